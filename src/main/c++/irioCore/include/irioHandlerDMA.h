@@ -329,6 +329,103 @@ int irio_getDMATTtoHostSampleSize(const irioDrv_t *p_DrvPvt, int n,
  */
 int irio_getNumDMA(const irioDrv_t *p_DrvPvt, size_t *value, TStatus *status);
 
+/**
+ * Function called when the data of a DMA with a registered callback is ready
+ *
+ * The data is valid until it is released with irio_releaseDMACallbackData().
+ * The DMA does not deliver new data to the callback until the previous one
+ * has been released, so it should be released as soon as possible to avoid
+ * overflows. It can be released from inside the callback.
+ *
+ * @param[in] data			Pointer to the data ready. NULL if the DMA stopped
+ * 							delivering data because of an error
+ * @param[in] elementsRead	Number of elements ready (blocks or images). 0 if
+ * 							data is NULL
+ * @param[in] releaseToken	Token to release the data with
+ * 							irio_releaseDMACallbackData()
+ * @param[in] userData		Pointer given when the callback was registered
+ *
+ * @ingroup IrioCoreCompatible
+ */
+typedef void (*irio_DMACallback)(const uint64_t *data, int elementsRead,
+								 void *releaseToken, void *userData);
+
+/**
+ * Registers a callback to be called each time data blocks are ready in a DMA
+ *
+ * An internal thread waits for \p nBlocks data blocks to be available in the
+ * DMA and calls \p callback with a pointer to them, without copying the data
+ * into an user buffer. The size in DMA words of a data block is the same as in
+ * irio_getDMATtoHostData(). Only one callback can be registered per DMA, and
+ * while it is registered the DMA must not be read with other functions.
+ *
+ * Errors may occur if the DMA is not found or if it already has a callback.
+ *
+ * @param[in] p_DrvPvt	Pointer to the driver session structure
+ * @param[in] n			Number of the DMA
+ * @param[in] nBlocks	Number of data blocks to deliver in each call
+ * @param[in] callback	Function to call when the data is ready
+ * @param[in] userData	Pointer passed to \p callback
+ * @param[out] status	Warning and error messages produced during the execution
+ * 						of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_registerDMACallback(irioDrv_t *p_DrvPvt, int n, int nBlocks,
+							 irio_DMACallback callback, void *userData,
+							 TStatus *status);
+
+/**
+ * Registers a callback to be called each time an image is ready in a DMA
+ *
+ * Same as irio_registerDMACallback() but each call delivers one image
+ * of \p imageSize pixels, as read by irio_getDMATtoHostImage().
+ *
+ * @param[in] p_DrvPvt	Pointer to the driver session structure
+ * @param[in] n			Number of the DMA
+ * @param[in] imageSize	Size of the image in pixels
+ * @param[in] callback	Function to call when an image is ready
+ * @param[in] userData	Pointer passed to \p callback
+ * @param[out] status	Warning and error messages produced during the execution
+ * 						of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_registerDMAImageCallback(irioDrv_t *p_DrvPvt, int n, int imageSize,
+								  irio_DMACallback callback, void *userData,
+								  TStatus *status);
+
+/**
+ * Unregisters the callback of a DMA
+ *
+ * Waits for the internal thread to finish. Data not released yet is
+ * released, so it must not be accessed after this call returns.
+ * It must not be called from inside the callback.
+ *
+ * @param[in] p_DrvPvt	Pointer to the driver session structure
+ * @param[in] n			Number of the DMA
+ * @param[out] status	Warning and error messages produced during the execution
+ * 						of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_unregisterDMACallback(irioDrv_t *p_DrvPvt, int n, TStatus *status);
+
+/**
+ * Releases the data delivered to a DMA callback, returning it to the DMA
+ *
+ * @param[in] releaseToken	Token received by the callback
+ * @param[out] status		Warning and error messages produced during the
+ * 							execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_releaseDMACallbackData(void *releaseToken, TStatus *status);
+
 
 #ifdef __cplusplus
 }
@@ -61,6 +61,13 @@ extern "C" {
  *              16384 for 32-bit elements (U32, I32),
  *              32768 for 16-bit elements (U16, I16), or
  *              65536 for  8-bit elements (U8, I8, Bool).
+ *              In DAQ profiles, blocks are acquired and released whole, so
+ *              depth must also be a multiple of the words per block of every
+ *              DMA. Otherwise a ValueOOB_Warning is returned and the DMAs are
+ *              not set up. A depth of 0 or less is rejected the same way.
+ *              In IMAQ profiles, depth must be a multiple of the size of the
+ *              images in DMA words to acquire them with
+ *              irio_getDMATtoGPUImage().
  * @param[out] status	Warning and error messages produced during the execution
  * of this call will be added here.
  *
@@ -204,20 +211,31 @@ int irio_setDMATtoGPUEnable(irioDrv_t *p_DrvPvt, int n, int32_t value,
 
 
 /**
- * Reads data from the DMA (NOT IMPLEMENTED)
- *
- * Reads Nelements from the DMA if they are available. If there are not enough
- * elements, nothing is read. The size in DMA words of an element must be
- * set before (NWordU64). Elements read will be written in the given buffer.
- *
- * @param p_DrvPvt Pointer to the nirioDriver structure
- * @param Nelements number of elements to read. Size of an element is given by NWordU64 of DMAStruct. @see {TdataDMA}
- * @param n Number of Number of the DMA where data should be read
- * @param data buffer where data should be stored
- * @param elementsRead number of elements read. Can be 0 or Nelements
- * @param status Warning and error messages produced during the execution of this call will be added here.
+ * Gives access to data blocks of the DMA without copying them
+ *
+ * Acquires Nelements data blocks from the DMA if they are available. If there
+ * are not enough blocks, nothing is acquired. The size in DMA words of a data
+ * block depends on the frame type and block size of the DMA
+ * (irioDrv_t::DMATtoHOSTFrameType and irioDrv_t::DMATtoHOSTBlockNWords).
+ * The blocks stay valid until they are released with
+ * irio_releaseDMATtoGPUData().
+ *
+ * The acquired blocks are contiguous in memory, so when the requested blocks
+ * wrap around the end of the host buffer only the ones up to the end are
+ * acquired, and the rest are acquired by the next call. This never happens
+ * if the depth used in irio_setUpDMAsTtoGPU() is a multiple of the size of
+ * the requested blocks.
+ *
+ * @param[in] p_DrvPvt Pointer to the nirioDriver structure
+ * @param[in] Nelements number of data blocks to acquire
+ * @param[in] n Number of the DMA where data should be read
+ * @param[out] data pointer to the first block acquired
+ * @param[out] elementsRead number of blocks acquired. 0 if there are not
+ * 				enough blocks, fewer than Nelements if they wrap around the end
+ * 				of the host buffer, Nelements otherwise
+ * @param[out] status Warning and error messages produced during the execution of this call will be added here.
  * 
- * @return Operation status. @see {TStatusCodes}
+ * @return \ref TIRIOStatusCode result of the execution of this call.
  *
  * @ingroup IrioCoreCompatible 
  */
@@ -225,14 +243,35 @@ int irio_getDMATtoGPUData(const irioDrv_t *p_DrvPvt, int Nelements, int n,
 		uint64_t **data, int *elementsRead, TStatus *status);
 
 /**
- * This function allow to get a pointer point to GPU Memory where the data are available. This pointer points (double pointer)
- * to GPU memory. Therefore, the access to this data using the CPU the user has to copy them to CPU memory using the appropriate function.
+ * Releases data blocks acquired with irio_getDMATtoGPUData(),
+ * returning them to the DMA
+ *
+ * @param[in] p_DrvPvt Pointer to the nirioDriver structure
+ * @param[in] n Number of the DMA where data was acquired
+ * @param[in] Nelements number of data blocks to release
+ * @param[out] status	Warning and error messages produced during the execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible 
+ */
+int irio_releaseDMATtoGPUData(irioDrv_t *p_DrvPvt, int n, int Nelements,
+		TStatus *status);
+
+/**
+ * This function allow to get a pointer point to the memory where the image is available, without copying it.
+ * The memory is provided by the DMA buffer sink configured in the terminals, by default the host memory where the DMA
+ * writes its data. If the sink maps the data into GPU memory, the user has to copy them to CPU memory using the appropriate
+ * function to access them from the CPU. The image stays valid until it is released with irio_releaseDMATtoGPUImage().
+ * If there are not enough pixels, nothing is acquired.
+ * The depth used in irio_setUpDMAsTtoGPU() must be a multiple of the image size
+ * in DMA words, so an image is never split at the end of the host buffer.
+ * Otherwise a ValueOOB_Warning is returned and nothing is acquired.
  *
  * @param[in] p_DrvPvt Pointer to the nirioDriver structure
  * @param[in] imageSize number of elements to get.
  * @param[in] n Identifier of the DMA Buffer (DMA FIFO)
  * @param[out] data double pointer to GPU memory buffer
- * @param[out] elementsRead number of elements available in the buffer
+ * @param[out] elementsRead number of elements (pixels) available in the buffer. Can be 0 or imageSize
  * @param[out] status	Warning and error messages produced during the execution of this call will be added here.
  * @return \ref TIRIOStatusCode
  *
@@ -246,7 +285,7 @@ int irio_getDMATtoGPUImage(const irioDrv_t *p_DrvPvt, int imageSize, int n,
  *
  * @param[in] p_DrvPvt Pointer to the nirioDriver structure
  * @param[in] n Identifier of the DMA Buffer (DMA FIFO)
- * @param[in] elementstofree number of elements realeased in the buffer
+ * @param[in] elementstofree number of elements (pixels) realeased in the buffer
  * @param[out] status	Warning and error messages produced during the execution of this call will be added here.
  * @return return \ref TIRIOStatusCode result of the execution of this call.
  *
@@ -0,0 +1,205 @@
+/****************************************************************************
+ * \file irioSharedDMA.h
+ * \brief Publication of DMA data blocks in shared memory for several
+ * consumer processes
+ * \par License:
+ * 	\n This project is released under the GNU Public License version 2.
+ *****************************************************************************/
+
+#pragma once
+
+#include "irioDataTypes.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Publisher of the data blocks of a DMA in a POSIX shared memory ring
+ *
+ * @ingroup IrioCoreCompatible
+ */
+typedef struct irioSharedDMAPublisher irioSharedDMAPublisher;
+
+/**
+ * Consumer of a DMA published with irio_createSharedDMAPublisher()
+ *
+ * @ingroup IrioCoreCompatible
+ */
+typedef struct irioSharedDMAReader irioSharedDMAReader;
+
+/**
+ * Creates a shared memory ring (/dev/shm) to publish the data blocks of a DMA
+ *
+ * Each slot of the ring holds \p nBlocks data blocks, with the same size in
+ * DMA words as in irio_getDMATtoHostData(). The DMA is read once, directly
+ * into the ring, with irio_publishSharedDMA(), and any number of processes
+ * (up to \p maxConsumers) can consume the data with irio_openSharedDMA().
+ * While the publisher exists the DMA must not be read with other functions.
+ *
+ * Errors may occur if the DMA is not found or the ring cannot be created.
+ *
+ * @param[in] p_DrvPvt		Pointer to the driver session structure
+ * @param[in] n				Number of the DMA
+ * @param[in] name			Name of the shared memory object (e.g. "irioDMA0")
+ * @param[in] nBlocks		Number of data blocks of each slot
+ * @param[in] nSlots		Number of slots of the ring
+ * @param[in] maxConsumers	Max number of consumers attached at the same time
+ * @param[in] skipAhead		If not 0, slow consumers skip the slots overwritten
+ * 							before being read. If 0, slots are not overwritten
+ * 							until read by all consumers, leaving the data in
+ * 							the DMA meanwhile
+ * @param[out] publisher	Publisher created
+ * @param[out] status		Warning and error messages produced during the
+ * 							execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_createSharedDMAPublisher(irioDrv_t *p_DrvPvt, int n, const char *name,
+								  int nBlocks, int nSlots, int maxConsumers,
+								  int skipAhead,
+								  irioSharedDMAPublisher **publisher,
+								  TStatus *status);
+
+/**
+ * Reads a slot from the DMA and publishes it in the ring
+ *
+ * Errors may occur if the data is not available before \p timeout expires or
+ * if the FPGA access fails.
+ *
+ * @param[in] publisher		Publisher of the DMA
+ * @param[in] timeout		Max time in milliseconds to wait for the data,
+ * 							0 to wait indefinitely
+ * @param[out] published	1 if published, 0 if the slot was not read yet by
+ * 							a consumer and \p skipAhead was 0
+ * @param[out] status		Warning and error messages produced during the
+ * 							execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_publishSharedDMA(irioSharedDMAPublisher *publisher, uint32_t timeout,
+						  int *published, TStatus *status);
+
+/**
+ * Destroys the publisher and removes the shared memory object
+ *
+ * @param[in,out] publisher	Publisher to destroy. Set to NULL
+ * @param[out] status		Warning and error messages produced during the
+ * 							execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_destroySharedDMAPublisher(irioSharedDMAPublisher **publisher,
+								   TStatus *status);
+
+/**
+ * Attaches to the ring of a DMA publisher
+ *
+ * The reader receives the slots published from now on.
+ * Errors may occur if the ring does not exist or has
+ * the maximum number of consumers attached.
+ *
+ * @param[in] name		Name of the shared memory object of the publisher
+ * @param[out] reader	Reader attached
+ * @param[out] status	Warning and error messages produced during the
+ * 						execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_openSharedDMA(const char *name, irioSharedDMAReader **reader,
+					   TStatus *status);
+
+/**
+ * Detaches from the ring
+ *
+ * @param[in,out] reader	Reader to close. Set to NULL
+ * @param[out] status		Warning and error messages produced during the
+ * 							execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_closeSharedDMA(irioSharedDMAReader **reader, TStatus *status);
+
+/**
+ * Waits for the next slot and gives access to its data without copying it
+ *
+ * The slot must be released with irio_releaseSharedDMABlock()
+ * before acquiring the next one.
+ *
+ * @param[in] reader	Reader of the ring
+ * @param[in] timeout	Max time in milliseconds to wait,
+ * 						0 to wait indefinitely
+ * @param[out] data		Pointer to the data in the shared memory
+ * @param[out] elements	Number of DMA words of the slot
+ * @param[out] sequence	Sequence number of the slot. Gaps in the sequence
+ * 						correspond to slots skipped. Can be NULL
+ * @param[out] status	Warning and error messages produced during the
+ * 						execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_acquireSharedDMABlock(irioSharedDMAReader *reader, uint32_t timeout,
+							   const uint64_t **data, int *elements,
+							   uint64_t *sequence, TStatus *status);
+
+/**
+ * Releases the slot acquired
+ *
+ * A warning is returned if the slot was overwritten by the publisher
+ * while acquired, in which case the data accessed is not reliable.
+ *
+ * @param[in] reader	Reader of the ring
+ * @param[out] status	Warning and error messages produced during the
+ * 						execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_releaseSharedDMABlock(irioSharedDMAReader *reader, TStatus *status);
+
+/**
+ * Copies the next slot into a buffer
+ *
+ * @param[in] reader		Reader of the ring
+ * @param[in] timeout		Max time in milliseconds to wait,
+ * 							0 to wait indefinitely
+ * @param[out] data			Buffer for the data
+ * @param[in] maxElements	Number of DMA words of \p data
+ * @param[out] elements		Number of DMA words read
+ * @param[out] sequence		Sequence number of the slot. Can be NULL
+ * @param[out] status		Warning and error messages produced during the
+ * 							execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_readSharedDMABlock(irioSharedDMAReader *reader, uint32_t timeout,
+							uint64_t *data, int maxElements, int *elements,
+							uint64_t *sequence, TStatus *status);
+
+/**
+ * Returns the number of slots skipped by a reader
+ * because they were overwritten before being read
+ *
+ * @param[in] reader	Reader of the ring
+ * @param[out] skipped	Number of slots skipped
+ * @param[out] status	Warning and error messages produced during the
+ * 						execution of this call will be added here.
+ * @return \ref TIRIOStatusCode result of the execution of this call.
+ *
+ * @ingroup IrioCoreCompatible
+ */
+int irio_getSharedDMASkippedBlocks(const irioSharedDMAReader *reader,
+								   uint64_t *skipped, TStatus *status);
+
+#ifdef __cplusplus
+}
+#endif
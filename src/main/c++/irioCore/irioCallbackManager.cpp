@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "irioCallbackManager.h"
+
+namespace {
+
+/// Max time the reader thread waits for data before checking if it must stop
+constexpr std::uint32_t READER_POLL_TIMEOUT_MS = 100;
+
+/**
+ * Number of the last delivery to a callback, of any reader. The release
+ * token is the number of the delivery, so a token of a reader already
+ * unregistered never releases the data of another one
+ */
+std::atomic<std::uintptr_t> lastDelivery{0};
+
+class DMACallbackReader {
+ public:
+	DMACallbackReader(const irio::TerminalsDMACommon &terminals,
+					  const std::uint32_t n, const size_t wordsPerElement,
+					  const size_t elements, const DMACallbackFunc &callback)
+		: m_terminals(terminals), m_n(n),
+		  m_words(wordsPerElement * elements), m_callback(callback) {
+		m_thread = std::thread(&DMACallbackReader::run, this);
+	}
+
+	~DMACallbackReader() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_cv.notify_all();
+		m_thread.join();
+	}
+
+	/**
+	 * Releases the data of a delivery
+	 *
+	 * @return False if \p token is not the one of the data pending
+	 */
+	bool release(const void *token) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_pendingRelease || token != m_pendingToken) {
+				return false;
+			}
+			m_pendingRelease = false;
+		}
+		m_cv.notify_all();
+		return true;
+	}
+
+ private:
+	void run() {
+		std::vector<std::uint64_t> bounceBuffer;
+		try {
+			while (!m_stop) {
+				std::uint64_t *data = nullptr;
+				size_t acquired;
+				try {
+					acquired = m_terminals.acquireData(m_n, m_words, &data,
+													   true,
+													   READER_POLL_TIMEOUT_MS);
+				} catch (irio::errors::DMAReadTimeout &) {
+					continue;
+				}
+
+				size_t toRelease = m_words;
+				if (acquired < m_words) {
+					// The data wraps around the end of the host buffer,
+					// it is delivered from a copy to keep it contiguous
+					bounceBuffer.resize(m_words);
+					if (!copyAcquiredToBounce(data, acquired, &bounceBuffer)) {
+						break;
+					}
+					data = bounceBuffer.data();
+					toRelease = 0;
+				}
+
+				void *token;
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					// 0 would be a null token once it wraps around
+					std::uintptr_t delivery;
+					while ((delivery = ++lastDelivery) == 0) {}
+					token = reinterpret_cast<void*>(delivery);
+					m_pendingToken = token;
+					m_pendingRelease = true;
+				}
+				m_callback(data, token);
+
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cv.wait(lock, [this] {
+						return !m_pendingRelease || m_stop;
+					});
+					m_pendingRelease = false;
+				}
+
+				if (toRelease) {
+					m_terminals.releaseData(m_n, toRelease);
+				}
+			}
+		} catch (irio::errors::IrioError &) {
+			m_callback(nullptr, nullptr);
+		}
+	}
+
+	/**
+	 * Copies a block that wraps around the end of the host buffer, waiting
+	 * for the rest of it as long as needed
+	 *
+	 * @return False if the reader was stopped before the block was complete
+	 */
+	bool copyAcquiredToBounce(const std::uint64_t *data, size_t acquired,
+							  std::vector<std::uint64_t> *bounceBuffer) {
+		size_t copied = 0;
+		while (true) {
+			std::copy_n(data, acquired, bounceBuffer->begin() + copied);
+			m_terminals.releaseData(m_n, acquired);
+			copied += acquired;
+			if (copied == m_words) {
+				return true;
+			}
+			std::uint64_t *nextData = nullptr;
+			acquired = 0;
+			while (acquired == 0) {
+				if (m_stop) {
+					return false;
+				}
+				try {
+					acquired = m_terminals.acquireData(m_n, m_words - copied,
+													   &nextData, true,
+													   READER_POLL_TIMEOUT_MS);
+				} catch (irio::errors::DMAReadTimeout &) {
+					// The rest of the block has not arrived yet
+				}
+			}
+			data = nextData;
+		}
+	}
+
+	const irio::TerminalsDMACommon m_terminals;
+	const std::uint32_t m_n;
+	const size_t m_words;
+	const DMACallbackFunc m_callback;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::atomic<bool> m_stop{false};
+	bool m_pendingRelease = false;
+	/// Token of the data pending to be released
+	const void *m_pendingToken = nullptr;
+
+	std::thread m_thread;
+};
+
+using CallbackKey = std::tuple<std::string, std::uint32_t, std::uint32_t>;
+using ReaderPtr = std::unique_ptr<DMACallbackReader>;
+
+std::mutex mutexReaders;
+std::map<CallbackKey, ReaderPtr> mapReaders;
+
+}  // namespace
+
+bool IrioCallbackManager::registerCallback(const std::string &RIOSerialNumber,
+		const std::uint32_t session, const std::uint32_t n,
+		const irio::TerminalsDMACommon &terminals,
+		const size_t wordsPerElement, const size_t elements,
+		const DMACallbackFunc &callback) {
+	std::lock_guard<std::mutex> lock(mutexReaders);
+	const auto key = std::make_tuple(RIOSerialNumber, session, n);
+	if (mapReaders.find(key) != mapReaders.end()) {
+		return false;
+	}
+
+	mapReaders.emplace(key, ReaderPtr(new DMACallbackReader(terminals, n,
+									  wordsPerElement, elements, callback)));
+	return true;
+}
+
+bool IrioCallbackManager::unregisterCallback(
+		const std::string &RIOSerialNumber,
+		const std::uint32_t session, const std::uint32_t n) {
+	ReaderPtr reader;
+	{
+		std::lock_guard<std::mutex> lock(mutexReaders);
+		const auto it =
+			mapReaders.find(std::make_tuple(RIOSerialNumber, session, n));
+		if (it == mapReaders.end()) {
+			return false;
+		}
+		reader = std::move(it->second);
+		mapReaders.erase(it);
+	}
+	// Stopped out of the lock, the callback may be releasing data
+	reader.reset();
+	return true;
+}
+
+void IrioCallbackManager::unregisterAllCallbacks(
+		const std::string &RIOSerialNumber,
+		const std::uint32_t session) {
+	std::vector<ReaderPtr> readers;
+	{
+		std::lock_guard<std::mutex> lock(mutexReaders);
+		auto it = mapReaders.begin();
+		while (it != mapReaders.end()) {
+			if (std::get<0>(it->first) == RIOSerialNumber &&
+				std::get<1>(it->first) == session) {
+				readers.push_back(std::move(it->second));
+				it = mapReaders.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+	readers.clear();
+}
+
+bool IrioCallbackManager::releaseData(void *releaseToken) {
+	if (releaseToken == nullptr) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutexReaders);
+	for (const auto &reader : mapReaders) {
+		if (reader.second->release(releaseToken)) {
+			return true;
+		}
+	}
+	return false;
+}
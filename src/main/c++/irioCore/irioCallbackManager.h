@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <functional>
+
+#include "irioCoreCpp.h"
+
+/**
+ * Function called by the reader threads when data is ready.
+ *
+ * The first parameter points to the data ready, nullptr if the
+ * reader stopped because of an error. The second one is the token
+ * to pass to IrioCallbackManager::releaseData once the data has been
+ * consumed.
+ */
+using DMACallbackFunc = std::function<void(const std::uint64_t*, void*)>;
+
+class IrioCallbackManager {
+ protected:
+	IrioCallbackManager() = default;
+
+ public:
+	IrioCallbackManager(const IrioCallbackManager &other) = delete;
+
+	void operator=(const IrioCallbackManager&) = delete;
+
+	/**
+	 * Starts a reader thread for a DMA that calls \p callback
+	 * each time \p elements of \p wordsPerElement words are ready.
+	 *
+	 * @return False if there is already a callback registered for the DMA
+	 */
+	static bool registerCallback(const std::string &RIOSerialNumber,
+			const std::uint32_t session, const std::uint32_t n,
+			const irio::TerminalsDMACommon &terminals,
+			const size_t wordsPerElement, const size_t elements,
+			const DMACallbackFunc &callback);
+
+	/**
+	 * Stops the reader thread of a DMA. Data not released
+	 * is released before returning.
+	 *
+	 * @return False if there was no callback registered for the DMA
+	 */
+	static bool unregisterCallback(const std::string &RIOSerialNumber,
+			const std::uint32_t session, const std::uint32_t n);
+
+	static void unregisterAllCallbacks(const std::string &RIOSerialNumber,
+			const std::uint32_t session);
+
+	/**
+	 * Returns the data of a callback to its DMA
+	 *
+	 * @return False if the token is not valid, was already released or is
+	 * 		   from a reader already unregistered
+	 */
+	static bool releaseData(void *releaseToken);
+};
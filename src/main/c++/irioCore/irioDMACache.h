@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "irioCoreCpp.h"
+#include "irioDataTypes.h"
+
+/**
+ * DMA information needed on every read, computed once at irio_initDriver.
+ *
+ * Kept with the rest of the state of each driver, avoiding the lookup of
+ * the driver instance and the terminals for each read.
+ */
+struct DMATtoHostCache {
+	explicit DMATtoHostCache(const irio::TerminalsDMACommon &term)
+		: terminals(term) {}
+
+	/// DMA terminals of the driver
+	const irio::TerminalsDMACommon terminals;
+	/// Whether the profile is a DAQ one, so data blocks can be read
+	bool isDAQ = false;
+	/// DMA words of a data block (timestamp included), 0 if DMA not found
+	std::vector<size_t> wordsPerBlock;
+};
+
+/**
+ * Returns the DMA cache of a driver, nullptr if it is not initialized
+ */
+std::shared_ptr<const DMATtoHostCache> findDMACache(const irioDrv_t *p_DrvPvt);
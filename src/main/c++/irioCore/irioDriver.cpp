@@ -6,8 +6,11 @@
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <mutex>
 
 #include "errorsIrio.h"
+#include "irioCallbackManager.h"
+#include "irioDMACache.h"
 #include "irioError.h"
 #include "irioInstanceManager.h"
 #include "irioResourceFinder.h"
@@ -39,8 +42,11 @@ struct DMATtoHostStruct {
 	std::unique_ptr<std::uint8_t> sampleSize;
 	std::unique_ptr<std::uint16_t> blockNWords;
 	std::unique_ptr<std::uint16_t> chIndex;
+	std::shared_ptr<DMATtoHostCache> cache;
 };
-std::unordered_map<irioDrv_t *, DMATtoHostStruct> map_DMA;
+/// Guards map_DMA, read concurrently by the DMA reads
+std::mutex mutexDMA;
+std::unordered_map<const irioDrv_t *, DMATtoHostStruct> map_DMA;
 
 std::unordered_map<irioDrv_t *, std::unique_ptr<std::uint32_t>> map_sgfref;
 
@@ -138,8 +144,6 @@ void fillPlatformData(const Irio *irio, irioDrv_t *p_DrvPvt) {
 	p_DrvPvt->max_numberofSG = static_cast<std::uint16_t>(plt.maxSG);
 
 	fillModules(plt, p_DrvPvt, irio);
-
-	// TODO: GPU
 }
 
 void fillCVData(const Irio *irio, irioDrv_t *p_DrvPvt, TStatus *status) {
@@ -168,6 +172,7 @@ void fillSGFref(const Irio *irio, irioDrv_t *p_DrvPvt) {
 }
 
 void fillDMATtoHOST(const Irio *irio, irioDrv_t *p_DrvPvt) {
+	std::lock_guard<std::mutex> lock(mutexDMA);
 	const auto it = map_DMA.emplace(p_DrvPvt, DMATtoHostStruct());
 	const auto maxDMA = p_DrvPvt->max_dmas;
 	std::uint32_t numCh = 0;
@@ -179,6 +184,12 @@ void fillDMATtoHOST(const Irio *irio, irioDrv_t *p_DrvPvt) {
 	it.first->second.chIndex.reset(new std::uint16_t[maxDMA]);
 
 	const auto profile = irio->getProfileID();
+	const bool isIMAQ = profile == PROFILE_ID::FLEXRIO_CPUIMAQ ||
+						profile == PROFILE_ID::FLEXRIO_GPUIMAQ;
+	it.first->second.cache.reset(
+		new DMATtoHostCache(getTerminalsDMA(irio)));
+	it.first->second.cache->isDAQ = !isIMAQ;
+	it.first->second.cache->wordsPerBlock.assign(maxDMA, 0);
 	std::uint16_t chIndexAccum = 0;
 	for(std::uint16_t i = 0; i < maxDMA; ++i) {
 		try {
@@ -187,8 +198,7 @@ void fillDMATtoHOST(const Irio *irio, irioDrv_t *p_DrvPvt) {
 				getTerminalsDMA(irio).getFrameType(i));
 			it.first->second.sampleSize.get()[i] =
 				getTerminalsDMA(irio).getSampleSize(i);
-			if (profile == PROFILE_ID::FLEXRIO_CPUIMAQ ||
-				profile == PROFILE_ID::FLEXRIO_GPUIMAQ) {
+			if (isIMAQ) {
 				it.first->second.blockNWords.get()[i] = 0;
 				it.first->second.chIndex.get()[i] = i;
 			} else {
@@ -196,6 +206,10 @@ void fillDMATtoHOST(const Irio *irio, irioDrv_t *p_DrvPvt) {
 					irio->getTerminalsDAQ().getLengthBlock(i);
 				it.first->second.chIndex.get()[i] = chIndexAccum;
 				chIndexAccum += it.first->second.nch.get()[i];
+				it.first->second.cache->wordsPerBlock[i] = getElementsToRead(
+					static_cast<irio::FrameType>(
+						it.first->second.frameType.get()[i]),
+					1, it.first->second.blockNWords.get()[i]);
 			}
 			numCh++;
 		} catch (ResourceNotFoundError &) {
@@ -209,10 +223,21 @@ void fillDMATtoHOST(const Irio *irio, irioDrv_t *p_DrvPvt) {
 	p_DrvPvt->DMATtoHOSTNo.value = numCh;
 
 	p_DrvPvt->DMATtoHOSTNCh = it.first->second.nch.get();
-	p_DrvPvt->DMATtoGPUChIndex = it.first->second.chIndex.get();
+	p_DrvPvt->DMATtoHOSTChIndex = it.first->second.chIndex.get();
 	p_DrvPvt->DMATtoHOSTFrameType = it.first->second.frameType.get();
 	p_DrvPvt->DMATtoHOSTSampleSize = it.first->second.sampleSize.get();
 	p_DrvPvt->DMATtoHOSTBlockNWords = it.first->second.blockNWords.get();
+
+	// GPU profiles use the same DMA information
+	if (profile == PROFILE_ID::FLEXRIO_GPUDAQ ||
+		profile == PROFILE_ID::FLEXRIO_GPUIMAQ) {
+		p_DrvPvt->max_dmas_gpu = maxDMA;
+		p_DrvPvt->DMATtoGPUNCh = p_DrvPvt->DMATtoHOSTNCh;
+		p_DrvPvt->DMATtoGPUChIndex = p_DrvPvt->DMATtoHOSTChIndex;
+		p_DrvPvt->DMATtoGPUFrameType = p_DrvPvt->DMATtoHOSTFrameType;
+		p_DrvPvt->DMATtoGPUSampleSize = p_DrvPvt->DMATtoHOSTSampleSize;
+		p_DrvPvt->DMATtoGPUBlockNWords = p_DrvPvt->DMATtoHOSTBlockNWords;
+	}
 }
 
 template <typename GetTerminalFunc, typename GetNumFunc>
@@ -293,6 +318,15 @@ void fillDrvPvtData(const Irio *irio, irioDrv_t *p_DrvPvt, TStatus *status) {
 	}
 }
 
+std::shared_ptr<const DMATtoHostCache> findDMACache(const irioDrv_t *p_DrvPvt) {
+	std::lock_guard<std::mutex> lock(mutexDMA);
+	const auto it = map_DMA.find(p_DrvPvt);
+	if (it == map_DMA.end()) {
+		return nullptr;
+	}
+	return it->second.cache;
+}
+
 ////////////////////////////////////////////////////
 /// Library API
 ////////////////////////////////////////////////////
@@ -365,12 +399,23 @@ int irio_closeDriver(irioDrv_t *p_DrvPvt, uint32_t mode, TStatus *status) {
 		map_sgfref.erase(p_DrvPvt);
 		map_projectName.erase(p_DrvPvt);
 		map_appCallID.erase(p_DrvPvt);
-		map_DMA.erase(p_DrvPvt);
+		{
+			std::lock_guard<std::mutex> lock(mutexDMA);
+			map_DMA.erase(p_DrvPvt);
+		}
 		p_DrvPvt->DMATtoHOSTNCh = nullptr;
 		p_DrvPvt->DMATtoHOSTFrameType = nullptr;
 		p_DrvPvt->DMATtoHOSTSampleSize = nullptr;
 		p_DrvPvt->DMATtoHOSTBlockNWords = nullptr;
-
+		p_DrvPvt->DMATtoHOSTChIndex = nullptr;
+		p_DrvPvt->DMATtoGPUNCh = nullptr;
+		p_DrvPvt->DMATtoGPUChIndex = nullptr;
+		p_DrvPvt->DMATtoGPUFrameType = nullptr;
+		p_DrvPvt->DMATtoGPUSampleSize = nullptr;
+		p_DrvPvt->DMATtoGPUBlockNWords = nullptr;
+
+		IrioCallbackManager::unregisterAllCallbacks(
+			p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
 		IrioInstanceManager::destroyInstance(p_DrvPvt->DeviceSerialNumber,
 											 p_DrvPvt->session);
 		irio_resetStatus(status);
@@ -1,5 +1,7 @@
 #include "irioHandlerDMA.h"
 
+#include "irioCallbackManager.h"
+#include "irioDMACache.h"
 #include "irioError.h"
 #include "irioInstanceManager.h"
 #include "irioUtils.h"
@@ -118,21 +120,6 @@ int irio_setDMATtoHostEnable(irioDrv_t *p_DrvPvt, int n, int32_t value,
 	return setOperationGeneric(f, status, p_DrvPvt->verbosity);
 }
 
-size_t getElementsToRead(const irio::FrameType &frameType, const int NBlocks,
-						 const std::uint16_t lengthBlock) {
-	size_t elementsToRead = 0;
-	switch (frameType) {
-	case irio::FrameType::FormatA:
-		elementsToRead = NBlocks * lengthBlock;
-		break;
-	case irio::FrameType::FormatB:
-		// each DMA data block includes two extra U64 words to include timestamp
-		elementsToRead = NBlocks * (lengthBlock + 2);
-		break;
-	}
-	return elementsToRead;
-}
-
 int irio_getDMATtoHOSTBlockNWords(const irioDrv_t *p_DrvPvt, uint16_t *Nwords,
 								  TStatus *status) {
 	const auto f = [Nwords, p_DrvPvt] {
@@ -154,23 +141,48 @@ int irio_getDMATtoHOSTNCh(const irioDrv_t *p_DrvPvt, uint16_t *NCh,
 	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
 }
 
-size_t readData(const std::string &serialNumber, const std::uint32_t &session,
-			  const int dmaNum, const int &NBlocks, uint64_t *data,
-			  const bool block, const std::uint32_t timeout = 0) {
-	const auto term = getTerminalsDAQ(serialNumber, session);
-	size_t lengthBlock = term.getLengthBlock(dmaNum);
-	size_t elementsToRead = getElementsToRead(
-		term.getFrameType(dmaNum), NBlocks, term.getLengthBlock(dmaNum));
+namespace {
+
+std::shared_ptr<const DMATtoHostCache> getDMACache(
+	const irioDrv_t *p_DrvPvt) {
+	auto cache = findDMACache(p_DrvPvt);
+	if (cache == nullptr || !cache->isDAQ) {
+		// Throws the error of the driver not initialized or the profile
+		// not having DAQ terminals
+		getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		throw TerminalNotImplementedError();
+	}
+	return cache;
+}
 
-	return term.readData(dmaNum, elementsToRead, data, block, timeout) /
-		   lengthBlock;
+size_t getWordsPerBlock(const DMATtoHostCache &cache, const int dmaNum) {
+	if (dmaNum < 0 ||
+		static_cast<size_t>(dmaNum) >= cache.wordsPerBlock.size() ||
+		cache.wordsPerBlock[dmaNum] == 0) {
+		throw ResourceNotFoundError(std::to_string(dmaNum) +
+									" is not a valid DMA ID");
+	}
+	return cache.wordsPerBlock[dmaNum];
 }
 
+size_t readData(const irioDrv_t *p_DrvPvt, const int dmaNum,
+				const int &NBlocks, uint64_t *data, const bool block,
+				const std::uint32_t timeout = 0) {
+	const auto cache = getDMACache(p_DrvPvt);
+	const size_t wordsPerBlock = getWordsPerBlock(*cache, dmaNum);
+
+	return cache->terminals.readData(dmaNum, NBlocks * wordsPerBlock, data,
+									block, timeout) /
+		   wordsPerBlock;
+}
+
+}  // namespace
+
 int irio_getDMATtoHostData(const irioDrv_t *p_DrvPvt, int NBlocks, int n,
 						   uint64_t *data, int *elementsRead, TStatus *status) {
 	const auto f = [n, NBlocks, data, elementsRead, p_DrvPvt] {
-		*elementsRead = static_cast<int>(readData(p_DrvPvt->DeviceSerialNumber,
-								 p_DrvPvt->session, n, NBlocks, data, false));
+		*elementsRead =
+			static_cast<int>(readData(p_DrvPvt, n, NBlocks, data, false));
 	};
 
 	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
@@ -180,9 +192,8 @@ int irio_getDMATtoHostData_timeout(const irioDrv_t *p_DrvPvt, int NBlocks,
 								   int n, uint64_t *data, int *elementsRead,
 								   uint32_t timeout, TStatus *status) {
 	const auto f = [n, NBlocks, data, timeout, elementsRead, p_DrvPvt] {
-		*elementsRead = static_cast<int>(readData(p_DrvPvt->DeviceSerialNumber,
-												  p_DrvPvt->session, n, NBlocks,
-												  data, true, timeout));
+		*elementsRead = static_cast<int>(
+			readData(p_DrvPvt, n, NBlocks, data, true, timeout));
 	};
 
 	try {
@@ -209,11 +220,8 @@ int irio_getDMATtoHostImage(const irioDrv_t *p_DrvPvt, int imageSize, int n,
 int irio_getDMATTtoHostFrameType(const irioDrv_t *p_DrvPvt, int n,
 								 uint8_t *frameType, TStatus *status) {
 	const auto f = [n, frameType, p_DrvPvt] {
-		*frameType = static_cast<std::uint8_t>(
-			IrioInstanceManager::getInstance(p_DrvPvt->DeviceSerialNumber,
-											 p_DrvPvt->session)
-				->getTerminalsDAQ()
-				.getFrameType(n));
+		getWordsPerBlock(*getDMACache(p_DrvPvt), n);
+		*frameType = p_DrvPvt->DMATtoHOSTFrameType[n];
 	};
 
 	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
@@ -222,10 +230,8 @@ int irio_getDMATTtoHostFrameType(const irioDrv_t *p_DrvPvt, int n,
 int irio_getDMATTtoHostSampleSize(const irioDrv_t *p_DrvPvt, int n,
 								  uint8_t *sampleSize, TStatus *status) {
 	const auto f = [n, sampleSize, p_DrvPvt] {
-		*sampleSize = IrioInstanceManager::getInstance(
-						  p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
-						  ->getTerminalsDAQ()
-						  .getSampleSize(n);
+		getWordsPerBlock(*getDMACache(p_DrvPvt), n);
+		*sampleSize = p_DrvPvt->DMATtoHOSTSampleSize[n];
 	};
 
 	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
@@ -236,3 +242,115 @@ int irio_getNumDMA(const irioDrv_t *p_DrvPvt, size_t *value, TStatus *status) {
 	status->code = IRIO_success;
 	return IRIO_success;
 }
+
+/**
+ * Registers the callback of a DMA. Returns false if the DMA already has one.
+ * The warning is merged by the caller, after operationGeneric has set the
+ * status of the operation
+ */
+bool registerCallbackGeneric(irioDrv_t *p_DrvPvt, int n,
+							 const irio::TerminalsDMACommon &terminals,
+							 const size_t wordsPerElement, const int elements,
+							 irio_DMACallback callback, void *userData) {
+	const auto cb = [callback, userData, elements](const uint64_t *data,
+												   void *releaseToken) {
+		callback(data, data ? elements : 0, releaseToken, userData);
+	};
+
+	return IrioCallbackManager::registerCallback(
+		p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session, n, terminals,
+		wordsPerElement, elements, cb);
+}
+
+int mergeRegisterResult(irioDrv_t *p_DrvPvt, int n, const int retOp,
+						const bool registered, TStatus *status) {
+	if (retOp != IRIO_success) {
+		return retOp;
+	}
+	if (!registered) {
+		irio_mergeStatus(status, ConfigDMA_Warning, p_DrvPvt->verbosity,
+						 "DMA %d already has a callback registered", n);
+		return IRIO_warning;
+	}
+	return IRIO_success;
+}
+
+int irio_registerDMACallback(irioDrv_t *p_DrvPvt, int n, int nBlocks,
+							 irio_DMACallback callback, void *userData,
+							 TStatus *status) {
+	if (nBlocks <= 0 || callback == nullptr) {
+		irio_mergeStatus(status, ValueOOB_Warning, p_DrvPvt->verbosity,
+						 "A callback and a positive number of blocks (%d) "
+						 "are required to register a DMA callback",
+						 nBlocks);
+		return IRIO_warning;
+	}
+
+	bool registered = true;
+	const auto f = [n, nBlocks, callback, userData, p_DrvPvt, &registered] {
+		const auto term =
+			getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		const size_t wordsPerBlock = getElementsToRead(
+			term.getFrameType(n), 1, term.getLengthBlock(n));
+		registered = registerCallbackGeneric(p_DrvPvt, n, term, wordsPerBlock,
+											 nBlocks, callback, userData);
+	};
+
+	const auto retOp =
+		operationGeneric<Read_Resource_Warning, Read_Resource_Warning,
+						 ConfigDMA_Warning>(f, status, p_DrvPvt->verbosity);
+
+	return mergeRegisterResult(p_DrvPvt, n, retOp, registered, status);
+}
+
+int irio_registerDMAImageCallback(irioDrv_t *p_DrvPvt, int n, int imageSize,
+								  irio_DMACallback callback, void *userData,
+								  TStatus *status) {
+	if (imageSize <= 0 || callback == nullptr) {
+		irio_mergeStatus(status, ValueOOB_Warning, p_DrvPvt->verbosity,
+						 "A callback and a positive image size (%d) "
+						 "are required to register a DMA callback",
+						 imageSize);
+		return IRIO_warning;
+	}
+
+	bool registered = true;
+	const auto f = [n, imageSize, callback, userData, p_DrvPvt,
+					&registered] {
+		const auto term =
+			getTerminalsIMAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		const size_t wordsPerImage =
+			static_cast<size_t>(imageSize) * term.getSampleSize(n) / 8;
+		registered = registerCallbackGeneric(p_DrvPvt, n, term, wordsPerImage,
+											 1, callback, userData);
+	};
+
+	const auto retOp =
+		operationGeneric<Read_Resource_Warning, Read_Resource_Warning,
+						 ConfigDMA_Warning>(f, status, p_DrvPvt->verbosity);
+
+	return mergeRegisterResult(p_DrvPvt, n, retOp, registered, status);
+}
+
+int irio_unregisterDMACallback(irioDrv_t *p_DrvPvt, int n, TStatus *status) {
+	if (!IrioCallbackManager::unregisterCallback(p_DrvPvt->DeviceSerialNumber,
+												 p_DrvPvt->session, n)) {
+		irio_mergeStatus(status, ConfigDMA_Warning, p_DrvPvt->verbosity,
+						 "DMA %d does not have a callback registered", n);
+		return IRIO_warning;
+	}
+
+	status->code = IRIO_success;
+	return IRIO_success;
+}
+
+int irio_releaseDMACallbackData(void *releaseToken, TStatus *status) {
+	if (!IrioCallbackManager::releaseData(releaseToken)) {
+		irio_mergeStatus(status, ConfigDMA_Warning, false,
+						 "Invalid release token or data already released");
+		return IRIO_warning;
+	}
+
+	status->code = IRIO_success;
+	return IRIO_success;
+}
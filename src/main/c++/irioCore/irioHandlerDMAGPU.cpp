@@ -0,0 +1,215 @@
+#include "irioHandlerDMAGPU.h"
+
+#include "irioError.h"
+#include "irioInstanceManager.h"
+#include "irioUtils.h"
+#include "profilesTypes.h"
+
+using irio::PROFILE_ID;
+using irio::errors::DMAReadTimeout;
+
+namespace {
+
+size_t getWordsPerBlock(const irio::TerminalsDMADAQ &term, const int n) {
+	return getElementsToRead(term.getFrameType(n), 1, term.getLengthBlock(n));
+}
+
+}  // namespace
+
+int irio_setUpDMAsTtoGPU(irioDrv_t *p_DrvPvt, int depth, TStatus *status) {
+	if (depth <= 0) {
+		irio_mergeStatus(status, ValueOOB_Warning, p_DrvPvt->verbosity,
+						 "Invalid host buffer depth %d, it must be positive",
+						 depth);
+		return IRIO_warning;
+	}
+
+	// Blocks are acquired and released whole, so a block must never be
+	// split by the wrap of the host buffer
+	int misaligned = -1;
+	const auto f = [p_DrvPvt, depth, &misaligned] {
+		const auto term =
+			getTerminalsDMA(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		if (p_DrvPvt->devProfile ==
+			static_cast<std::uint8_t>(PROFILE_ID::FLEXRIO_GPUDAQ)) {
+			const auto daq = getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber,
+											 p_DrvPvt->session);
+			const int dmas = static_cast<int>(daq.countDMAs());
+			for (int n = 0; n < dmas && misaligned < 0; ++n) {
+				if (depth % getWordsPerBlock(daq, n) != 0) {
+					misaligned = n;
+				}
+			}
+			if (misaligned >= 0) {
+				return;
+			}
+		}
+		term.setHostBufferDepth(depth);
+		term.startAllDMAs();
+	};
+
+	const int ret =
+		operationGeneric<Read_Resource_Warning, Read_Resource_Warning,
+						 ConfigDMA_Warning>(f, status, p_DrvPvt->verbosity);
+	if (ret == IRIO_success && misaligned >= 0) {
+		irio_mergeStatus(status, ValueOOB_Warning, p_DrvPvt->verbosity,
+						 "Host buffer depth %d is not a multiple of the "
+						 "words per block of DMA %d", depth, misaligned);
+		return IRIO_warning;
+	}
+	return ret;
+}
+
+int irio_closeDMAsTtoGPU(irioDrv_t *p_DrvPvt, TStatus *status) {
+	const auto f = [p_DrvPvt] {
+		getTerminalsDMA(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+			.stopAllDMAs();
+	};
+
+	return operationGeneric<Read_Resource_Warning, Read_Resource_Warning,
+							ConfigDMA_Warning>(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_cleanDMAsTtoGPU(irioDrv_t *p_DrvPvt, TStatus *status) {
+	const auto f = [p_DrvPvt] {
+		getTerminalsDMA(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+			.cleanAllDMAs();
+	};
+
+	return operationGeneric<Read_Resource_Warning, Read_Resource_Warning,
+							ConfigDMA_Warning>(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_cleanDMATtoGPU(irioDrv_t *p_DrvPvt, int n, uint64_t **, size_t,
+						TStatus *status) {
+	const auto f = [p_DrvPvt, n] {
+		getTerminalsDMA(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+			.cleanDMA(n);
+	};
+
+	return operationGeneric<Read_Resource_Warning, Read_Resource_Warning,
+							ConfigDMA_Warning>(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_getDMATtoGPUOverflow(const irioDrv_t *p_DrvPvt, int32_t *value,
+							  TStatus *status) {
+	const auto f = [value, p_DrvPvt] {
+		*value =
+			getTerminalsDMA(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+				.getAllDMAOverflows();
+	};
+
+	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_getDMATtoGPUSamplingRate(const irioDrv_t *p_DrvPvt, int n,
+								  int32_t *value, TStatus *status) {
+	const auto f = [n, value, p_DrvPvt] {
+		*value =
+			getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+				.getSamplingRateDecimation(n);
+	};
+
+	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_setDMATtoGPUSamplingRate(irioDrv_t *p_DrvPvt, int n, int32_t value,
+								  TStatus *status) {
+	const auto f = [n, value, p_DrvPvt] {
+		getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+			.setSamplingRateDecimation(n, value);
+	};
+
+	return setOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_getDMATtoGPUEnable(const irioDrv_t *p_DrvPvt, int n, int32_t *value,
+							TStatus *status) {
+	const auto f = [n, value, p_DrvPvt] {
+		*value =
+			getTerminalsDMA(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+				.isDMAEnable(n);
+	};
+
+	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_setDMATtoGPUEnable(irioDrv_t *p_DrvPvt, int n, int32_t value,
+							TStatus *status) {
+	const auto f = [n, value, p_DrvPvt] {
+		getTerminalsDMA(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session)
+			.enaDisDMA(n, value);
+	};
+
+	return setOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_getDMATtoGPUData(const irioDrv_t *p_DrvPvt, int Nelements, int n,
+						  uint64_t **data, int *elementsRead,
+						  TStatus *status) {
+	const auto f = [n, Nelements, data, elementsRead, p_DrvPvt] {
+		const auto term =
+			getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		const size_t wordsPerBlock = getWordsPerBlock(term, n);
+		*elementsRead = static_cast<int>(
+			term.acquireData(n, Nelements * wordsPerBlock, data, false) /
+			wordsPerBlock);
+	};
+
+	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_releaseDMATtoGPUData(irioDrv_t *p_DrvPvt, int n, int Nelements,
+							  TStatus *status) {
+	const auto f = [n, Nelements, p_DrvPvt] {
+		const auto term =
+			getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		term.releaseData(n, Nelements * getWordsPerBlock(term, n));
+	};
+
+	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_getDMATtoGPUImage(const irioDrv_t *p_DrvPvt, int imageSize, int n,
+						   uint64_t **data, int *elementsRead,
+						   TStatus *status) {
+	// Otherwise an image could be acquired partially at the end of the
+	// host buffer
+	size_t misalignedDepth = 0;
+	const auto f = [n, imageSize, data, elementsRead, p_DrvPvt,
+					&misalignedDepth] {
+		const auto term =
+			getTerminalsIMAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		const size_t sampleSize = term.getSampleSize(n);
+		const size_t words = imageSize * sampleSize / 8;
+		const size_t depth = term.getHostBufferDepth();
+		*elementsRead = 0;
+		if (words != 0 && depth % words != 0) {
+			misalignedDepth = depth;
+			return;
+		}
+		*elementsRead = static_cast<int>(
+			term.acquireData(n, words, data, false) * 8 / sampleSize);
+	};
+
+	const int ret = getOperationGeneric(f, status, p_DrvPvt->verbosity);
+	if (ret == IRIO_success && misalignedDepth != 0) {
+		irio_mergeStatus(status, ValueOOB_Warning, p_DrvPvt->verbosity,
+						 "Host buffer depth %zu is not a multiple of the "
+						 "image size of DMA %d", misalignedDepth, n);
+		return IRIO_warning;
+	}
+	return ret;
+}
+
+int irio_releaseDMATtoGPUImage(irioDrv_t *p_DrvPvt, int n, int elementstofree,
+							   TStatus *status) {
+	const auto f = [n, elementstofree, p_DrvPvt] {
+		const auto term =
+			getTerminalsIMAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		const size_t sampleSize = term.getSampleSize(n);
+		term.releaseData(n, elementstofree * sampleSize / 8);
+	};
+
+	return getOperationGeneric(f, status, p_DrvPvt->verbosity);
+}
@@ -0,0 +1,155 @@
+#include <functional>
+#include <memory>
+
+#include "irioSharedDMA.h"
+
+#include "dmaSharedPublisher.h"
+#include "dmaSharedReader.h"
+#include "irioError.h"
+#include "irioUtils.h"
+
+using irio::errors::DMAReadTimeout;
+using irio::errors::SharedMemoryError;
+
+struct irioSharedDMAPublisher {
+	std::unique_ptr<irio::DMASharedPublisher> publisher;
+	int verbosity;
+};
+
+struct irioSharedDMAReader {
+	std::unique_ptr<irio::DMASharedReader> reader;
+};
+
+namespace {
+
+int sharedOperation(const std::function<void()> &func, TStatus *status,
+					const bool verbosity) {
+	try {
+		return operationGeneric<Read_Resource_Warning, Read_Resource_Warning,
+								ConfigDMA_Warning>(func, status, verbosity);
+	} catch (DMAReadTimeout &e) {
+		irio_mergeStatus(status, Read_NIRIO_Warning, verbosity, e.what());
+		return IRIO_warning;
+	} catch (SharedMemoryError &e) {
+		irio_mergeStatus(status, FileAccess_Error, verbosity, e.what());
+		return IRIO_error;
+	}
+}
+
+}  // namespace
+
+int irio_createSharedDMAPublisher(irioDrv_t *p_DrvPvt, int n, const char *name,
+								  int nBlocks, int nSlots, int maxConsumers,
+								  int skipAhead,
+								  irioSharedDMAPublisher **publisher,
+								  TStatus *status) {
+	if (nBlocks <= 0 || nSlots < 2 || maxConsumers <= 0 || name == nullptr) {
+		irio_mergeStatus(status, ValueOOB_Warning, p_DrvPvt->verbosity,
+						 "A name, a positive number of blocks (%d), at least "
+						 "2 slots (%d) and 1 consumer (%d) are required to "
+						 "publish a DMA",
+						 nBlocks, nSlots, maxConsumers);
+		return IRIO_warning;
+	}
+
+	const auto f = [=] {
+		const auto term =
+			getTerminalsDAQ(p_DrvPvt->DeviceSerialNumber, p_DrvPvt->session);
+		const size_t wordsPerBlock = getElementsToRead(
+			term.getFrameType(n), 1, term.getLengthBlock(n));
+		const auto policy = skipAhead ? irio::SlowConsumerPolicy::SkipAhead
+									  : irio::SlowConsumerPolicy::WaitSlowest;
+
+		std::unique_ptr<irio::DMASharedPublisher> aux(
+			new irio::DMASharedPublisher(term, n, name, wordsPerBlock * nBlocks,
+										 nSlots, maxConsumers, policy));
+		*publisher = new irioSharedDMAPublisher{std::move(aux),
+												p_DrvPvt->verbosity};
+	};
+
+	return sharedOperation(f, status, p_DrvPvt->verbosity);
+}
+
+int irio_publishSharedDMA(irioSharedDMAPublisher *publisher, uint32_t timeout,
+						  int *published, TStatus *status) {
+	const auto f = [publisher, timeout, published] {
+		*published = publisher->publisher->publishFromDMA(timeout);
+	};
+
+	return sharedOperation(f, status, publisher->verbosity);
+}
+
+int irio_destroySharedDMAPublisher(irioSharedDMAPublisher **publisher,
+								   TStatus *status) {
+	delete *publisher;
+	*publisher = nullptr;
+	status->code = IRIO_success;
+	return IRIO_success;
+}
+
+int irio_openSharedDMA(const char *name, irioSharedDMAReader **reader,
+					   TStatus *status) {
+	const auto f = [name, reader] {
+		std::unique_ptr<irio::DMASharedReader> aux(
+			new irio::DMASharedReader(name));
+		*reader = new irioSharedDMAReader{std::move(aux)};
+	};
+
+	return sharedOperation(f, status, false);
+}
+
+int irio_closeSharedDMA(irioSharedDMAReader **reader, TStatus *status) {
+	delete *reader;
+	*reader = nullptr;
+	status->code = IRIO_success;
+	return IRIO_success;
+}
+
+int irio_acquireSharedDMABlock(irioSharedDMAReader *reader, uint32_t timeout,
+							   const uint64_t **data, int *elements,
+							   uint64_t *sequence, TStatus *status) {
+	const auto f = [reader, timeout, data, elements, sequence] {
+		irio::DMASharedBlock block;
+		reader->reader->acquireBlock(&block, timeout);
+		*data = block.data;
+		*elements = static_cast<int>(block.elements);
+		if (sequence) {
+			*sequence = block.sequence;
+		}
+	};
+
+	return sharedOperation(f, status, false);
+}
+
+int irio_releaseSharedDMABlock(irioSharedDMAReader *reader, TStatus *status) {
+	bool intact = true;
+	const auto f = [reader, &intact] {
+		intact = reader->reader->releaseBlock();
+	};
+
+	const auto ret = sharedOperation(f, status, false);
+	if (ret == IRIO_success && !intact) {
+		irio_mergeStatus(status, ResourceRelease_Warning, false,
+						 "The block was overwritten while acquired");
+		return IRIO_warning;
+	}
+	return ret;
+}
+
+int irio_readSharedDMABlock(irioSharedDMAReader *reader, uint32_t timeout,
+							uint64_t *data, int maxElements, int *elements,
+							uint64_t *sequence, TStatus *status) {
+	const auto f = [=] {
+		*elements = static_cast<int>(reader->reader->readBlock(
+			data, maxElements > 0 ? maxElements : 0, sequence, timeout));
+	};
+
+	return sharedOperation(f, status, false);
+}
+
+int irio_getSharedDMASkippedBlocks(const irioSharedDMAReader *reader,
+								   uint64_t *skipped, TStatus *status) {
+	*skipped = reader->reader->getSkippedBlocks();
+	status->code = IRIO_success;
+	return IRIO_success;
+}
@@ -60,6 +60,21 @@ irio::TerminalsDMACommon getTerminalsDMA(const std::string &rioSerial,
 	return getTerminalsDMA(irio);
 }
 
+size_t getElementsToRead(const irio::FrameType &frameType, const int NBlocks,
+						 const std::uint16_t lengthBlock) {
+	size_t elementsToRead = 0;
+	switch (frameType) {
+	case irio::FrameType::FormatA:
+		elementsToRead = NBlocks * lengthBlock;
+		break;
+	case irio::FrameType::FormatB:
+		// each DMA data block includes two extra U64 words to include timestamp
+		elementsToRead = NBlocks * (lengthBlock + 2);
+		break;
+	}
+	return elementsToRead;
+}
+
 template<TErrorDetailCode R,
 		 TErrorDetailCode T,
 		 TErrorDetailCode N>
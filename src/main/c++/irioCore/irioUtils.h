@@ -36,6 +36,9 @@ irio::TerminalsDMADAQ getTerminalsDAQ(const std::string &rioSerial,
 irio::TerminalsDMAIMAQ getTerminalsIMAQ(const std::string &rioSerial,
 		const std::uint32_t session);
 
+size_t getElementsToRead(const irio::FrameType &frameType, const int NBlocks,
+						 const std::uint16_t lengthBlock);
+
 template<TErrorDetailCode R,
 		 TErrorDetailCode T,
 		 TErrorDetailCode N>
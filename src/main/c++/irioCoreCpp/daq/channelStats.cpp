@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "daq/channelStats.h"
+#include "errorsIrio.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+/// The sums of squares of a window fit in 64 bits
+const std::uint64_t MAX_WINDOW_SAMPLES = static_cast<std::uint64_t>(1) << 32;
+/// Vectors whose sign extended values are added in 32 bits lanes
+const size_t SUM_VECTORS = 32768;
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+size_t checkSegments(const size_t segmentSamples,
+					 const size_t windowSegments) {
+	if (segmentSamples == 0 || windowSegments == 0 ||
+		static_cast<double>(segmentSamples) * windowSegments >
+			static_cast<double>(MAX_WINDOW_SAMPLES)) {
+		throw errors::DAQStageError(
+			"Window of " + std::to_string(windowSegments) + " segments of " +
+			std::to_string(segmentSamples) + " samples outside [1, 2^32]");
+	}
+	return segmentSamples;
+}
+
+/////////////////////////////////////////////////////////////
+/// Sum kernels
+/////////////////////////////////////////////////////////////
+
+// The kernels add the interleaved values of the channels, starting at a
+// sample, and return the number of values added. The vector kernels keep
+// the sums of each position of the vector, which belongs to the same
+// channel in every vector when the channels divide it
+
+template<typename M>
+void addScalar(const std::int16_t *values, const size_t first,
+			   const size_t count, const size_t channels, M *moments) {
+	size_t c = first % channels;
+	for (size_t i = first; i < count; ++i) {
+		const std::int16_t x = values[i];
+		M &m = moments[c];
+		c = c + 1 == channels ? 0 : c + 1;
+		m.sum += x;
+		m.squares += static_cast<std::uint64_t>(static_cast<std::int32_t>(x) *
+												x);
+		m.min = std::min(m.min, x);
+		m.max = std::max(m.max, x);
+	}
+}
+
+/**
+ * Adds the sums of each position of the vectors to its channel
+ */
+template<typename M>
+void addPositions(const size_t positions, const std::int64_t *sums,
+				  const std::uint64_t *squares, const std::int16_t *mins,
+				  const std::int16_t *maxs, const size_t channels,
+				  M *moments) {
+	for (size_t j = 0; j < positions; ++j) {
+		M &m = moments[j % channels];
+		m.sum += sums[j];
+		m.squares += squares[j];
+		m.min = std::min(m.min, mins[j]);
+		m.max = std::max(m.max, maxs[j]);
+	}
+}
+
+#ifdef IRIO_X86_SIMD
+template<typename M>
+__attribute__((target("ssse3")))
+size_t addSSSE3(const std::int16_t *values, const size_t count,
+				const size_t channels, M *moments) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i mins = _mm_set1_epi16(std::numeric_limits<std::int16_t>::max());
+	__m128i maxs = _mm_set1_epi16(std::numeric_limits<std::int16_t>::min());
+	// Squares of positions 0 2, 1 3, 4 6 and 5 7
+	__m128i squares[4] = {zero, zero, zero, zero};
+	std::int64_t sums[8] = {};
+
+	size_t i = 0;
+	while (i + 8 <= count) {
+		// Sums of positions 0-3 and 4-7
+		__m128i sumLo = zero, sumHi = zero;
+		const size_t last = std::min(count - count % 8, i + 8 * SUM_VECTORS);
+		for (; i < last; i += 8) {
+			const __m128i v =
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+			mins = _mm_min_epi16(mins, v);
+			maxs = _mm_max_epi16(maxs, v);
+			sumLo = _mm_add_epi32(
+				sumLo, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+			sumHi = _mm_add_epi32(
+				sumHi, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+
+			// Squares of the magnitudes, which fit in 16 bits unsigned,
+			// multiplied in 64 bits
+			const __m128i a = _mm_abs_epi16(v);
+			const __m128i aLo = _mm_unpacklo_epi16(a, zero);
+			const __m128i aHi = _mm_unpackhi_epi16(a, zero);
+			const __m128i aLoOdd = _mm_srli_epi64(aLo, 32);
+			const __m128i aHiOdd = _mm_srli_epi64(aHi, 32);
+			squares[0] = _mm_add_epi64(squares[0], _mm_mul_epu32(aLo, aLo));
+			squares[1] =
+				_mm_add_epi64(squares[1], _mm_mul_epu32(aLoOdd, aLoOdd));
+			squares[2] = _mm_add_epi64(squares[2], _mm_mul_epu32(aHi, aHi));
+			squares[3] =
+				_mm_add_epi64(squares[3], _mm_mul_epu32(aHiOdd, aHiOdd));
+		}
+		std::int32_t partial[8];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(partial), sumLo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(partial + 4), sumHi);
+		for (size_t j = 0; j < 8; ++j) {
+			sums[j] += partial[j];
+		}
+	}
+	if (i == 0) {
+		return 0;
+	}
+
+	std::uint64_t lanes[8];
+	for (size_t k = 0; k < 4; ++k) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 2 * k),
+						 squares[k]);
+	}
+	const std::uint64_t positionSquares[8] = {lanes[0], lanes[2], lanes[1],
+											  lanes[3], lanes[4], lanes[6],
+											  lanes[5], lanes[7]};
+	std::int16_t positionMins[8], positionMaxs[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(positionMins), mins);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(positionMaxs), maxs);
+	addPositions(8, sums, positionSquares, positionMins, positionMaxs,
+				 channels, moments);
+	return i;
+}
+
+template<typename M>
+__attribute__((target("avx2")))
+size_t addAVX2(const std::int16_t *values, const size_t count,
+			   const size_t channels, M *moments) {
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i mins = _mm256_set1_epi16(std::numeric_limits<std::int16_t>::max());
+	__m256i maxs = _mm256_set1_epi16(std::numeric_limits<std::int16_t>::min());
+	// Squares of positions 0 2 4 6, 1 3 5 7, 8 10 12 14 and 9 11 13 15
+	__m256i squares[4] = {zero, zero, zero, zero};
+	std::int64_t sums[16] = {};
+
+	size_t i = 0;
+	while (i + 16 <= count) {
+		// Sums of positions 0-7 and 8-15
+		__m256i sumLo = zero, sumHi = zero;
+		const size_t last = std::min(count - count % 16,
+									 i + 16 * SUM_VECTORS);
+		for (; i < last; i += 16) {
+			const __m256i v =
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(values + i));
+			mins = _mm256_min_epi16(mins, v);
+			maxs = _mm256_max_epi16(maxs, v);
+			const __m256i lo =
+				_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));
+			const __m256i hi =
+				_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));
+			sumLo = _mm256_add_epi32(sumLo, lo);
+			sumHi = _mm256_add_epi32(sumHi, hi);
+
+			const __m256i loOdd = _mm256_srli_epi64(lo, 32);
+			const __m256i hiOdd = _mm256_srli_epi64(hi, 32);
+			squares[0] = _mm256_add_epi64(squares[0], _mm256_mul_epi32(lo, lo));
+			squares[1] =
+				_mm256_add_epi64(squares[1], _mm256_mul_epi32(loOdd, loOdd));
+			squares[2] = _mm256_add_epi64(squares[2], _mm256_mul_epi32(hi, hi));
+			squares[3] =
+				_mm256_add_epi64(squares[3], _mm256_mul_epi32(hiOdd, hiOdd));
+		}
+		std::int32_t partial[16];
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(partial), sumLo);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(partial + 8), sumHi);
+		for (size_t j = 0; j < 16; ++j) {
+			sums[j] += partial[j];
+		}
+	}
+	if (i == 0) {
+		return 0;
+	}
+
+	std::uint64_t lanes[16];
+	for (size_t k = 0; k < 4; ++k) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes + 4 * k),
+							squares[k]);
+	}
+	std::uint64_t positionSquares[16];
+	for (size_t k = 0; k < 4; ++k) {
+		positionSquares[2 * k] = lanes[k];
+		positionSquares[2 * k + 1] = lanes[4 + k];
+		positionSquares[8 + 2 * k] = lanes[8 + k];
+		positionSquares[8 + 2 * k + 1] = lanes[12 + k];
+	}
+	std::int16_t positionMins[16], positionMaxs[16];
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(positionMins), mins);
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(positionMaxs), maxs);
+	addPositions(16, sums, positionSquares, positionMins, positionMaxs,
+				 channels, moments);
+	return i;
+}
+#endif
+
+}  // namespace
+
+ChannelStatsStage::ChannelStatsStage(const size_t channels,
+									 const size_t segmentSamples,
+									 const size_t windowSegments)
+	: m_channels(checkChannels(channels)),
+	  m_segmentSamples(checkSegments(segmentSamples, windowSegments)),
+	  m_windowSegments(windowSegments), m_current(channels),
+	  m_segments(windowSegments * channels), m_windowSum(channels),
+	  m_windowSquares(channels), m_totalSum(channels),
+	  m_totalSquares(channels), m_totalMin(channels), m_totalMax(channels),
+	  m_window(channels), m_cumulative(channels) {
+	reset();
+}
+
+void ChannelStatsStage::process(const std::uint64_t *words,
+								const size_t elements,
+								const SIMDLevel level) {
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	const auto values = reinterpret_cast<const std::int16_t*>(words);
+	const size_t samples = getBlockSamples(elements, m_channels);
+#ifdef IRIO_X86_SIMD
+	const bool vectors = m_channels == 1 || m_channels == 2 ||
+						 m_channels == 4 || m_channels == 8;
+#else
+	static_cast<void>(used);
+#endif
+
+	size_t first = 0;
+	while (first < samples) {
+		const size_t count =
+			std::min(samples - first, m_segmentSamples - m_filled);
+		const std::int16_t *x = values + first * m_channels;
+		const size_t total = count * m_channels;
+		size_t done = 0;
+#ifdef IRIO_X86_SIMD
+		if (vectors && used == SIMDLevel::AVX2) {
+			done = addAVX2(x, total, m_channels, m_current.data());
+		} else if (vectors && used == SIMDLevel::SSSE3) {
+			done = addSSSE3(x, total, m_channels, m_current.data());
+		}
+#endif
+		addScalar(x, done, total, m_channels, m_current.data());
+
+		first += count;
+		m_filled += count;
+		m_position += count;
+		if (m_filled == m_segmentSamples) {
+			closeSegment();
+		}
+	}
+	publish();
+}
+
+void ChannelStatsStage::getStats(const size_t channel, const StatsScope scope,
+								 ChannelStats *stats) const {
+	if (channel >= m_channels) {
+		throw errors::DAQStageError("Channel " + std::to_string(channel) +
+									" not found");
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	*stats = scope == StatsScope::Window ? m_window[channel]
+										 : m_cumulative[channel];
+}
+
+double ChannelStatsStage::getValue(const size_t channel,
+								   const StatsScope scope,
+								   const StatsValue value) const {
+	ChannelStats stats;
+	getStats(channel, scope, &stats);
+	switch (value) {
+	case StatsValue::Samples:
+		return static_cast<double>(stats.samples);
+	case StatsValue::Mean:
+		return stats.mean;
+	case StatsValue::RMS:
+		return stats.rms;
+	case StatsValue::StdDev:
+		return stats.stdDev;
+	case StatsValue::Min:
+		return stats.min;
+	case StatsValue::Max:
+		return stats.max;
+	}
+	return 0;
+}
+
+std::uint64_t ChannelStatsStage::getSegments() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_publishedSegments;
+}
+
+std::uint64_t ChannelStatsStage::getPosition() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_published;
+}
+
+size_t ChannelStatsStage::getChannels() const {
+	return m_channels;
+}
+
+size_t ChannelStatsStage::getSegmentSamples() const {
+	return m_segmentSamples;
+}
+
+size_t ChannelStatsStage::getWindowSegments() const {
+	return m_windowSegments;
+}
+
+void ChannelStatsStage::reset() {
+	for (auto &moments : m_current) {
+		clear(&moments);
+	}
+	m_filled = 0;
+	m_segmentHead = 0;
+	m_segmentCount = 0;
+	std::fill(m_windowSum.begin(), m_windowSum.end(), 0);
+	std::fill(m_windowSquares.begin(), m_windowSquares.end(), 0);
+	std::fill(m_totalSum.begin(), m_totalSum.end(), 0);
+	std::fill(m_totalSquares.begin(), m_totalSquares.end(), 0);
+	std::fill(m_totalMin.begin(), m_totalMin.end(),
+			  std::numeric_limits<std::int16_t>::max());
+	std::fill(m_totalMax.begin(), m_totalMax.end(),
+			  std::numeric_limits<std::int16_t>::min());
+	m_position = 0;
+	m_completed = 0;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::fill(m_window.begin(), m_window.end(), ChannelStats());
+	std::fill(m_cumulative.begin(), m_cumulative.end(), ChannelStats());
+	m_published = 0;
+	m_publishedSegments = 0;
+}
+
+void ChannelStatsStage::closeSegment() {
+	Moments *slot = m_segments.data() + m_segmentHead * m_channels;
+	for (size_t c = 0; c < m_channels; ++c) {
+		const Moments &segment = m_current[c];
+		if (m_segmentCount == m_windowSegments) {
+			// Replaces the oldest segment
+			m_windowSum[c] -= slot[c].sum;
+			m_windowSquares[c] -= slot[c].squares;
+		}
+		slot[c] = segment;
+		m_windowSum[c] += segment.sum;
+		m_windowSquares[c] += segment.squares;
+
+		m_totalSum[c] += segment.sum;
+		m_totalSquares[c] += static_cast<double>(segment.squares);
+		m_totalMin[c] = std::min(m_totalMin[c], segment.min);
+		m_totalMax[c] = std::max(m_totalMax[c], segment.max);
+		clear(&m_current[c]);
+	}
+	m_segmentHead = (m_segmentHead + 1) % m_windowSegments;
+	m_segmentCount = std::min(m_segmentCount + 1, m_windowSegments);
+	m_filled = 0;
+	++m_completed;
+}
+
+void ChannelStatsStage::publish() {
+	std::vector<ChannelStats> window(m_channels), cumulative(m_channels);
+	const std::uint64_t windowSamples =
+		static_cast<std::uint64_t>(m_segmentCount) * m_segmentSamples;
+	for (size_t c = 0; c < m_channels; ++c) {
+		if (m_segmentCount > 0) {
+			std::int16_t min = std::numeric_limits<std::int16_t>::max();
+			std::int16_t max = std::numeric_limits<std::int16_t>::min();
+			for (size_t s = 0; s < m_segmentCount; ++s) {
+				const Moments &segment = m_segments[s * m_channels + c];
+				min = std::min(min, segment.min);
+				max = std::max(max, segment.max);
+			}
+			window[c] = getStats(windowSamples,
+								 static_cast<double>(m_windowSum[c]),
+								 static_cast<double>(m_windowSquares[c]), min,
+								 max);
+		}
+		// The samples of the segment in progress are included
+		const Moments &current = m_current[c];
+		cumulative[c] = getStats(
+			m_position, static_cast<double>(m_totalSum[c] + current.sum),
+			m_totalSquares[c] + static_cast<double>(current.squares),
+			std::min(m_totalMin[c], current.min),
+			std::max(m_totalMax[c], current.max));
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_window.swap(window);
+	m_cumulative.swap(cumulative);
+	m_published = m_position;
+	m_publishedSegments = m_completed;
+}
+
+void ChannelStatsStage::clear(Moments *moments) {
+	moments->sum = 0;
+	moments->squares = 0;
+	moments->min = std::numeric_limits<std::int16_t>::max();
+	moments->max = std::numeric_limits<std::int16_t>::min();
+}
+
+ChannelStats ChannelStatsStage::getStats(const std::uint64_t samples,
+										 const double sum,
+										 const double squares,
+										 const std::int16_t min,
+										 const std::int16_t max) {
+	ChannelStats stats;
+	if (samples == 0) {
+		return stats;
+	}
+	const double n = static_cast<double>(samples);
+	stats.samples = samples;
+	stats.mean = sum / n;
+	stats.rms = std::sqrt(squares / n);
+	stats.stdDev = std::sqrt(std::max(squares / n - stats.mean * stats.mean,
+									  0.0));
+	stats.min = min;
+	stats.max = max;
+	return stats;
+}
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,145 @@
+#include <algorithm>
+
+#include "daq/daqLayout.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+void deinterleaveScalar(const std::int16_t *values, size_t first,
+						const size_t samples, const size_t channels,
+						std::int16_t *const *out) {
+	for (; first < samples; ++first) {
+		const std::int16_t *sample = values + first * channels;
+		for (size_t c = 0; c < channels; ++c) {
+			out[c][first] = sample[c];
+		}
+	}
+}
+
+#ifdef IRIO_X86_SIMD
+// The kernels transpose blocks of 8 samples with unpack instructions
+
+__attribute__((target("ssse3")))
+size_t deinterleave2SSSE3(const std::int16_t *values, const size_t samples,
+						  std::int16_t *const *out) {
+	// Groups the 4 values of each channel in one quadword
+	const __m128i split = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13,
+										2, 3, 6, 7, 10, 11, 14, 15);
+	size_t i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		const __m128i *in = reinterpret_cast<const __m128i*>(values + i * 2);
+		const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(in), split);
+		const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(in + 1), split);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out[0] + i),
+						 _mm_unpacklo_epi64(a, b));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out[1] + i),
+						 _mm_unpackhi_epi64(a, b));
+	}
+	return i;
+}
+
+__attribute__((target("ssse3")))
+size_t deinterleave4SSSE3(const std::int16_t *values, const size_t samples,
+						  std::int16_t *const *out) {
+	size_t i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		const __m128i *in = reinterpret_cast<const __m128i*>(values + i * 4);
+		// Each vector holds 2 samples of the 4 channels
+		const __m128i v0 = _mm_loadu_si128(in);
+		const __m128i v1 = _mm_loadu_si128(in + 1);
+		const __m128i v2 = _mm_loadu_si128(in + 2);
+		const __m128i v3 = _mm_loadu_si128(in + 3);
+		const __m128i a0 = _mm_unpacklo_epi16(v0, v1);
+		const __m128i a1 = _mm_unpackhi_epi16(v0, v1);
+		const __m128i a2 = _mm_unpacklo_epi16(v2, v3);
+		const __m128i a3 = _mm_unpackhi_epi16(v2, v3);
+		// Channels 0 and 1, then 2 and 3, of 4 samples
+		const __m128i b0 = _mm_unpacklo_epi16(a0, a1);
+		const __m128i b1 = _mm_unpackhi_epi16(a0, a1);
+		const __m128i b2 = _mm_unpacklo_epi16(a2, a3);
+		const __m128i b3 = _mm_unpackhi_epi16(a2, a3);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out[0] + i),
+						 _mm_unpacklo_epi64(b0, b2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out[1] + i),
+						 _mm_unpackhi_epi64(b0, b2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out[2] + i),
+						 _mm_unpacklo_epi64(b1, b3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out[3] + i),
+						 _mm_unpackhi_epi64(b1, b3));
+	}
+	return i;
+}
+
+__attribute__((target("ssse3")))
+size_t deinterleave8SSSE3(const std::int16_t *values, const size_t samples,
+						  std::int16_t *const *out) {
+	size_t i = 0;
+	for (; i + 8 <= samples; i += 8) {
+		const __m128i *in = reinterpret_cast<const __m128i*>(values + i * 8);
+		__m128i r[8];
+		for (int j = 0; j < 8; ++j) {
+			r[j] = _mm_loadu_si128(in + j);
+		}
+		// Pairs of samples, then groups of 4, then the 8 samples
+		__m128i a[8], b[8];
+		for (int j = 0; j < 4; ++j) {
+			a[2 * j] = _mm_unpacklo_epi16(r[2 * j], r[2 * j + 1]);
+			a[2 * j + 1] = _mm_unpackhi_epi16(r[2 * j], r[2 * j + 1]);
+		}
+		for (int j = 0; j < 2; ++j) {
+			b[4 * j] = _mm_unpacklo_epi32(a[4 * j], a[4 * j + 2]);
+			b[4 * j + 1] = _mm_unpackhi_epi32(a[4 * j], a[4 * j + 2]);
+			b[4 * j + 2] = _mm_unpacklo_epi32(a[4 * j + 1], a[4 * j + 3]);
+			b[4 * j + 3] = _mm_unpackhi_epi32(a[4 * j + 1], a[4 * j + 3]);
+		}
+		for (int j = 0; j < 4; ++j) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out[2 * j] + i),
+							 _mm_unpacklo_epi64(b[j], b[j + 4]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out[2 * j + 1] + i),
+							 _mm_unpackhi_epi64(b[j], b[j + 4]));
+		}
+	}
+	return i;
+}
+#endif
+
+}  // namespace
+
+size_t getBlockSamples(const size_t elements, const size_t channels) {
+	return channels == 0 ? 0 : elements * 4 / channels;
+}
+
+void deinterleave(const std::uint64_t *words, const size_t samples,
+				  const size_t channels, std::int16_t *const *out,
+				  const SIMDLevel level) {
+	const auto values = reinterpret_cast<const std::int16_t*>(words);
+	size_t done = 0;
+#ifdef IRIO_X86_SIMD
+	if (std::min(level, getSIMDLevel()) >= SIMDLevel::SSSE3) {
+		switch (channels) {
+		case 2:
+			done = deinterleave2SSSE3(values, samples, out);
+			break;
+		case 4:
+			done = deinterleave4SSSE3(values, samples, out);
+			break;
+		case 8:
+			done = deinterleave8SSSE3(values, samples, out);
+			break;
+		default:
+			break;
+		}
+	}
+#endif
+	deinterleaveScalar(values, done, samples, channels, out);
+}
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include "daq/decimation.h"
+#include "errorsIrio.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+/// Values processed by each iteration of the kernels
+const size_t VECTOR_VALUES = 16;
+const std::int16_t SAMPLE_MIN = std::numeric_limits<std::int16_t>::min();
+const std::int16_t SAMPLE_MAX = std::numeric_limits<std::int16_t>::max();
+/// Max ratio of the Average outputs, so the sums of each lane fit in 32 bits
+const size_t MAX_AVERAGE_RATIO = 65536;
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+size_t computeLanes(const size_t channels) {
+	size_t a = channels, b = VECTOR_VALUES;
+	while (b != 0) {
+		const size_t r = a % b;
+		a = b;
+		b = r;
+	}
+	return channels / a * VECTOR_VALUES;
+}
+
+void checkOutput(const DecimationOutput &config) {
+	if (config.ratio == 0) {
+		throw errors::DAQStageError("Decimation ratio must be at least 1");
+	}
+	if (config.mode == DecimationMode::Average &&
+		config.ratio > MAX_AVERAGE_RATIO) {
+		throw errors::DAQStageError(
+			"Decimation ratio of " + std::to_string(config.ratio) +
+			" above the max of " + std::to_string(MAX_AVERAGE_RATIO) +
+			" for Average outputs");
+	}
+	if (config.mode == DecimationMode::CIC) {
+		if (config.order == 0) {
+			throw errors::DAQStageError(
+				"CIC filters require at least one section");
+		}
+		// The registers must hold the input bits plus the gain R^N
+		unsigned ratioBits = 0;
+		while ((static_cast<size_t>(1) << ratioBits) < config.ratio) {
+			ratioBits++;
+		}
+		if (16 + static_cast<size_t>(config.order) * ratioBits > 64) {
+			throw errors::DAQStageError(
+				"CIC filter of order " + std::to_string(config.order) +
+				" and ratio " + std::to_string(config.ratio) +
+				" requires registers above 64 bits");
+		}
+	}
+}
+
+std::int16_t saturate(const double value) {
+	return static_cast<std::int16_t>(std::lround(
+		std::min<double>(std::max<double>(value, SAMPLE_MIN), SAMPLE_MAX)));
+}
+
+/////////////////////////////////////////////////////////////
+/// Window kernels
+/////////////////////////////////////////////////////////////
+
+// The kernels add each value to the lane of its position in the window. They
+// return the lane of the next value
+
+size_t sumScalar(const std::int16_t *values, const size_t count,
+				 std::int32_t *sums, size_t lane, const size_t lanes) {
+	for (size_t i = 0; i < count; ++i) {
+		sums[lane] += values[i];
+		if (++lane == lanes) {
+			lane = 0;
+		}
+	}
+	return lane;
+}
+
+size_t minMaxScalar(const std::int16_t *values, const size_t count,
+					std::int16_t *minimum, std::int16_t *maximum, size_t lane,
+					const size_t lanes) {
+	for (size_t i = 0; i < count; ++i) {
+		minimum[lane] = std::min(minimum[lane], values[i]);
+		maximum[lane] = std::max(maximum[lane], values[i]);
+		if (++lane == lanes) {
+			lane = 0;
+		}
+	}
+	return lane;
+}
+
+#ifdef IRIO_X86_SIMD
+// The vector kernels require a lane multiple of VECTOR_VALUES and return the
+// number of values processed
+
+__attribute__((target("ssse3")))
+size_t sumSSSE3(const std::int16_t *values, const size_t count,
+				std::int32_t *sums, size_t lane, const size_t lanes) {
+	size_t i = 0;
+	for (; i + VECTOR_VALUES <= count; i += VECTOR_VALUES) {
+		const __m128i *in = reinterpret_cast<const __m128i*>(values + i);
+		__m128i *acc = reinterpret_cast<__m128i*>(sums + lane);
+		for (int half = 0; half < 2; ++half) {
+			const __m128i x = _mm_loadu_si128(in + half);
+			// Sign extension without SSE4.1
+			const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+			const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+			_mm_storeu_si128(acc + 2 * half,
+				_mm_add_epi32(_mm_loadu_si128(acc + 2 * half), lo));
+			_mm_storeu_si128(acc + 2 * half + 1,
+				_mm_add_epi32(_mm_loadu_si128(acc + 2 * half + 1), hi));
+		}
+		lane += VECTOR_VALUES;
+		if (lane == lanes) {
+			lane = 0;
+		}
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t sumAVX2(const std::int16_t *values, const size_t count,
+			   std::int32_t *sums, size_t lane, const size_t lanes) {
+	size_t i = 0;
+	for (; i + VECTOR_VALUES <= count; i += VECTOR_VALUES) {
+		const __m256i x =
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+		__m256i *acc = reinterpret_cast<__m256i*>(sums + lane);
+		_mm256_storeu_si256(acc, _mm256_add_epi32(_mm256_loadu_si256(acc),
+			_mm256_cvtepi16_epi32(_mm256_castsi256_si128(x))));
+		_mm256_storeu_si256(acc + 1,
+			_mm256_add_epi32(_mm256_loadu_si256(acc + 1),
+				_mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1))));
+		lane += VECTOR_VALUES;
+		if (lane == lanes) {
+			lane = 0;
+		}
+	}
+	return i;
+}
+
+__attribute__((target("ssse3")))
+size_t minMaxSSSE3(const std::int16_t *values, const size_t count,
+				   std::int16_t *minimum, std::int16_t *maximum, size_t lane,
+				   const size_t lanes) {
+	size_t i = 0;
+	for (; i + VECTOR_VALUES <= count; i += VECTOR_VALUES) {
+		const __m128i *in = reinterpret_cast<const __m128i*>(values + i);
+		__m128i *mn = reinterpret_cast<__m128i*>(minimum + lane);
+		__m128i *mx = reinterpret_cast<__m128i*>(maximum + lane);
+		for (int half = 0; half < 2; ++half) {
+			const __m128i x = _mm_loadu_si128(in + half);
+			_mm_storeu_si128(mn + half,
+							 _mm_min_epi16(_mm_loadu_si128(mn + half), x));
+			_mm_storeu_si128(mx + half,
+							 _mm_max_epi16(_mm_loadu_si128(mx + half), x));
+		}
+		lane += VECTOR_VALUES;
+		if (lane == lanes) {
+			lane = 0;
+		}
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t minMaxAVX2(const std::int16_t *values, const size_t count,
+				  std::int16_t *minimum, std::int16_t *maximum, size_t lane,
+				  const size_t lanes) {
+	size_t i = 0;
+	for (; i + VECTOR_VALUES <= count; i += VECTOR_VALUES) {
+		const __m256i x =
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+		__m256i *mn = reinterpret_cast<__m256i*>(minimum + lane);
+		__m256i *mx = reinterpret_cast<__m256i*>(maximum + lane);
+		_mm256_storeu_si256(mn, _mm256_min_epi16(_mm256_loadu_si256(mn), x));
+		_mm256_storeu_si256(mx, _mm256_max_epi16(_mm256_loadu_si256(mx), x));
+		lane += VECTOR_VALUES;
+		if (lane == lanes) {
+			lane = 0;
+		}
+	}
+	return i;
+}
+#endif
+
+}  // namespace
+
+DecimationStage::DecimationStage(const size_t channels,
+								 const std::vector<DecimationOutput> &outputs)
+	: m_channels(checkChannels(channels)), m_lanes(computeLanes(channels)) {
+	if (outputs.empty()) {
+		throw errors::DAQStageError("At least one output must be configured");
+	}
+
+	for (const auto &config : outputs) {
+		checkOutput(config);
+		OutputState state;
+		state.config = config;
+		state.window = config.ratio * m_channels;
+		state.gain = 1.0;
+		switch (config.mode) {
+		case DecimationMode::Average:
+			state.sums.resize(m_lanes);
+			break;
+		case DecimationMode::MinMax:
+			state.minimum.resize(m_lanes);
+			state.maximum.resize(m_lanes);
+			break;
+		case DecimationMode::CIC:
+			state.integrators.resize(config.order * m_channels);
+			state.combs.resize(config.order * m_channels);
+			state.gain = std::pow(static_cast<double>(config.ratio),
+								  -static_cast<double>(config.order));
+			break;
+		}
+		m_outputs.push_back(std::move(state));
+	}
+	reset();
+}
+
+void DecimationStage::process(const std::uint64_t *words,
+							  const size_t elements, const SIMDLevel level) {
+	const auto values = reinterpret_cast<const std::int16_t*>(words);
+	const size_t count = elements * 4;
+
+	for (auto &state : m_outputs) {
+		state.values.clear();
+		size_t i = 0;
+		while (i < count) {
+			const size_t take =
+				std::min(count - i, state.window - state.position);
+			accumulate(&state, values + i, take, level);
+			state.position += take;
+			i += take;
+			if (state.position == state.window) {
+				emit(&state);
+				clearWindow(&state);
+			}
+		}
+	}
+}
+
+const std::vector<std::int16_t> &DecimationStage::getOutput(
+	const size_t output) const {
+	if (output >= m_outputs.size()) {
+		throw errors::DAQStageError("Output " + std::to_string(output) +
+									" does not exist");
+	}
+	return m_outputs[output].values;
+}
+
+size_t DecimationStage::getOutputSamples(const size_t output) const {
+	const auto &values = getOutput(output);
+	const size_t perSample =
+		m_outputs[output].config.mode == DecimationMode::MinMax
+			? 2 * m_channels
+			: m_channels;
+	return values.size() / perSample;
+}
+
+size_t DecimationStage::getNumOutputs() const {
+	return m_outputs.size();
+}
+
+size_t DecimationStage::getChannels() const {
+	return m_channels;
+}
+
+void DecimationStage::reset() {
+	for (auto &state : m_outputs) {
+		clearWindow(&state);
+		std::fill(state.integrators.begin(), state.integrators.end(), 0);
+		std::fill(state.combs.begin(), state.combs.end(), 0);
+		state.values.clear();
+	}
+}
+
+void DecimationStage::accumulate(OutputState *state,
+								 const std::int16_t *values,
+								 const size_t count,
+								 const SIMDLevel level) const {
+	if (state->config.mode == DecimationMode::CIC) {
+		const size_t order = state->config.order;
+		size_t channel = state->position % m_channels;
+		for (size_t i = 0; i < count; ++i) {
+			// Wraps around on overflow, the combs cancel it
+			std::uint64_t x = static_cast<std::uint64_t>(
+				static_cast<std::int64_t>(values[i]));
+			std::uint64_t *integrator = state->integrators.data() + channel;
+			for (size_t k = 0; k < order; ++k) {
+				integrator[k * m_channels] += x;
+				x = integrator[k * m_channels];
+			}
+			if (++channel == m_channels) {
+				channel = 0;
+			}
+		}
+		return;
+	}
+
+	const bool average = state->config.mode == DecimationMode::Average;
+	size_t lane = state->position % m_lanes;
+
+	// Up to the first lane where a vector starts
+	const size_t head =
+		std::min(count, (VECTOR_VALUES - lane % VECTOR_VALUES) % VECTOR_VALUES);
+	lane = average ? sumScalar(values, head, state->sums.data(), lane, m_lanes)
+				   : minMaxScalar(values, head, state->minimum.data(),
+								  state->maximum.data(), lane, m_lanes);
+
+	size_t done = head;
+#ifdef IRIO_X86_SIMD
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	size_t vectors = 0;
+	if (used == SIMDLevel::AVX2) {
+		vectors = average
+					  ? sumAVX2(values + done, count - done,
+								state->sums.data(), lane, m_lanes)
+					  : minMaxAVX2(values + done, count - done,
+								   state->minimum.data(),
+								   state->maximum.data(), lane, m_lanes);
+	} else if (used == SIMDLevel::SSSE3) {
+		vectors = average
+					  ? sumSSSE3(values + done, count - done,
+								 state->sums.data(), lane, m_lanes)
+					  : minMaxSSSE3(values + done, count - done,
+									state->minimum.data(),
+									state->maximum.data(), lane, m_lanes);
+	}
+	done += vectors;
+	lane = (lane + vectors) % m_lanes;
+#else
+	static_cast<void>(level);
+#endif
+
+	if (average) {
+		sumScalar(values + done, count - done, state->sums.data(), lane,
+				  m_lanes);
+	} else {
+		minMaxScalar(values + done, count - done, state->minimum.data(),
+					 state->maximum.data(), lane, m_lanes);
+	}
+}
+
+void DecimationStage::emit(OutputState *state) const {
+	auto &out = state->values;
+	switch (state->config.mode) {
+	case DecimationMode::Average:
+		for (size_t c = 0; c < m_channels; ++c) {
+			std::int64_t sum = 0;
+			for (size_t lane = c; lane < m_lanes; lane += m_channels) {
+				sum += state->sums[lane];
+			}
+			out.push_back(saturate(static_cast<double>(sum) /
+								   state->config.ratio));
+		}
+		break;
+	case DecimationMode::MinMax:
+		for (size_t c = 0; c < m_channels; ++c) {
+			std::int16_t minimum = SAMPLE_MAX;
+			std::int16_t maximum = SAMPLE_MIN;
+			for (size_t lane = c; lane < m_lanes; lane += m_channels) {
+				minimum = std::min(minimum, state->minimum[lane]);
+				maximum = std::max(maximum, state->maximum[lane]);
+			}
+			out.push_back(minimum);
+			out.push_back(maximum);
+		}
+		break;
+	case DecimationMode::CIC: {
+		const size_t order = state->config.order;
+		for (size_t c = 0; c < m_channels; ++c) {
+			std::uint64_t y = state->integrators[(order - 1) * m_channels + c];
+			for (size_t k = 0; k < order; ++k) {
+				std::uint64_t &delay = state->combs[k * m_channels + c];
+				const std::uint64_t previous = delay;
+				delay = y;
+				y -= previous;
+			}
+			out.push_back(saturate(static_cast<std::int64_t>(y) * state->gain));
+		}
+		break;
+	}
+	}
+}
+
+void DecimationStage::clearWindow(OutputState *state) const {
+	state->position = 0;
+	std::fill(state->sums.begin(), state->sums.end(), 0);
+	std::fill(state->minimum.begin(), state->minimum.end(), SAMPLE_MAX);
+	std::fill(state->maximum.begin(), state->maximum.end(), SAMPLE_MIN);
+}
+
+}  // namespace daq
+}  // namespace irio
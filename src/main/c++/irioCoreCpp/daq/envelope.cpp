@@ -0,0 +1,590 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "daq/envelope.h"
+#include "errorsIrio.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+const char DESCRIPTOR_MAGIC[8] = {'I', 'R', 'I', 'O', 'E', 'N', 'V', '\0'};
+const std::uint32_t DESCRIPTOR_VERSION = 1;
+const size_t MAX_LEVELS = 8;
+/// Bytes of points of the first level buffered before writing them
+const size_t PENDING_BYTES = 256 * 1024;
+/// Points of a level read at once
+const size_t READ_POINTS = 16384;
+
+const EnvelopePoint EMPTY_POINT = {std::numeric_limits<std::int16_t>::max(),
+								   std::numeric_limits<std::int16_t>::min()};
+
+/// Layout of the descriptor file
+struct Descriptor {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t channels;
+	std::uint32_t levels;
+	std::uint32_t reserved;
+	/// Samples of each channel covered by the points written
+	std::uint64_t samples;
+	std::uint64_t decimations[MAX_LEVELS];
+	std::uint64_t points[MAX_LEVELS];
+};
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+std::vector<size_t> checkDecimations(const std::vector<size_t> &decimations) {
+	if (decimations.empty() || decimations.size() > MAX_LEVELS) {
+		throw errors::DAQStageError("Envelopes require between 1 and " +
+									std::to_string(MAX_LEVELS) + " levels");
+	}
+	size_t previous = 1;
+	for (const auto decimation : decimations) {
+		if (decimation <= previous || decimation % previous != 0) {
+			throw errors::DAQStageError(
+				"Decimation " + std::to_string(decimation) +
+				" is not a multiple greater than " + std::to_string(previous));
+		}
+		previous = decimation;
+	}
+	return decimations;
+}
+
+void writeAll(const int fd, const void *data, const size_t bytes,
+			  const std::string &path) {
+	const char *p = static_cast<const char*>(data);
+	size_t done = 0;
+	while (done < bytes) {
+		const ssize_t n = ::write(fd, p + done, bytes - done);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0) {
+			throw errors::RecordingError("Unable to write " + path + ": " +
+										 strerror(errno));
+		}
+		done += static_cast<size_t>(n);
+	}
+}
+
+void readAll(const int fd, void *data, const size_t bytes,
+			 const std::uint64_t offset, const std::string &path) {
+	char *p = static_cast<char*>(data);
+	size_t done = 0;
+	while (done < bytes) {
+		const ssize_t n = pread(fd, p + done, bytes - done,
+								static_cast<off_t>(offset + done));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0) {
+			throw errors::RecordingError("Unable to read " + path + ": " +
+										 strerror(errno));
+		}
+		if (n == 0) {
+			throw errors::RecordingError("Unexpected end of " + path);
+		}
+		done += static_cast<size_t>(n);
+	}
+}
+
+/////////////////////////////////////////////////////////////
+/// Envelope kernels
+/////////////////////////////////////////////////////////////
+
+// The kernels compute the points of whole groups of interleaved samples,
+// starting with the group first, and return the number of groups done. The
+// vector kernels keep the min/max of each position of the vector, which
+// belongs to the same channel in every vector when the channels divide it
+
+void addScalar(const std::int16_t *values, const size_t count,
+			   const size_t channels, EnvelopePoint *point) {
+	size_t c = 0;
+	for (size_t i = 0; i < count; ++i) {
+		point[c].min = std::min(point[c].min, values[i]);
+		point[c].max = std::max(point[c].max, values[i]);
+		c = c + 1 == channels ? 0 : c + 1;
+	}
+}
+
+void envelopeScalar(const std::int16_t *values, const size_t first,
+					const size_t groups, const size_t groupValues,
+					const size_t channels, EnvelopePoint *points) {
+	for (size_t g = first; g < groups; ++g) {
+		EnvelopePoint *point = points + g * channels;
+		std::fill(point, point + channels, EMPTY_POINT);
+		addScalar(values + g * groupValues, groupValues, channels, point);
+	}
+}
+
+#ifdef IRIO_X86_SIMD
+/**
+ * Folds the min/max of the 8 positions of a vector into the channels
+ */
+__attribute__((target("ssse3")))
+void foldPositions(__m128i mins, __m128i maxs, const size_t channels,
+				   EnvelopePoint *point) {
+	if (channels <= 4) {
+		mins = _mm_min_epi16(mins, _mm_srli_si128(mins, 8));
+		maxs = _mm_max_epi16(maxs, _mm_srli_si128(maxs, 8));
+	}
+	if (channels <= 2) {
+		mins = _mm_min_epi16(mins, _mm_srli_si128(mins, 4));
+		maxs = _mm_max_epi16(maxs, _mm_srli_si128(maxs, 4));
+	}
+	if (channels == 1) {
+		mins = _mm_min_epi16(mins, _mm_srli_si128(mins, 2));
+		maxs = _mm_max_epi16(maxs, _mm_srli_si128(maxs, 2));
+	}
+	std::int16_t lo[8], hi[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(lo), mins);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(hi), maxs);
+	for (size_t c = 0; c < channels; ++c) {
+		point[c].min = lo[c];
+		point[c].max = hi[c];
+	}
+}
+
+__attribute__((target("ssse3")))
+size_t envelopeSSSE3(const std::int16_t *values, const size_t groups,
+					 const size_t groupValues, const size_t channels,
+					 EnvelopePoint *points) {
+	for (size_t g = 0; g < groups; ++g) {
+		const std::int16_t *x = values + g * groupValues;
+		__m128i mins = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));
+		__m128i maxs = mins;
+		for (size_t i = 8; i < groupValues; i += 8) {
+			const __m128i v =
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+			mins = _mm_min_epi16(mins, v);
+			maxs = _mm_max_epi16(maxs, v);
+		}
+		foldPositions(mins, maxs, channels, points + g * channels);
+	}
+	return groups;
+}
+
+__attribute__((target("avx2")))
+size_t envelopeAVX2(const std::int16_t *values, const size_t groups,
+					const size_t groupValues, const size_t channels,
+					EnvelopePoint *points) {
+	for (size_t g = 0; g < groups; ++g) {
+		const std::int16_t *x = values + g * groupValues;
+		__m256i mins =
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x));
+		__m256i maxs = mins;
+		for (size_t i = 16; i < groupValues; i += 16) {
+			const __m256i v =
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+			mins = _mm256_min_epi16(mins, v);
+			maxs = _mm256_max_epi16(maxs, v);
+		}
+		// Both halves hold the same positions
+		foldPositions(_mm_min_epi16(_mm256_castsi256_si128(mins),
+									_mm256_extracti128_si256(mins, 1)),
+					  _mm_max_epi16(_mm256_castsi256_si128(maxs),
+									_mm256_extracti128_si256(maxs, 1)),
+					  channels, points + g * channels);
+	}
+	return groups;
+}
+#endif
+
+}  // namespace
+
+EnvelopeBuilder::EnvelopeBuilder(const std::string &rawPath,
+								 const size_t channels,
+								 const std::vector<size_t> &decimations)
+	: m_rawPath(rawPath), m_channels(checkChannels(channels)),
+	  m_decimations(checkDecimations(decimations)), m_descriptorFd(-1),
+	  m_position(0), m_closed(false) {
+	size_t previous = 1;
+	for (const auto decimation : m_decimations) {
+		Level level;
+		level.ratio = decimation / previous;
+		level.current.assign(m_channels, EMPTY_POINT);
+		level.filled = 0;
+		level.written = 0;
+		level.fd = -1;
+		m_levels.push_back(level);
+		previous = decimation;
+	}
+
+	try {
+		for (size_t k = 0; k < m_levels.size(); ++k) {
+			const std::string path = getLevelPath(m_rawPath, m_decimations[k]);
+			m_levels[k].fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY,
+								  0644);
+			if (m_levels[k].fd < 0) {
+				throw errors::RecordingError("Unable to create " + path + ": " +
+											 strerror(errno));
+			}
+		}
+		const std::string path = getDescriptorPath(m_rawPath);
+		m_descriptorFd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+		if (m_descriptorFd < 0) {
+			throw errors::RecordingError("Unable to create " + path + ": " +
+										 strerror(errno));
+		}
+		writeDescriptor();
+	} catch (const errors::RecordingError &) {
+		closeFiles();
+		throw;
+	}
+}
+
+EnvelopeBuilder::~EnvelopeBuilder() {
+	try {
+		close();
+	} catch (const errors::RecordingError &) {
+	}
+}
+
+void EnvelopeBuilder::process(const std::uint64_t *words,
+							  const size_t elements, const SIMDLevel level) {
+	if (m_closed) {
+		throw errors::DAQStageError("Envelopes of " + m_rawPath +
+									" already closed");
+	}
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	const auto values = reinterpret_cast<const std::int16_t*>(words);
+	const size_t samples = getBlockSamples(elements, m_channels);
+	Level &first = m_levels[0];
+	const size_t decimation = first.ratio;
+
+	// Completes the point in progress
+	size_t n = 0;
+	if (first.filled > 0) {
+		n = std::min(samples, decimation - first.filled);
+		addScalar(values, n * m_channels, m_channels, first.current.data());
+		first.filled += n;
+		if (first.filled == decimation) {
+			completePoint(0);
+		}
+	}
+
+	// Whole points, computed in place in the points pending
+	const size_t groups = (samples - n) / decimation;
+	if (groups > 0) {
+		const size_t offset = first.pending.size();
+		first.pending.resize(offset + groups * m_channels);
+		EnvelopePoint *points = first.pending.data() + offset;
+		const std::int16_t *x = values + n * m_channels;
+		const size_t groupValues = decimation * m_channels;
+		size_t done = 0;
+#ifdef IRIO_X86_SIMD
+		const bool vectors = m_channels == 1 || m_channels == 2 ||
+							 m_channels == 4 || m_channels == 8;
+		if (vectors && used == SIMDLevel::AVX2 && groupValues % 16 == 0) {
+			done = envelopeAVX2(x, groups, groupValues, m_channels, points);
+		} else if (vectors && used >= SIMDLevel::SSSE3 &&
+				   groupValues % 8 == 0) {
+			done = envelopeSSSE3(x, groups, groupValues, m_channels, points);
+		}
+#else
+		static_cast<void>(used);
+#endif
+		envelopeScalar(x, done, groups, groupValues, m_channels, points);
+		if (m_levels.size() > 1) {
+			for (size_t g = 0; g < groups; ++g) {
+				merge(1, first.pending.data() + offset + g * m_channels);
+			}
+		}
+		n += groups * decimation;
+	}
+
+	// Starts the next point with the rest
+	if (n < samples) {
+		addScalar(values + n * m_channels, (samples - n) * m_channels,
+				  m_channels, first.current.data());
+		first.filled = samples - n;
+	}
+	m_position += samples;
+
+	if (first.pending.size() * sizeof(EnvelopePoint) >= PENDING_BYTES) {
+		flush();
+	}
+}
+
+void EnvelopeBuilder::flush() {
+	if (m_descriptorFd < 0) {
+		return;
+	}
+	for (auto &level : m_levels) {
+		writePending(&level);
+	}
+	writeDescriptor();
+}
+
+void EnvelopeBuilder::close() {
+	if (m_closed) {
+		return;
+	}
+	m_closed = true;
+	for (size_t k = 0; k < m_levels.size(); ++k) {
+		if (m_levels[k].filled > 0) {
+			completePoint(k);
+		}
+	}
+	try {
+		flush();
+	} catch (const errors::RecordingError &) {
+		closeFiles();
+		throw;
+	}
+	closeFiles();
+}
+
+std::uint64_t EnvelopeBuilder::getPosition() const {
+	return m_position;
+}
+
+size_t EnvelopeBuilder::getChannels() const {
+	return m_channels;
+}
+
+const std::vector<size_t> &EnvelopeBuilder::getDecimations() const {
+	return m_decimations;
+}
+
+std::string EnvelopeBuilder::getDescriptorPath(const std::string &rawPath) {
+	return rawPath + ".env";
+}
+
+std::string EnvelopeBuilder::getLevelPath(const std::string &rawPath,
+										  const size_t decimation) {
+	return rawPath + ".env." + std::to_string(decimation);
+}
+
+void EnvelopeBuilder::completePoint(const size_t level) {
+	Level &l = m_levels[level];
+	l.pending.insert(l.pending.end(), l.current.begin(), l.current.end());
+	std::fill(l.current.begin(), l.current.end(), EMPTY_POINT);
+	l.filled = 0;
+	if (level + 1 < m_levels.size()) {
+		merge(level + 1, l.pending.data() + l.pending.size() - m_channels);
+	}
+}
+
+void EnvelopeBuilder::merge(const size_t level, const EnvelopePoint *point) {
+	Level &l = m_levels[level];
+	for (size_t c = 0; c < m_channels; ++c) {
+		l.current[c].min = std::min(l.current[c].min, point[c].min);
+		l.current[c].max = std::max(l.current[c].max, point[c].max);
+	}
+	if (++l.filled == l.ratio) {
+		completePoint(level);
+	}
+}
+
+void EnvelopeBuilder::writePending(Level *level) {
+	if (level->pending.empty()) {
+		return;
+	}
+	const size_t decimation = m_decimations[level - m_levels.data()];
+	writeAll(level->fd, level->pending.data(),
+			 level->pending.size() * sizeof(EnvelopePoint),
+			 getLevelPath(m_rawPath, decimation));
+	level->written += level->pending.size() / m_channels;
+	level->pending.clear();
+}
+
+void EnvelopeBuilder::writeDescriptor() {
+	Descriptor descriptor;
+	std::memset(&descriptor, 0, sizeof(descriptor));
+	std::memcpy(descriptor.magic, DESCRIPTOR_MAGIC, sizeof(DESCRIPTOR_MAGIC));
+	descriptor.version = DESCRIPTOR_VERSION;
+	descriptor.channels = static_cast<std::uint32_t>(m_channels);
+	descriptor.levels = static_cast<std::uint32_t>(m_levels.size());
+	// Until closed, only complete points are written
+	descriptor.samples = m_closed ? m_position
+								  : m_levels[0].written * m_decimations[0];
+	for (size_t k = 0; k < m_levels.size(); ++k) {
+		descriptor.decimations[k] = m_decimations[k];
+		descriptor.points[k] = m_levels[k].written;
+	}
+	const std::string path = getDescriptorPath(m_rawPath);
+	if (pwrite(m_descriptorFd, &descriptor, sizeof(descriptor), 0) !=
+		static_cast<ssize_t>(sizeof(descriptor))) {
+		throw errors::RecordingError("Unable to write " + path + ": " +
+									 strerror(errno));
+	}
+}
+
+void EnvelopeBuilder::closeFiles() {
+	for (auto &level : m_levels) {
+		if (level.fd >= 0) {
+			::close(level.fd);
+			level.fd = -1;
+		}
+	}
+	if (m_descriptorFd >= 0) {
+		::close(m_descriptorFd);
+		m_descriptorFd = -1;
+	}
+}
+
+EnvelopeReader::EnvelopeReader(const std::string &rawPath)
+	: m_rawPath(rawPath), m_channels(0), m_samples(0) {
+	const std::string path = EnvelopeBuilder::getDescriptorPath(m_rawPath);
+	m_descriptorFd = open(path.c_str(), O_RDONLY);
+	if (m_descriptorFd < 0) {
+		throw errors::RecordingError("Unable to open " + path + ": " +
+									 strerror(errno));
+	}
+	try {
+		refresh();
+	} catch (const errors::RecordingError &) {
+		for (const auto fd : m_fds) {
+			close(fd);
+		}
+		close(m_descriptorFd);
+		throw;
+	}
+}
+
+EnvelopeReader::~EnvelopeReader() {
+	for (const auto fd : m_fds) {
+		close(fd);
+	}
+	close(m_descriptorFd);
+}
+
+void EnvelopeReader::refresh() {
+	const std::string path = EnvelopeBuilder::getDescriptorPath(m_rawPath);
+	Descriptor descriptor;
+	readAll(m_descriptorFd, &descriptor, sizeof(descriptor), 0, path);
+	if (std::memcmp(descriptor.magic, DESCRIPTOR_MAGIC,
+					sizeof(DESCRIPTOR_MAGIC)) != 0 ||
+		descriptor.version != DESCRIPTOR_VERSION ||
+		descriptor.channels == 0 || descriptor.levels == 0 ||
+		descriptor.levels > MAX_LEVELS) {
+		throw errors::RecordingError(path + " is not a valid descriptor");
+	}
+
+	if (m_fds.empty()) {
+		m_channels = descriptor.channels;
+		for (size_t k = 0; k < descriptor.levels; ++k) {
+			const size_t decimation =
+				static_cast<size_t>(descriptor.decimations[k]);
+			if (decimation == 0) {
+				throw errors::RecordingError(path +
+											 " is not a valid descriptor");
+			}
+			const std::string levelPath =
+				EnvelopeBuilder::getLevelPath(m_rawPath, decimation);
+			const int fd = open(levelPath.c_str(), O_RDONLY);
+			if (fd < 0) {
+				throw errors::RecordingError("Unable to open " + levelPath +
+											 ": " + strerror(errno));
+			}
+			m_fds.push_back(fd);
+			m_decimations.push_back(decimation);
+		}
+	} else if (descriptor.channels != m_channels ||
+			   descriptor.levels != m_decimations.size()) {
+		throw errors::RecordingError(path + " changed its layout");
+	}
+	m_samples = descriptor.samples;
+	m_points.assign(descriptor.points, descriptor.points + descriptor.levels);
+}
+
+std::uint64_t EnvelopeReader::read(const size_t channel,
+								   const std::uint64_t firstSample,
+								   const std::uint64_t samples,
+								   const size_t maxPoints,
+								   std::vector<EnvelopePoint> *points,
+								   std::uint64_t *start) const {
+	if (channel >= m_channels) {
+		throw errors::DAQStageError("Channel " + std::to_string(channel) +
+									" not found");
+	}
+	if (maxPoints == 0) {
+		throw errors::DAQStageError("At least one point has to be read");
+	}
+	points->clear();
+	*start = firstSample;
+	if (firstSample >= m_samples) {
+		return m_decimations[0];
+	}
+	const std::uint64_t last =
+		firstSample + std::min(samples, m_samples - firstSample);
+
+	// Coarsest level with the resolution requested whose points cover the
+	// range. The first level covers all the samples available
+	size_t k = 0;
+	for (size_t l = 1; l < m_decimations.size(); ++l) {
+		if ((last - firstSample) / maxPoints >= m_decimations[l] &&
+			m_points[l] * m_decimations[l] >= last) {
+			k = l;
+		}
+	}
+	const std::uint64_t decimation = m_decimations[k];
+	const std::uint64_t firstPoint = firstSample / decimation;
+	const std::uint64_t lastPoint =
+		std::min((last + decimation - 1) / decimation, m_points[k]);
+	*start = firstPoint * decimation;
+	if (lastPoint <= firstPoint) {
+		return decimation;
+	}
+
+	// Points of the level merged into each point returned
+	const std::uint64_t merged =
+		(lastPoint - firstPoint + maxPoints - 1) / maxPoints;
+	points->assign((lastPoint - firstPoint + merged - 1) / merged, EMPTY_POINT);
+	const std::string path = EnvelopeBuilder::getLevelPath(m_rawPath,
+														   decimation);
+	std::vector<EnvelopePoint> buffer(READ_POINTS * m_channels);
+	for (std::uint64_t p = firstPoint; p < lastPoint; p += READ_POINTS) {
+		const size_t count =
+			static_cast<size_t>(std::min<std::uint64_t>(READ_POINTS,
+														lastPoint - p));
+		readAll(m_fds[k], buffer.data(),
+				count * m_channels * sizeof(EnvelopePoint),
+				p * m_channels * sizeof(EnvelopePoint), path);
+		for (size_t i = 0; i < count; ++i) {
+			const EnvelopePoint &in = buffer[i * m_channels + channel];
+			EnvelopePoint &out = (*points)[(p + i - firstPoint) / merged];
+			out.min = std::min(out.min, in.min);
+			out.max = std::max(out.max, in.max);
+		}
+	}
+	return decimation * merged;
+}
+
+std::uint64_t EnvelopeReader::getSamples() const {
+	return m_samples;
+}
+
+size_t EnvelopeReader::getChannels() const {
+	return m_channels;
+}
+
+const std::vector<size_t> &EnvelopeReader::getDecimations() const {
+	return m_decimations;
+}
+
+const std::vector<std::uint64_t> &EnvelopeReader::getPoints() const {
+	return m_points;
+}
+
+}  // namespace daq
+}  // namespace irio
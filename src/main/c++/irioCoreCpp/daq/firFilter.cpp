@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <string>
+
+#include "daq/firFilter.h"
+#include "errorsIrio.h"
+#include "workerPool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+void checkFrequency(const double frequency) {
+	if (!(frequency > 0 && frequency < 0.5)) {
+		throw errors::DAQStageError(
+			"Frequency of " + std::to_string(frequency) +
+			" outside (0, 0.5) times the sampling rate");
+	}
+}
+
+double windowValue(const FIRWindow window, const size_t n, const size_t taps) {
+	if (taps == 1) {
+		return 1.0;
+	}
+	const double x = 2 * PI * n / (taps - 1);
+	switch (window) {
+	case FIRWindow::Hamming:
+		return 0.54 - 0.46 * std::cos(x);
+	case FIRWindow::Blackman:
+		return 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2 * x);
+	case FIRWindow::Rectangular:
+	default:
+		return 1.0;
+	}
+}
+
+/**
+ * Windowed sinc with unit gain at DC, in double precision
+ */
+std::vector<double> lowPass(const size_t taps, const double cutoff,
+							const FIRWindow window) {
+	if (taps == 0) {
+		throw errors::DAQStageError("FIR filters require at least one tap");
+	}
+	checkFrequency(cutoff);
+
+	std::vector<double> h(taps);
+	const double center = (taps - 1) / 2.0;
+	double sum = 0;
+	for (size_t n = 0; n < taps; ++n) {
+		const double x = 2 * PI * cutoff * (n - center);
+		h[n] = (x == 0 ? 2 * cutoff : std::sin(x) / (PI * (n - center))) *
+			   windowValue(window, n, taps);
+		sum += h[n];
+	}
+	for (auto &v : h) {
+		v /= sum;
+	}
+	return h;
+}
+
+std::vector<float> toFloat(const std::vector<double> &h) {
+	return std::vector<float>(h.begin(), h.end());
+}
+
+std::vector<float> reverse(const std::vector<float> &coefficients) {
+	if (coefficients.empty()) {
+		throw errors::DAQStageError("FIR filters require at least one tap");
+	}
+	return std::vector<float>(coefficients.rbegin(), coefficients.rend());
+}
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+size_t checkDecimation(const size_t decimation) {
+	if (decimation == 0) {
+		throw errors::DAQStageError("Decimation must be at least 1");
+	}
+	return decimation;
+}
+
+/////////////////////////////////////////////////////////////
+/// Convolution kernels
+/////////////////////////////////////////////////////////////
+
+// The output p is the dot product of the reversed coefficients with the
+// samples from p. The kernels without decimation accumulate the taps in
+// order in every lane, as the scalar one, so all give the same result
+
+float dotScalar(const float *coefficients, const float *samples,
+				const size_t taps) {
+	float acc = 0;
+	for (size_t j = 0; j < taps; ++j) {
+		acc += coefficients[j] * samples[j];
+	}
+	return acc;
+}
+
+#ifdef IRIO_X86_SIMD
+__attribute__((target("ssse3")))
+size_t convolveSSSE3(const float *coefficients, const size_t taps,
+					 const float *samples, const size_t outputs, float *out) {
+	size_t p = 0;
+	for (; p + 16 <= outputs; p += 16) {
+		__m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+		__m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+		const float *s = samples + p;
+		for (size_t j = 0; j < taps; ++j) {
+			const __m128 c = _mm_set1_ps(coefficients[j]);
+			acc0 = _mm_add_ps(acc0, _mm_mul_ps(c, _mm_loadu_ps(s + j)));
+			acc1 = _mm_add_ps(acc1, _mm_mul_ps(c, _mm_loadu_ps(s + j + 4)));
+			acc2 = _mm_add_ps(acc2, _mm_mul_ps(c, _mm_loadu_ps(s + j + 8)));
+			acc3 = _mm_add_ps(acc3, _mm_mul_ps(c, _mm_loadu_ps(s + j + 12)));
+		}
+		_mm_storeu_ps(out + p, acc0);
+		_mm_storeu_ps(out + p + 4, acc1);
+		_mm_storeu_ps(out + p + 8, acc2);
+		_mm_storeu_ps(out + p + 12, acc3);
+	}
+	for (; p + 4 <= outputs; p += 4) {
+		__m128 acc = _mm_setzero_ps();
+		for (size_t j = 0; j < taps; ++j) {
+			acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(coefficients[j]),
+											 _mm_loadu_ps(samples + p + j)));
+		}
+		_mm_storeu_ps(out + p, acc);
+	}
+	return p;
+}
+
+__attribute__((target("avx2")))
+size_t convolveAVX2(const float *coefficients, const size_t taps,
+					const float *samples, const size_t outputs, float *out) {
+	size_t p = 0;
+	for (; p + 32 <= outputs; p += 32) {
+		__m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+		__m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+		const float *s = samples + p;
+		for (size_t j = 0; j < taps; ++j) {
+			const __m256 c = _mm256_set1_ps(coefficients[j]);
+			acc0 = _mm256_add_ps(acc0,
+								 _mm256_mul_ps(c, _mm256_loadu_ps(s + j)));
+			acc1 = _mm256_add_ps(acc1,
+								 _mm256_mul_ps(c, _mm256_loadu_ps(s + j + 8)));
+			acc2 = _mm256_add_ps(acc2,
+								 _mm256_mul_ps(c, _mm256_loadu_ps(s + j + 16)));
+			acc3 = _mm256_add_ps(acc3,
+								 _mm256_mul_ps(c, _mm256_loadu_ps(s + j + 24)));
+		}
+		_mm256_storeu_ps(out + p, acc0);
+		_mm256_storeu_ps(out + p + 8, acc1);
+		_mm256_storeu_ps(out + p + 16, acc2);
+		_mm256_storeu_ps(out + p + 24, acc3);
+	}
+	for (; p + 8 <= outputs; p += 8) {
+		__m256 acc = _mm256_setzero_ps();
+		for (size_t j = 0; j < taps; ++j) {
+			acc = _mm256_add_ps(acc,
+								_mm256_mul_ps(_mm256_set1_ps(coefficients[j]),
+											  _mm256_loadu_ps(samples + p + j)));
+		}
+		_mm256_storeu_ps(out + p, acc);
+	}
+	return p;
+}
+
+__attribute__((target("ssse3")))
+float dotSSSE3(const float *coefficients, const float *samples,
+			   const size_t taps) {
+	__m128 acc = _mm_setzero_ps();
+	size_t j = 0;
+	for (; j + 4 <= taps; j += 4) {
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(coefficients + j),
+										 _mm_loadu_ps(samples + j)));
+	}
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+	return _mm_cvtss_f32(acc) +
+		   dotScalar(coefficients + j, samples + j, taps - j);
+}
+
+__attribute__((target("avx2")))
+float dotAVX2(const float *coefficients, const float *samples,
+			  const size_t taps) {
+	__m256 acc = _mm256_setzero_ps();
+	size_t j = 0;
+	for (; j + 8 <= taps; j += 8) {
+		acc = _mm256_add_ps(acc,
+							_mm256_mul_ps(_mm256_loadu_ps(coefficients + j),
+										  _mm256_loadu_ps(samples + j)));
+	}
+	__m128 half = _mm_add_ps(_mm256_castps256_ps128(acc),
+							 _mm256_extractf128_ps(acc, 1));
+	half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+	half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+	return _mm_cvtss_f32(half) +
+		   dotScalar(coefficients + j, samples + j, taps - j);
+}
+#endif
+
+}  // namespace
+
+std::vector<float> designLowPass(const size_t taps, const double cutoff,
+								 const FIRWindow window) {
+	return toFloat(lowPass(taps, cutoff, window));
+}
+
+std::vector<float> designHighPass(const size_t taps, const double cutoff,
+								  const FIRWindow window) {
+	if (taps % 2 == 0) {
+		throw errors::DAQStageError(
+			"High-pass FIR filters require an odd number of taps");
+	}
+	auto h = lowPass(taps, cutoff, window);
+	for (auto &v : h) {
+		v = -v;
+	}
+	h[taps / 2] += 1;
+	return toFloat(h);
+}
+
+std::vector<float> designBandPass(const size_t taps, const double low,
+								  const double high,
+								  const FIRWindow window) {
+	if (!(low < high)) {
+		throw errors::DAQStageError("The band must have low < high");
+	}
+	auto h = lowPass(taps, high, window);
+	const auto lower = lowPass(taps, low, window);
+	for (size_t n = 0; n < taps; ++n) {
+		h[n] -= lower[n];
+	}
+
+	// Unit gain at the center of the band
+	const double center = 2 * PI * (low + high) / 2;
+	std::complex<double> gain = 0;
+	for (size_t n = 0; n < taps; ++n) {
+		gain += h[n] * std::polar(1.0, -center * n);
+	}
+	for (auto &v : h) {
+		v /= std::abs(gain);
+	}
+	return toFloat(h);
+}
+
+FIRFilterStage::FIRFilterStage(const size_t channels,
+							   const std::vector<float> &coefficients,
+							   const size_t decimation,
+							   const unsigned threads)
+	: m_channels(checkChannels(channels)), m_reversed(reverse(coefficients)),
+	  m_decimation(checkDecimation(decimation)),
+	  m_threads(std::max(1u, threads)),
+	  m_history(channels, std::vector<float>(coefficients.size() - 1, 0)),
+	  m_phase(0) {}
+
+size_t FIRFilterStage::process(const std::int16_t *const *in,
+							   const size_t samples, float *const *out,
+							   const SIMDLevel level) {
+	const size_t outputs = getOutputSamples(samples);
+	const size_t threads = std::min<size_t>(m_threads, m_channels);
+	if (threads <= 1) {
+		processChannels(in, samples, out, level, 0, m_channels);
+	} else {
+		const size_t block = (m_channels + threads - 1) / threads;
+		WorkerPool::getShared().run(threads, m_threads, [&](const size_t t) {
+			processChannels(in, samples, out, level,
+							std::min(m_channels, t * block),
+							std::min(m_channels, (t + 1) * block));
+		});
+	}
+
+	m_phase = m_phase + outputs * m_decimation - samples;
+	return outputs;
+}
+
+size_t FIRFilterStage::getOutputSamples(const size_t samples) const {
+	return samples > m_phase
+			   ? (samples - m_phase + m_decimation - 1) / m_decimation
+			   : 0;
+}
+
+size_t FIRFilterStage::getChannels() const {
+	return m_channels;
+}
+
+size_t FIRFilterStage::getTaps() const {
+	return m_reversed.size();
+}
+
+size_t FIRFilterStage::getDecimation() const {
+	return m_decimation;
+}
+
+void FIRFilterStage::reset() {
+	for (auto &history : m_history) {
+		std::fill(history.begin(), history.end(), 0);
+	}
+	m_phase = 0;
+}
+
+void FIRFilterStage::processChannels(const std::int16_t *const *in,
+									 const size_t samples, float *const *out,
+									 const SIMDLevel level,
+									 const size_t firstChannel,
+									 const size_t lastChannel) {
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	const size_t taps = m_reversed.size();
+	const float *coefficients = m_reversed.data();
+
+	// Past samples followed by the block, reused between calls
+	static thread_local std::vector<float> work;
+	work.resize(taps - 1 + samples);
+
+	for (size_t c = firstChannel; c < lastChannel; ++c) {
+		auto &history = m_history[c];
+		std::copy(history.begin(), history.end(), work.begin());
+		for (size_t i = 0; i < samples; ++i) {
+			work[taps - 1 + i] = in[c][i];
+		}
+
+		float *y = out[c];
+		if (m_decimation == 1) {
+			size_t done = 0;
+#ifdef IRIO_X86_SIMD
+			if (used == SIMDLevel::AVX2) {
+				done = convolveAVX2(coefficients, taps, work.data(), samples, y);
+			} else if (used == SIMDLevel::SSSE3) {
+				done = convolveSSSE3(coefficients, taps, work.data(), samples,
+									 y);
+			}
+#endif
+			for (; done < samples; ++done) {
+				y[done] = dotScalar(coefficients, work.data() + done, taps);
+			}
+		} else {
+			for (size_t p = m_phase; p < samples; p += m_decimation) {
+				const float *s = work.data() + p;
+#ifdef IRIO_X86_SIMD
+				if (used == SIMDLevel::AVX2) {
+					*y++ = dotAVX2(coefficients, s, taps);
+					continue;
+				} else if (used == SIMDLevel::SSSE3) {
+					*y++ = dotSSSE3(coefficients, s, taps);
+					continue;
+				}
+#endif
+				*y++ = dotScalar(coefficients, s, taps);
+			}
+		}
+#ifndef IRIO_X86_SIMD
+		static_cast<void>(used);
+#endif
+
+		std::copy(work.end() - history.size(), work.end(), history.begin());
+	}
+}
+
+}  // namespace daq
+}  // namespace irio
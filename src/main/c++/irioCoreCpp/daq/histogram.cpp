@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <string>
+
+#include "daq/histogram.h"
+#include "errorsIrio.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+/// Copies of the private bins of the accumulators
+const size_t LANES = 4;
+/// Values whose bins are computed at once
+const size_t CHUNK = 256;
+const size_t MAX_BINS = 1 << 24;
+const std::int32_t MAX_MINIMUM = 1 << 30;
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+size_t checkBins(const size_t bins) {
+	if (bins == 0 || bins > MAX_BINS) {
+		throw errors::DAQStageError("Number of bins " + std::to_string(bins) +
+									" outside [1, 2^24]");
+	}
+	return bins;
+}
+
+std::int32_t checkMinimum(const std::int32_t minimum) {
+	if (minimum < -MAX_MINIMUM || minimum > MAX_MINIMUM) {
+		throw errors::DAQStageError("Histogram minimum " +
+									std::to_string(minimum) +
+									" outside [-2^30, 2^30]");
+	}
+	return minimum;
+}
+
+unsigned checkShift(const unsigned shift) {
+	if (shift > 30) {
+		throw errors::DAQStageError("Histogram shift " +
+									std::to_string(shift) + " above 30");
+	}
+	return shift;
+}
+
+/////////////////////////////////////////////////////////////
+/// Bin kernels
+/////////////////////////////////////////////////////////////
+
+// The bins are numbered from 1, leaving 0 for the underflow and bins + 1
+// for the overflow
+
+std::uint32_t getIndex(const std::int64_t value, const std::int32_t minimum,
+					   const unsigned shift, const std::uint32_t bins) {
+	if (value < minimum) {
+		return 0;
+	}
+	const std::int64_t bin = (value - minimum) >> shift;
+	return bin >= bins ? bins + 1 : static_cast<std::uint32_t>(bin) + 1;
+}
+
+size_t indicesScalar(const std::int16_t *x, const size_t first,
+					 const size_t count, const std::int32_t minimum,
+					 const unsigned shift, const std::uint32_t bins,
+					 std::uint32_t *indices) {
+	for (size_t i = first; i < count; ++i) {
+		indices[i] = getIndex(x[i], minimum, shift, bins);
+	}
+	return count;
+}
+
+#ifdef IRIO_X86_SIMD
+/**
+ * Bins of 4 values. Without SSE4.1 min/max, the limits are applied with
+ * masks
+ */
+__attribute__((target("ssse3")))
+inline __m128i binsSSSE3(const __m128i value, const __m128i low,
+						 const __m128i count32, const __m128i last,
+						 const __m128i over) {
+	const __m128i d = _mm_sub_epi32(value, low);
+	__m128i bin = _mm_add_epi32(_mm_sra_epi32(d, count32), _mm_set1_epi32(1));
+	bin = _mm_andnot_si128(_mm_cmpgt_epi32(_mm_setzero_si128(), d), bin);
+	const __m128i beyond = _mm_cmpgt_epi32(bin, last);
+	return _mm_or_si128(_mm_andnot_si128(beyond, bin),
+						_mm_and_si128(beyond, over));
+}
+
+__attribute__((target("ssse3")))
+size_t indicesSSSE3(const std::int16_t *x, const size_t count,
+					const std::int32_t minimum, const unsigned shift,
+					const std::uint32_t bins, std::uint32_t *indices) {
+	const __m128i low = _mm_set1_epi32(minimum);
+	const __m128i last = _mm_set1_epi32(static_cast<std::int32_t>(bins));
+	const __m128i over = _mm_set1_epi32(static_cast<std::int32_t>(bins + 1));
+	const __m128i count32 = _mm_cvtsi32_si128(static_cast<int>(shift));
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i v =
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+		// Sign extension of the 16 bits values
+		const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i),
+						 binsSSSE3(lo, low, count32, last, over));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i + 4),
+						 binsSSSE3(hi, low, count32, last, over));
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t indicesAVX2(const std::int16_t *x, const size_t count,
+				   const std::int32_t minimum, const unsigned shift,
+				   const std::uint32_t bins, std::uint32_t *indices) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i low = _mm256_set1_epi32(minimum);
+	const __m256i over =
+		_mm256_set1_epi32(static_cast<std::int32_t>(bins + 1));
+	const __m128i count32 = _mm_cvtsi32_si128(static_cast<int>(shift));
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i v = _mm256_cvtepi16_epi32(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+		__m256i bin = _mm256_add_epi32(
+			_mm256_sra_epi32(_mm256_sub_epi32(v, low), count32), one);
+		bin = _mm256_min_epi32(_mm256_max_epi32(bin, zero), over);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(indices + i), bin);
+	}
+	return i;
+}
+#endif
+
+}  // namespace
+
+MCAHistogram::Accumulator::Accumulator(MCAHistogram *histogram,
+									   const size_t mergeInterval)
+	: m_histogram(histogram),
+	  m_mergeInterval(std::min<size_t>(std::max<size_t>(mergeInterval, 1),
+									   static_cast<size_t>(1) << 31)),
+	  m_counts(histogram->m_channels,
+			   std::vector<std::uint32_t>((histogram->m_bins + 2) * LANES, 0)),
+	  m_indices(CHUNK), m_pending(0) {}
+
+MCAHistogram::Accumulator::~Accumulator() {
+	merge();
+}
+
+void MCAHistogram::Accumulator::addSamples(const std::int16_t *const *in,
+										   const size_t samples,
+										   const SIMDLevel level) {
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	const std::int32_t minimum = m_histogram->m_minimum;
+	const unsigned shift = m_histogram->m_shift;
+	const std::uint32_t bins = static_cast<std::uint32_t>(m_histogram->m_bins);
+	std::uint32_t *indices = m_indices.data();
+
+	for (size_t c = 0; c < m_counts.size(); ++c) {
+		std::uint32_t *counts = m_counts[c].data();
+		for (size_t first = 0; first < samples; first += CHUNK) {
+			const std::int16_t *x = in[c] + first;
+			const size_t count = std::min(CHUNK, samples - first);
+			size_t done = 0;
+#ifdef IRIO_X86_SIMD
+			if (used == SIMDLevel::AVX2) {
+				done = indicesAVX2(x, count, minimum, shift, bins, indices);
+			} else if (used == SIMDLevel::SSSE3) {
+				done = indicesSSSE3(x, count, minimum, shift, bins, indices);
+			}
+#else
+			static_cast<void>(used);
+#endif
+			indicesScalar(x, done, count, minimum, shift, bins, indices);
+
+			for (size_t i = 0; i < count; ++i) {
+				++counts[indices[i] * LANES + (i & (LANES - 1))];
+			}
+			m_pending += count;
+			checkMerge();
+		}
+	}
+}
+
+void MCAHistogram::Accumulator::addPulses(const std::vector<Pulse> &pulses) {
+	const std::int32_t minimum = m_histogram->m_minimum;
+	const unsigned shift = m_histogram->m_shift;
+	const std::uint32_t bins = static_cast<std::uint32_t>(m_histogram->m_bins);
+	for (size_t i = 0; i < pulses.size(); ++i) {
+		m_histogram->checkChannel(pulses[i].channel);
+		++m_counts[pulses[i].channel]
+				  [getIndex(pulses[i].amplitude, minimum, shift, bins) * LANES +
+				   (i & (LANES - 1))];
+		++m_pending;
+		checkMerge();
+	}
+}
+
+void MCAHistogram::Accumulator::addValues(const size_t channel,
+										  const std::int32_t *values,
+										  const size_t count) {
+	m_histogram->checkChannel(channel);
+	const std::int32_t minimum = m_histogram->m_minimum;
+	const unsigned shift = m_histogram->m_shift;
+	const std::uint32_t bins = static_cast<std::uint32_t>(m_histogram->m_bins);
+	std::uint32_t *counts = m_counts[channel].data();
+	for (size_t i = 0; i < count; ++i) {
+		++counts[getIndex(values[i], minimum, shift, bins) * LANES +
+				 (i & (LANES - 1))];
+		if ((i & (CHUNK - 1)) == CHUNK - 1) {
+			m_pending += CHUNK;
+			checkMerge();
+		}
+	}
+	m_pending += count & (CHUNK - 1);
+	checkMerge();
+}
+
+void MCAHistogram::Accumulator::merge() {
+	if (m_pending == 0) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(m_histogram->m_mutex);
+	for (size_t c = 0; c < m_counts.size(); ++c) {
+		auto &counts = m_counts[c];
+		auto &merged = m_histogram->m_counts[c];
+		for (size_t b = 0; b < merged.size(); ++b) {
+			const std::uint32_t *lanes = counts.data() + b * LANES;
+			merged[b] += static_cast<std::uint64_t>(lanes[0]) + lanes[1] +
+						 lanes[2] + lanes[3];
+		}
+		std::fill(counts.begin(), counts.end(), 0);
+	}
+	m_pending = 0;
+}
+
+size_t MCAHistogram::Accumulator::getPending() const {
+	return m_pending;
+}
+
+void MCAHistogram::Accumulator::checkMerge() {
+	if (m_pending >= m_mergeInterval) {
+		merge();
+	}
+}
+
+MCAHistogram::MCAHistogram(const size_t channels, const size_t bins,
+						   const std::int32_t minimum, const unsigned shift)
+	: m_channels(checkChannels(channels)), m_bins(checkBins(bins)),
+	  m_minimum(checkMinimum(minimum)), m_shift(checkShift(shift)),
+	  m_counts(channels, std::vector<std::uint64_t>(bins + 2, 0)) {}
+
+void MCAHistogram::getSnapshot(const size_t channel,
+							   HistogramCounts *counts) const {
+	checkChannel(channel);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto &merged = m_counts[channel];
+	counts->bins.assign(merged.begin() + 1, merged.end() - 1);
+	counts->underflow = merged.front();
+	counts->overflow = merged.back();
+}
+
+void MCAHistogram::takeSnapshot(const size_t channel,
+								HistogramCounts *counts) {
+	checkChannel(channel);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto &merged = m_counts[channel];
+	counts->bins.assign(merged.begin() + 1, merged.end() - 1);
+	counts->underflow = merged.front();
+	counts->overflow = merged.back();
+	std::fill(merged.begin(), merged.end(), 0);
+}
+
+void MCAHistogram::reset() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto &merged : m_counts) {
+		std::fill(merged.begin(), merged.end(), 0);
+	}
+}
+
+size_t MCAHistogram::getChannels() const {
+	return m_channels;
+}
+
+size_t MCAHistogram::getBins() const {
+	return m_bins;
+}
+
+std::int32_t MCAHistogram::getMinimum() const {
+	return m_minimum;
+}
+
+unsigned MCAHistogram::getShift() const {
+	return m_shift;
+}
+
+void MCAHistogram::checkChannel(const size_t channel) const {
+	if (channel >= m_channels) {
+		throw errors::DAQStageError("Channel " + std::to_string(channel) +
+									" not found");
+	}
+}
+
+}  // namespace daq
+}  // namespace irio
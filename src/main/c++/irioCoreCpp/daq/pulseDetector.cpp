@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <string>
+
+#include "daq/pulseDetector.h"
+#include "errorsIrio.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+const std::vector<PulseDetectorConfig> &checkConfigs(
+	const std::vector<PulseDetectorConfig> &configs) {
+	if (configs.empty()) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	for (size_t c = 0; c < configs.size(); ++c) {
+		const auto &config = configs[c];
+		const std::string channel = "Channel " + std::to_string(c) + ": ";
+		if (config.threshold < 1 || config.threshold > 32767) {
+			throw errors::DAQStageError(channel +
+										"Threshold outside [1, 32767]");
+		}
+		if (config.trigger == PulseTrigger::Threshold) {
+			if (config.release > config.threshold) {
+				throw errors::DAQStageError(
+					channel + "Release level above the threshold");
+			}
+			const std::int32_t level =
+				config.polarity == PulsePolarity::Positive
+					? config.baseline + config.threshold
+					: config.baseline - config.threshold;
+			if (level < -32768 || level > 32767) {
+				throw errors::DAQStageError(
+					channel + "Threshold level outside the int16 range");
+			}
+		} else if (config.lag == 0) {
+			throw errors::DAQStageError(channel +
+										"Derivative lag must be at least 1");
+		}
+	}
+	return configs;
+}
+
+/**
+ * Past samples required: the previous trigger value for the time of
+ * arrival and the pre samples of the waveforms
+ */
+size_t getHistorySamples(const std::vector<PulseDetectorConfig> &configs) {
+	size_t samples = 1;
+	for (const auto &config : configs) {
+		samples = std::max(samples, config.preSamples);
+		if (config.trigger == PulseTrigger::Derivative) {
+			samples = std::max(samples, config.lag + 1);
+		}
+	}
+	return samples;
+}
+
+std::int32_t getSignal(const PulseDetectorConfig &config,
+					   const std::int16_t value) {
+	const std::int32_t signal = value - config.baseline;
+	return config.polarity == PulsePolarity::Positive ? signal : -signal;
+}
+
+/**
+ * Samples before the first one with a trigger value
+ */
+size_t getTriggerDelay(const PulseDetectorConfig &config) {
+	return config.trigger == PulseTrigger::Derivative ? config.lag : 0;
+}
+
+/////////////////////////////////////////////////////////////
+/// Trigger scan kernels
+/////////////////////////////////////////////////////////////
+
+// The kernels return the first sample in [first, last) meeting the trigger
+// condition or, if none does, the first sample not scanned, as the vector
+// kernels leave the last ones to the scalar one. With the Derivative
+// trigger, first must be at least lag
+
+size_t scanScalar(const PulseDetectorConfig &config, const std::int16_t *x,
+				  const size_t first, const size_t last) {
+	const bool positive = config.polarity == PulsePolarity::Positive;
+	if (config.trigger == PulseTrigger::Threshold) {
+		for (size_t n = first; n < last; ++n) {
+			if (getSignal(config, x[n]) >= config.threshold) {
+				return n;
+			}
+		}
+	} else {
+		for (size_t n = first; n < last; ++n) {
+			const std::int32_t rise = x[n] - x[n - config.lag];
+			if ((positive ? rise : -rise) >= config.threshold) {
+				return n;
+			}
+		}
+	}
+	return last;
+}
+
+#ifdef IRIO_X86_SIMD
+// The signal is compared in 16 bits against the threshold level. The rise
+// of the Derivative trigger saturates, which keeps the comparison valid
+// as the threshold is within the int16 range
+
+__attribute__((target("ssse3")))
+size_t scanSSSE3(const PulseDetectorConfig &config, const std::int16_t *x,
+				 const size_t first, const size_t last) {
+	const bool positive = config.polarity == PulsePolarity::Positive;
+	size_t n = first;
+	int mask = 0;
+	if (config.trigger == PulseTrigger::Threshold) {
+		if (positive) {
+			const __m128i bound = _mm_set1_epi16(static_cast<std::int16_t>(
+				config.baseline + config.threshold - 1));
+			for (; n + 8 <= last; n += 8) {
+				const __m128i v = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(x + n));
+				mask = _mm_movemask_epi8(_mm_cmpgt_epi16(v, bound));
+				if (mask) {
+					break;
+				}
+			}
+		} else {
+			const __m128i bound = _mm_set1_epi16(static_cast<std::int16_t>(
+				config.baseline - config.threshold + 1));
+			for (; n + 8 <= last; n += 8) {
+				const __m128i v = _mm_loadu_si128(
+					reinterpret_cast<const __m128i*>(x + n));
+				mask = _mm_movemask_epi8(_mm_cmpgt_epi16(bound, v));
+				if (mask) {
+					break;
+				}
+			}
+		}
+	} else {
+		// The rise is a - b, reversed for negative pulses
+		const size_t a = positive ? 0 : config.lag;
+		const size_t b = positive ? config.lag : 0;
+		const __m128i bound =
+			_mm_set1_epi16(static_cast<std::int16_t>(config.threshold - 1));
+		for (; n + 8 <= last; n += 8) {
+			const __m128i rise = _mm_subs_epi16(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + n - a)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + n - b)));
+			mask = _mm_movemask_epi8(_mm_cmpgt_epi16(rise, bound));
+			if (mask) {
+				break;
+			}
+		}
+	}
+	return mask ? n + __builtin_ctz(mask) / 2 : n;
+}
+
+__attribute__((target("avx2")))
+size_t scanAVX2(const PulseDetectorConfig &config, const std::int16_t *x,
+				const size_t first, const size_t last) {
+	const bool positive = config.polarity == PulsePolarity::Positive;
+	size_t n = first;
+	unsigned mask = 0;
+	if (config.trigger == PulseTrigger::Threshold) {
+		if (positive) {
+			const __m256i bound = _mm256_set1_epi16(static_cast<std::int16_t>(
+				config.baseline + config.threshold - 1));
+			for (; n + 16 <= last; n += 16) {
+				const __m256i v = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(x + n));
+				mask = static_cast<unsigned>(
+					_mm256_movemask_epi8(_mm256_cmpgt_epi16(v, bound)));
+				if (mask) {
+					break;
+				}
+			}
+		} else {
+			const __m256i bound = _mm256_set1_epi16(static_cast<std::int16_t>(
+				config.baseline - config.threshold + 1));
+			for (; n + 16 <= last; n += 16) {
+				const __m256i v = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(x + n));
+				mask = static_cast<unsigned>(
+					_mm256_movemask_epi8(_mm256_cmpgt_epi16(bound, v)));
+				if (mask) {
+					break;
+				}
+			}
+		}
+	} else {
+		const size_t a = positive ? 0 : config.lag;
+		const size_t b = positive ? config.lag : 0;
+		const __m256i bound = _mm256_set1_epi16(
+			static_cast<std::int16_t>(config.threshold - 1));
+		for (; n + 16 <= last; n += 16) {
+			const __m256i rise = _mm256_subs_epi16(
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(x + n - a)),
+				_mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(x + n - b)));
+			mask = static_cast<unsigned>(
+				_mm256_movemask_epi8(_mm256_cmpgt_epi16(rise, bound)));
+			if (mask) {
+				break;
+			}
+		}
+	}
+	return mask ? n + __builtin_ctz(mask) / 2 : n;
+}
+#endif
+
+size_t scan(const PulseDetectorConfig &config, const std::int16_t *x,
+			const size_t first, const size_t last, const SIMDLevel level) {
+	size_t n = first;
+#ifdef IRIO_X86_SIMD
+	if (level == SIMDLevel::AVX2) {
+		n = scanAVX2(config, x, first, last);
+	} else if (level == SIMDLevel::SSSE3) {
+		n = scanSSSE3(config, x, first, last);
+	}
+#else
+	static_cast<void>(level);
+#endif
+	return scanScalar(config, x, n, last);
+}
+
+}  // namespace
+
+PulseDetectorStage::PulseDetectorStage(
+	const std::vector<PulseDetectorConfig> &channels)
+	: m_historySamples(getHistorySamples(checkConfigs(channels))),
+	  m_position(0), m_detected(0) {
+	m_channels.resize(channels.size());
+	for (size_t c = 0; c < channels.size(); ++c) {
+		m_channels[c].config = channels[c];
+		m_channels[c].pulse.channel = c;
+	}
+	reset();
+}
+
+size_t PulseDetectorStage::process(const std::int16_t *const *in,
+								   const size_t samples,
+								   const SIMDLevel level) {
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	m_pulses.clear();
+	m_waveforms.clear();
+	for (size_t c = 0; c < m_channels.size(); ++c) {
+		processChannel(&m_channels[c], in[c], samples, used);
+	}
+	m_position += samples;
+	return m_pulses.size();
+}
+
+const std::vector<Pulse> &PulseDetectorStage::getPulses() const {
+	return m_pulses;
+}
+
+const std::vector<std::int16_t> &PulseDetectorStage::getWaveforms() const {
+	return m_waveforms;
+}
+
+std::uint64_t PulseDetectorStage::getDetected() const {
+	return m_detected;
+}
+
+std::uint64_t PulseDetectorStage::getPosition() const {
+	return m_position;
+}
+
+size_t PulseDetectorStage::getChannels() const {
+	return m_channels.size();
+}
+
+void PulseDetectorStage::reset() {
+	for (auto &channel : m_channels) {
+		channel.history.assign(m_historySamples, 0);
+		channel.inPulse = false;
+		channel.waveform.clear();
+		channel.pending.clear();
+	}
+	m_position = 0;
+	m_detected = 0;
+	m_pulses.clear();
+	m_waveforms.clear();
+}
+
+void PulseDetectorStage::processChannel(Channel *channel, const std::int16_t *x,
+										const size_t samples,
+										const SIMDLevel level) {
+	const auto &config = channel->config;
+
+	// Post samples of the pulses completed in previous blocks
+	for (auto &pending : channel->pending) {
+		const size_t count = std::min(pending.remaining, samples);
+		pending.waveform.insert(pending.waveform.end(), x, x + count);
+		pending.remaining -= count;
+	}
+	while (!channel->pending.empty() &&
+		   channel->pending.front().remaining == 0) {
+		emit(channel->pending.front().pulse, channel->pending.front().waveform);
+		channel->pending.pop_front();
+	}
+
+	// The first samples of the stream have no trigger value
+	const size_t delay = getTriggerDelay(config);
+	const size_t firstValid =
+		m_position < delay
+			? static_cast<size_t>(std::min<std::uint64_t>(delay - m_position,
+														  samples))
+			: 0;
+	const bool keep = config.preSamples + config.postSamples > 0;
+
+	size_t n = firstValid;
+	while (n < samples) {
+		if (!channel->inPulse) {
+			// With the Derivative trigger, the rise of the first samples
+			// depends on the past ones
+			for (; n < std::min(delay, samples); ++n) {
+				const std::int32_t rise = getSignal(config, x[n]) -
+					getSignal(config,
+							  sample(*channel, x,
+									 static_cast<std::int64_t>(n) -
+										 static_cast<std::int64_t>(delay)));
+				if (rise >= config.threshold) {
+					break;
+				}
+			}
+			if (n >= delay || n == samples) {
+				n = scan(config, x, n, samples, level);
+			}
+			if (n == samples) {
+				break;
+			}
+			startPulse(channel, x, n);
+			++n;
+		}
+
+		for (; n < samples; ++n) {
+			const std::int32_t signal = getSignal(config, x[n]);
+			if (signal < config.release) {
+				break;
+			}
+			auto &pulse = channel->pulse;
+			++pulse.width;
+			pulse.area += signal;
+			if (signal > pulse.amplitude) {
+				pulse.amplitude = signal;
+				pulse.peak = m_position + n;
+			}
+			if (keep) {
+				channel->waveform.push_back(x[n]);
+			}
+		}
+		if (n == samples) {
+			break;
+		}
+		// The sample ending the pulse can start the next one
+		endPulse(channel, x, samples, n);
+	}
+
+	// Keep the last samples for the next block
+	auto &history = channel->history;
+	if (samples >= history.size()) {
+		std::copy(x + samples - history.size(), x + samples, history.begin());
+	} else {
+		std::copy(history.begin() + samples, history.end(), history.begin());
+		std::copy(x, x + samples, history.end() - samples);
+	}
+}
+
+void PulseDetectorStage::startPulse(Channel *channel, const std::int16_t *x,
+									const size_t n) const {
+	const auto &config = channel->config;
+	const std::int64_t i = static_cast<std::int64_t>(n);
+	const std::uint64_t position = m_position + n;
+	const size_t delay = getTriggerDelay(config);
+
+	auto trigger = [&](const std::int64_t k) {
+		const std::int32_t signal = getSignal(config, sample(*channel, x, k));
+		return config.trigger == PulseTrigger::Threshold
+				   ? signal
+				   : signal - getSignal(config,
+										sample(*channel, x,
+											   k - static_cast<std::int64_t>(
+													   delay)));
+	};
+
+	auto &pulse = channel->pulse;
+	pulse.start = position;
+	pulse.timeOfArrival = static_cast<double>(position);
+	if (position > delay) {
+		const std::int32_t previous = trigger(i - 1), current = trigger(i);
+		if (previous < config.threshold) {
+			pulse.timeOfArrival -=
+				static_cast<double>(current - config.threshold) /
+				(current - previous);
+		}
+	}
+
+	pulse.amplitude = getSignal(config, x[n]);
+	pulse.peak = position;
+	pulse.width = 1;
+	pulse.area = pulse.amplitude;
+
+	channel->waveform.clear();
+	pulse.waveformPreSamples = 0;
+	if (config.preSamples + config.postSamples > 0) {
+		const size_t pre = static_cast<size_t>(
+			std::min<std::uint64_t>(config.preSamples, position));
+		for (std::int64_t k = i - static_cast<std::int64_t>(pre); k < i; ++k) {
+			channel->waveform.push_back(sample(*channel, x, k));
+		}
+		channel->waveform.push_back(x[n]);
+		pulse.waveformPreSamples = pre;
+	}
+	channel->inPulse = true;
+}
+
+void PulseDetectorStage::endPulse(Channel *channel, const std::int16_t *x,
+								  const size_t samples, const size_t n) {
+	const auto &config = channel->config;
+	channel->inPulse = false;
+	if (config.preSamples + config.postSamples == 0) {
+		emit(channel->pulse, channel->waveform);
+		return;
+	}
+
+	const size_t count = std::min(config.postSamples, samples - n);
+	channel->waveform.insert(channel->waveform.end(), x + n, x + n + count);
+	if (count == config.postSamples && channel->pending.empty()) {
+		emit(channel->pulse, channel->waveform);
+	} else {
+		channel->pending.push_back(
+			{channel->pulse, channel->waveform, config.postSamples - count});
+		// Pulses are reported in order, after those still pending
+		while (!channel->pending.empty() &&
+			   channel->pending.front().remaining == 0) {
+			emit(channel->pending.front().pulse,
+				 channel->pending.front().waveform);
+			channel->pending.pop_front();
+		}
+	}
+}
+
+void PulseDetectorStage::emit(const Pulse &pulse,
+							  const std::vector<std::int16_t> &waveform) {
+	m_pulses.push_back(pulse);
+	m_pulses.back().waveformOffset = m_waveforms.size();
+	m_pulses.back().waveformSamples = waveform.size();
+	m_waveforms.insert(m_waveforms.end(), waveform.begin(), waveform.end());
+	++m_detected;
+}
+
+std::int16_t PulseDetectorStage::sample(const Channel &channel,
+										const std::int16_t *x,
+										const std::int64_t n) {
+	return n >= 0 ? x[n]
+				  : channel.history[static_cast<size_t>(
+						static_cast<std::int64_t>(channel.history.size()) + n)];
+}
+
+}  // namespace daq
+}  // namespace irio
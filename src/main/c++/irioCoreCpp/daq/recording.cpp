@@ -0,0 +1,385 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "daq/recording.h"
+#include "errorsIrio.h"
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+const char INDEX_MAGIC[8] = {'I', 'R', 'I', 'O', 'I', 'D', 'X', '\0'};
+const std::uint32_t INDEX_VERSION = 1;
+
+/// Layout of the start of the index, followed by a RecordedBlock per block
+struct IndexHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t channels;
+	std::uint64_t reserved;
+};
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+void writeAll(const int fd, const void *data, const size_t bytes,
+			  const std::uint64_t offset, const std::string &path) {
+	const char *p = static_cast<const char*>(data);
+	size_t done = 0;
+	while (done < bytes) {
+		const ssize_t n = pwrite(fd, p + done, bytes - done,
+								 static_cast<off_t>(offset + done));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0) {
+			throw errors::RecordingError("Unable to write " + path + ": " +
+										 strerror(errno));
+		}
+		done += static_cast<size_t>(n);
+	}
+}
+
+std::uint64_t getFileSize(const int fd, const std::string &path) {
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		throw errors::RecordingError("Unable to access " + path + ": " +
+									 strerror(errno));
+	}
+	return static_cast<std::uint64_t>(st.st_size);
+}
+
+}  // namespace
+
+DAQRecorder::DAQRecorder(const std::string &path, const size_t channels,
+						 const std::vector<size_t> &envelopes)
+	: m_path(path), m_channels(checkChannels(channels)), m_rawFd(-1),
+	  m_indexFd(-1), m_blocks(0), m_elements(0) {
+	if (!envelopes.empty()) {
+		m_envelopes.reset(new EnvelopeBuilder(m_path, m_channels, envelopes));
+	}
+
+	const std::string indexPath = getIndexPath(m_path);
+	m_rawFd = open(m_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	if (m_rawFd >= 0) {
+		m_indexFd = open(indexPath.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	}
+	if (m_rawFd < 0 || m_indexFd < 0) {
+		const std::string err = strerror(errno);
+		const std::string failed = m_rawFd < 0 ? m_path : indexPath;
+		if (m_rawFd >= 0) {
+			::close(m_rawFd);
+		}
+		throw errors::RecordingError("Unable to create " + failed + ": " +
+									 err);
+	}
+
+	IndexHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	header.version = INDEX_VERSION;
+	header.channels = static_cast<std::uint32_t>(m_channels);
+	try {
+		writeAll(m_indexFd, &header, sizeof(header), 0, indexPath);
+	} catch (const errors::RecordingError &) {
+		::close(m_rawFd);
+		::close(m_indexFd);
+		throw;
+	}
+}
+
+DAQRecorder::~DAQRecorder() {
+	try {
+		close();
+	} catch (const errors::RecordingError &) {
+	}
+}
+
+void DAQRecorder::record(const std::uint64_t *words, const size_t elements) {
+	record(words, elements, getHostTime());
+}
+
+void DAQRecorder::record(const std::uint64_t *words, const size_t elements,
+						 const std::int64_t timestamp) {
+	if (m_rawFd < 0) {
+		throw errors::DAQStageError("Recording " + m_path + " already closed");
+	}
+	if (m_envelopes && elements * 4 % m_channels != 0) {
+		throw errors::DAQStageError(
+			"Blocks of " + std::to_string(elements) +
+			" words do not hold whole samples of " +
+			std::to_string(m_channels) + " channels");
+	}
+
+	// The block is written at its offset, so a block that failed is
+	// overwritten by the next one
+	const RecordedBlock entry = {m_elements * sizeof(std::uint64_t), elements,
+								 timestamp};
+	writeAll(m_rawFd, words, elements * sizeof(std::uint64_t), entry.offset,
+			 m_path);
+	writeAll(m_indexFd, &entry, sizeof(entry),
+			 sizeof(IndexHeader) + m_blocks * sizeof(RecordedBlock),
+			 getIndexPath(m_path));
+	++m_blocks;
+	m_elements += elements;
+
+	if (m_envelopes) {
+		m_envelopes->process(words, elements);
+	}
+}
+
+size_t DAQRecorder::recordFromDMA(const TerminalsDMACommon &terminals,
+								  const std::uint32_t n, const size_t elements,
+								  const std::uint32_t timeout) {
+	std::uint64_t *data = nullptr;
+	const size_t acquired =
+		terminals.acquireData(n, elements, &data, true, timeout);
+	try {
+		record(data, acquired);
+	} catch (...) {
+		terminals.releaseData(n, acquired);
+		throw;
+	}
+	terminals.releaseData(n, acquired);
+	return acquired;
+}
+
+void DAQRecorder::close() {
+	if (m_rawFd < 0) {
+		return;
+	}
+	::close(m_rawFd);
+	::close(m_indexFd);
+	m_rawFd = -1;
+	m_indexFd = -1;
+	if (m_envelopes) {
+		m_envelopes->close();
+	}
+}
+
+std::uint64_t DAQRecorder::getBlocks() const {
+	return m_blocks;
+}
+
+std::uint64_t DAQRecorder::getElements() const {
+	return m_elements;
+}
+
+size_t DAQRecorder::getChannels() const {
+	return m_channels;
+}
+
+std::string DAQRecorder::getIndexPath(const std::string &path) {
+	return path + ".idx";
+}
+
+std::int64_t DAQRecorder::getHostTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+RecordingReader::RecordingReader(const std::string &path)
+	: m_path(path), m_rawFd(-1), m_indexFd(-1), m_channels(0),
+	  m_rawMap(nullptr), m_rawSize(0), m_indexMap(nullptr), m_indexSize(0),
+	  m_index(nullptr), m_blocks(0), m_values(nullptr), m_samples(0) {
+	const std::string indexPath = DAQRecorder::getIndexPath(m_path);
+	m_rawFd = open(m_path.c_str(), O_RDONLY);
+	if (m_rawFd >= 0) {
+		m_indexFd = open(indexPath.c_str(), O_RDONLY);
+	}
+	if (m_rawFd < 0 || m_indexFd < 0) {
+		const std::string err = strerror(errno);
+		const std::string failed = m_rawFd < 0 ? m_path : indexPath;
+		if (m_rawFd >= 0) {
+			close(m_rawFd);
+		}
+		throw errors::RecordingError("Unable to open " + failed + ": " + err);
+	}
+
+	try {
+		IndexHeader header;
+		if (pread(m_indexFd, &header, sizeof(header), 0) !=
+				static_cast<ssize_t>(sizeof(header)) ||
+			std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+			header.version != INDEX_VERSION || header.channels == 0) {
+			throw errors::RecordingError(indexPath + " is not a valid index");
+		}
+		m_channels = header.channels;
+		refresh();
+	} catch (const errors::RecordingError &) {
+		close(m_rawFd);
+		close(m_indexFd);
+		throw;
+	}
+}
+
+RecordingReader::~RecordingReader() {
+	unmap();
+	close(m_rawFd);
+	close(m_indexFd);
+}
+
+void RecordingReader::refresh() {
+	unmap();
+	const std::string indexPath = DAQRecorder::getIndexPath(m_path);
+	std::uint64_t blocks = (getFileSize(m_indexFd, indexPath) -
+							sizeof(IndexHeader)) / sizeof(RecordedBlock);
+	if (blocks == 0) {
+		return;
+	}
+
+	m_indexSize = sizeof(IndexHeader) + blocks * sizeof(RecordedBlock);
+	void *indexMap =
+		mmap(nullptr, m_indexSize, PROT_READ, MAP_SHARED, m_indexFd, 0);
+	if (indexMap == MAP_FAILED) {
+		m_indexSize = 0;
+		throw errors::RecordingError("Unable to map " + indexPath + ": " +
+									 strerror(errno));
+	}
+	m_indexMap = indexMap;
+	const auto index = reinterpret_cast<const RecordedBlock*>(
+		static_cast<const char*>(m_indexMap) + sizeof(IndexHeader));
+
+	// Only the blocks whose data is in the raw file
+	const std::uint64_t rawSize = getFileSize(m_rawFd, m_path);
+	while (blocks > 0 && index[blocks - 1].offset +
+			index[blocks - 1].elements * sizeof(std::uint64_t) > rawSize) {
+		--blocks;
+	}
+	const std::uint64_t end =
+		blocks == 0 ? 0
+					: index[blocks - 1].offset +
+						  index[blocks - 1].elements * sizeof(std::uint64_t);
+	if (end > 0) {
+		void *rawMap =
+			mmap(nullptr, end, PROT_READ, MAP_SHARED, m_rawFd, 0);
+		if (rawMap == MAP_FAILED) {
+			const std::string err = strerror(errno);
+			unmap();
+			throw errors::RecordingError("Unable to map " + m_path + ": " +
+										 err);
+		}
+		m_rawMap = rawMap;
+		m_rawSize = end;
+	}
+	m_index = index;
+	m_blocks = blocks;
+	m_values = static_cast<const std::int16_t*>(m_rawMap);
+	m_samples = end / sizeof(std::int16_t) / m_channels;
+}
+
+RecordedBlock RecordingReader::getBlock(const std::uint64_t block) const {
+	if (block >= m_blocks) {
+		throw errors::DAQStageError("Block " + std::to_string(block) +
+									" not recorded");
+	}
+	return m_index[block];
+}
+
+std::uint64_t RecordingReader::getBlockSample(const std::uint64_t block) const {
+	if (block == m_blocks) {
+		return m_samples;
+	}
+	const std::uint64_t values =
+		getBlock(block).offset / sizeof(std::int16_t);
+	return std::min((values + m_channels - 1) / m_channels, m_samples);
+}
+
+std::uint64_t RecordingReader::findBlock(const std::int64_t timestamp) const {
+	const auto block = std::lower_bound(
+		m_index, m_index + m_blocks, timestamp,
+		[](const RecordedBlock &entry, const std::int64_t t) {
+			return entry.timestamp < t;
+		});
+	return static_cast<std::uint64_t>(block - m_index);
+}
+
+void RecordingReader::getSampleRange(const std::uint64_t firstSample,
+									 const std::uint64_t samples,
+									 const std::vector<size_t> &channels,
+									 std::vector<ChannelSpan> *spans) const {
+	for (const auto channel : channels) {
+		if (channel >= m_channels) {
+			throw errors::DAQStageError("Channel " + std::to_string(channel) +
+										" not found");
+		}
+	}
+	const std::uint64_t first = std::min(firstSample, m_samples);
+	const size_t count =
+		static_cast<size_t>(std::min(samples, m_samples - first));
+	spans->clear();
+	for (const auto channel : channels) {
+		const std::int16_t *data =
+			count > 0 ? m_values + first * m_channels + channel : nullptr;
+		spans->push_back({channel, first, count, data, m_channels});
+	}
+}
+
+void RecordingReader::getBlockRange(const std::uint64_t firstBlock,
+									const std::uint64_t blocks,
+									const std::vector<size_t> &channels,
+									std::vector<ChannelSpan> *spans) const {
+	if (firstBlock > m_blocks || blocks > m_blocks - firstBlock) {
+		throw errors::DAQStageError(
+			"Blocks " + std::to_string(firstBlock) + " to " +
+			std::to_string(firstBlock + blocks) + " not recorded");
+	}
+	const std::uint64_t first = getBlockSample(firstBlock);
+	getSampleRange(first, getBlockSample(firstBlock + blocks) - first,
+				   channels, spans);
+}
+
+void RecordingReader::getTimeRange(const std::int64_t start,
+								   const std::int64_t end,
+								   const std::vector<size_t> &channels,
+								   std::vector<ChannelSpan> *spans) const {
+	const std::uint64_t first = findBlock(start);
+	const std::uint64_t last = std::max(first, findBlock(end));
+	getBlockRange(first, last - first, channels, spans);
+}
+
+std::uint64_t RecordingReader::getBlocks() const {
+	return m_blocks;
+}
+
+std::uint64_t RecordingReader::getSamples() const {
+	return m_samples;
+}
+
+size_t RecordingReader::getChannels() const {
+	return m_channels;
+}
+
+void RecordingReader::unmap() {
+	if (m_rawMap != nullptr) {
+		munmap(const_cast<void*>(m_rawMap), m_rawSize);
+	}
+	if (m_indexMap != nullptr) {
+		munmap(const_cast<void*>(m_indexMap), m_indexSize);
+	}
+	m_rawMap = nullptr;
+	m_rawSize = 0;
+	m_indexMap = nullptr;
+	m_indexSize = 0;
+	m_index = nullptr;
+	m_blocks = 0;
+	m_values = nullptr;
+	m_samples = 0;
+}
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,651 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "daq/sampleCodec.h"
+#include "errorsIrio.h"
+#include "workerPool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+constexpr std::uint32_t CODEC_MAGIC = 0x43535249;  // "IRSC"
+constexpr std::uint8_t CODEC_VERSION = 1;
+constexpr size_t HEADER_BYTES = 12;
+
+/// Samples of a group, packed in 16 lanes of 16 rows
+constexpr size_t GROUP = 256;
+constexpr size_t LANES = 16;
+constexpr unsigned MAX_WIDTH = 16;
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0 || channels > 0xFFFF) {
+		throw errors::DAQStageError("DAQ blocks can be compressed with 1 to "
+									"65535 channels, " +
+									std::to_string(channels) + " requested");
+	}
+	return channels;
+}
+
+size_t getMaxChannelBytes(const size_t samples) {
+	return (samples + GROUP - 1) / GROUP * (1 + GROUP * MAX_WIDTH / 8);
+}
+
+inline void store16(std::uint8_t *out, const std::uint16_t value) {
+	std::memcpy(out, &value, sizeof(value));
+}
+
+inline void store32(std::uint8_t *out, const std::uint32_t value) {
+	std::memcpy(out, &value, sizeof(value));
+}
+
+inline std::uint16_t load16(const std::uint8_t *data) {
+	std::uint16_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+inline std::uint32_t load32(const std::uint8_t *data) {
+	std::uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+/// Bits required by the largest of the values OR'ed in \p bits
+inline unsigned getWidth(const unsigned bits) {
+	return bits ? 32 - __builtin_clz(bits) : 0;
+}
+
+/// Packs the 256 values of a group, of up to W bits, in 32 x W bytes
+using PackKernel = void (*)(const std::uint16_t *values, std::uint8_t *out);
+/// Unpacks the 256 values of a group of W bits
+using UnpackKernel = void (*)(const std::uint8_t *data,
+							  std::uint16_t *values);
+
+/**
+ * Kernels of an instruction set
+ */
+struct Kernels {
+	/// Zigzag-coded differences of the samples of a full group, from
+	/// samples[-1]. Returns the values OR'ed
+	unsigned (*delta)(const std::int16_t *samples, std::uint16_t *values);
+	/// Inverse of delta for \p count values, after the sample \p previous.
+	/// Returns the last sample
+	std::int16_t (*integrate)(const std::uint16_t *values, const size_t count,
+							  const std::int16_t previous,
+							  std::int16_t *samples);
+	/// Kernels for each bit width, 0 to 16
+	PackKernel pack[MAX_WIDTH + 1];
+	UnpackKernel unpack[MAX_WIDTH + 1];
+};
+
+#define IRIO_WIDTH_KERNELS(kernel) \
+	kernel<0>, kernel<1>, kernel<2>, kernel<3>, kernel<4>, kernel<5>, \
+	kernel<6>, kernel<7>, kernel<8>, kernel<9>, kernel<10>, kernel<11>, \
+	kernel<12>, kernel<13>, kernel<14>, kernel<15>, kernel<16>
+
+/////////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+// Value i of a group is in lane i % 16 and row i / 16. The W bits of the 16
+// rows of a lane are packed in W words of 16 bits, stored as rows of 16
+// lanes, so each word of a SIMD register packs the values of its lane.
+
+unsigned deltaScalar(const std::int16_t *samples, const size_t count,
+					 std::uint16_t *values) {
+	unsigned bits = 0;
+	for (size_t i = 0; i < count; ++i) {
+		const unsigned diff =
+			static_cast<std::uint16_t>(samples[i] - samples[i - 1]);
+		const auto value =
+			static_cast<std::uint16_t>((diff << 1) ^ (0u - (diff >> 15)));
+		values[i] = value;
+		bits |= value;
+	}
+	std::fill(values + count, values + GROUP, 0);
+	return bits;
+}
+
+unsigned deltaGroupScalar(const std::int16_t *samples,
+						  std::uint16_t *values) {
+	return deltaScalar(samples, GROUP, values);
+}
+
+std::int16_t integrateScalar(const std::uint16_t *values, const size_t count,
+							 const std::int16_t previous,
+							 std::int16_t *samples) {
+	unsigned sample = static_cast<std::uint16_t>(previous);
+	for (size_t i = 0; i < count; ++i) {
+		const unsigned value = values[i];
+		sample += (value >> 1) ^ (0u - (value & 1));
+		samples[i] = static_cast<std::int16_t>(sample);
+	}
+	return static_cast<std::int16_t>(sample);
+}
+
+template <unsigned W>
+void packScalar(const std::uint16_t *values, std::uint8_t *out) {
+	for (size_t lane = 0; lane < LANES; ++lane) {
+		unsigned acc = 0;
+		unsigned used = 0;
+		size_t word = 0;
+		for (size_t row = 0; row < 16; ++row) {
+			const unsigned value = values[row * LANES + lane];
+			acc |= value << used;
+			used += W;
+			if (used >= 16) {
+				store16(out + (word++ * LANES + lane) * 2,
+						static_cast<std::uint16_t>(acc));
+				used -= 16;
+				acc = value >> (W - used);
+			}
+		}
+	}
+}
+
+template <unsigned W>
+void unpackScalar(const std::uint8_t *data, std::uint16_t *values) {
+	if (W == 0) {
+		std::fill(values, values + GROUP, 0);
+		return;
+	}
+	const unsigned mask = (1u << W) - 1;
+	for (size_t lane = 0; lane < LANES; ++lane) {
+		unsigned cur = load16(data + lane * 2);
+		unsigned used = 0;
+		size_t word = 0;
+		for (size_t row = 0; row < 16; ++row) {
+			unsigned value = cur >> used;
+			used += W;
+			if (used >= 16) {
+				used -= 16;
+				if (++word < W) {
+					cur = load16(data + (word * LANES + lane) * 2);
+					value |= cur << (W - used);
+				}
+			}
+			values[row * LANES + lane] =
+				static_cast<std::uint16_t>(value & mask);
+		}
+	}
+}
+
+const Kernels SCALAR_KERNELS = {
+	deltaGroupScalar, integrateScalar,
+	{IRIO_WIDTH_KERNELS(packScalar)}, {IRIO_WIDTH_KERNELS(unpackScalar)}};
+
+#ifdef IRIO_X86_SIMD
+/////////////////////////////////////////////////////////////////////////////
+// SSSE3 kernels
+// Each half of a row (8 lanes) is packed as a separate register
+
+__attribute__((target("ssse3")))
+unsigned deltaSSSE3(const std::int16_t *samples, std::uint16_t *values) {
+	__m128i bits = _mm_setzero_si128();
+	for (size_t i = 0; i < GROUP; i += 8) {
+		const __m128i cur = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(samples + i));
+		const __m128i prev = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(samples + i - 1));
+		const __m128i diff = _mm_sub_epi16(cur, prev);
+		const __m128i value = _mm_xor_si128(_mm_slli_epi16(diff, 1),
+											_mm_srai_epi16(diff, 15));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), value);
+		bits = _mm_or_si128(bits, value);
+	}
+	bits = _mm_or_si128(bits, _mm_srli_si128(bits, 8));
+	bits = _mm_or_si128(bits, _mm_srli_si128(bits, 4));
+	bits = _mm_or_si128(bits, _mm_srli_si128(bits, 2));
+	return _mm_cvtsi128_si32(bits) & 0xFFFF;
+}
+
+__attribute__((target("ssse3")))
+std::int16_t integrateSSSE3(const std::uint16_t *values, const size_t count,
+							const std::int16_t previous,
+							std::int16_t *samples) {
+	// Broadcasts the last word
+	const __m128i last = _mm_set1_epi16(0x0F0E);
+	const __m128i one = _mm_set1_epi16(1);
+	__m128i carry = _mm_set1_epi16(previous);
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i value = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(values + i));
+		__m128i diff = _mm_xor_si128(
+			_mm_srli_epi16(value, 1),
+			_mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(value, one)));
+		diff = _mm_add_epi16(diff, _mm_slli_si128(diff, 2));
+		diff = _mm_add_epi16(diff, _mm_slli_si128(diff, 4));
+		diff = _mm_add_epi16(diff, _mm_slli_si128(diff, 8));
+		const __m128i sample = _mm_add_epi16(diff, carry);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), sample);
+		carry = _mm_shuffle_epi8(sample, last);
+	}
+	return integrateScalar(values + i, count - i,
+						   static_cast<std::int16_t>(_mm_cvtsi128_si32(carry)),
+						   samples + i);
+}
+
+template <unsigned W>
+__attribute__((target("ssse3")))
+void packSSSE3(const std::uint16_t *values, std::uint8_t *out) {
+	for (size_t half = 0; half < 2; ++half) {
+		__m128i acc = _mm_setzero_si128();
+		unsigned used = 0;
+		size_t word = 0;
+		for (size_t row = 0; row < 16; ++row) {
+			const __m128i value = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(values + row * LANES) + half);
+			acc = _mm_or_si128(acc, _mm_slli_epi16(value, used));
+			used += W;
+			if (used >= 16) {
+				_mm_storeu_si128(
+					reinterpret_cast<__m128i*>(out + word++ * 32) + half, acc);
+				used -= 16;
+				acc = _mm_srli_epi16(value, W - used);
+			}
+		}
+	}
+}
+
+template <unsigned W>
+__attribute__((target("ssse3")))
+void unpackSSSE3(const std::uint8_t *data, std::uint16_t *values) {
+	if (W == 0) {
+		std::fill(values, values + GROUP, 0);
+		return;
+	}
+	const __m128i mask = _mm_set1_epi16(static_cast<short>((1u << W) - 1));
+	for (size_t half = 0; half < 2; ++half) {
+		__m128i cur = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(data) + half);
+		unsigned used = 0;
+		size_t word = 0;
+		for (size_t row = 0; row < 16; ++row) {
+			__m128i value = _mm_srli_epi16(cur, used);
+			used += W;
+			if (used >= 16) {
+				used -= 16;
+				if (++word < W) {
+					cur = _mm_loadu_si128(
+						reinterpret_cast<const __m128i*>(data + word * 32) +
+						half);
+					value = _mm_or_si128(value, _mm_slli_epi16(cur, W - used));
+				}
+			}
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(values + row * LANES) + half,
+				_mm_and_si128(value, mask));
+		}
+	}
+}
+
+const Kernels SSSE3_KERNELS = {
+	deltaSSSE3, integrateSSSE3,
+	{IRIO_WIDTH_KERNELS(packSSSE3)}, {IRIO_WIDTH_KERNELS(unpackSSSE3)}};
+
+/////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels
+// A register holds a whole row of the group
+
+__attribute__((target("avx2")))
+unsigned deltaAVX2(const std::int16_t *samples, std::uint16_t *values) {
+	__m256i bits = _mm256_setzero_si256();
+	for (size_t i = 0; i < GROUP; i += 16) {
+		const __m256i cur = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(samples + i));
+		const __m256i prev = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(samples + i - 1));
+		const __m256i diff = _mm256_sub_epi16(cur, prev);
+		const __m256i value = _mm256_xor_si256(_mm256_slli_epi16(diff, 1),
+											   _mm256_srai_epi16(diff, 15));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + i), value);
+		bits = _mm256_or_si256(bits, value);
+	}
+	__m128i half = _mm_or_si128(_mm256_castsi256_si128(bits),
+								_mm256_extracti128_si256(bits, 1));
+	half = _mm_or_si128(half, _mm_srli_si128(half, 8));
+	half = _mm_or_si128(half, _mm_srli_si128(half, 4));
+	half = _mm_or_si128(half, _mm_srli_si128(half, 2));
+	return _mm_cvtsi128_si32(half) & 0xFFFF;
+}
+
+__attribute__((target("avx2")))
+std::int16_t integrateAVX2(const std::uint16_t *values, const size_t count,
+						   const std::int16_t previous,
+						   std::int16_t *samples) {
+	// Broadcasts the last word of each 128 bits lane
+	const __m256i last = _mm256_set1_epi16(0x0F0E);
+	const __m256i one = _mm256_set1_epi16(1);
+	__m256i carry = _mm256_set1_epi16(previous);
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i value = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(values + i));
+		__m256i diff = _mm256_xor_si256(
+			_mm256_srli_epi16(value, 1),
+			_mm256_sub_epi16(_mm256_setzero_si256(),
+							 _mm256_and_si256(value, one)));
+		// Sums within each lane, then adds the low lane to the high one
+		diff = _mm256_add_epi16(diff, _mm256_slli_si256(diff, 2));
+		diff = _mm256_add_epi16(diff, _mm256_slli_si256(diff, 4));
+		diff = _mm256_add_epi16(diff, _mm256_slli_si256(diff, 8));
+		const __m256i low = _mm256_shuffle_epi8(diff, last);
+		diff = _mm256_add_epi16(diff,
+								_mm256_permute2x128_si256(low, low, 0x08));
+		const __m256i sample = _mm256_add_epi16(diff, carry);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(samples + i), sample);
+		const __m256i high = _mm256_shuffle_epi8(sample, last);
+		carry = _mm256_permute2x128_si256(high, high, 0x11);
+	}
+	return integrateScalar(
+		values + i, count - i,
+		static_cast<std::int16_t>(
+			_mm_cvtsi128_si32(_mm256_castsi256_si128(carry))),
+		samples + i);
+}
+
+template <unsigned W>
+__attribute__((target("avx2")))
+void packAVX2(const std::uint16_t *values, std::uint8_t *out) {
+	__m256i acc = _mm256_setzero_si256();
+	unsigned used = 0;
+	size_t word = 0;
+	for (size_t row = 0; row < 16; ++row) {
+		const __m256i value = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i*>(values + row * LANES));
+		acc = _mm256_or_si256(acc, _mm256_slli_epi16(value, used));
+		used += W;
+		if (used >= 16) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out) + word++, acc);
+			used -= 16;
+			acc = _mm256_srli_epi16(value, W - used);
+		}
+	}
+}
+
+template <unsigned W>
+__attribute__((target("avx2")))
+void unpackAVX2(const std::uint8_t *data, std::uint16_t *values) {
+	if (W == 0) {
+		std::fill(values, values + GROUP, 0);
+		return;
+	}
+	const __m256i mask =
+		_mm256_set1_epi16(static_cast<short>((1u << W) - 1));
+	const __m256i *in = reinterpret_cast<const __m256i*>(data);
+	__m256i cur = _mm256_loadu_si256(in);
+	unsigned used = 0;
+	size_t word = 0;
+	for (size_t row = 0; row < 16; ++row) {
+		__m256i value = _mm256_srli_epi16(cur, used);
+		used += W;
+		if (used >= 16) {
+			used -= 16;
+			if (++word < W) {
+				cur = _mm256_loadu_si256(in + word);
+				value =
+					_mm256_or_si256(value, _mm256_slli_epi16(cur, W - used));
+			}
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(values + row * LANES),
+							_mm256_and_si256(value, mask));
+	}
+}
+
+const Kernels AVX2_KERNELS = {
+	deltaAVX2, integrateAVX2,
+	{IRIO_WIDTH_KERNELS(packAVX2)}, {IRIO_WIDTH_KERNELS(unpackAVX2)}};
+#endif
+
+#undef IRIO_WIDTH_KERNELS
+
+const Kernels &getKernels(const SIMDLevel level) {
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+#ifdef IRIO_X86_SIMD
+	if (used == SIMDLevel::AVX2) {
+		return AVX2_KERNELS;
+	}
+	if (used == SIMDLevel::SSSE3) {
+		return SSSE3_KERNELS;
+	}
+#else
+	static_cast<void>(used);
+#endif
+	return SCALAR_KERNELS;
+}
+
+/**
+ * Codes the samples of a channel, preceded by a zero at samples[-1], and
+ * returns the number of bytes written
+ */
+size_t encodeChannel(const std::int16_t *samples, const size_t count,
+					 const Kernels &kernels, std::uint8_t *out) {
+	alignas(32) std::uint16_t values[GROUP];
+	size_t pos = 0;
+	for (size_t first = 0; first < count; first += GROUP) {
+		const size_t n = std::min(GROUP, count - first);
+		const unsigned bits =
+			n == GROUP ? kernels.delta(samples + first, values)
+					   : deltaScalar(samples + first, n, values);
+		const unsigned width = getWidth(bits);
+		out[pos++] = static_cast<std::uint8_t>(width);
+		kernels.pack[width](values, out + pos);
+		pos += width * GROUP / 8;
+	}
+	return pos;
+}
+
+void decodeChannel(const std::uint8_t *data, const size_t size,
+				   const size_t count, const Kernels &kernels,
+				   std::int16_t *samples) {
+	alignas(32) std::uint16_t values[GROUP];
+	size_t pos = 0;
+	std::int16_t previous = 0;
+	for (size_t first = 0; first < count; first += GROUP) {
+		const unsigned width = pos < size ? data[pos++] : MAX_WIDTH + 1;
+		if (width > MAX_WIDTH || size - pos < width * GROUP / 8) {
+			throw errors::CodecError("Corrupted channel of the compressed "
+									 "block");
+		}
+		kernels.unpack[width](data + pos, values);
+		pos += width * GROUP / 8;
+		previous = kernels.integrate(values, std::min(GROUP, count - first),
+									 previous, samples + first);
+	}
+	if (pos != size) {
+		throw errors::CodecError("Corrupted channel of the compressed block");
+	}
+}
+
+}  // namespace
+
+constexpr size_t SampleCodec::MAX_ELEMENTS;
+
+SampleCodec::SampleCodec(const size_t channels, const unsigned threads)
+	: m_channels(checkChannels(channels)),
+	  m_threads(std::max(1u, threads)) {}
+
+size_t SampleCodec::compress(const std::uint64_t *words,
+							 const size_t elements, std::uint8_t *out,
+							 const SIMDLevel level) const {
+	if (elements > MAX_ELEMENTS) {
+		throw errors::DAQStageError(
+			"Blocks of up to " + std::to_string(MAX_ELEMENTS) +
+			" DMA words can be compressed, " + std::to_string(elements) +
+			" requested");
+	}
+	const size_t samples = getBlockSamples(elements, m_channels);
+	const Kernels &kernels = getKernels(level);
+
+	// Channels split after a zero, the sample before the first one
+	static thread_local std::vector<std::int16_t> buffer;
+	static thread_local std::vector<std::int16_t*> pointers;
+	const size_t stride = samples + 16;
+	buffer.resize(m_channels * stride);
+	pointers.resize(m_channels);
+	for (size_t c = 0; c < m_channels; ++c) {
+		pointers[c] = buffer.data() + c * stride + 16;
+		pointers[c][-1] = 0;
+	}
+	// The pool threads see their own thread_local buffers, not these ones
+	std::int16_t *const *channels = pointers.data();
+	deinterleave(words, samples, m_channels, channels, level);
+
+	store32(out, CODEC_MAGIC);
+	out[4] = CODEC_VERSION;
+	out[5] = 0;
+	store16(out + 6, static_cast<std::uint16_t>(m_channels));
+	store32(out + 8, static_cast<std::uint32_t>(elements));
+
+	// Each channel is coded in its own slot of the buffer and the channels
+	// are moved together afterwards
+	const size_t dataOffset = HEADER_BYTES + 4 * m_channels;
+	const size_t slot = getMaxChannelBytes(samples);
+	WorkerPool::getShared().run(m_channels, m_threads, [&](const size_t c) {
+		const size_t bytes = encodeChannel(channels[c], samples, kernels,
+										   out + dataOffset + c * slot);
+		store32(out + HEADER_BYTES + 4 * c,
+				static_cast<std::uint32_t>(bytes));
+	});
+
+	size_t end = dataOffset;
+	for (size_t c = 0; c < m_channels; ++c) {
+		const size_t bytes = load32(out + HEADER_BYTES + 4 * c);
+		std::memmove(out + end, out + dataOffset + c * slot, bytes);
+		end += bytes;
+	}
+
+	// Values after the last complete sample
+	const size_t tail = elements * 4 - samples * m_channels;
+	if (tail > 0) {
+		std::memcpy(out + end,
+					reinterpret_cast<const std::int16_t*>(words) +
+						samples * m_channels,
+					tail * 2);
+	}
+	return end + tail * 2;
+}
+
+size_t SampleCodec::decompress(const std::uint8_t *data, const size_t size,
+							   std::uint64_t *words,
+							   const SIMDLevel level) const {
+	const size_t elements = getElements(data, size);
+	const size_t samples = getBlockSamples(elements, m_channels);
+
+	static thread_local std::vector<std::int16_t> buffer;
+	static thread_local std::vector<std::int16_t*> channels;
+	buffer.resize(m_channels * samples);
+	channels.resize(m_channels);
+	for (size_t c = 0; c < m_channels; ++c) {
+		channels[c] = buffer.data() + c * samples;
+	}
+	decodeChannels(data, 0, m_channels, channels.data(), level);
+
+	auto values = reinterpret_cast<std::int16_t*>(words);
+	for (size_t c = 0; c < m_channels; ++c) {
+		const std::int16_t *channel = channels[c];
+		for (size_t s = 0; s < samples; ++s) {
+			values[s * m_channels + c] = channel[s];
+		}
+	}
+
+	// Values after the last complete sample, after the channels
+	size_t end = HEADER_BYTES + 4 * m_channels;
+	for (size_t c = 0; c < m_channels; ++c) {
+		end += load32(data + HEADER_BYTES + 4 * c);
+	}
+	const size_t tail = elements * 4 - samples * m_channels;
+	if (tail > 0) {
+		std::memcpy(values + samples * m_channels, data + end, tail * 2);
+	}
+	return elements;
+}
+
+size_t SampleCodec::decompressChannel(const std::uint8_t *data,
+									  const size_t size, const size_t channel,
+									  std::int16_t *samples,
+									  const SIMDLevel level) const {
+	if (channel >= m_channels) {
+		throw errors::DAQStageError(
+			"Channel " + std::to_string(channel) + " not found, the DMA has " +
+			std::to_string(m_channels) + " channels");
+	}
+	const size_t elements = getElements(data, size);
+	decodeChannels(data, channel, channel + 1, &samples, level);
+	return getBlockSamples(elements, m_channels);
+}
+
+size_t SampleCodec::getElements(const std::uint8_t *data,
+								const size_t size) const {
+	if (size < HEADER_BYTES || load32(data) != CODEC_MAGIC) {
+		throw errors::CodecError("The data is not a compressed DAQ block");
+	}
+	if (data[4] != CODEC_VERSION) {
+		throw errors::CodecError("Unsupported version " +
+								 std::to_string(data[4]) +
+								 " of the compressed DAQ block");
+	}
+	const size_t channels = load16(data + 6);
+	if (channels != m_channels) {
+		throw errors::CodecError(
+			"Compressed DAQ block of " + std::to_string(channels) +
+			" channels, expected " + std::to_string(m_channels));
+	}
+	const size_t elements = load32(data + 8);
+	if (elements > MAX_ELEMENTS || size < HEADER_BYTES + 4 * channels) {
+		throw errors::CodecError("Corrupted header of the compressed block");
+	}
+
+	std::uint64_t end = HEADER_BYTES + 4 * channels;
+	for (size_t c = 0; c < channels; ++c) {
+		end += load32(data + HEADER_BYTES + 4 * c);
+	}
+	end += (elements * 4 - getBlockSamples(elements, channels) * channels) * 2;
+	if (end > size) {
+		throw errors::CodecError("Truncated compressed DAQ block, " +
+								 std::to_string(size) + " bytes of " +
+								 std::to_string(end));
+	}
+	return elements;
+}
+
+size_t SampleCodec::getMaxCompressedSize(const size_t elements) const {
+	const size_t samples = getBlockSamples(elements, m_channels);
+	const size_t bytes = HEADER_BYTES + 4 * m_channels +
+						 m_channels * getMaxChannelBytes(samples) +
+						 (elements * 4 - samples * m_channels) * 2;
+	return (bytes + 7) / 8 * 8;
+}
+
+size_t SampleCodec::getChannels() const {
+	return m_channels;
+}
+
+void SampleCodec::decodeChannels(const std::uint8_t *data, const size_t first,
+								 const size_t last, std::int16_t *const *out,
+								 const SIMDLevel level) const {
+	const size_t elements = load32(data + 8);
+	const size_t samples = getBlockSamples(elements, m_channels);
+	const Kernels &kernels = getKernels(level);
+
+	std::vector<size_t> offsets(m_channels + 1, HEADER_BYTES + 4 * m_channels);
+	for (size_t c = 0; c < m_channels; ++c) {
+		offsets[c + 1] = offsets[c] + load32(data + HEADER_BYTES + 4 * c);
+	}
+	WorkerPool::getShared().run(last - first, m_threads, [&](const size_t i) {
+		const size_t c = first + i;
+		decodeChannel(data + offsets[c], offsets[c + 1] - offsets[c], samples,
+					  kernels, out[i]);
+	});
+}
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,389 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "daq/spectrum.h"
+#include "errorsIrio.h"
+#include "workerPool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+size_t checkFFTSize(const size_t fftSize) {
+	if (fftSize < 8 || (fftSize & (fftSize - 1)) != 0) {
+		throw errors::DAQStageError("FFT size " + std::to_string(fftSize) +
+									" is not a power of 2 of at least 8");
+	}
+	return fftSize;
+}
+
+size_t checkNotZero(const size_t value, const std::string &name) {
+	if (value == 0) {
+		throw errors::DAQStageError(name + " must be at least 1");
+	}
+	return value;
+}
+
+double windowValue(const SpectrumWindow window, const size_t n,
+				   const size_t size) {
+	// Periodic windows, as the frames are analysed as one period
+	const double x = 2 * PI * n / size;
+	switch (window) {
+	case SpectrumWindow::Hann:
+		return 0.5 - 0.5 * std::cos(x);
+	case SpectrumWindow::Hamming:
+		return 0.54 - 0.46 * std::cos(x);
+	case SpectrumWindow::Blackman:
+		return 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2 * x);
+	case SpectrumWindow::Rectangular:
+	default:
+		return 1.0;
+	}
+}
+
+/////////////////////////////////////////////////////////////
+/// FFT butterflies
+/////////////////////////////////////////////////////////////
+
+// Radix-2 decimation in time stage of a complex FFT of n points, stored as
+// separate real and imaginary parts, combining transforms of half points.
+// w holds the half twiddle factors of the stage
+
+void stageScalar(float *re, float *im, const size_t n, const size_t half,
+				 const float *wRe, const float *wIm) {
+	for (size_t g = 0; g < n; g += 2 * half) {
+		for (size_t j = 0; j < half; ++j) {
+			const size_t a = g + j, b = a + half;
+			const float tRe = wRe[j] * re[b] - wIm[j] * im[b];
+			const float tIm = wRe[j] * im[b] + wIm[j] * re[b];
+			re[b] = re[a] - tRe;
+			im[b] = im[a] - tIm;
+			re[a] = re[a] + tRe;
+			im[a] = im[a] + tIm;
+		}
+	}
+}
+
+#ifdef IRIO_X86_SIMD
+__attribute__((target("ssse3")))
+void stageSSSE3(float *re, float *im, const size_t n, const size_t half,
+				const float *wRe, const float *wIm) {
+	for (size_t g = 0; g < n; g += 2 * half) {
+		for (size_t j = 0; j < half; j += 4) {
+			const size_t a = g + j, b = a + half;
+			const __m128 wr = _mm_loadu_ps(wRe + j);
+			const __m128 wi = _mm_loadu_ps(wIm + j);
+			const __m128 br = _mm_loadu_ps(re + b);
+			const __m128 bi = _mm_loadu_ps(im + b);
+			const __m128 ar = _mm_loadu_ps(re + a);
+			const __m128 ai = _mm_loadu_ps(im + a);
+			const __m128 tr = _mm_sub_ps(_mm_mul_ps(wr, br),
+										 _mm_mul_ps(wi, bi));
+			const __m128 ti = _mm_add_ps(_mm_mul_ps(wr, bi),
+										 _mm_mul_ps(wi, br));
+			_mm_storeu_ps(re + b, _mm_sub_ps(ar, tr));
+			_mm_storeu_ps(im + b, _mm_sub_ps(ai, ti));
+			_mm_storeu_ps(re + a, _mm_add_ps(ar, tr));
+			_mm_storeu_ps(im + a, _mm_add_ps(ai, ti));
+		}
+	}
+}
+
+__attribute__((target("avx2")))
+void stageAVX2(float *re, float *im, const size_t n, const size_t half,
+			   const float *wRe, const float *wIm) {
+	for (size_t g = 0; g < n; g += 2 * half) {
+		for (size_t j = 0; j < half; j += 8) {
+			const size_t a = g + j, b = a + half;
+			const __m256 wr = _mm256_loadu_ps(wRe + j);
+			const __m256 wi = _mm256_loadu_ps(wIm + j);
+			const __m256 br = _mm256_loadu_ps(re + b);
+			const __m256 bi = _mm256_loadu_ps(im + b);
+			const __m256 ar = _mm256_loadu_ps(re + a);
+			const __m256 ai = _mm256_loadu_ps(im + a);
+			const __m256 tr = _mm256_sub_ps(_mm256_mul_ps(wr, br),
+											_mm256_mul_ps(wi, bi));
+			const __m256 ti = _mm256_add_ps(_mm256_mul_ps(wr, bi),
+											_mm256_mul_ps(wi, br));
+			_mm256_storeu_ps(re + b, _mm256_sub_ps(ar, tr));
+			_mm256_storeu_ps(im + b, _mm256_sub_ps(ai, ti));
+			_mm256_storeu_ps(re + a, _mm256_add_ps(ar, tr));
+			_mm256_storeu_ps(im + a, _mm256_add_ps(ai, ti));
+		}
+	}
+}
+#endif
+
+}  // namespace
+
+SpectrumStage::SpectrumStage(const size_t channels, const size_t fftSize,
+							 const size_t hop, const size_t averages,
+							 const SpectrumWindow window,
+							 const unsigned threads)
+	: m_channels(checkChannels(channels)), m_fftSize(checkFFTSize(fftSize)),
+	  m_hop(checkNotZero(hop, "Hop")),
+	  m_averages(checkNotZero(averages, "Averages")),
+	  m_threads(std::max(1u, threads)),
+	  m_frames(channels, std::vector<float>(fftSize)),
+	  m_sums(channels, std::vector<double>(fftSize / 2 + 1, 0)),
+	  m_framing{0, 0, 0}, m_front(0) {
+	// The real FFT of n points is computed with a complex FFT of n / 2
+	const size_t points = fftSize / 2;
+
+	m_window.resize(fftSize);
+	double gain = 0;
+	for (size_t n = 0; n < fftSize; ++n) {
+		m_window[n] = static_cast<float>(windowValue(window, n, fftSize));
+		gain += m_window[n];
+	}
+
+	unsigned bits = 0;
+	while ((static_cast<size_t>(1) << bits) < points) {
+		++bits;
+	}
+	m_bitReverse.resize(points);
+	for (size_t n = 0; n < points; ++n) {
+		std::uint32_t reversed = 0;
+		for (unsigned b = 0; b < bits; ++b) {
+			reversed |= static_cast<std::uint32_t>((n >> b) & 1)
+						<< (bits - 1 - b);
+		}
+		m_bitReverse[n] = reversed;
+	}
+
+	// The stage combining transforms of half points starts at half - 1
+	for (size_t half = 1; half < points; half *= 2) {
+		for (size_t j = 0; j < half; ++j) {
+			const double angle = PI * j / half;
+			m_twiddleRe.push_back(static_cast<float>(std::cos(angle)));
+			m_twiddleIm.push_back(static_cast<float>(-std::sin(angle)));
+		}
+	}
+	for (size_t k = 0; k < points; ++k) {
+		const double angle = 2 * PI * k / fftSize;
+		m_splitRe.push_back(static_cast<float>(std::cos(angle)));
+		m_splitIm.push_back(static_cast<float>(-std::sin(angle)));
+	}
+
+	// Bins other than DC and Nyquist hold the power of both signs
+	m_scale.assign(points + 1, 2.0 / (gain * gain * averages));
+	m_scale.front() /= 2;
+	m_scale.back() /= 2;
+
+	m_buffers[0].assign(channels * getBins(), 0);
+	m_buffers[1].assign(channels * getBins(), 0);
+}
+
+size_t SpectrumStage::process(const std::int16_t *const *in,
+							  const size_t samples, const SIMDLevel level) {
+	const size_t threads = std::min<size_t>(m_threads, m_channels);
+	size_t spectra;
+	if (threads <= 1) {
+		spectra = processChannels(in, samples, level, 0, m_channels,
+								  &m_framing);
+	} else {
+		// The first block of channels updates the framing of the stage. The
+		// others follow the same framing from a copy of the state
+		const size_t block = (m_channels + threads - 1) / threads;
+		std::vector<Framing> framings(threads, m_framing);
+		WorkerPool::getShared().run(threads, m_threads, [&](const size_t t) {
+			const size_t found = processChannels(
+				in, samples, level, std::min(m_channels, t * block),
+				std::min(m_channels, (t + 1) * block),
+				t == 0 ? &m_framing : &framings[t]);
+			if (t == 0) {
+				spectra = found;
+			}
+		});
+	}
+
+	if (spectra > 0) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_front = 1 - m_front;
+		m_published += spectra;
+	}
+	return spectra;
+}
+
+std::uint64_t SpectrumStage::getSpectrum(const size_t channel,
+										 std::vector<float> *spectrum) const {
+	if (channel >= m_channels) {
+		throw errors::DAQStageError("Channel " + std::to_string(channel) +
+									" not found");
+	}
+	const size_t bins = getBins();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto first = m_buffers[m_front].begin() + channel * bins;
+	spectrum->assign(first, first + bins);
+	return m_published;
+}
+
+std::uint64_t SpectrumStage::getSpectra(std::vector<float> *spectra) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	*spectra = m_buffers[m_front];
+	return m_published;
+}
+
+std::uint64_t SpectrumStage::getPublished() const {
+	return m_published;
+}
+
+size_t SpectrumStage::getBins() const {
+	return m_fftSize / 2 + 1;
+}
+
+size_t SpectrumStage::getChannels() const {
+	return m_channels;
+}
+
+size_t SpectrumStage::getFFTSize() const {
+	return m_fftSize;
+}
+
+size_t SpectrumStage::getHop() const {
+	return m_hop;
+}
+
+size_t SpectrumStage::getAverages() const {
+	return m_averages;
+}
+
+void SpectrumStage::reset() {
+	for (auto &sums : m_sums) {
+		std::fill(sums.begin(), sums.end(), 0);
+	}
+	m_framing = Framing{0, 0, 0};
+}
+
+size_t SpectrumStage::processChannels(const std::int16_t *const *in,
+									  const size_t samples,
+									  const SIMDLevel level,
+									  const size_t firstChannel,
+									  const size_t lastChannel,
+									  Framing *framing) {
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	// Only process writes the back buffer, so it can read m_front unlocked
+	float *back = m_buffers[1 - m_front].data();
+	const size_t bins = getBins();
+
+	Framing state = *framing;
+	size_t spectra = 0;
+	for (size_t c = firstChannel; c < lastChannel; ++c) {
+		state = *framing;
+		spectra = 0;
+		float *frame = m_frames[c].data();
+		size_t pos = 0;
+		while (pos < samples) {
+			if (state.skip > 0) {
+				const size_t skipped = std::min(state.skip, samples - pos);
+				state.skip -= skipped;
+				pos += skipped;
+				continue;
+			}
+
+			const size_t count =
+				std::min(m_fftSize - state.filled, samples - pos);
+			for (size_t i = 0; i < count; ++i) {
+				frame[state.filled + i] = in[c][pos + i];
+			}
+			state.filled += count;
+			pos += count;
+			if (state.filled < m_fftSize) {
+				break;
+			}
+
+			accumulate(c, used);
+			if (++state.frames == m_averages) {
+				auto &sums = m_sums[c];
+				float *spectrum = back + c * bins;
+				for (size_t k = 0; k < bins; ++k) {
+					spectrum[k] = static_cast<float>(sums[k] * m_scale[k]);
+				}
+				std::fill(sums.begin(), sums.end(), 0);
+				state.frames = 0;
+				++spectra;
+			}
+
+			if (m_hop < m_fftSize) {
+				std::copy(frame + m_hop, frame + m_fftSize, frame);
+				state.filled = m_fftSize - m_hop;
+			} else {
+				state.filled = 0;
+				state.skip = m_hop - m_fftSize;
+			}
+		}
+	}
+	*framing = state;
+	return spectra;
+}
+
+void SpectrumStage::accumulate(const size_t channel, const SIMDLevel level) {
+	const size_t points = m_fftSize / 2;
+	const float *frame = m_frames[channel].data();
+
+	// Even samples as the real part and odd ones as the imaginary part,
+	// windowed and in bit reversed order. Reused between calls
+	static thread_local std::vector<float> re, im;
+	re.resize(points);
+	im.resize(points);
+	for (size_t n = 0; n < points; ++n) {
+		const std::uint32_t r = m_bitReverse[n];
+		re[r] = frame[2 * n] * m_window[2 * n];
+		im[r] = frame[2 * n + 1] * m_window[2 * n + 1];
+	}
+
+	for (size_t half = 1; half < points; half *= 2) {
+		const float *wRe = m_twiddleRe.data() + half - 1;
+		const float *wIm = m_twiddleIm.data() + half - 1;
+#ifdef IRIO_X86_SIMD
+		if (level == SIMDLevel::AVX2 && half >= 8) {
+			stageAVX2(re.data(), im.data(), points, half, wRe, wIm);
+			continue;
+		} else if (level >= SIMDLevel::SSSE3 && half >= 4) {
+			stageSSSE3(re.data(), im.data(), points, half, wRe, wIm);
+			continue;
+		}
+#endif
+		stageScalar(re.data(), im.data(), points, half, wRe, wIm);
+	}
+#ifndef IRIO_X86_SIMD
+	static_cast<void>(level);
+#endif
+
+	// With Z the transform of the complex sequence, the transforms of the
+	// even and odd samples are E = (Z[k] + Z*[p - k]) / 2 and
+	// O = (Z[k] - Z*[p - k]) / 2i, and the real transform is E + W^k O
+	double *sums = m_sums[channel].data();
+	const double dc = re[0] + im[0], nyquist = re[0] - im[0];
+	sums[0] += dc * dc;
+	sums[points] += nyquist * nyquist;
+	for (size_t k = 1; k < points; ++k) {
+		const float eRe = (re[k] + re[points - k]) / 2;
+		const float eIm = (im[k] - im[points - k]) / 2;
+		const float oRe = (im[k] + im[points - k]) / 2;
+		const float oIm = (re[points - k] - re[k]) / 2;
+		const float xRe = eRe + m_splitRe[k] * oRe - m_splitIm[k] * oIm;
+		const float xIm = eIm + m_splitRe[k] * oIm + m_splitIm[k] * oRe;
+		sums[k] += static_cast<double>(xRe) * xRe +
+				   static_cast<double>(xIm) * xIm;
+	}
+}
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,530 @@
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "daq/triggeredCapture.h"
+#include "errorsIrio.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace daq {
+
+namespace {
+
+size_t checkChannels(const size_t channels) {
+	if (channels == 0) {
+		throw errors::DAQStageError("DAQ streams require at least one channel");
+	}
+	return channels;
+}
+
+size_t checkBlockSamples(const size_t elements, const size_t channels) {
+	// Captures address the samples by block, so every block must start
+	// with the first channel
+	const size_t samples = getBlockSamples(elements, channels);
+	if (samples == 0 || samples * channels != elements * 4) {
+		throw errors::DAQStageError("Blocks of " + std::to_string(elements) +
+									" elements do not hold whole samples of " +
+									std::to_string(channels) + " channels");
+	}
+	return samples;
+}
+
+size_t checkWindow(const size_t preSamples, const size_t postSamples) {
+	if (preSamples + postSamples == 0) {
+		throw errors::DAQStageError("Captures require at least one sample");
+	}
+	return preSamples;
+}
+
+size_t checkCaptures(const size_t captures) {
+	if (captures == 0) {
+		throw errors::DAQStageError("At least one capture is required");
+	}
+	return captures;
+}
+
+/**
+ * Max number of blocks spanned by a window of samples
+ */
+size_t getCaptureBlocks(const size_t samples, const size_t blockSamples) {
+	return (samples + blockSamples - 1) / blockSamples + 1;
+}
+
+bool isEdge(const bool previous, const bool current, const TriggerEdge edge) {
+	if (previous == current) {
+		return false;
+	}
+	return edge == TriggerEdge::Both ||
+		   (edge == TriggerEdge::Rising) == current;
+}
+
+/////////////////////////////////////////////////////////////
+/// Threshold kernels
+/////////////////////////////////////////////////////////////
+
+// The kernels look for the first sample of a channel whose comparison with
+// the level differs from the previous sample's, as selected by the edge.
+// They return the sample found or the number of samples scanned
+
+size_t crossingScalar(const std::int16_t *x, size_t first,
+					  const size_t samples, const size_t channels,
+					  const std::int16_t level, const TriggerEdge edge,
+					  bool *above) {
+	for (; first < samples; ++first) {
+		const bool current = x[first * channels] >= level;
+		const bool fired = isEdge(*above, current, edge);
+		*above = current;
+		if (fired) {
+			break;
+		}
+	}
+	return first;
+}
+
+#ifdef IRIO_X86_SIMD
+// The interleaved values are compared at once and the channel is selected
+// from the movemask, which has 2 bits per value. The bits of the previous
+// sample of each value are those 2 x channels positions below, taken from
+// the previous vector for the first ones
+
+std::uint32_t selectEdges(const std::uint32_t current,
+						  const std::uint32_t previous,
+						  const TriggerEdge edge) {
+	const std::uint32_t rising = current & ~previous;
+	const std::uint32_t falling = ~current & previous;
+	return edge == TriggerEdge::Rising	  ? rising
+		   : edge == TriggerEdge::Falling ? falling
+										  : rising | falling;
+}
+
+__attribute__((target("ssse3")))
+size_t crossingSSSE3(const std::int16_t *values, const size_t samples,
+					 const size_t channel, const size_t channels,
+					 const std::int16_t level, const TriggerEdge edge,
+					 bool *above, bool *found) {
+	const __m128i below = _mm_set1_epi16(static_cast<std::int16_t>(level - 1));
+	std::uint32_t pattern = 0;
+	for (size_t k = channel; k < 8; k += channels) {
+		pattern |= 1u << (2 * k);
+	}
+	const unsigned shift = static_cast<unsigned>(16 - 2 * channels);
+	std::uint32_t previous = *above ? 0xFFFF : 0;
+
+	const size_t count = samples * channels;
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const std::uint32_t current = static_cast<std::uint32_t>(
+			_mm_movemask_epi8(_mm_cmpgt_epi16(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)),
+				below)));
+		const std::uint32_t before = (((current << 16) | previous) >> shift) &
+									 0xFFFF;
+		const std::uint32_t crossings =
+			selectEdges(current, before, edge) & pattern;
+		if (crossings != 0) {
+			const unsigned bit =
+				static_cast<unsigned>(__builtin_ctz(crossings));
+			*above = ((current >> bit) & 1) != 0;
+			*found = true;
+			return (i + bit / 2) / channels;
+		}
+		previous = current;
+	}
+	*above = ((previous >> (2 * (8 - channels + channel))) & 1) != 0;
+	return i / channels;
+}
+
+__attribute__((target("avx2")))
+size_t crossingAVX2(const std::int16_t *values, const size_t samples,
+					const size_t channel, const size_t channels,
+					const std::int16_t level, const TriggerEdge edge,
+					bool *above, bool *found) {
+	const __m256i below =
+		_mm256_set1_epi16(static_cast<std::int16_t>(level - 1));
+	std::uint32_t pattern = 0;
+	for (size_t k = channel; k < 16; k += channels) {
+		pattern |= 1u << (2 * k);
+	}
+	const unsigned shift = static_cast<unsigned>(32 - 2 * channels);
+	std::uint64_t previous = *above ? 0xFFFFFFFF : 0;
+
+	const size_t count = samples * channels;
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i v =
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+		const std::uint64_t current = static_cast<std::uint32_t>(
+			_mm256_movemask_epi8(_mm256_cmpgt_epi16(v, below)));
+		const std::uint32_t before =
+			static_cast<std::uint32_t>(((current << 32) | previous) >> shift);
+		const std::uint32_t crossings =
+			selectEdges(static_cast<std::uint32_t>(current), before, edge) &
+			pattern;
+		if (crossings != 0) {
+			const unsigned bit =
+				static_cast<unsigned>(__builtin_ctz(crossings));
+			*above = ((current >> bit) & 1) != 0;
+			*found = true;
+			return (i + bit / 2) / channels;
+		}
+		previous = current;
+	}
+	*above = ((previous >> (2 * (16 - channels + channel))) & 1) != 0;
+	return i / channels;
+}
+#endif
+
+}  // namespace
+
+TriggeredCapture::TriggeredCapture(const size_t channels,
+								   const size_t blockElements,
+								   const size_t preSamples,
+								   const size_t postSamples,
+								   const size_t maxCaptures,
+								   const bool hugePages)
+	: m_channels(checkChannels(channels)), m_blockElements(blockElements),
+	  m_blockSamples(checkBlockSamples(blockElements, channels)),
+	  m_preSamples(checkWindow(preSamples, postSamples)),
+	  m_postSamples(postSamples),
+	  m_historyBlocks((preSamples + m_blockSamples - 1) / m_blockSamples),
+	  // The ring, the block being written and the blocks of each capture
+	  m_pool(blockElements,
+			 m_historyBlocks + 2 +
+				 checkCaptures(maxCaptures) *
+					 getCaptureBlocks(preSamples + postSamples, m_blockSamples),
+			 hugePages),
+	  m_references(m_pool.getNumFrames(), 0),
+	  m_history(m_historyBlocks + 1, nullptr), m_slots(maxCaptures) {
+	for (auto &slot : m_slots) {
+		slot.state = SlotState::Free;
+		slot.blocks.reserve(
+			getCaptureBlocks(preSamples + postSamples, m_blockSamples));
+	}
+}
+
+std::uint64_t *TriggeredCapture::beginBlock() {
+	if (m_writing == nullptr) {
+		// The pool is large enough for all the holders of blocks
+		m_writing = m_pool.acquire();
+	}
+	return m_writing;
+}
+
+const std::uint64_t *TriggeredCapture::commitBlock(const SIMDLevel level) {
+	if (m_writing == nullptr) {
+		throw errors::DAQStageError("No block to commit");
+	}
+	const auto timestamp = std::chrono::steady_clock::now();
+	Trigger fired;
+	const bool triggered = checkTriggers(m_writing, level, &fired);
+	const std::uint64_t *block = m_writing;
+	m_writing = nullptr;
+
+	bool completed = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		addReference(block);
+		if (m_historyCount == m_history.size()) {
+			removeReference(m_history[m_historyHead]);
+			m_history[m_historyHead] = block;
+			m_historyHead = (m_historyHead + 1) % m_history.size();
+		} else {
+			m_history[(m_historyHead + m_historyCount) % m_history.size()] =
+				block;
+			++m_historyCount;
+		}
+		m_position.store(m_position.load() + m_blockSamples);
+
+		if (m_collecting != nullptr) {
+			addReference(block);
+			m_collecting->blocks.push_back(block);
+			completed = checkCompleted();
+			if (triggered) {
+				m_missed.fetch_add(1);
+			}
+		} else if (triggered) {
+			startCapture(fired, timestamp);
+			completed = m_collecting != nullptr && checkCompleted();
+		}
+	}
+	if (completed) {
+		m_cv.notify_all();
+	}
+	return block;
+}
+
+const std::uint64_t *TriggeredCapture::acquireFromDMA(
+	const TerminalsDMACommon &terminals, const std::uint32_t n,
+	const std::uint32_t timeout, const SIMDLevel level) {
+	terminals.readDataBlocking(n, m_blockElements, beginBlock(), timeout);
+	return commitBlock(level);
+}
+
+void TriggeredCapture::trigger() {
+	m_softwareTrigger.store(true);
+}
+
+void TriggeredCapture::setDigitalTrigger(const TerminalsDigital &terminals,
+										 const std::uint32_t n,
+										 const TriggerEdge edge) {
+	// Edges are detected from the value when the trigger is set
+	m_digitalValue = terminals.getDI(n);
+	m_digital.reset(new TerminalsDigital(terminals));
+	m_digitalN = n;
+	m_digitalEdge = edge;
+}
+
+void TriggeredCapture::setThresholdTrigger(const size_t channel,
+										   const std::int16_t level,
+										   const TriggerEdge edge) {
+	if (channel >= m_channels) {
+		throw errors::DAQStageError("Channel " + std::to_string(channel) +
+									" not found");
+	}
+	if (level == std::numeric_limits<std::int16_t>::min()) {
+		throw errors::DAQStageError("Trigger level of -32768 never crossed");
+	}
+	m_thresholdEnabled = true;
+	m_thresholdChannel = channel;
+	m_thresholdLevel = level;
+	m_thresholdEdge = edge;
+	m_thresholdKnown = false;
+}
+
+void TriggeredCapture::clearTriggers() {
+	m_digital.reset();
+	m_thresholdEnabled = false;
+}
+
+bool TriggeredCapture::getCapture(Capture *capture,
+								  const std::uint32_t timeout) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const auto ready = [this] { return !m_queue.empty(); };
+	if (timeout == 0) {
+		m_cv.wait(lock, ready);
+	} else if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeout),
+							  ready)) {
+		return false;
+	}
+	return popCapture(capture);
+}
+
+bool TriggeredCapture::tryGetCapture(Capture *capture) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return popCapture(capture);
+}
+
+void TriggeredCapture::releaseCapture(const Capture &capture) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto &slot : m_slots) {
+		if (slot.state == SlotState::Held &&
+			slot.blocks.data() == capture.blocks) {
+			for (const auto block : slot.blocks) {
+				removeReference(block);
+			}
+			slot.blocks.clear();
+			slot.state = SlotState::Free;
+			return;
+		}
+	}
+	throw errors::DAQStageError("Capture " +
+								std::to_string(capture.captureNumber) +
+								" not held by the user");
+}
+
+void TriggeredCapture::extractSamples(const Capture &capture,
+									  std::int16_t *const *out,
+									  const SIMDLevel level) const {
+	std::vector<std::int16_t*> outputs(m_channels);
+	size_t done = 0;
+	for (size_t b = 0; b < capture.numBlocks && done < capture.samples; ++b) {
+		const size_t first = b == 0 ? capture.firstSample : 0;
+		const size_t count =
+			std::min(m_blockSamples - first, capture.samples - done);
+		const std::uint64_t *words = capture.blocks[b];
+		if ((first * m_channels) % 4 == 0) {
+			for (size_t c = 0; c < m_channels; ++c) {
+				outputs[c] = out[c] + done;
+			}
+			deinterleave(words + first * m_channels / 4, count, m_channels,
+						 outputs.data(), level);
+		} else {
+			// Start of the capture in the middle of a DMA word
+			const auto values = reinterpret_cast<const std::int16_t*>(words);
+			for (size_t i = 0; i < count; ++i) {
+				for (size_t c = 0; c < m_channels; ++c) {
+					out[c][done + i] = values[(first + i) * m_channels + c];
+				}
+			}
+		}
+		done += count;
+	}
+}
+
+std::uint64_t TriggeredCapture::getCaptures() const {
+	return m_captures.load();
+}
+
+std::uint64_t TriggeredCapture::getMissedTriggers() const {
+	return m_missed.load();
+}
+
+std::uint64_t TriggeredCapture::getPosition() const {
+	return m_position.load();
+}
+
+size_t TriggeredCapture::getChannels() const {
+	return m_channels;
+}
+
+size_t TriggeredCapture::getBlockElements() const {
+	return m_blockElements;
+}
+
+size_t TriggeredCapture::getBlockSamples() const {
+	return m_blockSamples;
+}
+
+bool TriggeredCapture::checkTriggers(const std::uint64_t *block,
+									 const SIMDLevel level, Trigger *fired) {
+	const std::uint64_t position = m_position.load();
+	bool triggered = false;
+	// The DI is read first, so an error does not consume the software
+	// trigger
+	if (m_digital) {
+		const bool value = m_digital->getDI(m_digitalN);
+		if (isEdge(m_digitalValue, value, m_digitalEdge)) {
+			*fired = {TriggerSource::Digital, position};
+			triggered = true;
+		}
+		m_digitalValue = value;
+	}
+	if (m_softwareTrigger.exchange(false) && !triggered) {
+		*fired = {TriggerSource::Software, position};
+		triggered = true;
+	}
+	if (!m_thresholdEnabled) {
+		return triggered;
+	}
+
+	const auto values = reinterpret_cast<const std::int16_t*>(block);
+	const size_t channel = m_thresholdChannel;
+	const std::int16_t thresholdLevel = m_thresholdLevel;
+	bool above = m_thresholdKnown ? m_thresholdAbove
+								  : values[channel] >= thresholdLevel;
+	bool found = false;
+	size_t crossing = 0;
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+#ifdef IRIO_X86_SIMD
+	if (m_channels == 1 || m_channels == 2 || m_channels == 4 ||
+		m_channels == 8) {
+		if (used == SIMDLevel::AVX2) {
+			crossing = crossingAVX2(values, m_blockSamples, channel, m_channels,
+									thresholdLevel, m_thresholdEdge, &above,
+									&found);
+		} else if (used == SIMDLevel::SSSE3) {
+			crossing = crossingSSSE3(values, m_blockSamples, channel,
+									 m_channels, thresholdLevel,
+									 m_thresholdEdge, &above, &found);
+		}
+	}
+#else
+	static_cast<void>(used);
+#endif
+	if (!found) {
+		crossing = crossingScalar(values + channel, crossing, m_blockSamples,
+								  m_channels, thresholdLevel, m_thresholdEdge,
+								  &above);
+	}
+	if (crossing < m_blockSamples && !triggered) {
+		*fired = {TriggerSource::Threshold, position + crossing};
+		triggered = true;
+	}
+	// The scan stops at the first crossing
+	m_thresholdAbove =
+		values[(m_blockSamples - 1) * m_channels + channel] >= thresholdLevel;
+	m_thresholdKnown = true;
+	return triggered;
+}
+
+void TriggeredCapture::startCapture(
+	const Trigger &fired,
+	const std::chrono::steady_clock::time_point &timestamp) {
+	auto slot = std::find_if(m_slots.begin(), m_slots.end(),
+							 [](const Slot &s) {
+								 return s.state == SlotState::Free;
+							 });
+	if (slot == m_slots.end()) {
+		m_missed.fetch_add(1);
+		return;
+	}
+
+	const std::uint64_t pre = std::min<std::uint64_t>(m_preSamples,
+													  fired.position);
+	const std::uint64_t start = fired.position - pre;
+	// The history holds the start of the window
+	const std::uint64_t historyStart =
+		m_position.load() - m_historyCount * m_blockSamples;
+	const size_t first =
+		static_cast<size_t>((start - historyStart) / m_blockSamples);
+	for (size_t i = first; i < m_historyCount; ++i) {
+		const std::uint64_t *block =
+			m_history[(m_historyHead + i) % m_history.size()];
+		addReference(block);
+		slot->blocks.push_back(block);
+	}
+
+	Capture &capture = slot->capture;
+	capture.firstSample =
+		static_cast<size_t>(start - historyStart - first * m_blockSamples);
+	capture.samples = static_cast<size_t>(pre) + m_postSamples;
+	capture.preSamples = static_cast<size_t>(pre);
+	capture.triggerPosition = fired.position;
+	capture.source = fired.source;
+	capture.timestamp = timestamp;
+	slot->state = SlotState::Collecting;
+	m_collecting = &*slot;
+}
+
+bool TriggeredCapture::checkCompleted() {
+	Capture &capture = m_collecting->capture;
+	if (m_position.load() < capture.triggerPosition + m_postSamples) {
+		return false;
+	}
+	capture.blocks = m_collecting->blocks.data();
+	capture.numBlocks = m_collecting->blocks.size();
+	capture.captureNumber = m_captures.fetch_add(1);
+	m_collecting->state = SlotState::Queued;
+	m_queue.push_back(static_cast<size_t>(m_collecting - m_slots.data()));
+	m_collecting = nullptr;
+	return true;
+}
+
+void TriggeredCapture::addReference(const std::uint64_t *block) {
+	++m_references[m_pool.getFrameIndex(block)];
+}
+
+void TriggeredCapture::removeReference(const std::uint64_t *block) {
+	if (--m_references[m_pool.getFrameIndex(block)] == 0) {
+		m_pool.release(const_cast<std::uint64_t*>(block));
+	}
+}
+
+bool TriggeredCapture::popCapture(Capture *capture) {
+	if (m_queue.empty()) {
+		return false;
+	}
+	Slot &slot = m_slots[m_queue.front()];
+	m_queue.erase(m_queue.begin());
+	slot.state = SlotState::Held;
+	*capture = slot.capture;
+	return true;
+}
+
+}  // namespace daq
+}  // namespace irio
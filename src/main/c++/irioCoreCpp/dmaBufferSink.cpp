@@ -0,0 +1,22 @@
+#include <dmaBufferSink.h>
+
+namespace irio {
+
+NiFpga_Status HostMemoryBufferSink::acquire(const NiFpga_Session &session,
+											const std::uint32_t fifo,
+											const size_t elementsToAcquire,
+											const std::uint32_t timeout,
+											std::uint64_t **data,
+											size_t *elementsAcquired) {
+	return NiFpga_AcquireFifoReadElementsU64(session, fifo, data,
+											 elementsToAcquire, timeout,
+											 elementsAcquired, nullptr);
+}
+
+NiFpga_Status HostMemoryBufferSink::release(const NiFpga_Session &session,
+											const std::uint32_t fifo,
+											const size_t elementsToRelease) {
+	return NiFpga_ReleaseFifoElements(session, fifo, elementsToRelease);
+}
+
+}  // namespace irio
@@ -0,0 +1,236 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "dmaSharedPublisher.h"
+#include "dmaSharedRing.h"
+#include "errorsIrio.h"
+
+namespace irio {
+
+using shared::RingHeader;
+using shared::ConsumerEntry;
+using shared::SlotHeader;
+
+namespace {
+
+bool isProcessAlive(const pid_t pid) {
+	return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+/**
+ * Whether an existing shared memory object is the ring of a publisher that
+ * is no longer running. Objects that are not rings, or whose publisher may
+ * still be initializing them, are not stale
+ */
+bool isStaleRing(const std::string &name) {
+	const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		// Removed meanwhile
+		return errno == ENOENT;
+	}
+	struct stat st;
+	void *addr = MAP_FAILED;
+	if (fstat(fd, &st) == 0 &&
+		static_cast<size_t>(st.st_size) >= sizeof(RingHeader)) {
+		addr = mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (addr == MAP_FAILED) {
+		return false;
+	}
+
+	const auto header = static_cast<const RingHeader*>(addr);
+	const bool stale =
+		header->magic.load(std::memory_order_acquire) == shared::RING_MAGIC &&
+		header->version == shared::RING_VERSION &&
+		(!header->publisherAlive.load(std::memory_order_acquire) ||
+		 !isProcessAlive(
+			 header->publisherPid.load(std::memory_order_relaxed)));
+	munmap(addr, sizeof(RingHeader));
+	return stale;
+}
+
+}  // namespace
+
+DMASharedPublisher::DMASharedPublisher(const TerminalsDMACommon &terminals,
+									   const std::uint32_t n,
+									   const std::string &name,
+									   const size_t blockElements,
+									   const size_t numSlots,
+									   const size_t maxConsumers,
+									   const SlowConsumerPolicy policy,
+									   const mode_t mode)
+	: m_terminals(terminals), m_n(n), m_name(shared::getShmName(name)),
+	  m_policy(policy) {
+	// Checks that the DMA exists
+	m_terminals.getNCh(n);
+
+	if (blockElements == 0 || numSlots < 2 || maxConsumers == 0) {
+		throw errors::SharedMemoryError(
+			"A shared DMA ring requires a block size greater than 0, "
+			"at least 2 slots and 1 consumer");
+	}
+	m_size = shared::getRingSize(blockElements, numSlots, maxConsumers);
+
+	int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, mode);
+	if (fd < 0 && errno == EEXIST && isStaleRing(m_name)) {
+		// Ring of a previous publisher not destroyed properly
+		shm_unlink(m_name.c_str());
+		fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, mode);
+	}
+	if (fd < 0) {
+		throw errors::SharedMemoryError("Unable to create " + m_name + ": " +
+										strerror(errno));
+	}
+	void *addr = MAP_FAILED;
+	// The umask must not remove the permissions given
+	if (fchmod(fd, mode) == 0 && ftruncate(fd, m_size) == 0) {
+		addr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	const std::string err = strerror(errno);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		shm_unlink(m_name.c_str());
+		throw errors::SharedMemoryError("Unable to map " + m_name + ": " + err);
+	}
+
+	// The memory is zero filled, so consumers and slots are free
+	m_header = static_cast<RingHeader*>(addr);
+	m_header->version = shared::RING_VERSION;
+	m_header->dmaNumber = n;
+	m_header->maxConsumers = static_cast<std::uint32_t>(maxConsumers);
+	m_header->blockElements = blockElements;
+	m_header->numSlots = numSlots;
+	m_header->slotStride = shared::getSlotStride(blockElements);
+	m_header->skipAhead = policy == SlowConsumerPolicy::SkipAhead;
+	m_header->publisherAlive.store(1, std::memory_order_relaxed);
+	m_header->publisherPid.store(getpid(), std::memory_order_relaxed);
+	m_header->magic.store(shared::RING_MAGIC, std::memory_order_release);
+}
+
+DMASharedPublisher::~DMASharedPublisher() {
+	m_header->publisherAlive.store(0, std::memory_order_release);
+	munmap(m_header, m_size);
+	shm_unlink(m_name.c_str());
+}
+
+bool DMASharedPublisher::publishFromDMA(const std::uint32_t timeout) {
+	auto slot = beginWrite();
+	if (slot == nullptr) {
+		return false;
+	}
+
+	try {
+		m_terminals.readDataBlocking(m_n, m_header->blockElements,
+									 shared::getSlotData(slot), timeout);
+	} catch (...) {
+		// The previous block of the slot may be partially overwritten
+		slot->seqlock.store(0, std::memory_order_release);
+		throw;
+	}
+
+	endWrite(slot, m_header->blockElements);
+	return true;
+}
+
+bool DMASharedPublisher::publish(const std::uint64_t *data,
+								 const size_t elements) {
+	if (elements > m_header->blockElements) {
+		throw errors::SharedMemoryError(
+			"Block of " + std::to_string(elements) +
+			" elements does not fit in the slots of " + m_name);
+	}
+
+	auto slot = beginWrite();
+	if (slot == nullptr) {
+		return false;
+	}
+	std::memcpy(shared::getSlotData(slot), data,
+				elements * sizeof(std::uint64_t));
+	endWrite(slot, elements);
+	return true;
+}
+
+std::uint64_t DMASharedPublisher::getPublishedBlocks() const {
+	return m_header->published.load(std::memory_order_relaxed);
+}
+
+std::uint64_t DMASharedPublisher::getRejectedBlocks() const {
+	return m_header->rejected.load(std::memory_order_relaxed);
+}
+
+size_t DMASharedPublisher::getNumConsumers() const {
+	const auto consumers = shared::getConsumers(m_header);
+	size_t count = 0;
+	for (size_t i = 0; i < m_header->maxConsumers; ++i) {
+		count += consumers[i].used.load(std::memory_order_relaxed) ==
+				 shared::CONSUMER_USED;
+	}
+	return count;
+}
+
+const std::string &DMASharedPublisher::getName() const {
+	return m_name;
+}
+
+SlotHeader *DMASharedPublisher::beginWrite() {
+	const auto seq = m_header->published.load(std::memory_order_relaxed);
+	const auto numSlots = m_header->numSlots;
+
+	if (m_policy == SlowConsumerPolicy::WaitSlowest && seq >= numSlots) {
+		// The slot holds the block seq - numSlots
+		const auto isSlotRead = [this, seq, numSlots] {
+			const auto consumers = shared::getConsumers(m_header);
+			for (size_t i = 0; i < m_header->maxConsumers; ++i) {
+				if (consumers[i].used.load(std::memory_order_acquire) ==
+						shared::CONSUMER_USED &&
+					consumers[i].cursor.load(std::memory_order_acquire) <=
+						seq - numSlots) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		if (!isSlotRead()) {
+			releaseDeadConsumers();
+			if (!isSlotRead()) {
+				m_header->rejected.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+		}
+	}
+
+	auto slot = shared::getSlot(m_header, seq);
+	slot->seqlock.store(shared::writingSeqlock(seq), std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	return slot;
+}
+
+void DMASharedPublisher::endWrite(SlotHeader *slot, const size_t elements) {
+	const auto seq = m_header->published.load(std::memory_order_relaxed);
+	slot->elements = elements;
+	slot->seqlock.store(shared::writtenSeqlock(seq), std::memory_order_release);
+	m_header->published.store(seq + 1, std::memory_order_release);
+}
+
+void DMASharedPublisher::releaseDeadConsumers() {
+	const auto consumers = shared::getConsumers(m_header);
+	for (size_t i = 0; i < m_header->maxConsumers; ++i) {
+		if (consumers[i].used.load(std::memory_order_acquire) ==
+				shared::CONSUMER_USED &&
+			!isProcessAlive(consumers[i].pid.load(std::memory_order_relaxed))) {
+			consumers[i].used.store(shared::CONSUMER_FREE,
+									std::memory_order_release);
+		}
+	}
+}
+
+}  // namespace irio
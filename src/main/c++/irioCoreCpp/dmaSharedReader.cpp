@@ -0,0 +1,217 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "dmaSharedReader.h"
+#include "dmaSharedRing.h"
+#include "errorsIrio.h"
+
+namespace irio {
+
+namespace {
+
+/// Polls done yielding the CPU before sleeping between polls
+constexpr unsigned int POLLS_BEFORE_SLEEP = 100;
+constexpr std::chrono::microseconds POLL_SLEEP{50};
+
+}  // namespace
+
+DMASharedReader::DMASharedReader(const std::string &name)
+	: m_name(shared::getShmName(name)) {
+	const int fd = shm_open(m_name.c_str(), O_RDWR, 0);
+	if (fd < 0) {
+		throw errors::SharedMemoryError("Unable to open " + m_name + ": " +
+										strerror(errno));
+	}
+	struct stat st;
+	void *addr = MAP_FAILED;
+	if (fstat(fd, &st) == 0 &&
+		static_cast<size_t>(st.st_size) >= sizeof(shared::RingHeader)) {
+		m_size = st.st_size;
+		addr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (addr == MAP_FAILED) {
+		throw errors::SharedMemoryError("Unable to map " + m_name);
+	}
+
+	m_header = static_cast<shared::RingHeader*>(addr);
+	if (m_header->magic.load(std::memory_order_acquire) != shared::RING_MAGIC ||
+		m_header->version != shared::RING_VERSION ||
+		m_size < shared::getRingSize(m_header->blockElements,
+									 m_header->numSlots,
+									 m_header->maxConsumers)) {
+		munmap(m_header, m_size);
+		throw errors::SharedMemoryError(m_name + " is not a valid DMA ring");
+	}
+
+	const auto consumers = shared::getConsumers(m_header);
+	for (size_t i = 0; i < m_header->maxConsumers && !m_entry; ++i) {
+		std::uint32_t expected = shared::CONSUMER_FREE;
+		if (consumers[i].used.compare_exchange_strong(
+				expected, shared::CONSUMER_CLAIMED)) {
+			m_entry = &consumers[i];
+		}
+	}
+	if (m_entry == nullptr) {
+		munmap(m_header, m_size);
+		throw errors::SharedMemoryError(
+			"Maximum number of consumers reached in " + m_name);
+	}
+
+	m_cursor = m_header->published.load(std::memory_order_acquire);
+	m_entry->pid.store(getpid(), std::memory_order_relaxed);
+	m_entry->skipped.store(0, std::memory_order_relaxed);
+	m_entry->cursor.store(m_cursor, std::memory_order_relaxed);
+	m_entry->used.store(shared::CONSUMER_USED, std::memory_order_release);
+}
+
+DMASharedReader::~DMASharedReader() {
+	m_entry->used.store(shared::CONSUMER_FREE, std::memory_order_release);
+	munmap(m_header, m_size);
+}
+
+void DMASharedReader::acquireBlock(DMASharedBlock *block,
+								   const std::uint32_t timeout) {
+	const auto deadline = std::chrono::steady_clock::now() +
+						  std::chrono::milliseconds(timeout);
+	unsigned int polls = 0;
+	while (!tryAcquireBlock(block)) {
+		if (!m_header->publisherAlive.load(std::memory_order_acquire)) {
+			// Blocks published just before destroying the publisher
+			if (tryAcquireBlock(block)) {
+				return;
+			}
+			throw errors::SharedMemoryError("The publisher of " + m_name +
+											" was destroyed");
+		}
+		if (timeout != 0 && std::chrono::steady_clock::now() >= deadline) {
+			throw errors::DMAReadTimeout(m_name + ", DMA",
+										 m_header->dmaNumber);
+		}
+		if (++polls < POLLS_BEFORE_SLEEP) {
+			std::this_thread::yield();
+		} else {
+			std::this_thread::sleep_for(POLL_SLEEP);
+		}
+	}
+}
+
+bool DMASharedReader::tryAcquireBlock(DMASharedBlock *block) {
+	if (m_acquired) {
+		throw errors::SharedMemoryError("A block of " + m_name +
+										" is already acquired");
+	}
+
+	const auto numSlots = m_header->numSlots;
+	while (true) {
+		const auto published =
+			m_header->published.load(std::memory_order_acquire);
+		if (m_cursor >= published) {
+			return false;
+		}
+
+		// Skip ahead to the oldest block that is not being overwritten. The
+		// oldest block of the ring is only kept for the slow consumers when
+		// the publisher waits for them
+		const std::uint64_t kept = numSlots - m_header->skipAhead;
+		if (published - m_cursor > kept) {
+			skipBlocks(published - kept - m_cursor);
+		}
+
+		auto slot = shared::getSlot(m_header, m_cursor);
+		const auto seqlock = slot->seqlock.load(std::memory_order_acquire);
+		if (seqlock != shared::writtenSeqlock(m_cursor)) {
+			// Overwritten or lost after reading the number of blocks published
+			skipBlocks(1);
+			continue;
+		}
+
+		block->data = shared::getSlotData(slot);
+		block->elements = slot->elements;
+		block->sequence = m_cursor;
+		block->skipped = m_skippedSinceLast;
+		m_skippedSinceLast = 0;
+		m_acquired = true;
+		m_acquiredSeqlock = seqlock;
+		return true;
+	}
+}
+
+bool DMASharedReader::releaseBlock() {
+	if (!m_acquired) {
+		throw errors::SharedMemoryError("No block of " + m_name +
+										" acquired");
+	}
+
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const auto seqlock = shared::getSlot(m_header, m_cursor)
+							 ->seqlock.load(std::memory_order_relaxed);
+
+	m_acquired = false;
+	m_cursor++;
+	m_entry->cursor.store(m_cursor, std::memory_order_release);
+	return seqlock == m_acquiredSeqlock;
+}
+
+size_t DMASharedReader::readBlock(std::uint64_t *data,
+								  const size_t maxElements,
+								  std::uint64_t *sequence,
+								  const std::uint32_t timeout) {
+	if (maxElements < m_header->blockElements) {
+		throw errors::SharedMemoryError(
+			"Buffer too small for the blocks of " + m_name);
+	}
+
+	DMASharedBlock block;
+	while (true) {
+		acquireBlock(&block, timeout);
+		std::memcpy(data, block.data, block.elements * sizeof(std::uint64_t));
+		if (releaseBlock()) {
+			break;
+		}
+		// Overwritten while copying it
+		countSkipped(1);
+	}
+
+	if (sequence) {
+		*sequence = block.sequence;
+	}
+	return block.elements;
+}
+
+size_t DMASharedReader::getBlockElements() const {
+	return m_header->blockElements;
+}
+
+size_t DMASharedReader::getNumSlots() const {
+	return m_header->numSlots;
+}
+
+std::uint32_t DMASharedReader::getDMANumber() const {
+	return m_header->dmaNumber;
+}
+
+std::uint64_t DMASharedReader::getSkippedBlocks() const {
+	return m_entry->skipped.load(std::memory_order_relaxed);
+}
+
+void DMASharedReader::skipBlocks(const std::uint64_t blocks) {
+	m_cursor += blocks;
+	m_entry->cursor.store(m_cursor, std::memory_order_release);
+	countSkipped(blocks);
+}
+
+void DMASharedReader::countSkipped(const std::uint64_t blocks) {
+	m_skippedSinceLast += blocks;
+	m_entry->skipped.fetch_add(blocks, std::memory_order_relaxed);
+}
+
+}  // namespace irio
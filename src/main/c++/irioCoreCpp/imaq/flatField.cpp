@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "imaq/flatField.h"
+#include "errorsIrio.h"
+#include "workerPool.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+std::vector<std::uint16_t> checkDark(const size_t width, const size_t height,
+									 const std::vector<std::uint16_t> &dark) {
+	if (width == 0 || height == 0) {
+		throw errors::ImageStageError("Frames require at least one pixel");
+	}
+	if (dark.empty()) {
+		return std::vector<std::uint16_t>(width * height, 0);
+	}
+	if (dark.size() != width * height) {
+		throw errors::ImageStageError(
+			"Dark frame of " + std::to_string(dark.size()) +
+			" pixels for images of " + std::to_string(width * height));
+	}
+	return dark;
+}
+
+std::vector<float> computeGain(const std::vector<std::uint16_t> &dark,
+							   const std::vector<std::uint16_t> &flat) {
+	std::vector<float> gain(dark.size(), 1.0f);
+	if (flat.empty()) {
+		return gain;
+	}
+	if (flat.size() != dark.size()) {
+		throw errors::ImageStageError(
+			"Flat frame of " + std::to_string(flat.size()) +
+			" pixels for images of " + std::to_string(dark.size()));
+	}
+
+	double sum = 0;
+	size_t valid = 0;
+	for (size_t i = 0; i < flat.size(); ++i) {
+		if (flat[i] > dark[i]) {
+			sum += flat[i] - dark[i];
+			valid++;
+		}
+	}
+	if (valid == 0) {
+		throw errors::ImageStageError(
+			"The flat frame has no pixel above the dark frame");
+	}
+
+	const double target = sum / valid;
+	for (size_t i = 0; i < flat.size(); ++i) {
+		if (flat[i] > dark[i]) {
+			gain[i] = static_cast<float>(target / (flat[i] - dark[i]));
+		}
+	}
+	return gain;
+}
+
+/////////////////////////////////////////////////////////////
+/// Correction kernels
+/////////////////////////////////////////////////////////////
+
+// All the kernels compute the same operations in single precision and round
+// to nearest, so the result does not depend on the instruction set
+
+void correctScalar(std::uint16_t *row, const std::uint16_t *dark,
+				   const float *gain, size_t first, const size_t pixels,
+				   const float maxValue) {
+	for (; first < pixels; ++first) {
+		const float value =
+			static_cast<float>(static_cast<std::int32_t>(row[first]) -
+							   dark[first]) * gain[first];
+		row[first] = static_cast<std::uint16_t>(
+			std::nearbyint(std::min(std::max(value, 0.0f), maxValue)));
+	}
+}
+
+#ifdef IRIO_X86_SIMD
+__attribute__((target("ssse3")))
+size_t correctSSSE3(std::uint16_t *row, const std::uint16_t *dark,
+					const float *gain, const size_t pixels,
+					const float maxValue) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 vmax = _mm_set1_ps(maxValue);
+	// Without packus_epi32, values are biased to fit the signed saturation
+	const __m128i bias = _mm_set1_epi32(0x8000);
+	const __m128i flip = _mm_set1_epi16(static_cast<std::int16_t>(0x8000));
+	size_t i = 0;
+	for (; i + 8 <= pixels; i += 8) {
+		const __m128i raw =
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+		const __m128i off =
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(dark + i));
+		const __m128i lo = _mm_sub_epi32(_mm_unpacklo_epi16(raw, zero),
+										 _mm_unpacklo_epi16(off, zero));
+		const __m128i hi = _mm_sub_epi32(_mm_unpackhi_epi16(raw, zero),
+										 _mm_unpackhi_epi16(off, zero));
+		__m128 flo = _mm_mul_ps(_mm_cvtepi32_ps(lo), _mm_loadu_ps(gain + i));
+		__m128 fhi =
+			_mm_mul_ps(_mm_cvtepi32_ps(hi), _mm_loadu_ps(gain + i + 4));
+		flo = _mm_min_ps(_mm_max_ps(flo, _mm_setzero_ps()), vmax);
+		fhi = _mm_min_ps(_mm_max_ps(fhi, _mm_setzero_ps()), vmax);
+		const __m128i ilo = _mm_sub_epi32(_mm_cvtps_epi32(flo), bias);
+		const __m128i ihi = _mm_sub_epi32(_mm_cvtps_epi32(fhi), bias);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i),
+						 _mm_xor_si128(_mm_packs_epi32(ilo, ihi), flip));
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t correctAVX2(std::uint16_t *row, const std::uint16_t *dark,
+				   const float *gain, const size_t pixels,
+				   const float maxValue) {
+	const __m256 vmax = _mm256_set1_ps(maxValue);
+	size_t i = 0;
+	for (; i + 16 <= pixels; i += 16) {
+		const __m256i lo = _mm256_sub_epi32(
+			_mm256_cvtepu16_epi32(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i))),
+			_mm256_cvtepu16_epi32(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(dark + i))));
+		const __m256i hi = _mm256_sub_epi32(
+			_mm256_cvtepu16_epi32(_mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(row + i + 8))),
+			_mm256_cvtepu16_epi32(_mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(dark + i + 8))));
+		__m256 flo =
+			_mm256_mul_ps(_mm256_cvtepi32_ps(lo), _mm256_loadu_ps(gain + i));
+		__m256 fhi = _mm256_mul_ps(_mm256_cvtepi32_ps(hi),
+								   _mm256_loadu_ps(gain + i + 8));
+		flo = _mm256_min_ps(_mm256_max_ps(flo, _mm256_setzero_ps()), vmax);
+		fhi = _mm256_min_ps(_mm256_max_ps(fhi, _mm256_setzero_ps()), vmax);
+		// packus works per 128 bits lane, the quadwords are reordered after
+		const __m256i packed = _mm256_packus_epi32(_mm256_cvtps_epi32(flo),
+												   _mm256_cvtps_epi32(fhi));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i),
+							_mm256_permute4x64_epi64(packed, 0xD8));
+	}
+	return i;
+}
+#endif
+
+}  // namespace
+
+FlatFieldStage::FlatFieldStage(const size_t width, const size_t height,
+							   const PixelFormat format,
+							   const std::vector<std::uint16_t> &dark,
+							   const std::vector<std::uint16_t> &flat,
+							   const unsigned threads)
+	: m_width(width), m_height(height), m_format(format),
+	  m_maxValue(static_cast<float>((1u << getPixelDepth(format)) - 1)),
+	  m_threads(std::max(1u, threads)),
+	  m_dark(checkDark(width, height, dark)),
+	  m_gain(computeGain(m_dark, flat)) {}
+
+void FlatFieldStage::process(const std::uint64_t *words, std::uint16_t *image,
+							 const SIMDLevel level) const {
+	const size_t threads = std::min<size_t>(m_threads, m_height);
+	if (threads <= 1) {
+		processRows(words, image, level, 0, m_height);
+		return;
+	}
+
+	const size_t block = (m_height + threads - 1) / threads;
+	WorkerPool::getShared().run(threads, m_threads, [&](const size_t t) {
+		processRows(words, image, level, std::min(m_height, t * block),
+					std::min(m_height, (t + 1) * block));
+	});
+}
+
+const std::vector<float> &FlatFieldStage::getGain() const {
+	return m_gain;
+}
+
+size_t FlatFieldStage::getFrameWords() const {
+	return imaq::getFrameWords(m_format, m_width * m_height);
+}
+
+PixelFormat FlatFieldStage::getFormat() const {
+	return m_format;
+}
+
+void FlatFieldStage::processRows(const std::uint64_t *words,
+								 std::uint16_t *image, const SIMDLevel level,
+								 const size_t firstRow,
+								 const size_t lastRow) const {
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+
+	for (size_t r = firstRow; r < lastRow; ++r) {
+		const size_t first = r * m_width;
+		std::uint16_t *row = image + first;
+		const std::uint16_t *dark = m_dark.data() + first;
+		const float *gain = m_gain.data() + first;
+
+		unpackPixels(words, first, m_width, m_format, row, level);
+
+		size_t done = 0;
+#ifdef IRIO_X86_SIMD
+		if (used == SIMDLevel::AVX2) {
+			done = correctAVX2(row, dark, gain, m_width, m_maxValue);
+		} else if (used == SIMDLevel::SSSE3) {
+			done = correctSSSE3(row, dark, gain, m_width, m_maxValue);
+		}
+#endif
+		correctScalar(row, dark, gain, done, m_width, m_maxValue);
+	}
+}
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,469 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "imaq/frameCodec.h"
+#include "errorsIrio.h"
+#include "workerPool.h"
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+constexpr std::uint32_t CODEC_MAGIC = 0x43465249;  // "IRFC"
+constexpr std::uint8_t CODEC_VERSION = 1;
+constexpr size_t HEADER_BYTES = 20;
+
+/// Unary prefixes of this length escape the residual, written verbatim
+constexpr unsigned ESCAPE_LENGTH = 24;
+/// Contexts selected by the bit length of the local gradient
+constexpr size_t CONTEXTS = 19;
+/// Samples after which the statistics of a context are halved
+constexpr std::uint32_t CONTEXT_RESET = 64;
+
+size_t checkBandRows(const size_t width, const size_t height,
+					 const unsigned threads) {
+	if (width == 0 || height == 0) {
+		throw errors::ImageStageError("Frames require at least one pixel");
+	}
+	if (threads > 0xFFFF) {
+		throw errors::ImageStageError("Frames can be split in up to 65535 "
+									  "bands, " + std::to_string(threads) +
+									  " threads requested");
+	}
+	const size_t bands = std::min<size_t>(std::max(1u, threads), height);
+	return (height + bands - 1) / bands;
+}
+
+size_t getMaxBandBytes(const size_t rows, const size_t width,
+					   const unsigned depth) {
+	// Longest code of a pixel plus the bytes written in advance by BitWriter
+	return (rows * width * (ESCAPE_LENGTH + depth) + 7) / 8 + 8;
+}
+
+inline void store16(std::uint8_t *out, const std::uint16_t value) {
+	std::memcpy(out, &value, sizeof(value));
+}
+
+inline void store32(std::uint8_t *out, const std::uint32_t value) {
+	std::memcpy(out, &value, sizeof(value));
+}
+
+inline std::uint16_t load16(const std::uint8_t *data) {
+	std::uint16_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+inline std::uint32_t load32(const std::uint8_t *data) {
+	std::uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+/**
+ * Writes codes from the least significant bit, 32 bits at a time
+ */
+class BitWriter {
+ public:
+	explicit BitWriter(std::uint8_t *out): m_out(out) {}
+
+	/// Writes the \p bits (up to 32) least significant bits of \p value
+	inline void put(const std::uint32_t value, const unsigned bits) {
+		m_acc |= static_cast<std::uint64_t>(value) << m_bits;
+		m_bits += bits;
+		if (m_bits >= 32) {
+			store32(m_out + m_pos, static_cast<std::uint32_t>(m_acc));
+			m_pos += 4;
+			m_acc >>= 32;
+			m_bits -= 32;
+		}
+	}
+
+	/// Writes the pending bits and returns the number of bytes written
+	size_t finish() {
+		while (m_bits > 0) {
+			m_out[m_pos++] = static_cast<std::uint8_t>(m_acc);
+			m_acc >>= 8;
+			m_bits = m_bits > 8 ? m_bits - 8 : 0;
+		}
+		return m_pos;
+	}
+
+ private:
+	std::uint8_t *m_out;
+	size_t m_pos = 0;
+	std::uint64_t m_acc = 0;
+	unsigned m_bits = 0;
+};
+
+/**
+ * Reads the codes of BitWriter. Reading past the end returns zeros, which
+ * is detected afterwards with \ref overrun
+ */
+class BitReader {
+ public:
+	BitReader(const std::uint8_t *data, const size_t size)
+		: m_data(data), m_size(size) {}
+
+	/// Reads a unary prefix of up to \p limit ones and its ending zero
+	inline unsigned ones(const unsigned limit) {
+		refill();
+		const std::uint64_t zeros = ~m_acc;
+		const unsigned n = zeros ? __builtin_ctzll(zeros) : 64;
+		if (n >= limit) {
+			consume(limit);
+			return limit;
+		}
+		consume(n + 1);
+		return n;
+	}
+
+	/// Reads \p bits bits (up to 32)
+	inline std::uint32_t get(const unsigned bits) {
+		refill();
+		const auto value = static_cast<std::uint32_t>(
+			m_acc & ((std::uint64_t(1) << bits) - 1));
+		consume(bits);
+		return value;
+	}
+
+	/// Whether more bits than available have been read
+	bool overrun() const {
+		return m_pos * 8 - m_bits > m_size * 8;
+	}
+
+ private:
+	/// Leaves at least 56 bits in the accumulator
+	inline void refill() {
+		if (m_bits >= 32) {
+			return;
+		}
+		if (m_pos + 8 <= m_size) {
+			std::uint64_t word;
+			std::memcpy(&word, m_data + m_pos, sizeof(word));
+			m_acc |= word << m_bits;
+			m_pos += (63 - m_bits) >> 3;
+			m_bits |= 56;
+		} else {
+			while (m_bits <= 56) {
+				const std::uint64_t byte = m_pos < m_size ? m_data[m_pos] : 0;
+				m_acc |= byte << m_bits;
+				m_pos++;
+				m_bits += 8;
+			}
+		}
+	}
+
+	inline void consume(const unsigned bits) {
+		m_acc >>= bits;
+		m_bits -= bits;
+	}
+
+	const std::uint8_t *m_data;
+	const size_t m_size;
+	size_t m_pos = 0;
+	std::uint64_t m_acc = 0;
+	unsigned m_bits = 0;
+};
+
+/**
+ * Adaptive Rice coding statistics of each context, as in LOCO-I
+ */
+class RiceContexts {
+ public:
+	explicit RiceContexts(const unsigned depth): m_depth(depth) {
+		const std::uint32_t initial =
+			std::max<std::uint32_t>(2, ((1u << depth) + 32) >> 6);
+		std::fill(m_sum, m_sum + CONTEXTS, initial);
+		std::fill(m_count, m_count + CONTEXTS, 1);
+	}
+
+	/// Rice parameter to code the next residual of a context: the lowest k
+	/// such that count << k >= sum, from the bit lengths of both
+	inline unsigned parameter(const size_t ctx) const {
+		const std::uint32_t count = m_count[ctx];
+		const std::uint32_t sum = m_sum[ctx];
+		const int diff = __builtin_clz(count) - __builtin_clz(sum);
+		unsigned k = diff > 0 ? diff : 0;
+		k += (count << k) < sum;
+		return std::min(k, m_depth);
+	}
+
+	inline void update(const size_t ctx, const std::uint32_t mapped) {
+		m_sum[ctx] += mapped;
+		if (++m_count[ctx] >= CONTEXT_RESET) {
+			m_sum[ctx] = (m_sum[ctx] + 1) >> 1;
+			m_count[ctx] >>= 1;
+		}
+	}
+
+ private:
+	const unsigned m_depth;
+	std::uint32_t m_sum[CONTEXTS];
+	std::uint32_t m_count[CONTEXTS];
+};
+
+/// Median edge detector on the left (a), upper (b) and upper-left (c) pixels
+inline unsigned predict(const unsigned a, const unsigned b, const unsigned c) {
+	const unsigned lo = std::min(a, b);
+	const unsigned hi = std::max(a, b);
+	if (c >= hi) {
+		return lo;
+	}
+	if (c <= lo) {
+		return hi;
+	}
+	return a + b - c;
+}
+
+/// Bit length of the local gradient, with the upper-right pixel (d)
+inline size_t getContext(const unsigned a, const unsigned b, const unsigned c,
+						 const unsigned d) {
+	const auto diff = [](const unsigned x, const unsigned y) {
+		return x > y ? x - y : y - x;
+	};
+	const unsigned gradient = diff(d, b) + diff(b, c) + diff(c, a);
+	return gradient ? 32 - __builtin_clz(gradient) : 0;
+}
+
+/**
+ * Visits the pixels of a row with their prediction and context. \p pixel
+ * codes or decodes the pixel at x and returns its value. The neighbours are
+ * kept in registers while the row is traversed; missing neighbours are
+ * replaced as in JPEG-LS, and the first row of a band (without \p prev) is
+ * predicted from the left pixel
+ */
+template <typename Pixel>
+inline void codeRow(const std::uint16_t *prev, const size_t width,
+					const unsigned mask, Pixel pixel) {
+	if (!prev) {
+		unsigned a = 0;
+		for (size_t x = 0; x < width; ++x) {
+			a = pixel(x, a, 0);
+		}
+		return;
+	}
+	unsigned b = prev[0] & mask;
+	unsigned a = b;
+	unsigned c = b;
+	for (size_t x = 0; x < width; ++x) {
+		const unsigned d = x + 1 < width ? prev[x + 1] & mask : b;
+		a = pixel(x, predict(a, b, c), getContext(a, b, c, d));
+		c = b;
+		b = d;
+	}
+}
+
+}  // namespace
+
+FrameCodec::FrameCodec(const size_t width, const size_t height,
+					   const PixelFormat format, const unsigned threads)
+	: m_width(width), m_height(height), m_format(format),
+	  m_depth(getPixelDepth(format)),
+	  m_bandRows(checkBandRows(width, height, threads)),
+	  m_bands((height + m_bandRows - 1) / m_bandRows),
+	  m_threads(std::max(1u, threads)) {}
+
+size_t FrameCodec::compress(const std::uint16_t *image,
+							std::uint8_t *out) const {
+	return compressBands(image, nullptr, getSIMDLevel(), out);
+}
+
+size_t FrameCodec::compressFrame(const std::uint64_t *words,
+								 std::uint8_t *out,
+								 const SIMDLevel level) const {
+	return compressBands(nullptr, words, level, out);
+}
+
+void FrameCodec::decompress(const std::uint8_t *data, const size_t size,
+							std::uint16_t *image) const {
+	if (size < HEADER_BYTES || load32(data) != CODEC_MAGIC) {
+		throw errors::CodecError("The data is not a compressed frame");
+	}
+	if (data[4] != CODEC_VERSION) {
+		throw errors::CodecError("Unsupported version " +
+								 std::to_string(data[4]) +
+								 " of the compressed frame");
+	}
+	const size_t bands = load16(data + 6);
+	const size_t width = load32(data + 8);
+	const size_t height = load32(data + 12);
+	const size_t bandRows = load32(data + 16);
+	if (data[5] != m_depth || width != m_width || height != m_height) {
+		throw errors::CodecError(
+			"Compressed frame of " + std::to_string(width) + "x" +
+			std::to_string(height) + " pixels of " + std::to_string(data[5]) +
+			" bits, expected " + std::to_string(m_width) + "x" +
+			std::to_string(m_height) + " pixels of " +
+			std::to_string(m_depth) + " bits");
+	}
+	if (bandRows == 0 || bands != (height + bandRows - 1) / bandRows ||
+		size < HEADER_BYTES + 4 * bands) {
+		throw errors::CodecError("Corrupted header of the compressed frame");
+	}
+
+	std::vector<size_t> offsets(bands + 1, HEADER_BYTES + 4 * bands);
+	for (size_t band = 0; band < bands; ++band) {
+		offsets[band + 1] =
+			offsets[band] + load32(data + HEADER_BYTES + 4 * band);
+	}
+	if (offsets[bands] > size) {
+		throw errors::CodecError("Truncated compressed frame, " +
+								 std::to_string(size) + " bytes of " +
+								 std::to_string(offsets[bands]));
+	}
+
+	WorkerPool::getShared().run(bands, m_threads, [&](const size_t band) {
+		decodeBand(data + offsets[band], offsets[band + 1] - offsets[band],
+				   band * bandRows, std::min(height, (band + 1) * bandRows),
+				   image);
+	});
+}
+
+size_t FrameCodec::getMaxCompressedSize() const {
+	return HEADER_BYTES + 4 * m_bands +
+		   m_bands * getMaxBandBytes(m_bandRows, m_width, m_depth);
+}
+
+size_t FrameCodec::getFrameWords() const {
+	return imaq::getFrameWords(m_format, m_width * m_height);
+}
+
+PixelFormat FrameCodec::getFormat() const {
+	return m_format;
+}
+
+size_t FrameCodec::compressBands(const std::uint16_t *image,
+								 const std::uint64_t *words,
+								 const SIMDLevel level,
+								 std::uint8_t *out) const {
+	store32(out, CODEC_MAGIC);
+	out[4] = CODEC_VERSION;
+	out[5] = static_cast<std::uint8_t>(m_depth);
+	store16(out + 6, static_cast<std::uint16_t>(m_bands));
+	store32(out + 8, static_cast<std::uint32_t>(m_width));
+	store32(out + 12, static_cast<std::uint32_t>(m_height));
+	store32(out + 16, static_cast<std::uint32_t>(m_bandRows));
+
+	// Each band is coded in its own slot of the buffer and the bands are
+	// moved together afterwards
+	const size_t dataOffset = HEADER_BYTES + 4 * m_bands;
+	const size_t slot = getMaxBandBytes(m_bandRows, m_width, m_depth);
+	WorkerPool::getShared().run(m_bands, m_threads, [&](const size_t band) {
+		const size_t bytes = encodeBand(image, words, level, band,
+										out + dataOffset + band * slot);
+		store32(out + HEADER_BYTES + 4 * band,
+				static_cast<std::uint32_t>(bytes));
+	});
+
+	size_t end = dataOffset;
+	for (size_t band = 0; band < m_bands; ++band) {
+		const size_t bytes = load32(out + HEADER_BYTES + 4 * band);
+		std::memmove(out + end, out + dataOffset + band * slot, bytes);
+		end += bytes;
+	}
+	return end;
+}
+
+size_t FrameCodec::encodeBand(const std::uint16_t *image,
+							  const std::uint64_t *words,
+							  const SIMDLevel level, const size_t band,
+							  std::uint8_t *out) const {
+	const size_t firstRow = band * m_bandRows;
+	const size_t lastRow = std::min(m_height, firstRow + m_bandRows);
+	const unsigned mask = (1u << m_depth) - 1;
+	const unsigned half = 1u << (m_depth - 1);
+
+	// Rows unpacked from the DMA words, the current and the previous one
+	static thread_local std::vector<std::uint16_t> rows;
+	if (!image) {
+		rows.resize(2 * m_width);
+	}
+
+	RiceContexts contexts(m_depth);
+	BitWriter writer(out);
+	const std::uint16_t *prev = nullptr;
+	for (size_t r = firstRow; r < lastRow; ++r) {
+		const std::uint16_t *cur;
+		if (image) {
+			cur = image + r * m_width;
+		} else {
+			std::uint16_t *row = rows.data() + (r % 2) * m_width;
+			unpackPixels(words, r * m_width, m_width, m_format, row, level);
+			cur = row;
+		}
+
+		codeRow(prev, m_width, mask, [&](const size_t x,
+										 const unsigned prediction,
+										 const size_t ctx) {
+			const unsigned value = cur[x] & mask;
+			const unsigned k = contexts.parameter(ctx);
+
+			// Residual wrapped to the bit depth and interleaved as
+			// 0, -1, 1, -2, 2... so it fits in m_depth bits
+			const int residual =
+				static_cast<int>((value - prediction + half) & mask) -
+				static_cast<int>(half);
+			const std::uint32_t mapped =
+				((static_cast<std::uint32_t>(residual) << 1) ^
+				 static_cast<std::uint32_t>(residual >> 31)) & mask;
+
+			const std::uint32_t q = mapped >> k;
+			if (q < ESCAPE_LENGTH && q + 1 + k <= 32) {
+				// Unary prefix and remainder in a single write
+				writer.put(((1u << q) - 1) |
+							   ((mapped & ((1u << k) - 1)) << (q + 1)),
+						   q + 1 + k);
+			} else if (q < ESCAPE_LENGTH) {
+				writer.put((1u << q) - 1, q + 1);
+				writer.put(mapped & ((1u << k) - 1), k);
+			} else {
+				writer.put((1u << ESCAPE_LENGTH) - 1, ESCAPE_LENGTH);
+				writer.put(mapped, m_depth);
+			}
+			contexts.update(ctx, mapped);
+			return value;
+		});
+		prev = cur;
+	}
+	return writer.finish();
+}
+
+void FrameCodec::decodeBand(const std::uint8_t *data, const size_t size,
+							const size_t firstRow, const size_t lastRow,
+							std::uint16_t *image) const {
+	const unsigned mask = (1u << m_depth) - 1;
+
+	RiceContexts contexts(m_depth);
+	BitReader reader(data, size);
+	const std::uint16_t *prev = nullptr;
+	for (size_t r = firstRow; r < lastRow; ++r) {
+		std::uint16_t *cur = image + r * m_width;
+		codeRow(prev, m_width, mask, [&](const size_t x,
+										 const unsigned prediction,
+										 const size_t ctx) {
+			const unsigned k = contexts.parameter(ctx);
+			const unsigned q = reader.ones(ESCAPE_LENGTH);
+			const std::uint32_t mapped =
+				q < ESCAPE_LENGTH ? (q << k) | reader.get(k)
+								  : reader.get(m_depth);
+			const int residual = static_cast<int>(mapped >> 1) ^
+								 -static_cast<int>(mapped & 1);
+			const unsigned value = (prediction + residual) & mask;
+			cur[x] = static_cast<std::uint16_t>(value);
+			contexts.update(ctx, mapped);
+			return value;
+		});
+		prev = cur;
+	}
+
+	if (reader.overrun()) {
+		throw errors::CodecError("Corrupted band of the compressed frame");
+	}
+}
+
+}  // namespace imaq
+}  // namespace irio
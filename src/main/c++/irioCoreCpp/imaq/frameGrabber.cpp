@@ -0,0 +1,188 @@
+#include <string>
+
+#include "imaq/frameGrabber.h"
+
+#include "errorsIrio.h"
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+/// Max time the filler thread waits for an image before checking if it must stop
+constexpr std::uint32_t FILLER_POLL_TIMEOUT_MS = 100;
+
+size_t getImageElements(const TerminalsDMAIMAQ &terminals,
+						const std::uint32_t n, const size_t imagePixelSize) {
+	return imagePixelSize * terminals.getSampleSize(n) / 8;
+}
+
+std::shared_ptr<const FrameStatsStage> checkStatsStage(
+	std::shared_ptr<const FrameStatsStage> stats, const size_t frameElements) {
+	if (stats && stats->getFrameWords() > frameElements) {
+		throw errors::ImageStageError(
+			"The statistics stage expects frames of " +
+			std::to_string(stats->getFrameWords()) + " elements, images have " +
+			std::to_string(frameElements));
+	}
+	return stats;
+}
+
+}  // namespace
+
+FrameGrabber::FrameGrabber(const TerminalsDMAIMAQ &terminals,
+						   const std::uint32_t n, const size_t imagePixelSize,
+						   const size_t numFrames, const size_t queueDepth,
+						   const bool hugePages,
+						   std::shared_ptr<const FrameStatsStage> stats)
+	: m_terminals(terminals), m_n(n),
+	  m_frameElements(getImageElements(terminals, n, imagePixelSize)),
+	  m_pool(m_frameElements, numFrames, hugePages),
+	  m_queueDepth(queueDepth == 0 || queueDepth > numFrames ? numFrames
+															 : queueDepth),
+	  m_discard(m_frameElements),
+	  m_statsStage(checkStatsStage(stats, m_frameElements)),
+	  m_frameStats(m_statsStage ? numFrames : 0), m_queue(m_queueDepth) {
+	m_thread = std::thread(&FrameGrabber::run, this);
+}
+
+FrameGrabber::~FrameGrabber() {
+	m_stop = true;
+	m_thread.join();
+}
+
+void FrameGrabber::getFrame(Frame *frame, const std::uint32_t timeout) {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const auto ready = [this] { return m_queueCount > 0 || m_error; };
+	if (timeout == 0) {
+		m_cv.wait(lock, ready);
+	} else if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeout),
+							  ready)) {
+		throw errors::DMAReadTimeout("frame grabber of DMA", m_n);
+	}
+
+	if (!popFrame(frame)) {
+		std::rethrow_exception(m_error);
+	}
+}
+
+bool FrameGrabber::tryGetFrame(Frame *frame) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (popFrame(frame)) {
+		return true;
+	}
+	if (m_error) {
+		std::rethrow_exception(m_error);
+	}
+	return false;
+}
+
+void FrameGrabber::releaseFrame(const Frame &frame) {
+	m_pool.release(frame.data);
+}
+
+std::uint64_t FrameGrabber::getFramesAcquired() const {
+	return m_acquired.load();
+}
+
+std::uint64_t FrameGrabber::getDroppedFrames() const {
+	return m_dropped.load();
+}
+
+size_t FrameGrabber::getQueuedFrames() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queueCount;
+}
+
+size_t FrameGrabber::getFrameElements() const {
+	return m_frameElements;
+}
+
+const FramePool &FrameGrabber::getPool() const {
+	return m_pool;
+}
+
+void FrameGrabber::run() {
+	while (!m_stop) {
+		auto data = takeFrame();
+		auto dst = data ? data : m_discard.data();
+
+		try {
+			m_terminals.readDataBlocking(m_n, m_frameElements, dst,
+										 FILLER_POLL_TIMEOUT_MS);
+		} catch (errors::DMAReadTimeout &) {
+			if (data) {
+				m_pool.release(data);
+			}
+			continue;
+		} catch (errors::IrioError &) {
+			if (data) {
+				m_pool.release(data);
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_error = std::current_exception();
+			m_cv.notify_all();
+			return;
+		}
+
+		const auto frameNumber = m_acquired++;
+		if (!data) {
+			m_dropped++;
+			continue;
+		}
+		const auto timestamp = std::chrono::steady_clock::now();
+
+		const FrameStats *frameStats = nullptr;
+		if (m_statsStage) {
+			auto &slot = m_frameStats[m_pool.getFrameIndex(data)];
+			m_statsStage->process(data, &slot);
+			frameStats = &slot;
+		}
+		enqueue(Frame{data, m_frameElements, frameNumber, timestamp, 0,
+					  frameStats});
+	}
+}
+
+std::uint64_t *FrameGrabber::takeFrame() {
+	auto data = m_pool.acquire();
+	if (data) {
+		return data;
+	}
+
+	// The user is not keeping up, the oldest frame is reused
+	Frame oldest;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (popFrame(&oldest)) {
+		m_dropped++;
+		return oldest.data;
+	}
+	return nullptr;
+}
+
+void FrameGrabber::enqueue(const Frame &frame) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_queueCount == m_queueDepth) {
+		Frame oldest;
+		popFrame(&oldest);
+		m_pool.release(oldest.data);
+		m_dropped++;
+	}
+	auto &slot = m_queue[(m_queueHead + m_queueCount) % m_queueDepth];
+	slot = frame;
+	slot.droppedFrames = m_dropped.load();
+	m_queueCount++;
+	m_cv.notify_one();
+}
+
+bool FrameGrabber::popFrame(Frame *frame) {
+	if (m_queueCount == 0) {
+		return false;
+	}
+	*frame = m_queue[m_queueHead];
+	m_queueHead = (m_queueHead + 1) % m_queueDepth;
+	m_queueCount--;
+	return true;
+}
+
+}  // namespace imaq
+}  // namespace irio
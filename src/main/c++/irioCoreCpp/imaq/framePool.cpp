@@ -0,0 +1,112 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "imaq/framePool.h"
+#include "errorsIrio.h"
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+size_t roundUp(const size_t value, const size_t multiple) {
+	return (value + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+FramePool::FramePool(const size_t frameElements, const size_t numFrames,
+					 const bool hugePages)
+	: m_frameElements(frameElements), m_numFrames(numFrames) {
+	if (frameElements == 0 || numFrames == 0) {
+		throw errors::FramePoolError(
+			"A frame pool requires at least one frame of one element");
+	}
+
+	m_stride = roundUp(frameElements * sizeof(std::uint64_t), CACHE_LINE_SIZE);
+	void *addr = MAP_FAILED;
+	if (hugePages) {
+		m_size = roundUp(m_stride * numFrames, HUGE_PAGE_SIZE);
+		addr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+					-1, 0);
+		m_hugePages = addr != MAP_FAILED;
+	}
+	if (addr == MAP_FAILED) {
+		m_size = roundUp(m_stride * numFrames, sysconf(_SC_PAGESIZE));
+		addr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+	}
+	if (addr == MAP_FAILED) {
+		throw errors::FramePoolError("Unable to allocate " +
+									 std::to_string(numFrames) + " frames");
+	}
+	m_memory = static_cast<std::uint8_t*>(addr);
+
+	m_free.reserve(numFrames);
+	m_isFree.assign(numFrames, true);
+	// Reversed so frames are acquired in memory order
+	for (size_t i = numFrames; i > 0; --i) {
+		m_free.push_back(
+			reinterpret_cast<std::uint64_t*>(m_memory + (i - 1) * m_stride));
+	}
+}
+
+FramePool::~FramePool() {
+	munmap(m_memory, m_size);
+}
+
+std::uint64_t *FramePool::acquire() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_free.empty()) {
+		return nullptr;
+	}
+	auto frame = m_free.back();
+	m_free.pop_back();
+	m_isFree[getFrameIndex(frame)] = false;
+	return frame;
+}
+
+void FramePool::release(std::uint64_t *frame) {
+	const auto index = getFrameIndex(frame);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_isFree[index]) {
+		throw errors::FramePoolError("Frame already released to the pool");
+	}
+	m_isFree[index] = true;
+	m_free.push_back(frame);
+}
+
+size_t FramePool::getFrameElements() const {
+	return m_frameElements;
+}
+
+size_t FramePool::getNumFrames() const {
+	return m_numFrames;
+}
+
+size_t FramePool::getFreeFrames() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_free.size();
+}
+
+bool FramePool::usesHugePages() const {
+	return m_hugePages;
+}
+
+size_t FramePool::getFrameIndex(const std::uint64_t *frame) const {
+	const auto addr = reinterpret_cast<const std::uint8_t*>(frame);
+	if (addr < m_memory || addr >= m_memory + m_stride * m_numFrames ||
+		(addr - m_memory) % m_stride != 0) {
+		throw errors::FramePoolError("Frame does not belong to the pool");
+	}
+	return (addr - m_memory) / m_stride;
+}
+
+}  // namespace imaq
+}  // namespace irio
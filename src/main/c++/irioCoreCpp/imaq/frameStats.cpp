@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "imaq/frameStats.h"
+#include "errorsIrio.h"
+#include "workerPool.h"
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+/// Interleaved histograms counted by each thread
+constexpr size_t HISTOGRAM_COPIES = 4;
+
+size_t checkBins(const size_t width, const size_t height,
+				 const PixelFormat format, const size_t histogramBins) {
+	if (width == 0 || height == 0) {
+		throw errors::ImageStageError("Frames require at least one pixel");
+	}
+	const size_t values = size_t(1) << getPixelDepth(format);
+	const size_t bins = histogramBins == 0 ? values : histogramBins;
+	if (bins > values || (bins & (bins - 1)) != 0) {
+		throw errors::ImageStageError(
+			"Histograms of " + std::to_string(bins) +
+			" bins are not supported, it must be a power of 2 up to " +
+			std::to_string(values));
+	}
+	return bins;
+}
+
+unsigned getBinShift(const PixelFormat format, size_t bins) {
+	unsigned shift = getPixelDepth(format);
+	for (; bins > 1; bins >>= 1) {
+		shift--;
+	}
+	return shift;
+}
+
+}  // namespace
+
+struct FrameStatsStage::Partial {
+	std::vector<std::uint32_t> histogram;
+	std::uint16_t min;
+	std::uint16_t max;
+	std::uint64_t sum;
+	std::uint64_t sumX;
+	std::uint64_t sumY;
+	std::uint64_t saturated;
+};
+
+FrameStatsStage::FrameStatsStage(const size_t width, const size_t height,
+								 const PixelFormat format,
+								 const size_t histogramBins,
+								 const std::uint16_t saturationLevel,
+								 const unsigned threads)
+	: m_width(width), m_height(height), m_format(format),
+	  m_bins(checkBins(width, height, format, histogramBins)),
+	  m_binShift(getBinShift(format, m_bins)),
+	  m_saturation(saturationLevel != 0
+					   ? saturationLevel
+					   : static_cast<std::uint16_t>(
+							 (1u << getPixelDepth(format)) - 1)),
+	  m_threads(std::max(1u, threads)) {}
+
+void FrameStatsStage::process(const std::uint64_t *words, FrameStats *stats,
+							  std::uint16_t *image,
+							  const SIMDLevel level) const {
+	const size_t threads = std::min<size_t>(m_threads, m_height);
+
+	// The buffers of the calling thread are reused between frames. The
+	// tasks may run in other threads, so they get its address
+	static thread_local Partial local;
+	Partial *const callerPartial = &local;
+	std::vector<Partial> others(threads - 1);
+
+	const size_t block = (m_height + threads - 1) / threads;
+	WorkerPool::getShared().run(threads, m_threads, [&](const size_t t) {
+		processRows(words, image, level, std::min(m_height, t * block),
+					std::min(m_height, (t + 1) * block),
+					t == 0 ? callerPartial : &others[t - 1]);
+	});
+
+	stats->histogram.assign(m_bins, 0);
+	std::uint64_t sum = 0, sumX = 0, sumY = 0;
+	stats->min = std::numeric_limits<std::uint16_t>::max();
+	stats->max = 0;
+	stats->saturatedPixels = 0;
+	for (size_t i = 0; i < threads; ++i) {
+		const Partial &partial = i == 0 ? local : others[i - 1];
+		for (size_t c = 0; c < HISTOGRAM_COPIES; ++c) {
+			const std::uint32_t *copy = partial.histogram.data() + c * m_bins;
+			for (size_t b = 0; b < m_bins; ++b) {
+				stats->histogram[b] += copy[b];
+			}
+		}
+		stats->min = std::min(stats->min, partial.min);
+		stats->max = std::max(stats->max, partial.max);
+		stats->saturatedPixels += partial.saturated;
+		sum += partial.sum;
+		sumX += partial.sumX;
+		sumY += partial.sumY;
+	}
+
+	stats->mean = static_cast<double>(sum) / (m_width * m_height);
+	stats->centroidX = sum ? static_cast<double>(sumX) / sum : 0;
+	stats->centroidY = sum ? static_cast<double>(sumY) / sum : 0;
+}
+
+size_t FrameStatsStage::getHistogramBins() const {
+	return m_bins;
+}
+
+std::uint16_t FrameStatsStage::getSaturationLevel() const {
+	return m_saturation;
+}
+
+size_t FrameStatsStage::getFrameWords() const {
+	return imaq::getFrameWords(m_format, m_width * m_height);
+}
+
+void FrameStatsStage::processRows(const std::uint64_t *words,
+								  std::uint16_t *image, const SIMDLevel level,
+								  const size_t firstRow, const size_t lastRow,
+								  Partial *partial) const {
+	static thread_local std::vector<std::uint16_t> scratch;
+	if (!image) {
+		scratch.resize(m_width);
+	}
+
+	partial->histogram.assign(HISTOGRAM_COPIES * m_bins, 0);
+	partial->min = std::numeric_limits<std::uint16_t>::max();
+	partial->max = 0;
+	partial->sum = 0;
+	partial->sumX = 0;
+	partial->sumY = 0;
+	partial->saturated = 0;
+
+	std::uint32_t *h0 = partial->histogram.data();
+	std::uint32_t *h1 = h0 + m_bins;
+	std::uint32_t *h2 = h1 + m_bins;
+	std::uint32_t *h3 = h2 + m_bins;
+	const unsigned shift = m_binShift;
+	const std::uint16_t saturation = m_saturation;
+
+	for (size_t r = firstRow; r < lastRow; ++r) {
+		std::uint16_t *row = image ? image + r * m_width : scratch.data();
+		unpackPixels(words, r * m_width, m_width, m_format, row, level);
+
+		// Consecutive pixels go to different copies of the histogram
+		size_t x = 0;
+		for (; x + 4 <= m_width; x += 4) {
+			h0[row[x] >> shift]++;
+			h1[row[x + 1] >> shift]++;
+			h2[row[x + 2] >> shift]++;
+			h3[row[x + 3] >> shift]++;
+		}
+		for (; x < m_width; ++x) {
+			h0[row[x] >> shift]++;
+		}
+
+		// Reductions in a separate loop, vectorized by the compiler
+		std::uint16_t rowMin = partial->min;
+		std::uint16_t rowMax = partial->max;
+		std::uint64_t rowSum = 0;
+		std::uint64_t rowSumX = 0;
+		std::uint64_t rowSaturated = 0;
+		for (x = 0; x < m_width; ++x) {
+			const std::uint16_t v = row[x];
+			rowMin = std::min(rowMin, v);
+			rowMax = std::max(rowMax, v);
+			rowSum += v;
+			rowSumX += static_cast<std::uint64_t>(x) * v;
+			rowSaturated += v >= saturation;
+		}
+		partial->min = rowMin;
+		partial->max = rowMax;
+		partial->sum += rowSum;
+		partial->sumX += rowSumX;
+		partial->sumY += r * rowSum;
+		partial->saturated += rowSaturated;
+	}
+}
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cstring>
+
+#include "imaq/frameSync.h"
+#include "errorsIrio.h"
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+/// Max elements read at once while looking for a start of frame
+constexpr size_t SEARCH_CHUNK_ELEMENTS = 512;
+
+size_t getElementsPerImage(const TerminalsDMAIMAQ &terminals,
+						  const std::uint32_t n, const size_t imagePixelSize) {
+	return imagePixelSize * terminals.getSampleSize(n) / 8;
+}
+
+std::uint32_t getCounter(const std::uint64_t word) {
+	return static_cast<std::uint32_t>(word);
+}
+
+}  // namespace
+
+FrameSynchronizer::FrameSynchronizer(const TerminalsDMAIMAQ &terminals,
+									 const std::uint32_t n,
+									 const size_t imagePixelSize,
+									 const bool hasCounter,
+									 const std::uint32_t sofMarker,
+									 const std::uint32_t eofMarker)
+	: m_terminals(terminals), m_n(n),
+	  m_imageElements(getElementsPerImage(terminals, n, imagePixelSize)),
+	  m_hasCounter(hasCounter), m_sofMarker(sofMarker),
+	  m_eofMarker(eofMarker),
+	  m_search(std::max<size_t>(
+		  1, std::min(m_imageElements, SEARCH_CHUNK_ELEMENTS))) {
+	// Pending elements never exceed the image plus its end of frame word
+	m_pending.reserve(m_imageElements + 1);
+}
+
+std::uint64_t FrameSynchronizer::readFrame(std::uint64_t *image,
+										   const std::uint32_t timeout) {
+	while (true) {
+		if (!m_haveSOF) {
+			std::uint64_t word;
+			m_terminals.readDataBlocking(m_n, 1, &word, timeout);
+			if (isSOF(word)) {
+				m_sof = word;
+				m_haveSOF = true;
+			} else {
+				m_discarded++;
+				findSOF(timeout);
+			}
+		}
+
+		const size_t pending = m_pending.size();
+		if (pending < m_imageElements) {
+			m_terminals.readDataBlocking(m_n, m_imageElements - pending,
+										 image + pending, timeout);
+		}
+		if (pending > 0) {
+			std::memcpy(image, m_pending.data(),
+						pending * sizeof(std::uint64_t));
+		}
+		m_pending.clear();
+
+		std::uint64_t eof;
+		try {
+			m_terminals.readDataBlocking(m_n, 1, &eof, timeout);
+		} catch (const errors::DMAReadTimeout &) {
+			// The user may provide a different buffer in the next call
+			m_pending.assign(image, image + m_imageElements);
+			throw;
+		}
+		m_haveSOF = false;
+
+		if (isEOF(eof) && getCounter(eof) == getCounter(m_sof)) {
+			break;
+		}
+		m_torn++;
+		resyncAfterTorn(image, eof);
+	}
+
+	const auto counter = getCounter(m_sof);
+	if (!m_hasCounter) {
+		m_frameNumber = m_framesRead;
+	} else if (m_framesRead == 0) {
+		m_frameNumber = counter;
+	} else {
+		const std::uint32_t delta = counter - m_lastCounter;
+		m_dropped += delta - 1;
+		m_frameNumber += delta;
+	}
+	m_lastCounter = counter;
+	m_framesRead++;
+	return m_frameNumber;
+}
+
+size_t FrameSynchronizer::getImageElements() const {
+	return m_imageElements;
+}
+
+std::uint64_t FrameSynchronizer::getFramesRead() const {
+	return m_framesRead;
+}
+
+std::uint64_t FrameSynchronizer::getDroppedFrames() const {
+	return m_dropped;
+}
+
+std::uint64_t FrameSynchronizer::getTornFrames() const {
+	return m_torn;
+}
+
+std::uint64_t FrameSynchronizer::getDiscardedElements() const {
+	return m_discarded;
+}
+
+bool FrameSynchronizer::isSOF(const std::uint64_t word) const {
+	return (word >> 32) == m_sofMarker;
+}
+
+bool FrameSynchronizer::isEOF(const std::uint64_t word) const {
+	return (word >> 32) == m_eofMarker;
+}
+
+void FrameSynchronizer::findSOF(const std::uint32_t timeout) {
+	while (true) {
+		m_terminals.readDataBlocking(m_n, m_search.size(), m_search.data(),
+									 timeout);
+		const auto it = std::find_if(
+			m_search.begin(), m_search.end(),
+			[this](const std::uint64_t word) { return isSOF(word); });
+		if (it != m_search.end()) {
+			m_sof = *it;
+			m_haveSOF = true;
+			m_discarded += it - m_search.begin();
+			// The search chunk is never larger than the image
+			m_pending.assign(it + 1, m_search.end());
+			return;
+		}
+		m_discarded += m_search.size();
+	}
+}
+
+void FrameSynchronizer::resyncAfterTorn(const std::uint64_t *image,
+										const std::uint64_t eof) {
+	// The next frame may have started inside the torn one
+	const auto end = image + m_imageElements;
+	const auto it = std::find_if(
+		image, end, [this](const std::uint64_t word) { return isSOF(word); });
+	if (it != end) {
+		m_sof = *it;
+		m_haveSOF = true;
+		m_discarded += 1 + (it - image);
+		m_pending.assign(it + 1, end);
+		m_pending.push_back(eof);
+	} else if (isSOF(eof)) {
+		m_sof = eof;
+		m_haveSOF = true;
+		m_discarded += 1 + m_imageElements;
+	} else {
+		m_discarded += 2 + m_imageElements;
+	}
+}
+
+}  // namespace imaq
+}  // namespace irio
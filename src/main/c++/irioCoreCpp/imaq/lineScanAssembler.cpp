@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "imaq/lineScanAssembler.h"
+#include "errorsIrio.h"
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+using TimePoint = std::chrono::steady_clock::time_point;
+
+static_assert(sizeof(TimePoint) == sizeof(std::uint64_t) &&
+				  alignof(TimePoint) <= alignof(std::uint64_t),
+			  "Line timestamps are stored in DMA elements");
+
+size_t getElementsPerLine(const TerminalsDMAIMAQ &terminals,
+						  const std::uint32_t n, const size_t linePixels) {
+	const size_t bytes = linePixels * terminals.getSampleSize(n);
+	if (bytes == 0 || bytes % sizeof(std::uint64_t) != 0) {
+		throw errors::ImageStageError(
+			"Lines of " + std::to_string(linePixels) +
+			" pixels do not fill a whole number of DMA elements");
+	}
+	return bytes / sizeof(std::uint64_t);
+}
+
+size_t checkFrameLines(const size_t frameLines) {
+	if (frameLines == 0) {
+		throw errors::ImageStageError("Frames require at least one line");
+	}
+	return frameLines;
+}
+
+}  // namespace
+
+LineScanAssembler::LineScanAssembler(const TerminalsDMAIMAQ &terminals,
+									 const std::uint32_t n,
+									 const size_t linePixels,
+									 const size_t frameLines,
+									 const size_t lineStep,
+									 const size_t numFrames,
+									 const bool hugePages)
+	: m_terminals(terminals), m_n(n),
+	  m_lineElements(getElementsPerLine(terminals, n, linePixels)),
+	  m_frameLines(checkFrameLines(frameLines)),
+	  m_lineStep(lineStep == 0 || lineStep > frameLines ? frameLines
+														: lineStep),
+	  // The timestamps of the lines are stored after the lines
+	  m_pool((m_lineElements + 1) * frameLines, numFrames, hugePages),
+	  m_discard(m_lineElements),
+	  m_open((frameLines + m_lineStep - 1) / m_lineStep) {}
+
+void LineScanAssembler::assembleFrame(LineFrame *frame,
+									  const std::uint32_t timeout) {
+	while (true) {
+		if (m_openCount > 0 && getOpenFrame(0).linesFilled == m_frameLines) {
+			const auto oldest = getOpenFrame(0);
+			m_openHead = (m_openHead + 1) % m_open.size();
+			m_openCount--;
+
+			if (oldest.data) {
+				*frame = LineFrame{oldest.data,
+								   m_frameLines,
+								   m_lineElements,
+								   oldest.firstLine / m_lineStep,
+								   oldest.firstLine,
+								   getTimestamps(oldest.data),
+								   oldest.maxLineInterval,
+								   m_dropped};
+				return;
+			}
+			throw errors::FramePoolError(
+				"Frame " + std::to_string(oldest.firstLine / m_lineStep) +
+				" dropped, there were no free frames in the pool");
+		}
+		readLine(timeout);
+	}
+}
+
+void LineScanAssembler::releaseFrame(const LineFrame &frame) {
+	m_pool.release(frame.data);
+}
+
+std::uint64_t LineScanAssembler::getLinesRead() const {
+	return m_linesRead;
+}
+
+std::uint64_t LineScanAssembler::getDroppedFrames() const {
+	return m_dropped;
+}
+
+std::chrono::nanoseconds LineScanAssembler::getMaxLineInterval() const {
+	return m_maxLineInterval;
+}
+
+size_t LineScanAssembler::getLineElements() const {
+	return m_lineElements;
+}
+
+const FramePool &LineScanAssembler::getPool() const {
+	return m_pool;
+}
+
+void LineScanAssembler::readLine(const std::uint32_t timeout) {
+	const auto line = m_linesRead;
+
+	if (line == m_nextFrameLine) {
+		auto data = m_pool.acquire();
+		if (data == nullptr) {
+			m_dropped++;
+		}
+		getOpenFrame(m_openCount) = OpenFrame{data, line, 0,
+											  std::chrono::nanoseconds(0)};
+		m_openCount++;
+		m_nextFrameLine += m_lineStep;
+	}
+
+	// The line is read into the newest frame, which is the last one to use it
+	OpenFrame *target = nullptr;
+	for (size_t i = m_openCount; i > 0 && !target; --i) {
+		if (getOpenFrame(i - 1).data) {
+			target = &getOpenFrame(i - 1);
+		}
+	}
+	std::uint64_t *lineData =
+		target ? target->data + (line - target->firstLine) * m_lineElements
+			   : m_discard.data();
+
+	m_terminals.readDataBlocking(m_n, m_lineElements, lineData, timeout);
+
+	const auto now = std::chrono::steady_clock::now();
+	std::chrono::nanoseconds interval(0);
+	if (line > 0) {
+		interval = now - m_lastLineTime;
+		m_maxLineInterval = std::max(m_maxLineInterval, interval);
+	}
+	m_lastLineTime = now;
+	m_linesRead++;
+
+	for (size_t i = 0; i < m_openCount; ++i) {
+		auto &open = getOpenFrame(i);
+		const size_t row = line - open.firstLine;
+		if (open.data) {
+			if (&open != target) {
+				std::memcpy(open.data + row * m_lineElements, lineData,
+							m_lineElements * sizeof(std::uint64_t));
+			}
+			getTimestamps(open.data)[row] = now;
+		}
+		if (row > 0) {
+			open.maxLineInterval = std::max(open.maxLineInterval, interval);
+		}
+		open.linesFilled++;
+	}
+}
+
+LineScanAssembler::OpenFrame &LineScanAssembler::getOpenFrame(const size_t i) {
+	return m_open[(m_openHead + i) % m_open.size()];
+}
+
+TimePoint *LineScanAssembler::getTimestamps(std::uint64_t *data) {
+	return reinterpret_cast<TimePoint*>(data + m_lineElements * m_frameLines);
+}
+
+}  // namespace imaq
+}  // namespace irio
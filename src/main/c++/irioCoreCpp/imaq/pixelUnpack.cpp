@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "imaq/pixelUnpack.h"
+#include "errorsIrio.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IRIO_X86_SIMD
+#endif
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+/////////////////////////////////////////////////////////////
+/// Scalar kernels
+/////////////////////////////////////////////////////////////
+
+/**
+ * Extracts a pixel of a packed stream. Pixels of 10 and 12 bits
+ * always span two bytes, so no byte after the last pixel is read
+ */
+inline std::uint16_t extractPacked(const std::uint8_t *bytes,
+								   const size_t pixel, const unsigned bits) {
+	const size_t bit = pixel * bits;
+	const size_t byte = bit / 8;
+	const unsigned shift = bit % 8;
+	const unsigned value = bytes[byte] | (bytes[byte + 1] << 8);
+	return (value >> shift) & ((1u << bits) - 1);
+}
+
+void unpackPackedScalar(const std::uint8_t *bytes, size_t first,
+						const size_t pixels, const unsigned bits,
+						std::uint16_t *image) {
+	if (bits == 10) {
+		for (; first % 4 != 0 && first < pixels; ++first) {
+			image[first] = extractPacked(bytes, first, bits);
+		}
+		// 4 pixels every 5 bytes
+		for (; first + 4 <= pixels; first += 4) {
+			const std::uint8_t *b = bytes + first / 4 * 5;
+			image[first] = b[0] | ((b[1] & 0x03) << 8);
+			image[first + 1] = (b[1] >> 2) | ((b[2] & 0x0F) << 6);
+			image[first + 2] = (b[2] >> 4) | ((b[3] & 0x3F) << 4);
+			image[first + 3] = (b[3] >> 6) | (b[4] << 2);
+		}
+	} else {
+		for (; first % 2 != 0 && first < pixels; ++first) {
+			image[first] = extractPacked(bytes, first, bits);
+		}
+		// 2 pixels every 3 bytes
+		for (; first + 2 <= pixels; first += 2) {
+			const std::uint8_t *b = bytes + first / 2 * 3;
+			image[first] = b[0] | ((b[1] & 0x0F) << 8);
+			image[first + 1] = (b[1] >> 4) | (b[2] << 4);
+		}
+	}
+	for (; first < pixels; ++first) {
+		image[first] = extractPacked(bytes, first, bits);
+	}
+}
+
+void widen8Scalar(const std::uint8_t *bytes, size_t first,
+				  const size_t pixels, std::uint16_t *image) {
+	for (; first < pixels; ++first) {
+		image[first] = bytes[first];
+	}
+}
+
+void mask16Scalar(const std::uint16_t *samples, size_t first,
+				  const size_t pixels, const std::uint16_t mask,
+				  std::uint16_t *image) {
+	for (; first < pixels; ++first) {
+		image[first] = samples[first] & mask;
+	}
+}
+
+#ifdef IRIO_X86_SIMD
+/////////////////////////////////////////////////////////////
+/// SSSE3 kernels
+/////////////////////////////////////////////////////////////
+
+/*
+ * Packed pixels are unpacked 8 at a time. Each 16 bits lane receives the two
+ * bytes holding its pixel, which is then aligned to the top of the lane with a
+ * per lane multiplication and shifted down, dropping the bits of the
+ * neighbouring pixels.
+ */
+
+__attribute__((target("ssse3")))
+size_t unpack10pSSSE3(const std::uint8_t *bytes, const size_t inBytes,
+					  const size_t pixels, std::uint16_t *image) {
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 1, 2, 2, 3, 3, 4,
+										  5, 6, 6, 7, 7, 8, 8, 9);
+	const __m128i multiplier = _mm_setr_epi16(64, 16, 4, 1, 64, 16, 4, 1);
+	size_t i = 0;
+	// 8 pixels every 10 bytes, 16 bytes loaded
+	for (; i + 8 <= pixels && i / 8 * 10 + 16 <= inBytes; i += 8) {
+		const __m128i in = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(bytes + i / 8 * 10));
+		__m128i v = _mm_shuffle_epi8(in, shuffle);
+		v = _mm_srli_epi16(_mm_mullo_epi16(v, multiplier), 6);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(image + i), v);
+	}
+	return i;
+}
+
+__attribute__((target("ssse3")))
+size_t unpack12pSSSE3(const std::uint8_t *bytes, const size_t inBytes,
+					  const size_t pixels, std::uint16_t *image) {
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5,
+										  6, 7, 7, 8, 9, 10, 10, 11);
+	const __m128i multiplier = _mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+	size_t i = 0;
+	// 8 pixels every 12 bytes, 16 bytes loaded
+	for (; i + 8 <= pixels && i / 8 * 12 + 16 <= inBytes; i += 8) {
+		const __m128i in = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(bytes + i / 8 * 12));
+		__m128i v = _mm_shuffle_epi8(in, shuffle);
+		v = _mm_srli_epi16(_mm_mullo_epi16(v, multiplier), 4);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(image + i), v);
+	}
+	return i;
+}
+
+__attribute__((target("ssse3")))
+size_t widen8SSSE3(const std::uint8_t *bytes, const size_t pixels,
+				   std::uint16_t *image) {
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 16 <= pixels; i += 16) {
+		const __m128i in =
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(image + i),
+						 _mm_unpacklo_epi8(in, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(image + i + 8),
+						 _mm_unpackhi_epi8(in, zero));
+	}
+	return i;
+}
+
+__attribute__((target("ssse3")))
+size_t mask16SSSE3(const std::uint16_t *samples, const size_t pixels,
+				   const std::uint16_t mask, std::uint16_t *image) {
+	const __m128i vmask = _mm_set1_epi16(static_cast<std::int16_t>(mask));
+	size_t i = 0;
+	for (; i + 8 <= pixels; i += 8) {
+		const __m128i in =
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(image + i),
+						 _mm_and_si128(in, vmask));
+	}
+	return i;
+}
+
+/////////////////////////////////////////////////////////////
+/// AVX2 kernels
+/////////////////////////////////////////////////////////////
+
+/*
+ * Same as SSSE3, with the two 128 bits lanes loaded from consecutive groups
+ * of 8 pixels, as the byte shuffle does not cross lanes.
+ */
+
+__attribute__((target("avx2")))
+size_t unpack10pAVX2(const std::uint8_t *bytes, const size_t inBytes,
+					 const size_t pixels, std::uint16_t *image) {
+	const __m256i shuffle = _mm256_setr_epi8(
+		0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9,
+		0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9);
+	const __m256i multiplier = _mm256_setr_epi16(
+		64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1);
+	size_t i = 0;
+	// 16 pixels every 20 bytes, 16 bytes loaded from byte 10
+	for (; i + 16 <= pixels && i / 8 * 10 + 26 <= inBytes; i += 16) {
+		const std::uint8_t *src = bytes + i / 8 * 10;
+		const __m256i in = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 10)), 1);
+		__m256i v = _mm256_shuffle_epi8(in, shuffle);
+		v = _mm256_srli_epi16(_mm256_mullo_epi16(v, multiplier), 6);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(image + i), v);
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t unpack12pAVX2(const std::uint8_t *bytes, const size_t inBytes,
+					 const size_t pixels, std::uint16_t *image) {
+	const __m256i shuffle = _mm256_setr_epi8(
+		0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11,
+		0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+	const __m256i multiplier = _mm256_setr_epi16(
+		16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1);
+	size_t i = 0;
+	// 16 pixels every 24 bytes, 16 bytes loaded from byte 12
+	for (; i + 16 <= pixels && i / 8 * 12 + 28 <= inBytes; i += 16) {
+		const std::uint8_t *src = bytes + i / 8 * 12;
+		const __m256i in = _mm256_inserti128_si256(
+			_mm256_castsi128_si256(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12)), 1);
+		__m256i v = _mm256_shuffle_epi8(in, shuffle);
+		v = _mm256_srli_epi16(_mm256_mullo_epi16(v, multiplier), 4);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(image + i), v);
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t widen8AVX2(const std::uint8_t *bytes, const size_t pixels,
+				  std::uint16_t *image) {
+	size_t i = 0;
+	for (; i + 16 <= pixels; i += 16) {
+		const __m128i in =
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(image + i),
+							_mm256_cvtepu8_epi16(in));
+	}
+	return i;
+}
+
+__attribute__((target("avx2")))
+size_t mask16AVX2(const std::uint16_t *samples, const size_t pixels,
+				  const std::uint16_t mask, std::uint16_t *image) {
+	const __m256i vmask = _mm256_set1_epi16(static_cast<std::int16_t>(mask));
+	size_t i = 0;
+	for (; i + 16 <= pixels; i += 16) {
+		const __m256i in =
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(image + i),
+							_mm256_and_si256(in, vmask));
+	}
+	return i;
+}
+
+SIMDLevel detectSIMDLevel() {
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		return SIMDLevel::AVX2;
+	}
+	if (__builtin_cpu_supports("ssse3")) {
+		return SIMDLevel::SSSE3;
+	}
+	return SIMDLevel::Scalar;
+}
+#else
+SIMDLevel detectSIMDLevel() {
+	return SIMDLevel::Scalar;
+}
+#endif
+
+}  // namespace
+
+PixelFormat getPixelFormat(const std::uint8_t sampleSize,
+						   const std::uint8_t bitDepth) {
+	if (sampleSize == 1 && (bitDepth == 0 || bitDepth == 8)) {
+		return PixelFormat::Mono8;
+	}
+	if (sampleSize == 2) {
+		switch (bitDepth) {
+		case 10:
+			return PixelFormat::Mono10;
+		case 12:
+			return PixelFormat::Mono12;
+		case 0:
+		case 16:
+			return PixelFormat::Mono16;
+		default:
+			break;
+		}
+	}
+	throw errors::UnsupportedPixelFormatError(
+		"No pixel format for samples of " + std::to_string(sampleSize) +
+		" bytes and pixels of " + std::to_string(bitDepth) + " bits");
+}
+
+std::uint8_t getPixelBits(const PixelFormat format) {
+	switch (format) {
+	case PixelFormat::Mono8:
+		return 8;
+	case PixelFormat::Mono10p:
+		return 10;
+	case PixelFormat::Mono12p:
+		return 12;
+	default:
+		return 16;
+	}
+}
+
+std::uint8_t getPixelDepth(const PixelFormat format) {
+	switch (format) {
+	case PixelFormat::Mono8:
+		return 8;
+	case PixelFormat::Mono10:
+	case PixelFormat::Mono10p:
+		return 10;
+	case PixelFormat::Mono12:
+	case PixelFormat::Mono12p:
+		return 12;
+	default:
+		return 16;
+	}
+}
+
+size_t getFrameWords(const PixelFormat format, const size_t pixels) {
+	return (pixels * getPixelBits(format) + 63) / 64;
+}
+
+SIMDLevel getSIMDLevel() {
+	static const SIMDLevel level = detectSIMDLevel();
+	return level;
+}
+
+void unpackFrame(const std::uint64_t *words, const size_t pixels,
+				 const PixelFormat format, std::uint16_t *image) {
+	unpackFrame(words, pixels, format, image, getSIMDLevel());
+}
+
+void unpackFrame(const std::uint64_t *words, const size_t pixels,
+				 const PixelFormat format, std::uint16_t *image,
+				 const SIMDLevel level) {
+	unpackPixels(words, 0, pixels, format, image, level);
+}
+
+void unpackPixels(const std::uint64_t *words, const size_t first,
+				  const size_t pixels, const PixelFormat format,
+				  std::uint16_t *image, const SIMDLevel level) {
+	const auto bytes = reinterpret_cast<const std::uint8_t*>(words);
+	const auto samples = reinterpret_cast<const std::uint16_t*>(words) + first;
+	const size_t inBytes = getFrameWords(format, first + pixels) * 8;
+	const SIMDLevel used = std::min(level, getSIMDLevel());
+	size_t done = 0;
+
+	switch (format) {
+	case PixelFormat::Mono8:
+#ifdef IRIO_X86_SIMD
+		if (used == SIMDLevel::AVX2) {
+			done = widen8AVX2(bytes + first, pixels, image);
+		} else if (used == SIMDLevel::SSSE3) {
+			done = widen8SSSE3(bytes + first, pixels, image);
+		}
+#endif
+		widen8Scalar(bytes + first, done, pixels, image);
+		break;
+	case PixelFormat::Mono16:
+		std::memcpy(image, samples, pixels * sizeof(std::uint16_t));
+		break;
+	case PixelFormat::Mono10:
+	case PixelFormat::Mono12: {
+		const std::uint16_t mask =
+			format == PixelFormat::Mono10 ? 0x03FF : 0x0FFF;
+#ifdef IRIO_X86_SIMD
+		if (used == SIMDLevel::AVX2) {
+			done = mask16AVX2(samples, pixels, mask, image);
+		} else if (used == SIMDLevel::SSSE3) {
+			done = mask16SSSE3(samples, pixels, mask, image);
+		}
+#endif
+		mask16Scalar(samples, done, pixels, mask, image);
+		break;
+	}
+	case PixelFormat::Mono10p:
+	case PixelFormat::Mono12p: {
+		const unsigned bits = getPixelBits(format);
+		// Groups of 8 pixels start at a byte boundary for both formats
+		const size_t lead = std::min(pixels, (8 - first % 8) % 8);
+		for (size_t i = 0; i < lead; ++i) {
+			image[i] = extractPacked(bytes, first + i, bits);
+		}
+		const size_t offset = (first + lead) * bits / 8;
+		const std::uint8_t *aligned = bytes + offset;
+		const size_t rest = pixels - lead;
+		std::uint16_t *out = image + lead;
+#ifdef IRIO_X86_SIMD
+		if (used == SIMDLevel::AVX2) {
+			done = bits == 10
+					   ? unpack10pAVX2(aligned, inBytes - offset, rest, out)
+					   : unpack12pAVX2(aligned, inBytes - offset, rest, out);
+		} else if (used == SIMDLevel::SSSE3) {
+			done = bits == 10
+					   ? unpack10pSSSE3(aligned, inBytes - offset, rest, out)
+					   : unpack12pSSSE3(aligned, inBytes - offset, rest, out);
+		}
+#endif
+		unpackPackedScalar(aligned, done, rest, bits, out);
+		break;
+	}
+	}
+}
+
+void unpackFrame(const std::uint64_t *words, const size_t pixels,
+				 const PixelFormat format, std::uint8_t *image) {
+	if (format != PixelFormat::Mono8) {
+		throw errors::UnsupportedPixelFormatError(
+			"Only Mono8 frames can be unpacked into 8 bits images");
+	}
+	std::memcpy(image, words, pixels);
+}
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "imaq/roiBinning.h"
+#include "errorsIrio.h"
+#include "workerPool.h"
+
+namespace irio {
+namespace imaq {
+
+namespace {
+
+ROI checkROI(const size_t imageWidth, const size_t imageHeight,
+			 const ROI &roi, const unsigned binning) {
+	if (binning == 0) {
+		throw errors::ROIError("Binning must be at least 1");
+	}
+	if (roi.width == 0 || roi.height == 0 ||
+		roi.x + roi.width > imageWidth || roi.y + roi.height > imageHeight) {
+		throw errors::ROIError(
+			"ROI of " + std::to_string(roi.width) + "x" +
+			std::to_string(roi.height) + " at (" + std::to_string(roi.x) +
+			", " + std::to_string(roi.y) + ") does not fit in an image of " +
+			std::to_string(imageWidth) + "x" + std::to_string(imageHeight));
+	}
+	if (roi.width % binning != 0 || roi.height % binning != 0) {
+		throw errors::ROIError("ROI dimensions must be multiple of the binning");
+	}
+	return roi;
+}
+
+}  // namespace
+
+ROIBinningStage::ROIBinningStage(const size_t imageWidth,
+								 const size_t imageHeight,
+								 const PixelFormat format, const ROI &roi,
+								 const unsigned binning,
+								 const BinningMode mode,
+								 const unsigned threads)
+	: m_imageWidth(imageWidth), m_imageHeight(imageHeight), m_format(format),
+	  m_roi(checkROI(imageWidth, imageHeight, roi, binning)),
+	  m_binning(binning), m_mode(mode), m_threads(std::max(1u, threads)) {}
+
+void ROIBinningStage::process(const std::uint64_t *words,
+							  std::uint16_t *image,
+							  const SIMDLevel level) const {
+	const size_t rows = getOutputHeight();
+	const size_t threads = std::min<size_t>(m_threads, rows);
+	if (threads <= 1) {
+		processRows(words, image, level, 0, rows);
+		return;
+	}
+
+	const size_t block = (rows + threads - 1) / threads;
+	WorkerPool::getShared().run(threads, m_threads, [&](const size_t t) {
+		processRows(words, image, level, std::min(rows, t * block),
+					std::min(rows, (t + 1) * block));
+	});
+}
+
+size_t ROIBinningStage::getOutputWidth() const {
+	return m_roi.width / m_binning;
+}
+
+size_t ROIBinningStage::getOutputHeight() const {
+	return m_roi.height / m_binning;
+}
+
+size_t ROIBinningStage::getOutputPixels() const {
+	return getOutputWidth() * getOutputHeight();
+}
+
+size_t ROIBinningStage::getFrameWords() const {
+	return imaq::getFrameWords(m_format, m_imageWidth * m_imageHeight);
+}
+
+PixelFormat ROIBinningStage::getFormat() const {
+	return m_format;
+}
+
+void ROIBinningStage::processRows(const std::uint64_t *words,
+								  std::uint16_t *image, const SIMDLevel level,
+								  const size_t firstRow,
+								  const size_t lastRow) const {
+	const size_t outWidth = getOutputWidth();
+
+	if (m_binning == 1) {
+		for (size_t r = firstRow; r < lastRow; ++r) {
+			unpackPixels(words, (m_roi.y + r) * m_imageWidth + m_roi.x,
+						 m_roi.width, m_format, image + r * outWidth, level);
+		}
+		return;
+	}
+
+	// Rows of each bin are accumulated column by column (vectorized by the
+	// compiler) and the columns of each bin are combined afterwards
+	std::vector<std::uint16_t> row(m_roi.width);
+	std::vector<std::uint32_t> acc(m_roi.width);
+	// A column of a bin fits in 32 bits, a bin of more than 256 x 256
+	// pixels does not
+	const std::uint64_t binPixels =
+		static_cast<std::uint64_t>(m_binning) * m_binning;
+	const std::uint64_t maxValue = std::numeric_limits<std::uint16_t>::max();
+
+	for (size_t r = firstRow; r < lastRow; ++r) {
+		std::fill(acc.begin(), acc.end(), 0);
+		for (unsigned k = 0; k < m_binning; ++k) {
+			const size_t srcRow = m_roi.y + r * m_binning + k;
+			unpackPixels(words, srcRow * m_imageWidth + m_roi.x, m_roi.width,
+						 m_format, row.data(), level);
+			for (size_t x = 0; x < m_roi.width; ++x) {
+				acc[x] += row[x];
+			}
+		}
+
+		std::uint16_t *out = image + r * outWidth;
+		for (size_t x = 0; x < outWidth; ++x) {
+			std::uint64_t sum = 0;
+			for (unsigned k = 0; k < m_binning; ++k) {
+				sum += acc[x * m_binning + k];
+			}
+			out[x] = static_cast<std::uint16_t>(
+				m_mode == BinningMode::Average ? sum / binPixels
+											   : std::min(sum, maxValue));
+		}
+	}
+}
+
+}  // namespace imaq
+}  // namespace irio
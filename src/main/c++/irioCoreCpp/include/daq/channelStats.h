@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "daq/daqLayout.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Statistics of a channel of a DAQ stream
+ *
+ * @ingroup DAQ
+ */
+struct ChannelStats {
+	/// Number of samples included
+	std::uint64_t samples = 0;
+	/// Mean value
+	double mean = 0;
+	/// Root mean square
+	double rms = 0;
+	/// Standard deviation
+	double stdDev = 0;
+	/// Lowest value
+	std::int16_t min = 0;
+	/// Highest value
+	std::int16_t max = 0;
+};
+
+/**
+ * Samples covered by the statistics of a \ref irio::daq::ChannelStatsStage
+ *
+ * @ingroup DAQ
+ */
+enum class StatsScope : std::uint8_t {
+	/// The last complete segments of the window
+	Window,
+	/// All the samples since the stream started
+	Cumulative
+};
+
+/**
+ * Value read from the statistics of a \ref irio::daq::ChannelStatsStage
+ *
+ * @ingroup DAQ
+ */
+enum class StatsValue : std::uint8_t {
+	Samples,	/**< \ref ChannelStats::samples */
+	Mean,		/**< \ref ChannelStats::mean */
+	RMS,		/**< \ref ChannelStats::rms */
+	StdDev,		/**< \ref ChannelStats::stdDev */
+	Min,		/**< \ref ChannelStats::min */
+	Max			/**< \ref ChannelStats::max */
+};
+
+/**
+ * Computes the mean, RMS, standard deviation, min and max of each channel of
+ * a DAQ stream, over a sliding window and since the stream started.
+ *
+ * The stage works on the DMA blocks as read from a
+ * \ref irio::TerminalsDMADAQ, with the channels interleaved (see
+ * \ref irio::daq::deinterleave), so no extra pass is needed to split them.
+ * The samples of each channel are divided into segments of a fixed number
+ * of samples, whose sums are computed with SSE or AVX2 for 1, 2, 4 and 8
+ * channels. The window holds the last complete segments: when a segment
+ * completes, it replaces the oldest one, so the window slides one segment
+ * at a time without going through its samples again.
+ *
+ * The statistics are published at the end of each block processed, and can
+ * be read from other threads at any time, e.g. by slow-control records
+ * polling \ref getValue, without accessing the stream.
+ *
+ * @ingroup DAQ
+ */
+class ChannelStatsStage {
+ public:
+	/**
+	 * Configures the stage
+	 *
+	 * @throw irio::errors::DAQStageError	No channels, segments or window
+	 * 										segments, or window longer than
+	 * 										2^32 samples
+	 *
+	 * @param channels			Number of channels of the DMA
+	 * 							(\ref irio::TerminalsDMACommon::getNCh)
+	 * @param segmentSamples	Samples of each channel in each segment
+	 * @param windowSegments	Number of segments in the window
+	 */
+	ChannelStatsStage(const size_t channels, const size_t segmentSamples,
+					  const size_t windowSegments);
+
+	/**
+	 * Adds the next block of the stream and publishes the statistics
+	 *
+	 * @param words		DMA words of the block
+	 * @param elements	Number of DMA words. Only complete samples are
+	 * 					processed (\ref irio::daq::getBlockSamples)
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 */
+	void process(const std::uint64_t *words, const size_t elements,
+				 const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Copies the statistics of a channel published by the last block. The
+	 * window statistics have no samples until the first segment completes
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param channel		Number of the channel
+	 * @param scope			Window or cumulative statistics
+	 * @param[out] stats	Statistics of the channel
+	 */
+	void getStats(const size_t channel, const StatsScope scope,
+				  ChannelStats *stats) const;
+
+	/**
+	 * Returns a value of the statistics of a channel published by the last
+	 * block
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param channel	Number of the channel
+	 * @param scope		Window or cumulative statistics
+	 * @param value		Value to read
+	 */
+	double getValue(const size_t channel, const StatsScope scope,
+					const StatsValue value) const;
+
+	/**
+	 * Returns the number of segments completed since the stream started
+	 */
+	std::uint64_t getSegments() const;
+
+	/**
+	 * Returns the number of samples of each channel processed since the
+	 * stream started
+	 */
+	std::uint64_t getPosition() const;
+
+	/**
+	 * Returns the number of channels of the stream
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the number of samples of each segment
+	 */
+	size_t getSegmentSamples() const;
+
+	/**
+	 * Returns the number of segments of the window
+	 */
+	size_t getWindowSegments() const;
+
+	/**
+	 * Discards the statistics, to start processing a new stream
+	 */
+	void reset();
+
+ private:
+	/// Sums of the samples of a channel
+	struct Moments {
+		std::int64_t sum;
+		std::uint64_t squares;
+		std::int16_t min;
+		std::int16_t max;
+	};
+
+	void closeSegment();
+
+	void publish();
+
+	static void clear(Moments *moments);
+
+	static ChannelStats getStats(const std::uint64_t samples, const double sum,
+								 const double squares, const std::int16_t min,
+								 const std::int16_t max);
+
+	const size_t m_channels;
+	const size_t m_segmentSamples;
+	const size_t m_windowSegments;
+
+	/// Segment in progress of each channel
+	std::vector<Moments> m_current;
+	size_t m_filled;
+	/// Circular buffer with the segments of the window, channels of each
+	/// segment together
+	std::vector<Moments> m_segments;
+	size_t m_segmentHead;
+	size_t m_segmentCount;
+	/// Sums of the segments of the window of each channel
+	std::vector<std::int64_t> m_windowSum;
+	std::vector<std::uint64_t> m_windowSquares;
+	/// Sums of the segments completed of each channel
+	std::vector<std::int64_t> m_totalSum;
+	std::vector<double> m_totalSquares;
+	std::vector<std::int16_t> m_totalMin;
+	std::vector<std::int16_t> m_totalMax;
+	std::uint64_t m_position;
+	std::uint64_t m_completed;
+
+	mutable std::mutex m_mutex;
+	std::vector<ChannelStats> m_window;
+	std::vector<ChannelStats> m_cumulative;
+	std::uint64_t m_published;
+	std::uint64_t m_publishedSegments;
+};
+
+}  // namespace daq
+}  // namespace irio
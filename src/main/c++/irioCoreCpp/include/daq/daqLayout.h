@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "imaq/pixelUnpack.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Instruction sets available for the DAQ kernels. They are the same ones
+ * detected for the IMAQ kernels.
+ *
+ * @ingroup DAQ
+ */
+using imaq::SIMDLevel;
+using imaq::getSIMDLevel;
+
+/**
+ * Returns the number of samples of each channel in a DAQ block
+ *
+ * The 64 bits DMA words of a DAQ block hold signed 16 bits values, with the
+ * \p channels channels interleaved (the value of each channel for the first
+ * sample, then for the second sample...).
+ *
+ * @param elements	Number of DMA words (64 bits) of the block
+ * @param channels	Number of channels of the DMA
+ * 					(\ref irio::TerminalsDMACommon::getNCh)
+ * @return	Number of complete samples of each channel
+ */
+size_t getBlockSamples(const size_t elements, const size_t channels);
+
+/**
+ * Splits the interleaved samples of a DAQ block into a buffer per channel
+ *
+ * SSSE3 kernels are used for 2, 4 and 8 channels, the most common layouts,
+ * and a portable implementation otherwise.
+ *
+ * @param words		DMA words of the block. It must contain at least
+ * 					\p samples x \p channels values
+ * @param samples	Number of samples of each channel to split
+ * @param channels	Number of channels of the DMA
+ * @param out		Array of \p channels buffers of \p samples elements
+ * @param level		Instruction set to use. If it is not supported by
+ * 					the CPU, the best one supported is used
+ */
+void deinterleave(const std::uint64_t *words, const size_t samples,
+				  const size_t channels, std::int16_t *const *out,
+				  const SIMDLevel level = getSIMDLevel());
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "daq/daqLayout.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * How the samples of each decimation window are combined
+ *
+ * @ingroup DAQ
+ */
+enum class DecimationMode : std::uint8_t {
+	Average,	/**< Mean of the window (boxcar filter) */
+	CIC,		/**< Cascaded integrator-comb filter, normalized to unit gain */
+	MinMax		/**< Min and max of the window, for envelopes */
+};
+
+/**
+ * Configuration of a decimated output of a \ref DecimationStage
+ *
+ * @ingroup DAQ
+ */
+struct DecimationOutput {
+	/// Number of input samples of each output sample
+	size_t ratio;
+	/// How the samples of each window are combined
+	DecimationMode mode;
+	/// Number of integrator and comb sections. Only used by
+	/// \ref DecimationMode::CIC
+	unsigned order;
+};
+
+/**
+ * Decimates the channels of a DAQ stream on the host, producing one or more
+ * decimated outputs from the same full-rate blocks.
+ *
+ * The FPGA decimation (\ref irio::TerminalsDMADAQ::setSamplingRateDecimation)
+ * applies to every consumer of the DMA. This stage keeps the full-rate data
+ * untouched and computes lower rate streams, e.g. for monitoring, from the
+ * blocks read by the application.
+ *
+ * The stage works directly on the interleaved DMA words
+ * (see \ref getBlockSamples). Windows can span several blocks, and blocks
+ * can end in the middle of a sample: the partial windows are kept until the
+ * next call to \ref process. The Average and MinMax outputs are computed with
+ * SSSE3 or AVX2 kernels. The CIC integrators are recursive, so they are
+ * computed sample by sample, with 64 bits modular arithmetic.
+ *
+ * Each output has the layout of the input: the channels of each output
+ * sample are interleaved. MinMax outputs have two values per channel, the
+ * min and then the max.
+ *
+ * @ingroup DAQ
+ */
+class DecimationStage {
+ public:
+	/**
+	 * Configures the stage
+	 *
+	 * @throw irio::errors::DAQStageError	No channels or outputs, a ratio of
+	 * 										0 (or above 65536 for Average
+	 * 										outputs), or a CIC output whose
+	 * 										gain does not fit in 64 bits
+	 *
+	 * @param channels	Number of channels of the DMA
+	 * 					(\ref irio::TerminalsDMACommon::getNCh)
+	 * @param outputs	Decimated outputs to compute
+	 */
+	DecimationStage(const size_t channels,
+					const std::vector<DecimationOutput> &outputs);
+
+	/**
+	 * Decimates the next block of the stream
+	 *
+	 * The samples produced for each output are available with
+	 * \ref getOutput until the next call.
+	 *
+	 * @param words		DMA words of the block
+	 * @param elements	Number of DMA words of the block
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 */
+	void process(const std::uint64_t *words, const size_t elements,
+				 const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Returns the values produced for an output by the last call to
+	 * \ref process, with the channels interleaved
+	 *
+	 * @throw irio::errors::DAQStageError	Output does not exist
+	 *
+	 * @param output	Index of the output in the configuration
+	 */
+	const std::vector<std::int16_t> &getOutput(const size_t output) const;
+
+	/**
+	 * Returns the number of samples of each channel produced for an output
+	 * by the last call to \ref process
+	 *
+	 * @throw irio::errors::DAQStageError	Output does not exist
+	 *
+	 * @param output	Index of the output in the configuration
+	 */
+	size_t getOutputSamples(const size_t output) const;
+
+	/**
+	 * Returns the number of outputs
+	 */
+	size_t getNumOutputs() const;
+
+	/**
+	 * Returns the number of channels of the stream
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Discards the partial windows and the state of the filters, to start
+	 * decimating a new stream
+	 */
+	void reset();
+
+ private:
+	struct OutputState {
+		DecimationOutput config;
+		/// Number of values (samples x channels) of each window
+		size_t window;
+		/// Values of the current window already processed
+		size_t position;
+		/// Partial results by position in the window, modulo the lanes
+		std::vector<std::int32_t> sums;
+		std::vector<std::int16_t> minimum;
+		std::vector<std::int16_t> maximum;
+		/// CIC state, by section and channel
+		std::vector<std::uint64_t> integrators;
+		std::vector<std::uint64_t> combs;
+		double gain;
+		std::vector<std::int16_t> values;
+	};
+
+	void accumulate(OutputState *state, const std::int16_t *values,
+					const size_t count, const SIMDLevel level) const;
+
+	void emit(OutputState *state) const;
+
+	void clearWindow(OutputState *state) const;
+
+	const size_t m_channels;
+	/// Partial results are kept per lane, a multiple of the channels and of
+	/// the 16 values of the vectors, so each lane belongs to one channel
+	const size_t m_lanes;
+	std::vector<OutputState> m_outputs;
+};
+
+}  // namespace daq
+}  // namespace irio
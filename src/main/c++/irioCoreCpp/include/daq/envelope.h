@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "daq/daqLayout.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Lowest and highest values of a channel in a range of samples
+ *
+ * @ingroup DAQ
+ */
+struct EnvelopePoint {
+	std::int16_t min;
+	std::int16_t max;
+};
+
+/**
+ * Builds the min/max envelopes of a recorded DAQ stream at several
+ * decimations, so that zoomed out views of long recordings can be drawn
+ * from the envelopes (see \ref irio::daq::EnvelopeReader) instead of the
+ * raw samples.
+ *
+ * Each level of the pyramid holds a point per channel every decimation
+ * samples. The first level is computed from the DMA blocks, with the
+ * channels interleaved, with SSE/AVX2 for 1, 2, 4 and 8 channels, and each
+ * of the others from the points of the previous level, so the samples are
+ * read only once.
+ *
+ * The envelopes are stored alongside the raw file of the recording: the
+ * points of each level in `<rawPath>.env.<decimation>` and a descriptor with
+ * the levels and the number of points written in `<rawPath>.env`. The
+ * points are buffered and written when enough of them are pending, or by
+ * \ref flush. The descriptor is only updated after the points, so the
+ * envelopes can be read while they are built.
+ *
+ * @ingroup DAQ
+ */
+class EnvelopeBuilder {
+ public:
+	/**
+	 * Creates the envelope files of a recording, replacing any previous ones
+	 *
+	 * @throw irio::errors::DAQStageError	No channels, no decimations or more
+	 * 										than 8, or a decimation lower than
+	 * 										2 or not multiple of the previous
+	 * @throw irio::errors::RecordingError	The files cannot be created
+	 *
+	 * @param rawPath		Path of the raw file of the recording
+	 * @param channels		Number of channels of the DMA
+	 * 						(\ref irio::TerminalsDMACommon::getNCh)
+	 * @param decimations	Samples of each point of each level, from the
+	 * 						finest to the coarsest
+	 */
+	EnvelopeBuilder(const std::string &rawPath, const size_t channels,
+					const std::vector<size_t> &decimations = {16, 256, 4096});
+
+	EnvelopeBuilder(const EnvelopeBuilder &) = delete;
+	EnvelopeBuilder &operator=(const EnvelopeBuilder &) = delete;
+
+	/**
+	 * Closes the envelope files, adding the incomplete points (see
+	 * \ref close). Errors writing them are ignored
+	 */
+	~EnvelopeBuilder();
+
+	/**
+	 * Adds the next block of the recording
+	 *
+	 * @throw irio::errors::DAQStageError	The envelopes are closed
+	 * @throw irio::errors::RecordingError	The points cannot be written
+	 *
+	 * @param words		DMA words of the block
+	 * @param elements	Number of DMA words. Only complete samples are
+	 * 					processed (\ref irio::daq::getBlockSamples)
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 */
+	void process(const std::uint64_t *words, const size_t elements,
+				 const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Writes the complete points pending and updates the descriptor
+	 *
+	 * @throw irio::errors::RecordingError	The files cannot be written
+	 */
+	void flush();
+
+	/**
+	 * Adds the last point of each level, with the samples processed after
+	 * the last complete one, writes all the points and closes the files.
+	 * Calling it again has no effect
+	 *
+	 * @throw irio::errors::RecordingError	The files cannot be written
+	 */
+	void close();
+
+	/**
+	 * Returns the number of samples of each channel processed
+	 */
+	std::uint64_t getPosition() const;
+
+	/**
+	 * Returns the number of channels of the recording
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the samples of each point of each level
+	 */
+	const std::vector<size_t> &getDecimations() const;
+
+	/**
+	 * Returns the path of the descriptor of the envelopes of a recording
+	 *
+	 * @param rawPath	Path of the raw file of the recording
+	 */
+	static std::string getDescriptorPath(const std::string &rawPath);
+
+	/**
+	 * Returns the path of the points of a level of the envelopes of a
+	 * recording
+	 *
+	 * @param rawPath		Path of the raw file of the recording
+	 * @param decimation	Samples of each point of the level
+	 */
+	static std::string getLevelPath(const std::string &rawPath,
+									const size_t decimation);
+
+ private:
+	/// Level of the pyramid being built
+	struct Level {
+		/// Points of the previous level, or samples, of each point
+		size_t ratio;
+		/// Point in progress of each channel
+		std::vector<EnvelopePoint> current;
+		/// Samples or points of the previous level of the current point
+		size_t filled;
+		/// Points completed, channels of each point together
+		std::vector<EnvelopePoint> pending;
+		/// Points written
+		std::uint64_t written;
+		int fd;
+	};
+
+	void completePoint(const size_t level);
+
+	void merge(const size_t level, const EnvelopePoint *point);
+
+	void writePending(Level *level);
+
+	void writeDescriptor();
+
+	void closeFiles();
+
+	const std::string m_rawPath;
+	const size_t m_channels;
+	const std::vector<size_t> m_decimations;
+	std::vector<Level> m_levels;
+	int m_descriptorFd;
+	std::uint64_t m_position;
+	bool m_closed;
+};
+
+/**
+ * Reads the envelopes of a recording written by a
+ * \ref irio::daq::EnvelopeBuilder, choosing the coarsest level that gives
+ * the resolution requested, so a view of a long recording reads a few
+ * points instead of all the samples.
+ *
+ * The reader can be used while the envelopes are being built, calling
+ * \ref refresh to see the points written since it was opened.
+ *
+ * @ingroup DAQ
+ */
+class EnvelopeReader {
+ public:
+	/**
+	 * Opens the envelopes of a recording
+	 *
+	 * @throw irio::errors::RecordingError	The files cannot be opened or
+	 * 										their layout is invalid
+	 *
+	 * @param rawPath	Path of the raw file of the recording
+	 */
+	explicit EnvelopeReader(const std::string &rawPath);
+
+	EnvelopeReader(const EnvelopeReader &) = delete;
+	EnvelopeReader &operator=(const EnvelopeReader &) = delete;
+
+	~EnvelopeReader();
+
+	/**
+	 * Reads the descriptor again, to update the points available
+	 *
+	 * @throw irio::errors::RecordingError	The descriptor cannot be read
+	 */
+	void refresh();
+
+	/**
+	 * Reads the envelope of a channel in a range of samples, with at most
+	 * the number of points requested. The points are read from the coarsest
+	 * level that has the resolution requested and covers the range, and
+	 * merged so that each one covers the same number of points of the level
+	 * (the last one can cover fewer samples). When even the finest level is
+	 * too coarse, fewer points are returned, and the raw samples should be
+	 * read instead for that view.
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found or no points
+	 * 										requested
+	 * @throw irio::errors::RecordingError	The points cannot be read
+	 *
+	 * @param channel		Number of the channel
+	 * @param firstSample	First sample of the range
+	 * @param samples		Number of samples of the range. It is limited to
+	 * 						the samples available
+	 * @param maxPoints		Maximum number of points to return
+	 * @param[out] points	Envelope of the range, a point per range of
+	 * 						samples returned
+	 * @param[out] start	First sample of the first point: \p firstSample
+	 * 						rounded down to a point of the level read
+	 * @return	Samples of each point returned
+	 */
+	std::uint64_t read(const size_t channel, const std::uint64_t firstSample,
+					   const std::uint64_t samples, const size_t maxPoints,
+					   std::vector<EnvelopePoint> *points,
+					   std::uint64_t *start) const;
+
+	/**
+	 * Returns the number of samples of each channel covered by the points
+	 * available
+	 */
+	std::uint64_t getSamples() const;
+
+	/**
+	 * Returns the number of channels of the recording
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the samples of each point of each level
+	 */
+	const std::vector<size_t> &getDecimations() const;
+
+	/**
+	 * Returns the number of points available of each level
+	 */
+	const std::vector<std::uint64_t> &getPoints() const;
+
+ private:
+	const std::string m_rawPath;
+	int m_descriptorFd;
+	size_t m_channels;
+	std::uint64_t m_samples;
+	std::vector<size_t> m_decimations;
+	std::vector<std::uint64_t> m_points;
+	std::vector<int> m_fds;
+};
+
+}  // namespace daq
+}  // namespace irio
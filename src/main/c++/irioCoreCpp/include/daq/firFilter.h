@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "daq/daqLayout.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Window applied to the ideal response when designing FIR filters
+ *
+ * @ingroup DAQ
+ */
+enum class FIRWindow : std::uint8_t {
+	Rectangular,	/**< Sharpest transition, lowest stopband attenuation */
+	Hamming,		/**< About 53 dB of stopband attenuation */
+	Blackman		/**< About 74 dB, with a wider transition */
+};
+
+/**
+ * Designs a low-pass FIR filter with the windowed-sinc method
+ *
+ * @throw irio::errors::DAQStageError	No taps or cutoff outside (0, 0.5)
+ *
+ * @param taps		Number of coefficients
+ * @param cutoff	Cutoff frequency, as a fraction of the sampling rate
+ * @param window	Window applied to the sinc
+ * @return	Coefficients, normalized to unit gain at DC
+ */
+std::vector<float> designLowPass(const size_t taps, const double cutoff,
+								 const FIRWindow window = FIRWindow::Hamming);
+
+/**
+ * Designs a high-pass FIR filter by spectral inversion of a low-pass one
+ *
+ * @throw irio::errors::DAQStageError	Even number of taps (the response
+ * 										must not be zero at Nyquist) or cutoff
+ * 										outside (0, 0.5)
+ *
+ * @param taps		Number of coefficients, odd
+ * @param cutoff	Cutoff frequency, as a fraction of the sampling rate
+ * @param window	Window applied to the sinc
+ * @return	Coefficients, with unit gain at Nyquist
+ */
+std::vector<float> designHighPass(const size_t taps, const double cutoff,
+								  const FIRWindow window = FIRWindow::Hamming);
+
+/**
+ * Designs a band-pass FIR filter as the difference of two low-pass ones
+ *
+ * @throw irio::errors::DAQStageError	No taps, or band not within (0, 0.5)
+ *
+ * @param taps	Number of coefficients
+ * @param low	Lower cutoff frequency, as a fraction of the sampling rate
+ * @param high	Upper cutoff frequency, as a fraction of the sampling rate
+ * @param window	Window applied to the sincs
+ * @return	Coefficients, normalized to unit gain at the center of the band
+ */
+std::vector<float> designBandPass(const size_t taps, const double low,
+								  const double high,
+								  const FIRWindow window = FIRWindow::Hamming);
+
+/**
+ * Filters the channels of a DAQ stream with the same FIR filter, optionally
+ * decimating the result.
+ *
+ * The stage works on deinterleaved blocks (see
+ * \ref irio::daq::deinterleave) and keeps the last samples of each channel,
+ * so the blocks of a stream are filtered as a continuous signal. Without
+ * decimation, each iteration of the SSE or AVX2 kernels computes 16 or 32
+ * consecutive outputs, accumulating the taps in the same order as the
+ * portable implementation, so the result does not depend on the
+ * instruction set. With decimation, only the outputs kept are computed
+ * (polyphase), vectorizing the dot product of each one. The channels can
+ * be split among several threads of the shared \ref irio::WorkerPool.
+ *
+ * @ingroup DAQ
+ */
+class FIRFilterStage {
+ public:
+	/**
+	 * Configures the stage
+	 *
+	 * @throw irio::errors::DAQStageError	No channels, coefficients or
+	 * 										decimation
+	 *
+	 * @param channels		Number of channels of the stream
+	 * @param coefficients	Impulse response of the filter
+	 * @param decimation	Number of input samples of each output sample.
+	 * 						1 to keep the sampling rate
+	 * @param threads		Max number of threads processing the channels
+	 */
+	FIRFilterStage(const size_t channels,
+				   const std::vector<float> &coefficients,
+				   const size_t decimation = 1, const unsigned threads = 1);
+
+	/**
+	 * Filters the next block of the stream
+	 *
+	 * @param in		Array of \ref getChannels buffers with the \p samples
+	 * 					samples of each channel
+	 * @param samples	Number of samples of each channel
+	 * @param out		Array of \ref getChannels buffers for the result, of
+	 * 					at least \ref getOutputSamples(samples) elements
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 * @return	Number of samples written to each output buffer
+	 */
+	size_t process(const std::int16_t *const *in, const size_t samples,
+				   float *const *out, const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Returns the number of samples of each channel that the next call to
+	 * \ref process will produce for a block
+	 *
+	 * @param samples	Number of samples of each channel of the block
+	 */
+	size_t getOutputSamples(const size_t samples) const;
+
+	/**
+	 * Returns the number of channels of the stream
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the number of coefficients of the filter
+	 */
+	size_t getTaps() const;
+
+	/**
+	 * Returns the decimation applied after filtering
+	 */
+	size_t getDecimation() const;
+
+	/**
+	 * Clears the past samples of the channels, to start filtering a new
+	 * stream
+	 */
+	void reset();
+
+ private:
+	void processChannels(const std::int16_t *const *in, const size_t samples,
+						 float *const *out, const SIMDLevel level,
+						 const size_t firstChannel, const size_t lastChannel);
+
+	const size_t m_channels;
+	/// Coefficients in reverse order, so outputs are dot products with the
+	/// samples in increasing order
+	const std::vector<float> m_reversed;
+	const size_t m_decimation;
+	const unsigned m_threads;
+	/// Last taps - 1 samples of each channel
+	std::vector<std::vector<float>> m_history;
+	/// Position of the next output from the start of the next block
+	size_t m_phase;
+};
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "daq/daqLayout.h"
+#include "daq/pulseDetector.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Counts of a channel of a \ref irio::daq::MCAHistogram
+ *
+ * @ingroup DAQ
+ */
+struct HistogramCounts {
+	/// Counts of each bin
+	std::vector<std::uint64_t> bins;
+	/// Values below the first bin
+	std::uint64_t underflow;
+	/// Values beyond the last bin
+	std::uint64_t overflow;
+};
+
+/**
+ * Histograms of the values of each channel, such as the amplitudes of the
+ * pulses found by a \ref irio::daq::PulseDetectorStage (pulse-height
+ * spectra) or the raw samples.
+ *
+ * Value v falls in bin (v - minimum) >> shift, so each bin covers 2^shift
+ * consecutive values. The values are not added to the histogram directly
+ * but through \ref irio::daq::MCAHistogram::Accumulator objects, one for
+ * each thread producing values, which count in private bins and merge them
+ * into the histogram every number of values or when requested. So several
+ * acquisition threads can fill the same histogram without contention, and
+ * the histogram can be read at any time without stopping them: it holds
+ * the values merged so far.
+ *
+ * @ingroup DAQ
+ */
+class MCAHistogram {
+ public:
+	/**
+	 * Private bins of a thread adding values to a \ref MCAHistogram. An
+	 * accumulator must only be used by one thread at a time, and must not
+	 * outlive its histogram
+	 *
+	 * @ingroup DAQ
+	 */
+	class Accumulator {
+	 public:
+		/**
+		 * Creates empty private bins for a histogram
+		 *
+		 * @param histogram		Histogram where the values are merged
+		 * @param mergeInterval	Number of values after which they are merged
+		 * 						automatically, up to 2^31
+		 */
+		explicit Accumulator(MCAHistogram *histogram,
+							 const size_t mergeInterval = 1 << 20);
+
+		/**
+		 * Merges the values not merged yet
+		 */
+		~Accumulator();
+
+		Accumulator(const Accumulator &) = delete;
+		Accumulator &operator=(const Accumulator &) = delete;
+
+		/**
+		 * Adds the raw samples of a block to the histogram of each channel
+		 *
+		 * @param in		Array of \ref MCAHistogram::getChannels buffers
+		 * 					with the \p samples samples of each channel
+		 * @param samples	Number of samples of each channel
+		 * @param level		Instruction set to use. If it is not supported by
+		 * 					the CPU, the best one supported is used
+		 */
+		void addSamples(const std::int16_t *const *in, const size_t samples,
+						const SIMDLevel level = getSIMDLevel());
+
+		/**
+		 * Adds the amplitude of each pulse to the histogram of its channel
+		 *
+		 * @throw irio::errors::DAQStageError	Channel of a pulse not found.
+		 * 										The previous pulses are added
+		 *
+		 * @param pulses	Pulses to add
+		 */
+		void addPulses(const std::vector<Pulse> &pulses);
+
+		/**
+		 * Adds values to the histogram of a channel
+		 *
+		 * @throw irio::errors::DAQStageError	Channel not found
+		 *
+		 * @param channel	Number of the channel
+		 * @param values	Values to add
+		 * @param count		Number of values
+		 */
+		void addValues(const size_t channel, const std::int32_t *values,
+					   const size_t count);
+
+		/**
+		 * Merges the values added since the last merge into the histogram
+		 */
+		void merge();
+
+		/**
+		 * Returns the number of values added and not merged yet
+		 */
+		size_t getPending() const;
+
+	 private:
+		void checkMerge();
+
+		MCAHistogram *const m_histogram;
+		const size_t m_mergeInterval;
+		/// Four interleaved copies of the bins of each channel, including
+		/// underflow and overflow, so consecutive equal values do not wait
+		/// for each other's increment
+		std::vector<std::vector<std::uint32_t>> m_counts;
+		/// Bin of each value of the part of a block being added
+		std::vector<std::uint32_t> m_indices;
+		size_t m_pending;
+	};
+
+	/**
+	 * Creates empty histograms
+	 *
+	 * @throw irio::errors::DAQStageError	No channels or bins, more than
+	 * 										2^24 bins, shift above 30 or
+	 * 										minimum outside [-2^30, 2^30]
+	 *
+	 * @param channels	Number of channels of the stream
+	 * @param bins		Number of bins of each histogram
+	 * @param minimum	First value of the first bin
+	 * @param shift		Log2 of the number of values of each bin
+	 */
+	MCAHistogram(const size_t channels, const size_t bins,
+				 const std::int32_t minimum = 0, const unsigned shift = 0);
+
+	MCAHistogram(const MCAHistogram &) = delete;
+	MCAHistogram &operator=(const MCAHistogram &) = delete;
+
+	/**
+	 * Copies the counts of a channel merged so far
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param channel		Number of the channel
+	 * @param[out] counts	Counts of the channel
+	 */
+	void getSnapshot(const size_t channel, HistogramCounts *counts) const;
+
+	/**
+	 * Copies the counts of a channel merged so far and clears them, without
+	 * losing values merged in between
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param channel		Number of the channel
+	 * @param[out] counts	Counts of the channel
+	 */
+	void takeSnapshot(const size_t channel, HistogramCounts *counts);
+
+	/**
+	 * Clears the counts of every channel. Values not merged yet by the
+	 * accumulators are counted after the reset
+	 */
+	void reset();
+
+	/**
+	 * Returns the number of channels
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the number of bins of each histogram
+	 */
+	size_t getBins() const;
+
+	/**
+	 * Returns the first value of the first bin
+	 */
+	std::int32_t getMinimum() const;
+
+	/**
+	 * Returns the log2 of the number of values of each bin
+	 */
+	unsigned getShift() const;
+
+ private:
+	void checkChannel(const size_t channel) const;
+
+	const size_t m_channels;
+	const size_t m_bins;
+	const std::int32_t m_minimum;
+	const unsigned m_shift;
+
+	mutable std::mutex m_mutex;
+	/// Counts of each channel: underflow, bins and overflow
+	std::vector<std::vector<std::uint64_t>> m_counts;
+};
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "daq/daqLayout.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Condition starting a pulse
+ *
+ * @ingroup DAQ
+ */
+enum class PulseTrigger : std::uint8_t {
+	/// The signal above the baseline reaches the threshold
+	Threshold,
+	/// The rise of the signal in lag samples reaches the threshold,
+	/// regardless of the baseline
+	Derivative
+};
+
+/**
+ * Direction of the pulses from the baseline
+ *
+ * @ingroup DAQ
+ */
+enum class PulsePolarity : std::uint8_t {
+	Positive,	/**< Pulses above the baseline */
+	Negative	/**< Pulses below the baseline, measured as positive */
+};
+
+/**
+ * Detection parameters of a channel of a \ref irio::daq::PulseDetectorStage
+ *
+ * The signal of the channel is its value minus the baseline, negated for
+ * negative pulses.
+ *
+ * @ingroup DAQ
+ */
+struct PulseDetectorConfig {
+	/// Condition starting a pulse
+	PulseTrigger trigger;
+	/// Direction of the pulses
+	PulsePolarity polarity;
+	/// Value of the channel without pulses
+	std::int16_t baseline;
+	/// Signal (Threshold) or rise in lag samples (Derivative) starting a
+	/// pulse, from 1 to 32767
+	std::int32_t threshold;
+	/// Signal below which the pulse ends. With the Threshold trigger, the
+	/// difference with the threshold is the hysteresis
+	std::int32_t release;
+	/// Distance in samples of the Derivative trigger
+	size_t lag;
+	/// Samples before the start of each pulse kept in its waveform
+	size_t preSamples;
+	/// Samples after the end of each pulse kept in its waveform. Without
+	/// pre or post samples, no waveforms are kept
+	size_t postSamples;
+};
+
+/**
+ * Pulse found by a \ref irio::daq::PulseDetectorStage. Positions are
+ * samples since the start of the stream
+ *
+ * @ingroup DAQ
+ */
+struct Pulse {
+	/// Number of the channel
+	size_t channel;
+	/// First sample of the pulse
+	std::uint64_t start;
+	/// Time of arrival, interpolating linearly where the trigger condition
+	/// crosses the threshold
+	double timeOfArrival;
+	/// Max signal of the pulse
+	std::int32_t amplitude;
+	/// Sample with the max signal
+	std::uint64_t peak;
+	/// Number of samples of the pulse
+	size_t width;
+	/// Sum of the signal of the pulse samples
+	std::int64_t area;
+	/// Position of the waveform in the waveforms of the stage
+	size_t waveformOffset;
+	/// Samples of the waveform, 0 if waveforms are not kept
+	size_t waveformSamples;
+	/// Samples of the waveform before the start of the pulse. Fewer than
+	/// configured for pulses at the start of the stream
+	size_t waveformPreSamples;
+};
+
+/**
+ * Finds the pulses of the channels of a DAQ stream and extracts their
+ * features, optionally keeping the raw samples around each one.
+ *
+ * The stage works on deinterleaved blocks (see
+ * \ref irio::daq::deinterleave). A pulse starts at the first sample meeting
+ * the trigger condition and ends at the first sample whose signal is below
+ * the release level, so the hysteresis prevents noise around the threshold
+ * from splitting pulses. Pulses may span several blocks. The samples
+ * between pulses are scanned with SSE or AVX2 comparisons, which test 8 or
+ * 16 samples at once, so the cost is dominated by the pulses themselves.
+ *
+ * A pulse is reported by the call to \ref process that completes it,
+ * including its post samples when waveforms are kept.
+ *
+ * @ingroup DAQ
+ */
+class PulseDetectorStage {
+ public:
+	/**
+	 * Configures the stage
+	 *
+	 * @throw irio::errors::DAQStageError	No channels, threshold outside
+	 * 										[1, 32767], release above the
+	 * 										threshold with the Threshold
+	 * 										trigger, threshold level out of
+	 * 										the int16 range or lag of 0 with
+	 * 										the Derivative trigger
+	 *
+	 * @param channels	Detection parameters of each channel of the stream
+	 */
+	explicit PulseDetectorStage(
+		const std::vector<PulseDetectorConfig> &channels);
+
+	/**
+	 * Processes the next block of the stream. The pulses completed replace
+	 * those of the previous block
+	 *
+	 * @param in		Array of \ref getChannels buffers with the \p samples
+	 * 					samples of each channel
+	 * @param samples	Number of samples of each channel
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 * @return	Number of pulses completed
+	 */
+	size_t process(const std::int16_t *const *in, const size_t samples,
+				   const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Returns the pulses completed by the last call to \ref process, in
+	 * order of completion for each channel, grouped by channel
+	 */
+	const std::vector<Pulse> &getPulses() const;
+
+	/**
+	 * Returns the waveforms of the pulses of \ref getPulses, one after
+	 * another
+	 */
+	const std::vector<std::int16_t> &getWaveforms() const;
+
+	/**
+	 * Returns the number of pulses completed since the stream started
+	 */
+	std::uint64_t getDetected() const;
+
+	/**
+	 * Returns the number of samples of each channel processed since the
+	 * stream started
+	 */
+	std::uint64_t getPosition() const;
+
+	/**
+	 * Returns the number of channels of the stream
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Discards the pulses in progress and the past samples, to start
+	 * processing a new stream
+	 */
+	void reset();
+
+ private:
+	/// Pulse waiting for its post samples
+	struct Pending {
+		Pulse pulse;
+		std::vector<std::int16_t> waveform;
+		size_t remaining;
+	};
+
+	struct Channel {
+		PulseDetectorConfig config;
+		/// Last samples of the stream, oldest first
+		std::vector<std::int16_t> history;
+		bool inPulse;
+		/// Pulse in progress
+		Pulse pulse;
+		std::vector<std::int16_t> waveform;
+		/// Pulses waiting for their post samples, in order of completion
+		std::deque<Pending> pending;
+	};
+
+	void processChannel(Channel *channel, const std::int16_t *x,
+						const size_t samples, const SIMDLevel level);
+
+	void startPulse(Channel *channel, const std::int16_t *x,
+					const size_t n) const;
+
+	void endPulse(Channel *channel, const std::int16_t *x,
+				  const size_t samples, const size_t n);
+
+	void emit(const Pulse &pulse, const std::vector<std::int16_t> &waveform);
+
+	/**
+	 * Sample n of the block, where negative values are past samples
+	 */
+	static std::int16_t sample(const Channel &channel, const std::int16_t *x,
+							   const std::int64_t n);
+
+	std::vector<Channel> m_channels;
+	/// Past samples kept of each channel
+	const size_t m_historySamples;
+	std::uint64_t m_position;
+	std::uint64_t m_detected;
+	std::vector<Pulse> m_pulses;
+	std::vector<std::int16_t> m_waveforms;
+};
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,345 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "daq/daqLayout.h"
+#include "daq/envelope.h"
+#include "terminals/terminalsDMACommon.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Block of a recording, as stored in its index
+ *
+ * @ingroup DAQ
+ */
+struct RecordedBlock {
+	/// Offset of the block in the raw file, in bytes
+	std::uint64_t offset;
+	/// Number of DMA words of the block
+	std::uint64_t elements;
+	/// Time of the block, in nanoseconds. Host time
+	/// (\ref irio::daq::DAQRecorder::getHostTime) unless given when recorded
+	std::int64_t timestamp;
+};
+
+/**
+ * Samples of a channel of a recording, in the memory where the recording is
+ * mapped. The channels are interleaved, so the samples are \ref stride
+ * values apart
+ *
+ * @ingroup DAQ
+ */
+struct ChannelSpan {
+	/// Number of the channel
+	size_t channel;
+	/// Position of the first sample in the recording
+	std::uint64_t firstSample;
+	/// Number of samples
+	size_t samples;
+	/// First sample
+	const std::int16_t *data;
+	/// Values from a sample to the next one (number of channels)
+	size_t stride;
+
+	/**
+	 * Returns a sample of the span
+	 *
+	 * @param i	Number of the sample, from the first one of the span
+	 */
+	std::int16_t operator[](const size_t i) const {
+		return data[i * stride];
+	}
+};
+
+/**
+ * Records the blocks of a DAQ stream to a raw file, with the DMA words as
+ * they are read, and writes an index with the offset and the time of each
+ * block to `<path>.idx`, so that a range of the recording can be found
+ * without scanning it (see \ref irio::daq::RecordingReader).
+ *
+ * Each block is written to the raw file before its entry in the index, so
+ * the index only refers to data already written and the recording can be
+ * read while it is in progress. Optionally, the min/max envelopes of the
+ * recording are built at the same time (see \ref irio::daq::EnvelopeBuilder).
+ *
+ * @ingroup DAQ
+ */
+class DAQRecorder {
+ public:
+	/**
+	 * Creates the files of a recording, replacing any previous ones
+	 *
+	 * @throw irio::errors::DAQStageError	No channels or invalid decimations
+	 * 										of the envelopes
+	 * @throw irio::errors::RecordingError	The files cannot be created
+	 *
+	 * @param path			Path of the raw file
+	 * @param channels		Number of channels of the DMA
+	 * 						(\ref irio::TerminalsDMACommon::getNCh)
+	 * @param envelopes		Decimations of the envelopes to build. No
+	 * 						envelopes are built if empty
+	 */
+	DAQRecorder(const std::string &path, const size_t channels,
+				const std::vector<size_t> &envelopes = {});
+
+	DAQRecorder(const DAQRecorder &) = delete;
+	DAQRecorder &operator=(const DAQRecorder &) = delete;
+
+	/**
+	 * Closes the recording (see \ref close). Errors writing the envelopes
+	 * are ignored
+	 */
+	~DAQRecorder();
+
+	/**
+	 * Appends a block to the recording, with the current host time
+	 *
+	 * @throw irio::errors::DAQStageError	The recording is closed, or it
+	 * 										has envelopes and the block does
+	 * 										not hold whole samples
+	 * @throw irio::errors::RecordingError	The block cannot be written
+	 *
+	 * @param words		DMA words of the block
+	 * @param elements	Number of DMA words
+	 */
+	void record(const std::uint64_t *words, const size_t elements);
+
+	/**
+	 * Appends a block to the recording, with the time given, e.g. taken from
+	 * the FPGA. The times of the blocks must not decrease, for the reader
+	 * to find them
+	 *
+	 * @throw irio::errors::DAQStageError	The recording is closed, or it
+	 * 										has envelopes and the block does
+	 * 										not hold whole samples
+	 * @throw irio::errors::RecordingError	The block cannot be written
+	 *
+	 * @param words		DMA words of the block
+	 * @param elements	Number of DMA words
+	 * @param timestamp	Time of the block, in nanoseconds
+	 */
+	void record(const std::uint64_t *words, const size_t elements,
+				const std::int64_t timestamp);
+
+	/**
+	 * Acquires a block from a DMA, without copying it
+	 * (\ref irio::TerminalsDMACommon::acquireData), records it with the
+	 * current host time and releases it
+	 *
+	 * @throw irio::errors::DMAReadTimeout	The timeout expires before the
+	 * 										elements are available
+	 * @throw irio::errors::NiFpgaError		Error acquiring the elements
+	 * @throw irio::errors::DAQStageError	The recording is closed, or it
+	 * 										has envelopes and the block does
+	 * 										not hold whole samples
+	 * @throw irio::errors::RecordingError	The block cannot be written
+	 *
+	 * @param terminals	DMA terminals of the Irio object
+	 * @param n			Number of the DMA
+	 * @param elements	Number of DMA words to record
+	 * @param timeout	Max time in milliseconds to wait for the elements,
+	 * 					0 to wait indefinitely
+	 * @return	Number of DMA words recorded. It can be less than
+	 * 			\p elements when the block wraps around the end of the host
+	 * 			buffer (see \ref irio::TerminalsDMACommon::acquireData)
+	 */
+	size_t recordFromDMA(const TerminalsDMACommon &terminals,
+						 const std::uint32_t n, const size_t elements,
+						 const std::uint32_t timeout = 0);
+
+	/**
+	 * Closes the files of the recording, and the envelopes, adding their
+	 * incomplete points. Calling it again has no effect
+	 *
+	 * @throw irio::errors::RecordingError	The envelopes cannot be written
+	 */
+	void close();
+
+	/**
+	 * Returns the number of blocks recorded
+	 */
+	std::uint64_t getBlocks() const;
+
+	/**
+	 * Returns the number of DMA words recorded
+	 */
+	std::uint64_t getElements() const;
+
+	/**
+	 * Returns the number of channels of the recording
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the path of the index of a recording
+	 *
+	 * @param path	Path of the raw file of the recording
+	 */
+	static std::string getIndexPath(const std::string &path);
+
+	/**
+	 * Returns the current host time, in nanoseconds since the epoch
+	 */
+	static std::int64_t getHostTime();
+
+ private:
+	const std::string m_path;
+	const size_t m_channels;
+	std::unique_ptr<EnvelopeBuilder> m_envelopes;
+	int m_rawFd;
+	int m_indexFd;
+	std::uint64_t m_blocks;
+	std::uint64_t m_elements;
+};
+
+/**
+ * Reads a recording written by a \ref irio::daq::DAQRecorder. The raw file
+ * and the index are mapped in memory, so the blocks of a range of time are
+ * found with a binary search on the index and the samples of the channels
+ * requested are returned as spans of the mapped file, without copying or
+ * reading the rest of the recording.
+ *
+ * The reader can be used while the recording is in progress, calling
+ * \ref refresh to map the blocks recorded since it was opened.
+ *
+ * @ingroup DAQ
+ */
+class RecordingReader {
+ public:
+	/**
+	 * Opens and maps a recording
+	 *
+	 * @throw irio::errors::RecordingError	The files cannot be opened or
+	 * 										mapped, or the index is invalid
+	 *
+	 * @param path	Path of the raw file of the recording
+	 */
+	explicit RecordingReader(const std::string &path);
+
+	RecordingReader(const RecordingReader &) = delete;
+	RecordingReader &operator=(const RecordingReader &) = delete;
+
+	~RecordingReader();
+
+	/**
+	 * Maps the blocks recorded since the recording was opened or last
+	 * refreshed. Spans obtained before are no longer valid
+	 *
+	 * @throw irio::errors::RecordingError	The files cannot be mapped
+	 */
+	void refresh();
+
+	/**
+	 * Returns the entry of the index of a block
+	 *
+	 * @throw irio::errors::DAQStageError	Block not recorded
+	 *
+	 * @param block	Number of the block
+	 */
+	RecordedBlock getBlock(const std::uint64_t block) const;
+
+	/**
+	 * Returns the position of the first sample of a block. Samples belong to
+	 * the block where their first value is
+	 *
+	 * @throw irio::errors::DAQStageError	Block not recorded
+	 *
+	 * @param block	Number of the block. The number of blocks returns the
+	 * 				number of samples recorded
+	 */
+	std::uint64_t getBlockSample(const std::uint64_t block) const;
+
+	/**
+	 * Returns the first block whose time is not before the one given, or
+	 * the number of blocks if all of them are before it
+	 *
+	 * @param timestamp	Time, in nanoseconds
+	 */
+	std::uint64_t findBlock(const std::int64_t timestamp) const;
+
+	/**
+	 * Returns the samples of some channels in a range of samples
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param firstSample	Position of the first sample
+	 * @param samples		Number of samples. It is limited to the samples
+	 * 						recorded
+	 * @param channels		Channels to return
+	 * @param[out] spans	A span per channel, in the order requested
+	 */
+	void getSampleRange(const std::uint64_t firstSample,
+						const std::uint64_t samples,
+						const std::vector<size_t> &channels,
+						std::vector<ChannelSpan> *spans) const;
+
+	/**
+	 * Returns the samples of some channels in a range of blocks
+	 *
+	 * @throw irio::errors::DAQStageError	Channel or blocks not found
+	 *
+	 * @param firstBlock	Number of the first block
+	 * @param blocks		Number of blocks
+	 * @param channels		Channels to return
+	 * @param[out] spans	A span per channel, in the order requested
+	 */
+	void getBlockRange(const std::uint64_t firstBlock,
+					   const std::uint64_t blocks,
+					   const std::vector<size_t> &channels,
+					   std::vector<ChannelSpan> *spans) const;
+
+	/**
+	 * Returns the samples of some channels in the blocks whose time is in a
+	 * range
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param start			Start of the range, in nanoseconds
+	 * @param end			End of the range, not included, in nanoseconds
+	 * @param channels		Channels to return
+	 * @param[out] spans	A span per channel, in the order requested
+	 */
+	void getTimeRange(const std::int64_t start, const std::int64_t end,
+					  const std::vector<size_t> &channels,
+					  std::vector<ChannelSpan> *spans) const;
+
+	/**
+	 * Returns the number of blocks mapped
+	 */
+	std::uint64_t getBlocks() const;
+
+	/**
+	 * Returns the number of samples of each channel mapped
+	 */
+	std::uint64_t getSamples() const;
+
+	/**
+	 * Returns the number of channels of the recording
+	 */
+	size_t getChannels() const;
+
+ private:
+	void unmap();
+
+	const std::string m_path;
+	int m_rawFd;
+	int m_indexFd;
+	size_t m_channels;
+	const void *m_rawMap;
+	size_t m_rawSize;
+	const void *m_indexMap;
+	size_t m_indexSize;
+	const RecordedBlock *m_index;
+	std::uint64_t m_blocks;
+	const std::int16_t *m_values;
+	std::uint64_t m_samples;
+};
+
+}  // namespace daq
+}  // namespace irio
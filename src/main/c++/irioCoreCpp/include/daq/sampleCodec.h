@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "daq/daqLayout.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Lossless compression of DAQ blocks, fast enough to be used inline with the
+ * acquisition, e.g. before recording or publishing the blocks.
+ *
+ * The block is split in channels and each channel is coded independently:
+ * every sample is replaced by its difference with the previous one (wrapped
+ * to 16 bits), mapped to an unsigned value with zigzag coding (0, -1, 1,
+ * -2, 2...) and the values are bit packed in groups of 256 samples, with the
+ * bits required by the largest value of each group. Slow-varying channels
+ * need a few bits per sample, and noisy channels at most one byte per group
+ * more than their raw size. The groups are packed in 16 interleaved lanes,
+ * so the SSE/AVX2 kernels code a row of the group per instruction; the
+ * compressed data does not depend on the instruction set used.
+ *
+ * Channels can be compressed and decompressed in parallel, and a single
+ * channel can be decompressed without decoding the others. Each block is
+ * self-contained, so blocks can be decompressed in any order.
+ *
+ * The compressed data starts with a header of 12 bytes plus 4 bytes per
+ * channel, in the byte order of the host:
+ * - Magic number "IRSC"
+ * - Format version (1 byte) and a reserved byte
+ * - Number of channels (2 bytes)
+ * - Number of DMA words of the block (4 bytes)
+ * - Size in bytes of each channel (4 bytes each), followed by the channels.
+ *   A channel holds, per group, its bit width (1 byte) and 32 bytes per bit
+ * - The values after the last complete sample of the block, verbatim
+ *
+ * Data padded up to a multiple of 8 bytes can be decompressed, so compressed
+ * blocks can be published as DMA words, e.g. with
+ * \ref irio::DMASharedPublisher::publish.
+ *
+ * @ingroup DAQ
+ */
+class SampleCodec {
+ public:
+	/**
+	 * Configures the codec
+	 *
+	 * @throw irio::errors::DAQStageError	No channels or more than 65535
+	 *
+	 * @param channels	Number of channels of the DMA
+	 * 					(\ref irio::TerminalsDMACommon::getNCh)
+	 * @param threads	Max number of threads of the shared
+	 * 					\ref irio::WorkerPool. Channels are compressed and
+	 * 					decompressed in parallel when more than 1
+	 */
+	explicit SampleCodec(const size_t channels, const unsigned threads = 1);
+
+	/**
+	 * Compresses a DAQ block
+	 *
+	 * @throw irio::errors::DAQStageError	Block of more than
+	 * 										\ref MAX_ELEMENTS DMA words
+	 *
+	 * @param words		DMA words of the block
+	 * @param elements	Number of DMA words
+	 * @param out		Buffer of \ref getMaxCompressedSize bytes
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 * @return	Number of bytes of the compressed block
+	 */
+	size_t compress(const std::uint64_t *words, const size_t elements,
+					std::uint8_t *out,
+					const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Decompresses a DAQ block
+	 *
+	 * @throw irio::errors::CodecError	The data is truncated or corrupted, or
+	 * 									it is a block of other channels
+	 *
+	 * @param data		Compressed block
+	 * @param size		Number of bytes of \p data
+	 * @param words		Buffer of \ref getElements DMA words for the block
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 * @return	Number of DMA words of the block
+	 */
+	size_t decompress(const std::uint8_t *data, const size_t size,
+					  std::uint64_t *words,
+					  const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Decompresses the samples of a channel of a DAQ block, without
+	 * decoding the other channels
+	 *
+	 * @throw irio::errors::CodecError	The data is truncated or corrupted, or
+	 * 									it is a block of other channels
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param data		Compressed block
+	 * @param size		Number of bytes of \p data
+	 * @param channel	Channel to decompress
+	 * @param samples	Buffer of \ref getBlockSamples elements for the
+	 * 					samples of the channel
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 * @return	Number of samples of the channel
+	 */
+	size_t decompressChannel(const std::uint8_t *data, const size_t size,
+							 const size_t channel, std::int16_t *samples,
+							 const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Returns the number of DMA words of a compressed block
+	 *
+	 * @throw irio::errors::CodecError	The data is not a compressed block of
+	 * 									the channels of the codec
+	 *
+	 * @param data		Compressed block
+	 * @param size		Number of bytes of \p data
+	 */
+	size_t getElements(const std::uint8_t *data, const size_t size) const;
+
+	/**
+	 * Returns the size of the output buffer required to compress a block,
+	 * which is the worst case for incompressible blocks. It is a multiple
+	 * of 8 bytes
+	 *
+	 * @param elements	Number of DMA words of the block
+	 */
+	size_t getMaxCompressedSize(const size_t elements) const;
+
+	/**
+	 * Returns the number of channels of the blocks
+	 */
+	size_t getChannels() const;
+
+	/// Max number of DMA words of a block (2 GiB)
+	static constexpr size_t MAX_ELEMENTS = size_t(1) << 28;
+
+ private:
+	void decodeChannels(const std::uint8_t *data, const size_t first,
+						const size_t last, std::int16_t *const *out,
+						const SIMDLevel level) const;
+
+	const size_t m_channels;
+	const unsigned m_threads;
+};
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "daq/daqLayout.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Window applied to each frame before computing its spectrum
+ *
+ * @ingroup DAQ
+ */
+enum class SpectrumWindow : std::uint8_t {
+	Rectangular,	/**< Best resolution, highest leakage */
+	Hann,			/**< General purpose */
+	Hamming,		/**< Lower first sidelobe than Hann, slower decay */
+	Blackman		/**< Lowest leakage, widest main lobe */
+};
+
+/**
+ * Computes the averaged power spectrum of each channel of a DAQ stream.
+ *
+ * The stage works on deinterleaved blocks (see
+ * \ref irio::daq::deinterleave). The samples of each channel are split into
+ * frames of \ref getFFTSize samples, starting every \ref getHop samples, so
+ * consecutive frames overlap when the hop is smaller than the FFT size and
+ * samples are skipped when it is larger. Each frame is windowed and
+ * transformed with a built-in radix-2 real FFT, whose butterflies use SSE or
+ * AVX2, and the power spectra of \ref getAverages consecutive frames are
+ * averaged and published.
+ *
+ * The published spectrum is double buffered: \ref process fills the back
+ * buffer and swaps it with the front one, so the latest spectrum can be read
+ * from other threads while the acquisition thread keeps processing blocks.
+ * The power of bin k, at k times the sampling rate divided by the FFT size,
+ * is normalized so that a sinusoid centered in the bin gives its mean
+ * square value in counts^2.
+ *
+ * @ingroup DAQ
+ */
+class SpectrumStage {
+ public:
+	/**
+	 * Configures the stage
+	 *
+	 * @throw irio::errors::DAQStageError	No channels, hop or averages, or
+	 * 										FFT size not a power of 2 of at
+	 * 										least 8 samples
+	 *
+	 * @param channels	Number of channels of the stream
+	 * @param fftSize	Number of samples of each frame, power of 2
+	 * @param hop		Number of samples between the start of consecutive
+	 * 					frames. fftSize / 2 gives 50% overlap
+	 * @param averages	Number of frames averaged in each published spectrum
+	 * @param window	Window applied to each frame
+	 * @param threads	Max number of threads of the shared
+	 * 					\ref irio::WorkerPool processing the channels
+	 */
+	SpectrumStage(const size_t channels, const size_t fftSize,
+				  const size_t hop, const size_t averages,
+				  const SpectrumWindow window = SpectrumWindow::Hann,
+				  const unsigned threads = 1);
+
+	SpectrumStage(const SpectrumStage &) = delete;
+	SpectrumStage &operator=(const SpectrumStage &) = delete;
+
+	/**
+	 * Processes the next block of the stream. It must not be called from
+	 * several threads at the same time
+	 *
+	 * @param in		Array of \ref getChannels buffers with the \p samples
+	 * 					samples of each channel
+	 * @param samples	Number of samples of each channel
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 * @return	Number of spectra completed with this block. Only the last
+	 * 			one can be read
+	 */
+	size_t process(const std::int16_t *const *in, const size_t samples,
+				   const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Copies the latest spectrum of a channel. It can be called from any
+	 * thread
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found
+	 *
+	 * @param channel		Number of the channel
+	 * @param[out] spectrum	Power of the \ref getBins bins, zeros if no
+	 * 						spectrum has been published
+	 * @return	Number of spectra published when it was copied, so
+	 * 			consecutive calls can detect new spectra
+	 */
+	std::uint64_t getSpectrum(const size_t channel,
+							  std::vector<float> *spectrum) const;
+
+	/**
+	 * Copies the latest spectrum of every channel, all from the same frames.
+	 * It can be called from any thread
+	 *
+	 * @param[out] spectra	\ref getBins values of each channel, one channel
+	 * 						after another
+	 * @return	Number of spectra published when they were copied
+	 */
+	std::uint64_t getSpectra(std::vector<float> *spectra) const;
+
+	/**
+	 * Returns the number of spectra published since the stage was created
+	 */
+	std::uint64_t getPublished() const;
+
+	/**
+	 * Returns the number of bins of each spectrum, from DC to the Nyquist
+	 * frequency
+	 */
+	size_t getBins() const;
+
+	/**
+	 * Returns the number of channels of the stream
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the number of samples of each frame
+	 */
+	size_t getFFTSize() const;
+
+	/**
+	 * Returns the number of samples between the start of consecutive frames
+	 */
+	size_t getHop() const;
+
+	/**
+	 * Returns the number of frames averaged in each spectrum
+	 */
+	size_t getAverages() const;
+
+	/**
+	 * Discards the frames being accumulated, to start processing a new
+	 * stream. The latest spectrum published can still be read
+	 */
+	void reset();
+
+ private:
+	/// Position of the stream in the frames, the same for every channel
+	struct Framing {
+		/// Samples of the current frame
+		size_t filled;
+		/// Samples to skip before the next frame, when the hop exceeds the
+		/// FFT size
+		size_t skip;
+		/// Frames added to the sums
+		size_t frames;
+	};
+
+	/**
+	 * Splits the block into frames for a range of channels, returning the
+	 * number of spectra completed. \p framing is updated to the state after
+	 * the block
+	 */
+	size_t processChannels(const std::int16_t *const *in, const size_t samples,
+						   const SIMDLevel level, const size_t firstChannel,
+						   const size_t lastChannel, Framing *framing);
+
+	/**
+	 * Adds the power spectrum of the current frame of a channel to its sum
+	 */
+	void accumulate(const size_t channel, const SIMDLevel level);
+
+	const size_t m_channels;
+	const size_t m_fftSize;
+	const size_t m_hop;
+	const size_t m_averages;
+	const unsigned m_threads;
+
+	/// Window value of each sample of a frame
+	std::vector<float> m_window;
+	/// Position of each complex FFT input, bit reversed
+	std::vector<std::uint32_t> m_bitReverse;
+	/// Twiddle factors of the complex FFT, one stage after another
+	std::vector<float> m_twiddleRe, m_twiddleIm;
+	/// Twiddle factors splitting the complex FFT into the real one
+	std::vector<float> m_splitRe, m_splitIm;
+	/// Scale of the accumulated power of each bin
+	std::vector<double> m_scale;
+
+	/// Frame being filled of each channel
+	std::vector<std::vector<float>> m_frames;
+	/// Sum of the power spectra of each channel
+	std::vector<std::vector<double>> m_sums;
+	Framing m_framing;
+
+	/// Spectra of all the channels, one for the readers and one for process
+	std::vector<float> m_buffers[2];
+	size_t m_front;
+	mutable std::mutex m_mutex;
+	std::atomic<std::uint64_t> m_published{0};
+};
+
+}  // namespace daq
+}  // namespace irio
@@ -0,0 +1,384 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "daq/daqLayout.h"
+#include "imaq/framePool.h"
+#include "terminals/terminalsDigital.h"
+#include "terminals/terminalsDMACommon.h"
+
+namespace irio {
+namespace daq {
+
+/**
+ * Event that started a capture
+ *
+ * @ingroup DAQ
+ */
+enum class TriggerSource : std::uint8_t {
+	/// \ref irio::daq::TriggeredCapture::trigger called by the user
+	Software,
+	/// Edge of a DI terminal
+	Digital,
+	/// A channel crossing a level
+	Threshold
+};
+
+/**
+ * Transitions that fire a DI or threshold trigger
+ *
+ * @ingroup DAQ
+ */
+enum class TriggerEdge : std::uint8_t {
+	Rising,		/**< From below the level (false) to above it (true) */
+	Falling,	/**< From above the level (true) to below it (false) */
+	Both		/**< Any of them */
+};
+
+/**
+ * Window of a DAQ stream around a trigger, obtained from a
+ * \ref irio::daq::TriggeredCapture. Positions are samples since the start of
+ * the stream
+ *
+ * @ingroup DAQ
+ */
+struct Capture {
+	/// Blocks with the samples of the capture, oldest first. They belong to
+	/// the capture stage and are not copied
+	const std::uint64_t *const *blocks;
+	/// Number of blocks
+	size_t numBlocks;
+	/// Sample of the first block where the capture starts
+	size_t firstSample;
+	/// Samples of each channel of the capture
+	size_t samples;
+	/// Samples of the capture before the trigger. Fewer than configured if
+	/// the trigger came earlier in the stream
+	size_t preSamples;
+	/// Sample of the trigger
+	std::uint64_t triggerPosition;
+	/// Event that started the capture
+	TriggerSource source;
+	/// Number of the capture, starting at 0
+	std::uint64_t captureNumber;
+	/// Host time when the block with the trigger was committed
+	std::chrono::steady_clock::time_point timestamp;
+};
+
+/**
+ * Keeps the recent history of a DAQ stream and captures the samples before
+ * and after each trigger.
+ *
+ * The blocks of the stream are read into a preallocated ring of blocks,
+ * either by \ref acquireFromDMA or by the user between \ref beginBlock and
+ * \ref commitBlock, and stay available to process the stream as usual. When
+ * a trigger fires, the blocks holding the pre-trigger samples are frozen:
+ * the capture takes them from the ring, which continues with other blocks
+ * of the pool, and the following blocks are added to the capture until it
+ * holds the post-trigger samples. No samples are copied.
+ *
+ * Three triggers are available, and the first one to fire in a block starts
+ * the capture:
+ * - software, with \ref trigger, at the first sample of the next block
+ * - DI edge, polled once per block, at the first sample of the block
+ * - threshold crossing of a channel, at the exact sample. The blocks are
+ *   scanned with SSE or AVX2 comparisons for 1, 2, 4 and 8 channels
+ *
+ * Completed captures are queued until the user gets them with
+ * \ref getCapture and must be returned with \ref releaseCapture. Triggers
+ * that fire while a capture is collecting its post-trigger samples, or when
+ * all the captures are held by the user, are counted as missed.
+ *
+ * The acquisition (begin/commit) and the configuration of the triggers
+ * must be done by one thread. The software trigger can be fired, and the
+ * captures obtained and released, from other threads.
+ *
+ * @ingroup DAQ
+ */
+class TriggeredCapture {
+ public:
+	/**
+	 * Allocates the blocks of the ring and of the captures
+	 *
+	 * @throw irio::errors::DAQStageError	No channels, blocks without
+	 * 										whole samples (4 x
+	 * 										\p blockElements not a multiple
+	 * 										of \p channels), no samples to
+	 * 										capture or no captures
+	 * @throw irio::errors::FramePoolError	Unable to allocate the blocks
+	 *
+	 * @param channels		Number of channels of the DMA
+	 * @param blockElements	Number of DMA elements (64 bits) of each block
+	 * @param preSamples	Samples of each channel to capture before the
+	 * 						trigger
+	 * @param postSamples	Samples of each channel to capture from the
+	 * 						trigger on, including it
+	 * @param maxCaptures	Max number of captures completed or in progress
+	 * 						at the same time
+	 * @param hugePages		Whether to try to use huge pages for the blocks
+	 */
+	TriggeredCapture(const size_t channels, const size_t blockElements,
+					 const size_t preSamples, const size_t postSamples,
+					 const size_t maxCaptures = 2,
+					 const bool hugePages = false);
+
+	TriggeredCapture(const TriggeredCapture &) = delete;
+	TriggeredCapture &operator=(const TriggeredCapture &) = delete;
+
+	/**
+	 * Returns the buffer where the next block of the stream must be
+	 * written. Calling it again before \ref commitBlock returns the same
+	 * buffer
+	 *
+	 * @return	Buffer of \ref getBlockElements elements
+	 */
+	std::uint64_t *beginBlock();
+
+	/**
+	 * Adds the block written in the buffer of \ref beginBlock to the
+	 * history and checks the triggers
+	 *
+	 * @throw irio::errors::DAQStageError	\ref beginBlock not called
+	 * @throw irio::errors::NiFpgaError	Error reading the DI of the trigger
+	 *
+	 * @param level	Instruction set to use. If it is not supported by
+	 * 				the CPU, the best one supported is used
+	 * @return	The block, valid until the next block is committed
+	 */
+	const std::uint64_t *commitBlock(const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Reads the next block of the stream from a DMA and commits it
+	 *
+	 * @throw irio::errors::ResourceNotFoundError	DMA not found
+	 * @throw irio::errors::DMAReadTimeout	The block was not available
+	 * 										before \p timeout expired
+	 * @throw irio::errors::NiFpgaError	Error occurred in an FPGA operation
+	 *
+	 * @param terminals	DMA terminals of the Irio object
+	 * @param n			Number of DMA group
+	 * @param timeout	Max time in milliseconds to wait for the block,
+	 * 					0 to wait indefinitely
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 * @return	The block, valid until the next block is committed
+	 */
+	const std::uint64_t *acquireFromDMA(
+		const TerminalsDMACommon &terminals, const std::uint32_t n,
+		const std::uint32_t timeout = 0,
+		const SIMDLevel level = getSIMDLevel());
+
+	/**
+	 * Fires the software trigger at the start of the next block committed.
+	 * It can be called from any thread
+	 */
+	void trigger();
+
+	/**
+	 * Fires the trigger on the edges of a DI terminal, which is read each
+	 * time a block is committed. Replaces the previous DI trigger
+	 *
+	 * @throw irio::errors::ResourceNotFoundError	DI not found
+	 * @throw irio::errors::NiFpgaError	Error reading the DI
+	 *
+	 * @param terminals	Digital terminals of the Irio object
+	 * @param n			Number of the DI terminal
+	 * @param edge		Transitions that fire the trigger
+	 */
+	void setDigitalTrigger(const TerminalsDigital &terminals,
+						   const std::uint32_t n, const TriggerEdge edge);
+
+	/**
+	 * Fires the trigger when a channel crosses a level: rising when a
+	 * sample reaches it after one below it, falling when a sample is below
+	 * it after one that reached it. Replaces the previous threshold trigger
+	 *
+	 * @throw irio::errors::DAQStageError	Channel not found or level of
+	 * 										-32768
+	 *
+	 * @param channel	Number of the channel
+	 * @param level		Level of the trigger
+	 * @param edge		Transitions that fire the trigger
+	 */
+	void setThresholdTrigger(const size_t channel, const std::int16_t level,
+							 const TriggerEdge edge);
+
+	/**
+	 * Disables the DI and threshold triggers
+	 */
+	void clearTriggers();
+
+	/**
+	 * Waits for the next completed capture
+	 *
+	 * @param[out] capture	Capture obtained
+	 * @param timeout		Max time in milliseconds to wait,
+	 * 						0 to wait indefinitely
+	 * @return	False if no capture was completed before \p timeout expired
+	 */
+	bool getCapture(Capture *capture, const std::uint32_t timeout = 0);
+
+	/**
+	 * Gets the next completed capture if there is one
+	 *
+	 * @param[out] capture	Capture obtained
+	 * @return	True if a capture was obtained
+	 */
+	bool tryGetCapture(Capture *capture);
+
+	/**
+	 * Returns the blocks of a capture to the ring
+	 *
+	 * @throw irio::errors::DAQStageError	The capture is not held by the
+	 * 										user
+	 *
+	 * @param capture	Capture obtained with \ref getCapture or
+	 * 					\ref tryGetCapture
+	 */
+	void releaseCapture(const Capture &capture);
+
+	/**
+	 * Splits the samples of a capture into a buffer per channel
+	 *
+	 * @param capture	Capture held by the user
+	 * @param out		Array of \ref getChannels buffers of
+	 * 					\ref Capture::samples elements
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 */
+	void extractSamples(const Capture &capture, std::int16_t *const *out,
+						const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Returns the number of captures completed
+	 */
+	std::uint64_t getCaptures() const;
+
+	/**
+	 * Returns the number of triggers missed because a capture was
+	 * collecting its samples or all the captures were held by the user
+	 */
+	std::uint64_t getMissedTriggers() const;
+
+	/**
+	 * Returns the number of samples of each channel committed
+	 */
+	std::uint64_t getPosition() const;
+
+	/**
+	 * Returns the number of channels of the stream
+	 */
+	size_t getChannels() const;
+
+	/**
+	 * Returns the number of DMA elements (64 bits) of each block
+	 */
+	size_t getBlockElements() const;
+
+	/**
+	 * Returns the number of samples of each channel in a block
+	 */
+	size_t getBlockSamples() const;
+
+ private:
+	enum class SlotState : std::uint8_t { Free, Collecting, Queued, Held };
+
+	/// Preallocated capture
+	struct Slot {
+		SlotState state;
+		Capture capture;
+		std::vector<const std::uint64_t*> blocks;
+	};
+
+	struct Trigger {
+		TriggerSource source;
+		std::uint64_t position;
+	};
+
+	bool checkTriggers(const std::uint64_t *block, const SIMDLevel level,
+					   Trigger *fired);
+
+	/**
+	 * Takes the blocks of the window from the history into a free slot.
+	 * Must be called with the mutex locked
+	 */
+	void startCapture(const Trigger &fired,
+					  const std::chrono::steady_clock::time_point &timestamp);
+
+	/**
+	 * Queues the capture if it holds its post-trigger samples. Must be
+	 * called with the mutex locked
+	 *
+	 * @return	True if the capture was completed
+	 */
+	bool checkCompleted();
+
+	/**
+	 * Must be called with the mutex locked
+	 */
+	void addReference(const std::uint64_t *block);
+
+	/**
+	 * Returns the block to the pool if it has no holders left. Must be
+	 * called with the mutex locked
+	 */
+	void removeReference(const std::uint64_t *block);
+
+	/**
+	 * Must be called with the mutex locked
+	 */
+	bool popCapture(Capture *capture);
+
+	const size_t m_channels;
+	const size_t m_blockElements;
+	const size_t m_blockSamples;
+	const size_t m_preSamples;
+	const size_t m_postSamples;
+	/// Blocks kept before the last one committed
+	const size_t m_historyBlocks;
+
+	imaq::FramePool m_pool;
+	/// Holders of each block of the pool: the ring and the captures
+	std::vector<unsigned> m_references;
+	/// Circular history of blocks, the last one committed included
+	std::vector<const std::uint64_t*> m_history;
+	size_t m_historyHead = 0;
+	size_t m_historyCount = 0;
+	std::uint64_t *m_writing = nullptr;
+
+	std::atomic<bool> m_softwareTrigger{false};
+	std::unique_ptr<TerminalsDigital> m_digital;
+	std::uint32_t m_digitalN = 0;
+	TriggerEdge m_digitalEdge = TriggerEdge::Rising;
+	bool m_digitalValue = false;
+	bool m_thresholdEnabled = false;
+	size_t m_thresholdChannel = 0;
+	std::int16_t m_thresholdLevel = 0;
+	TriggerEdge m_thresholdEdge = TriggerEdge::Rising;
+	/// Whether the last sample of the channel reached the level. Unknown
+	/// at the start of the stream
+	bool m_thresholdAbove = false;
+	bool m_thresholdKnown = false;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::vector<Slot> m_slots;
+	/// Capture collecting its post-trigger samples, nullptr if none
+	Slot *m_collecting = nullptr;
+	/// Slots of the completed captures, oldest first
+	std::vector<size_t> m_queue;
+
+	std::atomic<std::uint64_t> m_position{0};
+	std::atomic<std::uint64_t> m_captures{0};
+	std::atomic<std::uint64_t> m_missed{0};
+};
+
+}  // namespace daq
+}  // namespace irio
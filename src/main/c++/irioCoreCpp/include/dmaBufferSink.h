@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <NiFpga.h>
+
+namespace irio {
+
+/**
+ * Interface of the backends used to access DMA data without copying it.
+ *
+ * A sink gives access to a region of the buffer where the DMA data is
+ * stored (acquire) and returns it back to the DMA once the data has been
+ * consumed (release). Regions must be released in the same order they were
+ * acquired.
+ *
+ * The default backend is \ref irio::HostMemoryBufferSink. Other backends
+ * (e.g. one that maps the data into GPU memory) can be set using
+ * \ref irio::TerminalsDMACommon::setBufferSink.
+ *
+ * @ingroup DMATerminals
+ */
+class DMABufferSink {
+ public:
+	virtual ~DMABufferSink() = default;
+
+	/**
+	 * Acquires a region of the DMA buffer with the requested elements.
+	 *
+	 * @param session				NiFpga_Session of the FPGA
+	 * @param fifo					Number of the FIFO in the FPGA
+	 * @param elementsToAcquire		Number of elements to acquire
+	 * @param timeout				Max time in milliseconds to wait for the
+	 * 								elements to be available.
+	 * 								NiFpga_InfiniteTimeout to wait indefinitely
+	 * @param[out] data				Pointer to the first element acquired
+	 * @param[out] elementsAcquired	Number of elements acquired. It can be
+	 * 								less than \p elementsToAcquire if the
+	 * 								region wraps around the end of the buffer
+	 * @return	Status of the operation, NiFpga_Status_FifoTimeout if the
+	 * 			elements are not available before \p timeout expires
+	 */
+	virtual NiFpga_Status acquire(const NiFpga_Session &session,
+								  const std::uint32_t fifo,
+								  const size_t elementsToAcquire,
+								  const std::uint32_t timeout,
+								  std::uint64_t **data,
+								  size_t *elementsAcquired) = 0;
+
+	/**
+	 * Releases elements previously acquired,
+	 * returning them back to the DMA
+	 *
+	 * @param session			NiFpga_Session of the FPGA
+	 * @param fifo				Number of the FIFO in the FPGA
+	 * @param elementsToRelease	Number of elements to release
+	 * @return	Status of the operation
+	 */
+	virtual NiFpga_Status release(const NiFpga_Session &session,
+								  const std::uint32_t fifo,
+								  const size_t elementsToRelease) = 0;
+};
+
+/**
+ * Default \ref irio::DMABufferSink. Gives direct access
+ * to the host memory buffer where the DMA writes its data.
+ *
+ * @ingroup DMATerminals
+ */
+class HostMemoryBufferSink: public DMABufferSink {
+ public:
+	NiFpga_Status acquire(const NiFpga_Session &session,
+						  const std::uint32_t fifo,
+						  const size_t elementsToAcquire,
+						  const std::uint32_t timeout, std::uint64_t **data,
+						  size_t *elementsAcquired) override;
+
+	NiFpga_Status release(const NiFpga_Session &session,
+						  const std::uint32_t fifo,
+						  const size_t elementsToRelease) override;
+};
+
+}  // namespace irio
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+
+#include "terminals/terminalsDMACommon.h"
+
+namespace irio {
+
+namespace shared {
+struct RingHeader;
+struct SlotHeader;
+}  // namespace shared
+
+/**
+ * What the publisher does when the slot to write
+ * still holds a block not read by a consumer
+ *
+ * @ingroup SharedDMA
+ */
+enum class SlowConsumerPolicy {
+	/**
+	 * The block is overwritten. Slow consumers skip ahead to the
+	 * oldest block available and the skipped blocks are counted
+	 */
+	SkipAhead,
+	/**
+	 * The block is not published and the data is left in the DMA,
+	 * which buffers it until the slowest consumer frees the slot
+	 */
+	WaitSlowest
+};
+
+/**
+ * Publishes the blocks of a DMA in a POSIX shared memory ring
+ * (/dev/shm), so several processes can consume the same acquisition.
+ *
+ * The DMA is read only once, directly into the shared memory, and
+ * consumers (\ref irio::DMASharedReader or the irioSharedDMA C API)
+ * access the blocks in place. Each consumer keeps its own cursor, so
+ * all of them receive every block unless they fall behind by more than the
+ * number of slots. Each block has a sequence number, starting at 0,
+ * that consumers can use to detect the blocks they skipped.
+ *
+ * The shared memory object is removed when the publisher is destroyed.
+ * Consumers already attached keep access to the blocks published.
+ *
+ * Consumers write their cursors in the ring, so any process that can open it
+ * can stall or corrupt the other consumers. By default only the user and the
+ * group of the publisher can open it.
+ *
+ * @ingroup SharedDMA
+ */
+class DMASharedPublisher {
+ public:
+	/**
+	 * Creates the shared memory ring of a DMA
+	 *
+	 * @throw irio::errors::ResourceNotFoundError	DMA not found
+	 * @throw irio::errors::SharedMemoryError	Unable to create the ring,
+	 * 											invalid ring dimensions or
+	 * 											\p name already in use. The
+	 * 											ring of a publisher that is
+	 * 											no longer running is replaced
+	 *
+	 * @param terminals		DMA terminals of the Irio object
+	 * @param n				Number of DMA group
+	 * @param name			Name of the shared memory object
+	 * 						(e.g. "irioDMA0", visible in /dev/shm)
+	 * @param blockElements	Number of DMA elements (64 bits) of each block
+	 * @param numSlots		Number of blocks the ring can hold
+	 * @param maxConsumers	Max number of consumers attached at the same time
+	 * @param policy		What to do when a consumer falls behind
+	 * @param mode			Permissions of the shared memory object
+	 */
+	DMASharedPublisher(const TerminalsDMACommon &terminals,
+					   const std::uint32_t n, const std::string &name,
+					   const size_t blockElements, const size_t numSlots,
+					   const size_t maxConsumers = 8,
+					   const SlowConsumerPolicy policy =
+						   SlowConsumerPolicy::SkipAhead,
+					   const mode_t mode = 0660);
+
+	/**
+	 * Unmaps and removes the shared memory object
+	 */
+	~DMASharedPublisher();
+
+	DMASharedPublisher(const DMASharedPublisher &) = delete;
+	DMASharedPublisher &operator=(const DMASharedPublisher &) = delete;
+
+	/**
+	 * Reads a block from the DMA into the next slot of the ring and
+	 * publishes it.
+	 *
+	 * @throw irio::errors::DMAReadTimeout	The block was not available
+	 * 										before \p timeout expired
+	 * @throw irio::errors::NiFpgaError	Error occurred in an FPGA operation
+	 *
+	 * @param timeout	Max time in milliseconds to wait for the block,
+	 * 					0 to wait indefinitely
+	 * @return	True if published. False if the policy is
+	 * 			\ref SlowConsumerPolicy::WaitSlowest and a consumer has not
+	 * 			read the slot yet, in which case the DMA is not read
+	 */
+	bool publishFromDMA(const std::uint32_t timeout = 0);
+
+	/**
+	 * Publishes a block of data obtained by other means
+	 *
+	 * @throw irio::errors::SharedMemoryError	\p elements is greater than
+	 * 											the block size
+	 *
+	 * @param data		Data to publish
+	 * @param elements	Number of elements of \p data
+	 * @return	True if published, false as in \ref publishFromDMA
+	 */
+	bool publish(const std::uint64_t *data, const size_t elements);
+
+	/**
+	 * Returns the number of blocks published
+	 */
+	std::uint64_t getPublishedBlocks() const;
+
+	/**
+	 * Returns the number of blocks not published because
+	 * of the \ref SlowConsumerPolicy::WaitSlowest policy
+	 */
+	std::uint64_t getRejectedBlocks() const;
+
+	/**
+	 * Returns the number of consumers attached
+	 */
+	size_t getNumConsumers() const;
+
+	/**
+	 * Returns the name of the shared memory object
+	 */
+	const std::string &getName() const;
+
+ private:
+	/**
+	 * Returns the slot for the next block, marked as being written.
+	 * nullptr if it cannot be overwritten
+	 */
+	shared::SlotHeader *beginWrite();
+
+	void endWrite(shared::SlotHeader *slot, const size_t elements);
+
+	/**
+	 * Frees the entries of the consumers whose process does not exist
+	 */
+	void releaseDeadConsumers();
+
+	const TerminalsDMACommon m_terminals;
+	const std::uint32_t m_n;
+	const std::string m_name;
+	const SlowConsumerPolicy m_policy;
+	size_t m_size = 0;
+	shared::RingHeader *m_header = nullptr;
+};
+
+}  // namespace irio
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace irio {
+
+namespace shared {
+struct RingHeader;
+struct ConsumerEntry;
+}  // namespace shared
+
+/**
+ * Block of a shared DMA ring
+ *
+ * @ingroup SharedDMA
+ */
+struct DMASharedBlock {
+	/// Data of the block in the shared memory
+	const std::uint64_t *data;
+	/// Number of elements (64 bits) of the block
+	size_t elements;
+	/// Sequence number of the block
+	std::uint64_t sequence;
+	/// Blocks skipped since the previous block read
+	std::uint64_t skipped;
+};
+
+/**
+ * Consumer of a DMA published by \ref irio::DMASharedPublisher.
+ *
+ * Blocks are accessed in place, without copying them. Each reader has its
+ * own cursor, starting at the next block published after attaching. If the
+ * reader falls behind by more than the number of slots of the ring, it skips
+ * ahead to the oldest block available.
+ *
+ * A reader must be used by a single thread.
+ *
+ * @ingroup SharedDMA
+ */
+class DMASharedReader {
+ public:
+	/**
+	 * Attaches to the ring of a publisher
+	 *
+	 * @throw irio::errors::SharedMemoryError	The ring does not exist, it is
+	 * 											not valid or the maximum
+	 * 											number of consumers is reached
+	 *
+	 * @param name	Name of the shared memory object used by the publisher
+	 */
+	explicit DMASharedReader(const std::string &name);
+
+	/**
+	 * Detaches from the ring. Blocks acquired must not be accessed afterwards
+	 */
+	~DMASharedReader();
+
+	DMASharedReader(const DMASharedReader &) = delete;
+	DMASharedReader &operator=(const DMASharedReader &) = delete;
+
+	/**
+	 * Waits for the next block and gives access to it.
+	 *
+	 * It must be released with \ref releaseBlock
+	 * before acquiring the next one.
+	 *
+	 * @throw irio::errors::DMAReadTimeout	No block published before
+	 * 										\p timeout expired
+	 * @throw irio::errors::SharedMemoryError	A block is already acquired or
+	 * 											the publisher was destroyed
+	 *
+	 * @param[out] block	Block acquired
+	 * @param timeout		Max time in milliseconds to wait,
+	 * 						0 to wait indefinitely
+	 */
+	void acquireBlock(DMASharedBlock *block, const std::uint32_t timeout = 0);
+
+	/**
+	 * Gives access to the next block if already published
+	 *
+	 * @throw irio::errors::SharedMemoryError	A block is already acquired
+	 *
+	 * @param[out] block	Block acquired
+	 * @return	True if a block was acquired
+	 */
+	bool tryAcquireBlock(DMASharedBlock *block);
+
+	/**
+	 * Releases the block acquired and advances the cursor.
+	 *
+	 * @throw irio::errors::SharedMemoryError	No block acquired
+	 *
+	 * @return	True if the block was not overwritten while acquired. If false,
+	 * 			the data accessed may be mixed with a newer block
+	 */
+	bool releaseBlock();
+
+	/**
+	 * Copies the next block into a buffer. Blocks overwritten
+	 * while being copied are skipped.
+	 *
+	 * @throw irio::errors::DMAReadTimeout	No block published before
+	 * 										\p timeout expired
+	 * @throw irio::errors::SharedMemoryError	A block is acquired, the
+	 * 											publisher was destroyed or
+	 * 											\p maxElements is less than
+	 * 											the block size
+	 *
+	 * @param data			Buffer for the data
+	 * @param maxElements	Number of elements of \p data
+	 * @param[out] sequence	Sequence number of the block read. Can be nullptr
+	 * @param timeout		Max time in milliseconds to wait,
+	 * 						0 to wait indefinitely
+	 * @return	Number of elements read
+	 */
+	size_t readBlock(std::uint64_t *data, const size_t maxElements,
+					 std::uint64_t *sequence = nullptr,
+					 const std::uint32_t timeout = 0);
+
+	/**
+	 * Returns the number of elements of each block
+	 */
+	size_t getBlockElements() const;
+
+	/**
+	 * Returns the number of slots of the ring
+	 */
+	size_t getNumSlots() const;
+
+	/**
+	 * Returns the number of the DMA published
+	 */
+	std::uint32_t getDMANumber() const;
+
+	/**
+	 * Returns the total number of blocks skipped by this reader
+	 */
+	std::uint64_t getSkippedBlocks() const;
+
+ private:
+	/**
+	 * Advances the cursor without reading the blocks
+	 */
+	void skipBlocks(const std::uint64_t blocks);
+
+	void countSkipped(const std::uint64_t blocks);
+
+	const std::string m_name;
+	size_t m_size = 0;
+	shared::RingHeader *m_header = nullptr;
+	shared::ConsumerEntry *m_entry = nullptr;
+	std::uint64_t m_cursor = 0;
+	std::uint64_t m_skippedSinceLast = 0;
+	bool m_acquired = false;
+	std::uint64_t m_acquiredSeqlock = 0;
+};
+
+}  // namespace irio
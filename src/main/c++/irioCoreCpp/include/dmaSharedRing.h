@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace irio {
+namespace shared {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+			  "Atomics shared between processes must be lock free");
+
+/// Identifies a memory region as a DMA ring ("IRIO")
+constexpr std::uint32_t RING_MAGIC = 0x4952494F;
+constexpr std::uint32_t RING_VERSION = 2;
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * Header at the beginning of the shared memory region.
+ *
+ * The region is laid out as:
+ * RingHeader | ConsumerEntry[maxConsumers] | numSlots x (SlotHeader | data)
+ *
+ * \p magic is written last by the publisher, so a region
+ * with a valid magic is completely initialized.
+ */
+struct alignas(CACHE_LINE_SIZE) RingHeader {
+	std::atomic<std::uint32_t> magic;
+	std::uint32_t version;
+	std::uint32_t dmaNumber;
+	std::uint32_t maxConsumers;
+	std::uint64_t blockElements;
+	std::uint64_t numSlots;
+	/// Bytes between consecutive slots, multiple of the cache line size
+	std::uint64_t slotStride;
+	/// 1 if the publisher overwrites the slots not read by slow consumers
+	std::uint32_t skipAhead;
+	/// Number of blocks published, the sequence of the next block
+	alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> published;
+	/// Blocks not published because a consumer had not read the slot
+	std::atomic<std::uint64_t> rejected;
+	std::atomic<std::uint32_t> publisherAlive;
+	/// Process of the publisher, to detect rings left by a dead publisher
+	std::atomic<std::int32_t> publisherPid;
+};
+
+/// The consumer entry is free
+constexpr std::uint32_t CONSUMER_FREE = 0;
+/// The consumer entry is used, and its other fields are valid
+constexpr std::uint32_t CONSUMER_USED = 1;
+/// The consumer entry is taken by a consumer still initializing its fields
+constexpr std::uint32_t CONSUMER_CLAIMED = 2;
+
+/**
+ * Cursor of a consumer. Each consumer has its own cache line.
+ *
+ * A consumer claims a free entry, initializes the other fields and then
+ * marks it as used, so the publisher only reads complete entries.
+ */
+struct alignas(CACHE_LINE_SIZE) ConsumerEntry {
+	/// \ref CONSUMER_FREE, \ref CONSUMER_CLAIMED or \ref CONSUMER_USED
+	std::atomic<std::uint32_t> used;
+	std::atomic<std::int32_t> pid;
+	/// Sequence of the next block to read
+	std::atomic<std::uint64_t> cursor;
+	/// Blocks skipped because they were overwritten before being read
+	std::atomic<std::uint64_t> skipped;
+};
+
+/**
+ * Header of each slot.
+ *
+ * \p seqlock is 2*seq+1 while block seq is being written and 2*seq+2 once
+ * written, 0 if the slot does not hold a valid block. Readers check it
+ * before and after accessing the data to detect blocks overwritten meanwhile.
+ */
+struct alignas(CACHE_LINE_SIZE) SlotHeader {
+	std::atomic<std::uint64_t> seqlock;
+	std::uint64_t elements;
+};
+
+inline std::uint64_t writingSeqlock(const std::uint64_t seq) {
+	return 2 * seq + 1;
+}
+
+inline std::uint64_t writtenSeqlock(const std::uint64_t seq) {
+	return 2 * seq + 2;
+}
+
+inline size_t getSlotStride(const size_t blockElements) {
+	const size_t bytes = sizeof(SlotHeader) + blockElements * sizeof(std::uint64_t);
+	return (bytes + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+
+inline size_t getRingSize(const size_t blockElements, const size_t numSlots,
+						  const size_t maxConsumers) {
+	return sizeof(RingHeader) + maxConsumers * sizeof(ConsumerEntry) +
+		   numSlots * getSlotStride(blockElements);
+}
+
+inline ConsumerEntry *getConsumers(RingHeader *header) {
+	return reinterpret_cast<ConsumerEntry*>(header + 1);
+}
+
+inline SlotHeader *getSlot(RingHeader *header, const std::uint64_t seq) {
+	auto base = reinterpret_cast<std::uint8_t*>(getConsumers(header) +
+												header->maxConsumers);
+	return reinterpret_cast<SlotHeader*>(
+		base + (seq % header->numSlots) * header->slotStride);
+}
+
+inline std::uint64_t *getSlotData(SlotHeader *slot) {
+	return reinterpret_cast<std::uint64_t*>(slot + 1);
+}
+
+/**
+ * Returns the name of the POSIX shared memory object,
+ * adding the leading '/' if missing
+ */
+inline std::string getShmName(const std::string &name) {
+	return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+}  // namespace shared
+}  // namespace irio
@@ -305,5 +305,103 @@ class UnsupportedAICouplingForModule: public IrioError {
 	}
 };
 
+/**
+ * Exception when the communication with the session daemon fails
+ *
+ * @ingroup Errors
+ */
+class SessionConnectionError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when a shared memory region cannot be created,
+ * mapped or has an invalid layout
+ *
+ * @ingroup Errors
+ */
+class SharedMemoryError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when a frame pool cannot be allocated
+ * or a frame does not belong to it
+ *
+ * @ingroup Errors
+ */
+class FramePoolError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when the pixels of a frame have a format not supported
+ *
+ * @ingroup Errors
+ */
+class UnsupportedPixelFormatError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when a region of interest or its binning
+ * does not fit the image
+ *
+ * @ingroup Errors
+ */
+class ROIError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when an image processing stage is configured
+ * with invalid parameters
+ *
+ * @ingroup Errors
+ */
+class ImageStageError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when compressed data is corrupted or was
+ * not produced with the same codec configuration
+ *
+ * @ingroup Errors
+ */
+class CodecError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when the host buffer of a DMA does not hold
+ * a whole number of frames, so a frame could wrap around its end
+ *
+ * @ingroup Errors
+ */
+class FrameAlignmentError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when a DAQ processing stage is configured with invalid
+ * parameters or used with invalid arguments
+ *
+ * @ingroup Errors
+ */
+class DAQStageError: public IrioError {
+	using IrioError::IrioError;
+};
+
+/**
+ * Exception when the files of a recording cannot be created, written or
+ * read, or have an invalid layout
+ *
+ * @ingroup Errors
+ */
+class RecordingError: public IrioError {
+	using IrioError::IrioError;
+};
+
 }  // namespace errors
 }  // namespace irio
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "imaq/pixelUnpack.h"
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Applies dark-frame subtraction and flat-field gain correction to IMAQ
+ * frames, working directly on the DMA words of the frame.
+ *
+ * Each pixel is corrected as `(raw - dark) * gain`, rounded to the nearest
+ * integer and clamped between 0 and the maximum value of the pixel format.
+ * The gain of each pixel is computed once from the reference frames as
+ * `mean(flat - dark) / (flat - dark)`, so a uniformly illuminated scene
+ * results in a uniform image. Pixels whose flat value is not above the
+ * dark value (dead pixels) keep a gain of 1.
+ *
+ * Each row is unpacked with \ref irio::imaq::unpackPixels into the output
+ * image and corrected in place while it is in cache, with SSSE3 or AVX2
+ * kernels. The rows can be processed by several threads of the shared
+ * \ref irio::WorkerPool.
+ *
+ * The reference frames are usually the average of several frames acquired
+ * with the shutter closed (dark) and with a uniform illumination (flat).
+ *
+ * @ingroup IMAQ
+ */
+class FlatFieldStage {
+ public:
+	/**
+	 * Configures the stage with its reference frames
+	 *
+	 * @throw irio::errors::ImageStageError	Empty image, the size of the
+	 * 										reference frames does not match
+	 * 										the image or the flat frame has
+	 * 										no pixel above the dark frame
+	 *
+	 * @param width		Number of columns of the frame
+	 * @param height	Number of rows of the frame
+	 * @param format	Pixel format of the frame
+	 * @param dark		Unpacked dark frame, width x height pixels.
+	 * 					Empty to not subtract any offset
+	 * @param flat		Unpacked flat frame, width x height pixels.
+	 * 					Empty to only subtract the dark frame
+	 * @param threads	Max number of threads processing the rows
+	 */
+	FlatFieldStage(const size_t width, const size_t height,
+				   const PixelFormat format,
+				   const std::vector<std::uint16_t> &dark,
+				   const std::vector<std::uint16_t> &flat =
+					   std::vector<std::uint16_t>(),
+				   const unsigned threads = 1);
+
+	/**
+	 * Unpacks and corrects a frame
+	 *
+	 * @param words		DMA words of the frame. It must contain at least
+	 * 					\ref getFrameWords elements
+	 * @param image		Buffer of width x height elements for the corrected
+	 * 					image
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 */
+	void process(const std::uint64_t *words, std::uint16_t *image,
+				 const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Returns the gain applied to each pixel, row after row
+	 */
+	const std::vector<float> &getGain() const;
+
+	/**
+	 * Returns the number of DMA words (64 bits) of each frame
+	 */
+	size_t getFrameWords() const;
+
+	/**
+	 * Returns the pixel format of the frames
+	 */
+	PixelFormat getFormat() const;
+
+ private:
+	void processRows(const std::uint64_t *words, std::uint16_t *image,
+					 const SIMDLevel level, const size_t firstRow,
+					 const size_t lastRow) const;
+
+	const size_t m_width;
+	const size_t m_height;
+	const PixelFormat m_format;
+	const float m_maxValue;
+	const unsigned m_threads;
+	const std::vector<std::uint16_t> m_dark;
+	const std::vector<float> m_gain;
+};
+
+}  // namespace imaq
+}  // namespace irio
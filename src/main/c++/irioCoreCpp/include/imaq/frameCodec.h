@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "imaq/pixelUnpack.h"
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Lossless compression of IMAQ frames for recording, based on the
+ * LOCO-I (JPEG-LS) scheme.
+ *
+ * Each pixel is predicted from its left, upper and upper-left neighbours
+ * with the median edge detector. The residual is wrapped to the bit depth
+ * of the pixels, mapped to an unsigned value and written with a Rice code
+ * whose parameter is adapted per context, selected by the local gradient,
+ * so smooth and textured areas of the image are coded independently.
+ * Residuals too large for the Rice code are escaped and written verbatim,
+ * which bounds the size of incompressible frames.
+ *
+ * The frame is split in bands of rows compressed independently, one per
+ * thread, so frames can be compressed and decompressed in parallel. The
+ * number of bands is stored in the compressed data, which can be
+ * decompressed with any number of threads. Frames can be compressed from
+ * their DMA words, unpacking the rows as they are coded, or from unpacked
+ * images.
+ *
+ * The compressed data starts with a header of 20 bytes plus 4 bytes per
+ * band, in the byte order of the host:
+ * - Magic number "IRFC"
+ * - Format version (1 byte) and bit depth of the pixels (1 byte)
+ * - Number of bands (2 bytes)
+ * - Width, height and rows of each band (4 bytes each)
+ * - Size in bytes of each band (4 bytes each), followed by the bands
+ *
+ * @ingroup IMAQ
+ */
+class FrameCodec {
+ public:
+	/**
+	 * Configures the codec
+	 *
+	 * @throw irio::errors::ImageStageError	Empty image or more than 65535
+	 * 										threads
+	 *
+	 * @param width		Number of columns of the frame
+	 * @param height	Number of rows of the frame
+	 * @param format	Pixel format of the frame, defines the bit depth
+	 * @param threads	Max number of threads of the shared
+	 * 					\ref irio::WorkerPool. Frames are compressed in as
+	 * 					many bands (up to the number of rows)
+	 */
+	FrameCodec(const size_t width, const size_t height,
+			   const PixelFormat format, const unsigned threads = 1);
+
+	/**
+	 * Compresses an unpacked image
+	 *
+	 * @param image		Image of width x height pixels, row after row. Bits
+	 * 					above the bit depth of the format are ignored
+	 * @param out		Buffer of \ref getMaxCompressedSize bytes
+	 * @return	Number of bytes of the compressed frame
+	 */
+	size_t compress(const std::uint16_t *image, std::uint8_t *out) const;
+
+	/**
+	 * Compresses a frame from its DMA words, unpacking the rows with
+	 * \ref irio::imaq::unpackPixels as they are compressed
+	 *
+	 * @param words		DMA words of the frame. It must contain at least
+	 * 					\ref getFrameWords elements
+	 * @param out		Buffer of \ref getMaxCompressedSize bytes
+	 * @param level		Instruction set used to unpack the rows
+	 * @return	Number of bytes of the compressed frame
+	 */
+	size_t compressFrame(const std::uint64_t *words, std::uint8_t *out,
+						 const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Decompresses a frame
+	 *
+	 * @throw irio::errors::CodecError	The data is truncated or corrupted, or
+	 * 									it is a frame of other dimensions or
+	 * 									bit depth
+	 *
+	 * @param data		Compressed frame
+	 * @param size		Number of bytes of \p data
+	 * @param image		Buffer of width x height elements for the image
+	 */
+	void decompress(const std::uint8_t *data, const size_t size,
+					std::uint16_t *image) const;
+
+	/**
+	 * Returns the size of the output buffer required to compress a frame,
+	 * which is the worst case for incompressible frames
+	 */
+	size_t getMaxCompressedSize() const;
+
+	/**
+	 * Returns the number of DMA words (64 bits) of each frame
+	 */
+	size_t getFrameWords() const;
+
+	/**
+	 * Returns the pixel format of the frames
+	 */
+	PixelFormat getFormat() const;
+
+ private:
+	size_t compressBands(const std::uint16_t *image,
+						 const std::uint64_t *words, const SIMDLevel level,
+						 std::uint8_t *out) const;
+
+	size_t encodeBand(const std::uint16_t *image, const std::uint64_t *words,
+					  const SIMDLevel level, const size_t band,
+					  std::uint8_t *out) const;
+
+	void decodeBand(const std::uint8_t *data, const size_t size,
+					const size_t firstRow, const size_t lastRow,
+					std::uint16_t *image) const;
+
+	const size_t m_width;
+	const size_t m_height;
+	const PixelFormat m_format;
+	const unsigned m_depth;
+	const size_t m_bandRows;
+	const size_t m_bands;
+	const unsigned m_threads;
+};
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "imaq/framePool.h"
+#include "imaq/frameStats.h"
+#include "terminals/terminalsDMAIMAQ.h"
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Frame acquired by a \ref irio::imaq::FrameGrabber
+ *
+ * @ingroup IMAQ
+ */
+struct Frame {
+	/// Image data. It belongs to the pool of the frame grabber
+	std::uint64_t *data;
+	/// Number of DMA elements (64 bits) of the image
+	size_t elements;
+	/// Number of the frame, starting at 0. Gaps correspond to dropped frames
+	std::uint64_t frameNumber;
+	/// Host time when the frame was read from the DMA
+	std::chrono::steady_clock::time_point timestamp;
+	/// Total number of frames dropped when this frame was read
+	std::uint64_t droppedFrames;
+	/// Statistics of the image, valid until the frame is released.
+	/// nullptr if the frame grabber has no statistics stage
+	const FrameStats *stats;
+};
+
+/**
+ * Acquires the images of an IMAQ DMA in a background thread.
+ *
+ * The images are read into the frames of a preallocated
+ * \ref irio::imaq::FramePool and queued until the user gets them. The DMA is
+ * drained continuously regardless of how fast the user processes the frames:
+ * if the queue is full or all the frames are in use, the oldest frame waiting
+ * in the queue is dropped, or the image is discarded if no frame is waiting.
+ * Dropped frames are counted and leave a gap in the frame numbers.
+ *
+ * Frames obtained with \ref getFrame must be returned with \ref releaseFrame.
+ * The number of frames of the pool should be greater than the frames held by
+ * the user at the same time plus the queue depth to avoid dropping frames.
+ *
+ * @ingroup IMAQ
+ */
+class FrameGrabber {
+ public:
+	/**
+	 * Allocates the frames and starts acquiring images
+	 *
+	 * The DMA must be started before the images can be acquired.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError	DMA not found
+	 * @throw irio::errors::FramePoolError	Unable to allocate the frames
+	 * @throw irio::errors::ImageStageError	The frames of \p stats are
+	 * 										larger than the images
+	 *
+	 * @param terminals			IMAQ terminals of the Irio object
+	 * @param n					Number of DMA group
+	 * @param imagePixelSize	Number of pixels of each image
+	 * @param numFrames			Number of frames of the pool
+	 * @param queueDepth		Max number of frames waiting to be read by the
+	 * 							user. 0 to allow all the frames of the pool
+	 * @param hugePages			Whether to try to use huge pages for the frames
+	 * @param stats				Stage computing the statistics of each image
+	 * 							in the acquisition thread, before the frame
+	 * 							is queued. nullptr to not compute them
+	 */
+	FrameGrabber(const TerminalsDMAIMAQ &terminals, const std::uint32_t n,
+				 const size_t imagePixelSize, const size_t numFrames,
+				 const size_t queueDepth = 0, const bool hugePages = false,
+				 std::shared_ptr<const FrameStatsStage> stats = nullptr);
+
+	/**
+	 * Stops the acquisition. Frames must not be accessed afterwards
+	 */
+	~FrameGrabber();
+
+	FrameGrabber(const FrameGrabber &) = delete;
+	FrameGrabber &operator=(const FrameGrabber &) = delete;
+
+	/**
+	 * Waits for the next frame in the queue
+	 *
+	 * @throw irio::errors::DMAReadTimeout	No frame acquired before
+	 * 										\p timeout expired
+	 * @throw irio::errors::IrioError	Error that stopped the acquisition
+	 *
+	 * @param[out] frame	Frame obtained
+	 * @param timeout		Max time in milliseconds to wait,
+	 * 						0 to wait indefinitely
+	 */
+	void getFrame(Frame *frame, const std::uint32_t timeout = 0);
+
+	/**
+	 * Gets the next frame if there is one in the queue
+	 *
+	 * @throw irio::errors::IrioError	Error that stopped the acquisition
+	 *
+	 * @param[out] frame	Frame obtained
+	 * @return	True if a frame was obtained
+	 */
+	bool tryGetFrame(Frame *frame);
+
+	/**
+	 * Returns a frame to the pool
+	 *
+	 * @throw irio::errors::FramePoolError	The frame does not belong to the
+	 * 										pool or it was already released
+	 *
+	 * @param frame	Frame obtained with \ref getFrame or \ref tryGetFrame
+	 */
+	void releaseFrame(const Frame &frame);
+
+	/**
+	 * Returns the number of images read from the DMA
+	 */
+	std::uint64_t getFramesAcquired() const;
+
+	/**
+	 * Returns the number of frames dropped
+	 */
+	std::uint64_t getDroppedFrames() const;
+
+	/**
+	 * Returns the number of frames waiting in the queue
+	 */
+	size_t getQueuedFrames() const;
+
+	/**
+	 * Returns the number of DMA elements (64 bits) of each frame
+	 */
+	size_t getFrameElements() const;
+
+	/**
+	 * Returns the pool with the frames
+	 */
+	const FramePool &getPool() const;
+
+ private:
+	void run();
+
+	/**
+	 * Takes a frame from the pool or, if there are none,
+	 * the oldest frame of the queue. nullptr if there are none
+	 */
+	std::uint64_t *takeFrame();
+
+	void enqueue(const Frame &frame);
+
+	bool popFrame(Frame *frame);
+
+	const TerminalsDMAIMAQ m_terminals;
+	const std::uint32_t m_n;
+	const size_t m_frameElements;
+	FramePool m_pool;
+	const size_t m_queueDepth;
+
+	/// Destination of the images read when there are no frames available
+	std::vector<std::uint64_t> m_discard;
+
+	const std::shared_ptr<const FrameStatsStage> m_statsStage;
+	/// Statistics of each frame of the pool
+	std::vector<FrameStats> m_frameStats;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cv;
+	/// Circular queue of frames waiting to be read
+	std::vector<Frame> m_queue;
+	size_t m_queueHead = 0;
+	size_t m_queueCount = 0;
+	std::exception_ptr m_error;
+
+	std::atomic<std::uint64_t> m_acquired{0};
+	std::atomic<std::uint64_t> m_dropped{0};
+	std::atomic<bool> m_stop{false};
+	std::thread m_thread;
+};
+
+}  // namespace imaq
+}  // namespace irio
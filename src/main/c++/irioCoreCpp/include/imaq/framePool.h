@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Fixed set of preallocated frame buffers.
+ *
+ * All the frames are allocated in a single region when the pool is created,
+ * with each frame aligned to a cache line. The region is prefaulted, so using
+ * a frame never triggers an allocation or a page fault. Optionally, the region
+ * is backed by huge pages to reduce TLB misses with large frames. If huge
+ * pages are not available, normal pages are used.
+ *
+ * Frames can be acquired and released from different threads.
+ *
+ * @ingroup IMAQ
+ */
+class FramePool {
+ public:
+	/**
+	 * Allocates the frames of the pool
+	 *
+	 * @throw irio::errors::FramePoolError	Invalid dimensions or
+	 * 										unable to allocate the memory
+	 *
+	 * @param frameElements	Number of DMA elements (64 bits) of each frame
+	 * @param numFrames		Number of frames of the pool
+	 * @param hugePages		Whether to try to use huge pages
+	 */
+	FramePool(const size_t frameElements, const size_t numFrames,
+			  const bool hugePages = false);
+
+	/**
+	 * Frees the memory of the pool. Frames must not be accessed afterwards
+	 */
+	~FramePool();
+
+	FramePool(const FramePool &) = delete;
+	FramePool &operator=(const FramePool &) = delete;
+
+	/**
+	 * Takes a free frame from the pool
+	 *
+	 * @return	Frame acquired. nullptr if all the frames are in use
+	 */
+	std::uint64_t *acquire();
+
+	/**
+	 * Returns a frame to the pool
+	 *
+	 * @throw irio::errors::FramePoolError	\p frame does not belong to the
+	 * 										pool or it is already free
+	 *
+	 * @param frame	Frame previously acquired
+	 */
+	void release(std::uint64_t *frame);
+
+	/**
+	 * Returns the number of DMA elements of each frame
+	 */
+	size_t getFrameElements() const;
+
+	/**
+	 * Returns the total number of frames of the pool
+	 */
+	size_t getNumFrames() const;
+
+	/**
+	 * Returns the number of frames not acquired
+	 */
+	size_t getFreeFrames() const;
+
+	/**
+	 * Returns whether the frames are backed by huge pages
+	 */
+	bool usesHugePages() const;
+
+	/**
+	 * Returns the position of a frame in the pool, to keep data
+	 * associated to each frame
+	 *
+	 * @throw irio::errors::FramePoolError	\p frame does not belong to the
+	 * 										pool
+	 *
+	 * @param frame	Frame of the pool
+	 * @return	Index of the frame, lower than \ref getNumFrames
+	 */
+	size_t getFrameIndex(const std::uint64_t *frame) const;
+
+ private:
+
+	const size_t m_frameElements;
+	const size_t m_numFrames;
+	size_t m_stride = 0;
+	size_t m_size = 0;
+	bool m_hugePages = false;
+	std::uint8_t *m_memory = nullptr;
+
+	mutable std::mutex m_mutex;
+	std::vector<std::uint64_t*> m_free;
+	std::vector<bool> m_isFree;
+};
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "imaq/pixelUnpack.h"
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Intensity statistics of a frame
+ *
+ * @ingroup IMAQ
+ */
+struct FrameStats {
+	/// Number of pixels in each intensity bin, from dark to bright
+	std::vector<std::uint32_t> histogram;
+	/// Lowest pixel value
+	std::uint16_t min = 0;
+	/// Highest pixel value
+	std::uint16_t max = 0;
+	/// Mean pixel value
+	double mean = 0;
+	/// Intensity weighted mean column. 0 if the frame is black
+	double centroidX = 0;
+	/// Intensity weighted mean row. 0 if the frame is black
+	double centroidY = 0;
+	/// Number of pixels at or above the saturation level
+	std::uint64_t saturatedPixels = 0;
+};
+
+/**
+ * Computes the histogram, min/max, mean, centroid and saturation count of
+ * IMAQ frames in the same pass that unpacks them.
+ *
+ * The frame is unpacked row by row with \ref irio::imaq::unpackPixels and
+ * the statistics are computed while the row is in cache, so no additional
+ * pass over the frame is needed. Each block of rows, processed by a thread
+ * of the shared \ref irio::WorkerPool, counts into its own histograms,
+ * interleaved to avoid dependencies between consecutive pixels falling in
+ * the same bin, which are merged at the end.
+ *
+ * The stage is configured once and can be applied to any number of frames.
+ * It can also be attached to a \ref irio::imaq::FrameGrabber to get the
+ * statistics of each frame acquired.
+ *
+ * @ingroup IMAQ
+ */
+class FrameStatsStage {
+ public:
+	/**
+	 * Configures the stage
+	 *
+	 * @throw irio::errors::ImageStageError	Empty image, or number of bins
+	 * 										not a power of 2 or greater than
+	 * 										the pixel values
+	 *
+	 * @param width				Number of columns of the frame
+	 * @param height			Number of rows of the frame
+	 * @param format			Pixel format of the frame
+	 * @param histogramBins		Number of bins of the histogram.
+	 * 							0 for one bin per pixel value
+	 * @param saturationLevel	Pixel value considered saturated.
+	 * 							0 for the max value of the format
+	 * @param threads			Max number of threads processing the rows
+	 */
+	FrameStatsStage(const size_t width, const size_t height,
+					const PixelFormat format, const size_t histogramBins = 256,
+					const std::uint16_t saturationLevel = 0,
+					const unsigned threads = 1);
+
+	/**
+	 * Computes the statistics of a frame and optionally unpacks it
+	 *
+	 * @param words		DMA words of the frame. It must contain at least
+	 * 					\ref getFrameWords elements
+	 * @param[out] stats	Statistics of the frame. Its histogram is only
+	 * 						allocated the first time
+	 * @param image		Buffer of width x height elements for the unpacked
+	 * 					image, nullptr to only compute the statistics
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 */
+	void process(const std::uint64_t *words, FrameStats *stats,
+				 std::uint16_t *image = nullptr,
+				 const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Returns the number of bins of the histogram
+	 */
+	size_t getHistogramBins() const;
+
+	/**
+	 * Returns the pixel value considered saturated
+	 */
+	std::uint16_t getSaturationLevel() const;
+
+	/**
+	 * Returns the number of DMA words (64 bits) of each frame
+	 */
+	size_t getFrameWords() const;
+
+ private:
+	struct Partial;
+
+	void processRows(const std::uint64_t *words, std::uint16_t *image,
+					 const SIMDLevel level, const size_t firstRow,
+					 const size_t lastRow, Partial *partial) const;
+
+	const size_t m_width;
+	const size_t m_height;
+	const PixelFormat m_format;
+	const size_t m_bins;
+	const unsigned m_binShift;
+	const std::uint16_t m_saturation;
+	const unsigned m_threads;
+};
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "terminals/terminalsDMAIMAQ.h"
+
+namespace irio {
+namespace imaq {
+
+/// Default marker of the start of frame word (high 32 bits)
+constexpr std::uint32_t DEFAULT_SOF_MARKER = 0x534F4649;  // "SOFI"
+/// Default marker of the end of frame word (high 32 bits)
+constexpr std::uint32_t DEFAULT_EOF_MARKER = 0x454F4649;  // "EOFI"
+
+/**
+ * Reads whole frames from an IMAQ DMA whose firmware delimits each frame.
+ *
+ * The firmware must write a start of frame word before the image (on the
+ * rising edge of FVAL) and an end of frame word after it (on the falling
+ * edge). The high 32 bits of these words are the markers and the low 32 bits
+ * are a frame counter, incremented by the firmware for every frame, or 0 if
+ * the firmware does not count frames:
+ *
+ * | SOF marker : counter | image (imagePixelSize pixels) | EOF marker : counter |
+ *
+ * A frame is valid when both markers are found where expected and their
+ * counters match. Otherwise the frame is torn (e.g. the read started in the
+ * middle of a frame or the DMA FIFO overflowed) and the reader
+ * resynchronizes without stopping the DMA: it looks for the next start of
+ * frame in the data already read and, if there is none, keeps reading until
+ * it finds one. Gaps in the frame counter are counted as dropped frames.
+ *
+ * @ingroup IMAQ
+ */
+class FrameSynchronizer {
+ public:
+	/**
+	 * Prepares the reader of delimited frames
+	 *
+	 * The DMA must be started before the frames can be read. The first frame
+	 * read is synchronized even if the DMA was not cleaned.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError	DMA not found
+	 *
+	 * @param terminals			IMAQ terminals of the Irio object
+	 * @param n					Number of DMA group
+	 * @param imagePixelSize	Number of pixels of each image, without the
+	 * 							start and end of frame words
+	 * @param hasCounter		Whether the firmware writes a frame counter in
+	 * 							the markers. Required to detect dropped frames
+	 * @param sofMarker			High 32 bits of the start of frame word
+	 * @param eofMarker			High 32 bits of the end of frame word
+	 */
+	FrameSynchronizer(const TerminalsDMAIMAQ &terminals, const std::uint32_t n,
+					  const size_t imagePixelSize, const bool hasCounter = true,
+					  const std::uint32_t sofMarker = DEFAULT_SOF_MARKER,
+					  const std::uint32_t eofMarker = DEFAULT_EOF_MARKER);
+
+	/**
+	 * Reads the next valid frame from the DMA
+	 *
+	 * Torn frames are skipped. The data read before an exception is kept,
+	 * so the call can be repeated.
+	 *
+	 * @throw irio::errors::DMAReadTimeout	Data was not available before
+	 * 										\p timeout expired
+	 * @throw irio::errors::NiFpgaError	Error occurred in an FPGA operation
+	 *
+	 * @param image		Buffer of \ref getImageElements elements to write the
+	 * 					image, without markers
+	 * @param timeout	Max time in milliseconds to wait for each DMA read,
+	 * 					0 to wait indefinitely
+	 * @return	Number of the frame, from the firmware counter extended to 64
+	 * 			bits. If the firmware does not count frames, the number of
+	 * 			valid frames read before this one
+	 */
+	std::uint64_t readFrame(std::uint64_t *image,
+							const std::uint32_t timeout = 0);
+
+	/**
+	 * Returns the number of DMA elements (64 bits) of each image
+	 */
+	size_t getImageElements() const;
+
+	/**
+	 * Returns the number of valid frames read
+	 */
+	std::uint64_t getFramesRead() const;
+
+	/**
+	 * Returns the number of frames missing from the firmware counter,
+	 * torn frames included. Always 0 without frame counter
+	 */
+	std::uint64_t getDroppedFrames() const;
+
+	/**
+	 * Returns the number of frames discarded because their markers were
+	 * not found where expected
+	 */
+	std::uint64_t getTornFrames() const;
+
+	/**
+	 * Returns the number of DMA elements discarded to resynchronize
+	 */
+	std::uint64_t getDiscardedElements() const;
+
+ private:
+	bool isSOF(const std::uint64_t word) const;
+
+	bool isEOF(const std::uint64_t word) const;
+
+	void findSOF(const std::uint32_t timeout);
+
+	void resyncAfterTorn(const std::uint64_t *image, const std::uint64_t eof);
+
+	const TerminalsDMAIMAQ m_terminals;
+	const std::uint32_t m_n;
+	const size_t m_imageElements;
+	const bool m_hasCounter;
+	const std::uint32_t m_sofMarker;
+	const std::uint32_t m_eofMarker;
+
+	/// Start of frame word of the frame being read, if already found
+	bool m_haveSOF = false;
+	std::uint64_t m_sof = 0;
+	/// Image elements of the frame being read that were read in advance
+	std::vector<std::uint64_t> m_pending;
+	/// Buffer to look for a start of frame
+	std::vector<std::uint64_t> m_search;
+
+	bool m_firstFrame = true;
+	std::uint32_t m_lastCounter = 0;
+	std::uint64_t m_frameNumber = 0;
+	std::uint64_t m_framesRead = 0;
+	std::uint64_t m_dropped = 0;
+	std::uint64_t m_torn = 0;
+	std::uint64_t m_discarded = 0;
+};
+
+}  // namespace imaq
+}  // namespace irio
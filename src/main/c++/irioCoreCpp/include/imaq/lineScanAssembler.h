@@ -0,0 +1,181 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "imaq/framePool.h"
+#include "terminals/terminalsDMAIMAQ.h"
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Frame assembled from the lines of a line-scan camera
+ *
+ * @ingroup IMAQ
+ */
+struct LineFrame {
+	/// Lines of the frame, one after the other. It belongs to the pool
+	std::uint64_t *data;
+	/// Number of lines of the frame
+	size_t lines;
+	/// Number of DMA elements (64 bits) of each line
+	size_t lineElements;
+	/// Number of the frame, starting at 0
+	std::uint64_t frameNumber;
+	/// Number of the first line of the frame since the assembler was created
+	std::uint64_t firstLine;
+	/// Host time when each line was read from the DMA
+	const std::chrono::steady_clock::time_point *lineTimestamps;
+	/// Max time between two consecutive lines of the frame
+	std::chrono::nanoseconds maxLineInterval;
+	/// Total number of frames dropped when this frame was completed
+	std::uint64_t droppedFrames;
+};
+
+/**
+ * Assembles the lines acquired from a line-scan camera into frames.
+ *
+ * Each frame has a fixed number of lines. A new frame starts every
+ * \p lineStep lines: if it is equal to the number of lines of the frame,
+ * frames do not overlap; if it is lower, consecutive frames share lines
+ * (a step of 1 gives a rolling window advancing one line per frame).
+ *
+ * Each line is read from the DMA directly into the newest frame that
+ * contains it, so non-overlapping frames are assembled without any copy.
+ * With overlapping frames, the line is also copied to the older frames that
+ * contain it. Frames come from a preallocated \ref irio::imaq::FramePool;
+ * if there are no free frames when one must start, its lines are read
+ * anyway to keep draining the DMA, and the frame is dropped.
+ *
+ * The host time of each line is kept to detect stalls in the acquisition.
+ *
+ * @ingroup IMAQ
+ */
+class LineScanAssembler {
+ public:
+	/**
+	 * Allocates the frames of the assembler
+	 *
+	 * The CameraLink interface must be configured in line-scan mode
+	 * (\ref irio::TerminalsDMAIMAQ::configCameraLink) and the DMA started.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError	DMA not found
+	 * @throw irio::errors::ImageStageError	Invalid dimensions
+	 * @throw irio::errors::FramePoolError	Unable to allocate the frames
+	 *
+	 * @param terminals		IMAQ terminals of the Irio object
+	 * @param n				Number of DMA group
+	 * @param linePixels	Number of pixels of each line. The line must fill
+	 * 						a whole number of DMA elements
+	 * @param frameLines	Number of lines of each frame
+	 * @param lineStep		Lines between the start of consecutive frames.
+	 * 						0 for frames without overlap (\p frameLines)
+	 * @param numFrames		Number of frames of the pool. It should be greater
+	 * 						than the frames held by the user plus the frames
+	 * 						being assembled at the same time
+	 * 						(\p frameLines / \p lineStep)
+	 * @param hugePages		Whether to try to use huge pages for the frames
+	 */
+	LineScanAssembler(const TerminalsDMAIMAQ &terminals, const std::uint32_t n,
+					  const size_t linePixels, const size_t frameLines,
+					  const size_t lineStep = 0, const size_t numFrames = 4,
+					  const bool hugePages = false);
+
+	LineScanAssembler(const LineScanAssembler &) = delete;
+	LineScanAssembler &operator=(const LineScanAssembler &) = delete;
+
+	/**
+	 * Reads lines from the DMA until the next frame is complete
+	 *
+	 * Lines already read are kept if an exception is thrown, so the call
+	 * can be repeated.
+	 *
+	 * @throw irio::errors::DMAReadTimeout	A line was not available before
+	 * 										\p timeout expired
+	 * @throw irio::errors::NiFpgaError	Error occurred in an FPGA operation
+	 * @throw irio::errors::FramePoolError	The next frame was dropped because
+	 * 										there were no free frames when it
+	 * 										started. Its lines were read
+	 *
+	 * @param[out] frame	Frame assembled
+	 * @param timeout		Max time in milliseconds to wait for each line,
+	 * 						0 to wait indefinitely
+	 */
+	void assembleFrame(LineFrame *frame, const std::uint32_t timeout = 0);
+
+	/**
+	 * Returns a frame to the pool
+	 *
+	 * @throw irio::errors::FramePoolError	The frame does not belong to the
+	 * 										pool or it was already released
+	 *
+	 * @param frame	Frame obtained with \ref assembleFrame
+	 */
+	void releaseFrame(const LineFrame &frame);
+
+	/**
+	 * Returns the number of lines read from the DMA
+	 */
+	std::uint64_t getLinesRead() const;
+
+	/**
+	 * Returns the number of frames dropped because the pool was empty
+	 */
+	std::uint64_t getDroppedFrames() const;
+
+	/**
+	 * Returns the max time between two consecutive lines since the
+	 * assembler was created
+	 */
+	std::chrono::nanoseconds getMaxLineInterval() const;
+
+	/**
+	 * Returns the number of DMA elements (64 bits) of each line
+	 */
+	size_t getLineElements() const;
+
+	/**
+	 * Returns the pool with the frames
+	 */
+	const FramePool &getPool() const;
+
+ private:
+	struct OpenFrame {
+		std::uint64_t *data;
+		std::uint64_t firstLine;
+		size_t linesFilled;
+		std::chrono::nanoseconds maxLineInterval;
+	};
+
+	void readLine(const std::uint32_t timeout);
+
+	OpenFrame &getOpenFrame(const size_t i);
+
+	std::chrono::steady_clock::time_point *getTimestamps(std::uint64_t *data);
+
+	const TerminalsDMAIMAQ m_terminals;
+	const std::uint32_t m_n;
+	const size_t m_lineElements;
+	const size_t m_frameLines;
+	const size_t m_lineStep;
+	FramePool m_pool;
+
+	/// Destination of the lines of dropped frames
+	std::vector<std::uint64_t> m_discard;
+
+	/// Frames being assembled, from oldest to newest (circular)
+	std::vector<OpenFrame> m_open;
+	size_t m_openHead = 0;
+	size_t m_openCount = 0;
+
+	std::uint64_t m_linesRead = 0;
+	std::uint64_t m_nextFrameLine = 0;
+	std::uint64_t m_dropped = 0;
+	std::chrono::steady_clock::time_point m_lastLineTime;
+	std::chrono::nanoseconds m_maxLineInterval{0};
+};
+
+}  // namespace imaq
+}  // namespace irio
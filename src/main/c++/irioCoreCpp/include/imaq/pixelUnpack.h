@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Layout of the pixels in the 64 bits DMA words of an IMAQ frame.
+ *
+ * Pixels are stored from the least significant bits of each word.
+ *
+ * @ingroup IMAQ
+ */
+enum class PixelFormat : std::uint8_t {
+	Mono8,		/**< 8 bits pixels, 8 pixels per word */
+	Mono10,		/**< 10 bits pixels in 16 bits containers */
+	Mono12,		/**< 12 bits pixels in 16 bits containers */
+	Mono16,		/**< 16 bits pixels, 4 pixels per word */
+	Mono10p,	/**< 10 bits pixels packed without padding */
+	Mono12p		/**< 12 bits pixels packed without padding */
+};
+
+/**
+ * Instruction sets available for the unpacking kernels
+ *
+ * @ingroup IMAQ
+ */
+enum class SIMDLevel : std::uint8_t {
+	Scalar,	/**< Portable implementation */
+	SSSE3,	/**< 128 bits vectors */
+	AVX2	/**< 256 bits vectors */
+};
+
+/**
+ * Returns the pixel format of the frames of a DMA
+ *
+ * The CameraLink mode and signal mapping only determine the number of taps
+ * of the camera, so the format is given by the sample size of the DMA and
+ * the bit depth configured in the camera.
+ *
+ * @throw irio::errors::UnsupportedPixelFormatError	No format with the
+ * 													\p sampleSize and
+ * 													\p bitDepth given
+ *
+ * @param sampleSize	Sample size in bytes of the DMA
+ * 						(\ref irio::TerminalsDMACommon::getSampleSize)
+ * @param bitDepth		Bits of each pixel. 0 to use all the bits of the sample
+ * @return	Pixel format of the frames
+ */
+PixelFormat getPixelFormat(const std::uint8_t sampleSize,
+						   const std::uint8_t bitDepth = 0);
+
+/**
+ * Returns the number of bits used by each pixel in the DMA
+ *
+ * @param format	Pixel format
+ * @return	Bits used by each pixel
+ */
+std::uint8_t getPixelBits(const PixelFormat format);
+
+/**
+ * Returns the number of significant bits of each pixel
+ *
+ * @param format	Pixel format
+ * @return	Bits of the value of each pixel
+ */
+std::uint8_t getPixelDepth(const PixelFormat format);
+
+/**
+ * Returns the number of DMA words (64 bits) of a frame
+ *
+ * @param format	Pixel format
+ * @param pixels	Number of pixels of the frame
+ * @return	Number of DMA words of the frame
+ */
+size_t getFrameWords(const PixelFormat format, const size_t pixels);
+
+/**
+ * Returns the best instruction set supported by the CPU.
+ * It is detected only once.
+ */
+SIMDLevel getSIMDLevel();
+
+/**
+ * Unpacks a frame into a contiguous 16 bits image
+ *
+ * The kernel for the best instruction set supported is used.
+ *
+ * @param words		DMA words of the frame. It must contain at least
+ * 					\ref getFrameWords elements
+ * @param pixels	Number of pixels to unpack
+ * @param format	Pixel format of the frame
+ * @param image		Buffer of \p pixels elements for the image
+ */
+void unpackFrame(const std::uint64_t *words, const size_t pixels,
+				 const PixelFormat format, std::uint16_t *image);
+
+/**
+ * Unpacks a frame into a contiguous 16 bits image
+ * using a specific instruction set
+ *
+ * If \p level is not supported by the CPU, the best one supported is used.
+ *
+ * @param words		DMA words of the frame
+ * @param pixels	Number of pixels to unpack
+ * @param format	Pixel format of the frame
+ * @param image		Buffer of \p pixels elements for the image
+ * @param level		Instruction set to use
+ */
+void unpackFrame(const std::uint64_t *words, const size_t pixels,
+				 const PixelFormat format, std::uint16_t *image,
+				 const SIMDLevel level);
+
+/**
+ * Unpacks a range of consecutive pixels of a frame, such as a segment of a
+ * row, into a contiguous 16 bits buffer
+ *
+ * Only the DMA words holding the range are read.
+ *
+ * @param words		DMA words of the frame
+ * @param first		Index of the first pixel to unpack in the frame
+ * @param pixels	Number of pixels to unpack
+ * @param format	Pixel format of the frame
+ * @param image		Buffer of \p pixels elements for the pixels
+ * @param level		Instruction set to use. If it is not supported by
+ * 					the CPU, the best one supported is used
+ */
+void unpackPixels(const std::uint64_t *words, const size_t first,
+				  const size_t pixels, const PixelFormat format,
+				  std::uint16_t *image,
+				  const SIMDLevel level = getSIMDLevel());
+
+/**
+ * Unpacks a \ref PixelFormat::Mono8 frame into a contiguous 8 bits image
+ *
+ * @throw irio::errors::UnsupportedPixelFormatError	\p format is not Mono8
+ *
+ * @param words		DMA words of the frame
+ * @param pixels	Number of pixels to unpack
+ * @param format	Pixel format of the frame
+ * @param image		Buffer of \p pixels elements for the image
+ */
+void unpackFrame(const std::uint64_t *words, const size_t pixels,
+				 const PixelFormat format, std::uint8_t *image);
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "imaq/pixelUnpack.h"
+
+namespace irio {
+namespace imaq {
+
+/**
+ * Rectangular region of interest of an image, in pixels
+ *
+ * @ingroup IMAQ
+ */
+struct ROI {
+	/// First column of the region
+	size_t x;
+	/// First row of the region
+	size_t y;
+	/// Number of columns of the region
+	size_t width;
+	/// Number of rows of the region
+	size_t height;
+};
+
+/**
+ * How the pixels of a bin are combined
+ *
+ * @ingroup IMAQ
+ */
+enum class BinningMode : std::uint8_t {
+	Average,	/**< Mean of the pixels, keeps the bit depth */
+	Sum			/**< Sum of the pixels, saturated to 16 bits */
+};
+
+/**
+ * Crops a region of interest of IMAQ frames and optionally bins its pixels,
+ * working directly on the DMA words of the frame.
+ *
+ * Only the rows and columns of the region are unpacked, with the SIMD kernels
+ * of \ref irio::imaq::unpackPixels, so the memory traffic is proportional to
+ * the region instead of the full frame. Binning combines blocks of
+ * \p binning x \p binning pixels into one. The rows of the output can be
+ * processed by several threads of the shared \ref irio::WorkerPool.
+ *
+ * The stage is configured once and can be applied to any number of frames.
+ *
+ * @ingroup IMAQ
+ */
+class ROIBinningStage {
+ public:
+	/**
+	 * Configures the stage
+	 *
+	 * @throw irio::errors::ROIError	The region is empty, outside the image
+	 * 									or its dimensions are not multiple of
+	 * 									\p binning
+	 *
+	 * @param imageWidth	Number of columns of the full frame
+	 * @param imageHeight	Number of rows of the full frame
+	 * @param format		Pixel format of the frame
+	 * @param roi			Region of interest to keep
+	 * @param binning		Rows and columns of each bin. 1 to only crop
+	 * @param mode			How the pixels of each bin are combined
+	 * @param threads		Max number of threads processing the rows, the
+	 * 						calling one included
+	 */
+	ROIBinningStage(const size_t imageWidth, const size_t imageHeight,
+					const PixelFormat format, const ROI &roi,
+					const unsigned binning = 1,
+					const BinningMode mode = BinningMode::Average,
+					const unsigned threads = 1);
+
+	/**
+	 * Crops and bins a frame
+	 *
+	 * @param words		DMA words of the full frame. It must contain at least
+	 * 					\ref getFrameWords elements
+	 * @param image		Buffer of \ref getOutputPixels elements for the
+	 * 					result, row after row
+	 * @param level		Instruction set to use. If it is not supported by
+	 * 					the CPU, the best one supported is used
+	 */
+	void process(const std::uint64_t *words, std::uint16_t *image,
+				 const SIMDLevel level = getSIMDLevel()) const;
+
+	/**
+	 * Returns the number of columns of the result
+	 */
+	size_t getOutputWidth() const;
+
+	/**
+	 * Returns the number of rows of the result
+	 */
+	size_t getOutputHeight() const;
+
+	/**
+	 * Returns the number of pixels of the result
+	 */
+	size_t getOutputPixels() const;
+
+	/**
+	 * Returns the number of DMA words (64 bits) of the full frame
+	 */
+	size_t getFrameWords() const;
+
+	/**
+	 * Returns the pixel format of the frames
+	 */
+	PixelFormat getFormat() const;
+
+ private:
+	void processRows(const std::uint64_t *words, std::uint16_t *image,
+					 const SIMDLevel level, const size_t firstRow,
+					 const size_t lastRow) const;
+
+	const size_t m_imageWidth;
+	const size_t m_imageHeight;
+	const PixelFormat m_format;
+	const ROI m_roi;
+	const unsigned m_binning;
+	const BinningMode m_mode;
+	const unsigned m_threads;
+};
+
+}  // namespace imaq
+}  // namespace irio
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <profiles/profileBase.h>
+#include <platforms.h>
+
+namespace irio {
+/**
+ * Profile with the terminals
+ * specific to data acquisition functionality
+ * where the data is transferred to GPU.
+ *
+ * @ingroup Profiles
+ */
+class ProfileGPUDAQ: public ProfileBase {
+ public:
+	/**
+	 * Manages creating the required terminals for GPU data acquisition.
+	 *
+	 * @throw irio::errors::NiFpgaError    Error occurred in an FPGA operation
+	 *
+	 * @param parserManager     Pointer to class managing parsing the bitfile
+	 *                          and finding its resources
+	 * @param session           NiFpga_Session to be used in NiFpga related functions
+	 * @param platform          Platform used
+	 * @param id                Profile used
+	 */
+	ProfileGPUDAQ(
+			ParserManager *parserManager,
+			const NiFpga_Session &session,
+			const Platform &platform,
+			const PROFILE_ID &id);
+};
+
+}  // namespace irio
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "profiles/profileGPUIMAQ.h"
+
+namespace irio {
+/**
+ * Profile with the terminals
+ * specific to GPU image acquisition functionality
+ * and the ones specific to FlexRIO devices.
+ *
+ * @ingroup Profiles
+ * @ingroup ProfilesFlexRIO
+ */
+class ProfileGPUIMAQFlexRIO: public ProfileGPUIMAQ {
+ public:
+  /**
+   * Manages creating the required terminals for GPU image acquisition in
+   * FlexRIO boards
+   *
+   * @throw irio::errors::NiFpgaError    Error occurred in an FPGA operation
+   *
+   * @param parserManager     Pointer to class managing parsing the bitfile
+   *                          and finding its resources
+   * @param session           NiFpga_Session to be used in NiFpga related
+   * functions
+   * @param platform          Platform used
+   */
+  ProfileGPUIMAQFlexRIO(ParserManager *parserManager,
+						const NiFpga_Session &session,
+						const Platform &platform);
+};
+}  // namespace irio
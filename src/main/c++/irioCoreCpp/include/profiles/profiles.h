@@ -3,5 +3,7 @@
 #include <profiles/profileCPUDAQFlexRIO.h>
 #include <profiles/profileCPUDAQcRIO.h>
 #include <profiles/profileCPUIMAQFlexRIO.h>
+#include <profiles/profileGPUDAQFlexRIO.h>
+#include <profiles/profileGPUIMAQFlexRIO.h>
 #include <profiles/profileIOcRIO.h>
 #include <profiles/profileCPUDAQRSeries.h>
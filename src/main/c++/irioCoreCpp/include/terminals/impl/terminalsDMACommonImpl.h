@@ -4,9 +4,12 @@
 #include <unordered_map>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <atomic>
 
 #include "terminals/impl/terminalsBaseImpl.h"
 #include "frameTypes.h"
+#include "dmaBufferSink.h"
 
 namespace irio {
 /**
@@ -110,6 +113,24 @@ class TerminalsDMACommonImpl: public TerminalsBaseImpl{
 			bool blockRead,
 			std::uint32_t timeout = 0) const;
 
+	size_t acquireDataImpl(
+			const std::uint32_t n,
+			size_t elementsToAcquire,
+			std::uint64_t **data,
+			bool blockRead,
+			std::uint32_t timeout = 0) const;
+
+	void releaseDataImpl(const std::uint32_t n,
+			size_t elementsToRelease) const;
+
+	size_t getElementsAvailableImpl(const std::uint32_t n) const;
+
+	void setBufferSinkImpl(std::shared_ptr<DMABufferSink> sink);
+
+	void setHostBufferDepthImpl(const size_t depth);
+
+	size_t getHostBufferDepthImpl() const;
+
 	size_t countDMAsImpl() const;
 
  protected:
@@ -139,6 +160,9 @@ class TerminalsDMACommonImpl: public TerminalsBaseImpl{
 
 	std::unordered_map<std::uint32_t, const std::uint32_t> m_mapEnable;
 
+	std::shared_ptr<DMABufferSink> m_bufferSink;
+	std::atomic<size_t> m_hostBufferDepth;
+
 	const std::string m_nameTermOverflows;
 	const std::string m_nameTermDMA;
 	const std::string m_nameTermDMAEnable;
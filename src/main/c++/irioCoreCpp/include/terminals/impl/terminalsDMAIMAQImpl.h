@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -76,12 +77,28 @@ class TerminalsDMAIMAQImpl : public TerminalsDMACommonImpl {
 						 std::uint64_t *imageRead, const bool blockRead,
 						 const std::uint32_t timeout = 0) const;
 
+	size_t readImagesImpl(const std::uint32_t n, const size_t imagePixelSize,
+						  const size_t count, std::uint64_t *images,
+						  const std::uint32_t timeout = 0) const;
+
+	size_t acquireImagesImpl(const std::uint32_t n,
+							 const size_t imagePixelSize, const size_t count,
+							 std::uint64_t **images,
+							 const std::uint32_t timeout = 0) const;
+
+	void releaseImagesImpl(const std::uint32_t n, const size_t imagePixelSize,
+						   const size_t count) const;
+
 	void sendUARTMsgImpl(const std::vector<std::uint8_t> &msg,
 						 const std::uint32_t timeout = 0) const;
 
 	std::vector<std::uint8_t> recvUARTMsgImpl(const size_t bytesToRecv,
 								const std::uint32_t timeout = 0) const;
 
+	std::vector<std::uint8_t> sendUARTCommandImpl(
+		const std::vector<std::uint8_t> &msg, const size_t bytesToRecv,
+		const std::uint32_t timeout = 0) const;
+
 	void setUARTBaudRateImpl(const UARTBaudRates &baudRate,
 							 const std::uint32_t timeout = 0) const;
 
@@ -94,12 +111,36 @@ class TerminalsDMAIMAQImpl : public TerminalsDMACommonImpl {
 	std::uint16_t getUARTOverrunErrorImpl() const;
 
  private:
+	size_t getImageElements(const std::uint32_t n,
+							const size_t imagePixelSize) const;
+
 	void findUART(irio::ParserManager *parserManager);
 
 	void findCLConfig(irio::ParserManager *parserManager);
 
 	void waitForSetBaudRateFalse(const uint32_t timeout) const;
 
+	void sendUART(const std::vector<std::uint8_t> &msg,
+				  const std::uint32_t timeout) const;
+
+	std::vector<std::uint8_t> recvUART(const size_t bytesToRecv,
+									   const std::uint32_t timeout) const;
+
+	/**
+	 * Waits until a boolean register has the expected value, spinning at
+	 * first and then sleeping with an exponential backoff
+	 *
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @return	False if \p timeout (ms) expired, 0 waits indefinitely
+	 */
+	bool waitForBool(const std::uint32_t addr, const bool value,
+					 const std::uint32_t timeout,
+					 const std::string &nameTerm) const;
+
+	/// Serializes the UART transactions, which use several registers
+	mutable std::mutex m_uartMutex;
+
 	std::uint32_t m_baudRate_addr;
 	std::uint32_t m_setBaudRate_addr;
 	std::uint32_t m_txReady_addr;
@@ -9,5 +9,7 @@
 #include <terminals/terminalsSignalGeneration.h>
 #include <terminals/terminalsDMADAQCPU.h>
 #include <terminals/terminalsDMAIMAQCPU.h>
+#include <terminals/terminalsDMADAQGPU.h>
+#include <terminals/terminalsDMAIMAQGPU.h>
 #include <terminals/terminalsCommon.h>
 #include <terminals/terminalsIO.h>
@@ -5,6 +5,7 @@
 
 #include "terminals/terminalsBase.h"
 #include "frameTypes.h"
+#include "dmaBufferSink.h"
 
 namespace irio {
 
@@ -278,6 +279,96 @@ class TerminalsDMACommon: public TerminalsBase{
 			const bool blockRead,
 			const std::uint32_t timeout = 0) const;
 
+	/**
+	 * Gives direct access to an specified number of elements
+	 * of a DMA group, without copying them.
+	 *
+	 * The elements are accessed through the \ref irio::DMABufferSink
+	 * configured (\ref irio::HostMemoryBufferSink by default). They stay
+	 * valid until they are released with \ref releaseData, which must
+	 * be called with the number of elements acquired.
+	 * If there are less elements than requested and \p blockRead is false,
+	 * nothing is acquired.
+	 *
+	 * The number of elements acquired can be less than the ones requested
+	 * when the region wraps around the end of the host buffer. This can be
+	 * avoided by using a host buffer depth (\ref setHostBufferDepth)
+	 * multiple of \p elementsToAcquire.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::DMAReadTimeout 	If reading is in blocking mode,
+	 * 										and the timeout expires waiting for
+	 * 										enough data to be acquired
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param n					Number of DMA group
+	 * @param elementsToAcquire	Number of elements to acquire
+	 * @param[out] data			Pointer to the first element acquired
+	 * @param blockRead	 		Whether to wait until the requested number of
+	 * 							elements are available or not
+	 * @param timeout			If \p blockRead is true. Max time in
+	 * 							milliseconds to wait for the elements to be
+	 * 							available, 0 means wait indefinitely
+	 * @return	Number of elements acquired. 0 if they were not enough
+	 */
+	size_t acquireData(
+			const std::uint32_t n,
+			const size_t elementsToAcquire,
+			std::uint64_t **data,
+			const bool blockRead,
+			const std::uint32_t timeout = 0) const;
+
+	/**
+	 * Releases elements previously acquired with \ref acquireData,
+	 * returning them to the DMA
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param n					Number of DMA group
+	 * @param elementsToRelease	Number of elements to release
+	 */
+	void releaseData(const std::uint32_t n,
+					 const size_t elementsToRelease) const;
+
+	/**
+	 * Returns the number of elements of a DMA group that can be read
+	 * right now, without waiting
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param n	Number of DMA group
+	 * @return	Number of elements available
+	 */
+	size_t getElementsAvailable(const std::uint32_t n) const;
+
+	/**
+	 * Changes the backend used by \ref acquireData and \ref releaseData.
+	 *
+	 * It must not be changed while there are elements acquired.
+	 *
+	 * @param sink	Backend to use. nullptr restores
+	 * 				the default \ref irio::HostMemoryBufferSink
+	 */
+	void setBufferSink(std::shared_ptr<DMABufferSink> sink) const;
+
+	/**
+	 * Sets the number of elements of the host buffer reserved for
+	 * each DMA. It is applied the next time the DMAs are started.
+	 *
+	 * @param depth	Number of elements of the host buffer
+	 */
+	void setHostBufferDepth(const size_t depth) const;
+
+	/**
+	 * Returns the number of elements of the host buffer
+	 * reserved for each DMA
+	 *
+	 * @return Number of elements of the host buffer
+	 */
+	size_t getHostBufferDepth() const;
+
 	/**
 	 * Returns the number of DMAs found
 	 *
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "terminals/terminalsDMADAQ.h"
+
+namespace irio {
+
+/**
+ * Class managing the terminals used for DMA GPU DAQ operations
+ *
+ * The data is accessed without copies through
+ * \ref irio::TerminalsDMACommon::acquireData and
+ * \ref irio::TerminalsDMACommon::releaseData, using the
+ * \ref irio::DMABufferSink configured.
+ *
+ * @ingroup DMAGPUTerminals
+ */
+class TerminalsDMADAQGPU: public TerminalsDMADAQ{
+ public:
+	/**
+	 * Manages finding all the required DMA GPU DAQ resources.
+	 *
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param parserManager     Pointer to class managing parsing the bitfile
+	 *                          and finding its resources
+	 * @param session			NiFpga_Session to be used in NiFpga
+	 * 							related functions
+	 * @param platform			Platform that is using the terminals.
+	 * 							Used to know the maximum number of terminals
+	 * 							that can be found
+	 */
+	TerminalsDMADAQGPU(ParserManager *parserManager,
+			const NiFpga_Session &session,
+			const Platform &platform);
+};
+
+}  // namespace irio
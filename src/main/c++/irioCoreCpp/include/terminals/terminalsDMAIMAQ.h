@@ -1,5 +1,6 @@
 #pragma once
 
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -9,6 +10,14 @@
 namespace irio {
 class TerminalsDMAIMAQImpl;
 
+namespace imaq {
+class FrameGrabber;
+class FrameStatsStage;
+class FrameSynchronizer;
+class LineScanAssembler;
+class ROIBinningStage;
+}  // namespace imaq
+
 /**
  * Class managing the resources used for IMAQ DAQ operations
  * 
@@ -135,6 +144,186 @@ class TerminalsDMAIMAQ: public TerminalsDMACommon {
 					 std::uint64_t *imageRead, const bool blockRead,
 					 const std::uint32_t timeout = 0) const;
 
+	/**
+	 * Reads up to \p count images from a DMA group in a single transfer.
+	 *
+	 * All the complete images already in the DMA (up to \p count) are
+	 * read at once. If there are none, it waits for the first one and
+	 * then reads the ones that arrived meanwhile. This reduces the
+	 * per-image overhead of \ref readImage when the camera runs at high
+	 * frame rates or the consumer falls behind.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::DMAReadTimeout 	The timeout expired waiting for
+	 * 										the first image
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param n					Number of DMA group
+	 * @param imagePixelSize	Number of pixels of each image
+	 * @param count				Max number of images to read
+	 * @param images			Buffer for \p count images, one after the
+	 * 							other. Allocation and deallocation of this
+	 * 							buffer is user responsibility
+	 * @param timeout			Max time in milliseconds to wait for the
+	 * 							first image, 0 means wait indefinitely
+	 * @return	Number of images read, between 1 and \p count
+	 */
+	size_t readImages(const std::uint32_t n, const size_t imagePixelSize,
+					  const size_t count, std::uint64_t *images,
+					  const std::uint32_t timeout = 0) const;
+
+	/**
+	 * Gives direct access to up to \p count images of a DMA group,
+	 * without copying them. Equivalent to \ref readImages using
+	 * \ref acquireData.
+	 *
+	 * The images acquired are contiguous and stay valid until they are
+	 * released with \ref releaseImages. Fewer images than available
+	 * can be acquired when they wrap around the end of the host buffer.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::FrameAlignmentError	The host buffer depth
+	 * 											(\ref setHostBufferDepth) is
+	 * 											not a multiple of the image
+	 * 											size in elements
+	 * @throw irio::errors::DMAReadTimeout 	The timeout expired waiting for
+	 * 										the first image
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param n					Number of DMA group
+	 * @param imagePixelSize	Number of pixels of each image
+	 * @param count				Max number of images to acquire
+	 * @param[out] images		Pointer to the first image acquired
+	 * @param timeout			Max time in milliseconds to wait for the
+	 * 							first image, 0 means wait indefinitely
+	 * @return	Number of images acquired, between 1 and \p count
+	 */
+	size_t acquireImages(const std::uint32_t n, const size_t imagePixelSize,
+						 const size_t count, std::uint64_t **images,
+						 const std::uint32_t timeout = 0) const;
+
+	/**
+	 * Releases images previously acquired with \ref acquireImages,
+	 * returning them to the DMA
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param n					Number of DMA group
+	 * @param imagePixelSize	Number of pixels of each image
+	 * @param count				Number of images to release
+	 */
+	void releaseImages(const std::uint32_t n, const size_t imagePixelSize,
+					   const size_t count) const;
+
+	/**
+	 * Reads an image from a DMA group and crops and bins it with \p stage
+	 *
+	 * The full frame must be read from the DMA, but only the region of
+	 * interest is unpacked into \p image. See
+	 * \ref irio::imaq::ROIBinningStage; include "imaq/roiBinning.h" to
+	 * create it.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::UnsupportedPixelFormatError The pixel format of
+	 * 											\p stage does not match the
+	 * 											sample size of the DMA
+	 * @throw irio::errors::DMAReadTimeout 	If reading is in blocking mode,
+	 * 											and the timeout expires waiting
+	 * 											for enough data to be read
+	 * @throw irio::errors::NiFpgaError Error occurred in an FPGA operation
+	 *
+	 * @param n			Number of DMA group
+	 * @param stage		Region of interest and binning to apply
+	 * @param frame		Buffer of \ref irio::imaq::ROIBinningStage::getFrameWords
+	 * 					elements to read the full frame
+	 * @param image		Buffer of
+	 * 					\ref irio::imaq::ROIBinningStage::getOutputPixels
+	 * 					elements for the result
+	 * @param blockRead	Whether to wait until the frame is available or not
+	 * @param timeout	If \p blockRead is true. Max time in milliseconds to
+	 * 					wait for the frame, 0 means wait indefinitely.
+	 * @return	Number of pixels of the result. 0 if the frame was not
+	 * 			available
+	 */
+	size_t readImageROI(const std::uint32_t n,
+						const imaq::ROIBinningStage &stage,
+						std::uint64_t *frame, std::uint16_t *image,
+						const bool blockRead,
+						const std::uint32_t timeout = 0) const;
+
+	/**
+	 * Starts acquiring the images of a DMA group in a background thread,
+	 * using a pool of preallocated frames.
+	 *
+	 * See \ref irio::imaq::FrameGrabber. Include "imaq/frameGrabber.h"
+	 * to use the object returned.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::FramePoolError Unable to allocate the frames
+	 *
+	 * @param n					Number of DMA group
+	 * @param imagePixelSize	Number of pixels of each image
+	 * @param numFrames			Number of frames of the pool
+	 * @param queueDepth		Max number of frames waiting to be read.
+	 * 							0 to allow all the frames of the pool
+	 * @param hugePages			Whether to try to use huge pages for the frames
+	 * @param stats				Stage computing the statistics of each image,
+	 * 							see \ref irio::imaq::FrameStatsStage.
+	 * 							nullptr to not compute them
+	 * @return	Frame grabber acquiring the images
+	 */
+	std::unique_ptr<imaq::FrameGrabber> createFrameGrabber(
+		const std::uint32_t n, const size_t imagePixelSize,
+		const size_t numFrames, const size_t queueDepth = 0,
+		const bool hugePages = false,
+		std::shared_ptr<const imaq::FrameStatsStage> stats = nullptr) const;
+
+	/**
+	 * Creates an assembler of the lines of a line-scan camera into frames,
+	 * using a pool of preallocated frames.
+	 *
+	 * See \ref irio::imaq::LineScanAssembler. Include
+	 * "imaq/lineScanAssembler.h" to use the object returned.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 * @throw irio::errors::ImageStageError Invalid dimensions
+	 * @throw irio::errors::FramePoolError Unable to allocate the frames
+	 *
+	 * @param n				Number of DMA group
+	 * @param linePixels	Number of pixels of each line
+	 * @param frameLines	Number of lines of each frame
+	 * @param lineStep		Lines between the start of consecutive frames.
+	 * 						0 for frames without overlap
+	 * @param numFrames		Number of frames of the pool
+	 * @param hugePages		Whether to try to use huge pages for the frames
+	 * @return	Line-scan assembler
+	 */
+	std::unique_ptr<imaq::LineScanAssembler> createLineScanAssembler(
+		const std::uint32_t n, const size_t linePixels,
+		const size_t frameLines, const size_t lineStep = 0,
+		const size_t numFrames = 4, const bool hugePages = false) const;
+
+	/**
+	 * Creates a reader of whole frames delimited by the firmware with start
+	 * and end of frame words, which resynchronizes on torn frames without
+	 * stopping the DMA.
+	 *
+	 * See \ref irio::imaq::FrameSynchronizer, which also allows custom
+	 * markers. Include "imaq/frameSync.h" to use the object returned.
+	 *
+	 * @throw irio::errors::ResourceNotFoundError Resource specified not found
+	 *
+	 * @param n					Number of DMA group
+	 * @param imagePixelSize	Number of pixels of each image, without markers
+	 * @param hasCounter		Whether the firmware writes a frame counter in
+	 * 							the markers
+	 * @return	Frame synchronizer
+	 */
+	std::unique_ptr<imaq::FrameSynchronizer> createFrameSynchronizer(
+		const std::uint32_t n, const size_t imagePixelSize,
+		const bool hasCounter = true) const;
+
 	/**
 	 * Sends an UART message to the CameraLink system
 	 *
@@ -168,6 +357,31 @@ class TerminalsDMAIMAQ: public TerminalsDMACommon {
 	std::vector<std::uint8_t> recvUARTMsg(
 		const size_t bytesToRecv = 0, const std::uint32_t timeout = 1000) const;
 
+	/**
+	 * Sends an UART command to the CameraLink system and reads its response
+	 * in the background
+	 *
+	 * The command and its response are not mixed with other UART messages
+	 * sent or read at the same time. The Irio object must not be destroyed
+	 * before the future is ready.
+	 *
+	 * Do not use bytesToRecv = 0 and timeout = 0 at the same time!
+	 *
+	 * The future throws the same exceptions as \ref sendUARTMsg and
+	 * \ref recvUARTMsg.
+	 *
+	 * @param msg			Command to send
+	 * @param bytesToRecv	Number of bytes of the response. If it is 0,
+	 * 						reads everything until timeout
+	 * @param timeout		Max time (ms) to wait for the line to be ready
+	 * 						and between bytes of the response. (0 to wait
+	 * 						indefinetly)
+	 * @return	Future with the response
+	 */
+	std::future<std::vector<std::uint8_t>> sendUARTCommandAsync(
+		const std::vector<std::uint8_t> &msg, const size_t bytesToRecv = 0,
+		const std::uint32_t timeout = 1000) const;
+
 	/**
 	 * Sets UART baud rate
 	 * 
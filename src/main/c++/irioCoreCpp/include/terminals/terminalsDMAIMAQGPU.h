@@ -0,0 +1,37 @@
+#pragma once
+
+#include "terminals/terminalsDMAIMAQ.h"
+
+namespace irio {
+
+/**
+ * Class managing the resources used for DMA GPU IMAQ operations
+ *
+ * The images are accessed without copies through
+ * \ref irio::TerminalsDMACommon::acquireData and
+ * \ref irio::TerminalsDMACommon::releaseData, using the
+ * \ref irio::DMABufferSink configured.
+ *
+ * @ingroup IMAQGPUTerminals
+*/
+class TerminalsDMAIMAQGPU: public TerminalsDMAIMAQ {
+ public:
+	/**
+	 * Manages finding all the required DMA GPU IMAQ resources.
+	 *
+	 * @throw irio::errors::NiFpgaError Error reading resources from the FPGA
+	 *
+	 * @param parserManager     Pointer to class managing parsing the bitfile
+	 *                          and finding its resources
+	 * @param session			NiFpga_Session to be used in NiFpga
+	 * 							related functions
+	 * @param platform			Platform that is using the terminals.
+	 * 							Used to know the maximum number of terminals
+	 * 							that can be found
+	 */
+	TerminalsDMAIMAQGPU(ParserManager *parserManager,
+						const NiFpga_Session &session,
+						const Platform &platform);
+};
+
+}  // namespace irio
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace irio {
+
+/**
+ * Persistent threads shared by the processing stages that split a frame or
+ * a block between several threads.
+ *
+ * Creating and joining threads for every frame or block costs more than
+ * some of the work done, so the stages hand the parts of each call to
+ * workers started once. The calling thread always works on the parts too,
+ * so a call completes even when all the workers are busy with other calls,
+ * including calls made from a worker.
+ *
+ * The pool grows on demand up to the threads requested, so a stage
+ * configured with N threads still runs in up to N threads.
+ *
+ * @ingroup IrioCoreCpp
+ */
+class WorkerPool {
+ public:
+	/**
+	 * Returns the pool shared by all the stages of the process
+	 */
+	static WorkerPool &getShared();
+
+	WorkerPool() = default;
+
+	/**
+	 * Stops and joins the workers
+	 */
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	/**
+	 * Runs \p work once for each task in [0, \p tasks), in up to \p threads
+	 * threads, the calling one included, and returns when all the tasks
+	 * are done. The first exception thrown by a task is rethrown once all
+	 * the tasks have finished.
+	 *
+	 * @param tasks		Number of tasks
+	 * @param threads	Max number of threads working on the tasks
+	 * @param work		Function called with the number of each task
+	 */
+	void run(const size_t tasks, const unsigned threads,
+			 const std::function<void(size_t)> &work);
+
+	/**
+	 * Returns the number of workers started
+	 */
+	size_t getWorkers() const;
+
+ private:
+	struct Job;
+
+	void startWorkers(const size_t workers);
+	void workerLoop();
+	static void runTasks(Job *job);
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cv;
+	/// Jobs still accepting workers
+	std::deque<std::shared_ptr<Job>> m_jobs;
+	std::vector<std::thread> m_workers;
+	bool m_stop = false;
+};
+
+}  // namespace irio
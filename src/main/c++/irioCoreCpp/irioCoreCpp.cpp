@@ -307,9 +307,13 @@ void Irio::selectDevProfile(ParserManager *parserManager) {
 			new ProfileCPUIMAQFlexRIO(parserManager, m_session, *m_platform));
 		break;
 	case PROFILE_ID::FLEXRIO_GPUDAQ:
-		throw errors::ProfileNotImplementedError();
+		m_profile.reset(
+			new ProfileGPUDAQFlexRIO(parserManager, m_session, *m_platform));
+		break;
 	case PROFILE_ID::FLEXRIO_GPUIMAQ:
-		throw errors::ProfileNotImplementedError();
+		m_profile.reset(
+			new ProfileGPUIMAQFlexRIO(parserManager, m_session, *m_platform));
+		break;
 	case PROFILE_ID::CRIO_DAQ:
 		m_profile.reset(
 			new ProfileCPUDAQcRIO(parserManager, m_session, *m_platform));
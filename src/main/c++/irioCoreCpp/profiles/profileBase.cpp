@@ -53,6 +53,18 @@ void ProfileBase::addTerminal(TerminalsDMAIMAQCPU terminal) {
 				std::unique_ptr<TerminalsBase>(new TerminalsDMAIMAQCPU(terminal)));
 }
 
+template<>
+void ProfileBase::addTerminal(TerminalsDMADAQGPU terminal) {
+	m_mapTerminals.emplace(std::type_index(typeid(TerminalsDMADAQ)),
+				std::unique_ptr<TerminalsBase>(new TerminalsDMADAQGPU(terminal)));
+}
+
+template <>
+void ProfileBase::addTerminal(TerminalsDMAIMAQGPU terminal) {
+	m_mapTerminals.emplace(std::type_index(typeid(TerminalsDMAIMAQ)),
+				std::unique_ptr<TerminalsBase>(new TerminalsDMAIMAQGPU(terminal)));
+}
+
 template void ProfileBase::addTerminal(TerminalsAnalog terminal);
 template void ProfileBase::addTerminal(TerminalsAuxAnalog terminal);
 template void ProfileBase::addTerminal(TerminalsDigital terminal);
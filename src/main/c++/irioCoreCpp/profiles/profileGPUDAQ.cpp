@@ -0,0 +1,18 @@
+#include <profiles/profileGPUDAQ.h>
+#include <terminals/terminalsDMADAQGPU.h>
+
+namespace irio {
+
+ProfileGPUDAQ::ProfileGPUDAQ(ParserManager *parserManager,
+		const NiFpga_Session &session, const Platform &platform,
+		const PROFILE_ID &id) :
+		ProfileBase(parserManager, session, id) {
+	addTerminal(TerminalsAnalog(parserManager, session, platform));
+	addTerminal(TerminalsDigital(parserManager, session, platform));
+	addTerminal(TerminalsAuxAnalog(parserManager, session, platform));
+	addTerminal(TerminalsAuxDigital(parserManager, session, platform));
+	addTerminal(TerminalsSignalGeneration(parserManager, session, platform));
+	addTerminal(TerminalsDMADAQGPU(parserManager, session, platform));
+}
+
+}  // namespace irio
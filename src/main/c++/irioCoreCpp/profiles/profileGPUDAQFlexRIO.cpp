@@ -0,0 +1,14 @@
+#include <profiles/profileGPUDAQFlexRIO.h>
+#include <terminals/terminalsFlexRIO.h>
+
+
+namespace irio {
+
+ProfileGPUDAQFlexRIO::ProfileGPUDAQFlexRIO(ParserManager *parserManager,
+										   const NiFpga_Session &session,
+										   const Platform &platform)
+	: ProfileGPUDAQ(parserManager, session, platform,
+					PROFILE_ID::FLEXRIO_GPUDAQ) {
+	addTerminal(TerminalsFlexRIO(parserManager, session));
+}
+}  // namespace irio
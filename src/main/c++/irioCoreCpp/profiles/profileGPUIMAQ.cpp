@@ -0,0 +1,17 @@
+#include "profiles/profileGPUIMAQ.h"
+#include "terminals/terminalsDMAIMAQGPU.h"
+
+namespace irio {
+
+ProfileGPUIMAQ::ProfileGPUIMAQ(ParserManager *parserManager,
+							   const NiFpga_Session &session,
+							   const Platform &platform,
+                               const PROFILE_ID &id)
+	: ProfileBase(parserManager, session, id) {
+    addTerminal(TerminalsDigital(parserManager, session, platform));
+    addTerminal(TerminalsAuxDigital(parserManager, session, platform));
+    addTerminal(TerminalsAuxAnalog(parserManager, session, platform));
+    addTerminal(TerminalsDMAIMAQGPU(parserManager, session, platform));
+}
+
+}  // namespace irio
@@ -0,0 +1,12 @@
+#include "profiles/profileGPUIMAQFlexRIO.h"
+
+namespace irio {
+
+ProfileGPUIMAQFlexRIO::ProfileGPUIMAQFlexRIO(ParserManager *parserManager,
+											 const NiFpga_Session &session,
+											 const Platform &platform)
+	: ProfileGPUIMAQ(parserManager, session, platform,
+					 PROFILE_ID::FLEXRIO_GPUIMAQ) {
+	addTerminal(TerminalsFlexRIO(parserManager, session));
+}
+}  // namespace irio
@@ -49,7 +49,10 @@ TerminalsDMACommonImpl::TerminalsDMACommonImpl(ParserManager *parserManager,
 		const std::string &nameTermSampleSize,
 		const std::string &nameTermOverflows, const std::string &nameTermDMA,
 		const std::string &nameTermDMAEnable) :
-		TerminalsBaseImpl(session), m_nameTermOverflows(nameTermOverflows),
+		TerminalsBaseImpl(session),
+		m_bufferSink(std::make_shared<HostMemoryBufferSink>()),
+		m_hostBufferDepth(SIZE_HOST_DMAS),
+		m_nameTermOverflows(nameTermOverflows),
 		m_nameTermDMA(nameTermDMA), m_nameTermDMAEnable(nameTermDMAEnable) {
 	// Find Overflows (it is one uint16 where each bit is the status)
 	parserManager->findRegisterAddress(nameTermOverflows,
@@ -99,7 +102,7 @@ std::uint16_t TerminalsDMACommonImpl::getNChImpl(const std::uint32_t n) const {
 
 void TerminalsDMACommonImpl::startDMACommon(const std::uint32_t &dma) const {
 	// TODO: For the moment, do the same as in the old lib, reserve a lot of space
-	auto status = NiFpga_ConfigureFifo(m_session, dma, SIZE_HOST_DMAS);
+	auto status = NiFpga_ConfigureFifo(m_session, dma, m_hostBufferDepth);
 	utils::throwIfNotSuccessNiFpga(status,
 			"Error configuring " + m_nameTermDMA + std::to_string(dma));
 	status = NiFpga_StartFifo(m_session, dma);
@@ -283,6 +286,14 @@ size_t TerminalsDMACommonImpl::readDataImpl(const std::uint32_t n,
 	const auto dmaNum = utils::getAddressEnumResource(m_mapDMA, n,
 			m_nameTermDMA);
 
+	// Only build the error message when the read fails
+	const auto throwIfError = [this, n](const NiFpga_Status st) {
+		if (NiFpga_IsError(st)) {
+			utils::throwIfNotSuccessNiFpga(st,
+					"Error reading " + m_nameTermDMA + std::to_string(n));
+		}
+	};
+
 	size_t elementsRead = 0;
 	NiFpga_Status status;
 	if (block) {
@@ -292,22 +303,19 @@ size_t TerminalsDMACommonImpl::readDataImpl(const std::uint32_t n,
 		if (status == NiFpga_Status_FifoTimeout) {
 			throw errors::DMAReadTimeout(m_nameTermDMA, dmaNum);
 		}
-		utils::throwIfNotSuccessNiFpga(status,
-				"Error reading " + m_nameTermDMA + std::to_string(n));
+		throwIfError(status);
 		elementsRead = elementsToRead;
 	} else {
 		size_t elementsRemaining;
 		// Test how many elements are available right now
 		status = NiFpga_ReadFifoU64(m_session, dmaNum, data, 0, 0,
 				&elementsRemaining);
-		utils::throwIfNotSuccessNiFpga(status,
-				"Error reading " + m_nameTermDMA + std::to_string(n));
+		throwIfError(status);
 		// If not enough, do not read anything and return
 		if (elementsRemaining >= elementsToRead) {
 			status = NiFpga_ReadFifoU64(m_session, dmaNum, data, elementsToRead,
 					1, nullptr);
-			utils::throwIfNotSuccessNiFpga(status,
-					"Error reading " + m_nameTermDMA + std::to_string(n));
+			throwIfError(status);
 			elementsRead = elementsToRead;
 		}
 	}
@@ -315,6 +323,75 @@ size_t TerminalsDMACommonImpl::readDataImpl(const std::uint32_t n,
 	return elementsRead;
 }
 
+size_t TerminalsDMACommonImpl::acquireDataImpl(const std::uint32_t n,
+		size_t elementsToAcquire, std::uint64_t **data, bool block,
+		std::uint32_t timeout) const {
+	const auto dmaNum = utils::getAddressEnumResource(m_mapDMA, n,
+			m_nameTermDMA);
+
+	// Non blocking acquisitions only succeed if the elements are already there
+	const std::uint32_t timeoutAcquire =
+			block ? (timeout == 0 ? NiFpga_InfiniteTimeout : timeout) : 0;
+
+	size_t elementsAcquired = 0;
+	const auto status = m_bufferSink->acquire(m_session, dmaNum,
+			elementsToAcquire, timeoutAcquire, data, &elementsAcquired);
+	if (status == NiFpga_Status_FifoTimeout) {
+		if (block) {
+			throw errors::DMAReadTimeout(m_nameTermDMA, dmaNum);
+		}
+		return 0;
+	}
+	utils::throwIfNotSuccessNiFpga(status,
+			"Error acquiring " + m_nameTermDMA + std::to_string(n));
+
+	return elementsAcquired;
+}
+
+void TerminalsDMACommonImpl::releaseDataImpl(const std::uint32_t n,
+		size_t elementsToRelease) const {
+	const auto dmaNum = utils::getAddressEnumResource(m_mapDMA, n,
+			m_nameTermDMA);
+
+	const auto status = m_bufferSink->release(m_session, dmaNum,
+			elementsToRelease);
+	utils::throwIfNotSuccessNiFpga(status,
+			"Error releasing " + m_nameTermDMA + std::to_string(n));
+}
+
+size_t TerminalsDMACommonImpl::getElementsAvailableImpl(
+		const std::uint32_t n) const {
+	const auto dmaNum = utils::getAddressEnumResource(m_mapDMA, n,
+			m_nameTermDMA);
+
+	// Reading 0 elements only reports the ones available
+	std::uint64_t unused;
+	size_t elementsRemaining = 0;
+	const auto status = NiFpga_ReadFifoU64(m_session, dmaNum, &unused, 0, 0,
+			&elementsRemaining);
+	utils::throwIfNotSuccessNiFpga(status,
+			"Error reading " + m_nameTermDMA + std::to_string(n));
+
+	return elementsRemaining;
+}
+
+void TerminalsDMACommonImpl::setBufferSinkImpl(
+		std::shared_ptr<DMABufferSink> sink) {
+	if (sink) {
+		m_bufferSink = sink;
+	} else {
+		m_bufferSink = std::make_shared<HostMemoryBufferSink>();
+	}
+}
+
+void TerminalsDMACommonImpl::setHostBufferDepthImpl(const size_t depth) {
+	m_hostBufferDepth = depth;
+}
+
+size_t TerminalsDMACommonImpl::getHostBufferDepthImpl() const {
+	return m_hostBufferDepth;
+}
+
 std::unordered_map<std::uint32_t, const std::uint32_t>
 TerminalsDMACommonImpl::getDMAMap() const {
 	return m_mapDMA;
@@ -1,4 +1,7 @@
-#include <unistd.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
 
 #include "terminals/impl/terminalsDMAIMAQImpl.h"
 #include "terminals/names/namesTerminalsDMAIMAQ.h"
@@ -7,8 +10,13 @@
 
 namespace irio {
 
-static const unsigned int SLEEP_INTERVAL_NS = 1000000;  // 1 ms
-static const timespec sleepTs { 0, SLEEP_INTERVAL_NS };
+/// Time polling the UART registers without sleeping. Covers several bytes at
+/// the highest baud rates (about 11 us per byte at 921600 bauds)
+static const std::chrono::microseconds UART_SPIN_TIME(100);
+/// First sleep after the spin time, doubled on each poll
+static const std::chrono::microseconds UART_MIN_SLEEP(10);
+/// Max sleep between polls, the fixed interval used before
+static const std::chrono::microseconds UART_MAX_SLEEP(1000);
 
 TerminalsDMAIMAQImpl::TerminalsDMAIMAQImpl(
 	ParserManager* parserManager, const NiFpga_Session& session,
@@ -126,32 +134,103 @@ size_t TerminalsDMAIMAQImpl::readImageImpl(const std::uint32_t n,
 									   std::uint64_t* imageRead,
 									   const bool blockRead,
 									   const std::uint32_t timeout) const {
-	const size_t elementsToRead = imagePixelSize * getSampleSizeImpl(n) / 8;
+	const size_t elementsToRead = getImageElements(n, imagePixelSize);
 	return readDataImpl(n, elementsToRead, imageRead, blockRead, timeout) ==
 				   elementsToRead
 			   ? imagePixelSize
 			   : 0;
 }
 
+size_t TerminalsDMAIMAQImpl::readImagesImpl(const std::uint32_t n,
+											const size_t imagePixelSize,
+											const size_t count,
+											std::uint64_t* images,
+											const std::uint32_t timeout) const {
+	const size_t imageElements = getImageElements(n, imagePixelSize);
+	if (count == 0 || imageElements == 0) {
+		return 0;
+	}
+
+	// All the images already in the DMA are read in a single transfer
+	size_t available = std::min(
+		count, getElementsAvailableImpl(n) / imageElements);
+	if (available > 0) {
+		return readDataImpl(n, available * imageElements, images, false) /
+			   imageElements;
+	}
+
+	// Wait for the first image, then take the ones that arrived meanwhile
+	readDataImpl(n, imageElements, images, true, timeout);
+	available = std::min(count - 1,
+						 getElementsAvailableImpl(n) / imageElements);
+	if (available == 0) {
+		return 1;
+	}
+	return 1 + readDataImpl(n, available * imageElements,
+							images + imageElements, false) /
+				   imageElements;
+}
+
+size_t TerminalsDMAIMAQImpl::acquireImagesImpl(
+	const std::uint32_t n, const size_t imagePixelSize, const size_t count,
+	std::uint64_t** images, const std::uint32_t timeout) const {
+	const size_t imageElements = getImageElements(n, imagePixelSize);
+	if (count == 0 || imageElements == 0) {
+		return 0;
+	}
+
+	// Otherwise an image could be split at the end of the host buffer
+	if (getHostBufferDepthImpl() % imageElements != 0) {
+		throw errors::FrameAlignmentError(
+			"Host buffer depth (" + std::to_string(getHostBufferDepthImpl()) +
+			" elements) is not a multiple of the image size (" +
+			std::to_string(imageElements) + " elements)");
+	}
+
+	const size_t frames = std::max<size_t>(
+		1, std::min(count, getElementsAvailableImpl(n) / imageElements));
+	return acquireDataImpl(n, frames * imageElements, images, true, timeout) /
+		   imageElements;
+}
+
+void TerminalsDMAIMAQImpl::releaseImagesImpl(const std::uint32_t n,
+											 const size_t imagePixelSize,
+											 const size_t count) const {
+	releaseDataImpl(n, count * getImageElements(n, imagePixelSize));
+}
+
+size_t TerminalsDMAIMAQImpl::getImageElements(
+	const std::uint32_t n, const size_t imagePixelSize) const {
+	return imagePixelSize * getSampleSizeImpl(n) / 8;
+}
+
 void TerminalsDMAIMAQImpl::sendUARTMsgImpl(const std::vector<std::uint8_t>& msg,
 										   const std::uint32_t timeout) const {
+	std::lock_guard<std::mutex> lock(m_uartMutex);
+	sendUART(msg, timeout);
+}
+
+std::vector<std::uint8_t> TerminalsDMAIMAQImpl::recvUARTMsgImpl(
+	const size_t bytesToRecv, const std::uint32_t timeout) const {
+	std::lock_guard<std::mutex> lock(m_uartMutex);
+	return recvUART(bytesToRecv, timeout);
+}
+
+std::vector<std::uint8_t> TerminalsDMAIMAQImpl::sendUARTCommandImpl(
+	const std::vector<std::uint8_t>& msg, const size_t bytesToRecv,
+	const std::uint32_t timeout) const {
+	// The response must not be mixed with other messages
+	std::lock_guard<std::mutex> lock(m_uartMutex);
+	sendUART(msg, timeout);
+	return recvUART(bytesToRecv, timeout);
+}
+
+void TerminalsDMAIMAQImpl::sendUART(const std::vector<std::uint8_t>& msg,
+									const std::uint32_t timeout) const {
 	NiFpga_Status status;
 	for (const std::uint8_t& c : msg) {
-		NiFpga_Bool txReady = 0;
-		std::uint32_t countTimeout = 0;
-		status = NiFpga_ReadBool(m_session, m_txReady_addr, &txReady);
-		utils::throwIfNotSuccessNiFpga(
-			status, "Error waiting for " + std::string(TERMINAL_UARTTXREADY));
-		while (!txReady && (timeout == 0 || countTimeout < timeout)) {
-			nanosleep(&sleepTs, nullptr);
-			countTimeout++;
-			status = NiFpga_ReadBool(m_session, m_txReady_addr, &txReady);
-			utils::throwIfNotSuccessNiFpga(
-				status,
-				"Error waiting for " + std::string(TERMINAL_UARTTXREADY));
-		}
-
-		if (timeout != 0 && countTimeout >= timeout) {
+		if (!waitForBool(m_txReady_addr, true, timeout,
+						 TERMINAL_UARTTXREADY)) {
 			throw errors::CLUARTTimeout();
 		}
 
@@ -165,33 +244,20 @@ void TerminalsDMAIMAQImpl::sendUARTMsgImpl(const std::vector<std::uint8_t>& msg,
 	}
 }
 
-std::vector<std::uint8_t> TerminalsDMAIMAQImpl::recvUARTMsgImpl(
+std::vector<std::uint8_t> TerminalsDMAIMAQImpl::recvUART(
 	const size_t bytesToRecv, const std::uint32_t timeout) const {
 	NiFpga_Status status;
 	std::vector<std::uint8_t> recvMsg;
-	NiFpga_Bool rxReady = 1;
-	std::uint32_t countTimeout = 0;
+	bool rxReady = true;
 
 	recvMsg.reserve(bytesToRecv);
 
 	size_t bytesRead = 0;
 	while(rxReady && (bytesToRecv == 0 || bytesRead < bytesToRecv)) {
-		status = NiFpga_ReadBool(m_session, m_rxReady_addr, &rxReady);
-		utils::throwIfNotSuccessNiFpga(
-			status, "Error waiting for " + std::string(TERMINAL_UARTRXREADY));
-
-		countTimeout = 0;
-		while (!rxReady && (timeout == 0 || countTimeout < timeout)) {
-			nanosleep(&sleepTs, nullptr);
-			countTimeout++;
-			status = NiFpga_ReadBool(m_session, m_rxReady_addr, &rxReady);
-			utils::throwIfNotSuccessNiFpga(
-				status,
-				"Error waiting for " + std::string(TERMINAL_UARTRXREADY));
-		}
-
-		if (timeout != 0 && countTimeout >= timeout) {
-			// This means message has been received, return it
+		// If it expires, the message has been received
+		rxReady =
+			waitForBool(m_rxReady_addr, true, timeout, TERMINAL_UARTRXREADY);
+		if (!rxReady) {
 			continue;
 		}
 
@@ -199,21 +265,9 @@ std::vector<std::uint8_t> TerminalsDMAIMAQImpl::recvUARTMsgImpl(
 		utils::throwIfNotSuccessNiFpga(status,
 									   "Error enabling receiving UART data");
 
-		NiFpga_Bool isDataPending;  // 0 means data is ready
-		status = NiFpga_ReadBool(m_session, m_receive_addr, &isDataPending);
-		utils::throwIfNotSuccessNiFpga(
-			status, "Error reading " + std::string(TERMINAL_UARTRECEIVE));
-
-		countTimeout = 0;
-		while(isDataPending && (timeout == 0 || countTimeout < timeout)) {
-			nanosleep(&sleepTs, nullptr);
-			countTimeout++;
-			status = NiFpga_ReadBool(m_session, m_receive_addr, &isDataPending);
-			utils::throwIfNotSuccessNiFpga(
-				status, "Error reading " + std::string(TERMINAL_UARTRECEIVE));
-		}
-
-		if (timeout != 0 && countTimeout >= timeout) {
+		// TERMINAL_UARTRECEIVE is false when data is ready
+		if (!waitForBool(m_receive_addr, false, timeout,
+						 TERMINAL_UARTRECEIVE)) {
 			throw errors::CLUARTTimeout();
 		}
 
@@ -229,6 +283,7 @@ std::vector<std::uint8_t> TerminalsDMAIMAQImpl::recvUARTMsgImpl(
 
 void TerminalsDMAIMAQImpl::setUARTBaudRateImpl(
 	const UARTBaudRates& baudRate, const std::uint32_t timeout) const {
+	std::lock_guard<std::mutex> lock(m_uartMutex);
 	NiFpga_Status status;
 
 	// Wait for SetBaudRate = false
@@ -247,22 +302,52 @@ void TerminalsDMAIMAQImpl::setUARTBaudRateImpl(
 
 void TerminalsDMAIMAQImpl::waitForSetBaudRateFalse(
 	const uint32_t timeout) const {
-	NiFpga_Status status;
-	NiFpga_Bool setBR;
-	std::uint32_t countTimeout = 0;
-	status = NiFpga_ReadBool(m_session, m_setBaudRate_addr, &setBR);
-	utils::throwIfNotSuccessNiFpga(
-		status, "Error reading " + std::string(TERMINAL_UARTSETBAUDRATE));
-	while (setBR && (timeout == 0 || countTimeout < timeout)) {
-		nanosleep(&sleepTs, nullptr);
-		countTimeout++;
-		status = NiFpga_ReadBool(m_session, m_setBaudRate_addr, &setBR);
-		utils::throwIfNotSuccessNiFpga(
-			status, "Error reading " + std::string(TERMINAL_UARTSETBAUDRATE));
+	if (!waitForBool(m_setBaudRate_addr, false, timeout,
+					 TERMINAL_UARTSETBAUDRATE)) {
+		throw errors::CLUARTTimeout();
 	}
+}
 
-	if (timeout != 0 && countTimeout >= timeout) {
-		throw errors::CLUARTTimeout();
+bool TerminalsDMAIMAQImpl::waitForBool(const std::uint32_t addr,
+									   const bool value,
+									   const std::uint32_t timeout,
+									   const std::string& nameTerm) const {
+	using std::chrono::steady_clock;
+
+	const auto readValue = [this, addr, &nameTerm]() {
+		NiFpga_Bool aux;
+		const auto status = NiFpga_ReadBool(m_session, addr, &aux);
+		utils::throwIfNotSuccessNiFpga(status, "Error reading " + nameTerm);
+		return static_cast<bool>(aux);
+	};
+
+	if (readValue() == value) {
+		return true;
+	}
+
+	// Spin first, the UART changes state in microseconds at high baud rates,
+	// then sleep with an exponential backoff up to UART_MAX_SLEEP
+	const auto start = steady_clock::now();
+	const auto deadline = start + std::chrono::milliseconds(timeout);
+	std::chrono::nanoseconds sleepTime = UART_MIN_SLEEP;
+	while (true) {
+		const auto now = steady_clock::now();
+		if (timeout != 0 && now >= deadline) {
+			return false;
+		}
+		if (now - start >= UART_SPIN_TIME) {
+			if (timeout != 0) {
+				sleepTime = std::min<std::chrono::nanoseconds>(
+					sleepTime, deadline - now);
+			}
+			const timespec ts{0, static_cast<long>(sleepTime.count())};
+			nanosleep(&ts, nullptr);
+			sleepTime = std::min<std::chrono::nanoseconds>(sleepTime * 2,
+														   UART_MAX_SLEEP);
+		}
+		if (readValue() == value) {
+			return true;
+		}
 	}
 }
 
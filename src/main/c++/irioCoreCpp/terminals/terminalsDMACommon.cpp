@@ -116,4 +116,40 @@ size_t TerminalsDMACommon::readData(const std::uint32_t n,
 			->readDataImpl(n, elementsToRead, data, blockRead, timeout);
 }
 
+size_t TerminalsDMACommon::acquireData(const std::uint32_t n,
+									   const size_t elementsToAcquire,
+									   std::uint64_t **data,
+									   const bool blockRead,
+									   const std::uint32_t timeout) const {
+	return std::static_pointer_cast<TerminalsDMACommonImpl>(m_impl)
+			->acquireDataImpl(n, elementsToAcquire, data, blockRead, timeout);
+}
+
+void TerminalsDMACommon::releaseData(const std::uint32_t n,
+									 const size_t elementsToRelease) const {
+	std::static_pointer_cast<TerminalsDMACommonImpl>(m_impl)
+			->releaseDataImpl(n, elementsToRelease);
+}
+
+size_t TerminalsDMACommon::getElementsAvailable(const std::uint32_t n) const {
+	return std::static_pointer_cast<TerminalsDMACommonImpl>(m_impl)
+			->getElementsAvailableImpl(n);
+}
+
+void TerminalsDMACommon::setBufferSink(
+		std::shared_ptr<DMABufferSink> sink) const {
+	std::static_pointer_cast<TerminalsDMACommonImpl>(m_impl)
+			->setBufferSinkImpl(sink);
+}
+
+void TerminalsDMACommon::setHostBufferDepth(const size_t depth) const {
+	std::static_pointer_cast<TerminalsDMACommonImpl>(m_impl)
+			->setHostBufferDepthImpl(depth);
+}
+
+size_t TerminalsDMACommon::getHostBufferDepth() const {
+	return std::static_pointer_cast<TerminalsDMACommonImpl>(m_impl)
+			->getHostBufferDepthImpl();
+}
+
 }  // namespace irio
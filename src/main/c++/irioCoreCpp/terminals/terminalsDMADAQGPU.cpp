@@ -0,0 +1,21 @@
+#include "terminals/terminalsDMADAQGPU.h"
+#include "terminals/names/namesTerminalsDMAGPUCommon.h"
+#include "terminals/names/namesTerminalsDMADAQGPU.h"
+#include "terminals/impl/terminalsDMADAQImpl.h"
+
+namespace irio {
+
+TerminalsDMADAQGPU::TerminalsDMADAQGPU(
+		ParserManager *parserManager,
+		const NiFpga_Session &session,
+		const Platform &platform) :
+		TerminalsDMADAQ(
+				std::make_shared<TerminalsDMADAQImpl>(parserManager, session,
+						platform, TERMINAL_DMATTOGPUBLOCKNWORDS,
+						TERMINAL_DMATTOGPUSAMPLINGRATE, TERMINAL_DMATTOGPUNCH,
+						TERMINAL_DMATTOGPUFRAMETYPE,
+						TERMINAL_DMATTOGPUSAMPLESIZE,
+						TERMINAL_DMATTOGPUOVERFLOWS, TERMINAL_DMATTOGPU,
+						TERMINAL_DMATTOGPUENABLE)) {
+}
+}  // namespace irio
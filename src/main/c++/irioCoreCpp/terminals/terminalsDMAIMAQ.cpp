@@ -1,6 +1,13 @@
+#include <string>
+
 #include "terminals/terminalsDMAIMAQ.h"
 
 #include "terminals/impl/terminalsDMAIMAQImpl.h"
+#include "errorsIrio.h"
+#include "imaq/frameGrabber.h"
+#include "imaq/frameSync.h"
+#include "imaq/lineScanAssembler.h"
+#include "imaq/roiBinning.h"
 
 namespace irio {
 
@@ -41,6 +48,81 @@ size_t TerminalsDMAIMAQ::readImage(const std::uint32_t n,
 		->readImageImpl(n, imagePixelSize, imageRead, blockRead, timeout);
 }
 
+size_t TerminalsDMAIMAQ::readImages(const std::uint32_t n,
+									const size_t imagePixelSize,
+									const size_t count,
+									std::uint64_t *images,
+									const std::uint32_t timeout) const {
+	return std::static_pointer_cast<TerminalsDMAIMAQImpl>(m_impl)
+		->readImagesImpl(n, imagePixelSize, count, images, timeout);
+}
+
+size_t TerminalsDMAIMAQ::acquireImages(const std::uint32_t n,
+									   const size_t imagePixelSize,
+									   const size_t count,
+									   std::uint64_t **images,
+									   const std::uint32_t timeout) const {
+	return std::static_pointer_cast<TerminalsDMAIMAQImpl>(m_impl)
+		->acquireImagesImpl(n, imagePixelSize, count, images, timeout);
+}
+
+void TerminalsDMAIMAQ::releaseImages(const std::uint32_t n,
+									 const size_t imagePixelSize,
+									 const size_t count) const {
+	std::static_pointer_cast<TerminalsDMAIMAQImpl>(m_impl)
+		->releaseImagesImpl(n, imagePixelSize, count);
+}
+
+size_t TerminalsDMAIMAQ::readImageROI(const std::uint32_t n,
+									  const imaq::ROIBinningStage &stage,
+									  std::uint64_t *frame,
+									  std::uint16_t *image,
+									  const bool blockRead,
+									  const std::uint32_t timeout) const {
+	const auto format = stage.getFormat();
+	const auto sampleSize = getSampleSize(n);
+	if ((imaq::getPixelBits(format) + 7) / 8 != sampleSize) {
+		throw errors::UnsupportedPixelFormatError(
+			"The pixels of the stage do not match the samples of " +
+			std::to_string(sampleSize) + " bytes of the DMA " +
+			std::to_string(n));
+	}
+	const size_t words = stage.getFrameWords();
+	if (readData(n, words, frame, blockRead, timeout) != words) {
+		return 0;
+	}
+	stage.process(frame, image);
+	return stage.getOutputPixels();
+}
+
+std::unique_ptr<imaq::FrameGrabber> TerminalsDMAIMAQ::createFrameGrabber(
+	const std::uint32_t n, const size_t imagePixelSize, const size_t numFrames,
+	const size_t queueDepth, const bool hugePages,
+	std::shared_ptr<const imaq::FrameStatsStage> stats) const {
+	return std::unique_ptr<imaq::FrameGrabber>(new imaq::FrameGrabber(
+		*this, n, imagePixelSize, numFrames, queueDepth, hugePages, stats));
+}
+
+std::unique_ptr<imaq::LineScanAssembler>
+TerminalsDMAIMAQ::createLineScanAssembler(const std::uint32_t n,
+										  const size_t linePixels,
+										  const size_t frameLines,
+										  const size_t lineStep,
+										  const size_t numFrames,
+										  const bool hugePages) const {
+	return std::unique_ptr<imaq::LineScanAssembler>(
+		new imaq::LineScanAssembler(*this, n, linePixels, frameLines, lineStep,
+									numFrames, hugePages));
+}
+
+std::unique_ptr<imaq::FrameSynchronizer>
+TerminalsDMAIMAQ::createFrameSynchronizer(const std::uint32_t n,
+										  const size_t imagePixelSize,
+										  const bool hasCounter) const {
+	return std::unique_ptr<imaq::FrameSynchronizer>(
+		new imaq::FrameSynchronizer(*this, n, imagePixelSize, hasCounter));
+}
+
 void TerminalsDMAIMAQ::sendUARTMsg(const std::vector<std::uint8_t> &msg,
 								   const std::uint32_t timeout) const {
 	std::static_pointer_cast<TerminalsDMAIMAQImpl>(m_impl)->sendUARTMsgImpl(
@@ -53,6 +135,15 @@ std::vector<std::uint8_t> TerminalsDMAIMAQ::recvUARTMsg(
 		->recvUARTMsgImpl(bytesToRecv, timeout);
 }
 
+std::future<std::vector<std::uint8_t>> TerminalsDMAIMAQ::sendUARTCommandAsync(
+	const std::vector<std::uint8_t> &msg, const size_t bytesToRecv,
+	const std::uint32_t timeout) const {
+	const auto impl = std::static_pointer_cast<TerminalsDMAIMAQImpl>(m_impl);
+	return std::async(std::launch::async, [impl, msg, bytesToRecv, timeout]() {
+		return impl->sendUARTCommandImpl(msg, bytesToRecv, timeout);
+	});
+}
+
 void TerminalsDMAIMAQ::setUARTBaudRate(const UARTBaudRates &baudRate,
 									   const std::uint32_t timeout) const {
 	std::static_pointer_cast<TerminalsDMAIMAQImpl>(m_impl)->setUARTBaudRateImpl(
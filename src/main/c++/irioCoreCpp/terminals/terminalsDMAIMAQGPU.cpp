@@ -0,0 +1,15 @@
+#include "terminals/terminalsDMAIMAQGPU.h"
+#include "terminals/names/namesTerminalsDMAGPUCommon.h"
+#include "terminals/impl/terminalsDMAIMAQImpl.h"
+
+namespace irio {
+
+TerminalsDMAIMAQGPU::TerminalsDMAIMAQGPU(ParserManager *parserManager,
+										 const NiFpga_Session &session,
+										 const Platform &platform)
+	: TerminalsDMAIMAQ(std::make_shared<TerminalsDMAIMAQImpl>(
+		  parserManager, session, platform, TERMINAL_DMATTOGPUNCH,
+		  TERMINAL_DMATTOGPUFRAMETYPE, TERMINAL_DMATTOGPUSAMPLESIZE,
+		  TERMINAL_DMATTOGPUOVERFLOWS, TERMINAL_DMATTOGPU,
+		  TERMINAL_DMATTOGPUENABLE)) {}
+}  // namespace irio
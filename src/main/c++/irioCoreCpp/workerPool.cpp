@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+#include "workerPool.h"
+
+namespace irio {
+
+struct WorkerPool::Job {
+	const std::function<void(size_t)> *work;
+	size_t tasks;
+	/// Workers that can still join the job
+	size_t helpers;
+	/// Next task to run
+	std::atomic<size_t> next{0};
+	/// Tasks finished
+	std::atomic<size_t> done{0};
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::exception_ptr failure;
+};
+
+WorkerPool &WorkerPool::getShared() {
+	static WorkerPool pool;
+	return pool;
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	for (auto &worker : m_workers) {
+		worker.join();
+	}
+}
+
+void WorkerPool::run(const size_t tasks, const unsigned threads,
+					 const std::function<void(size_t)> &work) {
+	if (tasks == 0) {
+		return;
+	}
+	const size_t helpers = std::min<size_t>(std::max(1u, threads), tasks) - 1;
+	if (helpers == 0) {
+		for (size_t t = 0; t < tasks; ++t) {
+			work(t);
+		}
+		return;
+	}
+
+	const auto job = std::make_shared<Job>();
+	job->work = &work;
+	job->tasks = tasks;
+	job->helpers = helpers;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		startWorkers(helpers);
+		m_jobs.push_back(job);
+	}
+	for (size_t i = 0; i < helpers; ++i) {
+		m_cv.notify_one();
+	}
+
+	runTasks(job.get());
+
+	// Workers not joined yet would find no tasks left
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const auto it = std::find(m_jobs.begin(), m_jobs.end(), job);
+		if (it != m_jobs.end()) {
+			m_jobs.erase(it);
+		}
+	}
+	std::unique_lock<std::mutex> lock(job->mutex);
+	job->cv.wait(lock, [&job] { return job->done.load() == job->tasks; });
+	if (job->failure) {
+		std::rethrow_exception(job->failure);
+	}
+}
+
+size_t WorkerPool::getWorkers() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_workers.size();
+}
+
+void WorkerPool::startWorkers(const size_t workers) {
+	while (m_workers.size() < workers) {
+		m_workers.emplace_back(&WorkerPool::workerLoop, this);
+	}
+}
+
+void WorkerPool::workerLoop() {
+	while (true) {
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+			if (m_stop) {
+				return;
+			}
+			job = m_jobs.front();
+			if (--job->helpers == 0) {
+				m_jobs.pop_front();
+			}
+		}
+		runTasks(job.get());
+	}
+}
+
+void WorkerPool::runTasks(Job *job) {
+	size_t task;
+	while ((task = job->next.fetch_add(1)) < job->tasks) {
+		try {
+			(*job->work)(task);
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(job->mutex);
+			if (!job->failure) {
+				job->failure = std::current_exception();
+			}
+		}
+		if (job->done.fetch_add(1) + 1 == job->tasks) {
+			// Under the lock, so the caller cannot miss the notification
+			std::lock_guard<std::mutex> lock(job->mutex);
+			job->cv.notify_all();
+		}
+	}
+}
+
+}  // namespace irio
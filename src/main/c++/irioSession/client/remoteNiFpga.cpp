@@ -0,0 +1,281 @@
+/**
+ * NiFpga_* functions, NiFlexRio_GetAttribute and irio::searchRIODevice
+ * executed by the session daemon.
+ *
+ * Linking this library before irioCoreCpp (or loading it with LD_PRELOAD)
+ * replaces the ones of irioCoreCpp, so irio::Irio uses the sessions of
+ * the daemon. The daemon socket is given by the IRIO_SESSION_SOCKET
+ * environment variable, /tmp/irioSession.sock by default.
+ */
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <niflexrio.h>
+
+#include "sessionClient.h"
+#include "errorsIrio.h"
+#include "rioDiscovery.h"
+
+using irio::session::SessionClient;
+using irio::session::ValueType;
+
+namespace {
+
+std::mutex mutexClient;
+std::unique_ptr<SessionClient> client;
+
+/**
+ * Returns the connection with the daemon, connecting if needed
+ *
+ * @throw irio::errors::SessionConnectionError	Unable to connect
+ */
+SessionClient &getClient() {
+	std::lock_guard<std::mutex> lock(mutexClient);
+	if (!client) {
+		const char *envVar = std::getenv(irio::session::SOCKET_PATH_ENV_VAR);
+		client.reset(new SessionClient(
+			envVar ? envVar : irio::session::DEFAULT_SOCKET_PATH));
+	}
+	return *client;
+}
+
+template<typename Func>
+NiFpga_Status forward(Func func) {
+	try {
+		return func(getClient());
+	} catch (irio::errors::SessionConnectionError &) {
+		return NiFpga_Status_RpcConnectionError;
+	}
+}
+
+template<typename T>
+NiFpga_Status readRemote(const NiFpga_Session session,
+						 const std::uint32_t indicator, const ValueType type,
+						 T *value) {
+	return forward([=](SessionClient &c) {
+		return c.read(session, indicator, type, value);
+	});
+}
+
+template<typename T>
+NiFpga_Status writeRemote(const NiFpga_Session session,
+						  const std::uint32_t control, const ValueType type,
+						  const T value) {
+	return forward([=](SessionClient &c) {
+		return c.write(session, control, type, &value);
+	});
+}
+
+}  // namespace
+
+namespace irio {
+
+std::string searchRIODevice(const std::string serialNumber) {
+	try {
+		return getClient().searchRIODevice(serialNumber);
+	} catch (errors::SessionConnectionError &e) {
+		throw errors::RIODiscoveryError(e.what());
+	}
+}
+
+}  // namespace irio
+
+NiFpga_Status NiFpga_Initialize(void) {
+	return forward([](SessionClient &) { return NiFpga_Status_Success; });
+}
+
+NiFpga_Status NiFpga_Finalize(void) {
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status NiFpga_Open(const char *bitfile, const char *signature,
+						  const char *resource, uint32_t attribute,
+						  NiFpga_Session *session) {
+	return forward([=](SessionClient &c) {
+		return c.open(bitfile, signature, resource, attribute, session);
+	});
+}
+
+NiFpga_Status NiFpga_Close(NiFpga_Session session, uint32_t attribute) {
+	return forward([=](SessionClient &c) {
+		return c.close(session, attribute);
+	});
+}
+
+NiFpga_Status NiFpga_Run(NiFpga_Session session, uint32_t attribute) {
+	return forward([=](SessionClient &c) {
+		return c.run(session, attribute);
+	});
+}
+
+NiFpga_Status NiFpga_ReadBool(NiFpga_Session session, uint32_t indicator,
+							  NiFpga_Bool *value) {
+	return readRemote(session, indicator, ValueType::Bool, value);
+}
+
+NiFpga_Status NiFpga_ReadI8(NiFpga_Session session, uint32_t indicator,
+							int8_t *value) {
+	return readRemote(session, indicator, ValueType::I8, value);
+}
+
+NiFpga_Status NiFpga_ReadU8(NiFpga_Session session, uint32_t indicator,
+							uint8_t *value) {
+	return readRemote(session, indicator, ValueType::U8, value);
+}
+
+NiFpga_Status NiFpga_ReadI16(NiFpga_Session session, uint32_t indicator,
+							 int16_t *value) {
+	return readRemote(session, indicator, ValueType::I16, value);
+}
+
+NiFpga_Status NiFpga_ReadU16(NiFpga_Session session, uint32_t indicator,
+							 uint16_t *value) {
+	return readRemote(session, indicator, ValueType::U16, value);
+}
+
+NiFpga_Status NiFpga_ReadI32(NiFpga_Session session, uint32_t indicator,
+							 int32_t *value) {
+	return readRemote(session, indicator, ValueType::I32, value);
+}
+
+NiFpga_Status NiFpga_ReadU32(NiFpga_Session session, uint32_t indicator,
+							 uint32_t *value) {
+	return readRemote(session, indicator, ValueType::U32, value);
+}
+
+NiFpga_Status NiFpga_ReadI64(NiFpga_Session session, uint32_t indicator,
+							 int64_t *value) {
+	return readRemote(session, indicator, ValueType::I64, value);
+}
+
+NiFpga_Status NiFpga_ReadU64(NiFpga_Session session, uint32_t indicator,
+							 uint64_t *value) {
+	return readRemote(session, indicator, ValueType::U64, value);
+}
+
+NiFpga_Status NiFpga_WriteBool(NiFpga_Session session, uint32_t control,
+							   NiFpga_Bool value) {
+	return writeRemote(session, control, ValueType::Bool, value);
+}
+
+NiFpga_Status NiFpga_WriteI8(NiFpga_Session session, uint32_t control,
+							 int8_t value) {
+	return writeRemote(session, control, ValueType::I8, value);
+}
+
+NiFpga_Status NiFpga_WriteU8(NiFpga_Session session, uint32_t control,
+							 uint8_t value) {
+	return writeRemote(session, control, ValueType::U8, value);
+}
+
+NiFpga_Status NiFpga_WriteI16(NiFpga_Session session, uint32_t control,
+							  int16_t value) {
+	return writeRemote(session, control, ValueType::I16, value);
+}
+
+NiFpga_Status NiFpga_WriteU16(NiFpga_Session session, uint32_t control,
+							  uint16_t value) {
+	return writeRemote(session, control, ValueType::U16, value);
+}
+
+NiFpga_Status NiFpga_WriteI32(NiFpga_Session session, uint32_t control,
+							  int32_t value) {
+	return writeRemote(session, control, ValueType::I32, value);
+}
+
+NiFpga_Status NiFpga_WriteU32(NiFpga_Session session, uint32_t control,
+							  uint32_t value) {
+	return writeRemote(session, control, ValueType::U32, value);
+}
+
+NiFpga_Status NiFpga_WriteI64(NiFpga_Session session, uint32_t control,
+							  int64_t value) {
+	return writeRemote(session, control, ValueType::I64, value);
+}
+
+NiFpga_Status NiFpga_WriteU64(NiFpga_Session session, uint32_t control,
+							  uint64_t value) {
+	return writeRemote(session, control, ValueType::U64, value);
+}
+
+NiFpga_Status NiFpga_ReadArrayU8(NiFpga_Session session, uint32_t indicator,
+								 uint8_t *array, size_t size) {
+	return forward([=](SessionClient &c) {
+		return c.readArray(session, indicator, ValueType::U8, array, size);
+	});
+}
+
+NiFpga_Status NiFpga_ReadArrayU16(NiFpga_Session session, uint32_t indicator,
+								  uint16_t *array, size_t size) {
+	return forward([=](SessionClient &c) {
+		return c.readArray(session, indicator, ValueType::U16, array, size);
+	});
+}
+
+NiFpga_Status NiFpga_ConfigureFifo(NiFpga_Session session, uint32_t fifo,
+								   size_t depth) {
+	return forward([=](SessionClient &c) {
+		return c.configureFifo(session, fifo, depth);
+	});
+}
+
+NiFpga_Status NiFpga_StartFifo(NiFpga_Session session, uint32_t fifo) {
+	return forward([=](SessionClient &c) {
+		return c.startFifo(session, fifo);
+	});
+}
+
+NiFpga_Status NiFpga_StopFifo(NiFpga_Session session, uint32_t fifo) {
+	return forward([=](SessionClient &c) {
+		return c.stopFifo(session, fifo);
+	});
+}
+
+NiFpga_Status NiFpga_ReadFifoU64(NiFpga_Session session, uint32_t fifo,
+								 uint64_t *data, size_t numberOfElements,
+								 uint32_t timeout, size_t *elementsRemaining) {
+	return forward([=](SessionClient &c) {
+		return c.readFifoU64(session, fifo, data, numberOfElements, timeout,
+							 elementsRemaining);
+	});
+}
+
+NiFpga_Status NiFpga_AcquireFifoReadElementsU64(NiFpga_Session session,
+												uint32_t fifo,
+												uint64_t **elements,
+												size_t elementsRequested,
+												uint32_t timeout,
+												size_t *elementsAcquired,
+												size_t *elementsRemaining) {
+	return forward([=](SessionClient &c) {
+		return c.acquireFifoReadElementsU64(session, fifo, elements,
+											elementsRequested, timeout,
+											elementsAcquired,
+											elementsRemaining);
+	});
+}
+
+NiFpga_Status NiFpga_ReleaseFifoElements(NiFpga_Session session,
+										 uint32_t fifo, size_t elements) {
+	return forward([=](SessionClient &c) {
+		return c.releaseFifoElements(session, fifo, elements);
+	});
+}
+
+NiFpga_Status NiFlexRio_GetAttribute(NiFpga_Session session,
+									 int32_t attribute, int32_t valueType,
+									 void *value) {
+	if (valueType != NIFLEXRIO_ValueType_U32) {
+		return NiFpga_Status_InvalidParameter;
+	}
+
+	return forward([=](SessionClient &c) {
+		std::uint64_t aux;
+		const auto status =
+			c.getFlexRIOAttribute(session, attribute, valueType, &aux);
+		*static_cast<std::uint32_t*>(value) =
+			static_cast<std::uint32_t>(aux);
+		return status;
+	});
+}
@@ -0,0 +1,105 @@
+/**
+ * Session daemon.
+ *
+ * Keeps the FPGA sessions of its clients open between executions, so
+ * short-lived processes using libirioSessionClient do not download and
+ * initialize the bitfile every time.
+ *
+ * Usage: irioSessionDaemon [-s socketPath] [-m mode] [-g group]
+ *
+ * Any process that can connect to the socket can open bitfiles and use the
+ * FPGA with the privileges of the daemon, so only the owner and the group of
+ * the socket are allowed by default.
+ */
+#include <grp.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "sessionServer.h"
+#include "errorsIrio.h"
+
+namespace {
+
+void printUsage(const char *progName) {
+	std::cerr << "Usage: " << progName
+			  << " [-s socketPath] [-m mode] [-g group]" << std::endl
+			  << "  -s  Path of the Unix domain socket. Default: $"
+			  << irio::session::SOCKET_PATH_ENV_VAR << " or "
+			  << irio::session::DEFAULT_SOCKET_PATH << std::endl
+			  << "  -m  Octal permissions of the socket. Default: "
+			  << std::oct << irio::session::DEFAULT_SOCKET_MODE << std::dec
+			  << std::endl
+			  << "  -g  Group allowed to use the daemon. Default: group of "
+			  << "the process" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+	const char *envVar = std::getenv(irio::session::SOCKET_PATH_ENV_VAR);
+	std::string socketPath =
+		envVar ? envVar : irio::session::DEFAULT_SOCKET_PATH;
+
+	mode_t socketMode = irio::session::DEFAULT_SOCKET_MODE;
+	gid_t socketGroup = static_cast<gid_t>(-1);
+
+	int opt;
+	while ((opt = getopt(argc, argv, "s:m:g:h")) != -1) {
+		switch (opt) {
+		case 's':
+			socketPath = optarg;
+			break;
+		case 'm':
+			socketMode = static_cast<mode_t>(std::strtoul(optarg, nullptr, 8));
+			break;
+		case 'g': {
+			const group *grp = getgrnam(optarg);
+			if (!grp) {
+				std::cerr << "Unknown group " << optarg << std::endl;
+				return EXIT_FAILURE;
+			}
+			socketGroup = grp->gr_gid;
+			break;
+		}
+		default:
+			printUsage(argv[0]);
+			return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	// Signals are handled synchronously, blocked before creating any thread
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigaddset(&signals, SIGHUP);
+	pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+	const auto status = NiFpga_Initialize();
+	if (NiFpga_IsError(status)) {
+		std::cerr << "Unable to initialize NiFpga: " << status << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	irio::session::SessionServer server(socketPath, socketMode, socketGroup);
+	try {
+		server.start();
+	} catch (irio::errors::SessionConnectionError &e) {
+		std::cerr << e.what() << std::endl;
+		NiFpga_Finalize();
+		return EXIT_FAILURE;
+	}
+	std::cout << "Listening on " << socketPath << std::endl;
+
+	int sig;
+	sigwait(&signals, &sig);
+	std::cout << "Received signal " << sig << ", closing sessions" << std::endl;
+
+	server.stop();
+	NiFpga_Finalize();
+	return EXIT_SUCCESS;
+}
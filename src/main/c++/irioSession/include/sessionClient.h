@@ -0,0 +1,167 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sessionProtocol.h"
+
+namespace irio {
+namespace session {
+
+/**
+ * Client of the session daemon.
+ *
+ * Sends NiFpga_* calls to a \ref irio::session::SessionServer. Each method
+ * returns the status of the call executed by the daemon. Array and FIFO data
+ * is returned through a shared memory buffer created by the client.
+ *
+ * Calls are serialized, so a client can be used from several threads.
+ *
+ * @ingroup IrioSession
+ */
+class SessionClient {
+ public:
+	/**
+	 * Connects to the daemon and shares a memory buffer with it
+	 *
+	 * @throw irio::errors::SessionConnectionError	Unable to connect to the
+	 * 												daemon or create the buffer
+	 *
+	 * @param socketPath	Path of the daemon socket
+	 * @param shmSize		Size in bytes of the buffer used to transfer array
+	 * 						and FIFO data. Limits the data of a single read
+	 */
+	explicit SessionClient(const std::string &socketPath,
+						   const size_t shmSize = DEFAULT_SHM_SIZE);
+
+	/**
+	 * Disconnects from the daemon. The sessions opened are kept in the daemon
+	 */
+	~SessionClient();
+
+	SessionClient(const SessionClient &) = delete;
+	SessionClient &operator=(const SessionClient &) = delete;
+
+	/**
+	 * Searches the RIO device in the daemon
+	 *
+	 * @throw irio::errors::RIODeviceNotFoundError	Device not found
+	 * @throw irio::errors::RIODiscoveryError			Error discovering devices
+	 * @throw irio::errors::SessionConnectionError	Error communicating
+	 * 												with the daemon
+	 *
+	 * @param serialNumber	Serial number of the RIO device
+	 * @return	Name of the RIO device
+	 */
+	std::string searchRIODevice(const std::string &serialNumber);
+
+	/**
+	 * Opens a session, reusing it if the daemon already has it open
+	 */
+	NiFpga_Status open(const std::string &bitfile, const std::string &signature,
+					   const std::string &resource,
+					   const std::uint32_t attribute, NiFpga_Session *session);
+
+	/**
+	 * Releases a session. The daemon keeps it open
+	 */
+	NiFpga_Status close(const NiFpga_Session session,
+						const std::uint32_t attribute);
+
+	NiFpga_Status run(const NiFpga_Session session,
+					  const std::uint32_t attribute);
+
+	/**
+	 * Reads a register
+	 *
+	 * @param session	Session
+	 * @param indicator	Address of the register
+	 * @param type		Type of the register
+	 * @param value		Pointer to a variable of the size of \p type
+	 */
+	NiFpga_Status read(const NiFpga_Session session,
+					   const std::uint32_t indicator, const ValueType type,
+					   void *value);
+
+	/**
+	 * Writes a register
+	 *
+	 * @param session	Session
+	 * @param control	Address of the register
+	 * @param type		Type of the register
+	 * @param value		Pointer to the value, of the size of \p type
+	 */
+	NiFpga_Status write(const NiFpga_Session session,
+						const std::uint32_t control, const ValueType type,
+						const void *value);
+
+	/**
+	 * Reads an array register. Only U8 and U16 are supported
+	 */
+	NiFpga_Status readArray(const NiFpga_Session session,
+							const std::uint32_t indicator,
+							const ValueType type, void *array,
+							const size_t size);
+
+	NiFpga_Status configureFifo(const NiFpga_Session session,
+								const std::uint32_t fifo, const size_t depth);
+
+	NiFpga_Status startFifo(const NiFpga_Session session,
+							const std::uint32_t fifo);
+
+	NiFpga_Status stopFifo(const NiFpga_Session session,
+						   const std::uint32_t fifo);
+
+	NiFpga_Status readFifoU64(const NiFpga_Session session,
+							  const std::uint32_t fifo, std::uint64_t *data,
+							  const size_t numberOfElements,
+							  const std::uint32_t timeout,
+							  size_t *elementsRemaining);
+
+	/**
+	 * Reads the elements from the daemon into a buffer kept by the client
+	 * until they are released
+	 */
+	NiFpga_Status acquireFifoReadElementsU64(const NiFpga_Session session,
+											 const std::uint32_t fifo,
+											 std::uint64_t **elements,
+											 const size_t elementsRequested,
+											 const std::uint32_t timeout,
+											 size_t *elementsAcquired,
+											 size_t *elementsRemaining);
+
+	NiFpga_Status releaseFifoElements(const NiFpga_Session session,
+									  const std::uint32_t fifo,
+									  const size_t elements);
+
+	NiFpga_Status getFlexRIOAttribute(const NiFpga_Session session,
+									  const std::int32_t attribute,
+									  const std::int32_t valueType,
+									  std::uint64_t *value);
+
+ private:
+	/// Regions acquired and not released of a FIFO
+	struct AcquiredRegion {
+		std::vector<std::uint64_t> data;
+		size_t released;
+	};
+
+	Reply request(Request *req, const std::string &payload = "",
+				  std::string *replyPayload = nullptr);
+
+	Reply requestLocked(Request *req, const std::string &payload,
+						std::string *replyPayload);
+
+	int m_fd = -1;
+	SharedMemory m_shm;
+	std::mutex m_mutex;
+	std::map<std::pair<NiFpga_Session, std::uint32_t>,
+			 std::deque<AcquiredRegion>> m_acquired;
+};
+
+}  // namespace session
+}  // namespace irio
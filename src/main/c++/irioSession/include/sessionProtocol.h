@@ -0,0 +1,198 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <NiFpga.h>
+
+namespace irio {
+namespace session {
+
+/**
+ * @defgroup IrioSession Session daemon
+ * @ingroup IrioCoreCpp
+ *
+ * Daemon that keeps the FPGA sessions open between processes.
+ *
+ * The daemon (\ref irio::session::SessionServer) owns the NiFpga sessions
+ * and executes the NiFpga_* calls of its clients, received through a Unix
+ * domain socket. Bulk data (arrays and DMA data) is returned through a
+ * shared memory buffer per client.
+ *
+ * Processes linked with libirioSessionClient (or with it in LD_PRELOAD) send
+ * the NiFpga_* calls and the RIO device discovery to the daemon, so the
+ * irio::Irio API works unchanged but without discovering the device, opening
+ * a session or downloading the bitfile each time.
+ */
+
+/// Path of the daemon socket if the environment variable is not defined
+constexpr const char *DEFAULT_SOCKET_PATH = "/tmp/irioSession.sock";
+/// Permissions of the daemon socket if not specified: owner and group
+constexpr mode_t DEFAULT_SOCKET_MODE = 0660;
+/// Environment variable with the path of the daemon socket
+constexpr const char *SOCKET_PATH_ENV_VAR = "IRIO_SESSION_SOCKET";
+/// Default size in bytes of the shared memory buffer of each client
+constexpr size_t DEFAULT_SHM_SIZE = 16 * 1024 * 1024;
+
+/**
+ * Operations the daemon can execute
+ *
+ * @ingroup IrioSession
+ */
+enum class Operation : std::uint32_t {
+	Attach,  ///< Maps the shared memory buffer of the client
+	SearchDevice,
+	Open,
+	Close,
+	Run,
+	Read,
+	Write,
+	ReadArray,
+	ConfigureFifo,
+	StartFifo,
+	StopFifo,
+	ReadFifo,
+	GetFlexRIOAttribute,
+};
+
+/**
+ * Types of the values read or written
+ *
+ * @ingroup IrioSession
+ */
+enum class ValueType : std::uint32_t {
+	Bool, I8, U8, I16, U16, I32, U32, I64, U64,
+};
+
+/**
+ * Request sent to the daemon. Followed by \p payloadSize bytes
+ * (null terminated strings of the Open and SearchDevice operations)
+ *
+ * @ingroup IrioSession
+ */
+struct Request {
+	Operation op;
+	ValueType type;
+	std::uint32_t session;
+	/// Register, FIFO or attribute
+	std::uint32_t resource;
+	/// Attribute of Open/Close/Run, timeout of ReadFifo
+	std::uint32_t attribute;
+	std::uint32_t payloadSize;
+	/// Value to write, depth of ConfigureFifo or size of the shared memory
+	std::uint64_t value;
+	/// Number of elements of ReadArray and ReadFifo
+	std::uint64_t count;
+};
+
+/**
+ * Reply of the daemon. Followed by \p payloadSize bytes (device name or error
+ * message of SearchDevice). Array and FIFO data is in the shared memory buffer
+ *
+ * @ingroup IrioSession
+ */
+struct Reply {
+	NiFpga_Status status;
+	std::uint32_t session;
+	std::uint32_t payloadSize;
+	/// Result of SearchDevice, see \ref irio::session::SearchResult
+	std::uint32_t searchResult;
+	/// Value read
+	std::uint64_t value;
+	/// Elements remaining in the FIFO after ReadFifo
+	std::uint64_t count;
+};
+
+/**
+ * Result of the SearchDevice operation
+ *
+ * @ingroup IrioSession
+ */
+enum SearchResult : std::uint32_t {
+	SearchFound = 0,
+	SearchNotFound,
+	SearchDiscoveryError,
+};
+
+/**
+ * Returns the size in bytes of a \ref irio::session::ValueType
+ */
+size_t getValueTypeSize(const ValueType type);
+
+/**
+ * Sends a message and its payload through a socket
+ *
+ * @throw irio::errors::SessionConnectionError	Error writing to the socket
+ */
+void sendMessage(const int fd, const void *message, const size_t messageSize,
+				 const void *payload = nullptr, const size_t payloadSize = 0);
+
+/**
+ * Receives \p size bytes from a socket
+ *
+ * @throw irio::errors::SessionConnectionError	Error reading from the socket or
+ * 												socket closed by the peer
+ */
+void receiveAll(const int fd, void *buffer, const size_t size);
+
+/**
+ * POSIX shared memory buffer, unmapped when destroyed
+ *
+ * @ingroup IrioSession
+ */
+class SharedMemory {
+ public:
+	SharedMemory() = default;
+
+	/**
+	 * Creates and maps a new shared memory object.
+	 * It is unlinked when destroyed.
+	 *
+	 * @throw irio::errors::SessionConnectionError	Error creating it
+	 */
+	static SharedMemory create(const std::string &name, const size_t size);
+
+	/**
+	 * Maps an existing shared memory object
+	 *
+	 * @param name	Name of the shared memory object
+	 * @param size	Size in bytes to map
+	 * @param owner	User that must own the object
+	 * @throw irio::errors::SessionConnectionError	Error mapping it or
+	 * 												object owned by another user
+	 */
+	static SharedMemory attach(const std::string &name, const size_t size,
+							   const uid_t owner);
+
+	SharedMemory(SharedMemory &&other);
+	SharedMemory &operator=(SharedMemory &&other);
+
+	SharedMemory(const SharedMemory &) = delete;
+	SharedMemory &operator=(const SharedMemory &) = delete;
+
+	~SharedMemory();
+
+	/**
+	 * Removes the name of the shared memory object, the mapping is kept
+	 */
+	void unlink();
+
+	void *data() const;
+
+	size_t size() const;
+
+	const std::string &name() const;
+
+ private:
+	void reset();
+
+	std::string m_name;
+	void *m_data = nullptr;
+	size_t m_size = 0;
+	bool m_owner = false;
+};
+
+}  // namespace session
+}  // namespace irio
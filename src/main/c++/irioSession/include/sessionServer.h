@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sessionProtocol.h"
+
+namespace irio {
+namespace session {
+
+/**
+ * Server of the session daemon.
+ *
+ * Listens on a Unix domain socket and executes the NiFpga_* calls of its
+ * clients, each client served by its own thread. Sessions are shared: opening
+ * a bitfile already opened in the same RIO device returns the existing
+ * session without downloading it again. Sessions are kept open when their
+ * clients close them or disconnect, and are only closed when the server stops.
+ *
+ * Every client able to connect to the socket is trusted: it can open any
+ * bitfile in any RIO device and use the FPGA with the privileges of the
+ * daemon. Access is granted through the permissions of the socket, only
+ * for its owner and group by default. A client can only use the sessions it
+ * opened, and only map a shared memory object owned by its own user, as
+ * reported by the credentials of the socket.
+ *
+ * The NiFpga library must be initialized before starting the server.
+ *
+ * @ingroup IrioSession
+ */
+class SessionServer {
+ public:
+	/**
+	 * Creates a server. It does not listen until \ref start is called
+	 *
+	 * @param socketPath	Path of the Unix domain socket
+	 * @param socketMode	Permissions of the socket
+	 * @param socketGroup	Group of the socket, -1 to keep the one of the
+	 * 						process
+	 */
+	explicit SessionServer(const std::string &socketPath,
+						   const mode_t socketMode = DEFAULT_SOCKET_MODE,
+						   const gid_t socketGroup = static_cast<gid_t>(-1));
+
+	/**
+	 * Stops the server if running
+	 */
+	~SessionServer();
+
+	SessionServer(const SessionServer &) = delete;
+	SessionServer &operator=(const SessionServer &) = delete;
+
+	/**
+	 * Creates the socket, with the permissions and group given, and starts
+	 * accepting clients
+	 *
+	 * @throw irio::errors::SessionConnectionError	Unable to create the socket
+	 * 												or to set its permissions
+	 */
+	void start();
+
+	/**
+	 * Disconnects all the clients, closes all the sessions and
+	 * removes the socket
+	 */
+	void stop();
+
+	/**
+	 * Returns the number of FPGA sessions open
+	 */
+	size_t getNumSessions() const;
+
+	/**
+	 * Returns the number of clients using a session
+	 *
+	 * @param session	Session to check
+	 * @return	Number of clients using it, 0 if not found
+	 */
+	size_t getSessionUsers(const NiFpga_Session session) const;
+
+	/**
+	 * Returns the number of clients connected
+	 */
+	size_t getNumClients() const;
+
+ private:
+	struct SessionEntry {
+		NiFpga_Session session;
+		size_t users;
+		std::uint32_t closeAttribute;
+	};
+
+	struct Client {
+		int fd;
+		/// User of the client process
+		uid_t uid;
+		SharedMemory shm;
+		/// Sessions opened and not closed yet by the client
+		std::vector<NiFpga_Session> sessions;
+		std::thread thread;
+		std::atomic<bool> finished{false};
+	};
+
+	void acceptClients();
+
+	void serveClient(Client *client);
+
+	Reply execute(Client *client, const Request &request,
+				  const std::string &payload, std::string *replyPayload);
+
+	Reply openSession(Client *client, const Request &request,
+					  const std::string &payload);
+
+	Reply closeSession(Client *client, const Request &request);
+
+	Reply searchDevice(const std::string &serialNumber,
+					   std::string *replyPayload) const;
+
+	void releaseSessions(Client *client);
+
+	void joinFinishedClients();
+
+	const std::string m_socketPath;
+	const mode_t m_socketMode;
+	const gid_t m_socketGroup;
+	int m_listenFd = -1;
+	std::atomic<bool> m_running{false};
+	std::thread m_acceptThread;
+
+	mutable std::mutex m_mutexClients;
+	std::vector<std::unique_ptr<Client>> m_clients;
+
+	mutable std::mutex m_mutexSessions;
+	/// Sessions open, the key is the resource and the bitfile path
+	std::map<std::string, SessionEntry> m_sessions;
+};
+
+}  // namespace session
+}  // namespace irio
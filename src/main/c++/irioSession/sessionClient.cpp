@@ -0,0 +1,305 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "sessionClient.h"
+#include "errorsIrio.h"
+
+namespace irio {
+namespace session {
+
+namespace {
+
+std::string getUniqueShmName() {
+	static std::atomic<unsigned int> counter{0};
+	return "/irioSession." + std::to_string(getpid()) + "." +
+		   std::to_string(counter++);
+}
+
+Request createRequest(const Operation op, const NiFpga_Session session,
+					  const std::uint32_t resource = 0) {
+	Request req;
+	memset(&req, 0, sizeof(req));
+	req.op = op;
+	req.session = session;
+	req.resource = resource;
+	return req;
+}
+
+}  // namespace
+
+SessionClient::SessionClient(const std::string &socketPath,
+							 const size_t shmSize) {
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(addr.sun_path)) {
+		throw errors::SessionConnectionError("Socket path too long: " +
+											 socketPath);
+	}
+	std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+	m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (m_fd < 0) {
+		throw errors::SessionConnectionError(
+			std::string("Unable to create socket: ") + strerror(errno));
+	}
+	if (connect(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+		const std::string err = strerror(errno);
+		::close(m_fd);
+		throw errors::SessionConnectionError(
+			"Unable to connect to the session daemon at " + socketPath + ": " +
+			err);
+	}
+
+	try {
+		m_shm = SharedMemory::create(getUniqueShmName(), shmSize);
+		auto req = createRequest(Operation::Attach, 0);
+		req.value = shmSize;
+		const auto reply = request(&req, m_shm.name());
+		// Once mapped by the daemon the name is not needed anymore
+		m_shm.unlink();
+		if (NiFpga_IsError(reply.status)) {
+			throw errors::SessionConnectionError(
+				"The session daemon could not map the shared memory");
+		}
+	} catch (...) {
+		::close(m_fd);
+		throw;
+	}
+}
+
+SessionClient::~SessionClient() {
+	::close(m_fd);
+}
+
+std::string SessionClient::searchRIODevice(const std::string &serialNumber) {
+	auto req = createRequest(Operation::SearchDevice, 0);
+	std::string result;
+	const auto reply = request(&req, serialNumber, &result);
+
+	switch (reply.searchResult) {
+	case SearchFound:
+		return result;
+	case SearchNotFound:
+		throw errors::RIODeviceNotFoundError(serialNumber);
+	default:
+		throw errors::RIODiscoveryError(result);
+	}
+}
+
+NiFpga_Status SessionClient::open(const std::string &bitfile,
+								  const std::string &signature,
+								  const std::string &resource,
+								  const std::uint32_t attribute,
+								  NiFpga_Session *session) {
+	auto req = createRequest(Operation::Open, 0);
+	req.attribute = attribute;
+
+	std::string payload = bitfile;
+	payload.push_back('\0');
+	payload += signature;
+	payload.push_back('\0');
+	payload += resource;
+	payload.push_back('\0');
+
+	const auto reply = request(&req, payload);
+	if (!NiFpga_IsError(reply.status)) {
+		*session = reply.session;
+	}
+	return reply.status;
+}
+
+NiFpga_Status SessionClient::close(const NiFpga_Session session,
+								   const std::uint32_t attribute) {
+	auto req = createRequest(Operation::Close, session);
+	req.attribute = attribute;
+	const auto status = request(&req).status;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto it = m_acquired.begin();
+	while (it != m_acquired.end()) {
+		it = it->first.first == session ? m_acquired.erase(it) : ++it;
+	}
+	return status;
+}
+
+NiFpga_Status SessionClient::run(const NiFpga_Session session,
+								 const std::uint32_t attribute) {
+	auto req = createRequest(Operation::Run, session);
+	req.attribute = attribute;
+	return request(&req).status;
+}
+
+NiFpga_Status SessionClient::read(const NiFpga_Session session,
+								  const std::uint32_t indicator,
+								  const ValueType type, void *value) {
+	auto req = createRequest(Operation::Read, session, indicator);
+	req.type = type;
+	const auto reply = request(&req);
+	std::memcpy(value, &reply.value, getValueTypeSize(type));
+	return reply.status;
+}
+
+NiFpga_Status SessionClient::write(const NiFpga_Session session,
+								   const std::uint32_t control,
+								   const ValueType type, const void *value) {
+	auto req = createRequest(Operation::Write, session, control);
+	req.type = type;
+	std::memcpy(&req.value, value, getValueTypeSize(type));
+	return request(&req).status;
+}
+
+NiFpga_Status SessionClient::readArray(const NiFpga_Session session,
+									   const std::uint32_t indicator,
+									   const ValueType type, void *array,
+									   const size_t size) {
+	auto req = createRequest(Operation::ReadArray, session, indicator);
+	req.type = type;
+	req.count = size;
+
+	// The buffer must be copied before another request overwrites it
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto reply = requestLocked(&req, "", nullptr);
+	if (!NiFpga_IsError(reply.status)) {
+		std::memcpy(array, m_shm.data(), size * getValueTypeSize(type));
+	}
+	return reply.status;
+}
+
+NiFpga_Status SessionClient::configureFifo(const NiFpga_Session session,
+										   const std::uint32_t fifo,
+										   const size_t depth) {
+	auto req = createRequest(Operation::ConfigureFifo, session, fifo);
+	req.value = depth;
+	return request(&req).status;
+}
+
+NiFpga_Status SessionClient::startFifo(const NiFpga_Session session,
+									   const std::uint32_t fifo) {
+	auto req = createRequest(Operation::StartFifo, session, fifo);
+	return request(&req).status;
+}
+
+NiFpga_Status SessionClient::stopFifo(const NiFpga_Session session,
+									  const std::uint32_t fifo) {
+	auto req = createRequest(Operation::StopFifo, session, fifo);
+	return request(&req).status;
+}
+
+NiFpga_Status SessionClient::readFifoU64(const NiFpga_Session session,
+										 const std::uint32_t fifo,
+										 std::uint64_t *data,
+										 const size_t numberOfElements,
+										 const std::uint32_t timeout,
+										 size_t *elementsRemaining) {
+	auto req = createRequest(Operation::ReadFifo, session, fifo);
+	req.type = ValueType::U64;
+	req.count = numberOfElements;
+	req.attribute = timeout;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto reply = requestLocked(&req, "", nullptr);
+	if (!NiFpga_IsError(reply.status)) {
+		std::memcpy(data, m_shm.data(),
+					numberOfElements * sizeof(std::uint64_t));
+	}
+	if (elementsRemaining) {
+		*elementsRemaining = reply.count;
+	}
+	return reply.status;
+}
+
+NiFpga_Status SessionClient::acquireFifoReadElementsU64(
+	const NiFpga_Session session, const std::uint32_t fifo,
+	std::uint64_t **elements, const size_t elementsRequested,
+	const std::uint32_t timeout, size_t *elementsAcquired,
+	size_t *elementsRemaining) {
+	auto req = createRequest(Operation::ReadFifo, session, fifo);
+	req.type = ValueType::U64;
+	req.count = elementsRequested;
+	req.attribute = timeout;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto reply = requestLocked(&req, "", nullptr);
+	if (elementsRemaining) {
+		*elementsRemaining = reply.count;
+	}
+	if (NiFpga_IsError(reply.status)) {
+		return reply.status;
+	}
+
+	auto &regions = m_acquired[std::make_pair(session, fifo)];
+	const auto shmData = static_cast<const std::uint64_t*>(m_shm.data());
+	regions.push_back(AcquiredRegion{
+		std::vector<std::uint64_t>(shmData, shmData + elementsRequested), 0});
+	*elements = regions.back().data.data();
+	if (elementsAcquired) {
+		*elementsAcquired = elementsRequested;
+	}
+	return reply.status;
+}
+
+NiFpga_Status SessionClient::releaseFifoElements(const NiFpga_Session session,
+												 const std::uint32_t fifo,
+												 const size_t elements) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto &regions = m_acquired[std::make_pair(session, fifo)];
+
+	size_t pending = elements;
+	while (pending > 0 && !regions.empty()) {
+		auto &region = regions.front();
+		const size_t released =
+			std::min(pending, region.data.size() - region.released);
+		region.released += released;
+		pending -= released;
+		if (region.released == region.data.size()) {
+			regions.pop_front();
+		}
+	}
+
+	return pending ? NiFpga_Status_InvalidParameter : NiFpga_Status_Success;
+}
+
+NiFpga_Status SessionClient::getFlexRIOAttribute(const NiFpga_Session session,
+												 const std::int32_t attribute,
+												 const std::int32_t valueType,
+												 std::uint64_t *value) {
+	auto req = createRequest(Operation::GetFlexRIOAttribute, session,
+							 static_cast<std::uint32_t>(attribute));
+	req.attribute = static_cast<std::uint32_t>(valueType);
+	const auto reply = request(&req);
+	*value = reply.value;
+	return reply.status;
+}
+
+Reply SessionClient::request(Request *req, const std::string &payload,
+							 std::string *replyPayload) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return requestLocked(req, payload, replyPayload);
+}
+
+Reply SessionClient::requestLocked(Request *req, const std::string &payload,
+								   std::string *replyPayload) {
+	req->payloadSize = static_cast<std::uint32_t>(payload.size());
+	sendMessage(m_fd, req, sizeof(*req), payload.data(), payload.size());
+
+	Reply reply;
+	receiveAll(m_fd, &reply, sizeof(reply));
+	std::string auxPayload(reply.payloadSize, '\0');
+	receiveAll(m_fd, &auxPayload[0], reply.payloadSize);
+	if (replyPayload) {
+		*replyPayload = std::move(auxPayload);
+	}
+
+	return reply;
+}
+
+}  // namespace session
+}  // namespace irio
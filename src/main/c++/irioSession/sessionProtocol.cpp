@@ -0,0 +1,217 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "sessionProtocol.h"
+#include "errorsIrio.h"
+
+namespace irio {
+namespace session {
+
+size_t getValueTypeSize(const ValueType type) {
+	switch (type) {
+	case ValueType::Bool:
+	case ValueType::I8:
+	case ValueType::U8:
+		return 1;
+	case ValueType::I16:
+	case ValueType::U16:
+		return 2;
+	case ValueType::I32:
+	case ValueType::U32:
+		return 4;
+	case ValueType::I64:
+	case ValueType::U64:
+		return 8;
+	}
+	return 0;
+}
+
+void sendMessage(const int fd, const void *message, const size_t messageSize,
+				 const void *payload, const size_t payloadSize) {
+	iovec iov[2];
+	iov[0].iov_base = const_cast<void*>(message);
+	iov[0].iov_len = messageSize;
+	iov[1].iov_base = const_cast<void*>(payload);
+	iov[1].iov_len = payloadSize;
+
+	msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = payloadSize ? 2 : 1;
+
+	while (msg.msg_iovlen > 0) {
+		const auto sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw errors::SessionConnectionError(
+				std::string("Error sending to the session daemon: ") +
+				strerror(errno));
+		}
+
+		// Skip what has already been sent
+		size_t pending = static_cast<size_t>(sent);
+		while (msg.msg_iovlen > 0 && pending >= msg.msg_iov->iov_len) {
+			pending -= msg.msg_iov->iov_len;
+			msg.msg_iov++;
+			msg.msg_iovlen--;
+		}
+		if (msg.msg_iovlen > 0) {
+			msg.msg_iov->iov_base =
+				static_cast<char*>(msg.msg_iov->iov_base) + pending;
+			msg.msg_iov->iov_len -= pending;
+		}
+	}
+}
+
+void receiveAll(const int fd, void *buffer, const size_t size) {
+	auto ptr = static_cast<char*>(buffer);
+	size_t received = 0;
+	while (received < size) {
+		const auto ret = recv(fd, ptr + received, size - received, 0);
+		if (ret == 0) {
+			throw errors::SessionConnectionError(
+				"Connection with the session daemon closed");
+		} else if (ret < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw errors::SessionConnectionError(
+				std::string("Error receiving from the session daemon: ") +
+				strerror(errno));
+		}
+		received += static_cast<size_t>(ret);
+	}
+}
+
+SharedMemory SharedMemory::create(const std::string &name,
+								  const size_t size) {
+	const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0) {
+		throw errors::SessionConnectionError("Unable to create shared memory " +
+											 name + ": " + strerror(errno));
+	}
+
+	SharedMemory shm;
+	shm.m_name = name;
+	shm.m_owner = true;
+	if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+		const std::string err = strerror(errno);
+		close(fd);
+		shm.unlink();
+		throw errors::SessionConnectionError("Unable to resize shared memory " +
+											 name + ": " + err);
+	}
+
+	shm.m_data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm.m_data == MAP_FAILED) {
+		shm.m_data = nullptr;
+		shm.unlink();
+		throw errors::SessionConnectionError("Unable to map shared memory " +
+											 name + ": " + strerror(errno));
+	}
+	shm.m_size = size;
+
+	return shm;
+}
+
+SharedMemory SharedMemory::attach(const std::string &name, const size_t size,
+								  const uid_t owner) {
+	const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+	if (fd < 0) {
+		throw errors::SessionConnectionError("Unable to open shared memory " +
+											 name + ": " + strerror(errno));
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < size) {
+		close(fd);
+		throw errors::SessionConnectionError("Shared memory " + name +
+											 " is smaller than expected");
+	}
+	if (st.st_uid != owner) {
+		close(fd);
+		throw errors::SessionConnectionError("Shared memory " + name +
+											 " is owned by another user");
+	}
+
+	SharedMemory shm;
+	shm.m_name = name;
+	shm.m_data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (shm.m_data == MAP_FAILED) {
+		shm.m_data = nullptr;
+		throw errors::SessionConnectionError("Unable to map shared memory " +
+											 name + ": " + strerror(errno));
+	}
+	shm.m_size = size;
+
+	return shm;
+}
+
+SharedMemory::SharedMemory(SharedMemory &&other)
+	: m_name(std::move(other.m_name)),
+	  m_data(other.m_data),
+	  m_size(other.m_size),
+	  m_owner(other.m_owner) {
+	other.m_data = nullptr;
+	other.m_size = 0;
+	other.m_owner = false;
+}
+
+SharedMemory &SharedMemory::operator=(SharedMemory &&other) {
+	if (this != &other) {
+		reset();
+		m_name = std::move(other.m_name);
+		m_data = other.m_data;
+		m_size = other.m_size;
+		m_owner = other.m_owner;
+		other.m_data = nullptr;
+		other.m_size = 0;
+		other.m_owner = false;
+	}
+	return *this;
+}
+
+SharedMemory::~SharedMemory() {
+	reset();
+}
+
+void SharedMemory::unlink() {
+	if (m_owner) {
+		shm_unlink(m_name.c_str());
+		m_owner = false;
+	}
+}
+
+void *SharedMemory::data() const {
+	return m_data;
+}
+
+size_t SharedMemory::size() const {
+	return m_size;
+}
+
+const std::string &SharedMemory::name() const {
+	return m_name;
+}
+
+void SharedMemory::reset() {
+	unlink();
+	if (m_data) {
+		munmap(m_data, m_size);
+		m_data = nullptr;
+	}
+	m_size = 0;
+}
+
+}  // namespace session
+}  // namespace irio
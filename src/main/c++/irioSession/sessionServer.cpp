@@ -0,0 +1,519 @@
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <niflexrio.h>
+
+#include "sessionServer.h"
+#include "errorsIrio.h"
+#include "rioDiscovery.h"
+
+namespace irio {
+namespace session {
+
+namespace {
+
+/// Max size of the inline payload of a request (strings of Open)
+constexpr std::uint32_t MAX_REQUEST_PAYLOAD = 16 * 1024;
+
+/**
+ * Whether the operation acts on an already opened session. Close checks the
+ * session itself
+ */
+bool usesSession(const Operation op) {
+	switch (op) {
+	case Operation::Attach:
+	case Operation::SearchDevice:
+	case Operation::Open:
+	case Operation::Close:
+		return false;
+	default:
+		return true;
+	}
+}
+
+template<typename T, typename ReadFunc>
+NiFpga_Status readValue(ReadFunc func, const Request &request, Reply *reply) {
+	T value = 0;
+	const auto status = func(request.session, request.resource, &value);
+	std::memcpy(&reply->value, &value, sizeof(T));
+	return status;
+}
+
+template<typename T, typename WriteFunc>
+NiFpga_Status writeValue(WriteFunc func, const Request &request) {
+	T value;
+	std::memcpy(&value, &request.value, sizeof(T));
+	return func(request.session, request.resource, value);
+}
+
+NiFpga_Status read(const Request &request, Reply *reply) {
+	switch (request.type) {
+	case ValueType::Bool:
+		return readValue<NiFpga_Bool>(NiFpga_ReadBool, request, reply);
+	case ValueType::I8:
+		return readValue<std::int8_t>(NiFpga_ReadI8, request, reply);
+	case ValueType::U8:
+		return readValue<std::uint8_t>(NiFpga_ReadU8, request, reply);
+	case ValueType::I16:
+		return readValue<std::int16_t>(NiFpga_ReadI16, request, reply);
+	case ValueType::U16:
+		return readValue<std::uint16_t>(NiFpga_ReadU16, request, reply);
+	case ValueType::I32:
+		return readValue<std::int32_t>(NiFpga_ReadI32, request, reply);
+	case ValueType::U32:
+		return readValue<std::uint32_t>(NiFpga_ReadU32, request, reply);
+	case ValueType::I64:
+		return readValue<std::int64_t>(NiFpga_ReadI64, request, reply);
+	case ValueType::U64:
+		return readValue<std::uint64_t>(NiFpga_ReadU64, request, reply);
+	}
+	return NiFpga_Status_InvalidParameter;
+}
+
+NiFpga_Status write(const Request &request) {
+	switch (request.type) {
+	case ValueType::Bool:
+		return writeValue<NiFpga_Bool>(NiFpga_WriteBool, request);
+	case ValueType::I8:
+		return writeValue<std::int8_t>(NiFpga_WriteI8, request);
+	case ValueType::U8:
+		return writeValue<std::uint8_t>(NiFpga_WriteU8, request);
+	case ValueType::I16:
+		return writeValue<std::int16_t>(NiFpga_WriteI16, request);
+	case ValueType::U16:
+		return writeValue<std::uint16_t>(NiFpga_WriteU16, request);
+	case ValueType::I32:
+		return writeValue<std::int32_t>(NiFpga_WriteI32, request);
+	case ValueType::U32:
+		return writeValue<std::uint32_t>(NiFpga_WriteU32, request);
+	case ValueType::I64:
+		return writeValue<std::int64_t>(NiFpga_WriteI64, request);
+	case ValueType::U64:
+		return writeValue<std::uint64_t>(NiFpga_WriteU64, request);
+	}
+	return NiFpga_Status_InvalidParameter;
+}
+
+/**
+ * Whether the operation and the value type of a request are known. Any
+ * other value would come from a malformed request
+ */
+bool isValidRequest(const Request &request) {
+	return request.op <= Operation::GetFlexRIOAttribute &&
+		   request.type <= ValueType::U64;
+}
+
+/**
+ * Checks that the shared memory of the client can hold \p count elements
+ * of \p elementSize bytes
+ */
+NiFpga_Status checkBulkSize(const SharedMemory &shm, const std::uint64_t count,
+							const size_t elementSize) {
+	if (shm.data() == nullptr) {
+		return NiFpga_Status_RpcSessionError;
+	}
+	if (count > shm.size() / elementSize) {
+		return NiFpga_Status_MemoryFull;
+	}
+	return NiFpga_Status_Success;
+}
+
+std::string getSessionKey(const std::string &resource,
+						  const std::string &bitfile) {
+	return resource + '\n' + bitfile;
+}
+
+}  // namespace
+
+SessionServer::SessionServer(const std::string &socketPath,
+							 const mode_t socketMode, const gid_t socketGroup)
+	: m_socketPath(socketPath),
+	  m_socketMode(socketMode),
+	  m_socketGroup(socketGroup) {}
+
+SessionServer::~SessionServer() {
+	stop();
+}
+
+void SessionServer::start() {
+	if (m_running) {
+		return;
+	}
+
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (m_socketPath.size() >= sizeof(addr.sun_path)) {
+		throw errors::SessionConnectionError("Socket path too long: " +
+											 m_socketPath);
+	}
+	std::strncpy(addr.sun_path, m_socketPath.c_str(),
+				 sizeof(addr.sun_path) - 1);
+
+	m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (m_listenFd < 0) {
+		throw errors::SessionConnectionError(
+			std::string("Unable to create socket: ") + strerror(errno));
+	}
+
+	// Remove the socket of a previous daemon not stopped properly
+	unlink(m_socketPath.c_str());
+	if (bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+		const std::string err = strerror(errno);
+		close(m_listenFd);
+		m_listenFd = -1;
+		throw errors::SessionConnectionError("Unable to bind " + m_socketPath +
+											 ": " + err);
+	}
+
+	// Nobody can connect before listening, so the permissions are set first
+	const bool keepGroup = m_socketGroup == static_cast<gid_t>(-1);
+	if ((!keepGroup && chown(m_socketPath.c_str(), static_cast<uid_t>(-1),
+							 m_socketGroup) < 0) ||
+		chmod(m_socketPath.c_str(), m_socketMode) < 0 ||
+		listen(m_listenFd, SOMAXCONN) < 0) {
+		const std::string err = strerror(errno);
+		close(m_listenFd);
+		m_listenFd = -1;
+		unlink(m_socketPath.c_str());
+		throw errors::SessionConnectionError("Unable to listen on " +
+											 m_socketPath + ": " + err);
+	}
+
+	m_running = true;
+	m_acceptThread = std::thread(&SessionServer::acceptClients, this);
+}
+
+void SessionServer::stop() {
+	if (!m_running.exchange(false)) {
+		return;
+	}
+
+	shutdown(m_listenFd, SHUT_RDWR);
+	m_acceptThread.join();
+	close(m_listenFd);
+	m_listenFd = -1;
+	unlink(m_socketPath.c_str());
+
+	std::vector<std::unique_ptr<Client>> clients;
+	{
+		std::lock_guard<std::mutex> lock(m_mutexClients);
+		clients.swap(m_clients);
+	}
+	for (auto &client : clients) {
+		shutdown(client->fd, SHUT_RDWR);
+	}
+	for (auto &client : clients) {
+		client->thread.join();
+		close(client->fd);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutexSessions);
+	for (const auto &entry : m_sessions) {
+		NiFpga_Close(entry.second.session, entry.second.closeAttribute);
+	}
+	m_sessions.clear();
+}
+
+size_t SessionServer::getNumSessions() const {
+	std::lock_guard<std::mutex> lock(m_mutexSessions);
+	return m_sessions.size();
+}
+
+size_t SessionServer::getSessionUsers(const NiFpga_Session session) const {
+	std::lock_guard<std::mutex> lock(m_mutexSessions);
+	for (const auto &entry : m_sessions) {
+		if (entry.second.session == session) {
+			return entry.second.users;
+		}
+	}
+	return 0;
+}
+
+size_t SessionServer::getNumClients() const {
+	std::lock_guard<std::mutex> lock(m_mutexClients);
+	return std::count_if(m_clients.begin(), m_clients.end(),
+						 [](const std::unique_ptr<Client> &client) {
+							 return !client->finished;
+						 });
+}
+
+void SessionServer::acceptClients() {
+	while (m_running) {
+		const int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			break;
+		}
+
+		ucred credentials;
+		socklen_t credentialsSize = sizeof(credentials);
+		if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials,
+					   &credentialsSize) < 0) {
+			close(fd);
+			continue;
+		}
+
+		joinFinishedClients();
+
+		std::lock_guard<std::mutex> lock(m_mutexClients);
+		m_clients.emplace_back(new Client());
+		auto client = m_clients.back().get();
+		client->fd = fd;
+		client->uid = credentials.uid;
+		client->thread = std::thread(&SessionServer::serveClient, this, client);
+	}
+}
+
+void SessionServer::serveClient(Client *client) {
+	Request request;
+	std::string payload;
+	std::string replyPayload;
+	try {
+		while (true) {
+			receiveAll(client->fd, &request, sizeof(request));
+			if (request.payloadSize > MAX_REQUEST_PAYLOAD) {
+				break;
+			}
+			payload.resize(request.payloadSize);
+			receiveAll(client->fd, &payload[0], request.payloadSize);
+
+			replyPayload.clear();
+			auto reply = execute(client, request, payload, &replyPayload);
+			reply.payloadSize = static_cast<std::uint32_t>(replyPayload.size());
+			sendMessage(client->fd, &reply, sizeof(reply), replyPayload.data(),
+						replyPayload.size());
+		}
+	} catch (errors::SessionConnectionError &) {
+		// Client disconnected
+	}
+
+	releaseSessions(client);
+	client->shm = SharedMemory();
+	client->finished = true;
+}
+
+Reply SessionServer::execute(Client *client, const Request &request,
+							 const std::string &payload,
+							 std::string *replyPayload) {
+	Reply reply;
+	memset(&reply, 0, sizeof(reply));
+	reply.session = request.session;
+
+	if (!isValidRequest(request)) {
+		reply.status = NiFpga_Status_InvalidParameter;
+		return reply;
+	}
+
+	// A client can only use the sessions it opened
+	if (usesSession(request.op) &&
+		std::find(client->sessions.begin(), client->sessions.end(),
+				  request.session) == client->sessions.end()) {
+		reply.status = NiFpga_Status_InvalidParameter;
+		return reply;
+	}
+
+	switch (request.op) {
+	case Operation::Attach:
+		try {
+			client->shm = SharedMemory::attach(payload.c_str(), request.value,
+												client->uid);
+			reply.status = NiFpga_Status_Success;
+		} catch (errors::SessionConnectionError &) {
+			reply.status = NiFpga_Status_RpcSessionError;
+		}
+		break;
+	case Operation::SearchDevice:
+		reply = searchDevice(payload.c_str(), replyPayload);
+		break;
+	case Operation::Open:
+		reply = openSession(client, request, payload);
+		break;
+	case Operation::Close:
+		reply = closeSession(client, request);
+		break;
+	case Operation::Run:
+		reply.status = NiFpga_Run(request.session, request.attribute);
+		break;
+	case Operation::Read:
+		reply.status = read(request, &reply);
+		break;
+	case Operation::Write:
+		reply.status = write(request);
+		break;
+	case Operation::ReadArray:
+		reply.status = checkBulkSize(client->shm, request.count,
+									 getValueTypeSize(request.type));
+		if (NiFpga_IsError(reply.status)) {
+			break;
+		}
+		if (request.type == ValueType::U8) {
+			reply.status = NiFpga_ReadArrayU8(
+				request.session, request.resource,
+				static_cast<std::uint8_t*>(client->shm.data()), request.count);
+		} else if (request.type == ValueType::U16) {
+			reply.status = NiFpga_ReadArrayU16(
+				request.session, request.resource,
+				static_cast<std::uint16_t*>(client->shm.data()), request.count);
+		} else {
+			reply.status = NiFpga_Status_InvalidParameter;
+		}
+		break;
+	case Operation::ConfigureFifo:
+		reply.status = NiFpga_ConfigureFifo(request.session, request.resource,
+											request.value);
+		break;
+	case Operation::StartFifo:
+		reply.status = NiFpga_StartFifo(request.session, request.resource);
+		break;
+	case Operation::StopFifo:
+		reply.status = NiFpga_StopFifo(request.session, request.resource);
+		break;
+	case Operation::ReadFifo: {
+		// The FIFO is always read as U64, whatever the type requested
+		reply.status = checkBulkSize(client->shm, request.count,
+									 sizeof(std::uint64_t));
+		if (NiFpga_IsError(reply.status)) {
+			break;
+		}
+		size_t remaining = 0;
+		reply.status = NiFpga_ReadFifoU64(
+			request.session, request.resource,
+			static_cast<std::uint64_t*>(client->shm.data()), request.count,
+			request.attribute, &remaining);
+		reply.count = remaining;
+		break;
+	}
+	case Operation::GetFlexRIOAttribute: {
+		std::uint64_t value = 0;
+		reply.status = NiFlexRio_GetAttribute(
+			request.session, static_cast<std::int32_t>(request.resource),
+			static_cast<std::int32_t>(request.attribute), &value);
+		reply.value = value;
+		break;
+	}
+	default:
+		reply.status = NiFpga_Status_InvalidParameter;
+		break;
+	}
+
+	return reply;
+}
+
+Reply SessionServer::openSession(Client *client, const Request &request,
+								 const std::string &payload) {
+	Reply reply;
+	memset(&reply, 0, sizeof(reply));
+
+	// Payload: bitfile, signature and resource, each one null terminated
+	const std::string bitfile = payload.c_str();
+	const size_t posSignature = bitfile.size() + 1;
+	const std::string signature =
+		posSignature < payload.size() ? payload.c_str() + posSignature : "";
+	const size_t posResource = posSignature + signature.size() + 1;
+	const std::string resource =
+		posResource < payload.size() ? payload.c_str() + posResource : "";
+
+	std::lock_guard<std::mutex> lock(m_mutexSessions);
+	const auto key = getSessionKey(resource, bitfile);
+	auto it = m_sessions.find(key);
+	if (it == m_sessions.end()) {
+		NiFpga_Session session = 0;
+		reply.status = NiFpga_Open(bitfile.c_str(), signature.c_str(),
+								   resource.c_str(), request.attribute,
+								   &session);
+		if (NiFpga_IsError(reply.status)) {
+			return reply;
+		}
+		it = m_sessions.emplace(key, SessionEntry{session, 0, 0}).first;
+	} else {
+		reply.status = NiFpga_Status_Success;
+	}
+
+	it->second.users++;
+	client->sessions.push_back(it->second.session);
+	reply.session = it->second.session;
+	return reply;
+}
+
+Reply SessionServer::closeSession(Client *client, const Request &request) {
+	Reply reply;
+	memset(&reply, 0, sizeof(reply));
+	reply.session = request.session;
+
+	const auto itClient = std::find(client->sessions.begin(),
+									client->sessions.end(), request.session);
+	if (itClient == client->sessions.end()) {
+		reply.status = NiFpga_Status_InvalidParameter;
+		return reply;
+	}
+	client->sessions.erase(itClient);
+
+	// The session is kept open, the attribute is used when the server stops
+	std::lock_guard<std::mutex> lock(m_mutexSessions);
+	for (auto &entry : m_sessions) {
+		if (entry.second.session == request.session) {
+			entry.second.users--;
+			entry.second.closeAttribute = request.attribute;
+		}
+	}
+	reply.status = NiFpga_Status_Success;
+	return reply;
+}
+
+Reply SessionServer::searchDevice(const std::string &serialNumber,
+								  std::string *replyPayload) const {
+	Reply reply;
+	memset(&reply, 0, sizeof(reply));
+	reply.status = NiFpga_Status_Success;
+
+	try {
+		*replyPayload = searchRIODevice(serialNumber);
+		reply.searchResult = SearchFound;
+	} catch (errors::RIODeviceNotFoundError &e) {
+		*replyPayload = e.what();
+		reply.searchResult = SearchNotFound;
+	} catch (errors::IrioError &e) {
+		*replyPayload = e.what();
+		reply.searchResult = SearchDiscoveryError;
+	}
+
+	return reply;
+}
+
+void SessionServer::releaseSessions(Client *client) {
+	std::lock_guard<std::mutex> lock(m_mutexSessions);
+	for (const auto session : client->sessions) {
+		for (auto &entry : m_sessions) {
+			if (entry.second.session == session) {
+				entry.second.users--;
+			}
+		}
+	}
+	client->sessions.clear();
+}
+
+void SessionServer::joinFinishedClients() {
+	std::lock_guard<std::mutex> lock(m_mutexClients);
+	auto it = m_clients.begin();
+	while (it != m_clients.end()) {
+		if ((*it)->finished) {
+			(*it)->thread.join();
+			close((*it)->fd);
+			it = m_clients.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+}  // namespace session
+}  // namespace irio
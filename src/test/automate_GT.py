@@ -16,6 +16,7 @@ binaryPaths = {
     "irioCore Functional": "c++/irioCore/test_irioCore",
     "irioCoreCpp Unitary": "c++/unittests/irioCoreCpp/test_ut_irioCoreCpp",
     "irioCoreCpp Functional": "c++/irioCoreCpp/test_irioCoreCpp",
+    "irioSession Unitary": "c++/unittests/irioSession/test_ut_irioSession",
     "BFP": "c++/bfp/test_bfp",
 }
 
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+#include "fixtures_adapter.h"
+#include "fff_nifpga.h"
+
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMADAQCPU.h"
+#include "platforms.h"
+
+#include "irioDriver.h"
+#include "irioError.h"
+#include "irioHandlerDMA.h"
+
+using namespace irio;
+
+/**
+ * Measures the overhead of the irio_getDMATtoHostData read path. The NiFpga
+ * calls are fakes that return immediately, so the time measured is the time
+ * spent in the library for each call.
+ */
+class DMAReadBenchmark: public BaseTestsAdapter {
+public:
+	DMAReadBenchmark():
+		BaseTestsAdapter("../../../resources/7966", "FlexRIO_CPUDAQ_7966")
+	{
+		setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::FlexRIO);
+
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU16,
+						bfp.getRegister(TERMINAL_DMATTOHOSTBLOCKNWORDS).getAddress(),
+						nwords, sizeof(nwords)/sizeof(std::uint16_t));
+
+		irio_initStatus(&status);
+		auto ret = irio_initDriver("test", "0", "TestModel",
+					projectName.c_str(), "V9.9", false,
+					nullptr, bitfileDir.c_str(), &p_DrvPvt, &status);
+
+		if(ret != IRIO_success) {
+			throw std::runtime_error("Unable to initialize driver");
+		}
+	}
+
+	~DMAReadBenchmark() {
+		irio_closeDriver(&p_DrvPvt, 0, &status);
+		irio_resetStatus(&status);
+	}
+
+	double nsPerCall(const std::function<void()> &func) {
+		// Warm up
+		for (size_t i = 0; i < ITERATIONS / 10; ++i) {
+			func();
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < ITERATIONS; ++i) {
+			func();
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::nano>(end - start).count()
+				/ ITERATIONS;
+	}
+
+	static constexpr size_t ITERATIONS = 1000000;
+
+	TStatus status;
+	irioDrv_t p_DrvPvt;
+	uint64_t data[4096];
+private:
+	std::uint16_t nwords[2] = {64, 64};
+};
+
+constexpr size_t DMAReadBenchmark::ITERATIONS;
+
+TEST_F(DMAReadBenchmark, getDMATtoHostDataOverhead) {
+	int elementsRead;
+	const double nsRead = nsPerCall([this, &elementsRead] {
+		irio_getDMATtoHostData(&p_DrvPvt, 1, 0, data, &elementsRead,
+				&status);
+	});
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+
+	// Reference: a call that looks up the driver instance and its terminals
+	uint16_t blockNWords;
+	const double nsLookup = nsPerCall([this, &blockNWords] {
+		irio_getDMATtoHOSTBlockNWords(&p_DrvPvt, &blockNWords, &status);
+	});
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+
+	std::cout << "irio_getDMATtoHostData: " << nsRead << " ns/call"
+			<< std::endl;
+	std::cout << "Instance lookup reference: " << nsLookup << " ns/call"
+			<< std::endl;
+	RecordProperty("getDMATtoHostData_ns", std::to_string(nsRead));
+	RecordProperty("instanceLookup_ns", std::to_string(nsLookup));
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/channelStats.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the channel statistics, in millions of input
+ * samples per second (all channels), processing DMA blocks of random samples
+ * for several instruction sets
+ */
+class ChannelStatsBenchmark: public ::testing::Test {
+public:
+	void run(const size_t channels, const size_t segmentSamples,
+			 const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+
+		std::mt19937 gen(2718);
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::int16_t> block(BLOCK_ELEMENTS * 4);
+		for (auto &v : block) {
+			v = static_cast<std::int16_t>(dist(gen));
+		}
+		const auto words = reinterpret_cast<const std::uint64_t*>(block.data());
+
+		for (const auto &level : levels) {
+			if (level.first > getSIMDLevel()) {
+				continue;
+			}
+			ChannelStatsStage stage(channels, segmentSamples, 16);
+
+			// Warm up
+			for (size_t i = 0; i < BLOCKS / 10; ++i) {
+				stage.process(words, BLOCK_ELEMENTS, level.first);
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < BLOCKS; ++i) {
+				stage.process(words, BLOCK_ELEMENTS, level.first);
+			}
+			const auto end = std::chrono::steady_clock::now();
+
+			const double us =
+				std::chrono::duration<double, std::micro>(end - start).count();
+			const double msps =
+				static_cast<double>(BLOCK_ELEMENTS) * 4 * BLOCKS / us;
+			const std::string id = name + "_" + level.second;
+			std::cout << id << ": " << msps << " MSample/s" << std::endl;
+			RecordProperty(id + "_MSample_s", std::to_string(msps));
+		}
+	}
+
+	static constexpr size_t BLOCK_ELEMENTS = 16384;
+	static constexpr size_t BLOCKS = 2000;
+};
+
+constexpr size_t ChannelStatsBenchmark::BLOCK_ELEMENTS;
+constexpr size_t ChannelStatsBenchmark::BLOCKS;
+
+TEST_F(ChannelStatsBenchmark, Channels1) {
+	run(1, 100000, "Channels1");
+}
+
+TEST_F(ChannelStatsBenchmark, Channels4) {
+	run(4, 10000, "Channels4");
+}
+
+TEST_F(ChannelStatsBenchmark, Channels8_ShortSegments) {
+	run(8, 256, "Channels8_ShortSegments");
+}
+
+TEST_F(ChannelStatsBenchmark, Channels3) {
+	run(3, 10000, "Channels3");
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/envelope.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the envelope builder, in millions of input
+ * samples per second (all channels), processing DMA blocks of random
+ * samples for several instruction sets, and the time to read a zoomed out
+ * view of the whole recording afterwards
+ */
+class EnvelopeBenchmark: public ::testing::Test {
+public:
+	void run(const size_t channels, const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+		const std::string path = ::testing::TempDir() + "envelope_bm.raw";
+
+		std::mt19937 gen(4669);
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::int16_t> block(BLOCK_ELEMENTS * 4);
+		for (auto &v : block) {
+			v = static_cast<std::int16_t>(dist(gen));
+		}
+		const auto words = reinterpret_cast<const std::uint64_t*>(block.data());
+
+		for (const auto &level : levels) {
+			if (level.first > getSIMDLevel()) {
+				continue;
+			}
+			const std::string id = name + "_" + level.second;
+			{
+				EnvelopeBuilder builder(path, channels);
+
+				// Warm up
+				for (size_t i = 0; i < BLOCKS / 10; ++i) {
+					builder.process(words, BLOCK_ELEMENTS, level.first);
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < BLOCKS; ++i) {
+					builder.process(words, BLOCK_ELEMENTS, level.first);
+				}
+				const auto end = std::chrono::steady_clock::now();
+
+				const double us =
+					std::chrono::duration<double, std::micro>(end - start)
+						.count();
+				const double msps =
+					static_cast<double>(BLOCK_ELEMENTS) * 4 * BLOCKS / us;
+				std::cout << id << ": " << msps << " MSample/s" << std::endl;
+				RecordProperty(id + "_MSample_s", std::to_string(msps));
+			}
+
+			// View of the whole recording, 1000 points wide
+			EnvelopeReader reader(path);
+			std::vector<EnvelopePoint> points;
+			std::uint64_t first;
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t c = 0; c < channels; ++c) {
+				reader.read(c, 0, reader.getSamples(), 1000, &points, &first);
+			}
+			const auto end = std::chrono::steady_clock::now();
+			const double us =
+				std::chrono::duration<double, std::micro>(end - start).count() /
+				channels;
+			std::cout << id << ": " << us << " us/view of "
+					  << reader.getSamples() << " samples" << std::endl;
+			RecordProperty(id + "_us_view", std::to_string(us));
+		}
+
+		std::remove(EnvelopeBuilder::getDescriptorPath(path).c_str());
+		for (const auto decimation : {16, 256, 4096}) {
+			std::remove(
+				EnvelopeBuilder::getLevelPath(path, decimation).c_str());
+		}
+	}
+
+	static constexpr size_t BLOCK_ELEMENTS = 16384;
+	static constexpr size_t BLOCKS = 2000;
+};
+
+constexpr size_t EnvelopeBenchmark::BLOCK_ELEMENTS;
+constexpr size_t EnvelopeBenchmark::BLOCKS;
+
+TEST_F(EnvelopeBenchmark, Channels1) {
+	run(1, "Channels1");
+}
+
+TEST_F(EnvelopeBenchmark, Channels4) {
+	run(4, "Channels4");
+}
+
+TEST_F(EnvelopeBenchmark, Channels8) {
+	run(8, "Channels8");
+}
+
+TEST_F(EnvelopeBenchmark, Channels3) {
+	run(3, "Channels3");
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/daqLayout.h"
+#include "daq/firFilter.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the FIR filter stage, in millions of input
+ * samples per second (all channels), including the deinterleaving of the
+ * DMA blocks, for several filter lengths, instruction sets and threads.
+ */
+class FIRFilterBenchmark: public ::testing::Test {
+public:
+	double msamplesPerSecond(FIRFilterStage &stage, const size_t channels,
+							 const SIMDLevel level) {
+		std::mt19937 gen(4321);
+		std::vector<std::uint64_t> words(BLOCK_SAMPLES * channels / 4);
+		for (auto &w : words) {
+			w = (static_cast<std::uint64_t>(gen()) << 32) | gen();
+		}
+
+		std::vector<std::vector<std::int16_t>> in(
+			channels, std::vector<std::int16_t>(BLOCK_SAMPLES));
+		std::vector<std::vector<float>> out(
+			channels, std::vector<float>(BLOCK_SAMPLES));
+		std::vector<std::int16_t*> inPointers;
+		std::vector<float*> outPointers;
+		for (size_t c = 0; c < channels; ++c) {
+			inPointers.push_back(in[c].data());
+			outPointers.push_back(out[c].data());
+		}
+
+		const auto run = [&]() {
+			deinterleave(words.data(), BLOCK_SAMPLES, channels,
+						 inPointers.data(), level);
+			stage.process(inPointers.data(), BLOCK_SAMPLES,
+						  outPointers.data(), level);
+		};
+
+		// Warm up
+		for (size_t i = 0; i < BLOCKS / 10; ++i) {
+			run();
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < BLOCKS; ++i) {
+			run();
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		const double us =
+			std::chrono::duration<double, std::micro>(end - start).count();
+		return static_cast<double>(BLOCK_SAMPLES) * channels * BLOCKS / us;
+	}
+
+	void run(const size_t channels, const size_t taps,
+			 const size_t decimation, const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+		const auto h = designLowPass(taps, 0.4 / decimation);
+
+		for (const unsigned threads : {1u, 4u}) {
+			for (const auto &level : levels) {
+				if (level.first > getSIMDLevel()) {
+					continue;
+				}
+				FIRFilterStage stage(channels, h, decimation, threads);
+				const double msps = msamplesPerSecond(stage, channels,
+													  level.first);
+				const std::string id = name + "_" + level.second + "_" +
+									   std::to_string(threads) + "T";
+				std::cout << id << ": " << msps << " MSample/s" << std::endl;
+				RecordProperty(id + "_MSample_s", std::to_string(msps));
+			}
+		}
+	}
+
+	static constexpr size_t BLOCK_SAMPLES = 8192;
+	static constexpr size_t BLOCKS = 100;
+};
+
+constexpr size_t FIRFilterBenchmark::BLOCK_SAMPLES;
+constexpr size_t FIRFilterBenchmark::BLOCKS;
+
+TEST_F(FIRFilterBenchmark, Channels4_Taps32) {
+	run(4, 32, 1, "Channels4_Taps32");
+}
+
+TEST_F(FIRFilterBenchmark, Channels4_Taps128) {
+	run(4, 128, 1, "Channels4_Taps128");
+}
+
+TEST_F(FIRFilterBenchmark, Channels8_Taps64_Decimation8) {
+	run(8, 64, 8, "Channels8_Taps64_Decimation8");
+}
+
+TEST_F(FIRFilterBenchmark, Channels16_Taps256) {
+	run(16, 256, 1, "Channels16_Taps256");
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "imaq/flatField.h"
+
+using namespace irio::imaq;
+
+/**
+ * Measures the throughput of the dark and flat-field correction, fused with
+ * the unpacking, for common sensor sizes, instruction sets and threads.
+ */
+class FlatFieldBenchmark: public ::testing::Test {
+public:
+	double mpixelsPerSecond(const FlatFieldStage &stage, const size_t pixels,
+							const SIMDLevel level) {
+		std::vector<std::uint64_t> words(stage.getFrameWords());
+		for (size_t i = 0; i < words.size(); ++i) {
+			words[i] = i * 0x9E3779B97F4A7C15ULL;
+		}
+		std::vector<std::uint16_t> image(pixels);
+
+		// Warm up
+		for (size_t i = 0; i < ITERATIONS / 10; ++i) {
+			stage.process(words.data(), image.data(), level);
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < ITERATIONS; ++i) {
+			stage.process(words.data(), image.data(), level);
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		const double us =
+			std::chrono::duration<double, std::micro>(end - start).count();
+		return pixels * ITERATIONS / us;
+	}
+
+	void run(const size_t width, const size_t height,
+			 const PixelFormat format, const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+
+		const size_t pixels = width * height;
+		std::vector<std::uint16_t> dark(pixels), flat(pixels);
+		for (size_t i = 0; i < pixels; ++i) {
+			dark[i] = 100 + i % 7;
+			flat[i] = 2000 + i % 101;
+		}
+
+		for (const unsigned threads : {1u, 4u}) {
+			FlatFieldStage stage(width, height, format, dark, flat, threads);
+			for (const auto &level : levels) {
+				if (level.first > getSIMDLevel()) {
+					continue;
+				}
+				const double mpx = mpixelsPerSecond(stage, pixels, level.first);
+				const std::string id = name + "_" + level.second + "_" +
+									   std::to_string(threads) + "T";
+				std::cout << id << ": " << mpx << " MPixel/s" << std::endl;
+				RecordProperty(id + "_MPixel_s", std::to_string(mpx));
+			}
+		}
+	}
+
+	static constexpr size_t ITERATIONS = 50;
+};
+
+constexpr size_t FlatFieldBenchmark::ITERATIONS;
+
+TEST_F(FlatFieldBenchmark, Mono12p_1024x1024) {
+	run(1024, 1024, PixelFormat::Mono12p, "Mono12p_1024x1024");
+}
+
+TEST_F(FlatFieldBenchmark, Mono16_2048x2048) {
+	run(2048, 2048, PixelFormat::Mono16, "Mono16_2048x2048");
+}
+
+TEST_F(FlatFieldBenchmark, Mono12p_2560x2160) {
+	run(2560, 2160, PixelFormat::Mono12p, "Mono12p_2560x2160");
+}
+
+TEST_F(FlatFieldBenchmark, Mono16_4096x3072) {
+	run(4096, 3072, PixelFormat::Mono16, "Mono16_4096x3072");
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "imaq/frameCodec.h"
+
+using namespace irio::imaq;
+
+/**
+ * Measures the compression ratio and the compression and decompression
+ * throughput of the lossless frame codec, in MB/s of unpacked image.
+ *
+ * Recorded frames can be measured too, setting the environment variables
+ * codecFramesFile (raw file of 16 bits pixels, frame after frame),
+ * codecFramesWidth, codecFramesHeight and codecFramesBits (10, 12 or 16).
+ */
+class FrameCodecBenchmark: public ::testing::Test {
+public:
+	/**
+	 * Smooth scene with a moving spot and shot noise
+	 */
+	std::vector<std::uint16_t> syntheticFrames(const size_t width,
+											   const size_t height,
+											   const unsigned bits,
+											   const size_t frames) {
+		const double maxValue = (1u << bits) - 1;
+		std::mt19937 gen(1234);
+		std::normal_distribution<double> noise(0, 1);
+		std::vector<std::uint16_t> pixels(width * height * frames);
+		for (size_t f = 0; f < frames; ++f) {
+			const double cx = width * (0.3 + 0.05 * f);
+			const double cy = height * 0.5;
+			for (size_t y = 0; y < height; ++y) {
+				for (size_t x = 0; x < width; ++x) {
+					const double r2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+					const double signal =
+						maxValue * (0.1 + 0.02 * y / height +
+									0.6 * std::exp(-r2 / (width * 20.0)));
+					const double value =
+						signal + std::sqrt(signal) * 0.05 * noise(gen);
+					pixels[(f * height + y) * width + x] =
+						static_cast<std::uint16_t>(
+							std::min(std::max(value, 0.0), maxValue));
+				}
+			}
+		}
+		return pixels;
+	}
+
+	void run(const std::vector<std::uint16_t> &pixels, const size_t width,
+			 const size_t height, const PixelFormat format,
+			 const std::string &name) {
+		const size_t framePixels = width * height;
+		const size_t frames = pixels.size() / framePixels;
+		const double rawMB = frames * framePixels * 2 / 1e6;
+
+		for (const unsigned threads : {1u, 4u}) {
+			FrameCodec codec(width, height, format, threads);
+			std::vector<std::uint8_t> data(codec.getMaxCompressedSize() *
+										   frames);
+			std::vector<size_t> sizes(frames);
+			std::vector<std::uint16_t> image(framePixels);
+
+			auto start = std::chrono::steady_clock::now();
+			size_t compressed = 0;
+			for (size_t f = 0; f < frames; ++f) {
+				sizes[f] = codec.compress(pixels.data() + f * framePixels,
+										  data.data() + compressed);
+				compressed += sizes[f];
+			}
+			const double compressUs = std::chrono::duration<double, std::micro>(
+				std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			size_t offset = 0;
+			for (size_t f = 0; f < frames; ++f) {
+				codec.decompress(data.data() + offset, sizes[f], image.data());
+				offset += sizes[f];
+			}
+			const double decompressUs =
+				std::chrono::duration<double, std::micro>(
+					std::chrono::steady_clock::now() - start).count();
+
+			// Ratio against the bits of the pixels, not the 16 bits containers
+			const double ratio = frames * framePixels *
+								 getPixelDepth(format) / 8.0 / compressed;
+			const std::string id = name + "_" + std::to_string(threads) + "T";
+			std::cout << id << ": ratio " << ratio << ", compress "
+					  << rawMB / compressUs * 1e6 << " MB/s, decompress "
+					  << rawMB / decompressUs * 1e6 << " MB/s" << std::endl;
+			RecordProperty(id + "_ratio", std::to_string(ratio));
+			RecordProperty(id + "_compress_MB_s",
+						   std::to_string(rawMB / compressUs * 1e6));
+			RecordProperty(id + "_decompress_MB_s",
+						   std::to_string(rawMB / decompressUs * 1e6));
+		}
+	}
+
+	static constexpr size_t FRAMES = 8;
+};
+
+constexpr size_t FrameCodecBenchmark::FRAMES;
+
+TEST_F(FrameCodecBenchmark, SyntheticMono12_2048x2048) {
+	run(syntheticFrames(2048, 2048, 12, FRAMES), 2048, 2048,
+		PixelFormat::Mono12, "SyntheticMono12_2048x2048");
+}
+
+TEST_F(FrameCodecBenchmark, SyntheticMono16_2560x2160) {
+	run(syntheticFrames(2560, 2160, 16, FRAMES), 2560, 2160,
+		PixelFormat::Mono16, "SyntheticMono16_2560x2160");
+}
+
+TEST_F(FrameCodecBenchmark, RecordedFrames) {
+	const char *file = std::getenv("codecFramesFile");
+	const char *width = std::getenv("codecFramesWidth");
+	const char *height = std::getenv("codecFramesHeight");
+	const char *bits = std::getenv("codecFramesBits");
+	if (!file || !width || !height || !bits) {
+		std::cout << "Set codecFramesFile, codecFramesWidth, "
+					 "codecFramesHeight and codecFramesBits to measure "
+					 "recorded frames" << std::endl;
+		return;
+	}
+
+	const size_t w = std::stoul(width);
+	const size_t h = std::stoul(height);
+	const unsigned depth = std::stoul(bits);
+	const PixelFormat format = depth == 10	 ? PixelFormat::Mono10
+							   : depth == 12 ? PixelFormat::Mono12
+											 : PixelFormat::Mono16;
+
+	std::ifstream in(file, std::ios::binary | std::ios::ate);
+	ASSERT_TRUE(in.good()) << "Unable to open " << file;
+	const size_t frames = in.tellg() / (w * h * 2);
+	ASSERT_GT(frames, 0);
+	std::vector<std::uint16_t> pixels(frames * w * h);
+	in.seekg(0);
+	in.read(reinterpret_cast<char*>(pixels.data()), pixels.size() * 2);
+	run(pixels, w, h, format, "Recorded");
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "daq/histogram.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the histograms, in millions of values per
+ * second (all channels and threads), adding raw samples for several
+ * instruction sets and numbers of threads, each with its own accumulator,
+ * and adding pulse amplitudes.
+ */
+class HistogramBenchmark: public ::testing::Test {
+public:
+	void runSamples(const size_t channels, const size_t bins,
+					const unsigned shift, const size_t threads,
+					const bool constant, const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+
+		// Gaussian noise, or a constant value where every sample falls in
+		// the same bin
+		std::mt19937 gen(2468);
+		std::normal_distribution<double> dist(0, 3000);
+		std::vector<std::vector<std::int16_t>> in(
+			channels, std::vector<std::int16_t>(BLOCK_SAMPLES, 1234));
+		std::vector<const std::int16_t*> inputs;
+		for (auto &channel : in) {
+			if (!constant) {
+				for (auto &v : channel) {
+					v = static_cast<std::int16_t>(dist(gen));
+				}
+			}
+			inputs.push_back(channel.data());
+		}
+
+		for (const auto &level : levels) {
+			if (level.first > getSIMDLevel()) {
+				continue;
+			}
+			MCAHistogram histogram(channels, bins, -32768, shift);
+			const auto work = [&](const size_t blocks) {
+				MCAHistogram::Accumulator accumulator(&histogram);
+				for (size_t i = 0; i < blocks; ++i) {
+					accumulator.addSamples(inputs.data(), BLOCK_SAMPLES,
+										   level.first);
+				}
+			};
+
+			// Warm up
+			work(BLOCKS / 10);
+
+			const auto start = std::chrono::steady_clock::now();
+			std::vector<std::thread> workers;
+			for (size_t t = 1; t < threads; ++t) {
+				workers.emplace_back(work, BLOCKS);
+			}
+			work(BLOCKS);
+			for (auto &worker : workers) {
+				worker.join();
+			}
+			const auto end = std::chrono::steady_clock::now();
+
+			const double us =
+				std::chrono::duration<double, std::micro>(end - start).count();
+			const double msps = static_cast<double>(BLOCK_SAMPLES) * BLOCKS *
+								channels * threads / us;
+			const std::string id = name + "_" + level.second;
+			std::cout << id << ": " << msps << " MSample/s" << std::endl;
+			RecordProperty(id + "_MSample_s", std::to_string(msps));
+		}
+	}
+
+	static constexpr size_t BLOCK_SAMPLES = 65536;
+	static constexpr size_t BLOCKS = 100;
+};
+
+constexpr size_t HistogramBenchmark::BLOCK_SAMPLES;
+constexpr size_t HistogramBenchmark::BLOCKS;
+
+TEST_F(HistogramBenchmark, Channels4_Bins65536_Threads1) {
+	runSamples(4, 65536, 0, 1, false, "Channels4_Bins65536_Threads1");
+}
+
+TEST_F(HistogramBenchmark, Channels4_Bins1024_Threads1) {
+	runSamples(4, 1024, 6, 1, false, "Channels4_Bins1024_Threads1");
+}
+
+TEST_F(HistogramBenchmark, Channels4_Bins1024_Threads4) {
+	runSamples(4, 1024, 6, 4, false, "Channels4_Bins1024_Threads4");
+}
+
+TEST_F(HistogramBenchmark, Channels4_Bins1024_Constant) {
+	runSamples(4, 1024, 6, 1, true, "Channels4_Bins1024_Constant");
+}
+
+TEST_F(HistogramBenchmark, Pulses) {
+	const size_t channels = 8, pulses = 4096;
+	std::mt19937 gen(1357);
+	std::uniform_int_distribution<int> amplitude(0, 32767);
+	std::vector<Pulse> block(pulses);
+	for (size_t p = 0; p < pulses; ++p) {
+		block[p].channel = p % channels;
+		block[p].amplitude = amplitude(gen);
+	}
+
+	MCAHistogram histogram(channels, 4096, 0, 3);
+	MCAHistogram::Accumulator accumulator(&histogram);
+	for (size_t i = 0; i < BLOCKS; ++i) {
+		accumulator.addPulses(block);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < BLOCKS * 10; ++i) {
+		accumulator.addPulses(block);
+	}
+	const auto end = std::chrono::steady_clock::now();
+
+	const double us =
+		std::chrono::duration<double, std::micro>(end - start).count();
+	const double rate = static_cast<double>(pulses) * BLOCKS * 10 / us * 1e6;
+	std::cout << "Pulses: " << rate << " pulses/s" << std::endl;
+	RecordProperty("Pulses_s", std::to_string(rate));
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "imaq/pixelUnpack.h"
+
+using namespace irio::imaq;
+
+/**
+ * Measures the throughput of the pixel unpacking kernels for a 2048x2048
+ * frame, for each pixel format and instruction set.
+ */
+class PixelUnpackBenchmark: public ::testing::Test {
+public:
+	double mpixelsPerSecond(const PixelFormat format, const SIMDLevel level) {
+		std::vector<std::uint64_t> words(getFrameWords(format, PIXELS));
+		for (size_t i = 0; i < words.size(); ++i) {
+			words[i] = i * 0x9E3779B97F4A7C15ULL;
+		}
+
+		// Warm up
+		for (size_t i = 0; i < ITERATIONS / 10; ++i) {
+			unpackFrame(words.data(), PIXELS, format, image.data(), level);
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < ITERATIONS; ++i) {
+			unpackFrame(words.data(), PIXELS, format, image.data(), level);
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		const double us =
+			std::chrono::duration<double, std::micro>(end - start).count();
+		return PIXELS * ITERATIONS / us;
+	}
+
+	void run(const PixelFormat format, const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+
+		for (const auto &level : levels) {
+			if (level.first > getSIMDLevel()) {
+				continue;
+			}
+			const double mpx = mpixelsPerSecond(format, level.first);
+			std::cout << name << " " << level.second << ": " << mpx
+					  << " MPixel/s" << std::endl;
+			RecordProperty(name + "_" + level.second + "_MPixel_s",
+						   std::to_string(mpx));
+		}
+	}
+
+	static constexpr size_t PIXELS = 2048 * 2048;
+	static constexpr size_t ITERATIONS = 200;
+
+	std::vector<std::uint16_t> image = std::vector<std::uint16_t>(PIXELS);
+};
+
+constexpr size_t PixelUnpackBenchmark::PIXELS;
+constexpr size_t PixelUnpackBenchmark::ITERATIONS;
+
+TEST_F(PixelUnpackBenchmark, Mono8) {
+	run(PixelFormat::Mono8, "Mono8");
+}
+
+TEST_F(PixelUnpackBenchmark, Mono12) {
+	run(PixelFormat::Mono12, "Mono12");
+}
+
+TEST_F(PixelUnpackBenchmark, Mono16) {
+	run(PixelFormat::Mono16, "Mono16");
+}
+
+TEST_F(PixelUnpackBenchmark, Mono10p) {
+	run(PixelFormat::Mono10p, "Mono10p");
+}
+
+TEST_F(PixelUnpackBenchmark, Mono12p) {
+	run(PixelFormat::Mono12p, "Mono12p");
+}
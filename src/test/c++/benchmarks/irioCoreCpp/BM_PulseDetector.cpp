@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/pulseDetector.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the pulse detector, in millions of input
+ * samples per second (all channels) and pulses per second, for several
+ * pulse rates and instruction sets. At low rates the cost is the scan of
+ * the baseline; at high rates, the measurement of the pulses.
+ */
+class PulseDetectorBenchmark: public ::testing::Test {
+public:
+	void run(const size_t channels, const size_t pulseSpacing,
+			 const size_t preSamples, const size_t postSamples,
+			 const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+
+		// Noisy baseline with a 40 samples pulse every pulseSpacing samples
+		std::mt19937 gen(1357);
+		std::uniform_int_distribution<int> noise(-30, 30);
+		std::vector<std::vector<std::int16_t>> in(
+			channels, std::vector<std::int16_t>(BLOCK_SAMPLES));
+		std::vector<const std::int16_t*> inputs;
+		for (auto &channel : in) {
+			for (size_t n = 0; n < BLOCK_SAMPLES; ++n) {
+				const double t = static_cast<double>(n % pulseSpacing);
+				const double pulse =
+					t < 40 ? 5000 * std::sin(M_PI * t / 40) : 0;
+				channel[n] = static_cast<std::int16_t>(noise(gen) + pulse);
+			}
+			inputs.push_back(channel.data());
+		}
+		const std::vector<PulseDetectorConfig> configs(
+			channels, {PulseTrigger::Threshold, PulsePolarity::Positive, 0, 500,
+					   300, 0, preSamples, postSamples});
+
+		for (const auto &level : levels) {
+			if (level.first > getSIMDLevel()) {
+				continue;
+			}
+			PulseDetectorStage stage(configs);
+
+			// Warm up
+			for (size_t i = 0; i < BLOCKS / 10; ++i) {
+				stage.process(inputs.data(), BLOCK_SAMPLES, level.first);
+			}
+
+			const std::uint64_t detected = stage.getDetected();
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < BLOCKS; ++i) {
+				stage.process(inputs.data(), BLOCK_SAMPLES, level.first);
+			}
+			const auto end = std::chrono::steady_clock::now();
+
+			const double us =
+				std::chrono::duration<double, std::micro>(end - start).count();
+			const double msps =
+				static_cast<double>(BLOCK_SAMPLES) * BLOCKS * channels / us;
+			const double pulses =
+				static_cast<double>(stage.getDetected() - detected) / us * 1e6;
+			const std::string id = name + "_" + level.second;
+			std::cout << id << ": " << msps << " MSample/s, " << pulses
+					  << " pulses/s" << std::endl;
+			RecordProperty(id + "_MSample_s", std::to_string(msps));
+			RecordProperty(id + "_Pulses_s", std::to_string(pulses));
+		}
+	}
+
+	static constexpr size_t BLOCK_SAMPLES = 65536;
+	static constexpr size_t BLOCKS = 100;
+};
+
+constexpr size_t PulseDetectorBenchmark::BLOCK_SAMPLES;
+constexpr size_t PulseDetectorBenchmark::BLOCKS;
+
+TEST_F(PulseDetectorBenchmark, Channels4_Spacing10000) {
+	run(4, 10000, 0, 0, "Channels4_Spacing10000");
+}
+
+TEST_F(PulseDetectorBenchmark, Channels4_Spacing1000) {
+	run(4, 1000, 0, 0, "Channels4_Spacing1000");
+}
+
+TEST_F(PulseDetectorBenchmark, Channels4_Spacing100) {
+	run(4, 100, 0, 0, "Channels4_Spacing100");
+}
+
+TEST_F(PulseDetectorBenchmark, Channels4_Spacing1000_Waveforms) {
+	run(4, 1000, 32, 64, "Channels4_Spacing1000_Waveforms");
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/recording.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the recorder, in millions of samples per second
+ * (all channels), writing DMA blocks of random samples to a file with and
+ * without envelopes, and the time to find and return a range of time of the
+ * recording afterwards
+ */
+class RecordingBenchmark: public ::testing::Test {
+public:
+	void run(const size_t channels, const std::vector<size_t> &envelopes,
+			 const std::string &id) {
+		const std::string path = ::testing::TempDir() + "recording_bm.raw";
+
+		std::mt19937 gen(5387);
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::int16_t> block(BLOCK_ELEMENTS * 4);
+		for (auto &v : block) {
+			v = static_cast<std::int16_t>(dist(gen));
+		}
+		const auto words = reinterpret_cast<const std::uint64_t*>(block.data());
+
+		{
+			DAQRecorder recorder(path, channels, envelopes);
+
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < BLOCKS; ++i) {
+				recorder.record(words, BLOCK_ELEMENTS,
+								static_cast<std::int64_t>(i * 1000));
+			}
+			recorder.close();
+			const auto end = std::chrono::steady_clock::now();
+
+			const double us =
+				std::chrono::duration<double, std::micro>(end - start).count();
+			const double msps =
+				static_cast<double>(BLOCK_ELEMENTS) * 4 * BLOCKS / us;
+			std::cout << id << ": " << msps << " MSample/s, "
+					  << msps * 2 / 1000 << " GB/s" << std::endl;
+			RecordProperty(id + "_MSample_s", std::to_string(msps));
+		}
+
+		// Ranges of 10 blocks at random times of the recording
+		RecordingReader reader(path);
+		std::uniform_int_distribution<std::int64_t> time(0, BLOCKS * 1000);
+		std::vector<ChannelSpan> spans;
+		std::int64_t checksum = 0;
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < QUERIES; ++i) {
+			const std::int64_t first = time(gen);
+			reader.getTimeRange(first, first + 10000, {0}, &spans);
+			if (spans[0].samples > 0) {
+				checksum += spans[0][spans[0].samples - 1];
+			}
+		}
+		const auto end = std::chrono::steady_clock::now();
+		const double us =
+			std::chrono::duration<double, std::micro>(end - start).count() /
+			QUERIES;
+		std::cout << id << ": " << us << " us/query of "
+				  << reader.getBlocks() << " blocks (" << checksum << ")"
+				  << std::endl;
+		RecordProperty(id + "_us_query", std::to_string(us));
+
+		std::remove(path.c_str());
+		std::remove(DAQRecorder::getIndexPath(path).c_str());
+		std::remove(EnvelopeBuilder::getDescriptorPath(path).c_str());
+		for (const auto decimation : envelopes) {
+			std::remove(
+				EnvelopeBuilder::getLevelPath(path, decimation).c_str());
+		}
+	}
+
+	static constexpr size_t BLOCK_ELEMENTS = 16384;
+	static constexpr size_t BLOCKS = 2000;
+	static constexpr size_t QUERIES = 100000;
+};
+
+constexpr size_t RecordingBenchmark::BLOCK_ELEMENTS;
+constexpr size_t RecordingBenchmark::BLOCKS;
+constexpr size_t RecordingBenchmark::QUERIES;
+
+TEST_F(RecordingBenchmark, Channels4) {
+	run(4, {}, "Channels4");
+}
+
+TEST_F(RecordingBenchmark, Channels4Envelopes) {
+	run(4, {16, 256, 4096}, "Channels4Envelopes");
+}
+
+TEST_F(RecordingBenchmark, Channels8Envelopes) {
+	run(8, {16, 256, 4096}, "Channels8Envelopes");
+}
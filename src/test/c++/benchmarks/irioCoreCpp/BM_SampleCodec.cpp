@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/sampleCodec.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the compression ratio and the compression and decompression
+ * throughput of the DAQ sample codec, in GB/s of DMA words, for several
+ * instruction sets and threads.
+ *
+ * Recorded blocks can be measured too, setting the environment variables
+ * codecSamplesFile (raw file of DMA words, as written by
+ * irio::daq::DAQRecorder) and codecSamplesChannels.
+ */
+class SampleCodecBenchmark: public ::testing::Test {
+public:
+	/**
+	 * Slow-varying channels with \p noise counts of noise
+	 */
+	std::vector<std::uint64_t> syntheticBlock(const size_t channels,
+											  const double noise) {
+		std::mt19937 gen(2468);
+		std::normal_distribution<double> dist(0, noise);
+		std::vector<std::uint64_t> words(BLOCK_ELEMENTS * BLOCKS);
+		auto values = reinterpret_cast<std::int16_t*>(words.data());
+		for (size_t i = 0; i < words.size() * 4; ++i) {
+			const size_t c = i % channels;
+			const double value =
+				10000 * std::sin(i / channels / (500.0 + 100 * c)) + dist(gen);
+			values[i] = static_cast<std::int16_t>(
+				std::min(std::max(value, -32768.0), 32767.0));
+		}
+		return words;
+	}
+
+	void run(const std::vector<std::uint64_t> &words, const size_t channels,
+			 const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+		const size_t blocks = words.size() / BLOCK_ELEMENTS;
+		const double rawGB = blocks * BLOCK_ELEMENTS * 8 / 1e9;
+
+		for (const unsigned threads : {1u, 4u}) {
+			for (const auto &level : levels) {
+				if (level.first > getSIMDLevel()) {
+					continue;
+				}
+				SampleCodec codec(channels, threads);
+				const size_t slot = codec.getMaxCompressedSize(BLOCK_ELEMENTS);
+				std::vector<std::uint8_t> data(slot * blocks);
+				std::vector<size_t> sizes(blocks);
+				std::vector<std::uint64_t> out(BLOCK_ELEMENTS);
+
+				auto start = std::chrono::steady_clock::now();
+				size_t compressed = 0;
+				for (size_t b = 0; b < blocks; ++b) {
+					sizes[b] = codec.compress(
+						words.data() + b * BLOCK_ELEMENTS, BLOCK_ELEMENTS,
+						data.data() + b * slot, level.first);
+					compressed += sizes[b];
+				}
+				const double compressUs =
+					std::chrono::duration<double, std::micro>(
+						std::chrono::steady_clock::now() - start).count();
+
+				start = std::chrono::steady_clock::now();
+				for (size_t b = 0; b < blocks; ++b) {
+					codec.decompress(data.data() + b * slot, sizes[b],
+									 out.data(), level.first);
+				}
+				const double decompressUs =
+					std::chrono::duration<double, std::micro>(
+						std::chrono::steady_clock::now() - start).count();
+
+				const double ratio =
+					static_cast<double>(blocks * BLOCK_ELEMENTS * 8) /
+					compressed;
+				const std::string id = name + "_" + level.second + "_" +
+									   std::to_string(threads) + "T";
+				std::cout << id << ": ratio " << ratio << ", compress "
+						  << rawGB / compressUs * 1e6 << " GB/s, decompress "
+						  << rawGB / decompressUs * 1e6 << " GB/s"
+						  << std::endl;
+				RecordProperty(id + "_ratio", std::to_string(ratio));
+				RecordProperty(id + "_compress_GB_s",
+							   std::to_string(rawGB / compressUs * 1e6));
+				RecordProperty(id + "_decompress_GB_s",
+							   std::to_string(rawGB / decompressUs * 1e6));
+			}
+		}
+	}
+
+	static constexpr size_t BLOCK_ELEMENTS = 16384;
+	static constexpr size_t BLOCKS = 200;
+};
+
+constexpr size_t SampleCodecBenchmark::BLOCK_ELEMENTS;
+constexpr size_t SampleCodecBenchmark::BLOCKS;
+
+TEST_F(SampleCodecBenchmark, SlowChannels4) {
+	run(syntheticBlock(4, 2), 4, "SlowChannels4");
+}
+
+TEST_F(SampleCodecBenchmark, NoisyChannels4) {
+	run(syntheticBlock(4, 300), 4, "NoisyChannels4");
+}
+
+TEST_F(SampleCodecBenchmark, SlowChannels8) {
+	run(syntheticBlock(8, 2), 8, "SlowChannels8");
+}
+
+TEST_F(SampleCodecBenchmark, RecordedBlocks) {
+	const char *file = std::getenv("codecSamplesFile");
+	const char *channels = std::getenv("codecSamplesChannels");
+	if (!file || !channels) {
+		std::cout << "Set codecSamplesFile and codecSamplesChannels to "
+					 "measure recorded blocks" << std::endl;
+		return;
+	}
+
+	std::ifstream in(file, std::ios::binary | std::ios::ate);
+	ASSERT_TRUE(in.good()) << "Unable to open " << file;
+	const size_t blocks = in.tellg() / (BLOCK_ELEMENTS * 8);
+	ASSERT_GT(blocks, 0);
+	std::vector<std::uint64_t> words(blocks * BLOCK_ELEMENTS);
+	in.seekg(0);
+	in.read(reinterpret_cast<char*>(words.data()), words.size() * 8);
+	run(words, std::stoul(channels), "Recorded");
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/spectrum.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the spectral stage, in millions of input
+ * samples per second (all channels) and in FFTs per second, for several FFT
+ * sizes, instruction sets and threads.
+ */
+class SpectrumBenchmark: public ::testing::Test {
+public:
+	void run(const size_t channels, const size_t fftSize, const size_t hop,
+			 const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+
+		std::mt19937 gen(2468);
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::vector<std::int16_t>> in(
+			channels, std::vector<std::int16_t>(BLOCK_SAMPLES));
+		std::vector<const std::int16_t*> inputs;
+		for (auto &channel : in) {
+			for (auto &v : channel) {
+				v = static_cast<std::int16_t>(dist(gen));
+			}
+			inputs.push_back(channel.data());
+		}
+
+		for (const unsigned threads : {1u, 4u}) {
+			for (const auto &level : levels) {
+				if (level.first > getSIMDLevel()) {
+					continue;
+				}
+				SpectrumStage stage(channels, fftSize, hop, 10,
+									SpectrumWindow::Hann, threads);
+
+				// Warm up
+				for (size_t i = 0; i < BLOCKS / 10; ++i) {
+					stage.process(inputs.data(), BLOCK_SAMPLES, level.first);
+				}
+				stage.reset();
+
+				const auto start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < BLOCKS; ++i) {
+					stage.process(inputs.data(), BLOCK_SAMPLES, level.first);
+				}
+				const auto end = std::chrono::steady_clock::now();
+
+				const double us =
+					std::chrono::duration<double, std::micro>(end - start)
+						.count();
+				const double samples =
+					static_cast<double>(BLOCK_SAMPLES) * BLOCKS;
+				const double msps = samples * channels / us;
+				const double ffts =
+					(samples - fftSize) / hop * channels / us * 1e6;
+				const std::string id = name + "_" + level.second + "_" +
+									   std::to_string(threads) + "T";
+				std::cout << id << ": " << msps << " MSample/s, " << ffts
+						  << " FFT/s" << std::endl;
+				RecordProperty(id + "_MSample_s", std::to_string(msps));
+				RecordProperty(id + "_FFT_s", std::to_string(ffts));
+			}
+		}
+	}
+
+	static constexpr size_t BLOCK_SAMPLES = 65536;
+	static constexpr size_t BLOCKS = 40;
+};
+
+constexpr size_t SpectrumBenchmark::BLOCK_SAMPLES;
+constexpr size_t SpectrumBenchmark::BLOCKS;
+
+TEST_F(SpectrumBenchmark, Channels4_FFT1024_Overlap50) {
+	run(4, 1024, 512, "Channels4_FFT1024_Overlap50");
+}
+
+TEST_F(SpectrumBenchmark, Channels4_FFT8192) {
+	run(4, 8192, 8192, "Channels4_FFT8192");
+}
+
+TEST_F(SpectrumBenchmark, Channels16_FFT65536) {
+	run(16, 65536, 65536, "Channels16_FFT65536");
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/triggeredCapture.h"
+
+using namespace irio::daq;
+
+/**
+ * Measures the throughput of the triggered capture, in millions of input
+ * samples per second (all channels), committing blocks with the threshold
+ * trigger armed on a noisy channel for several instruction sets. A crossing
+ * every crossingSpacing samples starts a capture, which is released as soon
+ * as it completes.
+ */
+class TriggeredCaptureBenchmark: public ::testing::Test {
+public:
+	void run(const size_t channels, const size_t crossingSpacing,
+			 const std::string &name) {
+		const std::vector<std::pair<SIMDLevel, std::string>> levels = {
+			{SIMDLevel::Scalar, "Scalar"},
+			{SIMDLevel::SSSE3, "SSSE3"},
+			{SIMDLevel::AVX2, "AVX2"}};
+
+		// Noise below the level with a step above it every crossingSpacing
+		// samples
+		const size_t blockSamples = BLOCK_ELEMENTS * 4 / channels;
+		std::mt19937 gen(1357);
+		std::uniform_int_distribution<int> noise(-30, 30);
+		std::vector<std::int16_t> block(BLOCK_ELEMENTS * 4);
+		for (size_t n = 0; n < blockSamples; ++n) {
+			for (size_t c = 0; c < channels; ++c) {
+				const bool high = n % crossingSpacing >= crossingSpacing / 2;
+				block[n * channels + c] =
+					static_cast<std::int16_t>(noise(gen) + (high ? 2000 : 0));
+			}
+		}
+
+		for (const auto &level : levels) {
+			if (level.first > getSIMDLevel()) {
+				continue;
+			}
+			TriggeredCapture stage(channels, BLOCK_ELEMENTS, blockSamples,
+								   blockSamples);
+			stage.setThresholdTrigger(0, 1000, TriggerEdge::Rising);
+			const auto commit = [&]() {
+				std::memcpy(stage.beginBlock(), block.data(),
+							BLOCK_ELEMENTS * sizeof(std::uint64_t));
+				stage.commitBlock(level.first);
+				Capture capture;
+				while (stage.tryGetCapture(&capture)) {
+					stage.releaseCapture(capture);
+				}
+			};
+
+			// Warm up
+			for (size_t i = 0; i < BLOCKS / 10; ++i) {
+				commit();
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < BLOCKS; ++i) {
+				commit();
+			}
+			const auto end = std::chrono::steady_clock::now();
+
+			const double us =
+				std::chrono::duration<double, std::micro>(end - start).count();
+			const double msps =
+				static_cast<double>(blockSamples) * BLOCKS * channels / us;
+			const std::string id = name + "_" + level.second;
+			std::cout << id << ": " << msps << " MSample/s, "
+					  << stage.getCaptures() << " captures" << std::endl;
+			RecordProperty(id + "_MSample_s", std::to_string(msps));
+		}
+	}
+
+	static constexpr size_t BLOCK_ELEMENTS = 16384;
+	static constexpr size_t BLOCKS = 2000;
+};
+
+constexpr size_t TriggeredCaptureBenchmark::BLOCK_ELEMENTS;
+constexpr size_t TriggeredCaptureBenchmark::BLOCKS;
+
+TEST_F(TriggeredCaptureBenchmark, Channels4_NoCrossings) {
+	run(4, 2 * BLOCK_ELEMENTS * 4, "Channels4_NoCrossings");
+}
+
+TEST_F(TriggeredCaptureBenchmark, Channels4_Crossings) {
+	run(4, 4096, "Channels4_Crossings");
+}
+
+TEST_F(TriggeredCaptureBenchmark, Channels8_NoCrossings) {
+	run(8, 2 * BLOCK_ELEMENTS * 4, "Channels8_NoCrossings");
+}
+
+TEST_F(TriggeredCaptureBenchmark, Channels16_NoCrossings) {
+	// Scanned with the scalar kernel for every instruction set
+	run(16, 2 * BLOCK_ELEMENTS * 4, "Channels16_NoCrossings");
+}
@@ -1,5 +1,6 @@
 #include "fff_nifpga.h"
 #include <string>
+#include <vector>
 #include <platforms.h>
 
 DEFINE_FFF_GLOBALS
@@ -45,6 +46,8 @@ DEFINE_FAKE_NIFPGA_FUNC(NiFpga_ReadArrayU8, NiFpga_Session, uint32_t, uint8_t*,
 DEFINE_FAKE_NIFPGA_FUNC(NiFpga_ReadArrayU16, NiFpga_Session, uint32_t, uint16_t*, size_t);
 
 DEFINE_FAKE_NIFPGA_FUNC(NiFpga_ReadFifoU64, NiFpga_Session, uint32_t, uint64_t*, size_t, uint32_t, size_t*);
+DEFINE_FAKE_NIFPGA_FUNC(NiFpga_AcquireFifoReadElementsU64, NiFpga_Session, uint32_t, uint64_t**, size_t, uint32_t, size_t*, size_t*);
+DEFINE_FAKE_NIFPGA_FUNC(NiFpga_ReleaseFifoElements, NiFpga_Session, uint32_t, size_t);
 
 DEFINE_FAKE_NIFPGA_FUNC(NiFpga_ConfigureFifo, NiFpga_Session, uint32_t, size_t);
 
@@ -184,6 +187,21 @@ void init_ok_fff_nifpga(){
 		return NiFpga_Status_Success;
 	};
 
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = [](NiFpga_Session,
+			uint32_t, uint64_t** elements, size_t elementsRequested, uint32_t,
+			size_t* elementsAcquired, size_t* elementsRemaining) {
+		static std::vector<uint64_t> acquireBuffer;
+		acquireBuffer.assign(elementsRequested, 7);
+		*elements = acquireBuffer.data();
+		if(elementsAcquired)
+			*elementsAcquired = elementsRequested;
+		if(elementsRemaining)
+			*elementsRemaining = 0;
+
+		return NiFpga_Status_Success;
+	};
+	NiFpga_ReleaseFifoElements_fake.return_val = NiFpga_Status_Success;
+
 	NiFpga_ConfigureFifo_fake.return_val = NiFpga_Status_Success;
 	NiFpga_StartFifo_fake.return_val = NiFpga_Status_Success;
 	NiFpga_StopFifo_fake.return_val = NiFpga_Status_Success;
@@ -211,6 +229,8 @@ void reset_fff_nifpga(){
 	RESET_FAKE(NiFpga_ReadArrayU8);
 	RESET_FAKE(NiFpga_ReadArrayU16);
 	RESET_FAKE(NiFpga_ReadFifoU64);
+	RESET_FAKE(NiFpga_AcquireFifoReadElementsU64);
+	RESET_FAKE(NiFpga_ReleaseFifoElements);
 	RESET_FAKE(NiFpga_ConfigureFifo);
 	RESET_FAKE(NiFpga_Run);
 	RESET_FAKE(NiFpga_StartFifo);
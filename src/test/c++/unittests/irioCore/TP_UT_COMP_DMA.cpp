@@ -1,13 +1,19 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
 #include <limits>
+#include <mutex>
+#include <vector>
 #include <NiFpga.h>
 
 #include "fixtures_adapter.h"
 #include "fff_nifpga.h"
 
 #include "bfp.h"
+#include "frameTypes.h"
 #include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMACPUCommon.h"
 #include "terminals/names/namesTerminalsDMADAQCPU.h"
 #include "platforms.h"
 #include "modules.h"
@@ -21,7 +27,7 @@ using namespace irio;
 
 class DMATestsAdapter: public BaseTestsAdapter {
 public:
-	DMATestsAdapter():
+	explicit DMATestsAdapter(const std::uint8_t frameType = 0):
 		BaseTestsAdapter("../../../resources/7966", "FlexRIO_CPUDAQ_7966")
 	{
 		setValueForReg(ReadFunctions::NiFpga_ReadU8,
@@ -32,6 +38,11 @@ public:
 						bfp.getRegister(TERMINAL_DMATTOHOSTBLOCKNWORDS).getAddress(),
 						nwords, sizeof(nwords)/sizeof(std::uint16_t));
 
+		frameTypes[0] = frameType;
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTFRAMETYPE).getAddress(),
+						frameTypes, sizeof(frameTypes)/sizeof(std::uint8_t));
+
 		auto ret = irio_initDriver("test", "0", "TestModel",
 					projectName.c_str(), "V9.9", false,
 					nullptr, bitfileDir.c_str(), &p_DrvPvt, &status);
@@ -58,10 +69,53 @@ public:
 	irioDrv_t p_DrvPvt;
 private:
 	std::uint16_t nwords[1] = {1};
+	std::uint8_t frameTypes[1] = {0};
 };
 
 class ErrorDMATestsAdapter: public DMATestsAdapter {};
 
+class DMAFormatBTestsAdapter: public DMATestsAdapter {
+public:
+	DMAFormatBTestsAdapter():
+		DMATestsAdapter(static_cast<std::uint8_t>(FrameType::FormatB)) {}
+};
+
+struct CallbackRecorder {
+	std::mutex mutex;
+	std::condition_variable cv;
+	int calls = 0;
+	int elementsRead = -1;
+	uint64_t firstWord = 0;
+	bool releaseData = true;
+	void *token = nullptr;
+
+	bool waitCalls(const int expectedCalls) {
+		std::unique_lock<std::mutex> lock(mutex);
+		return cv.wait_for(lock, std::chrono::seconds(5),
+				[this, expectedCalls] { return calls >= expectedCalls; });
+	}
+
+	static void callback(const uint64_t *data, int elementsRead,
+			void *releaseToken, void *userData) {
+		auto recorder = static_cast<CallbackRecorder*>(userData);
+		bool release;
+		{
+			std::lock_guard<std::mutex> lock(recorder->mutex);
+			recorder->calls++;
+			recorder->elementsRead = elementsRead;
+			recorder->firstWord = data ? data[0] : 0;
+			recorder->token = releaseToken;
+			release = recorder->releaseData;
+		}
+		recorder->cv.notify_all();
+		if (release && releaseToken) {
+			TStatus status;
+			irio_initStatus(&status);
+			irio_releaseDMACallbackData(releaseToken, &status);
+		}
+	}
+};
+
 
 ///////////////////////////////////////////////////////////////
 /// DMA Tests
@@ -199,6 +253,117 @@ TEST_F(DMATestsAdapter, getDMATtoHostData_timeout) {
 	EXPECT_EQ(ret, IRIO_success);
 }
 
+TEST_F(DMAFormatBTestsAdapter, getDMATtoHostDataFormatB) {
+	// Blocks of 1 word and 2 timestamp words
+	int32_t elementsRead = 0;
+	uint64_t data[256];
+	const auto ret = irio_getDMATtoHostData_timeout(&p_DrvPvt, 2, 0, data,
+			&elementsRead, 1000, &status);
+
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+	EXPECT_EQ(NiFpga_ReadFifoU64_fake.arg3_val, 6);
+	EXPECT_EQ(elementsRead, 2);
+}
+
+TEST_F(DMATestsAdapter, registerDMACallback) {
+	CallbackRecorder recorder;
+	const auto ret = irio_registerDMACallback(&p_DrvPvt, 0, 2,
+			CallbackRecorder::callback, &recorder, &status);
+
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+
+	ASSERT_TRUE(recorder.waitCalls(2));
+	EXPECT_EQ(recorder.elementsRead, 2);
+	EXPECT_EQ(recorder.firstWord, 7);
+
+	const auto retUnreg = irio_unregisterDMACallback(&p_DrvPvt, 0, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(retUnreg, IRIO_success);
+	EXPECT_GE(NiFpga_ReleaseFifoElements_fake.call_count, 1);
+}
+
+TEST_F(DMATestsAdapter, unregisterDMACallbackReleasesPendingData) {
+	CallbackRecorder recorder;
+	recorder.releaseData = false;
+	irio_registerDMACallback(&p_DrvPvt, 0, 1, CallbackRecorder::callback,
+			&recorder, &status);
+	ASSERT_TRUE(recorder.waitCalls(1));
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.call_count, 0);
+
+	const auto ret = irio_unregisterDMACallback(&p_DrvPvt, 0, &status);
+
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.call_count, 1);
+	EXPECT_EQ(recorder.calls, 1);
+
+	const auto retRelease = irio_releaseDMACallbackData(recorder.token,
+			&status);
+	EXPECT_EQ(retRelease, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ConfigDMA_Warning);
+}
+
+TEST_F(DMATestsAdapter, registerDMACallbackWaitsRestOfWrappedBlock) {
+	// The block wraps around the end of the host buffer and the rest of it
+	// arrives after a timeout
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = [](NiFpga_Session,
+			uint32_t, uint64_t** elements, size_t elementsRequested, uint32_t,
+			size_t* elementsAcquired, size_t* elementsRemaining) {
+		static std::vector<uint64_t> acquireBuffer(2, 7);
+		const auto call = NiFpga_AcquireFifoReadElementsU64_fake.call_count;
+		if (call == 2) {
+			return NiFpga_Status_FifoTimeout;
+		}
+		*elements = acquireBuffer.data();
+		*elementsAcquired = call == 1 ? 1 : elementsRequested;
+		if (elementsRemaining)
+			*elementsRemaining = 0;
+		return NiFpga_Status_Success;
+	};
+
+	CallbackRecorder recorder;
+	irio_registerDMACallback(&p_DrvPvt, 0, 2, CallbackRecorder::callback,
+			&recorder, &status);
+	ASSERT_TRUE(recorder.waitCalls(1));
+	EXPECT_EQ(recorder.elementsRead, 2);
+	EXPECT_EQ(recorder.firstWord, 7);
+	EXPECT_GE(NiFpga_AcquireFifoReadElementsU64_fake.call_count, 3);
+
+	irio_unregisterDMACallback(&p_DrvPvt, 0, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+}
+
+TEST_F(DMATestsAdapter, releaseDMACallbackDataStaleToken) {
+	CallbackRecorder recorder;
+	recorder.releaseData = false;
+	irio_registerDMACallback(&p_DrvPvt, 0, 1, CallbackRecorder::callback,
+			&recorder, &status);
+	ASSERT_TRUE(recorder.waitCalls(1));
+	const auto staleToken = recorder.token;
+	irio_unregisterDMACallback(&p_DrvPvt, 0, &status);
+
+	// A new reader, possibly allocated where the old one was
+	irio_registerDMACallback(&p_DrvPvt, 0, 1, CallbackRecorder::callback,
+			&recorder, &status);
+	ASSERT_TRUE(recorder.waitCalls(2));
+	const auto releases = NiFpga_ReleaseFifoElements_fake.call_count;
+
+	const auto retStale = irio_releaseDMACallbackData(staleToken, &status);
+	EXPECT_EQ(retStale, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ConfigDMA_Warning);
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.call_count, releases);
+	EXPECT_EQ(recorder.calls, 2);
+
+	irio_resetStatus(&status);
+	const auto ret = irio_releaseDMACallbackData(recorder.token, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+
+	irio_unregisterDMACallback(&p_DrvPvt, 0, &status);
+}
+
 /////////////////////////////////////////////////////////////////
 /////// Error DMA Tests
 /////////////////////////////////////////////////////////////////
@@ -272,3 +437,105 @@ TEST_F(ErrorDMATestsAdapter, ErrorTimeoutGetDMATtoHostData_timeout) {
 	EXPECT_EQ(ret, IRIO_warning);
 }
 
+
+TEST_F(ErrorDMATestsAdapter, ErrorRegisterDMACallbackTwice) {
+	CallbackRecorder recorder;
+	irio_registerDMACallback(&p_DrvPvt, 0, 1, CallbackRecorder::callback,
+			&recorder, &status);
+	const auto ret = irio_registerDMACallback(&p_DrvPvt, 0, 1,
+			CallbackRecorder::callback, &recorder, &status);
+
+	EXPECT_EQ(status.code, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ConfigDMA_Warning);
+	EXPECT_EQ(ret, IRIO_warning);
+}
+
+TEST_F(ErrorDMATestsAdapter, ErrorRegisterDMAImageCallbackNotIMAQ) {
+	CallbackRecorder recorder;
+	const auto ret = irio_registerDMAImageCallback(&p_DrvPvt, 0, 64,
+			CallbackRecorder::callback, &recorder, &status);
+
+	EXPECT_EQ(status.code, IRIO_warning);
+	EXPECT_EQ(status.detailCode, Read_Resource_Warning);
+	EXPECT_EQ(ret, IRIO_warning);
+}
+
+TEST_F(ErrorDMATestsAdapter, ErrorRegisterDMACallbackInvalidArgs) {
+	CallbackRecorder recorder;
+	const auto ret = irio_registerDMACallback(&p_DrvPvt, 0, 0,
+			CallbackRecorder::callback, &recorder, &status);
+	EXPECT_EQ(status.detailCode, ValueOOB_Warning);
+	EXPECT_EQ(ret, IRIO_warning);
+
+	irio_resetStatus(&status);
+	const auto retNull = irio_registerDMACallback(&p_DrvPvt, 0, 1, nullptr,
+			&recorder, &status);
+	EXPECT_EQ(status.detailCode, ValueOOB_Warning);
+	EXPECT_EQ(retNull, IRIO_warning);
+}
+
+TEST_F(ErrorDMATestsAdapter, ErrorRegisterDMACallbackInvalidDMA) {
+	CallbackRecorder recorder;
+	const auto ret = irio_registerDMACallback(&p_DrvPvt, 100, 1,
+			CallbackRecorder::callback, &recorder, &status);
+
+	EXPECT_EQ(status.code, IRIO_warning);
+	EXPECT_EQ(status.detailCode, Read_Resource_Warning);
+	EXPECT_EQ(ret, IRIO_warning);
+}
+
+TEST_F(ErrorDMATestsAdapter, ErrorUnregisterDMACallbackNotRegistered) {
+	const auto ret = irio_unregisterDMACallback(&p_DrvPvt, 0, &status);
+
+	EXPECT_EQ(status.code, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ConfigDMA_Warning);
+	EXPECT_EQ(ret, IRIO_warning);
+}
+
+TEST_F(ErrorDMATestsAdapter, ErrorReleaseDMACallbackDataInvalidToken) {
+	const auto ret = irio_releaseDMACallbackData(nullptr, &status);
+
+	EXPECT_EQ(status.code, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ConfigDMA_Warning);
+	EXPECT_EQ(ret, IRIO_warning);
+}
+
+TEST_F(ErrorDMATestsAdapter, NiFpgaErrorDMACallback) {
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = nullptr;
+	NiFpga_AcquireFifoReadElementsU64_fake.return_val = -1;
+
+	CallbackRecorder recorder;
+	recorder.firstWord = 1;
+	const auto ret = irio_registerDMACallback(&p_DrvPvt, 0, 1,
+			CallbackRecorder::callback, &recorder, &status);
+	EXPECT_EQ(ret, IRIO_success);
+
+	ASSERT_TRUE(recorder.waitCalls(1));
+	EXPECT_EQ(recorder.elementsRead, 0);
+	EXPECT_EQ(recorder.firstWord, 0);
+	EXPECT_EQ(recorder.token, nullptr);
+}
+
+TEST_F(ErrorDMATestsAdapter, ErrorGetDMATtoHostDataInvalidDMA) {
+	int32_t elementsRead;
+	uint64_t data[256];
+	const auto ret = irio_getDMATtoHostData(&p_DrvPvt, 1, 100, data,
+			&elementsRead, &status);
+
+	EXPECT_EQ(status.code, IRIO_warning);
+	EXPECT_EQ(status.detailCode, Read_Resource_Warning);
+	EXPECT_EQ(ret, IRIO_warning);
+}
+
+TEST_F(ErrorDMATestsAdapter, ErrorGetDMATtoHostDataDriverClosed) {
+	irio_closeDriver(&p_DrvPvt, 0, &status);
+	irio_resetStatus(&status);
+
+	int32_t elementsRead;
+	uint64_t data[256];
+	const auto ret = irio_getDMATtoHostData(&p_DrvPvt, 1, 0, data,
+			&elementsRead, &status);
+
+	EXPECT_EQ(status.code, IRIO_error);
+	EXPECT_EQ(ret, IRIO_error);
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <limits>
+#include <NiFpga.h>
+
+#include "fixtures_adapter.h"
+#include "fff_nifpga.h"
+
+#include "bfp.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMAGPUCommon.h"
+#include "terminals/names/namesTerminalsDMADAQGPU.h"
+#include "platforms.h"
+#include "profilesTypes.h"
+
+#include "irioDriver.h"
+#include "irioError.h"
+#include "irioHandlerDMAGPU.h"
+
+using namespace irio;
+
+
+class DMAGPUTestsAdapter: public BaseTestsAdapter {
+public:
+	explicit DMAGPUTestsAdapter(const std::uint8_t profile = PROFILE_VALUE_DAQGPU):
+		BaseTestsAdapter("../../../resources/7966", "FlexRIO_OnlyResources_7966")
+	{
+		setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::FlexRIO);
+		setValueForReg(ReadFunctions::NiFpga_ReadU8,
+					   bfp.getRegister(TERMINAL_DEVPROFILE).getAddress(),
+					   profile);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU16,
+						bfp.getRegister(TERMINAL_DMATTOGPUBLOCKNWORDS).getAddress(),
+						nwords, sizeof(nwords)/sizeof(std::uint16_t));
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOGPUSAMPLESIZE).getAddress(),
+						sampleSize, sizeof(sampleSize)/sizeof(std::uint8_t));
+
+		auto ret = irio_initDriver("test", "0", "TestModel",
+					projectName.c_str(), "V9.9", false,
+					nullptr, bitfileDir.c_str(), &p_DrvPvt, &status);
+
+		if(ret != IRIO_success) {
+			throw std::runtime_error("Unable to initialize driver");
+		}
+	}
+
+	void SetUp() override {
+		irio_initStatus(&status);
+	}
+
+	void TearDown() override {
+		irio_resetStatus(&status);
+		irio_closeDriver(&p_DrvPvt, 0, &status);
+	}
+
+	~DMAGPUTestsAdapter() {
+		irio_closeDriver(&p_DrvPvt, 0, &status);
+	}
+
+	TStatus status;
+	irioDrv_t p_DrvPvt;
+private:
+	std::uint16_t nwords[1] = {4};
+	std::uint8_t sampleSize[1] = {2};
+};
+
+class DMAGPUIMAQTestsAdapter: public DMAGPUTestsAdapter {
+public:
+	DMAGPUIMAQTestsAdapter(): DMAGPUTestsAdapter(PROFILE_VALUE_IMAQGPU) {}
+};
+
+
+///////////////////////////////////////////////////////////////
+/// DMA GPU Tests
+///////////////////////////////////////////////////////////////
+TEST_F(DMAGPUTestsAdapter, GPUDataInDrvPvt) {
+	EXPECT_EQ(p_DrvPvt.devProfile,
+			  static_cast<std::uint8_t>(PROFILE_ID::FLEXRIO_GPUDAQ));
+	EXPECT_EQ(p_DrvPvt.max_dmas_gpu, p_DrvPvt.max_dmas);
+	ASSERT_NE(p_DrvPvt.DMATtoGPUBlockNWords, nullptr);
+	EXPECT_EQ(p_DrvPvt.DMATtoGPUBlockNWords[0], 4);
+}
+
+TEST_F(DMAGPUTestsAdapter, setUpDMAsTtoGPU) {
+	const auto ret = irio_setUpDMAsTtoGPU(&p_DrvPvt, 8192, &status);
+
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+	EXPECT_EQ(NiFpga_ConfigureFifo_fake.arg2_val, 8192);
+}
+
+TEST_F(DMAGPUTestsAdapter, closeDMAsTtoGPU) {
+	const auto ret = irio_closeDMAsTtoGPU(&p_DrvPvt, &status);
+
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+}
+
+TEST_F(DMAGPUTestsAdapter, cleanDMAsTtoGPU) {
+	const auto ret = irio_cleanDMAsTtoGPU(&p_DrvPvt, &status);
+
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+}
+
+TEST_F(DMAGPUTestsAdapter, setGetDMATtoGPUEnable) {
+	int32_t value;
+	auto ret = irio_setDMATtoGPUEnable(&p_DrvPvt, 0, 1, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	ret = irio_getDMATtoGPUEnable(&p_DrvPvt, 0, &value, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+}
+
+TEST_F(DMAGPUTestsAdapter, getDMATtoGPUOverflow) {
+	int32_t value;
+	const auto ret = irio_getDMATtoGPUOverflow(&p_DrvPvt, &value, &status);
+
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+}
+
+TEST_F(DMAGPUTestsAdapter, getReleaseDMATtoGPUData) {
+	uint64_t *data = nullptr;
+	int elementsRead = 0;
+	auto ret = irio_getDMATtoGPUData(&p_DrvPvt, 10, 0, &data, &elementsRead,
+									 &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	EXPECT_EQ(elementsRead, 10);
+	EXPECT_NE(data, nullptr);
+	EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.arg3_val, 40);
+
+	ret = irio_releaseDMATtoGPUData(&p_DrvPvt, 0, elementsRead, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.arg2_val, 40);
+}
+
+TEST_F(DMAGPUTestsAdapter, getDMATtoGPUDataNotEnough) {
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = nullptr;
+	NiFpga_AcquireFifoReadElementsU64_fake.return_val =
+		NiFpga_Status_FifoTimeout;
+
+	uint64_t *data = nullptr;
+	int elementsRead = -1;
+	const auto ret = irio_getDMATtoGPUData(&p_DrvPvt, 10, 0, &data,
+										   &elementsRead, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	EXPECT_EQ(elementsRead, 0);
+}
+
+TEST_F(DMAGPUIMAQTestsAdapter, getReleaseDMATtoGPUImage) {
+	uint64_t *data = nullptr;
+	int elementsRead = 0;
+	auto ret = irio_getDMATtoGPUImage(&p_DrvPvt, 1024, 0, &data,
+									  &elementsRead, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	EXPECT_EQ(elementsRead, 1024);
+	EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.arg3_val, 256);
+
+	ret = irio_releaseDMATtoGPUImage(&p_DrvPvt, 0, elementsRead, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.arg2_val, 256);
+}
+
+///////////////////////////////////////////////////////////////
+/// DMA GPU Error Tests
+///////////////////////////////////////////////////////////////
+TEST_F(DMAGPUTestsAdapter, setUpDMAsTtoGPUInvalidDepth) {
+	for (const int depth : {0, -8192}) {
+		irio_resetStatus(&status);
+		const auto ret = irio_setUpDMAsTtoGPU(&p_DrvPvt, depth, &status);
+		EXPECT_EQ(ret, IRIO_warning);
+		EXPECT_EQ(status.detailCode, ValueOOB_Warning);
+	}
+	EXPECT_EQ(NiFpga_ConfigureFifo_fake.call_count, 0);
+}
+
+TEST_F(DMAGPUTestsAdapter, setUpDMAsTtoGPUDepthNotMultipleOfBlock) {
+	// Blocks of 4 words
+	const auto ret = irio_setUpDMAsTtoGPU(&p_DrvPvt, 8190, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ValueOOB_Warning);
+	EXPECT_EQ(NiFpga_ConfigureFifo_fake.call_count, 0);
+}
+
+TEST_F(DMAGPUIMAQTestsAdapter, getDMATtoGPUImageDepthNotMultipleOfImage) {
+	auto ret = irio_setUpDMAsTtoGPU(&p_DrvPvt, 8192, &status);
+	ASSERT_EQ(ret, IRIO_success) << status.msg;
+
+	// Images of 250 words
+	uint64_t *data = nullptr;
+	int elementsRead = -1;
+	ret = irio_getDMATtoGPUImage(&p_DrvPvt, 1000, 0, &data, &elementsRead,
+								 &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ValueOOB_Warning);
+	EXPECT_EQ(elementsRead, 0);
+	EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.call_count, 0);
+}
+
+TEST_F(DMAGPUTestsAdapter, getDMATtoGPUDataInvalidDMA) {
+	uint64_t *data = nullptr;
+	int elementsRead;
+	const auto ret = irio_getDMATtoGPUData(&p_DrvPvt, 1, 100, &data,
+										   &elementsRead, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, Read_Resource_Warning);
+}
+
+TEST_F(DMAGPUTestsAdapter, getDMATtoGPUDataNiFpgaError) {
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = nullptr;
+	NiFpga_AcquireFifoReadElementsU64_fake.return_val = -1;
+
+	uint64_t *data = nullptr;
+	int elementsRead;
+	const auto ret = irio_getDMATtoGPUData(&p_DrvPvt, 1, 0, &data,
+										   &elementsRead, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, Read_NIRIO_Warning);
+}
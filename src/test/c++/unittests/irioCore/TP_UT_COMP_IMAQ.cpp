@@ -14,6 +14,7 @@
 
 #include "irioDriver.h"
 #include "irioError.h"
+#include "irioHandlerDMA.h"
 #include "irioHandlerImage.h"
 
 using namespace irio;
@@ -203,6 +204,30 @@ TEST_F(IMAQTestsAdapter, getUARTOverrunError) {
 /////////////////////////////////////////////////////////////////
 /// Error IMAQ Tests
 /////////////////////////////////////////////////////////////////
+TEST_F(ErrorIMAQTestsAdapter, registerDMAImageCallbackTwice) {
+	const irio_DMACallback callback = [](const uint64_t*, int, void *token,
+										 void*) {
+		TStatus releaseStatus;
+		irio_initStatus(&releaseStatus);
+		irio_releaseDMACallbackData(token, &releaseStatus);
+		irio_resetStatus(&releaseStatus);
+	};
+	const auto ret = irio_registerDMAImageCallback(&p_DrvPvt, 0, 64, callback,
+			nullptr, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+
+	const auto retTwice = irio_registerDMAImageCallback(&p_DrvPvt, 0, 64,
+			callback, nullptr, &status);
+	EXPECT_EQ(status.code, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ConfigDMA_Warning);
+	EXPECT_EQ(retTwice, IRIO_warning);
+
+	irio_resetStatus(&status);
+	EXPECT_EQ(irio_unregisterDMACallback(&p_DrvPvt, 0, &status),
+			  IRIO_success);
+}
+
 TEST_F(ErrorIMAQTestsAdapter, configCLBadSignalMapping) {
 	std::uint32_t badSigMap = 125;
 	const auto ret = irio_configCL(&p_DrvPvt, 1, 1, 1, 1, 0, 0,
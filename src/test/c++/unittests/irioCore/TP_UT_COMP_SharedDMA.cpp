@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <NiFpga.h>
+
+#include "fixtures_adapter.h"
+#include "fff_nifpga.h"
+
+#include "bfp.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMADAQCPU.h"
+#include "platforms.h"
+
+#include "irioDriver.h"
+#include "irioError.h"
+#include "irioSharedDMA.h"
+
+using namespace irio;
+
+
+class SharedDMATestsAdapter: public BaseTestsAdapter {
+public:
+	SharedDMATestsAdapter():
+		BaseTestsAdapter("../../../resources/7966", "FlexRIO_CPUDAQ_7966"),
+		shmName("irioUTCompSharedDMA" + std::to_string(getpid()))
+	{
+		setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::FlexRIO);
+
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU16,
+						bfp.getRegister(TERMINAL_DMATTOHOSTBLOCKNWORDS).getAddress(),
+						nwords, sizeof(nwords)/sizeof(std::uint16_t));
+
+		NiFpga_ReadFifoU64_fake.custom_fake = [](NiFpga_Session, uint32_t,
+				uint64_t* data, size_t numberOfElements, uint32_t,
+				size_t* elementsRemaining) {
+			for (size_t i = 0; i < numberOfElements; ++i) {
+				data[i] = i;
+			}
+			if(elementsRemaining)
+				*elementsRemaining = 0;
+
+			return NiFpga_Status_Success;
+		};
+
+		auto ret = irio_initDriver("test", "0", "TestModel",
+					projectName.c_str(), "V9.9", false,
+					nullptr, bitfileDir.c_str(), &p_DrvPvt, &status);
+
+		if(ret != IRIO_success) {
+			throw std::runtime_error("Unable to initialize driver");
+		}
+	}
+
+	void SetUp() override {
+		irio_initStatus(&status);
+	}
+
+	void TearDown() override {
+		irio_resetStatus(&status);
+		if (reader) {
+			irio_closeSharedDMA(&reader, &status);
+		}
+		if (publisher) {
+			irio_destroySharedDMAPublisher(&publisher, &status);
+		}
+		irio_closeDriver(&p_DrvPvt, 0, &status);
+	}
+
+	~SharedDMATestsAdapter() {
+		irio_closeDriver(&p_DrvPvt, 0, &status);
+	}
+
+	/**
+	 * Creates a publisher of DMA 0 with 2 blocks per slot
+	 */
+	void createPublisher(const int nSlots = 4, const int skipAhead = 1) {
+		const auto ret = irio_createSharedDMAPublisher(&p_DrvPvt, 0,
+				shmName.c_str(), 2, nSlots, 4, skipAhead, &publisher,
+				&status);
+		ASSERT_EQ(ret, IRIO_success) << status.msg;
+		ASSERT_NE(publisher, nullptr);
+	}
+
+	void publish(const int times = 1) {
+		for (int i = 0; i < times; ++i) {
+			int published = 0;
+			const auto ret = irio_publishSharedDMA(publisher, 100, &published,
+					&status);
+			ASSERT_EQ(ret, IRIO_success) << status.msg;
+			ASSERT_EQ(published, 1);
+		}
+	}
+
+	TStatus status;
+	irioDrv_t p_DrvPvt;
+	const std::string shmName;
+	irioSharedDMAPublisher *publisher = nullptr;
+	irioSharedDMAReader *reader = nullptr;
+private:
+	std::uint16_t nwords[1] = {1};
+};
+
+class ErrorSharedDMATestsAdapter: public SharedDMATestsAdapter {};
+
+///////////////////////////////////////////////////////////////
+/// Shared DMA Tests
+///////////////////////////////////////////////////////////////
+TEST_F(SharedDMATestsAdapter, createDestroyPublisher) {
+	createPublisher();
+
+	const auto ret = irio_destroySharedDMAPublisher(&publisher, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+	EXPECT_EQ(publisher, nullptr);
+}
+
+TEST_F(SharedDMATestsAdapter, openCloseSharedDMA) {
+	createPublisher();
+
+	auto ret = irio_openSharedDMA(shmName.c_str(), &reader, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	ASSERT_NE(reader, nullptr);
+
+	ret = irio_closeSharedDMA(&reader, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+	EXPECT_EQ(reader, nullptr);
+}
+
+TEST_F(SharedDMATestsAdapter, acquireReleaseSharedDMABlock) {
+	createPublisher();
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+	publish();
+
+	const uint64_t *data = nullptr;
+	int elements = 0;
+	uint64_t sequence = 1;
+	auto ret = irio_acquireSharedDMABlock(reader, 100, &data, &elements,
+			&sequence, &status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	ASSERT_NE(data, nullptr);
+	ASSERT_GT(elements, 0);
+	EXPECT_EQ(sequence, 0);
+	EXPECT_EQ(data[elements - 1], static_cast<uint64_t>(elements - 1));
+
+	ret = irio_releaseSharedDMABlock(reader, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+}
+
+TEST_F(SharedDMATestsAdapter, readSharedDMABlock) {
+	createPublisher();
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+	publish(2);
+
+	std::vector<uint64_t> data(256);
+	for (uint64_t expected = 0; expected < 2; ++expected) {
+		int elements = 0;
+		uint64_t sequence = 10;
+		const auto ret = irio_readSharedDMABlock(reader, 100, data.data(),
+				static_cast<int>(data.size()), &elements, &sequence, &status);
+		EXPECT_EQ(ret, IRIO_success) << status.msg;
+		EXPECT_GT(elements, 0);
+		EXPECT_EQ(sequence, expected);
+		EXPECT_EQ(data[0], 0);
+	}
+}
+
+TEST_F(SharedDMATestsAdapter, getSharedDMASkippedBlocks) {
+	createPublisher(2);
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+	publish(5);
+
+	std::vector<uint64_t> data(256);
+	int elements = 0;
+	uint64_t sequence = 0;
+	ASSERT_EQ(irio_readSharedDMABlock(reader, 100, data.data(),
+			static_cast<int>(data.size()), &elements, &sequence, &status),
+			IRIO_success) << status.msg;
+	EXPECT_EQ(sequence, 4);
+
+	uint64_t skipped = 0;
+	const auto ret = irio_getSharedDMASkippedBlocks(reader, &skipped, &status);
+	EXPECT_EQ(status.code, IRIO_success) << status.msg;
+	EXPECT_EQ(ret, IRIO_success);
+	EXPECT_EQ(skipped, 4);
+}
+
+TEST_F(SharedDMATestsAdapter, publishSharedDMAWaitSlowest) {
+	createPublisher(2, 0);
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+	publish(2);
+
+	int published = 1;
+	const auto ret = irio_publishSharedDMA(publisher, 100, &published,
+			&status);
+	EXPECT_EQ(ret, IRIO_success) << status.msg;
+	EXPECT_EQ(published, 0);
+}
+
+///////////////////////////////////////////////////////////////
+/// Shared DMA Error Tests
+///////////////////////////////////////////////////////////////
+TEST_F(ErrorSharedDMATestsAdapter, ErrorCreatePublisherInvalidArgs) {
+	auto ret = irio_createSharedDMAPublisher(&p_DrvPvt, 0, shmName.c_str(),
+			0, 4, 4, 1, &publisher, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ValueOOB_Warning);
+
+	irio_resetStatus(&status);
+	ret = irio_createSharedDMAPublisher(&p_DrvPvt, 0, nullptr, 2, 4, 4, 1,
+			&publisher, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ValueOOB_Warning);
+	EXPECT_EQ(publisher, nullptr);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorCreatePublisherInvalidDMA) {
+	const auto ret = irio_createSharedDMAPublisher(&p_DrvPvt, 100,
+			shmName.c_str(), 2, 4, 4, 1, &publisher, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, Read_Resource_Warning);
+	EXPECT_EQ(publisher, nullptr);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorCreatePublisherNameInUse) {
+	createPublisher();
+
+	irioSharedDMAPublisher *other = nullptr;
+	const auto ret = irio_createSharedDMAPublisher(&p_DrvPvt, 0,
+			shmName.c_str(), 2, 4, 4, 1, &other, &status);
+	EXPECT_EQ(ret, IRIO_error);
+	EXPECT_EQ(status.detailCode, FileAccess_Error);
+	EXPECT_EQ(other, nullptr);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorOpenSharedDMANotFound) {
+	const auto ret = irio_openSharedDMA(shmName.c_str(), &reader, &status);
+	EXPECT_EQ(ret, IRIO_error);
+	EXPECT_EQ(status.detailCode, FileAccess_Error);
+	EXPECT_EQ(reader, nullptr);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorPublishSharedDMANiFpga) {
+	createPublisher();
+	NiFpga_ReadFifoU64_fake.custom_fake = nullptr;
+	NiFpga_ReadFifoU64_fake.return_val = -1;
+
+	int published = 1;
+	const auto ret = irio_publishSharedDMA(publisher, 100, &published,
+			&status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ConfigDMA_Warning);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorAcquireSharedDMABlockTimeout) {
+	createPublisher();
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+
+	const uint64_t *data = nullptr;
+	int elements = 0;
+	const auto ret = irio_acquireSharedDMABlock(reader, 10, &data, &elements,
+			nullptr, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, Read_NIRIO_Warning);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorReleaseSharedDMABlockNotAcquired) {
+	createPublisher();
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+
+	const auto ret = irio_releaseSharedDMABlock(reader, &status);
+	EXPECT_EQ(ret, IRIO_error);
+	EXPECT_EQ(status.detailCode, FileAccess_Error);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorReleaseSharedDMABlockOverwritten) {
+	createPublisher(2);
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+	publish();
+
+	const uint64_t *data = nullptr;
+	int elements = 0;
+	ASSERT_EQ(irio_acquireSharedDMABlock(reader, 100, &data, &elements,
+			nullptr, &status), IRIO_success) << status.msg;
+	publish(2);
+
+	const auto ret = irio_releaseSharedDMABlock(reader, &status);
+	EXPECT_EQ(ret, IRIO_warning);
+	EXPECT_EQ(status.detailCode, ResourceRelease_Warning);
+}
+
+TEST_F(ErrorSharedDMATestsAdapter, ErrorReadSharedDMABlockBufferTooSmall) {
+	createPublisher();
+	ASSERT_EQ(irio_openSharedDMA(shmName.c_str(), &reader, &status),
+			  IRIO_success) << status.msg;
+	publish();
+
+	uint64_t data[1];
+	int elements = 0;
+	const auto ret = irio_readSharedDMABlock(reader, 100, data, 0, &elements,
+			nullptr, &status);
+	EXPECT_EQ(ret, IRIO_error);
+	EXPECT_EQ(status.detailCode, FileAccess_Error);
+}
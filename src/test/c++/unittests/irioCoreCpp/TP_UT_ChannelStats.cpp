@@ -0,0 +1,317 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "daq/channelStats.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class ChannelStatsTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random interleaved samples, around a different level for each channel
+	 */
+	std::vector<std::int16_t> makeSamples(const size_t channels,
+										  const size_t samples,
+										  const double sigma = 6000) {
+		std::vector<std::int16_t> in(channels * samples);
+		for (size_t c = 0; c < channels; ++c) {
+			std::normal_distribution<double> dist(-15000.0 + 4000.0 * c, sigma);
+			for (size_t n = 0; n < samples; ++n) {
+				in[n * channels + c] = static_cast<std::int16_t>(
+					std::min(std::max(dist(gen), -32768.0), 32767.0));
+			}
+		}
+		return in;
+	}
+
+	/**
+	 * Statistics of the samples [first, last) of a channel, computed one by
+	 * one
+	 */
+	ChannelStats reference(const std::vector<std::int16_t> &in,
+						   const size_t channels, const size_t channel,
+						   const size_t first, const size_t last) {
+		ChannelStats stats;
+		if (first == last) {
+			return stats;
+		}
+		double sum = 0, squares = 0;
+		stats.min = 32767;
+		stats.max = -32768;
+		for (size_t n = first; n < last; ++n) {
+			const std::int16_t x = in[n * channels + channel];
+			sum += x;
+			squares += static_cast<double>(x) * x;
+			stats.min = std::min(stats.min, x);
+			stats.max = std::max(stats.max, x);
+		}
+		stats.samples = last - first;
+		stats.mean = sum / stats.samples;
+		stats.rms = std::sqrt(squares / stats.samples);
+		double deviations = 0;
+		for (size_t n = first; n < last; ++n) {
+			const double d = in[n * channels + channel] - stats.mean;
+			deviations += d * d;
+		}
+		stats.stdDev = std::sqrt(deviations / stats.samples);
+		return stats;
+	}
+
+	void expectStats(const ChannelStats &stats, const ChannelStats &expected) {
+		EXPECT_EQ(stats.samples, expected.samples);
+		EXPECT_NEAR(stats.mean, expected.mean,
+					1e-9 * std::max(1.0, std::abs(expected.mean)));
+		EXPECT_NEAR(stats.rms, expected.rms,
+					1e-9 * std::max(1.0, expected.rms));
+		EXPECT_NEAR(stats.stdDev, expected.stdDev,
+					1e-6 * std::max(1.0, expected.rms));
+		EXPECT_EQ(stats.min, expected.min);
+		EXPECT_EQ(stats.max, expected.max);
+	}
+
+	/**
+	 * Processes the samples in blocks of random sizes and compares the
+	 * window and cumulative statistics of every channel after each block
+	 */
+	void checkSamples(const size_t channels, const size_t segmentSamples,
+					  const size_t windowSegments) {
+		const size_t samples = 40000;
+		const auto in = makeSamples(channels, samples);
+		const auto words = reinterpret_cast<const std::uint64_t*>(in.data());
+		// Blocks hold whole DMA words, so they start at a word
+		const size_t wordSamples =
+			channels % 4 == 0 ? 1 : (channels % 2 == 0 ? 2 : 4);
+
+		ChannelStatsStage stage(channels, segmentSamples, windowSegments);
+		std::uniform_int_distribution<size_t> blockSize(1, 3000);
+		size_t first = 0;
+		while (first < samples) {
+			size_t count = std::min(blockSize(gen), samples - first);
+			count = std::max(count - count % wordSamples, wordSamples);
+			stage.process(words + first * channels / 4, count * channels / 4,
+						  GetParam());
+			first += count;
+
+			const size_t segments = first / segmentSamples;
+			const size_t windowFirst =
+				segments > windowSegments ?
+					(segments - windowSegments) * segmentSamples : 0;
+			const size_t windowLast = segments * segmentSamples;
+			EXPECT_EQ(stage.getSegments(), segments);
+			EXPECT_EQ(stage.getPosition(), first);
+			ChannelStats stats;
+			for (size_t c = 0; c < channels; ++c) {
+				stage.getStats(c, StatsScope::Window, &stats);
+				expectStats(stats, reference(in, channels, c, windowFirst,
+											 windowLast));
+				stage.getStats(c, StatsScope::Cumulative, &stats);
+				expectStats(stats, reference(in, channels, c, 0, first));
+			}
+		}
+	}
+
+	std::mt19937 gen{31415};
+};
+
+class ErrorChannelStatsTests: public ::testing::Test {};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, ChannelStatsTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Channel Stats Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(ChannelStatsTests, oneChannel) {
+	checkSamples(1, 1000, 8);
+}
+
+TEST_P(ChannelStatsTests, twoChannels) {
+	checkSamples(2, 777, 5);
+}
+
+TEST_P(ChannelStatsTests, threeChannels) {
+	checkSamples(3, 1024, 4);
+}
+
+TEST_P(ChannelStatsTests, fourChannels) {
+	checkSamples(4, 501, 10);
+}
+
+TEST_P(ChannelStatsTests, eightChannels) {
+	checkSamples(8, 2048, 3);
+}
+
+TEST_P(ChannelStatsTests, fiveChannels) {
+	checkSamples(5, 333, 7);
+}
+
+TEST_P(ChannelStatsTests, oneSegmentWindow) {
+	checkSamples(4, 4096, 1);
+}
+
+TEST_P(ChannelStatsTests, fullScale) {
+	// Extreme values in every position, to check the sums do not overflow
+	const size_t channels = 4, segmentSamples = 1 << 16, segments = 5;
+	std::vector<std::int16_t> in(channels * segmentSamples * segments);
+	for (size_t i = 0; i < in.size(); ++i) {
+		in[i] = (i / channels) % 3 == 0 ? 32767 : -32768;
+	}
+	ChannelStatsStage stage(channels, segmentSamples, 4);
+	stage.process(reinterpret_cast<const std::uint64_t*>(in.data()),
+				  in.size() / 4, GetParam());
+
+	ChannelStats stats;
+	for (size_t c = 0; c < channels; ++c) {
+		stage.getStats(c, StatsScope::Window, &stats);
+		expectStats(stats, reference(in, channels, c, segmentSamples,
+									 segmentSamples * segments));
+		stage.getStats(c, StatsScope::Cumulative, &stats);
+		expectStats(stats, reference(in, channels, c, 0,
+									 segmentSamples * segments));
+		EXPECT_EQ(stats.min, -32768);
+		EXPECT_EQ(stats.max, 32767);
+	}
+}
+
+TEST_P(ChannelStatsTests, windowSlides) {
+	// Each segment holds a constant value, so the window statistics show
+	// which segments it covers
+	const size_t channels = 2, segmentSamples = 64;
+	ChannelStatsStage stage(channels, segmentSamples, 3);
+	std::vector<std::int16_t> segment(channels * segmentSamples);
+
+	ChannelStats stats;
+	stage.getStats(1, StatsScope::Window, &stats);
+	EXPECT_EQ(stats.samples, 0);
+	for (std::int16_t s = 1; s <= 6; ++s) {
+		for (size_t n = 0; n < segmentSamples; ++n) {
+			segment[n * channels] = s;
+			segment[n * channels + 1] = static_cast<std::int16_t>(-10 * s);
+		}
+		stage.process(reinterpret_cast<const std::uint64_t*>(segment.data()),
+					  segment.size() / 4, GetParam());
+
+		const std::int16_t oldest =
+			static_cast<std::int16_t>(std::max(s - 2, 1));
+		stage.getStats(0, StatsScope::Window, &stats);
+		EXPECT_EQ(stats.samples, segmentSamples * (s - oldest + 1));
+		EXPECT_DOUBLE_EQ(stats.mean, (oldest + s) / 2.0);
+		EXPECT_EQ(stats.min, oldest);
+		EXPECT_EQ(stats.max, s);
+		stage.getStats(1, StatsScope::Window, &stats);
+		EXPECT_EQ(stats.min, -10 * s);
+		EXPECT_EQ(stats.max, -10 * oldest);
+		stage.getStats(1, StatsScope::Cumulative, &stats);
+		EXPECT_EQ(stats.samples, segmentSamples * s);
+		EXPECT_EQ(stats.min, -10 * s);
+		EXPECT_EQ(stats.max, -10);
+	}
+}
+
+TEST_P(ChannelStatsTests, getValue) {
+	const size_t channels = 4;
+	const auto in = makeSamples(channels, 5000, 100);
+	ChannelStatsStage stage(channels, 1000, 2);
+	stage.process(reinterpret_cast<const std::uint64_t*>(in.data()),
+				  in.size() / 4, GetParam());
+
+	ChannelStats stats;
+	for (size_t c = 0; c < channels; ++c) {
+		for (const auto scope : {StatsScope::Window, StatsScope::Cumulative}) {
+			stage.getStats(c, scope, &stats);
+			EXPECT_EQ(stage.getValue(c, scope, StatsValue::Samples),
+					  stats.samples);
+			EXPECT_EQ(stage.getValue(c, scope, StatsValue::Mean), stats.mean);
+			EXPECT_EQ(stage.getValue(c, scope, StatsValue::RMS), stats.rms);
+			EXPECT_EQ(stage.getValue(c, scope, StatsValue::StdDev),
+					  stats.stdDev);
+			EXPECT_EQ(stage.getValue(c, scope, StatsValue::Min), stats.min);
+			EXPECT_EQ(stage.getValue(c, scope, StatsValue::Max), stats.max);
+		}
+		EXPECT_NEAR(stage.getValue(c, StatsScope::Cumulative, StatsValue::Mean),
+					-15000.0 + 4000.0 * c, 10);
+		EXPECT_NEAR(
+			stage.getValue(c, StatsScope::Cumulative, StatsValue::StdDev), 100,
+			10);
+	}
+	EXPECT_EQ(stage.getValue(0, StatsScope::Window, StatsValue::Samples), 2000);
+}
+
+TEST_P(ChannelStatsTests, reset) {
+	const size_t channels = 2;
+	const auto in = makeSamples(channels, 3000);
+	const auto words = reinterpret_cast<const std::uint64_t*>(in.data());
+	ChannelStatsStage stage(channels, 1000, 2);
+	stage.process(words, in.size() / 4, GetParam());
+	EXPECT_EQ(stage.getSegments(), 3);
+
+	stage.reset();
+	EXPECT_EQ(stage.getSegments(), 0);
+	EXPECT_EQ(stage.getPosition(), 0);
+	EXPECT_EQ(stage.getValue(1, StatsScope::Cumulative, StatsValue::Samples),
+			  0);
+
+	stage.process(words, 1000 * channels / 4, GetParam());
+	ChannelStats stats;
+	stage.getStats(1, StatsScope::Window, &stats);
+	expectStats(stats, reference(in, channels, 1, 0, 1000));
+	stage.getStats(1, StatsScope::Cumulative, &stats);
+	expectStats(stats, reference(in, channels, 1, 0, 1000));
+}
+
+TEST_P(ChannelStatsTests, concurrentReaders) {
+	const size_t channels = 8, blockSamples = 512, blocks = 400;
+	const auto in = makeSamples(channels, blockSamples, 50);
+	ChannelStatsStage stage(channels, 1024, 4);
+
+	std::thread reader([&]() {
+		ChannelStats stats;
+		std::uint64_t last = 0;
+		while (last < blockSamples * blocks) {
+			stage.getStats(channels - 1, StatsScope::Cumulative, &stats);
+			EXPECT_GE(stats.samples, last);
+			last = stats.samples;
+			if (stats.samples > 0) {
+				EXPECT_NEAR(stats.mean, -15000.0 + 4000.0 * (channels - 1),
+							20);
+			}
+		}
+	});
+	for (size_t b = 0; b < blocks; ++b) {
+		stage.process(reinterpret_cast<const std::uint64_t*>(in.data()),
+					  in.size() / 4, GetParam());
+	}
+	reader.join();
+	EXPECT_EQ(stage.getPosition(), blockSamples * blocks);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Channel Stats Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorChannelStatsTests, invalidConfiguration) {
+	EXPECT_THROW(ChannelStatsStage(0, 1000, 4);, errors::DAQStageError);
+	EXPECT_THROW(ChannelStatsStage(4, 0, 4);, errors::DAQStageError);
+	EXPECT_THROW(ChannelStatsStage(4, 1000, 0);, errors::DAQStageError);
+	EXPECT_THROW(ChannelStatsStage(4, 1 << 20, (1 << 12) + 1);,
+				 errors::DAQStageError);
+	EXPECT_NO_THROW(ChannelStatsStage(1, 1 << 20, 1 << 12););
+}
+
+TEST_F(ErrorChannelStatsTests, channelNotFound) {
+	ChannelStatsStage stage(3, 100, 2);
+	ChannelStats stats;
+	EXPECT_THROW(stage.getStats(3, StatsScope::Window, &stats),
+				 errors::DAQStageError);
+	EXPECT_THROW(stage.getValue(3, StatsScope::Cumulative, StatsValue::Mean),
+				 errors::DAQStageError);
+	EXPECT_NO_THROW(stage.getStats(2, StatsScope::Window, &stats));
+}
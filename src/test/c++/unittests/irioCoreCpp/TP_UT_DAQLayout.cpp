@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "daq/daqLayout.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class DAQLayoutTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Checks the split of a random block against the interleaved values
+	 */
+	void check(const size_t channels, const size_t samples) {
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::uint64_t> words((samples * channels + 3) / 4);
+		auto values = reinterpret_cast<std::int16_t*>(words.data());
+		for (size_t i = 0; i < samples * channels; ++i) {
+			values[i] = static_cast<std::int16_t>(dist(gen));
+		}
+
+		std::vector<std::vector<std::int16_t>> out(
+			channels, std::vector<std::int16_t>(samples));
+		std::vector<std::int16_t*> pointers;
+		for (auto &channel : out) {
+			pointers.push_back(channel.data());
+		}
+		deinterleave(words.data(), samples, channels, pointers.data(),
+					 GetParam());
+
+		for (size_t c = 0; c < channels; ++c) {
+			for (size_t s = 0; s < samples; ++s) {
+				ASSERT_EQ(out[c][s], values[s * channels + c])
+					<< "channels " << channels << ", channel " << c
+					<< ", sample " << s;
+			}
+		}
+	}
+
+	std::mt19937 gen{2468};
+};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, DAQLayoutTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// DAQ Layout Tests
+///////////////////////////////////////////////////////////////
+
+TEST(DAQLayout, blockSamples) {
+	EXPECT_EQ(getBlockSamples(1024, 4), 1024);
+	EXPECT_EQ(getBlockSamples(1024, 8), 512);
+	EXPECT_EQ(getBlockSamples(1024, 3), 1365);
+	EXPECT_EQ(getBlockSamples(1024, 0), 0);
+}
+
+TEST_P(DAQLayoutTests, deinterleaveVectorLayouts) {
+	for (const size_t channels : {2, 4, 8}) {
+		check(channels, 1000);
+		check(channels, 7);
+	}
+}
+
+TEST_P(DAQLayoutTests, deinterleaveOtherLayouts) {
+	for (const size_t channels : {1, 3, 5, 6, 16}) {
+		check(channels, 333);
+	}
+}
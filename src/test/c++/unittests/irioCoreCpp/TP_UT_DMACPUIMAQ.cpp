@@ -1,7 +1,11 @@
+#include <chrono>
+#include <vector>
+
 #include "fixtures.h"
 #include "fff_nifpga.h"
 
 #include "irioCoreCpp.h"
+#include "imaq/roiBinning.h"
 #include "terminals/names/namesTerminalsCommon.h"
 #include "terminals/names/namesTerminalsDMACPUCommon.h"
 #include "terminals/names/namesTerminalsDMAIMAQ.h"
@@ -62,6 +66,26 @@ public:
 
 class ErrorDMACPUIMAQTests: public DMACPUIMAQTests{};
 
+/// Elements in the fake DMA, and the ones arriving while a read waits
+size_t fifoElementsFake = 0;
+size_t fifoArrivingFake = 0;
+
+NiFpga_Status funcFifoElements(NiFpga_Session, uint32_t, uint64_t*,
+        size_t numberOfElements, uint32_t timeout, size_t* elementsRemaining) {
+    if (timeout != 0) {
+        fifoElementsFake += fifoArrivingFake;
+        fifoArrivingFake = 0;
+    }
+    if (numberOfElements > fifoElementsFake) {
+        return NiFpga_Status_FifoTimeout;
+    }
+    fifoElementsFake -= numberOfElements;
+    if (elementsRemaining) {
+        *elementsRemaining = fifoElementsFake;
+    }
+    return NiFpga_Status_Success;
+}
+
 
 ///////////////////////////////////////////////////////////////
 /// IMAQCPU Terminals Tests
@@ -109,6 +133,50 @@ TEST_F(DMACPUIMAQTests, recvUARTMsg){
 			  msg);
 }
 
+TEST_F(DMACPUIMAQTests, sendUARTMsgThroughput){
+    Irio irio(bitfilePath, "0", "V9.9");
+
+    // The line is busy for a moment after each byte is transmitted
+    NiFpga_ReadBool_fake.custom_fake = [](NiFpga_Session, uint32_t, NiFpga_Bool* value){
+        static size_t i = 0;
+        *value = i % 2;
+        i++;
+        return NiFpga_Status_Success;
+    };
+
+    auto imaq = irio.getTerminalsIMAQ();
+    const std::vector<std::uint8_t> msg(100, 'a');
+    const auto writes = NiFpga_WriteU8_fake.call_count;
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_NO_THROW(imaq.sendUARTMsg(msg, 1000));
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Polling every 1 ms took more than 100 ms
+    EXPECT_LT(elapsed, std::chrono::milliseconds(50));
+    EXPECT_EQ(NiFpga_WriteU8_fake.call_count - writes, msg.size());
+}
+
+TEST_F(DMACPUIMAQTests, sendUARTCommandAsync){
+    Irio irio(bitfilePath, "0", "V9.9");
+
+    NiFpga_ReadU8_fake.custom_fake = [](NiFpga_Session, uint32_t, uint8_t* value){
+        static std::string msg = "OK";
+        static size_t i = 0;
+
+        *value = msg[i%(msg.length())];
+        i++;
+        return NiFpga_Status_Success;
+    };
+
+    auto imaq = irio.getTerminalsIMAQ();
+    std::string cmd = "cmd";
+    auto response = imaq.sendUARTCommandAsync(
+        std::vector<std::uint8_t>(cmd.begin(), cmd.end()), 2);
+    std::string expectedMsg = "OK";
+    EXPECT_EQ(std::vector<std::uint8_t>(expectedMsg.begin(), expectedMsg.end()),
+              response.get());
+}
+
 TEST_F(DMACPUIMAQTests, setUARTBaudRate){
     Irio irio(bitfilePath, "0", "V9.9");
     auto imaq = irio.getTerminalsIMAQ();
@@ -166,10 +234,152 @@ TEST_F(DMACPUIMAQTests, readImageBlocking){
     EXPECT_NO_THROW(imaq.readImageBlocking(0, numPixels, data.get()));
 }
 
+TEST_F(DMACPUIMAQTests, readImagesAvailable){
+    // DMA 0 has samples of 4 bytes, 2 pixels per element
+    const size_t numPixels = 1920;
+    const size_t imageElements = numPixels / 2;
+    std::vector<std::uint64_t> data(imageElements * 8);
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoElements;
+    fifoElementsFake = imageElements * 7 / 2;
+    fifoArrivingFake = 0;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    EXPECT_EQ(imaq.readImages(0, numPixels, 8, data.data()), 3);
+    EXPECT_EQ(fifoElementsFake, imageElements / 2);
+    EXPECT_EQ(NiFpga_ReadFifoU64_fake.arg3_val, imageElements * 3);
+}
+
+TEST_F(DMACPUIMAQTests, readImagesLimitedByCount){
+    const size_t numPixels = 1920;
+    const size_t imageElements = numPixels / 2;
+    std::vector<std::uint64_t> data(imageElements * 2);
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoElements;
+    fifoElementsFake = imageElements * 5;
+    fifoArrivingFake = 0;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    EXPECT_EQ(imaq.readImages(0, numPixels, 2, data.data()), 2);
+    EXPECT_EQ(fifoElementsFake, imageElements * 3);
+}
+
+TEST_F(DMACPUIMAQTests, readImagesWaitsFirstImage){
+    const size_t numPixels = 1920;
+    const size_t imageElements = numPixels / 2;
+    std::vector<std::uint64_t> data(imageElements * 8);
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoElements;
+    fifoElementsFake = 0;
+    fifoArrivingFake = imageElements * 3;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    EXPECT_EQ(imaq.readImages(0, numPixels, 8, data.data(), 100), 3);
+    EXPECT_EQ(fifoElementsFake, 0);
+}
+
+TEST_F(DMACPUIMAQTests, acquireReleaseImages){
+    const size_t numPixels = 1920;
+    const size_t imageElements = numPixels / 2;
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoElements;
+    fifoElementsFake = imageElements * 4;
+    fifoArrivingFake = 0;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    imaq.setHostBufferDepth(imageElements * 16);
+
+    std::uint64_t *data = nullptr;
+    EXPECT_EQ(imaq.acquireImages(0, numPixels, 3, &data), 3);
+    EXPECT_NE(data, nullptr);
+    EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.arg3_val,
+              imageElements * 3);
+
+    imaq.releaseImages(0, numPixels, 3);
+    EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.arg2_val, imageElements * 3);
+}
+
+TEST_F(DMACPUIMAQTests, acquireImagesWaitsFirstImage){
+    const size_t numPixels = 1920;
+    const size_t imageElements = numPixels / 2;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    imaq.setHostBufferDepth(imageElements * 16);
+
+    // Nothing available yet, only the first image is waited for
+    std::uint64_t *data = nullptr;
+    EXPECT_EQ(imaq.acquireImages(0, numPixels, 4, &data), 1);
+    EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.arg3_val, imageElements);
+}
+
+TEST_F(DMACPUIMAQTests, readImageROI){
+    // DMA 1 has samples of 8 bytes, so use 2 bytes samples for DMA 0
+    const std::uint8_t sampleSize[2] = {2, 8};
+    setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+                   bfp.getRegister(TERMINAL_DMATTOHOSTSAMPLESIZE).getAddress(),
+                   sampleSize, 2);
+    const irio::imaq::ROIBinningStage stage(
+        64, 32, irio::imaq::PixelFormat::Mono16,
+        irio::imaq::ROI{0, 0, 32, 16}, 2);
+    std::vector<std::uint64_t> frame(stage.getFrameWords());
+    std::vector<std::uint16_t> image(stage.getOutputPixels());
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoElements;
+    fifoElementsFake = frame.size();
+    fifoArrivingFake = 0;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    EXPECT_EQ(imaq.readImageROI(0, stage, frame.data(), image.data(), false),
+              16 * 8);
+    EXPECT_EQ(NiFpga_ReadFifoU64_fake.arg3_val, frame.size());
+}
+
 ///////////////////////////////////////////////////////////////
 /// Error IMAQCPU Terminals Tests
 ///////////////////////////////////////////////////////////////
 
+TEST_F(ErrorDMACPUIMAQTests, readImageROIFormatNotMatchingSamples){
+    // DMA 0 has samples of 4 bytes, no pixel format uses them
+    const irio::imaq::ROIBinningStage stage(
+        64, 32, irio::imaq::PixelFormat::Mono16,
+        irio::imaq::ROI{0, 0, 32, 16});
+    std::vector<std::uint64_t> frame(stage.getFrameWords());
+    std::vector<std::uint16_t> image(stage.getOutputPixels());
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    EXPECT_THROW(imaq.readImageROI(0, stage, frame.data(), image.data(), true),
+                 irio::errors::UnsupportedPixelFormatError);
+    EXPECT_EQ(NiFpga_ReadFifoU64_fake.call_count, 0);
+}
+
+TEST_F(ErrorDMACPUIMAQTests, readImagesTimeout){
+    const size_t numPixels = 1920;
+    std::vector<std::uint64_t> data(numPixels);
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoElements;
+    fifoElementsFake = 0;
+    fifoArrivingFake = 0;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    EXPECT_THROW(imaq.readImages(0, numPixels, 2, data.data(), 1),
+                 irio::errors::DMAReadTimeout);
+}
+
+TEST_F(ErrorDMACPUIMAQTests, acquireImagesUnalignedHostBuffer){
+    const size_t numPixels = 1920;
+
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+    imaq.setHostBufferDepth(numPixels / 2 * 16 + 1);
+
+    std::uint64_t *data = nullptr;
+    EXPECT_THROW(imaq.acquireImages(0, numPixels, 2, &data),
+                 irio::errors::FrameAlignmentError);
+    EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.call_count, 0);
+}
+
 TEST_F(ErrorDMACPUIMAQTests, sendUARTMsgTimeout){
 	setValueForReg(ReadFunctions::NiFpga_ReadBool,
 				   bfp.getRegister(TERMINAL_UARTTXREADY).getAddress(), 0);
@@ -193,6 +403,19 @@ TEST_F(ErrorDMACPUIMAQTests, recvUARTMsgTimeout){
     EXPECT_THROW(imaq.recvUARTMsg(1,1), irio::errors::CLUARTTimeout);
 }
 
+TEST_F(ErrorDMACPUIMAQTests, sendUARTCommandAsyncTimeout){
+	setValueForReg(ReadFunctions::NiFpga_ReadBool,
+				   bfp.getRegister(TERMINAL_UARTTXREADY).getAddress(), 0);
+
+	Irio irio(bitfilePath, "0", "V9.9");
+    auto imaq = irio.getTerminalsIMAQ();
+
+    std::string cmd = "cmd";
+    auto response = imaq.sendUARTCommandAsync(
+        std::vector<std::uint8_t>(cmd.begin(), cmd.end()), 2, 1);
+    EXPECT_THROW(response.get(), irio::errors::CLUARTTimeout);
+}
+
 TEST_F(ErrorDMACPUIMAQTests, setUARTBaudRateTimeout1){
 	setValueForReg(ReadFunctions::NiFpga_ReadBool,
 				   bfp.getRegister(TERMINAL_UARTSETBAUDRATE).getAddress(), 1);
@@ -0,0 +1,431 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fixtures.h"
+#include "fff_nifpga.h"
+
+#include "irioCoreCpp.h"
+#include "dmaSharedPublisher.h"
+#include "dmaSharedReader.h"
+#include "dmaSharedRing.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMACPUCommon.h"
+
+
+using namespace irio;
+
+
+class DMASharedRingTests: public BaseTests {
+public:
+	DMASharedRingTests():
+		BaseTests("../../../resources/7854/NiFpga_Rseries_CPUDAQ_7854.lvbitx"),
+		shmName("irioUTSharedDMA" + std::to_string(getpid()))
+	{
+		setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::RSeries);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU16,
+						bfp.getRegister(TERMINAL_DMATTOHOSTNCH).getAddress(),
+						nchFake, 2);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTFRAMETYPE).getAddress(),
+						frameTypeFake, 2);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTSAMPLESIZE).getAddress(),
+						sampleSizeFake, 2);
+	}
+
+	std::vector<std::uint64_t> makeBlock(const std::uint64_t value) const {
+		return std::vector<std::uint64_t>(blockElements, value);
+	}
+
+	const std::string shmName;
+	const size_t blockElements = 16;
+	const size_t numSlots = 4;
+	const std::uint16_t nchFake[2] = {5,2};
+	const std::uint8_t frameTypeFake[2] = {1, 0};
+	const std::uint8_t sampleSizeFake[2] = {4,8};
+};
+
+class ErrorDMASharedRingTests: public DMASharedRingTests { };
+
+/**
+ * Maps the ring of a publisher as another process would
+ */
+shared::RingHeader *mapRing(const std::string &name, const size_t size) {
+	const int fd = shm_open(shared::getShmName(name).c_str(), O_RDWR, 0);
+	if (fd < 0) {
+		return nullptr;
+	}
+	void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	return addr == MAP_FAILED ? nullptr : static_cast<shared::RingHeader*>(addr);
+}
+
+/**
+ * Returns the pid of a process that has already finished
+ */
+pid_t getDeadPid() {
+	const pid_t pid = fork();
+	if (pid == 0) {
+		_exit(0);
+	}
+	waitpid(pid, nullptr, 0);
+	return pid;
+}
+
+NiFpga_Status funcFillDMAData(NiFpga_Session, uint32_t, uint64_t *data,
+		size_t numberOfElements, uint32_t, size_t *elementsRemaining) {
+	for (size_t i = 0; i < numberOfElements; ++i) {
+		data[i] = i;
+	}
+	if(elementsRemaining)
+		*elementsRemaining = 0;
+
+	return NiFpga_Status_Success;
+}
+
+///////////////////////////////////////////////////////////////
+///// Shared DMA Ring Tests
+///////////////////////////////////////////////////////////////
+TEST_F(DMASharedRingTests, createPublisher) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	EXPECT_EQ(publisher.getPublishedBlocks(), 0);
+	EXPECT_EQ(publisher.getNumConsumers(), 0);
+}
+
+TEST_F(DMASharedRingTests, ringPermissions) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	const auto name = shared::getShmName(shmName);
+	struct stat st;
+	{
+		DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+									 blockElements, numSlots);
+		const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		ASSERT_GE(fd, 0);
+		ASSERT_EQ(fstat(fd, &st), 0);
+		close(fd);
+		EXPECT_EQ(st.st_mode & 0777, 0660);
+	}
+
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots, 8,
+								 SlowConsumerPolicy::SkipAhead, 0600);
+	const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(fstat(fd, &st), 0);
+	close(fd);
+	EXPECT_EQ(st.st_mode & 0777, 0600);
+}
+
+TEST_F(DMASharedRingTests, attachReader) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	EXPECT_EQ(publisher.getNumConsumers(), 1);
+	EXPECT_EQ(reader.getBlockElements(), blockElements);
+	EXPECT_EQ(reader.getNumSlots(), numSlots);
+	EXPECT_EQ(reader.getDMANumber(), 0);
+}
+
+TEST_F(DMASharedRingTests, publishFromDMA) {
+	NiFpga_ReadFifoU64_fake.custom_fake = funcFillDMAData;
+
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	EXPECT_TRUE(publisher.publishFromDMA(100));
+
+	DMASharedBlock block;
+	ASSERT_TRUE(reader.tryAcquireBlock(&block));
+	EXPECT_EQ(block.elements, blockElements);
+	EXPECT_EQ(block.sequence, 0);
+	EXPECT_EQ(block.data[blockElements - 1], blockElements - 1);
+	EXPECT_TRUE(reader.releaseBlock());
+}
+
+TEST_F(DMASharedRingTests, multipleReaders) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader1(shmName);
+	DMASharedReader reader2(shmName);
+
+	for (std::uint64_t i = 0; i < 3; ++i) {
+		const auto data = makeBlock(i);
+		EXPECT_TRUE(publisher.publish(data.data(), data.size()));
+	}
+
+	std::vector<std::uint64_t> data(blockElements);
+	for (std::uint64_t i = 0; i < 3; ++i) {
+		std::uint64_t seq1, seq2;
+		EXPECT_EQ(reader1.readBlock(data.data(), data.size(), &seq1, 100),
+				  blockElements);
+		EXPECT_EQ(data[0], i);
+		EXPECT_EQ(reader2.readBlock(data.data(), data.size(), &seq2, 100),
+				  blockElements);
+		EXPECT_EQ(data[0], i);
+		EXPECT_EQ(seq1, i);
+		EXPECT_EQ(seq2, i);
+	}
+}
+
+TEST_F(DMASharedRingTests, readerStartsAtNextBlock) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	const auto old = makeBlock(1);
+	publisher.publish(old.data(), old.size());
+
+	DMASharedReader reader(shmName);
+	DMASharedBlock block;
+	EXPECT_FALSE(reader.tryAcquireBlock(&block));
+
+	const auto data = makeBlock(2);
+	publisher.publish(data.data(), data.size());
+	ASSERT_TRUE(reader.tryAcquireBlock(&block));
+	EXPECT_EQ(block.sequence, 1);
+	EXPECT_EQ(block.data[0], 2);
+	reader.releaseBlock();
+}
+
+TEST_F(DMASharedRingTests, skipAheadSlowReader) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+
+	const size_t blocks = numSlots * 3;
+	for (std::uint64_t i = 0; i < blocks; ++i) {
+		const auto data = makeBlock(i);
+		EXPECT_TRUE(publisher.publish(data.data(), data.size()));
+	}
+
+	DMASharedBlock block;
+	ASSERT_TRUE(reader.tryAcquireBlock(&block));
+	EXPECT_EQ(block.sequence, blocks - numSlots + 1);
+	EXPECT_EQ(block.skipped, blocks - numSlots + 1);
+	EXPECT_EQ(block.data[0], block.sequence);
+	reader.releaseBlock();
+	EXPECT_EQ(reader.getSkippedBlocks(), blocks - numSlots + 1);
+}
+
+TEST_F(DMASharedRingTests, waitSlowestRejects) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots, 8,
+								 SlowConsumerPolicy::WaitSlowest);
+	DMASharedReader reader(shmName);
+
+	const auto data = makeBlock(0);
+	for (size_t i = 0; i < numSlots; ++i) {
+		EXPECT_TRUE(publisher.publish(data.data(), data.size()));
+	}
+	EXPECT_FALSE(publisher.publish(data.data(), data.size()));
+	EXPECT_EQ(publisher.getRejectedBlocks(), 1);
+
+	std::vector<std::uint64_t> buffer(blockElements);
+	reader.readBlock(buffer.data(), buffer.size());
+	EXPECT_TRUE(publisher.publish(data.data(), data.size()));
+	EXPECT_EQ(reader.getSkippedBlocks(), 0);
+}
+
+TEST_F(DMASharedRingTests, waitSlowestNoDMARead) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, 2, 8,
+								 SlowConsumerPolicy::WaitSlowest);
+	DMASharedReader reader(shmName);
+
+	EXPECT_TRUE(publisher.publishFromDMA(100));
+	EXPECT_TRUE(publisher.publishFromDMA(100));
+	const auto reads = NiFpga_ReadFifoU64_fake.call_count;
+	EXPECT_FALSE(publisher.publishFromDMA(100));
+	EXPECT_EQ(NiFpga_ReadFifoU64_fake.call_count, reads);
+}
+
+TEST_F(DMASharedRingTests, releaseOverwrittenBlock) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	const auto data = makeBlock(0);
+	publisher.publish(data.data(), data.size());
+
+	DMASharedBlock block;
+	ASSERT_TRUE(reader.tryAcquireBlock(&block));
+	for (size_t i = 0; i < numSlots; ++i) {
+		publisher.publish(data.data(), data.size());
+	}
+	EXPECT_FALSE(reader.releaseBlock());
+}
+
+TEST_F(DMASharedRingTests, readerAfterPublisherDestroyed) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	std::unique_ptr<DMASharedPublisher> publisher(
+		new DMASharedPublisher(irio.getTerminalsDAQ(), 0, shmName,
+							   blockElements, numSlots));
+	DMASharedReader reader(shmName);
+	const auto data = makeBlock(5);
+	publisher->publish(data.data(), data.size());
+	publisher.reset();
+
+	std::vector<std::uint64_t> buffer(blockElements);
+	EXPECT_EQ(reader.readBlock(buffer.data(), buffer.size()), blockElements);
+	EXPECT_EQ(buffer[0], 5);
+	EXPECT_THROW(reader.readBlock(buffer.data(), buffer.size());,
+			errors::SharedMemoryError);
+}
+
+TEST_F(DMASharedRingTests, replaceRingOfDeadPublisher) {
+	// Ring left by a publisher process that crashed
+	const auto name = shared::getShmName(shmName);
+	const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+	ASSERT_GE(fd, 0);
+	ASSERT_EQ(ftruncate(fd, sizeof(shared::RingHeader)), 0);
+	void *addr = mmap(nullptr, sizeof(shared::RingHeader),
+					  PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	ASSERT_NE(addr, MAP_FAILED);
+	auto header = static_cast<shared::RingHeader*>(addr);
+	header->version = shared::RING_VERSION;
+	header->publisherAlive.store(1);
+	header->publisherPid.store(getDeadPid());
+	header->magic.store(shared::RING_MAGIC);
+	munmap(addr, sizeof(shared::RingHeader));
+
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	const auto data = makeBlock(3);
+	EXPECT_TRUE(publisher.publish(data.data(), data.size()));
+	std::vector<std::uint64_t> buffer(blockElements);
+	EXPECT_EQ(reader.readBlock(buffer.data(), buffer.size()), blockElements);
+	EXPECT_EQ(buffer[0], 3);
+}
+
+TEST_F(DMASharedRingTests, claimedConsumerIgnored) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	const size_t size = shared::getRingSize(blockElements, numSlots, 8);
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots, 8,
+								 SlowConsumerPolicy::WaitSlowest);
+	auto header = mapRing(shmName, size);
+	ASSERT_NE(header, nullptr);
+
+	// A consumer still initializing its entry does not hold the slots
+	shared::getConsumers(header)[0].used.store(shared::CONSUMER_CLAIMED);
+	EXPECT_EQ(publisher.getNumConsumers(), 0);
+	const auto data = makeBlock(0);
+	for (size_t i = 0; i < numSlots + 1; ++i) {
+		EXPECT_TRUE(publisher.publish(data.data(), data.size()));
+	}
+
+	DMASharedReader reader(shmName);
+	EXPECT_EQ(publisher.getNumConsumers(), 1);
+	EXPECT_EQ(shared::getConsumers(header)[1].used.load(),
+			  shared::CONSUMER_USED);
+	EXPECT_EQ(shared::getConsumers(header)[1].pid.load(), getpid());
+	munmap(header, size);
+}
+
+///////////////////////////////////////////////////////////////
+///// Error Shared DMA Ring Tests
+///////////////////////////////////////////////////////////////
+TEST_F(ErrorDMASharedRingTests, invalidDMA) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	EXPECT_THROW(DMASharedPublisher(irio.getTerminalsDAQ(), 10, shmName,
+									blockElements, numSlots);,
+			errors::ResourceNotFoundError);
+}
+
+TEST_F(ErrorDMASharedRingTests, invalidDimensions) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	EXPECT_THROW(DMASharedPublisher(irio.getTerminalsDAQ(), 0, shmName,
+									0, numSlots);,
+			errors::SharedMemoryError);
+	EXPECT_THROW(DMASharedPublisher(irio.getTerminalsDAQ(), 0, shmName,
+									blockElements, 1);,
+			errors::SharedMemoryError);
+}
+
+TEST_F(ErrorDMASharedRingTests, readerNotFound) {
+	EXPECT_THROW(DMASharedReader reader(shmName);,
+			errors::SharedMemoryError);
+}
+
+TEST_F(ErrorDMASharedRingTests, maxConsumers) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots, 1);
+	DMASharedReader reader(shmName);
+	EXPECT_THROW(DMASharedReader reader2(shmName);,
+			errors::SharedMemoryError);
+}
+
+TEST_F(ErrorDMASharedRingTests, publishTooBig) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	const std::vector<std::uint64_t> data(blockElements + 1);
+	EXPECT_THROW(publisher.publish(data.data(), data.size());,
+			errors::SharedMemoryError);
+}
+
+TEST_F(ErrorDMASharedRingTests, acquireTimeout) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	DMASharedBlock block;
+	EXPECT_THROW(reader.acquireBlock(&block, 10);,
+			errors::DMAReadTimeout);
+}
+
+TEST_F(ErrorDMASharedRingTests, releaseNotAcquired) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	EXPECT_THROW(reader.releaseBlock();,
+			errors::SharedMemoryError);
+}
+
+TEST_F(ErrorDMASharedRingTests, readBufferTooSmall) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	std::vector<std::uint64_t> buffer(blockElements - 1);
+	EXPECT_THROW(reader.readBlock(buffer.data(), buffer.size());,
+			errors::SharedMemoryError);
+}
+
+TEST_F(ErrorDMASharedRingTests, nameInUse) {
+	Irio irio(bitfilePath, "0", "V9.9");
+	DMASharedPublisher publisher(irio.getTerminalsDAQ(), 0, shmName,
+								 blockElements, numSlots);
+	DMASharedReader reader(shmName);
+	EXPECT_THROW(DMASharedPublisher(irio.getTerminalsDAQ(), 1, shmName,
+									blockElements, numSlots);,
+			errors::SharedMemoryError);
+
+	// The ring of the running publisher is untouched
+	const auto data = makeBlock(7);
+	EXPECT_TRUE(publisher.publish(data.data(), data.size()));
+	std::vector<std::uint64_t> buffer(blockElements);
+	EXPECT_EQ(reader.readBlock(buffer.data(), buffer.size()), blockElements);
+	EXPECT_EQ(buffer[0], 7);
+}
@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "daq/decimation.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class DecimationTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random interleaved stream of the given number of samples
+	 */
+	std::vector<std::uint64_t> makeStream(const size_t channels,
+										  const size_t samples) {
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::uint64_t> words(samples * channels / 4);
+		auto values = reinterpret_cast<std::int16_t*>(words.data());
+		for (size_t i = 0; i < words.size() * 4; ++i) {
+			values[i] = static_cast<std::int16_t>(dist(gen));
+		}
+		return words;
+	}
+
+	/**
+	 * Reference decimation of the complete windows of a stream
+	 */
+	std::vector<std::int16_t> reference(const std::vector<std::uint64_t> &words,
+										const size_t channels,
+										const DecimationOutput &config) {
+		auto values = reinterpret_cast<const std::int16_t*>(words.data());
+		const size_t windows = words.size() * 4 / channels / config.ratio;
+		std::vector<std::int16_t> out;
+		std::vector<double> cic(channels * config.ratio * windows, 0);
+
+		for (size_t c = 0; c < channels && config.mode == DecimationMode::CIC;
+			 ++c) {
+			// Boxcar of length ratio applied order times
+			std::vector<double> x(config.ratio * windows);
+			for (size_t s = 0; s < x.size(); ++s) {
+				x[s] = values[s * channels + c];
+			}
+			for (unsigned k = 0; k < config.order; ++k) {
+				std::vector<double> y(x.size(), 0);
+				for (size_t s = 0; s < x.size(); ++s) {
+					for (size_t j = 0; j < config.ratio && j <= s; ++j) {
+						y[s] += x[s - j];
+					}
+				}
+				x = y;
+			}
+			for (size_t s = 0; s < x.size(); ++s) {
+				cic[s * channels + c] = x[s];
+			}
+		}
+
+		for (size_t w = 0; w < windows; ++w) {
+			for (size_t c = 0; c < channels; ++c) {
+				double sum = 0;
+				std::int16_t minimum = 32767, maximum = -32768;
+				for (size_t s = w * config.ratio; s < (w + 1) * config.ratio;
+					 ++s) {
+					const std::int16_t v = values[s * channels + c];
+					sum += v;
+					minimum = std::min(minimum, v);
+					maximum = std::max(maximum, v);
+				}
+				switch (config.mode) {
+				case DecimationMode::Average:
+					out.push_back(std::lround(sum / config.ratio));
+					break;
+				case DecimationMode::MinMax:
+					out.push_back(minimum);
+					out.push_back(maximum);
+					break;
+				case DecimationMode::CIC: {
+					const size_t last = ((w + 1) * config.ratio - 1) * channels;
+					const double value =
+						cic[last + c] / std::pow(config.ratio, config.order);
+					out.push_back(std::lround(
+						std::min(std::max(value, -32768.0), 32767.0)));
+					break;
+				}
+				}
+			}
+		}
+		return out;
+	}
+
+	/**
+	 * Decimates the stream in blocks of random sizes and compares each
+	 * output with the reference
+	 */
+	void check(const size_t channels,
+			   const std::vector<DecimationOutput> &outputs,
+			   const size_t samples = 4096) {
+		const auto words = makeStream(channels, samples);
+		DecimationStage stage(channels, outputs);
+		std::vector<std::vector<std::int16_t>> results(outputs.size());
+
+		std::uniform_int_distribution<size_t> blockSize(1, 300);
+		size_t first = 0;
+		while (first < words.size()) {
+			const size_t elements =
+				std::min(blockSize(gen), words.size() - first);
+			stage.process(words.data() + first, elements, GetParam());
+			for (size_t o = 0; o < outputs.size(); ++o) {
+				const auto &out = stage.getOutput(o);
+				results[o].insert(results[o].end(), out.begin(), out.end());
+			}
+			first += elements;
+		}
+
+		for (size_t o = 0; o < outputs.size(); ++o) {
+			const auto expected = reference(words, channels, outputs[o]);
+			ASSERT_EQ(results[o].size(), expected.size()) << "output " << o;
+			for (size_t i = 0; i < expected.size(); ++i) {
+				// The CIC reference is computed in double precision
+				ASSERT_NEAR(results[o][i], expected[i],
+							outputs[o].mode == DecimationMode::CIC ? 1 : 0)
+					<< "channels " << channels << ", output " << o
+					<< ", value " << i;
+			}
+		}
+	}
+
+	std::mt19937 gen{13579};
+};
+
+class ErrorDecimationTests: public ::testing::Test {};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, DecimationTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Decimation Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(DecimationTests, average) {
+	for (const size_t channels : {1, 2, 3, 4, 6, 8, 16}) {
+		check(channels, {{10, DecimationMode::Average, 0},
+						 {64, DecimationMode::Average, 0},
+						 {1, DecimationMode::Average, 0}});
+	}
+}
+
+TEST_P(DecimationTests, minMax) {
+	for (const size_t channels : {1, 3, 4, 5, 8}) {
+		check(channels, {{7, DecimationMode::MinMax, 0},
+						 {100, DecimationMode::MinMax, 0}});
+	}
+}
+
+TEST_P(DecimationTests, cic) {
+	for (const size_t channels : {1, 4, 6}) {
+		check(channels, {{8, DecimationMode::CIC, 1},
+						 {10, DecimationMode::CIC, 3},
+						 {5, DecimationMode::CIC, 5}}, 1024);
+	}
+}
+
+TEST_P(DecimationTests, mixedOutputs) {
+	check(4, {{16, DecimationMode::Average, 0},
+			  {16, DecimationMode::MinMax, 0},
+			  {16, DecimationMode::CIC, 2}});
+}
+
+TEST_P(DecimationTests, largeRatio) {
+	check(2, {{65536, DecimationMode::Average, 0},
+			  {30000, DecimationMode::MinMax, 0}}, 140000);
+}
+
+TEST_P(DecimationTests, constantInputKeepsLevel) {
+	const size_t channels = 4;
+	std::vector<std::uint64_t> words(1024);
+	auto values = reinterpret_cast<std::int16_t*>(words.data());
+	for (size_t i = 0; i < words.size() * 4; ++i) {
+		values[i] = static_cast<std::int16_t>(-1000 * (i % channels) + 7);
+	}
+
+	DecimationStage stage(channels, {{32, DecimationMode::CIC, 4},
+									 {32, DecimationMode::Average, 0}});
+	stage.process(words.data(), words.size(), GetParam());
+	EXPECT_EQ(stage.getOutputSamples(0), 32);
+	EXPECT_EQ(stage.getOutputSamples(1), 32);
+
+	// The CIC output settles after its first order windows
+	const auto &cic = stage.getOutput(0);
+	for (size_t s = 4; s < stage.getOutputSamples(0); ++s) {
+		for (size_t c = 0; c < channels; ++c) {
+			EXPECT_EQ(cic[s * channels + c], -1000 * static_cast<int>(c) + 7);
+		}
+	}
+}
+
+TEST_P(DecimationTests, reset) {
+	DecimationStage stage(2, {{8, DecimationMode::Average, 0}});
+	std::vector<std::uint64_t> words(3, 0x0001000100010001ULL);
+	stage.process(words.data(), 3, GetParam());
+	EXPECT_EQ(stage.getOutputSamples(0), 0);
+
+	// Without reset, the 6 pending samples would complete a window
+	stage.reset();
+	stage.process(words.data(), 1, GetParam());
+	EXPECT_EQ(stage.getOutputSamples(0), 0);
+	stage.process(words.data(), 3, GetParam());
+	EXPECT_EQ(stage.getOutputSamples(0), 1);
+	EXPECT_EQ(stage.getOutput(0), std::vector<std::int16_t>({1, 1}));
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Decimation Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorDecimationTests, invalidConfiguration) {
+	EXPECT_THROW(DecimationStage(0, {{2, DecimationMode::Average, 0}});,
+				 errors::DAQStageError);
+	EXPECT_THROW(DecimationStage(4, {});, errors::DAQStageError);
+	EXPECT_THROW(DecimationStage(4, {{0, DecimationMode::MinMax, 0}});,
+				 errors::DAQStageError);
+	EXPECT_THROW(DecimationStage(4, {{65537, DecimationMode::Average, 0}});,
+				 errors::DAQStageError);
+	EXPECT_THROW(DecimationStage(4, {{16, DecimationMode::CIC, 0}});,
+				 errors::DAQStageError);
+	// 16 + 6 * 10 bits
+	EXPECT_THROW(DecimationStage(4, {{1000, DecimationMode::CIC, 6}});,
+				 errors::DAQStageError);
+	EXPECT_NO_THROW(DecimationStage(4, {{1000, DecimationMode::CIC, 4}}););
+}
+
+TEST_F(ErrorDecimationTests, outputNotFound) {
+	DecimationStage stage(4, {{2, DecimationMode::Average, 0}});
+	EXPECT_THROW(stage.getOutput(1), errors::DAQStageError);
+	EXPECT_THROW(stage.getOutputSamples(1), errors::DAQStageError);
+}
@@ -0,0 +1,337 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "daq/envelope.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+namespace {
+
+const std::vector<size_t> DECIMATIONS = {16, 256, 4096};
+
+std::string getTestPath() {
+	// Parameterized tests are named test/parameter
+	std::string name =
+		::testing::UnitTest::GetInstance()->current_test_info()->name();
+	std::replace(name.begin(), name.end(), '/', '_');
+	return ::testing::TempDir() + "envelope_" + name + ".raw";
+}
+
+void removeEnvelopes(const std::string &rawPath,
+					 const std::vector<size_t> &decimations) {
+	std::remove(EnvelopeBuilder::getDescriptorPath(rawPath).c_str());
+	for (const auto decimation : decimations) {
+		std::remove(EnvelopeBuilder::getLevelPath(rawPath, decimation).c_str());
+	}
+}
+
+/**
+ * Points of all the channels stored in the file of a level
+ */
+std::vector<EnvelopePoint> readLevel(const std::string &rawPath,
+									 const size_t decimation) {
+	std::ifstream file(EnvelopeBuilder::getLevelPath(rawPath, decimation),
+					   std::ios::binary | std::ios::ate);
+	std::vector<EnvelopePoint> points(
+		static_cast<size_t>(file.tellg()) / sizeof(EnvelopePoint));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(points.data()),
+			  points.size() * sizeof(EnvelopePoint));
+	return points;
+}
+
+}  // namespace
+
+class EnvelopeTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	void TearDown() override {
+		removeEnvelopes(getTestPath(), DECIMATIONS);
+	}
+
+	/**
+	 * Random interleaved samples, around a different level for each channel
+	 * and with spikes
+	 */
+	std::vector<std::int16_t> makeSamples(const size_t channels,
+										  const size_t samples) {
+		std::vector<std::int16_t> in(channels * samples);
+		std::uniform_int_distribution<int> spike(0, 999);
+		for (size_t c = 0; c < channels; ++c) {
+			std::normal_distribution<double> dist(-15000.0 + 4000.0 * c, 3000);
+			for (size_t n = 0; n < samples; ++n) {
+				const double x = spike(gen) == 0 ? 40000 - 80000.0 * (n % 2)
+												 : dist(gen);
+				in[n * channels + c] = static_cast<std::int16_t>(
+					std::min(std::max(x, -32768.0), 32767.0));
+			}
+		}
+		return in;
+	}
+
+	/**
+	 * Envelope of a channel in the samples [first, last)
+	 */
+	EnvelopePoint reference(const std::vector<std::int16_t> &in,
+							const size_t channels, const size_t channel,
+							const size_t first, const size_t last) {
+		EnvelopePoint point = {32767, -32768};
+		for (size_t n = first; n < last; ++n) {
+			point.min = std::min(point.min, in[n * channels + channel]);
+			point.max = std::max(point.max, in[n * channels + channel]);
+		}
+		return point;
+	}
+
+	void expectPoint(const EnvelopePoint &point,
+					 const EnvelopePoint &expected) {
+		EXPECT_EQ(point.min, expected.min);
+		EXPECT_EQ(point.max, expected.max);
+	}
+
+	/**
+	 * Builds the envelopes of the samples, processed in blocks of random
+	 * sizes, and compares every level with the reference
+	 */
+	void checkSamples(const size_t channels, const size_t samples) {
+		const std::string path = getTestPath();
+		const auto in = makeSamples(channels, samples);
+		const auto words = reinterpret_cast<const std::uint64_t*>(in.data());
+		// Blocks hold whole DMA words, so they start at a word
+		const size_t wordSamples =
+			channels % 4 == 0 ? 1 : (channels % 2 == 0 ? 2 : 4);
+
+		{
+			EnvelopeBuilder builder(path, channels);
+			std::uniform_int_distribution<size_t> blockSize(1, 20000);
+			size_t first = 0;
+			while (first < samples) {
+				size_t count = std::min(blockSize(gen), samples - first);
+				count = std::max(count - count % wordSamples, wordSamples);
+				builder.process(words + first * channels / 4,
+								count * channels / 4, GetParam());
+				first += count;
+			}
+			EXPECT_EQ(builder.getPosition(), samples);
+		}
+
+		EnvelopeReader reader(path);
+		EXPECT_EQ(reader.getChannels(), channels);
+		EXPECT_EQ(reader.getSamples(), samples);
+		EXPECT_EQ(reader.getDecimations(), DECIMATIONS);
+		for (size_t k = 0; k < DECIMATIONS.size(); ++k) {
+			const size_t decimation = DECIMATIONS[k];
+			const size_t expectedPoints =
+				(samples + decimation - 1) / decimation;
+			EXPECT_EQ(reader.getPoints()[k], expectedPoints);
+			const auto points = readLevel(path, decimation);
+			ASSERT_EQ(points.size(), expectedPoints * channels);
+			for (size_t p = 0; p < expectedPoints; ++p) {
+				for (size_t c = 0; c < channels; ++c) {
+					expectPoint(points[p * channels + c],
+								reference(in, channels, c, p * decimation,
+										  std::min((p + 1) * decimation,
+												   samples)));
+				}
+			}
+		}
+	}
+
+	std::mt19937 gen{16180};
+};
+
+class ErrorEnvelopeTests: public ::testing::Test {
+public:
+	void TearDown() override {
+		removeEnvelopes(getTestPath(), DECIMATIONS);
+	}
+};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, EnvelopeTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Envelope Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(EnvelopeTests, oneChannel) {
+	checkSamples(1, 300000);
+}
+
+TEST_P(EnvelopeTests, twoChannels) {
+	checkSamples(2, 200002);
+}
+
+TEST_P(EnvelopeTests, threeChannels) {
+	checkSamples(3, 100000);
+}
+
+TEST_P(EnvelopeTests, fourChannels) {
+	checkSamples(4, 123457);
+}
+
+TEST_P(EnvelopeTests, eightChannels) {
+	checkSamples(8, 81920);
+}
+
+TEST_P(EnvelopeTests, otherDecimations) {
+	// Decimations that are not a multiple of the vector sizes
+	const std::string path = getTestPath();
+	const std::vector<size_t> decimations = {6, 30, 90};
+	const size_t channels = 2, samples = 10000;
+	const auto in = makeSamples(channels, samples);
+	{
+		EnvelopeBuilder builder(path, channels, decimations);
+		builder.process(reinterpret_cast<const std::uint64_t*>(in.data()),
+						samples * channels / 4, GetParam());
+	}
+	for (const auto decimation : decimations) {
+		const auto points = readLevel(path, decimation);
+		ASSERT_EQ(points.size(),
+				  (samples + decimation - 1) / decimation * channels);
+		for (size_t p = 0; p < points.size() / channels; ++p) {
+			expectPoint(points[p * channels + 1],
+						reference(in, channels, 1, p * decimation,
+								  std::min((p + 1) * decimation, samples)));
+		}
+	}
+	removeEnvelopes(path, decimations);
+}
+
+TEST_P(EnvelopeTests, readWhileBuilding) {
+	const std::string path = getTestPath();
+	const size_t channels = 4, samples = 10010;
+	const auto in = makeSamples(channels, samples);
+	EnvelopeBuilder builder(path, channels);
+	EnvelopeReader reader(path);
+	EXPECT_EQ(reader.getSamples(), 0);
+
+	builder.process(reinterpret_cast<const std::uint64_t*>(in.data()),
+					samples * channels / 4, GetParam());
+	builder.flush();
+	reader.refresh();
+	// Only the complete points are written
+	EXPECT_EQ(reader.getSamples(), samples / 16 * 16);
+	EXPECT_EQ(reader.getPoints(),
+			  std::vector<std::uint64_t>({samples / 16, samples / 256,
+										  samples / 4096}));
+
+	std::vector<EnvelopePoint> points;
+	std::uint64_t start;
+	const std::uint64_t decimation =
+		reader.read(2, 0, samples, samples, &points, &start);
+	EXPECT_EQ(decimation, 16);
+	EXPECT_EQ(start, 0);
+	ASSERT_EQ(points.size(), samples / 16);
+	expectPoint(points.back(), reference(in, channels, 2,
+										 samples / 16 * 16 - 16,
+										 samples / 16 * 16));
+
+	builder.close();
+	reader.refresh();
+	EXPECT_EQ(reader.getSamples(), samples);
+	EXPECT_THROW(builder.process(
+					 reinterpret_cast<const std::uint64_t*>(in.data()), 4),
+				 errors::DAQStageError);
+}
+
+TEST_P(EnvelopeTests, readLevels) {
+	const std::string path = getTestPath();
+	const size_t channels = 2, samples = 1000000;
+	const auto in = makeSamples(channels, samples);
+	{
+		EnvelopeBuilder builder(path, channels);
+		builder.process(reinterpret_cast<const std::uint64_t*>(in.data()),
+						samples * channels / 4, GetParam());
+	}
+	EnvelopeReader reader(path);
+
+	/**
+	 * Reads a range and checks each point returned against the samples
+	 */
+	const auto check = [&](const size_t firstSample, const size_t count,
+						   const size_t maxPoints,
+						   const std::uint64_t expectedDecimation) {
+		std::vector<EnvelopePoint> points;
+		std::uint64_t start;
+		const std::uint64_t decimation =
+			reader.read(1, firstSample, count, maxPoints, &points, &start);
+		EXPECT_EQ(decimation, expectedDecimation);
+		EXPECT_LE(points.size(), maxPoints);
+		EXPECT_LE(start, firstSample);
+		EXPECT_GT(start + decimation, firstSample);
+		const size_t last = std::min<size_t>(firstSample + count, samples);
+		EXPECT_GE(start + decimation * points.size(), last);
+		for (size_t p = 0; p < points.size(); ++p) {
+			expectPoint(points[p],
+						reference(in, channels, 1, start + p * decimation,
+								  std::min<size_t>(start + (p + 1) * decimation,
+												   samples)));
+		}
+	};
+	// 245 points of 4096 samples merged by 3
+	check(0, samples, 100, 3 * 4096);
+	// 3907 points of 256 samples merged by 4
+	check(100, 1000000, 1000, 4 * 256);
+	// 625 points of 16 samples, merged by 7
+	check(500000, 10000, 100, 7 * 16);
+	// Finest level too coarse
+	check(123, 50, 100, 16);
+	// Beyond the end of the recording
+	check(999000, 5000, 1000, 16);
+
+	std::vector<EnvelopePoint> points(3);
+	std::uint64_t start;
+	reader.read(0, samples, 10, 10, &points, &start);
+	EXPECT_TRUE(points.empty());
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Envelope Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorEnvelopeTests, invalidConfiguration) {
+	const std::string path = getTestPath();
+	EXPECT_THROW(EnvelopeBuilder(path, 0);, errors::DAQStageError);
+	EXPECT_THROW(EnvelopeBuilder(path, 2, {});, errors::DAQStageError);
+	EXPECT_THROW(EnvelopeBuilder(path, 2, {1, 16});, errors::DAQStageError);
+	EXPECT_THROW(EnvelopeBuilder(path, 2, {16, 16});, errors::DAQStageError);
+	EXPECT_THROW(EnvelopeBuilder(path, 2, {16, 40});, errors::DAQStageError);
+	EXPECT_THROW(EnvelopeBuilder(path, 2, {2, 4, 8, 16, 32, 64, 128, 256, 512});
+				 , errors::DAQStageError);
+	EXPECT_THROW(EnvelopeBuilder("/nonexistent/dir/file.raw", 2);,
+				 errors::RecordingError);
+}
+
+TEST_F(ErrorEnvelopeTests, invalidFiles) {
+	const std::string path = getTestPath();
+	EXPECT_THROW(EnvelopeReader reader(path);, errors::RecordingError);
+
+	std::ofstream(EnvelopeBuilder::getDescriptorPath(path)) << "Not envelopes";
+	EXPECT_THROW(EnvelopeReader reader(path);, errors::RecordingError);
+
+	{ EnvelopeBuilder builder(path, 2); }
+	std::remove(EnvelopeBuilder::getLevelPath(path, 256).c_str());
+	EXPECT_THROW(EnvelopeReader reader(path);, errors::RecordingError);
+}
+
+TEST_F(ErrorEnvelopeTests, invalidRead) {
+	const std::string path = getTestPath();
+	EnvelopeBuilder builder(path, 2);
+	EnvelopeReader reader(path);
+	std::vector<EnvelopePoint> points;
+	std::uint64_t start;
+	EXPECT_THROW(reader.read(2, 0, 100, 10, &points, &start),
+				 errors::DAQStageError);
+	EXPECT_THROW(reader.read(1, 0, 100, 0, &points, &start),
+				 errors::DAQStageError);
+	EXPECT_NO_THROW(reader.read(1, 0, 100, 10, &points, &start));
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+#include "daq/firFilter.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class FIRFilterTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random samples of each channel
+	 */
+	std::vector<std::vector<std::int16_t>> makeChannels(const size_t channels,
+														const size_t samples) {
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::vector<std::int16_t>> in(
+			channels, std::vector<std::int16_t>(samples));
+		for (auto &channel : in) {
+			for (auto &v : channel) {
+				v = static_cast<std::int16_t>(dist(gen));
+			}
+		}
+		return in;
+	}
+
+	/**
+	 * Filters the channels in blocks of random sizes and compares the
+	 * result with a reference computed in double precision
+	 */
+	void check(const size_t channels, const std::vector<float> &h,
+			   const size_t decimation = 1, const unsigned threads = 1) {
+		const size_t samples = 3000;
+		const auto in = makeChannels(channels, samples);
+		FIRFilterStage stage(channels, h, decimation, threads);
+
+		std::vector<std::vector<float>> result(channels);
+		std::uniform_int_distribution<size_t> blockSize(1, 700);
+		size_t first = 0;
+		while (first < samples) {
+			const size_t count = std::min(blockSize(gen), samples - first);
+			std::vector<const std::int16_t*> inputs;
+			std::vector<std::vector<float>> outputs(
+				channels, std::vector<float>(stage.getOutputSamples(count)));
+			std::vector<float*> outPointers;
+			for (size_t c = 0; c < channels; ++c) {
+				inputs.push_back(in[c].data() + first);
+				outPointers.push_back(outputs[c].data());
+			}
+			ASSERT_EQ(stage.process(inputs.data(), count, outPointers.data(),
+									GetParam()),
+					  outputs[0].size());
+			for (size_t c = 0; c < channels; ++c) {
+				result[c].insert(result[c].end(), outputs[c].begin(),
+								 outputs[c].end());
+			}
+			first += count;
+		}
+
+		double scale = 0;
+		for (const auto v : h) {
+			scale += std::fabs(v) * 32768;
+		}
+		for (size_t c = 0; c < channels; ++c) {
+			ASSERT_EQ(result[c].size(), (samples + decimation - 1) / decimation);
+			for (size_t k = 0; k < result[c].size(); ++k) {
+				const size_t n = k * decimation;
+				double expected = 0;
+				for (size_t j = 0; j < h.size() && j <= n; ++j) {
+					expected += h[j] * in[c][n - j];
+				}
+				ASSERT_NEAR(result[c][k], expected, scale * 1e-6)
+					<< "channel " << c << ", output " << k;
+			}
+		}
+	}
+
+	std::mt19937 gen{8642};
+};
+
+class FIRDesignTests: public ::testing::Test {
+public:
+	/**
+	 * Magnitude of the response of a filter at a frequency
+	 */
+	double response(const std::vector<float> &h, const double frequency) {
+		std::complex<double> sum = 0;
+		for (size_t n = 0; n < h.size(); ++n) {
+			sum += static_cast<double>(h[n]) *
+				   std::polar(1.0, -2 * M_PI * frequency * n);
+		}
+		return std::abs(sum);
+	}
+};
+
+class ErrorFIRFilterTests: public ::testing::Test {};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, FIRFilterTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// FIR Filter Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(FIRFilterTests, filterAcrossBlocks) {
+	for (const size_t taps : {1, 5, 33, 128}) {
+		check(3, designLowPass(taps, 0.1));
+	}
+}
+
+TEST_P(FIRFilterTests, polyphaseDecimation) {
+	check(2, designLowPass(31, 0.05), 4);
+	check(4, designLowPass(64, 0.02, FIRWindow::Blackman), 10);
+	check(1, designLowPass(7, 0.2), 3);
+}
+
+TEST_P(FIRFilterTests, severalThreads) {
+	check(6, designBandPass(47, 0.1, 0.2), 1, 4);
+	check(3, designLowPass(20, 0.1), 2, 8);
+}
+
+TEST_P(FIRFilterTests, sameResultAnyLevel) {
+	const auto in = makeChannels(1, 1000);
+	const auto h = designLowPass(45, 0.15);
+	const std::int16_t *input = in[0].data();
+
+	std::vector<float> scalar(1000), vector(1000);
+	float *out = scalar.data();
+	FIRFilterStage(1, h).process(&input, 1000, &out, SIMDLevel::Scalar);
+	out = vector.data();
+	FIRFilterStage(1, h).process(&input, 1000, &out, GetParam());
+	EXPECT_EQ(scalar, vector);
+}
+
+TEST_P(FIRFilterTests, reset) {
+	const auto h = designLowPass(9, 0.2);
+	FIRFilterStage stage(1, h, 2);
+	const std::vector<std::int16_t> ones(5, 1000);
+	const std::int16_t *input = ones.data();
+	std::vector<float> first(3), second(3);
+	float *out = first.data();
+	EXPECT_EQ(stage.process(&input, 5, &out, GetParam()), 3);
+
+	stage.reset();
+	out = second.data();
+	EXPECT_EQ(stage.getOutputSamples(5), 3);
+	EXPECT_EQ(stage.process(&input, 5, &out, GetParam()), 3);
+	EXPECT_EQ(first, second);
+}
+
+TEST_F(FIRDesignTests, designLowPass) {
+	for (const auto window : {FIRWindow::Rectangular, FIRWindow::Hamming,
+							  FIRWindow::Blackman}) {
+		const auto h = designLowPass(101, 0.1, window);
+		EXPECT_NEAR(response(h, 0), 1, 1e-5);
+		EXPECT_LT(response(h, 0.25), 0.02);
+		for (size_t n = 0; n < h.size(); ++n) {
+			EXPECT_FLOAT_EQ(h[n], h[h.size() - 1 - n]);
+		}
+	}
+	EXPECT_LT(response(designLowPass(101, 0.1, FIRWindow::Blackman), 0.2),
+			  1e-3);
+}
+
+TEST_F(FIRDesignTests, designHighPass) {
+	const auto h = designHighPass(101, 0.1);
+	EXPECT_NEAR(response(h, 0), 0, 1e-5);
+	EXPECT_NEAR(response(h, 0.5), 1, 1e-3);
+	EXPECT_NEAR(response(h, 0.3), 1, 1e-2);
+}
+
+TEST_F(FIRDesignTests, designBandPass) {
+	const auto h = designBandPass(151, 0.1, 0.2);
+	EXPECT_NEAR(response(h, 0.15), 1, 1e-5);
+	EXPECT_LT(response(h, 0), 1e-3);
+	EXPECT_LT(response(h, 0.35), 1e-2);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error FIR Filter Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorFIRFilterTests, invalidConfiguration) {
+	EXPECT_THROW(FIRFilterStage(0, {1.0f});, errors::DAQStageError);
+	EXPECT_THROW(FIRFilterStage(2, {});, errors::DAQStageError);
+	EXPECT_THROW(FIRFilterStage(2, {1.0f}, 0);, errors::DAQStageError);
+}
+
+TEST_F(ErrorFIRFilterTests, invalidDesign) {
+	EXPECT_THROW(designLowPass(0, 0.1), errors::DAQStageError);
+	EXPECT_THROW(designLowPass(11, 0.5), errors::DAQStageError);
+	EXPECT_THROW(designLowPass(11, 0), errors::DAQStageError);
+	EXPECT_THROW(designHighPass(10, 0.1), errors::DAQStageError);
+	EXPECT_THROW(designBandPass(11, 0.2, 0.1), errors::DAQStageError);
+	EXPECT_THROW(designBandPass(11, 0.1, 0.6), errors::DAQStageError);
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "imaq/flatField.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+class FlatFieldTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random frame of the given format and its unpacked pixels
+	 */
+	void makeFrame(const PixelFormat format) {
+		const unsigned bits = getPixelBits(format);
+		pixels = randomImage(format);
+		words.assign(getFrameWords(format, pixels.size()), 0);
+		auto bytes = reinterpret_cast<std::uint8_t*>(words.data());
+		for (size_t i = 0; i < pixels.size(); ++i) {
+			for (unsigned b = 0; b < bits; ++b) {
+				const size_t bit = i * bits + b;
+				if ((pixels[i] >> b) & 1) {
+					bytes[bit / 8] |= 1 << (bit % 8);
+				}
+			}
+		}
+	}
+
+	std::vector<std::uint16_t> randomImage(const PixelFormat format,
+										   unsigned maxValue = 0) {
+		if (maxValue == 0) {
+			maxValue = (1u << getPixelDepth(format)) - 1;
+		}
+		std::uniform_int_distribution<unsigned> dist(0, maxValue);
+		std::vector<std::uint16_t> image(WIDTH * HEIGHT);
+		for (auto &p : image) {
+			p = dist(gen);
+		}
+		return image;
+	}
+
+	/**
+	 * Reference correction of the unpacked pixels
+	 */
+	std::vector<std::uint16_t> reference(const PixelFormat format,
+										 const std::vector<std::uint16_t> &dark,
+										 const std::vector<float> &gain) const {
+		const float maxValue = (1u << getPixelDepth(format)) - 1;
+		std::vector<std::uint16_t> out(pixels.size());
+		for (size_t i = 0; i < pixels.size(); ++i) {
+			const float d = dark.empty() ? 0 : dark[i];
+			const float v = (pixels[i] - d) * gain[i];
+			out[i] = std::nearbyint(std::min(std::max(v, 0.0f), maxValue));
+		}
+		return out;
+	}
+
+	void check(const PixelFormat format, const bool withFlat = true,
+			   const unsigned threads = 1) {
+		makeFrame(format);
+		const unsigned maxValue = (1u << getPixelDepth(format)) - 1;
+		const auto dark = randomImage(format, maxValue / 8);
+		std::vector<std::uint16_t> flat;
+		if (withFlat) {
+			flat = randomImage(format);
+		}
+		FlatFieldStage stage(WIDTH, HEIGHT, format, dark, flat, threads);
+		ASSERT_EQ(stage.getFrameWords(), words.size());
+		std::vector<std::uint16_t> image(WIDTH * HEIGHT, 0xDEAD);
+		stage.process(words.data(), image.data(), GetParam());
+		EXPECT_EQ(image, reference(format, dark, stage.getGain()));
+	}
+
+	static constexpr size_t WIDTH = 101;
+	static constexpr size_t HEIGHT = 64;
+
+	std::vector<std::uint16_t> pixels;
+	std::vector<std::uint64_t> words;
+	std::mt19937 gen{2468};
+};
+
+constexpr size_t FlatFieldTests::WIDTH;
+constexpr size_t FlatFieldTests::HEIGHT;
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, FlatFieldTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Flat Field Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(FlatFieldTests, correctMono8) {
+	check(PixelFormat::Mono8);
+}
+
+TEST_P(FlatFieldTests, correctMono10p) {
+	check(PixelFormat::Mono10p);
+}
+
+TEST_P(FlatFieldTests, correctMono12) {
+	check(PixelFormat::Mono12);
+}
+
+TEST_P(FlatFieldTests, correctMono12p) {
+	check(PixelFormat::Mono12p);
+}
+
+TEST_P(FlatFieldTests, correctMono16) {
+	check(PixelFormat::Mono16);
+}
+
+TEST_P(FlatFieldTests, darkOnly) {
+	check(PixelFormat::Mono12p, false);
+}
+
+TEST_P(FlatFieldTests, severalThreads) {
+	check(PixelFormat::Mono12p, true, 4);
+	check(PixelFormat::Mono16, true, 100);
+}
+
+TEST_P(FlatFieldTests, uniformIlluminationIsFlattened) {
+	// A sensor with a gradient of sensitivity, illuminated uniformly
+	std::vector<std::uint16_t> dark(WIDTH * HEIGHT, 100);
+	std::vector<std::uint16_t> flat(WIDTH * HEIGHT);
+	for (size_t i = 0; i < flat.size(); ++i) {
+		flat[i] = 100 + 1000 + (i % WIDTH) * 10;
+	}
+	FlatFieldStage stage(WIDTH, HEIGHT, PixelFormat::Mono16, dark, flat);
+	std::vector<std::uint16_t> image(WIDTH * HEIGHT);
+	stage.process(reinterpret_cast<const std::uint64_t*>(flat.data()),
+				  image.data(), GetParam());
+	const auto range = std::minmax_element(image.begin(), image.end());
+	EXPECT_LE(*range.second - *range.first, 1);
+	EXPECT_NEAR(image[0], 1500, 1);
+}
+
+TEST_P(FlatFieldTests, clampsToPixelRange) {
+	std::vector<std::uint16_t> dark(WIDTH * HEIGHT, 50);
+	std::vector<std::uint16_t> flat(WIDTH * HEIGHT, 250);
+	flat[0] = 51;
+	FlatFieldStage stage(WIDTH, HEIGHT, PixelFormat::Mono8, dark, flat);
+	std::vector<std::uint64_t> frame(WIDTH * HEIGHT / 8 + 1, 0);
+	auto bytes = reinterpret_cast<std::uint8_t*>(frame.data());
+	bytes[0] = 255;
+	bytes[1] = 10;
+	std::vector<std::uint16_t> image(WIDTH * HEIGHT);
+	stage.process(frame.data(), image.data(), GetParam());
+	EXPECT_EQ(image[0], 255);
+	EXPECT_EQ(image[1], 0);
+}
+
+TEST(FlatFieldStageTests, deadPixelsKeepUnityGain) {
+	std::vector<std::uint16_t> dark = {10, 10, 10, 10};
+	std::vector<std::uint16_t> flat = {110, 60, 10, 5};
+	FlatFieldStage stage(2, 2, PixelFormat::Mono8, dark, flat);
+	EXPECT_FLOAT_EQ(stage.getGain()[0], 0.75f);
+	EXPECT_FLOAT_EQ(stage.getGain()[1], 1.5f);
+	EXPECT_FLOAT_EQ(stage.getGain()[2], 1);
+	EXPECT_FLOAT_EQ(stage.getGain()[3], 1);
+	EXPECT_EQ(stage.getFormat(), PixelFormat::Mono8);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Flat Field Tests
+///////////////////////////////////////////////////////////////
+
+TEST(ErrorFlatFieldStageTests, referenceSizeMismatch) {
+	EXPECT_THROW(FlatFieldStage(4, 4, PixelFormat::Mono8,
+								std::vector<std::uint16_t>(15));,
+				 errors::ImageStageError);
+	EXPECT_THROW(FlatFieldStage(4, 4, PixelFormat::Mono8,
+								std::vector<std::uint16_t>(16),
+								std::vector<std::uint16_t>(17, 1));,
+				 errors::ImageStageError);
+}
+
+TEST(ErrorFlatFieldStageTests, flatBelowDark) {
+	EXPECT_THROW(FlatFieldStage(2, 2, PixelFormat::Mono8,
+								std::vector<std::uint16_t>(4, 10),
+								std::vector<std::uint16_t>(4, 10));,
+				 errors::ImageStageError);
+}
+
+TEST(ErrorFlatFieldStageTests, emptyFrame) {
+	EXPECT_THROW(FlatFieldStage(0, 4, PixelFormat::Mono8,
+								std::vector<std::uint16_t>());,
+				 errors::ImageStageError);
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "imaq/frameCodec.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+class FrameCodecTests: public ::testing::Test {
+public:
+	/**
+	 * Smooth scene with noise, as seen by a camera
+	 */
+	std::vector<std::uint16_t> smoothImage(const PixelFormat format) {
+		const unsigned maxValue = (1u << getPixelDepth(format)) - 1;
+		std::normal_distribution<double> noise(0, 2);
+		std::vector<std::uint16_t> image(WIDTH * HEIGHT);
+		for (size_t y = 0; y < HEIGHT; ++y) {
+			for (size_t x = 0; x < WIDTH; ++x) {
+				const double value =
+					maxValue * (0.5 + 0.4 * std::sin(x / 9.0) *
+										  std::cos(y / 7.0)) +
+					noise(gen);
+				image[y * WIDTH + x] = static_cast<std::uint16_t>(
+					std::min<double>(std::max(value, 0.0), maxValue));
+			}
+		}
+		return image;
+	}
+
+	std::vector<std::uint16_t> randomImage(const PixelFormat format) {
+		std::uniform_int_distribution<unsigned> dist(
+			0, (1u << getPixelDepth(format)) - 1);
+		std::vector<std::uint16_t> image(WIDTH * HEIGHT);
+		for (auto &p : image) {
+			p = dist(gen);
+		}
+		return image;
+	}
+
+	/**
+	 * Packs the pixels as the DMA words of a frame
+	 */
+	std::vector<std::uint64_t> pack(const std::vector<std::uint16_t> &image,
+									const PixelFormat format) {
+		const unsigned bits = getPixelBits(format);
+		std::vector<std::uint64_t> words(getFrameWords(format, image.size()));
+		auto bytes = reinterpret_cast<std::uint8_t*>(words.data());
+		for (size_t i = 0; i < image.size(); ++i) {
+			for (unsigned b = 0; b < bits; ++b) {
+				const size_t bit = i * bits + b;
+				if ((image[i] >> b) & 1) {
+					bytes[bit / 8] |= 1 << (bit % 8);
+				}
+			}
+		}
+		return words;
+	}
+
+	/**
+	 * Compresses and decompresses the image and returns the compressed size
+	 */
+	size_t roundTrip(const std::vector<std::uint16_t> &image,
+					 const PixelFormat format, const unsigned threads = 1) {
+		FrameCodec codec(WIDTH, HEIGHT, format, threads);
+		std::vector<std::uint8_t> data(codec.getMaxCompressedSize());
+		const size_t size = codec.compress(image.data(), data.data());
+		EXPECT_LE(size, data.size());
+
+		std::vector<std::uint16_t> out(WIDTH * HEIGHT, 0xDEAD);
+		codec.decompress(data.data(), size, out.data());
+		EXPECT_EQ(out, image);
+		return size;
+	}
+
+	static constexpr size_t WIDTH = 123;
+	static constexpr size_t HEIGHT = 77;
+
+	std::mt19937 gen{97531};
+};
+
+constexpr size_t FrameCodecTests::WIDTH;
+constexpr size_t FrameCodecTests::HEIGHT;
+
+class ErrorFrameCodecTests: public FrameCodecTests {};
+
+///////////////////////////////////////////////////////////////
+/// Frame Codec Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(FrameCodecTests, smoothImagesCompress) {
+	for (const auto format : {PixelFormat::Mono8, PixelFormat::Mono10,
+							  PixelFormat::Mono12, PixelFormat::Mono16}) {
+		const auto image = smoothImage(format);
+		const size_t size = roundTrip(image, format);
+		EXPECT_LT(size, image.size() * getPixelDepth(format) / 8 * 3 / 4);
+	}
+}
+
+TEST_F(FrameCodecTests, randomImagesAreBounded) {
+	for (const auto format : {PixelFormat::Mono8, PixelFormat::Mono12,
+							  PixelFormat::Mono16}) {
+		const auto image = randomImage(format);
+		const size_t size = roundTrip(image, format);
+		EXPECT_LT(size, image.size() * (getPixelDepth(format) + 2) / 8);
+	}
+}
+
+TEST_F(FrameCodecTests, constantAndExtremeImages) {
+	roundTrip(std::vector<std::uint16_t>(WIDTH * HEIGHT, 0),
+			  PixelFormat::Mono16);
+	roundTrip(std::vector<std::uint16_t>(WIDTH * HEIGHT, 0xFFFF),
+			  PixelFormat::Mono16);
+
+	// Alternating black and white pixels give the largest residuals
+	std::vector<std::uint16_t> image(WIDTH * HEIGHT);
+	for (size_t i = 0; i < image.size(); ++i) {
+		image[i] = (i % 2) ? 0x0FFF : 0;
+	}
+	roundTrip(image, PixelFormat::Mono12);
+}
+
+TEST_F(FrameCodecTests, severalThreads) {
+	const auto image = smoothImage(PixelFormat::Mono12);
+	roundTrip(image, PixelFormat::Mono12, 4);
+	roundTrip(image, PixelFormat::Mono12, 200);
+}
+
+TEST_F(FrameCodecTests, decompressWithOtherThreads) {
+	const auto image = smoothImage(PixelFormat::Mono16);
+	FrameCodec encoder(WIDTH, HEIGHT, PixelFormat::Mono16, 7);
+	FrameCodec decoder(WIDTH, HEIGHT, PixelFormat::Mono16, 2);
+	std::vector<std::uint8_t> data(encoder.getMaxCompressedSize());
+	const size_t size = encoder.compress(image.data(), data.data());
+
+	std::vector<std::uint16_t> out(WIDTH * HEIGHT);
+	decoder.decompress(data.data(), size, out.data());
+	EXPECT_EQ(out, image);
+}
+
+TEST_F(FrameCodecTests, compressFrameWords) {
+	for (const auto format : {PixelFormat::Mono8, PixelFormat::Mono10p,
+							  PixelFormat::Mono12p, PixelFormat::Mono16}) {
+		const auto image = smoothImage(format);
+		const auto words = pack(image, format);
+		FrameCodec codec(WIDTH, HEIGHT, format, 3);
+		ASSERT_EQ(codec.getFrameWords(), words.size());
+
+		std::vector<std::uint8_t> fromWords(codec.getMaxCompressedSize());
+		std::vector<std::uint8_t> fromImage(codec.getMaxCompressedSize());
+		const size_t size = codec.compressFrame(words.data(), fromWords.data());
+		ASSERT_EQ(size, codec.compress(image.data(), fromImage.data()));
+		fromWords.resize(size);
+		fromImage.resize(size);
+		EXPECT_EQ(fromWords, fromImage);
+	}
+}
+
+TEST_F(FrameCodecTests, ignoresBitsAboveDepth) {
+	auto image = smoothImage(PixelFormat::Mono10);
+	auto dirty = image;
+	for (auto &p : dirty) {
+		p |= 0xFC00;
+	}
+	FrameCodec codec(WIDTH, HEIGHT, PixelFormat::Mono10);
+	std::vector<std::uint8_t> data(codec.getMaxCompressedSize());
+	const size_t size = codec.compress(dirty.data(), data.data());
+	std::vector<std::uint16_t> out(WIDTH * HEIGHT);
+	codec.decompress(data.data(), size, out.data());
+	EXPECT_EQ(out, image);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Frame Codec Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorFrameCodecTests, invalidConfiguration) {
+	EXPECT_THROW(FrameCodec(0, 10, PixelFormat::Mono8);,
+				 errors::ImageStageError);
+	EXPECT_THROW(FrameCodec(10, 10, PixelFormat::Mono8, 70000);,
+				 errors::ImageStageError);
+}
+
+TEST_F(ErrorFrameCodecTests, otherDimensions) {
+	const auto image = smoothImage(PixelFormat::Mono8);
+	FrameCodec codec(WIDTH, HEIGHT, PixelFormat::Mono8);
+	std::vector<std::uint8_t> data(codec.getMaxCompressedSize());
+	const size_t size = codec.compress(image.data(), data.data());
+
+	std::vector<std::uint16_t> out(WIDTH * HEIGHT);
+	FrameCodec other(WIDTH, HEIGHT, PixelFormat::Mono12);
+	EXPECT_THROW(other.decompress(data.data(), size, out.data());,
+				 errors::CodecError);
+	FrameCodec smaller(WIDTH, HEIGHT - 1, PixelFormat::Mono8);
+	EXPECT_THROW(smaller.decompress(data.data(), size, out.data());,
+				 errors::CodecError);
+}
+
+TEST_F(ErrorFrameCodecTests, truncatedOrCorrupted) {
+	const auto image = smoothImage(PixelFormat::Mono12);
+	FrameCodec codec(WIDTH, HEIGHT, PixelFormat::Mono12, 2);
+	std::vector<std::uint8_t> data(codec.getMaxCompressedSize());
+	const size_t size = codec.compress(image.data(), data.data());
+
+	std::vector<std::uint16_t> out(WIDTH * HEIGHT);
+	EXPECT_THROW(codec.decompress(data.data(), size - 1, out.data());,
+				 errors::CodecError);
+	EXPECT_THROW(codec.decompress(data.data(), 10, out.data());,
+				 errors::CodecError);
+
+	data[0] ^= 0xFF;
+	EXPECT_THROW(codec.decompress(data.data(), size, out.data());,
+				 errors::CodecError);
+}
+
+TEST_F(ErrorFrameCodecTests, corruptedBandsStayInBounds) {
+	const auto image = smoothImage(PixelFormat::Mono16);
+	FrameCodec codec(WIDTH, HEIGHT, PixelFormat::Mono16, 3);
+	std::vector<std::uint8_t> data(codec.getMaxCompressedSize());
+	const size_t size = codec.compress(image.data(), data.data());
+
+	// Garbage in the bands decodes to a wrong image or throws, nothing else
+	std::uniform_int_distribution<size_t> position(32, size - 1);
+	std::vector<std::uint16_t> out(WIDTH * HEIGHT);
+	for (int i = 0; i < 50; ++i) {
+		auto corrupted = data;
+		for (int j = 0; j < 8; ++j) {
+			corrupted[position(gen)] ^= 0xFF;
+		}
+		try {
+			codec.decompress(corrupted.data(), size, out.data());
+		} catch (const errors::CodecError&) {
+		}
+	}
+}
@@ -0,0 +1,241 @@
+#include <memory>
+#include <set>
+
+#include "fixtures.h"
+#include "fff_nifpga.h"
+
+#include "irioCoreCpp.h"
+#include "imaq/frameGrabber.h"
+#include "imaq/framePool.h"
+#include "imaq/frameStats.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMACPUCommon.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+class FrameGrabberTests: public BaseTests {
+public:
+    FrameGrabberTests():
+        BaseTests("../../../resources/7966/NiFpga_FlexRIO_CPUIMAQ_7966.lvbitx",
+                    false) {    }
+
+    void SetUp() override {
+        init_ok_fff_nifpga();
+        setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::FlexRIO);
+        setValueForReg(ReadFunctions::NiFpga_ReadU8,
+                        bfp.getRegister(TERMINAL_DEVPROFILE).getAddress(),
+                        PROFILE_VALUE_IMAQ);
+        setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTSAMPLESIZE).getAddress(),
+						sampleSizeFake, 2);
+    }
+
+    const std::uint8_t sampleSizeFake[2] = {4,8};
+    const size_t imagePixelSize = 64;
+};
+
+class ErrorFrameGrabberTests: public FrameGrabberTests{};
+
+class FramePoolTests: public ::testing::Test {};
+
+NiFpga_Status funcFifoTimeout(NiFpga_Session, uint32_t, uint64_t*, size_t,
+        uint32_t, size_t*) {
+    return NiFpga_Status_FifoTimeout;
+}
+
+NiFpga_Status funcFifoError(NiFpga_Session, uint32_t, uint64_t*, size_t,
+        uint32_t, size_t*) {
+    return NiFpga_Status_InvalidParameter;
+}
+
+///////////////////////////////////////////////////////////////
+/// Frame Pool Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(FramePoolTests, acquireAll) {
+    FramePool pool(100, 4);
+    EXPECT_EQ(pool.getFreeFrames(), 4);
+
+    std::set<std::uint64_t*> frames;
+    for (size_t i = 0; i < 4; ++i) {
+        auto frame = pool.acquire();
+        ASSERT_NE(frame, nullptr);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(frame) % 64, 0);
+        frame[99] = i;
+        frames.insert(frame);
+    }
+    EXPECT_EQ(frames.size(), 4);
+    EXPECT_EQ(pool.acquire(), nullptr);
+    EXPECT_EQ(pool.getFreeFrames(), 0);
+}
+
+TEST_F(FramePoolTests, releaseFrame) {
+    FramePool pool(10, 1);
+    auto frame = pool.acquire();
+    pool.release(frame);
+    EXPECT_EQ(pool.getFreeFrames(), 1);
+    EXPECT_EQ(pool.acquire(), frame);
+}
+
+TEST_F(FramePoolTests, hugePagesFallback) {
+    FramePool pool(1024, 2, true);
+    EXPECT_EQ(pool.getNumFrames(), 2);
+    EXPECT_EQ(pool.getFrameElements(), 1024);
+    EXPECT_NE(pool.acquire(), nullptr);
+}
+
+TEST_F(FramePoolTests, invalidDimensions) {
+    EXPECT_THROW(FramePool(0, 4);, errors::FramePoolError);
+    EXPECT_THROW(FramePool(10, 0);, errors::FramePoolError);
+}
+
+TEST_F(FramePoolTests, releaseForeignFrame) {
+    FramePool pool(10, 2);
+    std::uint64_t other[10];
+    EXPECT_THROW(pool.release(other);, errors::FramePoolError);
+    auto frame = pool.acquire();
+    EXPECT_THROW(pool.release(frame + 1);, errors::FramePoolError);
+}
+
+TEST_F(FramePoolTests, releaseTwice) {
+    FramePool pool(10, 2);
+    auto frame = pool.acquire();
+    pool.release(frame);
+    EXPECT_THROW(pool.release(frame);, errors::FramePoolError);
+}
+
+///////////////////////////////////////////////////////////////
+/// Frame Grabber Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(FrameGrabberTests, createFrameGrabber) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto grabber = irio.getTerminalsIMAQ().createFrameGrabber(0,
+                                                    imagePixelSize, 4);
+    EXPECT_EQ(grabber->getFrameElements(),
+              imagePixelSize * sampleSizeFake[0] / 8);
+    EXPECT_EQ(grabber->getPool().getNumFrames(), 4);
+}
+
+TEST_F(FrameGrabberTests, getFrame) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameGrabber grabber(irio.getTerminalsIMAQ(), 0, imagePixelSize, 4);
+
+    Frame frame1, frame2;
+    grabber.getFrame(&frame1, 1000);
+    grabber.getFrame(&frame2, 1000);
+    EXPECT_EQ(frame1.elements, grabber.getFrameElements());
+    EXPECT_GT(frame2.frameNumber, frame1.frameNumber);
+    EXPECT_GE(frame2.timestamp, frame1.timestamp);
+    EXPECT_NE(frame1.data, frame2.data);
+    EXPECT_EQ(frame1.stats, nullptr);
+    grabber.releaseFrame(frame1);
+    grabber.releaseFrame(frame2);
+}
+
+TEST_F(FrameGrabberTests, frameStatistics) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto stage = std::make_shared<FrameStatsStage>(8, 8, PixelFormat::Mono8,
+                                                   16);
+    auto grabber = irio.getTerminalsIMAQ().createFrameGrabber(0,
+                                    imagePixelSize, 4, 0, false, stage);
+
+    Frame frame1, frame2;
+    grabber->getFrame(&frame1, 1000);
+    grabber->getFrame(&frame2, 1000);
+    ASSERT_NE(frame1.stats, nullptr);
+    ASSERT_NE(frame2.stats, nullptr);
+    EXPECT_NE(frame1.stats, frame2.stats);
+    ASSERT_EQ(frame1.stats->histogram.size(), 16);
+
+    FrameStats expected;
+    stage->process(frame1.data, &expected);
+    EXPECT_EQ(frame1.stats->histogram, expected.histogram);
+    EXPECT_EQ(frame1.stats->min, expected.min);
+    EXPECT_EQ(frame1.stats->max, expected.max);
+    grabber->releaseFrame(frame1);
+    grabber->releaseFrame(frame2);
+}
+
+TEST_F(FrameGrabberTests, dropsWhenNotRead) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameGrabber grabber(irio.getTerminalsIMAQ(), 0, imagePixelSize, 2);
+
+    // The fake DMA has always data, frames are dropped until read
+    while (grabber.getDroppedFrames() == 0) {
+        std::this_thread::yield();
+    }
+
+    Frame frame;
+    grabber.getFrame(&frame, 1000);
+    EXPECT_GT(frame.frameNumber, 0);
+    EXPECT_GT(frame.droppedFrames, 0);
+    EXPECT_LE(grabber.getQueuedFrames(), 2);
+    grabber.releaseFrame(frame);
+}
+
+TEST_F(FrameGrabberTests, drainsWithAllFramesHeld) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameGrabber grabber(irio.getTerminalsIMAQ(), 0, imagePixelSize, 1);
+
+    Frame frame;
+    grabber.getFrame(&frame, 1000);
+    const auto acquired = grabber.getFramesAcquired();
+    while (grabber.getFramesAcquired() < acquired + 10) {
+        std::this_thread::yield();
+    }
+    EXPECT_GT(grabber.getDroppedFrames(), 0);
+    grabber.releaseFrame(frame);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Frame Grabber Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorFrameGrabberTests, invalidDMA) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    EXPECT_THROW(irio.getTerminalsIMAQ().createFrameGrabber(10,
+                                                    imagePixelSize, 4);,
+                 errors::ResourceNotFoundError);
+}
+
+TEST_F(ErrorFrameGrabberTests, statsStageLargerThanImage) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto stage = std::make_shared<FrameStatsStage>(64, 64,
+                                                   PixelFormat::Mono8);
+    EXPECT_THROW(FrameGrabber(irio.getTerminalsIMAQ(), 0, imagePixelSize, 4,
+                              0, false, stage);,
+                 errors::ImageStageError);
+}
+
+TEST_F(ErrorFrameGrabberTests, getFrameTimeout) {
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoTimeout;
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameGrabber grabber(irio.getTerminalsIMAQ(), 0, imagePixelSize, 4);
+
+    Frame frame;
+    EXPECT_THROW(grabber.getFrame(&frame, 10);, errors::DMAReadTimeout);
+    EXPECT_FALSE(grabber.tryGetFrame(&frame));
+}
+
+TEST_F(ErrorFrameGrabberTests, acquisitionError) {
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoError;
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameGrabber grabber(irio.getTerminalsIMAQ(), 0, imagePixelSize, 4);
+
+    Frame frame;
+    EXPECT_THROW(grabber.getFrame(&frame, 1000);, errors::NiFpgaError);
+}
+
+TEST_F(ErrorFrameGrabberTests, releaseTwice) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameGrabber grabber(irio.getTerminalsIMAQ(), 0, imagePixelSize, 4);
+
+    Frame frame;
+    grabber.getFrame(&frame, 1000);
+    grabber.releaseFrame(frame);
+    EXPECT_THROW(grabber.releaseFrame(frame);, errors::FramePoolError);
+}
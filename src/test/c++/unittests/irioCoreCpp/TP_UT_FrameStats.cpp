@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "imaq/frameStats.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+class FrameStatsTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random frame of the given format and its unpacked pixels, with values
+	 * up to \p maxValue
+	 */
+	void makeFrame(const PixelFormat format, unsigned maxValue = 0) {
+		const unsigned bits = getPixelBits(format);
+		if (maxValue == 0) {
+			maxValue = (1u << getPixelDepth(format)) - 1;
+		}
+		std::uniform_int_distribution<unsigned> dist(0, maxValue);
+		pixels.resize(WIDTH * HEIGHT);
+		for (auto &p : pixels) {
+			p = dist(gen);
+		}
+		words.assign(getFrameWords(format, pixels.size()), 0);
+		auto bytes = reinterpret_cast<std::uint8_t*>(words.data());
+		for (size_t i = 0; i < pixels.size(); ++i) {
+			for (unsigned b = 0; b < bits; ++b) {
+				const size_t bit = i * bits + b;
+				if ((pixels[i] >> b) & 1) {
+					bytes[bit / 8] |= 1 << (bit % 8);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Reference statistics of the unpacked pixels
+	 */
+	FrameStats reference(const PixelFormat format, const size_t bins,
+						 const std::uint16_t saturation) const {
+		FrameStats stats;
+		stats.histogram.assign(bins, 0);
+		stats.min = *std::min_element(pixels.begin(), pixels.end());
+		stats.max = *std::max_element(pixels.begin(), pixels.end());
+		const size_t values = size_t(1) << getPixelDepth(format);
+		double sum = 0, sumX = 0, sumY = 0;
+		for (size_t y = 0; y < HEIGHT; ++y) {
+			for (size_t x = 0; x < WIDTH; ++x) {
+				const std::uint16_t v = pixels[y * WIDTH + x];
+				stats.histogram[v * bins / values]++;
+				stats.saturatedPixels += v >= saturation;
+				sum += v;
+				sumX += x * v;
+				sumY += y * v;
+			}
+		}
+		stats.mean = sum / pixels.size();
+		stats.centroidX = sum ? sumX / sum : 0;
+		stats.centroidY = sum ? sumY / sum : 0;
+		return stats;
+	}
+
+	void check(const PixelFormat format, const size_t bins = 256,
+			   const std::uint16_t saturation = 0,
+			   const unsigned threads = 1) {
+		makeFrame(format);
+		FrameStatsStage stage(WIDTH, HEIGHT, format, bins, saturation,
+							  threads);
+		ASSERT_EQ(stage.getFrameWords(), words.size());
+		const auto expected =
+			reference(format, stage.getHistogramBins(),
+					  stage.getSaturationLevel());
+
+		FrameStats stats;
+		std::vector<std::uint16_t> image(WIDTH * HEIGHT, 0xDEAD);
+		stage.process(words.data(), &stats, image.data(), GetParam());
+		expectStats(stats, expected);
+		EXPECT_EQ(image, pixels);
+
+		// Statistics only, reusing the result
+		stage.process(words.data(), &stats, nullptr, GetParam());
+		expectStats(stats, expected);
+	}
+
+	void expectStats(const FrameStats &stats, const FrameStats &expected) {
+		EXPECT_EQ(stats.histogram, expected.histogram);
+		EXPECT_EQ(stats.min, expected.min);
+		EXPECT_EQ(stats.max, expected.max);
+		EXPECT_EQ(stats.saturatedPixels, expected.saturatedPixels);
+		EXPECT_DOUBLE_EQ(stats.mean, expected.mean);
+		EXPECT_DOUBLE_EQ(stats.centroidX, expected.centroidX);
+		EXPECT_DOUBLE_EQ(stats.centroidY, expected.centroidY);
+	}
+
+	static constexpr size_t WIDTH = 101;
+	static constexpr size_t HEIGHT = 64;
+
+	std::vector<std::uint16_t> pixels;
+	std::vector<std::uint64_t> words;
+	std::mt19937 gen{1234};
+};
+
+constexpr size_t FrameStatsTests::WIDTH;
+constexpr size_t FrameStatsTests::HEIGHT;
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, FrameStatsTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Frame Stats Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(FrameStatsTests, statsMono8) {
+	check(PixelFormat::Mono8);
+}
+
+TEST_P(FrameStatsTests, statsMono10p) {
+	check(PixelFormat::Mono10p, 64);
+}
+
+TEST_P(FrameStatsTests, statsMono12) {
+	check(PixelFormat::Mono12, 0, 4000);
+}
+
+TEST_P(FrameStatsTests, statsMono16) {
+	check(PixelFormat::Mono16, 1024, 60000);
+}
+
+TEST_P(FrameStatsTests, singleBin) {
+	check(PixelFormat::Mono12p, 1);
+}
+
+TEST_P(FrameStatsTests, severalThreads) {
+	check(PixelFormat::Mono12p, 256, 0, 4);
+	check(PixelFormat::Mono8, 16, 200, 100);
+}
+
+TEST_P(FrameStatsTests, blackFrame) {
+	makeFrame(PixelFormat::Mono8, 0);
+	std::fill(words.begin(), words.end(), 0);
+	FrameStatsStage stage(WIDTH, HEIGHT, PixelFormat::Mono8);
+	FrameStats stats;
+	stage.process(words.data(), &stats, nullptr, GetParam());
+	EXPECT_EQ(stats.histogram[0], WIDTH * HEIGHT);
+	EXPECT_EQ(stats.max, 0);
+	EXPECT_EQ(stats.saturatedPixels, 0);
+	EXPECT_EQ(stats.mean, 0);
+	EXPECT_EQ(stats.centroidX, 0);
+	EXPECT_EQ(stats.centroidY, 0);
+}
+
+TEST_P(FrameStatsTests, centroidOfASpot) {
+	std::vector<std::uint64_t> frame(WIDTH * HEIGHT / 8 + 1, 0);
+	auto bytes = reinterpret_cast<std::uint8_t*>(frame.data());
+	bytes[10 * WIDTH + 20] = 100;
+	bytes[10 * WIDTH + 22] = 100;
+	bytes[12 * WIDTH + 21] = 200;
+	FrameStatsStage stage(WIDTH, HEIGHT, PixelFormat::Mono8, 256, 200);
+	FrameStats stats;
+	stage.process(frame.data(), &stats, nullptr, GetParam());
+	EXPECT_DOUBLE_EQ(stats.centroidX, 21);
+	EXPECT_DOUBLE_EQ(stats.centroidY, 11);
+	EXPECT_EQ(stats.saturatedPixels, 1);
+	EXPECT_EQ(stats.max, 200);
+}
+
+TEST(FrameStatsStageTests, defaultParameters) {
+	FrameStatsStage stage(640, 480, PixelFormat::Mono10p, 0);
+	EXPECT_EQ(stage.getHistogramBins(), 1024);
+	EXPECT_EQ(stage.getSaturationLevel(), 1023);
+	EXPECT_EQ(stage.getFrameWords(), 640 * 480 * 10 / 64);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Frame Stats Tests
+///////////////////////////////////////////////////////////////
+
+TEST(ErrorFrameStatsStageTests, invalidBins) {
+	EXPECT_THROW(FrameStatsStage(64, 64, PixelFormat::Mono8, 100);,
+				 errors::ImageStageError);
+	EXPECT_THROW(FrameStatsStage(64, 64, PixelFormat::Mono8, 512);,
+				 errors::ImageStageError);
+	EXPECT_THROW(FrameStatsStage(64, 64, PixelFormat::Mono10, 2048);,
+				 errors::ImageStageError);
+}
+
+TEST(ErrorFrameStatsStageTests, emptyFrame) {
+	EXPECT_THROW(FrameStatsStage(0, 64, PixelFormat::Mono8);,
+				 errors::ImageStageError);
+	EXPECT_THROW(FrameStatsStage(64, 0, PixelFormat::Mono8);,
+				 errors::ImageStageError);
+}
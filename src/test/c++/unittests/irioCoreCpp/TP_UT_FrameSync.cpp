@@ -0,0 +1,209 @@
+#include <deque>
+
+#include "fixtures.h"
+#include "fff_nifpga.h"
+
+#include "irioCoreCpp.h"
+#include "imaq/frameSync.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMACPUCommon.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+static std::deque<std::uint64_t> streamFake;
+
+/**
+ * Reads the elements from the fake stream, times out if there are not enough
+ */
+NiFpga_Status funcFifoStream(NiFpga_Session, uint32_t, uint64_t* data,
+        size_t numElements, uint32_t, size_t*) {
+    if (streamFake.size() < numElements) {
+        return NiFpga_Status_FifoTimeout;
+    }
+    for (size_t i = 0; i < numElements; ++i) {
+        data[i] = streamFake.front();
+        streamFake.pop_front();
+    }
+    return NiFpga_Status_Success;
+}
+
+class FrameSyncTests: public BaseTests {
+public:
+    FrameSyncTests():
+        BaseTests("../../../resources/7966/NiFpga_FlexRIO_CPUIMAQ_7966.lvbitx",
+                    false) {    }
+
+    void SetUp() override {
+        init_ok_fff_nifpga();
+        setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::FlexRIO);
+        setValueForReg(ReadFunctions::NiFpga_ReadU8,
+                        bfp.getRegister(TERMINAL_DEVPROFILE).getAddress(),
+                        PROFILE_VALUE_IMAQ);
+        setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTSAMPLESIZE).getAddress(),
+						sampleSizeFake, 2);
+        streamFake.clear();
+        NiFpga_ReadFifoU64_fake.custom_fake = funcFifoStream;
+    }
+
+    /**
+     * Writes a frame in the fake stream, removing the last \p missing
+     * elements of the image and the end of frame word if \p missing > 0
+     */
+    void pushFrame(const std::uint32_t counter, const size_t missing = 0) {
+        streamFake.push_back(
+            (static_cast<std::uint64_t>(DEFAULT_SOF_MARKER) << 32) | counter);
+        for (size_t i = 0; i < imageElements - missing; ++i) {
+            streamFake.push_back(counter * 100 + i);
+        }
+        if (missing == 0) {
+            streamFake.push_back(
+                (static_cast<std::uint64_t>(DEFAULT_EOF_MARKER) << 32) |
+                counter);
+        }
+    }
+
+    void expectImage(const std::uint64_t *image, const std::uint32_t counter) {
+        for (size_t i = 0; i < imageElements; ++i) {
+            EXPECT_EQ(image[i], counter * 100 + i);
+        }
+    }
+
+    const std::uint8_t sampleSizeFake[2] = {4,8};
+    const size_t imagePixelSize = 16;
+    const size_t imageElements = 8;
+};
+
+class ErrorFrameSyncTests: public FrameSyncTests{};
+
+///////////////////////////////////////////////////////////////
+/// Frame Sync Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(FrameSyncTests, createFrameSynchronizer) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto sync = irio.getTerminalsIMAQ().createFrameSynchronizer(0,
+                                                    imagePixelSize);
+    EXPECT_EQ(sync->getImageElements(), imageElements);
+    EXPECT_EQ(sync->getFramesRead(), 0);
+}
+
+TEST_F(FrameSyncTests, readAlignedFrames) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameSynchronizer sync(irio.getTerminalsIMAQ(), 0, imagePixelSize);
+    pushFrame(1);
+    pushFrame(2);
+
+    std::uint64_t image[8];
+    EXPECT_EQ(sync.readFrame(image, 10), 1);
+    expectImage(image, 1);
+    EXPECT_EQ(sync.readFrame(image, 10), 2);
+    expectImage(image, 2);
+    EXPECT_EQ(sync.getFramesRead(), 2);
+    EXPECT_EQ(sync.getDroppedFrames(), 0);
+    EXPECT_EQ(sync.getTornFrames(), 0);
+    EXPECT_EQ(sync.getDiscardedElements(), 0);
+}
+
+TEST_F(FrameSyncTests, startInTheMiddleOfAFrame) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameSynchronizer sync(irio.getTerminalsIMAQ(), 0, imagePixelSize);
+    pushFrame(4);
+    streamFake.erase(streamFake.begin(), streamFake.begin() + 3);
+    pushFrame(5);
+
+    std::uint64_t image[8];
+    EXPECT_EQ(sync.readFrame(image, 10), 5);
+    expectImage(image, 5);
+    EXPECT_EQ(sync.getTornFrames(), 0);
+    EXPECT_EQ(sync.getDiscardedElements(), imageElements + 2 - 3);
+}
+
+TEST_F(FrameSyncTests, resyncAfterTornFrame) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameSynchronizer sync(irio.getTerminalsIMAQ(), 0, imagePixelSize);
+    pushFrame(1);
+    pushFrame(2, 3);
+    pushFrame(3);
+    pushFrame(4);
+
+    std::uint64_t image[8];
+    EXPECT_EQ(sync.readFrame(image, 10), 1);
+    EXPECT_EQ(sync.readFrame(image, 10), 3);
+    expectImage(image, 3);
+    EXPECT_EQ(sync.readFrame(image, 10), 4);
+    expectImage(image, 4);
+    EXPECT_EQ(sync.getTornFrames(), 1);
+    EXPECT_EQ(sync.getDroppedFrames(), 1);
+    EXPECT_TRUE(streamFake.empty());
+}
+
+TEST_F(FrameSyncTests, countDroppedFrames) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameSynchronizer sync(irio.getTerminalsIMAQ(), 0, imagePixelSize);
+    pushFrame(0xFFFFFFFE);
+    pushFrame(2);
+
+    std::uint64_t image[8];
+    EXPECT_EQ(sync.readFrame(image, 10), 0xFFFFFFFE);
+    EXPECT_EQ(sync.readFrame(image, 10), 0x100000002);
+    EXPECT_EQ(sync.getDroppedFrames(), 3);
+}
+
+TEST_F(FrameSyncTests, withoutCounter) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameSynchronizer sync(irio.getTerminalsIMAQ(), 0, imagePixelSize, false);
+    pushFrame(0);
+    pushFrame(0);
+
+    std::uint64_t image[8];
+    EXPECT_EQ(sync.readFrame(image, 10), 0);
+    EXPECT_EQ(sync.readFrame(image, 10), 1);
+    EXPECT_EQ(sync.getDroppedFrames(), 0);
+}
+
+TEST_F(FrameSyncTests, customMarkers) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameSynchronizer sync(irio.getTerminalsIMAQ(), 0, imagePixelSize, true,
+                           0x1234, 0x5678);
+    streamFake.push_back(0x0000123400000007);
+    for (size_t i = 0; i < imageElements; ++i) {
+        streamFake.push_back(700 + i);
+    }
+    streamFake.push_back(0x0000567800000007);
+
+    std::uint64_t image[8];
+    EXPECT_EQ(sync.readFrame(image, 10), 7);
+    expectImage(image, 7);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Frame Sync Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorFrameSyncTests, invalidDMA) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    EXPECT_THROW(irio.getTerminalsIMAQ().createFrameSynchronizer(10,
+                                                    imagePixelSize);,
+                 errors::ResourceNotFoundError);
+}
+
+TEST_F(ErrorFrameSyncTests, timeoutKeepsData) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    FrameSynchronizer sync(irio.getTerminalsIMAQ(), 0, imagePixelSize);
+    pushFrame(9);
+    const auto eof = streamFake.back();
+    streamFake.pop_back();
+
+    std::uint64_t image[8];
+    EXPECT_THROW(sync.readFrame(image, 10);, errors::DMAReadTimeout);
+
+    streamFake.push_back(eof);
+    std::uint64_t other[8];
+    EXPECT_EQ(sync.readFrame(other, 10), 9);
+    expectImage(other, 9);
+    EXPECT_EQ(sync.getTornFrames(), 0);
+}
@@ -9,9 +9,12 @@
 #include "irioCoreCpp.h"
 #include "errorsIrio.h"
 
-#include "profiles/profileCPUDAQFlexRIO.h"
+#include "profiles/profileGPUDAQFlexRIO.h"
+#include "profiles/profileGPUIMAQFlexRIO.h"
 #include "terminals/names/namesTerminalsCommon.h"
 #include "terminals/names/namesTerminalsFlexRIO.h"
+#include "terminals/names/namesTerminalsDMAGPUCommon.h"
+#include "terminals/names/namesTerminalsDMADAQGPU.h"
 
 
 using namespace irio;
@@ -46,18 +49,159 @@ public:
 };
 
 
+class FakeBufferSink: public DMABufferSink {
+public:
+	NiFpga_Status acquire(const NiFpga_Session &, const std::uint32_t,
+						  const size_t elementsToAcquire, const std::uint32_t,
+						  std::uint64_t **data,
+						  size_t *elementsAcquired) override {
+		buffer.assign(elementsToAcquire, 0xCAFE);
+		*data = buffer.data();
+		*elementsAcquired = elementsToAcquire;
+		return NiFpga_Status_Success;
+	}
+
+	NiFpga_Status release(const NiFpga_Session &, const std::uint32_t,
+						  const size_t elementsToRelease) override {
+		released += elementsToRelease;
+		return NiFpga_Status_Success;
+	}
+
+	std::vector<std::uint64_t> buffer;
+	size_t released = 0;
+};
+
+
 ///////////////////////////////////////////////////////////////
 /// GPU DAQ Tests
 ///////////////////////////////////////////////////////////////
-TEST_F(FlexRIOGPUDAQ, ProfileNotImplementedError){
-	EXPECT_THROW(Irio irio(bitfilePath, "0", "V9.9"),
-				 errors::ProfileNotImplementedError);
+TEST_F(FlexRIOGPUDAQ, ProfileGPUDAQ){
+	Irio irio(bitfilePath, "0", "V9.9");
+	EXPECT_EQ(irio.getProfileID(), PROFILE_ID::FLEXRIO_GPUDAQ);
+	EXPECT_NO_THROW(irio.getTerminalsDAQ());
+	EXPECT_NO_THROW(irio.getTerminalsFlexRIO());
+}
+
+TEST_F(FlexRIOGPUDAQ, TerminalsIMAQNotImplemented){
+	Irio irio(bitfilePath, "0", "V9.9");
+	EXPECT_THROW(irio.getTerminalsIMAQ(), errors::TerminalNotImplementedError);
+}
+
+TEST_F(FlexRIOGPUDAQ, StartAllDMAsHostBufferDepth){
+	Irio irio(bitfilePath, "0", "V9.9");
+	auto daq = irio.getTerminalsDAQ();
+	daq.setHostBufferDepth(8192);
+	EXPECT_EQ(daq.getHostBufferDepth(), 8192);
+
+	daq.startAllDMAs();
+	EXPECT_EQ(NiFpga_ConfigureFifo_fake.arg2_val, 8192);
+}
+
+TEST_F(FlexRIOGPUDAQ, AcquireReleaseData){
+	Irio irio(bitfilePath, "0", "V9.9");
+	auto daq = irio.getTerminalsDAQ();
+
+	std::uint64_t *data = nullptr;
+	EXPECT_EQ(daq.acquireData(0, 64, &data, true, 100), 64);
+	ASSERT_NE(data, nullptr);
+	EXPECT_EQ(data[0], 7);
+	EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.call_count, 1);
+
+	EXPECT_NO_THROW(daq.releaseData(0, 64));
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.call_count, 1);
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.arg2_val, 64);
+}
+
+TEST_F(FlexRIOGPUDAQ, AcquireDataNonBlockingNotEnoughElements){
+	Irio irio(bitfilePath, "0", "V9.9");
+	auto daq = irio.getTerminalsDAQ();
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = nullptr;
+	NiFpga_AcquireFifoReadElementsU64_fake.return_val =
+		NiFpga_Status_FifoTimeout;
+
+	std::uint64_t *data = nullptr;
+	EXPECT_EQ(daq.acquireData(0, 64, &data, false), 0);
+}
+
+TEST_F(FlexRIOGPUDAQ, AcquireDataTimeout){
+	Irio irio(bitfilePath, "0", "V9.9");
+	auto daq = irio.getTerminalsDAQ();
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = nullptr;
+	NiFpga_AcquireFifoReadElementsU64_fake.return_val =
+		NiFpga_Status_FifoTimeout;
+
+	std::uint64_t *data = nullptr;
+	EXPECT_THROW(daq.acquireData(0, 64, &data, true, 1),
+				 errors::DMAReadTimeout);
+}
+
+TEST_F(FlexRIOGPUDAQ, CustomBufferSink){
+	Irio irio(bitfilePath, "0", "V9.9");
+	auto daq = irio.getTerminalsDAQ();
+	auto sink = std::make_shared<FakeBufferSink>();
+	daq.setBufferSink(sink);
+
+	std::uint64_t *data = nullptr;
+	EXPECT_EQ(daq.acquireData(0, 16, &data, true), 16);
+	EXPECT_EQ(data, sink->buffer.data());
+	EXPECT_EQ(data[15], 0xCAFE);
+	daq.releaseData(0, 16);
+	EXPECT_EQ(sink->released, 16);
+	EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.call_count, 0);
+
+	daq.setBufferSink(nullptr);
+	EXPECT_EQ(daq.acquireData(0, 16, &data, true), 16);
+	EXPECT_EQ(NiFpga_AcquireFifoReadElementsU64_fake.call_count, 1);
+}
+
+///////////////////////////////////////////////////////////////
+/// GPU DAQ Error Tests
+///////////////////////////////////////////////////////////////
+TEST_F(FlexRIOGPUDAQ, AcquireDataInvalidDMA){
+	Irio irio(bitfilePath, "0", "V9.9");
+	std::uint64_t *data = nullptr;
+	EXPECT_THROW(irio.getTerminalsDAQ().acquireData(100, 16, &data, true),
+				 errors::ResourceNotFoundError);
+}
+
+TEST_F(FlexRIOGPUDAQ, AcquireDataNiFpgaError){
+	Irio irio(bitfilePath, "0", "V9.9");
+	auto daq = irio.getTerminalsDAQ();
+	NiFpga_AcquireFifoReadElementsU64_fake.custom_fake = nullptr;
+	NiFpga_AcquireFifoReadElementsU64_fake.return_val = -1;
+
+	std::uint64_t *data = nullptr;
+	EXPECT_THROW(daq.acquireData(0, 16, &data, true), errors::NiFpgaError);
+}
+
+TEST_F(FlexRIOGPUDAQ, ReleaseDataNiFpgaError){
+	Irio irio(bitfilePath, "0", "V9.9");
+	NiFpga_ReleaseFifoElements_fake.return_val = -1;
+	EXPECT_THROW(irio.getTerminalsDAQ().releaseData(0, 16),
+				 errors::NiFpgaError);
 }
 
 ///////////////////////////////////////////////////////////////
 /// GPU IMAQ Tests
 ///////////////////////////////////////////////////////////////
-TEST_F(FlexRIOGPUIMAQ, ProfileNotImplementedError){
-	EXPECT_THROW(Irio irio(bitfilePath, "0", "V9.9"),
-				 errors::ProfileNotImplementedError);
+TEST_F(FlexRIOGPUIMAQ, ProfileGPUIMAQ){
+	Irio irio(bitfilePath, "0", "V9.9");
+	EXPECT_EQ(irio.getProfileID(), PROFILE_ID::FLEXRIO_GPUIMAQ);
+	EXPECT_NO_THROW(irio.getTerminalsIMAQ());
+	EXPECT_NO_THROW(irio.getTerminalsFlexRIO());
+}
+
+TEST_F(FlexRIOGPUIMAQ, TerminalsDAQNotImplemented){
+	Irio irio(bitfilePath, "0", "V9.9");
+	EXPECT_THROW(irio.getTerminalsDAQ(), errors::TerminalNotImplementedError);
+}
+
+TEST_F(FlexRIOGPUIMAQ, AcquireReleaseImage){
+	Irio irio(bitfilePath, "0", "V9.9");
+	auto imaq = irio.getTerminalsIMAQ();
+
+	std::uint64_t *data = nullptr;
+	EXPECT_EQ(imaq.acquireData(0, 1024, &data, false), 1024);
+	EXPECT_NO_THROW(imaq.releaseData(0, 1024));
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.arg2_val, 1024);
 }
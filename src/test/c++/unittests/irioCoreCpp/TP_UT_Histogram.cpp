@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "daq/histogram.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class HistogramTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random samples of each channel, around a different level each
+	 */
+	std::vector<std::vector<std::int16_t>> makeChannels(const size_t channels,
+														const size_t samples) {
+		std::vector<std::vector<std::int16_t>> in(
+			channels, std::vector<std::int16_t>(samples));
+		for (size_t c = 0; c < channels; ++c) {
+			std::normal_distribution<double> dist(-20000.0 + 10000.0 * c,
+												  8000);
+			for (auto &v : in[c]) {
+				v = static_cast<std::int16_t>(
+					std::min(std::max(dist(gen), -32768.0), 32767.0));
+			}
+		}
+		return in;
+	}
+
+	/**
+	 * Histogram of the values, computed one by one
+	 */
+	HistogramCounts reference(const std::vector<std::int64_t> &values,
+							  const MCAHistogram &histogram) {
+		HistogramCounts counts{
+			std::vector<std::uint64_t>(histogram.getBins(), 0), 0, 0};
+		const std::int64_t width = std::int64_t(1) << histogram.getShift();
+		for (const auto v : values) {
+			if (v < histogram.getMinimum()) {
+				++counts.underflow;
+				continue;
+			}
+			const std::int64_t bin = (v - histogram.getMinimum()) / width;
+			if (bin >= static_cast<std::int64_t>(histogram.getBins())) {
+				++counts.overflow;
+			} else {
+				++counts.bins[bin];
+			}
+		}
+		return counts;
+	}
+
+	void expectCounts(const HistogramCounts &counts,
+					  const HistogramCounts &expected) {
+		EXPECT_EQ(counts.bins, expected.bins);
+		EXPECT_EQ(counts.underflow, expected.underflow);
+		EXPECT_EQ(counts.overflow, expected.overflow);
+	}
+
+	/**
+	 * Adds the samples in blocks of random sizes and compares each
+	 * channel with the reference
+	 */
+	void checkSamples(const size_t bins, const std::int32_t minimum,
+					  const unsigned shift) {
+		const size_t channels = 4, samples = 30000;
+		const auto in = makeChannels(channels, samples);
+		MCAHistogram histogram(channels, bins, minimum, shift);
+		{
+			MCAHistogram::Accumulator accumulator(&histogram, 5000);
+			std::uniform_int_distribution<size_t> blockSize(1, 3000);
+			size_t first = 0;
+			while (first < samples) {
+				const size_t count = std::min(blockSize(gen), samples - first);
+				std::vector<const std::int16_t*> inputs;
+				for (const auto &channel : in) {
+					inputs.push_back(channel.data() + first);
+				}
+				accumulator.addSamples(inputs.data(), count, GetParam());
+				first += count;
+			}
+		}
+
+		HistogramCounts counts;
+		for (size_t c = 0; c < channels; ++c) {
+			histogram.getSnapshot(c, &counts);
+			expectCounts(counts,
+						 reference(std::vector<std::int64_t>(in[c].begin(),
+															 in[c].end()),
+								   histogram));
+		}
+	}
+
+	std::mt19937 gen{11235};
+};
+
+class ErrorHistogramTests: public ::testing::Test {};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, HistogramTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Histogram Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(HistogramTests, rawSamples) {
+	checkSamples(65536, -32768, 0);
+	checkSamples(1024, -32768, 6);
+	// Values on both sides of the range
+	checkSamples(1000, -10000, 4);
+	checkSamples(3, 100, 11);
+}
+
+TEST_P(HistogramTests, pulseAmplitudes) {
+	MCAHistogram histogram(3, 512, 100, 7);
+	std::uniform_int_distribution<int> amplitude(0, 70000);
+	std::vector<std::vector<std::int64_t>> values(3);
+	{
+		MCAHistogram::Accumulator accumulator(&histogram);
+		for (int block = 0; block < 50; ++block) {
+			std::vector<Pulse> pulses(200);
+			for (size_t p = 0; p < pulses.size(); ++p) {
+				pulses[p].channel = (p * 7 + block) % 3;
+				pulses[p].amplitude = amplitude(gen);
+				values[pulses[p].channel].push_back(pulses[p].amplitude);
+			}
+			accumulator.addPulses(pulses);
+		}
+	}
+
+	HistogramCounts counts;
+	for (size_t c = 0; c < 3; ++c) {
+		histogram.getSnapshot(c, &counts);
+		expectCounts(counts, reference(values[c], histogram));
+	}
+}
+
+TEST_P(HistogramTests, values) {
+	MCAHistogram histogram(2, 4096, -5000, 3);
+	std::uniform_int_distribution<std::int32_t> dist(-6000, 40000);
+	std::vector<std::int32_t> values(10000);
+	for (auto &v : values) {
+		v = dist(gen);
+	}
+	MCAHistogram::Accumulator accumulator(&histogram, 1000);
+	accumulator.addValues(1, values.data(), values.size());
+	// Values after the last automatic merge
+	EXPECT_GT(accumulator.getPending(), 0);
+	EXPECT_LT(accumulator.getPending(), 1000);
+	accumulator.merge();
+	EXPECT_EQ(accumulator.getPending(), 0);
+
+	HistogramCounts counts;
+	histogram.getSnapshot(1, &counts);
+	expectCounts(counts, reference(std::vector<std::int64_t>(values.begin(),
+															 values.end()),
+								   histogram));
+	histogram.getSnapshot(0, &counts);
+	EXPECT_EQ(counts.underflow + counts.overflow, 0);
+}
+
+TEST_P(HistogramTests, severalThreads) {
+	const size_t threads = 4, channels = 2, samples = 20000;
+	MCAHistogram histogram(channels, 256, -32768, 8);
+	std::vector<std::vector<std::vector<std::int16_t>>> in;
+	std::vector<std::vector<std::int64_t>> all(channels);
+	for (size_t t = 0; t < threads; ++t) {
+		in.push_back(makeChannels(channels, samples));
+		for (size_t c = 0; c < channels; ++c) {
+			all[c].insert(all[c].end(), in[t][c].begin(), in[t][c].end());
+		}
+	}
+
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t]() {
+			MCAHistogram::Accumulator accumulator(&histogram, 4096);
+			for (size_t first = 0; first < samples; first += 1000) {
+				std::vector<const std::int16_t*> inputs;
+				for (const auto &channel : in[t]) {
+					inputs.push_back(channel.data() + first);
+				}
+				accumulator.addSamples(inputs.data(), 1000, GetParam());
+			}
+		});
+	}
+	// Live read-out while the threads add samples
+	HistogramCounts counts;
+	for (int i = 0; i < 100; ++i) {
+		histogram.getSnapshot(0, &counts);
+	}
+	for (auto &worker : workers) {
+		worker.join();
+	}
+
+	for (size_t c = 0; c < channels; ++c) {
+		histogram.getSnapshot(c, &counts);
+		expectCounts(counts, reference(all[c], histogram));
+	}
+}
+
+TEST_P(HistogramTests, mergeAndSnapshots) {
+	MCAHistogram histogram(1, 16, 0, 0);
+	MCAHistogram::Accumulator accumulator(&histogram, 100);
+	const std::vector<std::int16_t> fives(60, 5);
+	const std::int16_t *input = fives.data();
+
+	accumulator.addSamples(&input, 60, GetParam());
+	EXPECT_EQ(accumulator.getPending(), 60);
+	HistogramCounts counts;
+	histogram.getSnapshot(0, &counts);
+	EXPECT_EQ(counts.bins[5], 0);
+
+	// The interval is reached
+	accumulator.addSamples(&input, 60, GetParam());
+	EXPECT_EQ(accumulator.getPending(), 0);
+	histogram.getSnapshot(0, &counts);
+	EXPECT_EQ(counts.bins[5], 120);
+
+	accumulator.addSamples(&input, 10, GetParam());
+	accumulator.merge();
+	histogram.takeSnapshot(0, &counts);
+	EXPECT_EQ(counts.bins[5], 130);
+	histogram.getSnapshot(0, &counts);
+	EXPECT_EQ(counts.bins[5], 0);
+
+	accumulator.addSamples(&input, 10, GetParam());
+	histogram.reset();
+	accumulator.merge();
+	histogram.getSnapshot(0, &counts);
+	EXPECT_EQ(counts.bins[5], 10);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Histogram Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorHistogramTests, invalidConfiguration) {
+	EXPECT_THROW(MCAHistogram(0, 16);, errors::DAQStageError);
+	EXPECT_THROW(MCAHistogram(2, 0);, errors::DAQStageError);
+	EXPECT_THROW(MCAHistogram(2, (1 << 24) + 1);, errors::DAQStageError);
+	EXPECT_THROW(MCAHistogram(2, 16, 0, 31);, errors::DAQStageError);
+	EXPECT_THROW(MCAHistogram(2, 16, -(1 << 30) - 1);, errors::DAQStageError);
+}
+
+TEST_F(ErrorHistogramTests, channelNotFound) {
+	MCAHistogram histogram(2, 16);
+	MCAHistogram::Accumulator accumulator(&histogram);
+	HistogramCounts counts;
+	EXPECT_THROW(histogram.getSnapshot(2, &counts), errors::DAQStageError);
+	EXPECT_THROW(histogram.takeSnapshot(2, &counts), errors::DAQStageError);
+	const std::int32_t value = 1;
+	EXPECT_THROW(accumulator.addValues(2, &value, 1), errors::DAQStageError);
+
+	std::vector<Pulse> pulses(2);
+	pulses[0].channel = 1;
+	pulses[0].amplitude = 3;
+	pulses[1].channel = 5;
+	EXPECT_THROW(accumulator.addPulses(pulses), errors::DAQStageError);
+	accumulator.merge();
+	histogram.getSnapshot(1, &counts);
+	EXPECT_EQ(counts.bins[3], 1);
+}
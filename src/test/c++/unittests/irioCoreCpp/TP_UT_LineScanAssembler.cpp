@@ -0,0 +1,183 @@
+#include "fixtures.h"
+#include "fff_nifpga.h"
+
+#include "irioCoreCpp.h"
+#include "imaq/lineScanAssembler.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMACPUCommon.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+static std::uint64_t lineCounterFake = 0;
+
+/**
+ * Fills every element of the line read with the number of the line
+ */
+NiFpga_Status funcFifoLines(NiFpga_Session, uint32_t, uint64_t* data,
+        size_t numElements, uint32_t, size_t*) {
+    for (size_t i = 0; i < numElements; ++i) {
+        data[i] = lineCounterFake;
+    }
+    lineCounterFake++;
+    return NiFpga_Status_Success;
+}
+
+NiFpga_Status funcFifoLineTimeout(NiFpga_Session, uint32_t, uint64_t*, size_t,
+        uint32_t, size_t*) {
+    return NiFpga_Status_FifoTimeout;
+}
+
+class LineScanAssemblerTests: public BaseTests {
+public:
+    LineScanAssemblerTests():
+        BaseTests("../../../resources/7966/NiFpga_FlexRIO_CPUIMAQ_7966.lvbitx",
+                    false) {    }
+
+    void SetUp() override {
+        init_ok_fff_nifpga();
+        setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::FlexRIO);
+        setValueForReg(ReadFunctions::NiFpga_ReadU8,
+                        bfp.getRegister(TERMINAL_DEVPROFILE).getAddress(),
+                        PROFILE_VALUE_IMAQ);
+        setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTSAMPLESIZE).getAddress(),
+						sampleSizeFake, 2);
+        lineCounterFake = 0;
+        NiFpga_ReadFifoU64_fake.custom_fake = funcFifoLines;
+    }
+
+    void expectLines(const LineFrame &frame, const std::uint64_t firstLine) {
+        for (size_t l = 0; l < frame.lines; ++l) {
+            for (size_t e = 0; e < frame.lineElements; ++e) {
+                EXPECT_EQ(frame.data[l * frame.lineElements + e],
+                          firstLine + l);
+            }
+        }
+    }
+
+    const std::uint8_t sampleSizeFake[2] = {4,8};
+    const size_t linePixels = 16;
+};
+
+class ErrorLineScanAssemblerTests: public LineScanAssemblerTests{};
+
+///////////////////////////////////////////////////////////////
+/// Line Scan Assembler Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(LineScanAssemblerTests, createLineScanAssembler) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    auto assembler = irio.getTerminalsIMAQ().createLineScanAssembler(0,
+                                                    linePixels, 8);
+    EXPECT_EQ(assembler->getLineElements(),
+              linePixels * sampleSizeFake[0] / 8);
+    EXPECT_EQ(assembler->getPool().getNumFrames(), 4);
+    EXPECT_EQ(assembler->getLinesRead(), 0);
+}
+
+TEST_F(LineScanAssemblerTests, framesWithoutOverlap) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    LineScanAssembler assembler(irio.getTerminalsIMAQ(), 0, linePixels, 8);
+
+    LineFrame frame;
+    for (std::uint64_t i = 0; i < 3; ++i) {
+        assembler.assembleFrame(&frame, 1000);
+        EXPECT_EQ(frame.frameNumber, i);
+        EXPECT_EQ(frame.firstLine, i * 8);
+        EXPECT_EQ(frame.lines, 8);
+        expectLines(frame, i * 8);
+        EXPECT_GE(frame.lineTimestamps[7], frame.lineTimestamps[0]);
+        assembler.releaseFrame(frame);
+    }
+    EXPECT_EQ(assembler.getLinesRead(), 24);
+    EXPECT_EQ(assembler.getDroppedFrames(), 0);
+}
+
+TEST_F(LineScanAssemblerTests, overlappingFrames) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    LineScanAssembler assembler(irio.getTerminalsIMAQ(), 0, linePixels, 8, 2,
+                                6);
+
+    LineFrame frame;
+    for (std::uint64_t i = 0; i < 5; ++i) {
+        assembler.assembleFrame(&frame, 1000);
+        EXPECT_EQ(frame.frameNumber, i);
+        EXPECT_EQ(frame.firstLine, i * 2);
+        expectLines(frame, i * 2);
+        assembler.releaseFrame(frame);
+    }
+    // Each line is read only once
+    EXPECT_EQ(assembler.getLinesRead(), 4 * 2 + 8);
+}
+
+TEST_F(LineScanAssemblerTests, rollingWindow) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    LineScanAssembler assembler(irio.getTerminalsIMAQ(), 0, linePixels, 4, 1,
+                                6);
+
+    LineFrame frame;
+    for (std::uint64_t i = 0; i < 4; ++i) {
+        assembler.assembleFrame(&frame, 1000);
+        EXPECT_EQ(frame.firstLine, i);
+        expectLines(frame, i);
+        assembler.releaseFrame(frame);
+    }
+}
+
+TEST_F(LineScanAssemblerTests, dropsWithAllFramesHeld) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    LineScanAssembler assembler(irio.getTerminalsIMAQ(), 0, linePixels, 4, 0,
+                                2);
+
+    LineFrame frame1, frame2, frame3;
+    assembler.assembleFrame(&frame1, 1000);
+    assembler.assembleFrame(&frame2, 1000);
+    EXPECT_THROW(assembler.assembleFrame(&frame3, 1000);,
+                 errors::FramePoolError);
+    EXPECT_EQ(assembler.getDroppedFrames(), 1);
+
+    assembler.releaseFrame(frame1);
+    assembler.assembleFrame(&frame3, 1000);
+    EXPECT_EQ(frame3.frameNumber, 3);
+    EXPECT_EQ(frame3.droppedFrames, 1);
+    expectLines(frame3, 12);
+    assembler.releaseFrame(frame2);
+    assembler.releaseFrame(frame3);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Line Scan Assembler Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorLineScanAssemblerTests, invalidDMA) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    EXPECT_THROW(irio.getTerminalsIMAQ().createLineScanAssembler(10,
+                                                    linePixels, 8);,
+                 errors::ResourceNotFoundError);
+}
+
+TEST_F(ErrorLineScanAssemblerTests, invalidLineSize) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    EXPECT_THROW(LineScanAssembler(irio.getTerminalsIMAQ(), 0, 3, 8);,
+                 errors::ImageStageError);
+    EXPECT_THROW(LineScanAssembler(irio.getTerminalsIMAQ(), 0, linePixels, 0);,
+                 errors::ImageStageError);
+}
+
+TEST_F(ErrorLineScanAssemblerTests, lineTimeoutKeepsLines) {
+    Irio irio(bitfilePath, "0", "V9.9");
+    LineScanAssembler assembler(irio.getTerminalsIMAQ(), 0, linePixels, 8);
+
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoLineTimeout;
+    LineFrame frame;
+    EXPECT_THROW(assembler.assembleFrame(&frame, 10);, errors::DMAReadTimeout);
+
+    NiFpga_ReadFifoU64_fake.custom_fake = funcFifoLines;
+    assembler.assembleFrame(&frame, 1000);
+    EXPECT_EQ(frame.frameNumber, 0);
+    expectLines(frame, 0);
+    assembler.releaseFrame(frame);
+}
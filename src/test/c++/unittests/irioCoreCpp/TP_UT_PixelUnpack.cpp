@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "imaq/pixelUnpack.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+class PixelUnpackTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Reference packing: pixels stored from the least significant bit
+	 * of the byte stream, with the given bits (and container bits)
+	 */
+	std::vector<std::uint64_t> pack(const std::vector<std::uint16_t> &pixels,
+									const unsigned containerBits) const {
+		std::vector<std::uint64_t> words(
+			(pixels.size() * containerBits + 63) / 64, 0);
+		auto bytes = reinterpret_cast<std::uint8_t*>(words.data());
+		for (size_t i = 0; i < pixels.size(); ++i) {
+			for (unsigned b = 0; b < containerBits; ++b) {
+				const size_t bit = i * containerBits + b;
+				if ((pixels[i] >> b) & 1) {
+					bytes[bit / 8] |= 1 << (bit % 8);
+				}
+			}
+		}
+		return words;
+	}
+
+	std::vector<std::uint16_t> randomPixels(const size_t n,
+											const unsigned bits) {
+		std::uniform_int_distribution<unsigned> dist(0, (1u << bits) - 1);
+		std::vector<std::uint16_t> pixels(n);
+		for (auto &p : pixels) {
+			p = dist(gen);
+		}
+		return pixels;
+	}
+
+	void checkFormat(const PixelFormat format, const unsigned bits,
+					 const unsigned containerBits) {
+		// Sizes not multiple of the vector width to exercise the tails
+		for (const size_t n : {1, 7, 33, 1000, 4099}) {
+			const auto pixels = randomPixels(n, containerBits);
+			const auto words = pack(pixels, containerBits);
+			ASSERT_EQ(words.size(), getFrameWords(format, n));
+
+			std::vector<std::uint16_t> image(n, 0xDEAD);
+			unpackFrame(words.data(), n, format, image.data(), GetParam());
+			for (size_t i = 0; i < n; ++i) {
+				ASSERT_EQ(image[i], pixels[i] & ((1u << bits) - 1))
+					<< "pixel " << i << " of " << n;
+			}
+		}
+	}
+
+	std::mt19937 gen{1234};
+};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, PixelUnpackTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Pixel Unpack Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(PixelUnpackTests, Mono8) {
+	checkFormat(PixelFormat::Mono8, 8, 8);
+}
+
+TEST_P(PixelUnpackTests, Mono10) {
+	checkFormat(PixelFormat::Mono10, 10, 16);
+}
+
+TEST_P(PixelUnpackTests, Mono12) {
+	checkFormat(PixelFormat::Mono12, 12, 16);
+}
+
+TEST_P(PixelUnpackTests, Mono16) {
+	checkFormat(PixelFormat::Mono16, 16, 16);
+}
+
+TEST_P(PixelUnpackTests, Mono10p) {
+	checkFormat(PixelFormat::Mono10p, 10, 10);
+}
+
+TEST_P(PixelUnpackTests, Mono12p) {
+	checkFormat(PixelFormat::Mono12p, 12, 12);
+}
+
+TEST_P(PixelUnpackTests, unpackPixelsRange) {
+	const size_t n = 1000;
+	for (const auto format : {PixelFormat::Mono8, PixelFormat::Mono16,
+							  PixelFormat::Mono10p, PixelFormat::Mono12p}) {
+		const unsigned bits = getPixelBits(format);
+		const auto pixels = randomPixels(n, bits);
+		const auto words = pack(pixels, bits);
+
+		// Ranges starting and ending at every alignment of the packed groups
+		for (const size_t first : {0, 1, 3, 5, 7, 8, 13, 500}) {
+			for (const size_t count : {1, 9, 17, 40, 300}) {
+				std::vector<std::uint16_t> out(count, 0xDEAD);
+				unpackPixels(words.data(), first, count, format, out.data(),
+							 GetParam());
+				for (size_t i = 0; i < count; ++i) {
+					ASSERT_EQ(out[i], pixels[first + i])
+						<< "pixel " << i << " of range " << first << "+"
+						<< count;
+				}
+			}
+		}
+	}
+}
+
+TEST(PixelUnpackFormatTests, Mono8To8Bits) {
+	const std::vector<std::uint64_t> words = {0x0807060504030201};
+	std::uint8_t image[8];
+	unpackFrame(words.data(), 8, PixelFormat::Mono8, image);
+	for (std::uint8_t i = 0; i < 8; ++i) {
+		EXPECT_EQ(image[i], i + 1);
+	}
+}
+
+TEST(PixelUnpackFormatTests, getPixelFormat) {
+	EXPECT_EQ(getPixelFormat(1), PixelFormat::Mono8);
+	EXPECT_EQ(getPixelFormat(2), PixelFormat::Mono16);
+	EXPECT_EQ(getPixelFormat(2, 10), PixelFormat::Mono10);
+	EXPECT_EQ(getPixelFormat(2, 12), PixelFormat::Mono12);
+	EXPECT_EQ(getPixelFormat(2, 16), PixelFormat::Mono16);
+}
+
+TEST(PixelUnpackFormatTests, getFrameWords) {
+	EXPECT_EQ(getFrameWords(PixelFormat::Mono8, 16), 2);
+	EXPECT_EQ(getFrameWords(PixelFormat::Mono16, 16), 4);
+	EXPECT_EQ(getFrameWords(PixelFormat::Mono10p, 32), 5);
+	EXPECT_EQ(getFrameWords(PixelFormat::Mono12p, 16), 3);
+	EXPECT_EQ(getFrameWords(PixelFormat::Mono12p, 17), 4);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Pixel Unpack Tests
+///////////////////////////////////////////////////////////////
+
+TEST(ErrorPixelUnpackFormatTests, unsupportedSampleSize) {
+	EXPECT_THROW(getPixelFormat(4);, errors::UnsupportedPixelFormatError);
+	EXPECT_THROW(getPixelFormat(1, 10);, errors::UnsupportedPixelFormatError);
+	EXPECT_THROW(getPixelFormat(2, 14);, errors::UnsupportedPixelFormatError);
+}
+
+TEST(ErrorPixelUnpackFormatTests, unpack16BitsTo8Bits) {
+	const std::uint64_t words[1] = {0};
+	std::uint8_t image[4];
+	EXPECT_THROW(unpackFrame(words, 4, PixelFormat::Mono16, image);,
+				 errors::UnsupportedPixelFormatError);
+}
@@ -0,0 +1,288 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "daq/pulseDetector.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class PulseDetectorTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Noisy baseline with pulses of random amplitude at random positions
+	 */
+	std::vector<std::int16_t> makeSignal(const size_t samples,
+										 const std::int16_t baseline,
+										 const PulsePolarity polarity) {
+		std::uniform_int_distribution<int> noise(-20, 20);
+		std::uniform_int_distribution<size_t> gap(5, 400);
+		std::uniform_real_distribution<double> amplitude(200, 20000);
+		std::vector<double> pulses(samples, 0);
+		for (size_t start = gap(gen); start < samples; start += gap(gen)) {
+			const double a = amplitude(gen);
+			for (size_t n = start; n < std::min(samples, start + 150); ++n) {
+				const double t = static_cast<double>(n - start);
+				pulses[n] += a * (1 - std::exp(-t / 1.5)) * std::exp(-t / 15);
+			}
+		}
+
+		std::vector<std::int16_t> x(samples);
+		const double sign = polarity == PulsePolarity::Positive ? 1 : -1;
+		for (size_t n = 0; n < samples; ++n) {
+			const double v = baseline + noise(gen) + sign * pulses[n];
+			x[n] = static_cast<std::int16_t>(
+				std::lround(std::min(std::max(v, -32768.0), 32767.0)));
+		}
+		return x;
+	}
+
+	/**
+	 * Pulses of a whole stream, computed sample by sample. Only pulses
+	 * whose post samples are in the stream are complete
+	 */
+	std::vector<Pulse> reference(const std::vector<std::int16_t> &x,
+								 const PulseDetectorConfig &config) {
+		const double sign =
+			config.polarity == PulsePolarity::Positive ? 1 : -1;
+		auto signal = [&](const size_t n) {
+			return static_cast<std::int32_t>(sign * (x[n] - config.baseline));
+		};
+		const bool derivative = config.trigger == PulseTrigger::Derivative;
+		const size_t delay = derivative ? config.lag : 0;
+		auto trigger = [&](const size_t n) {
+			return derivative ? signal(n) - signal(n - delay) : signal(n);
+		};
+		const bool keep = config.preSamples + config.postSamples > 0;
+
+		std::vector<Pulse> pulses;
+		size_t n = delay;
+		while (n < x.size()) {
+			if (trigger(n) < config.threshold) {
+				++n;
+				continue;
+			}
+			Pulse pulse{};
+			pulse.start = n;
+			pulse.timeOfArrival = static_cast<double>(n);
+			if (n > delay && trigger(n - 1) < config.threshold) {
+				pulse.timeOfArrival =
+					n - 1.0 + static_cast<double>(config.threshold -
+												   trigger(n - 1)) /
+								  (trigger(n) - trigger(n - 1));
+			}
+			pulse.amplitude = signal(n);
+			pulse.peak = n;
+			pulse.width = 1;
+			pulse.area = signal(n);
+			size_t end = n + 1;
+			for (; end < x.size() && signal(end) >= config.release; ++end) {
+				++pulse.width;
+				pulse.area += signal(end);
+				if (signal(end) > pulse.amplitude) {
+					pulse.amplitude = signal(end);
+					pulse.peak = end;
+				}
+			}
+			if (end == x.size() ||
+				(keep && end + config.postSamples > x.size())) {
+				break;
+			}
+			if (keep) {
+				pulse.waveformPreSamples = std::min(config.preSamples, n);
+				pulse.waveformSamples = pulse.waveformPreSamples + pulse.width +
+										config.postSamples;
+			}
+			pulses.push_back(pulse);
+			n = end;
+		}
+		return pulses;
+	}
+
+	/**
+	 * Detects the pulses feeding the stream in blocks of random sizes and
+	 * compares them with the reference
+	 */
+	void check(const std::vector<PulseDetectorConfig> &configs,
+			   const size_t samples = 20000) {
+		std::vector<std::vector<std::int16_t>> in;
+		for (const auto &config : configs) {
+			in.push_back(makeSignal(samples, config.baseline, config.polarity));
+		}
+
+		PulseDetectorStage stage(configs);
+		std::vector<std::vector<Pulse>> pulses(configs.size());
+		std::vector<std::vector<std::vector<std::int16_t>>> waveforms(
+			configs.size());
+		std::uniform_int_distribution<size_t> blockSize(1, 1500);
+		size_t first = 0;
+		while (first < samples) {
+			const size_t count = std::min(blockSize(gen), samples - first);
+			std::vector<const std::int16_t*> inputs;
+			for (const auto &channel : in) {
+				inputs.push_back(channel.data() + first);
+			}
+			const size_t completed =
+				stage.process(inputs.data(), count, GetParam());
+			ASSERT_EQ(completed, stage.getPulses().size());
+			for (const auto &pulse : stage.getPulses()) {
+				pulses[pulse.channel].push_back(pulse);
+				const auto w =
+					stage.getWaveforms().begin() +
+					static_cast<std::ptrdiff_t>(pulse.waveformOffset);
+				waveforms[pulse.channel].emplace_back(
+					w, w + static_cast<std::ptrdiff_t>(pulse.waveformSamples));
+			}
+			first += count;
+		}
+
+		size_t total = 0;
+		for (size_t c = 0; c < configs.size(); ++c) {
+			const auto expected = reference(in[c], configs[c]);
+			ASSERT_GT(expected.size(), 10);
+			ASSERT_EQ(pulses[c].size(), expected.size()) << "channel " << c;
+			for (size_t p = 0; p < expected.size(); ++p) {
+				const auto &pulse = pulses[c][p];
+				ASSERT_EQ(pulse.start, expected[p].start) << "pulse " << p;
+				EXPECT_DOUBLE_EQ(pulse.timeOfArrival,
+								 expected[p].timeOfArrival);
+				EXPECT_EQ(pulse.amplitude, expected[p].amplitude);
+				EXPECT_EQ(pulse.peak, expected[p].peak);
+				EXPECT_EQ(pulse.width, expected[p].width);
+				EXPECT_EQ(pulse.area, expected[p].area);
+				ASSERT_EQ(pulse.waveformSamples, expected[p].waveformSamples);
+				EXPECT_EQ(pulse.waveformPreSamples,
+						  expected[p].waveformPreSamples);
+				const auto w = in[c].begin() +
+							   static_cast<std::ptrdiff_t>(
+								   pulse.start - pulse.waveformPreSamples);
+				EXPECT_TRUE(std::equal(waveforms[c][p].begin(),
+									   waveforms[c][p].end(), w))
+					<< "pulse " << p;
+			}
+			total += expected.size();
+		}
+		EXPECT_EQ(stage.getDetected(), total);
+		EXPECT_EQ(stage.getPosition(), samples);
+	}
+
+	std::mt19937 gen{24680};
+};
+
+class ErrorPulseDetectorTests: public ::testing::Test {};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, PulseDetectorTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Pulse Detector Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(PulseDetectorTests, threshold) {
+	check({{PulseTrigger::Threshold, PulsePolarity::Positive, 100, 150, 60, 0,
+			0, 0},
+		   {PulseTrigger::Threshold, PulsePolarity::Negative, -300, 500, 100,
+			0, 0, 0},
+		   {PulseTrigger::Threshold, PulsePolarity::Positive, 32000, 100, 100,
+			0, 0, 0}});
+}
+
+TEST_P(PulseDetectorTests, derivative) {
+	check({{PulseTrigger::Derivative, PulsePolarity::Positive, 0, 120, 80, 2,
+			0, 0},
+		   {PulseTrigger::Derivative, PulsePolarity::Negative, 2000, 300, 50,
+			17, 0, 0}});
+}
+
+TEST_P(PulseDetectorTests, waveforms) {
+	check({{PulseTrigger::Threshold, PulsePolarity::Positive, 0, 150, 60, 0,
+			16, 32},
+		   {PulseTrigger::Derivative, PulsePolarity::Negative, 0, 200, 60, 3,
+			0, 500},
+		   {PulseTrigger::Threshold, PulsePolarity::Positive, 0, 150, 60, 0,
+			2000, 0},
+		   {PulseTrigger::Threshold, PulsePolarity::Negative, 0, 150, 60, 0,
+			0, 0}});
+}
+
+TEST_P(PulseDetectorTests, features) {
+	PulseDetectorStage stage({{PulseTrigger::Threshold, PulsePolarity::Positive,
+							   10, 100, 50, 0, 1, 1}});
+	const std::vector<std::int16_t> x = {10, 60, 160, 400, 90, 70, 30, 10};
+	const std::int16_t *input = x.data();
+	EXPECT_EQ(stage.process(&input, x.size(), GetParam()), 1);
+
+	const Pulse &pulse = stage.getPulses()[0];
+	EXPECT_EQ(pulse.channel, 0);
+	EXPECT_EQ(pulse.start, 2);
+	// The signal crosses 100 halfway between 50 and 150
+	EXPECT_DOUBLE_EQ(pulse.timeOfArrival, 1.5);
+	EXPECT_EQ(pulse.amplitude, 390);
+	EXPECT_EQ(pulse.peak, 3);
+	EXPECT_EQ(pulse.width, 4);
+	EXPECT_EQ(pulse.area, 150 + 390 + 80 + 60);
+	EXPECT_EQ(stage.getWaveforms(),
+			  std::vector<std::int16_t>({60, 160, 400, 90, 70, 30}));
+}
+
+TEST_P(PulseDetectorTests, hysteresis) {
+	// The noise around the threshold does not split the pulse
+	PulseDetectorStage stage({{PulseTrigger::Threshold, PulsePolarity::Positive,
+							   0, 1000, 700, 0, 0, 0}});
+	std::vector<std::int16_t> x(100, 0);
+	for (size_t n = 10; n < 60; ++n) {
+		x[n] = n % 2 ? 1100 : 900;
+	}
+	const std::int16_t *input = x.data();
+	EXPECT_EQ(stage.process(&input, x.size(), GetParam()), 1);
+	EXPECT_EQ(stage.getPulses()[0].start, 11);
+	EXPECT_EQ(stage.getPulses()[0].width, 49);
+}
+
+TEST_P(PulseDetectorTests, reset) {
+	PulseDetectorStage stage({{PulseTrigger::Threshold, PulsePolarity::Positive,
+							   0, 100, 100, 0, 0, 0}});
+	const std::vector<std::int16_t> x = {0, 500, 500, 0};
+	const std::int16_t *input = x.data();
+	EXPECT_EQ(stage.process(&input, 2, GetParam()), 0);
+
+	// Without reset, the pulse would end at the first sample
+	stage.reset();
+	input = x.data() + 3;
+	EXPECT_EQ(stage.process(&input, 1, GetParam()), 0);
+	EXPECT_EQ(stage.getPosition(), 1);
+	EXPECT_EQ(stage.getDetected(), 0);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Pulse Detector Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorPulseDetectorTests, invalidConfiguration) {
+	EXPECT_THROW(PulseDetectorStage({});, errors::DAQStageError);
+	EXPECT_THROW(PulseDetectorStage({{PulseTrigger::Threshold,
+									  PulsePolarity::Positive, 0, 0, 0, 0, 0,
+									  0}});,
+				 errors::DAQStageError);
+	EXPECT_THROW(PulseDetectorStage({{PulseTrigger::Threshold,
+									  PulsePolarity::Positive, 0, 100, 101, 0,
+									  0, 0}});,
+				 errors::DAQStageError);
+	EXPECT_THROW(PulseDetectorStage({{PulseTrigger::Threshold,
+									  PulsePolarity::Positive, 32000, 1000,
+									  500, 0, 0, 0}});,
+				 errors::DAQStageError);
+	EXPECT_THROW(PulseDetectorStage({{PulseTrigger::Threshold,
+									  PulsePolarity::Negative, -32000, 1000,
+									  500, 0, 0, 0}});,
+				 errors::DAQStageError);
+	EXPECT_THROW(PulseDetectorStage({{PulseTrigger::Derivative,
+									  PulsePolarity::Positive, 0, 100, 50, 0,
+									  0, 0}});,
+				 errors::DAQStageError);
+}
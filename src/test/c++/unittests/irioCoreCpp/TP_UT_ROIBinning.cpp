@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "imaq/roiBinning.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::imaq;
+
+class ROIBinningTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random frame of the given format and its unpacked pixels
+	 */
+	void makeFrame(const PixelFormat format) {
+		const unsigned bits = getPixelBits(format);
+		std::uniform_int_distribution<unsigned> dist(0, (1u << bits) - 1);
+		pixels.resize(WIDTH * HEIGHT);
+		for (auto &p : pixels) {
+			p = dist(gen);
+		}
+		words.assign(getFrameWords(format, pixels.size()), 0);
+		auto bytes = reinterpret_cast<std::uint8_t*>(words.data());
+		for (size_t i = 0; i < pixels.size(); ++i) {
+			for (unsigned b = 0; b < bits; ++b) {
+				const size_t bit = i * bits + b;
+				if ((pixels[i] >> b) & 1) {
+					bytes[bit / 8] |= 1 << (bit % 8);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Reference crop and binning of the unpacked pixels
+	 */
+	std::vector<std::uint16_t> reference(const ROI &roi, const unsigned bin,
+										 const BinningMode mode) const {
+		std::vector<std::uint16_t> out;
+		for (size_t y = 0; y < roi.height / bin; ++y) {
+			for (size_t x = 0; x < roi.width / bin; ++x) {
+				std::uint32_t sum = 0;
+				for (unsigned j = 0; j < bin; ++j) {
+					for (unsigned i = 0; i < bin; ++i) {
+						sum += pixels[(roi.y + y * bin + j) * WIDTH +
+									  roi.x + x * bin + i];
+					}
+				}
+				out.push_back(mode == BinningMode::Average
+								  ? sum / (bin * bin)
+								  : std::min<std::uint32_t>(sum, 0xFFFF));
+			}
+		}
+		return out;
+	}
+
+	void check(const PixelFormat format, const ROI &roi, const unsigned bin,
+			   const BinningMode mode = BinningMode::Average,
+			   const unsigned threads = 1) {
+		makeFrame(format);
+		ROIBinningStage stage(WIDTH, HEIGHT, format, roi, bin, mode, threads);
+		ASSERT_EQ(stage.getFrameWords(), words.size());
+		std::vector<std::uint16_t> image(stage.getOutputPixels(), 0xDEAD);
+		stage.process(words.data(), image.data(), GetParam());
+		EXPECT_EQ(image, reference(roi, bin, mode));
+	}
+
+	static constexpr size_t WIDTH = 101;
+	static constexpr size_t HEIGHT = 64;
+
+	std::vector<std::uint16_t> pixels;
+	std::vector<std::uint64_t> words;
+	std::mt19937 gen{4321};
+};
+
+constexpr size_t ROIBinningTests::WIDTH;
+constexpr size_t ROIBinningTests::HEIGHT;
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, ROIBinningTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// ROI Binning Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(ROIBinningTests, cropMono8) {
+	check(PixelFormat::Mono8, ROI{3, 5, 50, 20}, 1);
+}
+
+TEST_P(ROIBinningTests, cropMono16) {
+	check(PixelFormat::Mono16, ROI{0, 0, 101, 64}, 1);
+}
+
+TEST_P(ROIBinningTests, cropMono10p) {
+	check(PixelFormat::Mono10p, ROI{7, 1, 61, 33}, 1);
+}
+
+TEST_P(ROIBinningTests, cropMono12p) {
+	check(PixelFormat::Mono12p, ROI{1, 2, 99, 40}, 1);
+}
+
+TEST_P(ROIBinningTests, bin2x2Mono12p) {
+	check(PixelFormat::Mono12p, ROI{5, 4, 64, 32}, 2);
+}
+
+TEST_P(ROIBinningTests, bin4x4Mono10p) {
+	check(PixelFormat::Mono10p, ROI{9, 0, 88, 64}, 4);
+}
+
+TEST_P(ROIBinningTests, bin2x2SumMono16) {
+	check(PixelFormat::Mono16, ROI{0, 0, 100, 64}, 2, BinningMode::Sum);
+}
+
+TEST_P(ROIBinningTests, severalThreads) {
+	check(PixelFormat::Mono12p, ROI{3, 3, 96, 60}, 2, BinningMode::Average,
+		  4);
+	check(PixelFormat::Mono8, ROI{0, 0, 101, 64}, 1, BinningMode::Average,
+		  8);
+}
+
+TEST(ROIBinningStageTests, outputDimensions) {
+	ROIBinningStage stage(640, 480, PixelFormat::Mono8, ROI{0, 0, 320, 240},
+						  4);
+	EXPECT_EQ(stage.getOutputWidth(), 80);
+	EXPECT_EQ(stage.getOutputHeight(), 60);
+	EXPECT_EQ(stage.getOutputPixels(), 80 * 60);
+	EXPECT_EQ(stage.getFrameWords(), 640 * 480 / 8);
+	EXPECT_EQ(stage.getFormat(), PixelFormat::Mono8);
+}
+
+TEST(ROIBinningStageTests, largeBinsNotWrapped) {
+	// 512 x 512 pixels of 0xFFFF add up to more than 32 bits
+	const size_t side = 512;
+	std::vector<std::uint64_t> words(side * side / 4, ~0ULL);
+	std::uint16_t image[1];
+
+	ROIBinningStage average(side, side, PixelFormat::Mono16,
+							ROI{0, 0, side, side}, side);
+	average.process(words.data(), image);
+	EXPECT_EQ(image[0], 0xFFFF);
+
+	ROIBinningStage sum(side, side, PixelFormat::Mono16,
+						ROI{0, 0, side, side}, side, BinningMode::Sum);
+	sum.process(words.data(), image);
+	EXPECT_EQ(image[0], 0xFFFF);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error ROI Binning Tests
+///////////////////////////////////////////////////////////////
+
+TEST(ErrorROIBinningStageTests, roiOutsideImage) {
+	EXPECT_THROW(ROIBinningStage(64, 64, PixelFormat::Mono8,
+								 ROI{32, 0, 33, 10});,
+				 errors::ROIError);
+	EXPECT_THROW(ROIBinningStage(64, 64, PixelFormat::Mono8,
+								 ROI{0, 60, 10, 5});,
+				 errors::ROIError);
+	EXPECT_THROW(ROIBinningStage(64, 64, PixelFormat::Mono8,
+								 ROI{0, 0, 0, 5});,
+				 errors::ROIError);
+}
+
+TEST(ErrorROIBinningStageTests, roiNotMultipleOfBinning) {
+	EXPECT_THROW(ROIBinningStage(64, 64, PixelFormat::Mono8,
+								 ROI{0, 0, 30, 32}, 4);,
+				 errors::ROIError);
+	EXPECT_THROW(ROIBinningStage(64, 64, PixelFormat::Mono8,
+								 ROI{0, 0, 32, 32}, 0);,
+				 errors::ROIError);
+}
@@ -0,0 +1,368 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fixtures.h"
+#include "fff_nifpga.h"
+
+#include "irioCoreCpp.h"
+#include "daq/recording.h"
+#include "errorsIrio.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMACPUCommon.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+namespace {
+
+std::string getTestPath() {
+	return ::testing::TempDir() + "recording_" +
+		   ::testing::UnitTest::GetInstance()->current_test_info()->name() +
+		   ".raw";
+}
+
+void removeRecording(const std::string &path) {
+	std::remove(path.c_str());
+	std::remove(DAQRecorder::getIndexPath(path).c_str());
+	std::remove(EnvelopeBuilder::getDescriptorPath(path).c_str());
+	for (const auto decimation : {16, 256, 4096}) {
+		std::remove(EnvelopeBuilder::getLevelPath(path, decimation).c_str());
+	}
+}
+
+}  // namespace
+
+class RecordingTests: public ::testing::Test {
+public:
+	void TearDown() override {
+		removeRecording(getTestPath());
+	}
+
+	/**
+	 * Records blocks of random sizes with random words, with a timestamp
+	 * of 100 times the number of the block, and returns the words recorded
+	 */
+	std::vector<std::uint64_t> recordBlocks(DAQRecorder *recorder,
+											const size_t blocks) {
+		std::uniform_int_distribution<size_t> blockSize(1, 2000);
+		std::vector<std::uint64_t> words;
+		for (size_t b = 0; b < blocks; ++b) {
+			std::vector<std::uint64_t> block(blockSize(gen));
+			for (auto &word : block) {
+				word = gen();
+			}
+			recorder->record(block.data(), block.size(),
+							 static_cast<std::int64_t>(100 * b));
+			words.insert(words.end(), block.begin(), block.end());
+		}
+		return words;
+	}
+
+	/**
+	 * Checks that a span holds the samples of its channel from the words
+	 * recorded
+	 */
+	void expectSpan(const ChannelSpan &span,
+					const std::vector<std::uint64_t> &words,
+					const size_t channels) {
+		const auto values = reinterpret_cast<const std::int16_t*>(words.data());
+		EXPECT_EQ(span.stride, channels);
+		for (size_t i = 0; i < span.samples; ++i) {
+			ASSERT_EQ(span[i],
+					  values[(span.firstSample + i) * channels + span.channel]);
+		}
+	}
+
+	std::mt19937_64 gen{2236};
+};
+
+class RecordingDMATests: public BaseTests {
+public:
+	RecordingDMATests():
+		BaseTests("../../../resources/7854/NiFpga_Rseries_CPUDAQ_7854.lvbitx")
+	{
+		setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::RSeries);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU16,
+						bfp.getRegister(TERMINAL_DMATTOHOSTNCH).getAddress(),
+						nchFake, 2);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTFRAMETYPE).getAddress(),
+						frameTypeFake, 2);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTSAMPLESIZE).getAddress(),
+						sampleSizeFake, 2);
+	}
+
+	void TearDown() override {
+		removeRecording(getTestPath());
+	}
+
+	const std::uint16_t nchFake[2] = {4,2};
+	const std::uint8_t frameTypeFake[2] = {1, 0};
+	const std::uint8_t sampleSizeFake[2] = {4,8};
+};
+
+class ErrorRecordingTests: public ::testing::Test {
+public:
+	void TearDown() override {
+		removeRecording(getTestPath());
+	}
+};
+
+///////////////////////////////////////////////////////////////
+/// Recording Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(RecordingTests, recordAndRead) {
+	const std::string path = getTestPath();
+	const size_t channels = 4;
+	DAQRecorder recorder(path, channels);
+	const auto words = recordBlocks(&recorder, 50);
+	EXPECT_EQ(recorder.getBlocks(), 50);
+	EXPECT_EQ(recorder.getElements(), words.size());
+
+	RecordingReader reader(path);
+	EXPECT_EQ(reader.getChannels(), channels);
+	EXPECT_EQ(reader.getBlocks(), 50);
+	EXPECT_EQ(reader.getSamples(), words.size());
+
+	std::uint64_t offset = 0;
+	for (std::uint64_t b = 0; b < 50; ++b) {
+		const RecordedBlock block = reader.getBlock(b);
+		EXPECT_EQ(block.offset, offset);
+		EXPECT_EQ(block.timestamp, 100 * b);
+		EXPECT_EQ(reader.getBlockSample(b), offset / 8);
+		offset += block.elements * 8;
+	}
+
+	std::vector<ChannelSpan> spans;
+	reader.getBlockRange(10, 5, {3, 1}, &spans);
+	ASSERT_EQ(spans.size(), 2);
+	EXPECT_EQ(spans[0].channel, 3);
+	EXPECT_EQ(spans[1].channel, 1);
+	for (const auto &span : spans) {
+		EXPECT_EQ(span.firstSample, reader.getBlockSample(10));
+		EXPECT_EQ(span.samples,
+				  reader.getBlockSample(15) - reader.getBlockSample(10));
+		expectSpan(span, words, channels);
+	}
+
+	// The spans point to the mapped file
+	reader.getSampleRange(0, reader.getSamples(), {0, 1, 2, 3}, &spans);
+	EXPECT_EQ(reinterpret_cast<const std::uint64_t*>(spans[0].data)[1],
+			  words[1]);
+	for (const auto &span : spans) {
+		EXPECT_EQ(span.samples, words.size());
+		expectSpan(span, words, channels);
+	}
+}
+
+TEST_F(RecordingTests, samplesAcrossBlocks) {
+	// 3 channels, so samples are split between blocks
+	const std::string path = getTestPath();
+	const size_t channels = 3;
+	DAQRecorder recorder(path, channels);
+	const auto words = recordBlocks(&recorder, 20);
+
+	RecordingReader reader(path);
+	EXPECT_EQ(reader.getSamples(), words.size() * 4 / channels);
+	std::vector<ChannelSpan> spans;
+	std::uint64_t next = 0;
+	for (std::uint64_t b = 0; b < 20; ++b) {
+		const std::uint64_t values = reader.getBlock(b).offset / 2;
+		EXPECT_EQ(reader.getBlockSample(b), (values + 2) / 3);
+		reader.getBlockRange(b, 1, {0, 2}, &spans);
+		EXPECT_EQ(spans[0].firstSample, next);
+		next += spans[0].samples;
+		expectSpan(spans[0], words, channels);
+		expectSpan(spans[1], words, channels);
+	}
+	EXPECT_EQ(next, reader.getSamples());
+}
+
+TEST_F(RecordingTests, timeRange) {
+	const std::string path = getTestPath();
+	const size_t channels = 2;
+	DAQRecorder recorder(path, channels);
+	const auto words = recordBlocks(&recorder, 10);
+	RecordingReader reader(path);
+
+	EXPECT_EQ(reader.findBlock(-5), 0);
+	EXPECT_EQ(reader.findBlock(300), 3);
+	EXPECT_EQ(reader.findBlock(301), 4);
+	EXPECT_EQ(reader.findBlock(2000), 10);
+
+	std::vector<ChannelSpan> spans;
+	reader.getTimeRange(250, 650, {1}, &spans);
+	ASSERT_EQ(spans.size(), 1);
+	EXPECT_EQ(spans[0].firstSample, reader.getBlockSample(3));
+	EXPECT_EQ(spans[0].samples,
+			  reader.getBlockSample(7) - reader.getBlockSample(3));
+	expectSpan(spans[0], words, channels);
+
+	reader.getTimeRange(5000, 6000, {0, 1}, &spans);
+	ASSERT_EQ(spans.size(), 2);
+	EXPECT_EQ(spans[0].samples, 0);
+	reader.getTimeRange(650, 250, {0}, &spans);
+	EXPECT_EQ(spans[0].samples, 0);
+}
+
+TEST_F(RecordingTests, readWhileRecording) {
+	const std::string path = getTestPath();
+	const size_t channels = 4;
+	DAQRecorder recorder(path, channels);
+	RecordingReader reader(path);
+	EXPECT_EQ(reader.getBlocks(), 0);
+	EXPECT_EQ(reader.getSamples(), 0);
+	std::vector<ChannelSpan> spans;
+	reader.getSampleRange(0, 100, {0}, &spans);
+	EXPECT_EQ(spans[0].samples, 0);
+
+	auto words = recordBlocks(&recorder, 3);
+	reader.refresh();
+	EXPECT_EQ(reader.getBlocks(), 3);
+	EXPECT_EQ(reader.getSamples(), words.size());
+
+	const auto more = recordBlocks(&recorder, 2);
+	words.insert(words.end(), more.begin(), more.end());
+	reader.refresh();
+	EXPECT_EQ(reader.getBlocks(), 5);
+	reader.getBlockRange(0, 5, {2}, &spans);
+	EXPECT_EQ(spans[0].samples, words.size());
+	expectSpan(spans[0], words, channels);
+}
+
+TEST_F(RecordingTests, hostTime) {
+	const std::string path = getTestPath();
+	DAQRecorder recorder(path, 4);
+	const std::vector<std::uint64_t> block(64, 0);
+	const std::int64_t before = DAQRecorder::getHostTime();
+	recorder.record(block.data(), block.size());
+	recorder.record(block.data(), block.size());
+	const std::int64_t after = DAQRecorder::getHostTime();
+
+	RecordingReader reader(path);
+	EXPECT_GE(reader.getBlock(0).timestamp, before);
+	EXPECT_LE(reader.getBlock(0).timestamp, reader.getBlock(1).timestamp);
+	EXPECT_LE(reader.getBlock(1).timestamp, after);
+	EXPECT_EQ(reader.findBlock(after + 1), 2);
+}
+
+TEST_F(RecordingTests, envelopes) {
+	const std::string path = getTestPath();
+	const size_t channels = 2;
+	std::vector<std::uint64_t> words;
+	{
+		DAQRecorder recorder(path, channels, {16, 256});
+		for (size_t b = 0; b < 10; ++b) {
+			std::vector<std::uint64_t> block(500);
+			for (auto &word : block) {
+				word = gen();
+			}
+			recorder.record(block.data(), block.size());
+			words.insert(words.end(), block.begin(), block.end());
+		}
+	}
+
+	EnvelopeReader envelopes(path);
+	EXPECT_EQ(envelopes.getSamples(), words.size() * 2);
+	EXPECT_EQ(envelopes.getDecimations(), std::vector<size_t>({16, 256}));
+	std::vector<EnvelopePoint> points;
+	std::uint64_t start;
+	envelopes.read(1, 0, envelopes.getSamples(), 1, &points, &start);
+	ASSERT_EQ(points.size(), 1);
+
+	RecordingReader reader(path);
+	std::vector<ChannelSpan> spans;
+	reader.getSampleRange(0, reader.getSamples(), {1}, &spans);
+	std::int16_t min = 32767, max = -32768;
+	for (size_t i = 0; i < spans[0].samples; ++i) {
+		min = std::min(min, spans[0][i]);
+		max = std::max(max, spans[0][i]);
+	}
+	EXPECT_EQ(points[0].min, min);
+	EXPECT_EQ(points[0].max, max);
+}
+
+///////////////////////////////////////////////////////////////
+/// Recording DMA Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(RecordingDMATests, recordFromDMA) {
+	const std::string path = getTestPath();
+	Irio irio(bitfilePath, "0", "V9.9");
+	DAQRecorder recorder(path, 4);
+	EXPECT_EQ(recorder.recordFromDMA(irio.getTerminalsDAQ(), 0, 64, 100), 64);
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.call_count, 1);
+	EXPECT_EQ(NiFpga_ReleaseFifoElements_fake.arg2_val, 64);
+
+	RecordingReader reader(path);
+	EXPECT_EQ(reader.getBlocks(), 1);
+	EXPECT_EQ(reader.getBlock(0).elements, 64);
+	std::vector<ChannelSpan> spans;
+	reader.getBlockRange(0, 1, {0}, &spans);
+	ASSERT_EQ(spans[0].samples, 64);
+	// The fake DMA returns words with value 7
+	EXPECT_EQ(spans[0][0], 7);
+	EXPECT_EQ(spans[0][63], 7);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Recording Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorRecordingTests, invalidConfiguration) {
+	const std::string path = getTestPath();
+	EXPECT_THROW(DAQRecorder(path, 0);, errors::DAQStageError);
+	EXPECT_THROW(DAQRecorder(path, 2, {16, 40});, errors::DAQStageError);
+	EXPECT_THROW(DAQRecorder("/nonexistent/dir/file.raw", 2);,
+				 errors::RecordingError);
+}
+
+TEST_F(ErrorRecordingTests, invalidRecord) {
+	const std::string path = getTestPath();
+	const std::vector<std::uint64_t> block(3, 0);
+	DAQRecorder recorder(path, 3, {16});
+	// 12 values, 4 samples of 3 channels
+	EXPECT_NO_THROW(recorder.record(block.data(), 3));
+	EXPECT_THROW(recorder.record(block.data(), 2), errors::DAQStageError);
+	recorder.close();
+	EXPECT_THROW(recorder.record(block.data(), 3), errors::DAQStageError);
+}
+
+TEST_F(ErrorRecordingTests, invalidFiles) {
+	const std::string path = getTestPath();
+	EXPECT_THROW(RecordingReader reader(path);, errors::RecordingError);
+
+	std::ofstream(path) << "Raw";
+	EXPECT_THROW(RecordingReader reader(path);, errors::RecordingError);
+	std::ofstream(DAQRecorder::getIndexPath(path)) << "Not an index";
+	EXPECT_THROW(RecordingReader reader(path);, errors::RecordingError);
+}
+
+TEST_F(ErrorRecordingTests, invalidRead) {
+	const std::string path = getTestPath();
+	DAQRecorder recorder(path, 2);
+	const std::vector<std::uint64_t> block(16, 0);
+	recorder.record(block.data(), block.size(), 10);
+	RecordingReader reader(path);
+	std::vector<ChannelSpan> spans;
+	EXPECT_THROW(reader.getSampleRange(0, 10, {0, 2}, &spans),
+				 errors::DAQStageError);
+	EXPECT_THROW(reader.getTimeRange(0, 100, {2}, &spans),
+				 errors::DAQStageError);
+	EXPECT_THROW(reader.getBlockRange(0, 2, {0}, &spans),
+				 errors::DAQStageError);
+	EXPECT_THROW(reader.getBlock(1), errors::DAQStageError);
+	EXPECT_THROW(reader.getBlockSample(2), errors::DAQStageError);
+	EXPECT_NO_THROW(reader.getBlockRange(1, 0, {0}, &spans));
+	EXPECT_EQ(reader.getBlockSample(1), 32);
+}
@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "daq/sampleCodec.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class SampleCodecTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Value of a channel at a position of the block
+	 */
+	using Signal = std::function<std::int16_t(size_t, size_t)>;
+
+	/**
+	 * Slow-varying channels with a few counts of noise, as read from an ADC
+	 */
+	std::int16_t slow(const size_t channel, const size_t position) {
+		return static_cast<std::int16_t>(
+			8000 * std::sin(position / (200.0 + 50 * channel)) +
+			noise(gen));
+	}
+
+	std::int16_t random(const size_t, const size_t) {
+		return static_cast<std::int16_t>(full(gen));
+	}
+
+	/**
+	 * DMA words of a block with the channels interleaved
+	 */
+	std::vector<std::uint64_t> makeBlock(const size_t channels,
+										 const size_t elements,
+										 const Signal &signal) {
+		std::vector<std::uint64_t> words(elements);
+		auto values = reinterpret_cast<std::int16_t*>(words.data());
+		for (size_t i = 0; i < elements * 4; ++i) {
+			values[i] = signal(i % channels, i / channels);
+		}
+		return words;
+	}
+
+	/**
+	 * Compresses and decompresses the block and returns the compressed size
+	 */
+	size_t roundTrip(const std::vector<std::uint64_t> &words,
+					 const size_t channels, const unsigned threads = 1) {
+		SampleCodec codec(channels, threads);
+		std::vector<std::uint8_t> data(
+			codec.getMaxCompressedSize(words.size()));
+		const size_t size =
+			codec.compress(words.data(), words.size(), data.data(), GetParam());
+		EXPECT_LE(size, data.size());
+		EXPECT_EQ(codec.getElements(data.data(), size), words.size());
+
+		std::vector<std::uint64_t> out(words.size(), 0xDEADBEEF);
+		EXPECT_EQ(codec.decompress(data.data(), size, out.data(), GetParam()),
+				  words.size());
+		EXPECT_EQ(out, words);
+		return size;
+	}
+
+	Signal slowSignal() {
+		return [this](const size_t c, const size_t p) { return slow(c, p); };
+	}
+
+	Signal randomSignal() {
+		return [this](const size_t c, const size_t p) { return random(c, p); };
+	}
+
+	std::mt19937 gen{8642};
+	std::uniform_int_distribution<int> noise{-3, 3};
+	std::uniform_int_distribution<int> full{-32768, 32767};
+};
+
+class ErrorSampleCodecTests: public ::testing::Test {
+public:
+	std::vector<std::uint8_t> compressRamp(const SampleCodec &codec,
+										   const size_t elements) {
+		std::vector<std::uint64_t> words(elements);
+		auto values = reinterpret_cast<std::int16_t*>(words.data());
+		for (size_t i = 0; i < elements * 4; ++i) {
+			values[i] = static_cast<std::int16_t>(i * 3);
+		}
+		std::vector<std::uint8_t> data(codec.getMaxCompressedSize(elements));
+		data.resize(codec.compress(words.data(), elements, data.data()));
+		return data;
+	}
+};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, SampleCodecTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Sample Codec Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(SampleCodecTests, slowSignalsCompress) {
+	for (const size_t channels : {1, 4, 8}) {
+		const auto words = makeBlock(channels, 16384, slowSignal());
+		const size_t size = roundTrip(words, channels);
+		// Differences of up to about 40 counts, 7 bits
+		EXPECT_LT(size, words.size() * 8 / 2);
+	}
+}
+
+TEST_P(SampleCodecTests, randomSignalsAreBounded) {
+	const size_t channels = 4;
+	const auto words = makeBlock(channels, 16384, randomSignal());
+	const size_t size = roundTrip(words, channels);
+	// A byte per group of 256 samples, plus the header
+	EXPECT_LE(size, words.size() * 8 + words.size() * 4 / 256 + 12 + 16);
+}
+
+TEST_P(SampleCodecTests, constantAndExtremeSignals) {
+	const size_t channels = 2;
+	const auto constant = makeBlock(
+		channels, 4096, [](size_t, size_t) { return std::int16_t(-1234); });
+	// Only the first group of each channel has a difference, of 12 bits.
+	// The other 31 groups only take their bit width
+	EXPECT_EQ(roundTrip(constant, channels),
+			  12 + 4 * channels + channels * (1 + 32 * 12 + 31));
+
+	// Alternating extremes give the largest differences, wrapped to 16 bits
+	roundTrip(makeBlock(channels, 4096,
+						[](size_t, const size_t p) {
+							return std::int16_t(p % 2 ? 32767 : -32768);
+						}),
+			  channels);
+}
+
+TEST_P(SampleCodecTests, anyChannelsAndSizes) {
+	std::uniform_int_distribution<size_t> elements(0, 3000);
+	for (const size_t channels : {1, 2, 3, 5, 7, 8, 16, 33}) {
+		for (int i = 0; i < 4; ++i) {
+			roundTrip(makeBlock(channels, elements(gen), slowSignal()),
+					  channels);
+			roundTrip(makeBlock(channels, elements(gen), randomSignal()),
+					  channels);
+		}
+	}
+	// Empty blocks and blocks of less than a sample
+	roundTrip({}, 4);
+	roundTrip(makeBlock(9, 2, slowSignal()), 9);
+}
+
+TEST_P(SampleCodecTests, sameDataForAllLevels) {
+	const size_t channels = 4;
+	const auto words = makeBlock(channels, 5000, slowSignal());
+	SampleCodec codec(channels);
+	std::vector<std::uint8_t> expected(codec.getMaxCompressedSize(5000));
+	std::vector<std::uint8_t> data(expected.size());
+	expected.resize(codec.compress(words.data(), words.size(),
+								   expected.data(), SIMDLevel::Scalar));
+	data.resize(codec.compress(words.data(), words.size(), data.data(),
+							   GetParam()));
+	EXPECT_EQ(data, expected);
+}
+
+TEST_P(SampleCodecTests, decompressChannel) {
+	const size_t channels = 3;
+	const auto words = makeBlock(channels, 2000, slowSignal());
+	const auto values = reinterpret_cast<const std::int16_t*>(words.data());
+	SampleCodec codec(channels);
+	std::vector<std::uint8_t> data(codec.getMaxCompressedSize(words.size()));
+	const size_t size = codec.compress(words.data(), words.size(),
+									   data.data(), GetParam());
+
+	const size_t samples = getBlockSamples(words.size(), channels);
+	for (size_t c = 0; c < channels; ++c) {
+		std::vector<std::int16_t> out(samples);
+		EXPECT_EQ(codec.decompressChannel(data.data(), size, c, out.data(),
+										  GetParam()),
+				  samples);
+		for (size_t s = 0; s < samples; ++s) {
+			ASSERT_EQ(out[s], values[s * channels + c]);
+		}
+	}
+}
+
+TEST_P(SampleCodecTests, severalThreads) {
+	const size_t channels = 8;
+	const auto words = makeBlock(channels, 8000, slowSignal());
+	roundTrip(words, channels, 3);
+	roundTrip(words, channels, 20);
+
+	// Blocks compressed with threads are decompressed without them
+	SampleCodec encoder(channels, 4);
+	SampleCodec decoder(channels);
+	std::vector<std::uint8_t> data(encoder.getMaxCompressedSize(8000));
+	const size_t size = encoder.compress(words.data(), words.size(),
+										 data.data(), GetParam());
+	std::vector<std::uint64_t> out(words.size());
+	decoder.decompress(data.data(), size, out.data(), GetParam());
+	EXPECT_EQ(out, words);
+}
+
+TEST_P(SampleCodecTests, paddedData) {
+	const size_t channels = 4;
+	const auto words = makeBlock(channels, 1001, slowSignal());
+	SampleCodec codec(channels);
+	std::vector<std::uint64_t> padded(codec.getMaxCompressedSize(1001) / 8);
+	auto data = reinterpret_cast<std::uint8_t*>(padded.data());
+	const size_t size =
+		codec.compress(words.data(), words.size(), data, GetParam());
+
+	std::vector<std::uint64_t> out(words.size());
+	codec.decompress(data, (size + 7) / 8 * 8, out.data(), GetParam());
+	EXPECT_EQ(out, words);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Sample Codec Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorSampleCodecTests, invalidConfiguration) {
+	EXPECT_THROW(SampleCodec(0);, errors::DAQStageError);
+	EXPECT_THROW(SampleCodec(70000);, errors::DAQStageError);
+
+	SampleCodec codec(4);
+	std::uint64_t word = 0;
+	std::uint8_t out[64];
+	EXPECT_THROW(codec.compress(&word, SampleCodec::MAX_ELEMENTS + 1, out);,
+				 errors::DAQStageError);
+}
+
+TEST_F(ErrorSampleCodecTests, otherChannels) {
+	SampleCodec codec(4);
+	const auto data = compressRamp(codec, 100);
+	SampleCodec other(2);
+	std::vector<std::uint64_t> out(100);
+	EXPECT_THROW(other.decompress(data.data(), data.size(), out.data());,
+				 errors::CodecError);
+}
+
+TEST_F(ErrorSampleCodecTests, channelNotFound) {
+	SampleCodec codec(4);
+	const auto data = compressRamp(codec, 100);
+	std::vector<std::int16_t> out(100);
+	EXPECT_THROW(
+		codec.decompressChannel(data.data(), data.size(), 4, out.data());,
+		errors::DAQStageError);
+}
+
+TEST_F(ErrorSampleCodecTests, truncatedOrCorrupted) {
+	SampleCodec codec(3);
+	auto data = compressRamp(codec, 1000);
+	std::vector<std::uint64_t> out(1000);
+	EXPECT_THROW(codec.decompress(data.data(), data.size() - 1, out.data());,
+				 errors::CodecError);
+	EXPECT_THROW(codec.decompress(data.data(), 10, out.data());,
+				 errors::CodecError);
+
+	// Bit width of the first group of the first channel
+	auto corrupted = data;
+	corrupted[12 + 4 * 3] = 17;
+	EXPECT_THROW(
+		codec.decompress(corrupted.data(), corrupted.size(), out.data());,
+		errors::CodecError);
+
+	data[0] ^= 0xFF;
+	EXPECT_THROW(codec.decompress(data.data(), data.size(), out.data());,
+				 errors::CodecError);
+}
+
+TEST_F(ErrorSampleCodecTests, corruptedChannelsStayInBounds) {
+	SampleCodec codec(4, 2);
+	const auto data = compressRamp(codec, 3000);
+
+	// Garbage in the channels decodes to a wrong block or throws
+	std::mt19937 gen(1357);
+	std::uniform_int_distribution<size_t> position(12 + 16, data.size() - 1);
+	std::vector<std::uint64_t> out(3000);
+	for (int i = 0; i < 100; ++i) {
+		auto corrupted = data;
+		for (int j = 0; j < 4; ++j) {
+			corrupted[position(gen)] ^= 0xFF;
+		}
+		try {
+			codec.decompress(corrupted.data(), corrupted.size(), out.data());
+		} catch (const errors::CodecError&) {
+		}
+	}
+}
@@ -0,0 +1,263 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "daq/spectrum.h"
+#include "errorsIrio.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class SpectrumTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Random samples of each channel
+	 */
+	std::vector<std::vector<std::int16_t>> makeChannels(const size_t channels,
+														const size_t samples) {
+		std::uniform_int_distribution<int> dist(-32768, 32767);
+		std::vector<std::vector<std::int16_t>> in(
+			channels, std::vector<std::int16_t>(samples));
+		for (auto &channel : in) {
+			for (auto &v : channel) {
+				v = static_cast<std::int16_t>(dist(gen));
+			}
+		}
+		return in;
+	}
+
+	/**
+	 * Feeds the channels to the stage in blocks of random sizes
+	 */
+	size_t feed(SpectrumStage *stage,
+				const std::vector<std::vector<std::int16_t>> &in) {
+		std::uniform_int_distribution<size_t> blockSize(1, 900);
+		size_t spectra = 0, first = 0;
+		while (first < in[0].size()) {
+			const size_t count = std::min(blockSize(gen), in[0].size() - first);
+			std::vector<const std::int16_t*> inputs;
+			for (const auto &channel : in) {
+				inputs.push_back(channel.data() + first);
+			}
+			spectra += stage->process(inputs.data(), count, GetParam());
+			first += count;
+		}
+		return spectra;
+	}
+
+	/**
+	 * Spectrum of the last complete group of frames of a channel, with a
+	 * DFT in double precision
+	 */
+	std::vector<double> reference(const std::vector<std::int16_t> &x,
+								  const SpectrumStage &stage,
+								  const SpectrumWindow window) {
+		const size_t n = stage.getFFTSize();
+		const size_t frames = (x.size() - n) / stage.getHop() + 1;
+		const size_t groups = frames / stage.getAverages();
+		std::vector<double> w(n);
+		double gain = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const double a = 2 * M_PI * i / n;
+			switch (window) {
+			case SpectrumWindow::Rectangular:
+				w[i] = 1;
+				break;
+			case SpectrumWindow::Hann:
+				w[i] = 0.5 - 0.5 * std::cos(a);
+				break;
+			case SpectrumWindow::Hamming:
+				w[i] = 0.54 - 0.46 * std::cos(a);
+				break;
+			case SpectrumWindow::Blackman:
+				w[i] = 0.42 - 0.5 * std::cos(a) + 0.08 * std::cos(2 * a);
+				break;
+			}
+			gain += w[i];
+		}
+
+		std::vector<double> power(n / 2 + 1, 0);
+		for (size_t f = (groups - 1) * stage.getAverages();
+			 f < groups * stage.getAverages(); ++f) {
+			const size_t start = f * stage.getHop();
+			for (size_t k = 0; k <= n / 2; ++k) {
+				std::complex<double> sum = 0;
+				for (size_t i = 0; i < n; ++i) {
+					sum += w[i] * x[start + i] *
+						   std::polar(1.0, -2 * M_PI * k * i / n);
+				}
+				const double factor = (k == 0 || k == n / 2) ? 1 : 2;
+				power[k] += factor * std::norm(sum) /
+							(gain * gain * stage.getAverages());
+			}
+		}
+		return power;
+	}
+
+	void check(const size_t channels, const size_t fftSize, const size_t hop,
+			   const size_t averages, const SpectrumWindow window,
+			   const size_t samples) {
+		const auto in = makeChannels(channels, samples);
+		SpectrumStage stage(channels, fftSize, hop, averages, window);
+		const size_t frames = (samples - fftSize) / hop + 1;
+		ASSERT_EQ(feed(&stage, in), frames / averages);
+		EXPECT_EQ(stage.getPublished(), frames / averages);
+
+		std::vector<float> spectrum;
+		for (size_t c = 0; c < channels; ++c) {
+			EXPECT_EQ(stage.getSpectrum(c, &spectrum), frames / averages);
+			ASSERT_EQ(spectrum.size(), fftSize / 2 + 1);
+			const auto expected = reference(in[c], stage, window);
+			const double scale =
+				*std::max_element(expected.begin(), expected.end());
+			for (size_t k = 0; k < expected.size(); ++k) {
+				ASSERT_NEAR(spectrum[k], expected[k], scale * 1e-4)
+					<< "fft " << fftSize << ", channel " << c << ", bin " << k;
+			}
+		}
+	}
+
+	std::mt19937 gen{97531};
+};
+
+class ErrorSpectrumTests: public ::testing::Test {};
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, SpectrumTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Spectrum Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(SpectrumTests, matchesDFT) {
+	for (const size_t fftSize : {8, 16, 32, 256}) {
+		check(3, fftSize, fftSize, 2, SpectrumWindow::Hann, 4000);
+	}
+	check(2, 1024, 1024, 1, SpectrumWindow::Rectangular, 2500);
+}
+
+TEST_P(SpectrumTests, overlapAndSkip) {
+	check(2, 64, 32, 5, SpectrumWindow::Hamming, 3000);
+	check(1, 128, 100, 3, SpectrumWindow::Blackman, 3000);
+	check(2, 64, 200, 4, SpectrumWindow::Hann, 5000);
+}
+
+TEST_P(SpectrumTests, sinusoidPower) {
+	const size_t n = 1024, bin = 37;
+	const double amplitude = 10000;
+	std::vector<std::int16_t> x(4 * n);
+	for (size_t i = 0; i < x.size(); ++i) {
+		x[i] = static_cast<std::int16_t>(
+			std::lround(amplitude * std::sin(2 * M_PI * bin * i / n) + 500));
+	}
+	SpectrumStage stage(1, n, n / 2, 7, SpectrumWindow::Blackman);
+	const std::int16_t *input = x.data();
+	EXPECT_EQ(stage.process(&input, x.size(), GetParam()), 1);
+
+	std::vector<float> spectrum;
+	stage.getSpectrum(0, &spectrum);
+	EXPECT_NEAR(spectrum[bin], amplitude * amplitude / 2, 1e-3 * 5e7);
+	EXPECT_NEAR(spectrum[0], 500 * 500, 1);
+	EXPECT_LT(spectrum[bin + 10], 1);
+	EXPECT_LT(spectrum[n / 2], 1);
+}
+
+TEST_P(SpectrumTests, severalThreads) {
+	const auto in = makeChannels(5, 5000);
+	std::vector<const std::int16_t*> inputs;
+	for (const auto &channel : in) {
+		inputs.push_back(channel.data());
+	}
+	SpectrumStage single(5, 256, 128, 4);
+	SpectrumStage parallel(5, 256, 128, 4, SpectrumWindow::Hann, 3);
+	for (size_t first = 0; first < 5000; first += 1000) {
+		EXPECT_EQ(single.process(inputs.data(), 1000, GetParam()),
+				  parallel.process(inputs.data(), 1000, GetParam()));
+		for (auto &input : inputs) {
+			input += 1000;
+		}
+	}
+
+	std::vector<float> expected, spectra;
+	EXPECT_EQ(single.getSpectra(&expected), 9);
+	EXPECT_EQ(parallel.getSpectra(&spectra), 9);
+	EXPECT_EQ(spectra, expected);
+}
+
+TEST_P(SpectrumTests, reset) {
+	SpectrumStage stage(1, 16, 16, 2, SpectrumWindow::Rectangular);
+	const std::vector<std::int16_t> ones(48, 100);
+	const std::int16_t *input = ones.data();
+	EXPECT_EQ(stage.process(&input, 24, GetParam()), 0);
+
+	// Without reset, the 8 pending samples would complete the second frame
+	stage.reset();
+	EXPECT_EQ(stage.process(&input, 24, GetParam()), 0);
+	EXPECT_EQ(stage.process(&input, 8, GetParam()), 1);
+
+	std::vector<float> spectrum;
+	EXPECT_EQ(stage.getSpectrum(0, &spectrum), 1);
+	EXPECT_FLOAT_EQ(spectrum[0], 100 * 100);
+	EXPECT_LT(spectrum[1], 1e-3);
+
+	stage.reset();
+	EXPECT_EQ(stage.getSpectrum(0, &spectrum), 1);
+	EXPECT_FLOAT_EQ(spectrum[0], 100 * 100);
+}
+
+TEST_P(SpectrumTests, readWhileProcessing) {
+	// Every spectrum comes from a constant signal, different for each one
+	// but the same in all the channels, so a reader must never see the
+	// channels of two spectra mixed
+	const size_t channels = 4, n = 64;
+	SpectrumStage stage(channels, n, n, 1, SpectrumWindow::Rectangular);
+	std::atomic<bool> done{false};
+	std::atomic<size_t> mixed{0};
+	std::thread reader([&]() {
+		std::vector<float> spectra;
+		while (!done) {
+			stage.getSpectra(&spectra);
+			for (size_t c = 1; c < channels; ++c) {
+				if (spectra[c * (n / 2 + 1)] != spectra[0]) {
+					++mixed;
+				}
+			}
+		}
+	});
+
+	std::vector<std::int16_t> block(n);
+	const std::vector<const std::int16_t*> inputs(channels, block.data());
+	for (int i = 0; i < 3000; ++i) {
+		std::fill(block.begin(), block.end(), static_cast<std::int16_t>(i));
+		stage.process(inputs.data(), n, GetParam());
+	}
+	done = true;
+	reader.join();
+	EXPECT_EQ(mixed, 0);
+	EXPECT_EQ(stage.getPublished(), 3000);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Spectrum Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorSpectrumTests, invalidConfiguration) {
+	EXPECT_THROW(SpectrumStage(0, 64, 64, 1);, errors::DAQStageError);
+	EXPECT_THROW(SpectrumStage(2, 4, 4, 1);, errors::DAQStageError);
+	EXPECT_THROW(SpectrumStage(2, 100, 50, 1);, errors::DAQStageError);
+	EXPECT_THROW(SpectrumStage(2, 64, 0, 1);, errors::DAQStageError);
+	EXPECT_THROW(SpectrumStage(2, 64, 32, 0);, errors::DAQStageError);
+}
+
+TEST_F(ErrorSpectrumTests, channelNotFound) {
+	SpectrumStage stage(2, 64, 64, 1);
+	std::vector<float> spectrum;
+	EXPECT_THROW(stage.getSpectrum(2, &spectrum), errors::DAQStageError);
+}
@@ -0,0 +1,476 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "fixtures.h"
+#include "fff_nifpga.h"
+
+#include "irioCoreCpp.h"
+#include "daq/triggeredCapture.h"
+#include "errorsIrio.h"
+#include "terminals/names/namesTerminalsCommon.h"
+#include "terminals/names/namesTerminalsDMACPUCommon.h"
+#include "terminals/names/namesTerminalsDigital.h"
+
+using namespace irio;
+using namespace irio::daq;
+
+class TriggeredCaptureTests: public ::testing::TestWithParam<SIMDLevel> {
+public:
+	/**
+	 * Value of a channel at a position of the stream
+	 */
+	using Signal = std::function<std::int16_t(size_t, std::uint64_t)>;
+
+	static std::int16_t ramp(const size_t channel,
+							 const std::uint64_t position) {
+		return static_cast<std::int16_t>(
+			(position * 31 + channel * 977) % 4001 - 2000);
+	}
+
+	/**
+	 * Writes and commits the next block of the stream
+	 */
+	const std::uint64_t *commit(TriggeredCapture *stage,
+								const Signal &signal = ramp) {
+		const size_t channels = stage->getChannels();
+		const std::uint64_t position = stage->getPosition();
+		auto values = reinterpret_cast<std::int16_t*>(stage->beginBlock());
+		for (size_t n = 0; n < stage->getBlockSamples(); ++n) {
+			for (size_t c = 0; c < channels; ++c) {
+				values[n * channels + c] = signal(c, position + n);
+			}
+		}
+		return stage->commitBlock(GetParam());
+	}
+
+	/**
+	 * Checks the samples of a capture against the signal
+	 */
+	void checkSamples(const TriggeredCapture &stage, const Capture &capture,
+					  const Signal &signal = ramp) {
+		const size_t channels = stage.getChannels();
+		std::vector<std::vector<std::int16_t>> out(
+			channels, std::vector<std::int16_t>(capture.samples));
+		std::vector<std::int16_t*> outputs;
+		for (auto &channel : out) {
+			outputs.push_back(channel.data());
+		}
+		stage.extractSamples(capture, outputs.data(), GetParam());
+
+		const std::uint64_t start =
+			capture.triggerPosition - capture.preSamples;
+		for (size_t c = 0; c < channels; ++c) {
+			for (size_t n = 0; n < capture.samples; ++n) {
+				ASSERT_EQ(out[c][n], signal(c, start + n))
+					<< "channel " << c << " sample " << n;
+			}
+		}
+	}
+
+	/**
+	 * Signal of a channel below the level up to a sample and above it
+	 * afterwards, with the other channels around the level
+	 */
+	static Signal step(const size_t stepChannel, const std::uint64_t stepAt,
+					   const std::int16_t level, const bool rising) {
+		return [=](const size_t channel, const std::uint64_t position) {
+			if (channel != stepChannel) {
+				return static_cast<std::int16_t>(level - 1 + position % 3);
+			}
+			const bool above = (position >= stepAt) == rising;
+			return static_cast<std::int16_t>(above ? level + position % 5
+												   : level - 1 - position % 5);
+		};
+	}
+
+	/**
+	 * Commits blocks until a capture is completed
+	 */
+	void commitUntilCapture(TriggeredCapture *stage, Capture *capture,
+							const Signal &signal = ramp) {
+		for (int i = 0; i < 1000; ++i) {
+			commit(stage, signal);
+			if (stage->tryGetCapture(capture)) {
+				return;
+			}
+		}
+		FAIL() << "No capture completed";
+	}
+
+	void checkThreshold(const size_t channels, const size_t channel,
+						const std::uint64_t stepAt, const bool rising,
+						const TriggerEdge edge) {
+		const std::int16_t level = 1200;
+		const Signal signal = step(channel, stepAt, level, rising);
+		TriggeredCapture stage(channels, 30, 70, 90);
+		stage.setThresholdTrigger(channel, level, edge);
+
+		Capture capture;
+		commitUntilCapture(&stage, &capture, signal);
+		EXPECT_EQ(capture.source, TriggerSource::Threshold);
+		EXPECT_EQ(capture.triggerPosition, stepAt);
+		EXPECT_EQ(capture.preSamples, std::min<size_t>(70, stepAt));
+		checkSamples(stage, capture, signal);
+		stage.releaseCapture(capture);
+	}
+};
+
+class ErrorTriggeredCaptureTests: public ::testing::Test {};
+
+class TriggeredCaptureDMATests: public BaseTests {
+public:
+	TriggeredCaptureDMATests():
+		BaseTests("../../../resources/7854/NiFpga_Rseries_CPUDAQ_7854.lvbitx")
+	{
+		setValueForReg(ReadFunctions::NiFpga_ReadU8,
+						bfp.getRegister(TERMINAL_PLATFORM).getAddress(),
+						PLATFORM_ID::RSeries);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU16,
+						bfp.getRegister(TERMINAL_DMATTOHOSTNCH).getAddress(),
+						nchFake, 2);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTFRAMETYPE).getAddress(),
+						frameTypeFake, 2);
+		setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU8,
+						bfp.getRegister(TERMINAL_DMATTOHOSTSAMPLESIZE).getAddress(),
+						sampleSizeFake, 2);
+		setDI(false);
+	}
+
+	void setDI(const bool value) {
+		setValueForReg(ReadFunctions::NiFpga_ReadBool,
+						bfp.getRegister(TERMINAL_DI+std::to_string(0)).getAddress(),
+						static_cast<std::uint8_t>(value));
+	}
+
+	const size_t blockElements = 16;
+	const std::uint16_t nchFake[2] = {4,2};
+	const std::uint8_t frameTypeFake[2] = {1, 0};
+	const std::uint8_t sampleSizeFake[2] = {4,8};
+};
+
+NiFpga_Status funcFillCaptureData(NiFpga_Session, uint32_t, uint64_t *data,
+		size_t numberOfElements, uint32_t, size_t *elementsRemaining) {
+	for (size_t i = 0; i < numberOfElements; ++i) {
+		data[i] = i;
+	}
+	if(elementsRemaining)
+		*elementsRemaining = 0;
+
+	return NiFpga_Status_Success;
+}
+
+INSTANTIATE_TEST_CASE_P(SIMDLevels, TriggeredCaptureTests,
+						::testing::Values(SIMDLevel::Scalar, SIMDLevel::SSSE3,
+										  SIMDLevel::AVX2));
+
+///////////////////////////////////////////////////////////////
+/// Triggered Capture Tests
+///////////////////////////////////////////////////////////////
+
+TEST_P(TriggeredCaptureTests, softwareTrigger) {
+	// 64 samples of 4 channels per block
+	TriggeredCapture stage(4, 64, 100, 150);
+	for (int i = 0; i < 5; ++i) {
+		commit(&stage);
+	}
+	stage.trigger();
+
+	Capture capture;
+	EXPECT_FALSE(stage.tryGetCapture(&capture));
+	commitUntilCapture(&stage, &capture);
+	EXPECT_EQ(capture.source, TriggerSource::Software);
+	EXPECT_EQ(capture.triggerPosition, 320);
+	EXPECT_EQ(capture.preSamples, 100);
+	EXPECT_EQ(capture.samples, 250);
+	EXPECT_EQ(capture.captureNumber, 0);
+	// Samples 220 to 469
+	EXPECT_EQ(capture.numBlocks, 5);
+	EXPECT_EQ(capture.firstSample, 28);
+	EXPECT_EQ(stage.getPosition(), 512);
+	checkSamples(stage, capture);
+	stage.releaseCapture(capture);
+	EXPECT_EQ(stage.getCaptures(), 1);
+}
+
+TEST_P(TriggeredCaptureTests, blocksNotCopied) {
+	TriggeredCapture stage(2, 16, 40, 20);
+	std::vector<const std::uint64_t*> blocks;
+	for (int i = 0; i < 3; ++i) {
+		blocks.push_back(commit(&stage));
+	}
+	stage.trigger();
+	blocks.push_back(commit(&stage));
+
+	Capture capture;
+	ASSERT_TRUE(stage.getCapture(&capture, 100));
+	// Samples 56 to 115 of blocks of 32 samples
+	ASSERT_EQ(capture.numBlocks, 3);
+	EXPECT_EQ(capture.blocks[0], blocks[1]);
+	EXPECT_EQ(capture.blocks[1], blocks[2]);
+	EXPECT_EQ(capture.blocks[2], blocks[3]);
+	checkSamples(stage, capture);
+
+	// The captured blocks are not reused while the capture is held
+	for (int i = 0; i < 10; ++i) {
+		const auto block = commit(&stage);
+		EXPECT_EQ(std::count(capture.blocks, capture.blocks + 3, block), 0);
+	}
+	checkSamples(stage, capture);
+	stage.releaseCapture(capture);
+}
+
+TEST_P(TriggeredCaptureTests, triggerAtStreamStart) {
+	TriggeredCapture stage(3, 6, 50, 30);
+	stage.trigger();
+
+	Capture capture;
+	commitUntilCapture(&stage, &capture);
+	EXPECT_EQ(capture.triggerPosition, 0);
+	EXPECT_EQ(capture.preSamples, 0);
+	EXPECT_EQ(capture.samples, 30);
+	EXPECT_EQ(capture.firstSample, 0);
+	checkSamples(stage, capture);
+	stage.releaseCapture(capture);
+}
+
+TEST_P(TriggeredCaptureTests, unalignedCapture) {
+	// 3 channels, 8 samples per block, windows starting mid-word
+	TriggeredCapture stage(3, 6, 13, 29, 1);
+	for (int i = 0; i < 7; ++i) {
+		commit(&stage);
+	}
+	stage.trigger();
+
+	Capture capture;
+	commitUntilCapture(&stage, &capture);
+	EXPECT_EQ(capture.firstSample, 3);
+	checkSamples(stage, capture);
+	stage.releaseCapture(capture);
+}
+
+TEST_P(TriggeredCaptureTests, thresholdRising) {
+	for (const size_t channels : {1, 2, 3, 4, 8}) {
+		for (const std::uint64_t stepAt : {5, 200, 301, 527}) {
+			checkThreshold(channels, channels - 1, stepAt, true,
+						   TriggerEdge::Rising);
+			checkThreshold(channels, channels / 2, stepAt, true,
+						   TriggerEdge::Both);
+		}
+	}
+}
+
+TEST_P(TriggeredCaptureTests, thresholdFalling) {
+	for (const size_t channels : {1, 2, 4, 5, 8}) {
+		for (const std::uint64_t stepAt : {9, 200, 409}) {
+			checkThreshold(channels, 0, stepAt, false, TriggerEdge::Falling);
+			checkThreshold(channels, channels - 1, stepAt, false,
+						   TriggerEdge::Both);
+		}
+	}
+}
+
+TEST_P(TriggeredCaptureTests, thresholdAtBlockStart) {
+	// Blocks of 60 samples of 2 channels
+	for (const std::uint64_t stepAt : {60, 120, 59, 61}) {
+		checkThreshold(2, 1, stepAt, true, TriggerEdge::Rising);
+	}
+}
+
+TEST_P(TriggeredCaptureTests, thresholdSpike) {
+	// The channel reaches the level for a single sample
+	for (const size_t channels : {1, 2, 4, 8}) {
+		for (const std::uint64_t spikeAt : {40, 77, 143}) {
+			const Signal signal = [=](const size_t channel,
+									  const std::uint64_t position) {
+				return static_cast<std::int16_t>(
+					channel == channels - 1 && position == spikeAt ? 100 : 0);
+			};
+			TriggeredCapture stage(channels, 32, 10, 10);
+			stage.setThresholdTrigger(channels - 1, 50, TriggerEdge::Falling);
+			Capture capture;
+			commitUntilCapture(&stage, &capture, signal);
+			EXPECT_EQ(capture.triggerPosition, spikeAt + 1);
+			stage.releaseCapture(capture);
+		}
+	}
+}
+
+TEST_P(TriggeredCaptureTests, thresholdOppositeEdge) {
+	const Signal signal = step(1, 100, 0, false);
+	TriggeredCapture stage(4, 32, 10, 10);
+	stage.setThresholdTrigger(1, 0, TriggerEdge::Rising);
+	for (int i = 0; i < 20; ++i) {
+		commit(&stage, signal);
+	}
+	Capture capture;
+	EXPECT_FALSE(stage.tryGetCapture(&capture));
+
+	stage.clearTriggers();
+	stage.trigger();
+	commitUntilCapture(&stage, &capture, signal);
+	EXPECT_EQ(capture.source, TriggerSource::Software);
+	stage.releaseCapture(capture);
+}
+
+TEST_P(TriggeredCaptureTests, softwareBeforeThreshold) {
+	const Signal signal = step(0, 70, 500, true);
+	TriggeredCapture stage(2, 32, 20, 20);
+	stage.setThresholdTrigger(0, 500, TriggerEdge::Rising);
+	commit(&stage, signal);
+	stage.trigger();
+
+	Capture capture;
+	commitUntilCapture(&stage, &capture, signal);
+	EXPECT_EQ(capture.source, TriggerSource::Software);
+	EXPECT_EQ(capture.triggerPosition, 64);
+	stage.releaseCapture(capture);
+	EXPECT_FALSE(stage.tryGetCapture(&capture));
+}
+
+TEST_P(TriggeredCaptureTests, missedTriggers) {
+	TriggeredCapture stage(2, 8, 10, 10, 1);
+	stage.trigger();
+	Capture first;
+	commitUntilCapture(&stage, &first);
+
+	// Missed while the only capture is held by the user
+	stage.trigger();
+	commit(&stage);
+	stage.trigger();
+	commit(&stage);
+	EXPECT_EQ(stage.getMissedTriggers(), 2);
+	Capture capture;
+	EXPECT_FALSE(stage.tryGetCapture(&capture));
+
+	stage.releaseCapture(first);
+	EXPECT_THROW(stage.releaseCapture(first), errors::DAQStageError);
+	stage.trigger();
+	commitUntilCapture(&stage, &capture);
+	EXPECT_EQ(capture.captureNumber, 1);
+	checkSamples(stage, capture);
+	stage.releaseCapture(capture);
+}
+
+TEST_P(TriggeredCaptureTests, missedWhileCollecting) {
+	TriggeredCapture stage(2, 8, 4, 100, 2);
+	stage.trigger();
+	commit(&stage);
+	stage.trigger();
+	commit(&stage);
+	EXPECT_EQ(stage.getMissedTriggers(), 1);
+
+	Capture capture;
+	commitUntilCapture(&stage, &capture);
+	EXPECT_EQ(capture.triggerPosition, 0);
+	stage.releaseCapture(capture);
+	for (int i = 0; i < 20; ++i) {
+		commit(&stage);
+	}
+	EXPECT_FALSE(stage.tryGetCapture(&capture));
+	EXPECT_EQ(stage.getMissedTriggers(), 1);
+}
+
+TEST_P(TriggeredCaptureTests, concurrentConsumer) {
+	const size_t maxCaptures = 3;
+	TriggeredCapture stage(4, 32, 300, 200, maxCaptures);
+	std::vector<Capture> captures;
+	std::thread consumer([&]() {
+		Capture capture;
+		while (stage.getCapture(&capture, 1000)) {
+			captures.push_back(capture);
+			checkSamples(stage, capture);
+			stage.releaseCapture(capture);
+		}
+	});
+
+	std::mt19937 gen(97);
+	std::uniform_int_distribution<int> dist(0, 20);
+	for (int i = 0; i < 3000; ++i) {
+		if (dist(gen) == 0) {
+			stage.trigger();
+		}
+		commit(&stage);
+	}
+	consumer.join();
+
+	EXPECT_GT(captures.size(), 0);
+	EXPECT_EQ(captures.size(), stage.getCaptures());
+	for (size_t i = 0; i < captures.size(); ++i) {
+		EXPECT_EQ(captures[i].captureNumber, i);
+		EXPECT_EQ(captures[i].samples, 500);
+	}
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Triggered Capture Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorTriggeredCaptureTests, invalidConfiguration) {
+	EXPECT_THROW(TriggeredCapture(0, 16, 10, 10);, errors::DAQStageError);
+	// 5 channels do not fit in 1 element
+	EXPECT_THROW(TriggeredCapture(5, 1, 10, 10);, errors::DAQStageError);
+	// 3 channels would start the next blocks mid-sample
+	EXPECT_THROW(TriggeredCapture(3, 16, 10, 10);, errors::DAQStageError);
+	EXPECT_THROW(TriggeredCapture(2, 16, 0, 0);, errors::DAQStageError);
+	EXPECT_THROW(TriggeredCapture(2, 16, 10, 10, 0);, errors::DAQStageError);
+}
+
+TEST_F(ErrorTriggeredCaptureTests, invalidTrigger) {
+	TriggeredCapture stage(2, 16, 10, 10);
+	EXPECT_THROW(stage.setThresholdTrigger(2, 0, TriggerEdge::Rising),
+				 errors::DAQStageError);
+	EXPECT_THROW(stage.setThresholdTrigger(0, -32768, TriggerEdge::Rising),
+				 errors::DAQStageError);
+}
+
+TEST_F(ErrorTriggeredCaptureTests, commitWithoutBlock) {
+	TriggeredCapture stage(2, 16, 10, 10);
+	EXPECT_THROW(stage.commitBlock(), errors::DAQStageError);
+	stage.beginBlock();
+	EXPECT_NO_THROW(stage.commitBlock());
+	EXPECT_THROW(stage.commitBlock(), errors::DAQStageError);
+}
+
+///////////////////////////////////////////////////////////////
+/// Triggered Capture DMA Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(TriggeredCaptureDMATests, acquireFromDMA) {
+	NiFpga_ReadFifoU64_fake.custom_fake = funcFillCaptureData;
+
+	Irio irio(bitfilePath, "0", "V9.9");
+	TriggeredCapture stage(4, blockElements, 8, 8);
+	const auto block = stage.acquireFromDMA(irio.getTerminalsDAQ(), 0, 100);
+	EXPECT_EQ(block[blockElements - 1], blockElements - 1);
+	EXPECT_EQ(stage.getPosition(), blockElements);
+}
+
+TEST_F(TriggeredCaptureDMATests, digitalTrigger) {
+	NiFpga_ReadFifoU64_fake.custom_fake = funcFillCaptureData;
+
+	Irio irio(bitfilePath, "0", "V9.9");
+	TriggeredCapture stage(4, blockElements, 8, 8);
+	stage.setDigitalTrigger(irio.getTerminalsDigital(), 0,
+							TriggerEdge::Rising);
+	stage.acquireFromDMA(irio.getTerminalsDAQ(), 0, 100);
+	setDI(true);
+	stage.acquireFromDMA(irio.getTerminalsDAQ(), 0, 100);
+	setDI(false);
+
+	Capture capture;
+	ASSERT_TRUE(stage.tryGetCapture(&capture));
+	EXPECT_EQ(capture.source, TriggerSource::Digital);
+	EXPECT_EQ(capture.triggerPosition, blockElements);
+	EXPECT_EQ(capture.preSamples, 8);
+	stage.releaseCapture(capture);
+
+	// Falling edge
+	stage.acquireFromDMA(irio.getTerminalsDAQ(), 0, 100);
+	EXPECT_FALSE(stage.tryGetCapture(&capture));
+}
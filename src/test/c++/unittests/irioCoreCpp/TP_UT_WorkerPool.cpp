@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "workerPool.h"
+
+using namespace irio;
+
+class WorkerPoolTests: public ::testing::Test {};
+
+class ErrorWorkerPoolTests: public ::testing::Test {};
+
+///////////////////////////////////////////////////////////////
+/// Worker Pool Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(WorkerPoolTests, everyTaskOnce) {
+	WorkerPool pool;
+	for (const unsigned threads : {1u, 2u, 4u, 16u}) {
+		std::vector<std::atomic<int>> runs(100);
+		pool.run(runs.size(), threads, [&](const size_t t) { ++runs[t]; });
+		for (const auto &count : runs) {
+			ASSERT_EQ(count.load(), 1);
+		}
+	}
+	pool.run(0, 4, [](size_t) { FAIL() << "No tasks to run"; });
+}
+
+TEST_F(WorkerPoolTests, workersReused) {
+	WorkerPool pool;
+	EXPECT_EQ(pool.getWorkers(), 0);
+	pool.run(1000, 1, [](size_t) {});
+	EXPECT_EQ(pool.getWorkers(), 0);
+
+	for (int i = 0; i < 100; ++i) {
+		pool.run(8, 4, [](size_t) {});
+	}
+	EXPECT_EQ(pool.getWorkers(), 3);
+	// No more threads than tasks
+	pool.run(2, 8, [](size_t) {});
+	EXPECT_EQ(pool.getWorkers(), 3);
+}
+
+TEST_F(WorkerPoolTests, severalThreadsWork) {
+	WorkerPool pool;
+	std::mutex mutex;
+	std::set<std::thread::id> ids;
+	std::atomic<int> waiting{0};
+	// Every task waits for the others, so each one runs in its own thread
+	pool.run(3, 3, [&](size_t) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			ids.insert(std::this_thread::get_id());
+		}
+		++waiting;
+		while (waiting.load() < 3) {
+			std::this_thread::yield();
+		}
+	});
+	EXPECT_EQ(ids.size(), 3);
+	EXPECT_EQ(ids.count(std::this_thread::get_id()), 1);
+}
+
+TEST_F(WorkerPoolTests, concurrentAndNestedCalls) {
+	WorkerPool pool;
+	std::atomic<size_t> total{0};
+	std::vector<std::thread> callers;
+	for (int c = 0; c < 4; ++c) {
+		callers.emplace_back([&]() {
+			for (int i = 0; i < 50; ++i) {
+				pool.run(4, 3, [&](size_t) {
+					pool.run(5, 2, [&](size_t) { ++total; });
+				});
+			}
+		});
+	}
+	for (auto &caller : callers) {
+		caller.join();
+	}
+	EXPECT_EQ(total.load(), 4 * 50 * 4 * 5);
+}
+
+TEST_F(WorkerPoolTests, sharedPool) {
+	EXPECT_EQ(&WorkerPool::getShared(), &WorkerPool::getShared());
+	std::atomic<int> runs{0};
+	WorkerPool::getShared().run(10, 2, [&](size_t) { ++runs; });
+	EXPECT_EQ(runs.load(), 10);
+}
+
+///////////////////////////////////////////////////////////////
+/// Error Worker Pool Tests
+///////////////////////////////////////////////////////////////
+
+TEST_F(ErrorWorkerPoolTests, exceptionAfterAllTasks) {
+	WorkerPool pool;
+	std::atomic<int> runs{0};
+	EXPECT_THROW(pool.run(20, 4,
+						  [&](const size_t t) {
+							  ++runs;
+							  if (t == 3) {
+								  throw std::runtime_error("Task failed");
+							  }
+						  }),
+				 std::runtime_error);
+	EXPECT_EQ(runs.load(), 20);
+
+	// The pool is still usable
+	runs = 0;
+	pool.run(20, 4, [&](size_t) { ++runs; });
+	EXPECT_EQ(runs.load(), 20);
+}
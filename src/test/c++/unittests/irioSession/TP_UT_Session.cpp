@@ -0,0 +1,452 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fff_nifpga.h"
+
+#include "errorsIrio.h"
+#include "sessionClient.h"
+#include "sessionServer.h"
+
+using namespace irio;
+using namespace irio::session;
+
+class SessionTests: public ::testing::Test {
+public:
+	SessionTests():
+		socketPath("/tmp/irioSessionTest." + std::to_string(getpid()) + ".sock"),
+		server(socketPath)
+	{
+		resetFakes();
+		FFF_RESET_HISTORY();
+		init_ok_fff_nifpga();
+		NiFpga_Close_fake.return_val = NiFpga_Status_Success;
+		NiFpga_Run_fake.return_val = NiFpga_Status_Success;
+		server.start();
+	}
+
+	~SessionTests() {
+		server.stop();
+		resetFakes();
+	}
+
+	void resetFakes() {
+		RESET_FAKE(irio::searchRIODevice);
+		reset_fff_nifpga();
+	}
+
+	NiFpga_Session openSession(SessionClient *client) {
+		NiFpga_Session session = 0;
+		EXPECT_EQ(client->open(bitfile, signature, resource, 0, &session),
+				  NiFpga_Status_Success);
+		return session;
+	}
+
+	/**
+	 * Disconnections are processed asynchronously by the server
+	 */
+	void waitSessionUsers(const NiFpga_Session session, const size_t users) {
+		const auto deadline = std::chrono::steady_clock::now() +
+							  std::chrono::seconds(2);
+		while (server.getSessionUsers(session) != users &&
+			   std::chrono::steady_clock::now() < deadline) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	/**
+	 * Connects without a SessionClient, to send requests it would not send.
+	 * Maps a shared memory of \p shmSize bytes and opens a session
+	 */
+	int connectRaw(const size_t shmSize, SharedMemory *shm,
+				   NiFpga_Session *session) {
+		sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		std::strncpy(addr.sun_path, socketPath.c_str(),
+					 sizeof(addr.sun_path) - 1);
+		const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)),
+				  0);
+
+		*shm = SharedMemory::create(
+			"/irioSessionTest." + std::to_string(getpid()), shmSize);
+		auto req = createRawRequest(Operation::Attach, 0);
+		req.value = shmSize;
+		EXPECT_EQ(sendRaw(fd, req, shm->name()).status, NiFpga_Status_Success);
+		shm->unlink();
+
+		const auto payload = bitfile + '\0' + signature + '\0' + resource + '\0';
+		const auto reply =
+			sendRaw(fd, createRawRequest(Operation::Open, 0), payload);
+		EXPECT_EQ(reply.status, NiFpga_Status_Success);
+		*session = reply.session;
+		return fd;
+	}
+
+	Request createRawRequest(const Operation op, const NiFpga_Session session) {
+		Request req;
+		memset(&req, 0, sizeof(req));
+		req.op = op;
+		req.session = session;
+		return req;
+	}
+
+	Reply sendRaw(const int fd, Request req, const std::string &payload = "") {
+		req.payloadSize = static_cast<std::uint32_t>(payload.size());
+		sendMessage(fd, &req, sizeof(req), payload.data(), payload.size());
+		Reply reply;
+		receiveAll(fd, &reply, sizeof(reply));
+		std::string replyPayload(reply.payloadSize, '\0');
+		receiveAll(fd, &replyPayload[0], replyPayload.size());
+		return reply;
+	}
+
+	const std::string socketPath;
+	const std::string bitfile = "/tmp/FlexRIO.lvbitx";
+	const std::string signature = "ABCDEF";
+	const std::string resource = "RIO0";
+	SessionServer server;
+};
+
+///////////////////////////////////////////////////////////////
+///// Sessions
+///////////////////////////////////////////////////////////////
+TEST_F(SessionTests, OpenSharedBetweenClients) {
+	SessionClient client1(socketPath);
+	SessionClient client2(socketPath);
+
+	const auto session1 = openSession(&client1);
+	const auto session2 = openSession(&client2);
+
+	EXPECT_EQ(NiFpga_Open_fake.call_count, 1);
+	EXPECT_STREQ(NiFpga_Open_fake.arg2_val, resource.c_str());
+	EXPECT_EQ(session1, session2);
+	EXPECT_EQ(server.getNumSessions(), 1);
+	EXPECT_EQ(server.getSessionUsers(session1), 2);
+}
+
+TEST_F(SessionTests, CloseKeepsSessionOpen) {
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	EXPECT_EQ(client.close(session, 0), NiFpga_Status_Success);
+	EXPECT_EQ(NiFpga_Close_fake.call_count, 0);
+	EXPECT_EQ(server.getNumSessions(), 1);
+	EXPECT_EQ(server.getSessionUsers(session), 0);
+
+	// Reopening does not download the bitfile again
+	openSession(&client);
+	EXPECT_EQ(NiFpga_Open_fake.call_count, 1);
+}
+
+TEST_F(SessionTests, CloseNotOpenedSession) {
+	SessionClient client(socketPath);
+	EXPECT_EQ(client.close(42, 0), NiFpga_Status_InvalidParameter);
+}
+
+TEST_F(SessionTests, ErrorUseSessionOfOtherClient) {
+	SessionClient owner(socketPath);
+	SessionClient other(socketPath);
+	const auto session = openSession(&owner);
+
+	std::int32_t read = 0;
+	EXPECT_EQ(other.read(session, 0x10, ValueType::I32, &read),
+			  NiFpga_Status_InvalidParameter);
+	const std::uint16_t value = 0xBEEF;
+	EXPECT_EQ(other.write(session, 0x20, ValueType::U16, &value),
+			  NiFpga_Status_InvalidParameter);
+	EXPECT_EQ(other.startFifo(session, 3), NiFpga_Status_InvalidParameter);
+	EXPECT_EQ(NiFpga_ReadI32_fake.call_count, 0);
+	EXPECT_EQ(NiFpga_WriteU16_fake.call_count, 0);
+	EXPECT_EQ(NiFpga_StartFifo_fake.call_count, 0);
+
+	// Nor after closing it
+	EXPECT_EQ(owner.close(session, 0), NiFpga_Status_Success);
+	EXPECT_EQ(owner.startFifo(session, 3), NiFpga_Status_InvalidParameter);
+	EXPECT_EQ(NiFpga_StartFifo_fake.call_count, 0);
+}
+
+TEST_F(SessionTests, OpenError) {
+	NiFpga_Open_fake.custom_fake = nullptr;
+	NiFpga_Open_fake.return_val = NiFpga_Status_BitfileReadError;
+	SessionClient client(socketPath);
+
+	NiFpga_Session session = 0;
+	EXPECT_EQ(client.open(bitfile, signature, resource, 0, &session),
+			  NiFpga_Status_BitfileReadError);
+	EXPECT_EQ(server.getNumSessions(), 0);
+}
+
+TEST_F(SessionTests, DisconnectReleasesSessions) {
+	SessionClient client1(socketPath);
+	const auto session = openSession(&client1);
+	{
+		SessionClient client2(socketPath);
+		openSession(&client2);
+		EXPECT_EQ(server.getSessionUsers(session), 2);
+	}
+
+	waitSessionUsers(session, 1);
+	EXPECT_EQ(server.getSessionUsers(session), 1);
+	EXPECT_EQ(server.getNumSessions(), 1);
+}
+
+TEST_F(SessionTests, StopClosesSessions) {
+	{
+		SessionClient client(socketPath);
+		const auto session = openSession(&client);
+		client.close(session, 1);
+	}
+
+	server.stop();
+	EXPECT_EQ(NiFpga_Close_fake.call_count, 1);
+	EXPECT_EQ(NiFpga_Close_fake.arg1_val, 1);
+	EXPECT_EQ(server.getNumSessions(), 0);
+}
+
+TEST_F(SessionTests, SocketPermissions) {
+	struct stat st;
+	ASSERT_EQ(stat(socketPath.c_str(), &st), 0);
+	EXPECT_EQ(st.st_mode & 0777, DEFAULT_SOCKET_MODE);
+
+	const std::string path = socketPath + ".owner";
+	SessionServer ownerOnly(path, 0600);
+	ownerOnly.start();
+	ASSERT_EQ(stat(path.c_str(), &st), 0);
+	EXPECT_EQ(st.st_mode & 0777, 0600);
+	SessionClient client(path);
+	ownerOnly.stop();
+}
+
+TEST_F(SessionTests, ErrorConnectNoDaemon) {
+	EXPECT_THROW(SessionClient("/tmp/irioSessionTest.missing.sock"),
+				 errors::SessionConnectionError);
+}
+
+///////////////////////////////////////////////////////////////
+///// Registers
+///////////////////////////////////////////////////////////////
+TEST_F(SessionTests, ReadRegister) {
+	const std::uint32_t reg = 0x10;
+	const std::int32_t value = -1234;
+	setValueForReg(ReadFunctions::NiFpga_ReadI32, reg, value);
+
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	std::int32_t read = 0;
+	EXPECT_EQ(client.read(session, reg, ValueType::I32, &read),
+			  NiFpga_Status_Success);
+	EXPECT_EQ(read, value);
+	EXPECT_EQ(NiFpga_ReadI32_fake.arg0_val, session);
+}
+
+TEST_F(SessionTests, WriteRegister) {
+	const std::uint32_t reg = 0x20;
+	const std::uint16_t value = 0xBEEF;
+
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	EXPECT_EQ(client.write(session, reg, ValueType::U16, &value),
+			  NiFpga_Status_Success);
+	EXPECT_EQ(NiFpga_WriteU16_fake.call_count, 1);
+	EXPECT_EQ(NiFpga_WriteU16_fake.arg1_val, reg);
+	EXPECT_EQ(NiFpga_WriteU16_fake.arg2_val, value);
+}
+
+TEST_F(SessionTests, ReadArrayRegister) {
+	const std::uint32_t reg = 0x30;
+	const std::uint16_t values[4] = { 1, 2, 3, 4 };
+	setValueForReg(ReadArrayFunctions::NiFpga_ReadArrayU16, reg, values, 4);
+
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	std::uint16_t read[4] = { 0 };
+	EXPECT_EQ(client.readArray(session, reg, ValueType::U16, read, 4),
+			  NiFpga_Status_Success);
+	for (size_t i = 0; i < 4; ++i) {
+		EXPECT_EQ(read[i], values[i]);
+	}
+}
+
+TEST_F(SessionTests, FlexRIOAttribute) {
+	NiFlexRio_GetAttribute_fake.custom_fake = [](NiFpga_Session, int32_t,
+			int32_t, void* value){
+		*reinterpret_cast<uint32_t*>(value) = 0x1234;
+		return NiFpga_Status_Success;
+	};
+
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	std::uint64_t value = 0;
+	EXPECT_EQ(client.getFlexRIOAttribute(session, 5,
+										 NIFLEXRIO_ValueType_U32, &value),
+			  NiFpga_Status_Success);
+	EXPECT_EQ(static_cast<std::uint32_t>(value), 0x1234);
+	EXPECT_EQ(NiFlexRio_GetAttribute_fake.arg1_val, 5);
+}
+
+///////////////////////////////////////////////////////////////
+///// FIFOs
+///////////////////////////////////////////////////////////////
+static NiFpga_Status readFifoSequence(NiFpga_Session, uint32_t,
+		uint64_t* data, size_t numberOfElements, uint32_t,
+		size_t* elementsRemaining) {
+	for (size_t i = 0; i < numberOfElements; ++i) {
+		data[i] = i;
+	}
+	if (elementsRemaining) {
+		*elementsRemaining = 5;
+	}
+	return NiFpga_Status_Success;
+}
+
+TEST_F(SessionTests, ReadFifo) {
+	NiFpga_ReadFifoU64_fake.custom_fake = readFifoSequence;
+
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	std::vector<std::uint64_t> data(1000);
+	size_t remaining = 0;
+	EXPECT_EQ(client.readFifoU64(session, 2, data.data(), data.size(), 100,
+								 &remaining),
+			  NiFpga_Status_Success);
+	EXPECT_EQ(remaining, 5);
+	EXPECT_EQ(NiFpga_ReadFifoU64_fake.arg1_val, 2);
+	EXPECT_EQ(NiFpga_ReadFifoU64_fake.arg4_val, 100);
+	for (size_t i = 0; i < data.size(); ++i) {
+		EXPECT_EQ(data[i], i);
+	}
+}
+
+TEST_F(SessionTests, ErrorReadFifoBiggerThanSharedMemory) {
+	SessionClient client(socketPath, 1024);
+	const auto session = openSession(&client);
+
+	std::vector<std::uint64_t> data(1024);
+	EXPECT_EQ(client.readFifoU64(session, 0, data.data(), data.size(), 0,
+								 nullptr),
+			  NiFpga_Status_MemoryFull);
+	EXPECT_EQ(NiFpga_ReadFifoU64_fake.call_count, 0);
+}
+
+TEST_F(SessionTests, ErrorReadFifoTypeNotU64) {
+	SharedMemory shm;
+	NiFpga_Session session;
+	const int fd = connectRaw(1024, &shm, &session);
+
+	// The FIFO is read as U64 whatever the type, so it does not fit either
+	auto req = createRawRequest(Operation::ReadFifo, session);
+	req.type = ValueType::U8;
+	req.count = 1024;
+	EXPECT_EQ(sendRaw(fd, req).status, NiFpga_Status_MemoryFull);
+	EXPECT_EQ(NiFpga_ReadFifoU64_fake.call_count, 0);
+	close(fd);
+}
+
+TEST_F(SessionTests, ErrorUnknownOperationOrType) {
+	SharedMemory shm;
+	NiFpga_Session session;
+	const int fd = connectRaw(1024, &shm, &session);
+
+	auto req = createRawRequest(Operation::ReadArray, session);
+	req.type = static_cast<ValueType>(100);
+	req.count = 1;
+	EXPECT_EQ(sendRaw(fd, req).status, NiFpga_Status_InvalidParameter);
+	req.op = Operation::ReadFifo;
+	EXPECT_EQ(sendRaw(fd, req).status, NiFpga_Status_InvalidParameter);
+	req.op = static_cast<Operation>(100);
+	req.type = ValueType::U8;
+	EXPECT_EQ(sendRaw(fd, req).status, NiFpga_Status_InvalidParameter);
+	EXPECT_EQ(NiFpga_ReadArrayU8_fake.call_count, 0);
+	EXPECT_EQ(NiFpga_ReadFifoU64_fake.call_count, 0);
+
+	// The daemon keeps serving the client
+	req = createRawRequest(Operation::Run, session);
+	EXPECT_EQ(sendRaw(fd, req).status, NiFpga_Status_Success);
+	close(fd);
+}
+
+TEST_F(SessionTests, AcquireReleaseFifo) {
+	NiFpga_ReadFifoU64_fake.custom_fake = readFifoSequence;
+
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	std::uint64_t *first = nullptr;
+	std::uint64_t *second = nullptr;
+	size_t acquired = 0;
+	EXPECT_EQ(client.acquireFifoReadElementsU64(session, 0, &first, 4, 0,
+												&acquired, nullptr),
+			  NiFpga_Status_Success);
+	EXPECT_EQ(acquired, 4);
+	EXPECT_EQ(client.acquireFifoReadElementsU64(session, 0, &second, 4, 0,
+												&acquired, nullptr),
+			  NiFpga_Status_Success);
+
+	// Acquired regions remain valid until released
+	EXPECT_EQ(first[3], 3);
+	EXPECT_EQ(second[3], 3);
+
+	EXPECT_EQ(client.releaseFifoElements(session, 0, 6), NiFpga_Status_Success);
+	EXPECT_EQ(client.releaseFifoElements(session, 0, 2), NiFpga_Status_Success);
+	EXPECT_EQ(client.releaseFifoElements(session, 0, 1),
+			  NiFpga_Status_InvalidParameter);
+}
+
+TEST_F(SessionTests, ConfigureStartStopFifo) {
+	SessionClient client(socketPath);
+	const auto session = openSession(&client);
+
+	EXPECT_EQ(client.configureFifo(session, 3, 4096), NiFpga_Status_Success);
+	EXPECT_EQ(NiFpga_ConfigureFifo_fake.arg2_val, 4096);
+	EXPECT_EQ(client.startFifo(session, 3), NiFpga_Status_Success);
+	EXPECT_EQ(NiFpga_StartFifo_fake.arg1_val, 3);
+	EXPECT_EQ(client.stopFifo(session, 3), NiFpga_Status_Success);
+	EXPECT_EQ(NiFpga_StopFifo_fake.arg1_val, 3);
+}
+
+///////////////////////////////////////////////////////////////
+///// RIO discovery
+///////////////////////////////////////////////////////////////
+TEST_F(SessionTests, SearchRIODevice) {
+	searchRIODevice_fake.return_val = "RIO0";
+
+	SessionClient client(socketPath);
+	EXPECT_EQ(client.searchRIODevice("0x01234567"), "RIO0");
+	EXPECT_EQ(searchRIODevice_fake.call_count, 1);
+}
+
+TEST_F(SessionTests, ErrorSearchRIODeviceNotFound) {
+	searchRIODevice_fake.custom_fake = [](const std::string) -> std::string {
+		throw errors::RIODeviceNotFoundError("0x01234567");
+	};
+
+	SessionClient client(socketPath);
+	EXPECT_THROW(client.searchRIODevice("0x01234567"),
+				 errors::RIODeviceNotFoundError);
+}
+
+TEST_F(SessionTests, ErrorSearchRIODeviceDiscovery) {
+	searchRIODevice_fake.custom_fake = [](const std::string) -> std::string {
+		throw errors::RIODiscoveryError("nisyscfg failed");
+	};
+
+	SessionClient client(socketPath);
+	EXPECT_THROW(client.searchRIODevice("0x01234567"),
+				 errors::RIODiscoveryError);
+}